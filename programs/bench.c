@@ -0,0 +1,1267 @@
+/**
+ * bench.c - Benchmarks for vd-libs by Michael Dodis <michaeldodisgr@gmail.com>
+ * ---------------------------------------------------------------------------------------------------------------------
+ * This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <https://unlicense.org/>
+ * ---------------------------------------------------------------------------------------------------------------------
+ */
+
+#define VD_USE_CRT 1
+#define VD_IMPL
+#define VD_INIX_IMPL
+#include "vd.h"
+#include "vd_inix.h"
+
+#define VD_UI_IMPL
+#include "vd_ui.h"
+
+#define VD_DEBUG_ENABLE 1
+#define VD_DEBUG_IMPL
+#include "vd_debug.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCH_PROC(name) void name(Vdusize max_count)
+typedef BENCH_PROC(BenchProc);
+
+typedef struct {
+    const char *name;
+    BenchProc  *proc;
+    Vdusize     default_max_count;
+} Bench;
+
+static Vdu64 Bench_Rng = 0x9E3779B97F4A7C15ull;
+
+static Vdu32 bench_rand32(void)
+{
+    Bench_Rng ^= Bench_Rng << 13;
+    Bench_Rng ^= Bench_Rng >> 7;
+    Bench_Rng ^= Bench_Rng << 17;
+    return (Vdu32)(Bench_Rng >> 32);
+}
+
+static Vdf64 bench_ms_since(VdHiTime start)
+{
+    return vd_hitime_fms64(vd_hitime_sub(vd_hitime_get(), start));
+}
+
+/* ----SORT---------------------------------------------------------------------------------------------------------- */
+static int bench_qsort_cmp_u32(const void *a, const void *b)
+{
+    Vdu32 x = *(const Vdu32*)a;
+    Vdu32 y = *(const Vdu32*)b;
+    return (x > y) - (x < y);
+}
+
+static VD_PROC_SORT_CMP(bench_sort_cmp_u32)
+{
+    VD_UNUSED(userdata);
+    Vdu32 x = *(const Vdu32*)a;
+    Vdu32 y = *(const Vdu32*)b;
+    return (x > y) - (x < y);
+}
+
+static Vdb32 bench_is_sorted_u32(Vdu32 *a, Vdusize count)
+{
+    for (Vdusize i = 1; i < count; ++i) {
+        if (a[i - 1] > a[i]) return VD_FALSE;
+    }
+    return VD_TRUE;
+}
+
+static BENCH_PROC(bench_sort)
+{
+    printf("%12s %12s %12s %12s %12s %12s\n", "count", "qsort", "vd_sort", "radix", "radix_par", "sort_par");
+
+    for (Vdusize count = 1000; count <= max_count; count *= 10) {
+        Vdu32 *input = (Vdu32*)malloc(count * sizeof(Vdu32));
+        Vdu32 *work  = (Vdu32*)malloc(count * sizeof(Vdu32));
+        for (Vdusize i = 0; i < count; ++i) input[i] = bench_rand32();
+
+        // Radix needs a second key buffer plus histograms; the parallel merge needs a second buffer as well
+        VdArena scratch = vd_arena_from_malloc(count * sizeof(Vdu32) + VD_KILOBYTES(256));
+
+        Vdf64   ms[5];
+        Vdb32   ok = VD_TRUE;
+        VdHiTime start;
+
+        memcpy(work, input, count * sizeof(Vdu32));
+        start = vd_hitime_get();
+        qsort(work, count, sizeof(Vdu32), bench_qsort_cmp_u32);
+        ms[0] = bench_ms_since(start);
+        ok = ok && bench_is_sorted_u32(work, count);
+
+        memcpy(work, input, count * sizeof(Vdu32));
+        start = vd_hitime_get();
+        vd_sort(work, count, sizeof(Vdu32), bench_sort_cmp_u32, 0);
+        ms[1] = bench_ms_since(start);
+        ok = ok && bench_is_sorted_u32(work, count);
+
+        memcpy(work, input, count * sizeof(Vdu32));
+        start = vd_hitime_get();
+        vd_sort_radix_u32(work, 0, count, &scratch);
+        ms[2] = bench_ms_since(start);
+        ok = ok && bench_is_sorted_u32(work, count);
+
+        memcpy(work, input, count * sizeof(Vdu32));
+        start = vd_hitime_get();
+        vd_sort_radix_u32_parallel(work, 0, count, &scratch, 0);
+        ms[3] = bench_ms_since(start);
+        ok = ok && bench_is_sorted_u32(work, count);
+
+        memcpy(work, input, count * sizeof(Vdu32));
+        start = vd_hitime_get();
+        vd_sort_parallel(work, count, sizeof(Vdu32), bench_sort_cmp_u32, 0, &scratch, 0);
+        ms[4] = bench_ms_since(start);
+        ok = ok && bench_is_sorted_u32(work, count);
+
+        printf("%12zu %10.2fms %10.2fms %10.2fms %10.2fms %10.2fms%s\n",
+               count, ms[0], ms[1], ms[2], ms[3], ms[4], ok ? "" : "  (NOT SORTED)");
+
+        free(scratch.buf);
+        free(work);
+        free(input);
+    }
+}
+
+/* ----BITSET-------------------------------------------------------------------------------------------------------- */
+static void bench_bitset_fill(VdBitset *b, Vdu32 one_in)
+{
+    for (Vdusize i = 0; i < b->num_bits; ++i) {
+        if ((bench_rand32() % one_in) == 0) vd_bitset_set(b, i);
+    }
+}
+
+static BENCH_PROC(bench_bitset)
+{
+    Vdusize num_bits = max_count;
+    Vdusize num_reps = 10;
+    VdArena arena = vd_arena_from_malloc(VD_BITS_WORDS(num_bits) * sizeof(Vdu64) * 6 + num_bits / 8 + VD_MEGABYTES(64));
+
+    VdBitset a = vd_bitset_new(&arena, num_bits);
+    VdBitset b = vd_bitset_new(&arena, num_bits);
+    VdBitset r = vd_bitset_new(&arena, num_bits);
+    bench_bitset_fill(&a, 2);
+    bench_bitset_fill(&b, 2);
+
+    Vdf64 bytes = (Vdf64)(a.num_words * sizeof(Vdu64));
+    printf("%zu bits, %.1f MiB per set, best of %zu\n", num_bits, bytes / (1024.0 * 1024.0), num_reps);
+
+    struct { const char *name; void (*proc)(VdBitset*, VdBitset*, VdBitset*); } binops[] = {
+        { "and",    vd_bitset_and    },
+        { "or",     vd_bitset_or     },
+        { "andnot", vd_bitset_andnot },
+        { "xor",    vd_bitset_xor    },
+    };
+
+    for (Vdusize o = 0; o < VD_ARRAY_COUNT(binops); ++o) {
+        Vdf64 best = 1e30;
+        for (Vdusize rep = 0; rep < num_reps; ++rep) {
+            VdHiTime start = vd_hitime_get();
+            binops[o].proc(&r, &a, &b);
+            Vdf64 ms = bench_ms_since(start);
+            if (ms < best) best = ms;
+        }
+        printf("%-24s %10.3fms %8.2f GiB/s (3 streams)\n", binops[o].name, best, (3 * bytes / (1024.0 * 1024.0 * 1024.0)) / (best / 1000.0));
+    }
+
+    {
+        Vdf64 best = 1e30;
+        Vdusize count = 0;
+        for (Vdusize rep = 0; rep < num_reps; ++rep) {
+            VdHiTime start = vd_hitime_get();
+            count = vd_bitset_count(&a);
+            Vdf64 ms = bench_ms_since(start);
+            if (ms < best) best = ms;
+        }
+        printf("%-24s %10.3fms %8.2f GiB/s (count=%zu)\n", "popcount", best, (bytes / (1024.0 * 1024.0 * 1024.0)) / (best / 1000.0), count);
+    }
+
+    // Sparse (1 in 1024) sets: iteration and compressed set operations
+    VdBitset sa = vd_bitset_new(&arena, num_bits);
+    VdBitset sb = vd_bitset_new(&arena, num_bits);
+    bench_bitset_fill(&sa, 1024);
+    bench_bitset_fill(&sb, 1024);
+
+    Vdu32 *indices = (Vdu32*)malloc(sizeof(Vdu32) * (vd_bitset_count(&sa) + 1));
+    VdHiTime start = vd_hitime_get();
+    Vdusize n = vd_bitset_to_indices(&sa, indices);
+    printf("%-24s %10.3fms (%zu members)\n", "to_indices 1/1024", bench_ms_since(start), n);
+
+    start = vd_hitime_get();
+    Vdusize visited = 0;
+    VD_BITSET_FOR_EACH(&sa, i) visited += i & 1;
+    printf("%-24s %10.3fms\n", "for_each 1/1024", bench_ms_since(start));
+
+    VdSparseBitset ssa, ssb, ssr;
+    vd_sparse_bitset_init(&ssa, &arena);
+    vd_sparse_bitset_init(&ssb, &arena);
+    start = vd_hitime_get();
+    for (Vdusize i = 0; i < n; ++i) vd_sparse_bitset_add(&ssa, indices[i]);
+    printf("%-24s %10.3fms\n", "sparse add 1/1024", bench_ms_since(start));
+    vd_sparse_bitset_from_bitset(&ssb, &sb);
+
+    Vdusize sparse_bytes = 0;
+    for (Vdu32 i = 0; i < ssa.num_containers; ++i) sparse_bytes += ssa.containers[i].count * sizeof(Vdu16);
+    printf("%-24s %10.2f MiB vs %.2f MiB dense\n", "sparse size", sparse_bytes / (1024.0 * 1024.0), bytes / (1024.0 * 1024.0));
+
+    start = vd_hitime_get();
+    vd_sparse_bitset_init(&ssr, &arena);
+    vd_sparse_bitset_and(&ssr, &ssa, &ssb);
+    printf("%-24s %10.3fms (count=%llu)\n", "sparse and 1/1024", bench_ms_since(start), (unsigned long long)vd_sparse_bitset_count(&ssr));
+
+    start = vd_hitime_get();
+    vd_sparse_bitset_init(&ssr, &arena);
+    vd_sparse_bitset_or(&ssr, &ssa, &ssb);
+    printf("%-24s %10.3fms (count=%llu)\n", "sparse or 1/1024", bench_ms_since(start), (unsigned long long)vd_sparse_bitset_count(&ssr));
+
+    start = vd_hitime_get();
+    vd_bitset_and(&r, &sa, &sb);
+    printf("%-24s %10.3fms (count=%zu)\n", "dense and 1/1024", bench_ms_since(start), vd_bitset_count(&r));
+
+    VD_UNUSED(visited);
+    free(indices);
+    free(arena.buf);
+}
+
+/* ----MAP IMAGE----------------------------------------------------------------------------------------------------- */
+static BENCH_PROC(bench_map_image)
+{
+    Vdu32 count = (Vdu32)max_count;
+    Vdu32 cap   = count + count / 2;
+    VdArena arena = vd_arena_from_malloc((Vdusize)cap * (sizeof(Vd__StrmapBinPrefix) + sizeof(Vdu32)) + (Vdusize)count * 128);
+
+    char key[64];
+    VdHiTime start = vd_hitime_get();
+    VD_STRMAP Vdu32 *map = 0;
+    VD_STRMAP_INIT(map, &arena, cap, 0);
+    for (Vdu32 i = 0; i < count; ++i) {
+        snprintf(key, sizeof(key), "assets/textures/environment/%08u.png", i);
+        VD_STRMAP_SET(map, vd_str_from_cstr(key), &i);
+    }
+    printf("%-24s %10.3fms (%u entries)\n", "build strmap", bench_ms_since(start), count);
+
+    start = vd_hitime_get();
+    Vdusize size = vd_strmap_image_size(map);
+    void *buf = malloc(size);
+    vd_strmap_image_write(map, buf, size);
+    FILE *f = fopen("bench_map_image.vdmi", "wb");
+    fwrite(buf, size, 1, f);
+    fclose(f);
+    free(buf);
+    printf("%-24s %10.3fms (%.1f MiB)\n", "write image", bench_ms_since(start), size / (1024.0 * 1024.0));
+
+    start = vd_hitime_get();
+    VdFileMap file;
+    VdMapImage image;
+    if (!vd_file_map_open(&file, "bench_map_image.vdmi")) {
+        printf("Failed to map image\n");
+        return;
+    }
+    VdMapImageStatus status = vd_strmap_image_open(&image, file.data, file.size);
+    printf("%-24s %10.3fms (%s)\n", "map + open image", bench_ms_since(start), vd_map_image_status_to_cstr(status));
+
+    Vdu32 num_lookups = count < 1000000 ? count : 1000000;
+    Vdu64 sum_map = 0, sum_image = 0;
+
+    start = vd_hitime_get();
+    for (Vdu32 i = 0; i < num_lookups; ++i) {
+        Vdu32 v = 0;
+        snprintf(key, sizeof(key), "assets/textures/environment/%08u.png", (Vdu32)((i * 2654435761ull) % count));
+        VD_STRMAP_GET(map, vd_str_from_cstr(key), &v);
+        sum_map += v;
+    }
+    printf("%-24s %10.3fms\n", "lookups (strmap)", bench_ms_since(start));
+
+    start = vd_hitime_get();
+    for (Vdu32 i = 0; i < num_lookups; ++i) {
+        Vdu32 v = 0;
+        snprintf(key, sizeof(key), "assets/textures/environment/%08u.png", (Vdu32)((i * 2654435761ull) % count));
+        vd_strmap_image_get(&image, vd_str_from_cstr(key), &v);
+        sum_image += v;
+    }
+    printf("%-24s %10.3fms%s\n", "lookups (image)", bench_ms_since(start), sum_map == sum_image ? "" : "  (MISMATCH)");
+
+    vd_file_map_close(&file);
+    remove("bench_map_image.vdmi");
+    free(arena.buf);
+}
+
+/* ----ARENA SNAPSHOT------------------------------------------------------------------------------------------------ */
+static BENCH_PROC(bench_arena_snapshot)
+{
+    Vdusize count = max_count;
+    VdArena text_arena = vd_arena_from_malloc(count * 64 + VD_KILOBYTES(1));
+    char *text = (char*)text_arena.buf;
+    Vdusize len = 0;
+    for (Vdusize i = 0; i < count; ++i) {
+        if ((i % 16) == 0) len += (Vdusize)snprintf(text + len, 64, "[section_%zu]\n", i / 16);
+        len += (Vdusize)snprintf(text + len, 64, (i % 2) ? "key_%zu = \"value %zu\"\n" : "key_%zu = %zu\n", i, i);
+    }
+
+    VdArena arena = vd_arena_from_malloc(count * 128 + VD_MEGABYTES(1));
+    VdInixParseInfo info = { .contents = { text, len }, .copy_strings = VD_TRUE };
+
+    VdHiTime start = vd_hitime_get();
+    VdInixResult result = vd_inix_parse(&arena, &info);
+    printf("%-24s %10.3fms (%zu entries, %.1f MiB)\n", "parse", bench_ms_since(start), count,
+           arena.curr_offset / (1024.0 * 1024.0));
+    if (!result.global_section) {
+        printf("Failed to parse\n");
+        return;
+    }
+
+    // Register every pointer slot of the parsed document; nothing else in the arena gets relocated
+    start = vd_hitime_get();
+    VdArena reloc_arena = vd_arena_from_malloc(count * 64 + VD_KILOBYTES(4));
+    VdArenaSnapshotRelocs relocs;
+    vd_arena_snapshot_relocs_init(&relocs, &reloc_arena);
+    for (VdInixSection *s = result.global_section; s; s = s->next) {
+        VD_ARENA_SNAPSHOT_ADD_FIELD(&relocs, s, name.s);
+        VD_ARENA_SNAPSHOT_ADD_FIELD(&relocs, s, entry);
+        VD_ARENA_SNAPSHOT_ADD_FIELD(&relocs, s, next);
+        for (VdInixEntry *e = s->entry; e; e = e->next) {
+            VD_ARENA_SNAPSHOT_ADD_FIELD(&relocs, e, name.s);
+            VD_ARENA_SNAPSHOT_ADD_FIELD(&relocs, e, next);
+            if (e->type == VD_INIX_ENTRY_TYPE_RAW_STRING) VD_ARENA_SNAPSHOT_ADD_FIELD(&relocs, e, val.raw_string.s);
+        }
+    }
+    printf("%-24s %10.3fms (%u slots)\n", "register relocs", bench_ms_since(start), VD_DYNARRAY_LEN(relocs.slots));
+
+    start = vd_hitime_get();
+    Vdusize size = vd_arena_snapshot_size(&arena, &relocs);
+    void *buf = malloc(size);
+    vd_arena_snapshot_write(&arena, &relocs, result.global_section, buf, size);
+    FILE *f = fopen("bench_arena_snapshot.vdns", "wb");
+    fwrite(buf, size, 1, f);
+    fclose(f);
+    printf("%-24s %10.3fms (%.1f MiB)\n", "write snapshot", bench_ms_since(start), size / (1024.0 * 1024.0));
+
+    start = vd_hitime_get();
+    VdFileMap file;
+    if (!vd_file_map_open(&file, "bench_arena_snapshot.vdns")) {
+        printf("Failed to map snapshot\n");
+        return;
+    }
+    VdArena load_arena = vd_arena_from_malloc(size + VD_KILOBYTES(1));
+    void *root = 0;
+    VdArenaSnapshotStatus status = vd_arena_snapshot_load(&load_arena, file.data, file.size, &root);
+    printf("%-24s %10.3fms (%s)\n", "map + load", bench_ms_since(start), vd_arena_snapshot_status_to_cstr(status));
+
+    start = vd_hitime_get();
+    status = vd_arena_snapshot_fixup(buf, size, &root);
+    printf("%-24s %10.3fms (%s)\n", "fixup in place", bench_ms_since(start), vd_arena_snapshot_status_to_cstr(status));
+
+    Vdusize num_entries = 0;
+    for (VdInixSection *s = (VdInixSection*)root; s; s = s->next) {
+        for (VdInixEntry *e = s->entry; e; e = e->next) num_entries++;
+    }
+    printf("%-24s %10zu%s\n", "entries after load", num_entries, num_entries == count ? "" : "  (MISMATCH)");
+
+    vd_file_map_close(&file);
+    remove("bench_arena_snapshot.vdns");
+    free(buf);
+    free(load_arena.buf);
+    free(reloc_arena.buf);
+    free(arena.buf);
+    free(text_arena.buf);
+}
+
+/* ----UTF8---------------------------------------------------------------------------------------------------------- */
+static BENCH_PROC(bench_utf8)
+{
+    // Mostly ASCII with a sprinkle of 2, 3 and 4 byte sequences, like source text or UI strings.
+    static const char *words[] = { "hello ", "world ", "caf\xC3\xA9 ", "\xE2\x82\xAC" "42 ", "na\xC3\xAFve ",
+                                   "\xF0\x9F\x98\x80 ", "parser ", "layout " };
+    Vdusize len = max_count;
+    char *text = (char*)malloc(len + 16);
+    Vdusize at = 0;
+    while (at < len) {
+        const char *w = words[bench_rand32() % VD_ARRAY_COUNT(words)];
+        Vdusize wlen = strlen(w);
+        if (at + wlen > len) break;
+        memcpy(text + at, w, wlen);
+        at += wlen;
+    }
+    len = at;
+
+    VdHiTime start = vd_hitime_get();
+    Vdb32 valid = vd__utf8_validate_scalar((const Vdu8*)text, len);
+    Vdf64 ms = bench_ms_since(start);
+    printf("%-24s %10.3fms (%.2f GB/s, %s)\n", "validate (scalar)", ms, len / (ms * 1e6), valid ? "valid" : "INVALID");
+
+    start = vd_hitime_get();
+    valid = vd_utf8_validate(text, len);
+    ms = bench_ms_since(start);
+    printf("%-24s %10.3fms (%.2f GB/s, %s)\n", "validate", ms, len / (ms * 1e6), valid ? "valid" : "INVALID");
+
+    start = vd_hitime_get();
+    Vdb32 ascii = vd_utf8_is_ascii(text, len);
+    ms = bench_ms_since(start);
+    printf("%-24s %10.3fms (%.2f GB/s, %s)\n", "is_ascii", ms, len / (ms * 1e6), ascii ? "ascii" : "not ascii");
+
+    start = vd_hitime_get();
+    Vdusize count = vd_utf8_count(text, len);
+    ms = bench_ms_since(start);
+    printf("%-24s %10.3fms (%.2f GB/s, %zu codepoints)\n", "count", ms, len / (ms * 1e6), count);
+
+    Vdu32 *out = (Vdu32*)malloc(sizeof(Vdu32) * (count + 1));
+    start = vd_hitime_get();
+    Vdusize decoded = 0;
+    for (Vdusize i = 0; i < len;) {
+        Vdu32 c = 0xFFFD;
+        Vdu32 n = vd_utf8_decode(text + i, len - i, &c);
+        out[decoded++] = c;
+        i += n ? n : 1;
+    }
+    ms = bench_ms_since(start);
+    printf("%-24s %10.3fms (%.2f GB/s)\n", "decode one at a time", ms, len / (ms * 1e6));
+
+    start = vd_hitime_get();
+    decoded = vd_utf8_to_utf32(text, len, out);
+    ms = bench_ms_since(start);
+    printf("%-24s %10.3fms (%.2f GB/s)%s\n", "to_utf32", ms, len / (ms * 1e6), decoded == count ? "" : "  (MISMATCH)");
+
+    free(out);
+    free(text);
+}
+
+/* ----LZ------------------------------------------------------------------------------------------------------------ */
+static void bench_lz_run(const char *name, Vdu8 *src, Vdusize len)
+{
+    Vdusize bound = vd_lz_frame_bound(len);
+    Vdu8 *frame = (Vdu8*)malloc(bound);
+    Vdu8 *out   = (Vdu8*)malloc(len);
+
+    VdHiTime start = vd_hitime_get();
+    Vdusize size = vd_lz_frame_compress(src, len, frame, bound);
+    Vdf64 ms = bench_ms_since(start);
+    printf("%-10s %-13s %10.3fms (%.2f GB/s, ratio %.2f)\n", name, "compress", ms, len / (ms * 1e6),
+           (Vdf64)len / size);
+
+    // Fault the output pages in first, so only decompression is measured.
+    memset(out, 0, len);
+
+    start = vd_hitime_get();
+    Vdusize out_len = 0;
+    VdLzStatus status = vd_lz_frame_decompress(frame, size, out, len, &out_len);
+    ms = bench_ms_since(start);
+    printf("%-10s %-13s %10.3fms (%.2f GB/s, %s)%s\n", name, "decompress", ms, len / (ms * 1e6),
+           vd_lz_status_to_cstr(status), (out_len == len) && (memcmp(out, src, len) == 0) ? "" : "  (MISMATCH)");
+
+    free(out);
+    free(frame);
+}
+
+static BENCH_PROC(bench_lz)
+{
+    // Source-like text made of random tokens: many short matches, close to the worst case for LZ decoders.
+    static const char *words[] = { "static ", "void ", "return ", "VdArena ", "*a, ", "(Vdusize) ", "if (", ") {\n", "}\n",
+                                   "    ", "vd_arena_alloc", "0x", "len", " = ", ";\n", "// ", "const ", "Vdu8 " };
+    Vdusize len = max_count;
+    Vdu8 *src = (Vdu8*)malloc(len + 32);
+    Vdusize at = 0;
+    while (at < len) {
+        const char *w = words[bench_rand32() % VD_ARRAY_COUNT(words)];
+        Vdusize wlen = strlen(w);
+        if (at + wlen > len) break;
+        memcpy(src + at, w, wlen);
+        at += wlen;
+        if ((bench_rand32() & 15) == 0) src[at++] = (Vdu8)('0' + bench_rand32() % 10);
+    }
+    bench_lz_run("tokens", src, at);
+
+    // Arrays of records, like vertex or glyph data: longer matches.
+    typedef struct { Vdu32 id; Vdf32 pos[3]; Vdf32 uv[2]; Vdu32 color; } Record;
+    Record *records = (Record*)src;
+    Vdusize num_records = len / sizeof(Record);
+    for (Vdusize i = 0; i < num_records; ++i) {
+        Record r = { (Vdu32)i, { (Vdf32)(i % 64), 0.0f, 1.0f }, { 0.5f, (Vdf32)((i / 64) % 2) }, 0xFFFFFFFFu };
+        if ((bench_rand32() & 7) == 0) r.color = bench_rand32();
+        records[i] = r;
+    }
+    bench_lz_run("records", src, num_records * sizeof(Record));
+
+    free(src);
+}
+
+/* ----CHECKSUM------------------------------------------------------------------------------------------------------ */
+static BENCH_PROC(bench_crc)
+{
+    Vdusize len = max_count;
+    Vdu8 *data = (Vdu8*)malloc(len);
+    for (Vdusize i = 0; i < len; ++i) data[i] = (Vdu8)bench_rand32();
+
+    printf("%-24s %10s\n", "crc32 instructions", vd_crc32c_hw_available() ? "yes" : "no");
+
+    VdHiTime start = vd_hitime_get();
+    Vdu32 hw = vd_crc32c(0, data, len);
+    Vdf64 ms = bench_ms_since(start);
+    printf("%-24s %10.3fms (%.2f GB/s)\n", "crc32c", ms, len / (ms * 1e6));
+
+    start = vd_hitime_get();
+    Vdu32 sw = vd_crc32c_portable(0, data, len);
+    ms = bench_ms_since(start);
+    printf("%-24s %10.3fms (%.2f GB/s)%s\n", "crc32c slicing-by-8", ms, len / (ms * 1e6), sw == hw ? "" : "  (MISMATCH)");
+
+    // Small records, like pack entries or cache keys, where the interleaved loop never kicks in.
+    start = vd_hitime_get();
+    Vdu32 acc = 0;
+    for (Vdusize i = 0; i + 64 <= len; i += 64) acc ^= vd_crc32c(0, data + i, 64);
+    ms = bench_ms_since(start);
+    printf("%-24s %10.3fms (%.2f GB/s, %08x)\n", "crc32c 64 byte chunks", ms, len / (ms * 1e6), acc);
+
+    start = vd_hitime_get();
+    Vdu16 c16 = vd_crc16(0, data, len);
+    ms = bench_ms_since(start);
+    printf("%-24s %10.3fms (%.2f GB/s, %04x)\n", "crc16", ms, len / (ms * 1e6), c16);
+
+    start = vd_hitime_get();
+    Vdu64 h = vd_dhash64(data, len);
+    ms = bench_ms_since(start);
+    printf("%-24s %10.3fms (%.2f GB/s, %08x)\n", "dhash64 (reference)", ms, len / (ms * 1e6), (Vdu32)h);
+
+    free(data);
+}
+
+/* ----BTREE--------------------------------------------------------------------------------------------------------- */
+typedef struct {
+    Vdu64 k;
+    Vdu64 v;
+} BenchKV64;
+
+static int bench_qsort_cmp_u64(const void *a, const void *b)
+{
+    Vdu64 x = *(const Vdu64*)a;
+    Vdu64 y = *(const Vdu64*)b;
+    return (x > y) - (x < y);
+}
+
+static int bench_qsort_cmp_str(const void *a, const void *b)
+{
+    return vd_str_compare(*(const VdStr*)a, *(const VdStr*)b);
+}
+
+static Vdusize bench_lower_bound_u64(const Vdu64 *a, Vdusize n, Vdu64 key)
+{
+    const Vdu64 *base = a;
+    while (n > 1) {
+        Vdusize half = n / 2;
+        base = (base[half - 1] < key) ? base + half : base;
+        n -= half;
+    }
+    return (Vdusize)(base - a) + (n == 1 && *base < key);
+}
+
+static Vdusize bench_lower_bound_str(const VdStr *a, Vdusize n, VdStr key)
+{
+    Vdusize lo = 0, hi = n;
+    while (lo < hi) {
+        Vdusize mid = lo + (hi - lo) / 2;
+        if (vd_str_compare(a[mid], key) < 0) lo = mid + 1;
+        else                                 hi = mid;
+    }
+    return lo;
+}
+
+static BENCH_PROC(bench_btree)
+{
+    Vdusize count = max_count;
+    Vdu64 *keys   = (Vdu64*)malloc(count * sizeof(Vdu64));
+    Vdu64 *sorted = (Vdu64*)malloc(count * sizeof(Vdu64));
+    for (Vdusize i = 0; i < count; ++i) keys[i] = ((Vdu64)bench_rand32() << 32) | bench_rand32();
+
+    VdArena arena = vd_arena_from_malloc(count * 128 + VD_MEGABYTES(64));
+    Vdu64 sums[4] = {0};
+    VdHiTime start;
+    Vdf64 ms;
+
+    printf("%-24s %10zu random u64 keys\n", "", count);
+
+    VdBTree tree;
+    vd_btree_init(&tree, &arena, VD_BTREE_KEY_U64);
+    start = vd_hitime_get();
+    for (Vdusize i = 0; i < count; ++i) vd_btree_set_u64(&tree, keys[i], i);
+    printf("%-24s %10.3fms (height %u)\n", "btree insert", bench_ms_since(start), tree.height);
+
+    start = vd_hitime_get();
+    for (Vdusize i = 0; i < count; ++i) {
+        Vdu64 v = 0;
+        vd_btree_get_u64(&tree, keys[(i * 2654435761ull) % count], &v);
+        sums[0] += v;
+    }
+    printf("%-24s %10.3fms\n", "btree get", bench_ms_since(start));
+
+    memcpy(sorted, keys, count * sizeof(Vdu64));
+    start = vd_hitime_get();
+    qsort(sorted, count, sizeof(Vdu64), bench_qsort_cmp_u64);
+    printf("%-24s %10.3fms\n", "qsort", bench_ms_since(start));
+
+    start = vd_hitime_get();
+    for (Vdusize i = 0; i < count; ++i) {
+        sums[1] += bench_lower_bound_u64(sorted, count, keys[(i * 2654435761ull) % count]);
+    }
+    printf("%-24s %10.3fms\n", "binary search", bench_ms_since(start));
+
+    VdBTree built;
+    vd_btree_init(&built, &arena, VD_BTREE_KEY_U64);
+    start = vd_hitime_get();
+    vd_btree_build_u64(&built, sorted, 0, count);
+    printf("%-24s %10.3fms (height %u)\n", "btree build (sorted)", bench_ms_since(start), built.height);
+
+    start = vd_hitime_get();
+    for (Vdusize i = 0; i < count; ++i) {
+        Vdu64 v = 0;
+        vd_btree_get_u64(&built, keys[(i * 2654435761ull) % count], &v);
+        sums[2] += v;
+    }
+    ms = bench_ms_since(start);
+    printf("%-24s %10.3fms%s\n", "btree get (built)", ms, sums[1] == sums[2] ? "" : "  (MISMATCH)");
+
+    VD_KVMAP BenchKV64 *map = 0;
+    VD_KVMAP_INIT(map, &arena, (Vdu32)(count + count / 2), 0);
+    start = vd_hitime_get();
+    for (Vdusize i = 0; i < count; ++i) {
+        Vdu64 v = i;
+        VD_KVMAP_SET(map, &keys[i], &v);
+    }
+    printf("%-24s %10.3fms\n", "kvmap insert", bench_ms_since(start));
+
+    start = vd_hitime_get();
+    for (Vdusize i = 0; i < count; ++i) {
+        Vdu64 v = 0;
+        VD_KVMAP_GET(map, &keys[(i * 2654435761ull) % count], &v);
+        sums[3] += v;
+    }
+    printf("%-24s %10.3fms%s\n", "kvmap get", bench_ms_since(start), sums[0] == sums[3] ? "" : "  (MISMATCH)");
+
+    // Short range scans: the next 64 keys after a random point
+    Vdusize num_ranges = count / 64;
+    Vdu64 range_btree = 0, range_array = 0;
+    start = vd_hitime_get();
+    for (Vdusize r = 0; r < num_ranges; ++r) {
+        VdBTreeIter it = vd_btree_lower_bound_u64(&built, keys[(r * 2654435761ull) % count]);
+        for (int n = 0; (n < 64) && vd_btree_iter_valid(&it); ++n, vd_btree_iter_next(&it)) {
+            range_btree += vd_btree_iter_value(&it);
+        }
+    }
+    printf("%-24s %10.3fms\n", "btree range x64", bench_ms_since(start));
+
+    start = vd_hitime_get();
+    for (Vdusize r = 0; r < num_ranges; ++r) {
+        Vdusize at = bench_lower_bound_u64(sorted, count, keys[(r * 2654435761ull) % count]);
+        for (int n = 0; (n < 64) && (at < count); ++n, ++at) range_array += at;
+    }
+    ms = bench_ms_since(start);
+    printf("%-24s %10.3fms%s\n", "array range x64", ms, range_btree == range_array ? "" : "  (MISMATCH)");
+
+    // Identifier-like strings that share long prefixes
+    Vdusize num_strs = count / 4;
+    VdStr *strs    = (VdStr*)malloc(num_strs * sizeof(VdStr));
+    VdStr *sorted_strs = (VdStr*)malloc(num_strs * sizeof(VdStr));
+    for (Vdusize i = 0; i < num_strs; ++i) {
+        char buf[64];
+        int n = snprintf(buf, sizeof(buf), "vd_module_%02u_identifier_%08x", bench_rand32() % 64, bench_rand32());
+        strs[i] = vd_str_dup(&arena, vd_str_from_cstr(buf));
+        VD_UNUSED(n);
+    }
+
+    printf("%-24s %10zu string keys\n", "", num_strs);
+    VdBTree stree;
+    vd_btree_init(&stree, &arena, VD_BTREE_KEY_STR);
+    start = vd_hitime_get();
+    for (Vdusize i = 0; i < num_strs; ++i) vd_btree_set_str(&stree, strs[i], i);
+    printf("%-24s %10.3fms\n", "btree insert", bench_ms_since(start));
+
+    VD_MEMSET(sums, 0, sizeof(sums));
+    start = vd_hitime_get();
+    for (Vdusize i = 0; i < num_strs; ++i) {
+        Vdu64 v = 0;
+        vd_btree_get_str(&stree, strs[(i * 2654435761ull) % num_strs], &v);
+        sums[0] += v;
+    }
+    printf("%-24s %10.3fms\n", "btree get", bench_ms_since(start));
+
+    memcpy(sorted_strs, strs, num_strs * sizeof(VdStr));
+    start = vd_hitime_get();
+    qsort(sorted_strs, num_strs, sizeof(VdStr), bench_qsort_cmp_str);
+    printf("%-24s %10.3fms\n", "qsort", bench_ms_since(start));
+
+    start = vd_hitime_get();
+    for (Vdusize i = 0; i < num_strs; ++i) {
+        sums[1] += bench_lower_bound_str(sorted_strs, num_strs, strs[(i * 2654435761ull) % num_strs]);
+    }
+    printf("%-24s %10.3fms\n", "binary search", bench_ms_since(start));
+
+    VD_STRMAP Vdu64 *smap = 0;
+    VD_STRMAP_INIT(smap, &arena, (Vdu32)(num_strs + num_strs / 2), 0);
+    start = vd_hitime_get();
+    for (Vdusize i = 0; i < num_strs; ++i) {
+        Vdu64 v = i;
+        VD_STRMAP_SET(smap, strs[i], &v);
+    }
+    printf("%-24s %10.3fms\n", "strmap insert", bench_ms_since(start));
+
+    start = vd_hitime_get();
+    for (Vdusize i = 0; i < num_strs; ++i) {
+        Vdu64 v = 0;
+        VD_STRMAP_GET(smap, strs[(i * 2654435761ull) % num_strs], &v);
+        sums[2] += v;
+    }
+    printf("%-24s %10.3fms%s\n", "strmap get", bench_ms_since(start), sums[0] == sums[2] ? "" : "  (MISMATCH)");
+
+    free(sorted_strs);
+    free(strs);
+    free(arena.buf);
+    free(sorted);
+    free(keys);
+}
+
+/* ----ART----------------------------------------------------------------------------------------------------------- */
+static VD_PROC_ART_VISIT(bench_art_count)
+{
+    *(Vdu64*)userdata += value;
+    VD_UNUSED(key);
+    return VD_TRUE;
+}
+
+static BENCH_PROC(bench_art)
+{
+    // Docs-index-like paths: ~100 bytes, most of them shared with thousands of other keys
+    Vdusize count = max_count;
+    VdArena keys_arena = vd_arena_from_malloc(count * 128);
+    VdStr *keys = (VdStr*)malloc(count * sizeof(VdStr));
+    for (Vdusize i = 0; i < count; ++i) {
+        char buf[128];
+        snprintf(buf, sizeof(buf), "site/docs/reference/api/vd/section_%02u/modules/strings/vd_function_identifier_%06u",
+                 bench_rand32() % 16, (Vdu32)i);
+        keys[i] = vd_str_dup(&keys_arena, vd_str_from_cstr(buf));
+    }
+
+    VdArena arena = vd_arena_from_malloc(count * 256 + VD_MEGABYTES(64));
+    Vdu64 sums[4] = {0};
+    VdHiTime start;
+
+    printf("%-24s %10zu keys, %zu bytes long\n", "", count, keys[0].len);
+
+    VdArt art;
+    vd_art_init(&art, &arena);
+    start = vd_hitime_get();
+    for (Vdusize i = 0; i < count; ++i) vd_art_set(&art, keys[i], i);
+    printf("%-24s %10.3fms (%.1fMB)\n", "art insert", bench_ms_since(start), arena.curr_offset / (1024.0 * 1024.0));
+
+    start = vd_hitime_get();
+    for (Vdusize i = 0; i < count; ++i) {
+        Vdu64 v = 0;
+        vd_art_get(&art, keys[(i * 2654435761ull) % count], &v);
+        sums[0] += v;
+    }
+    printf("%-24s %10.3fms\n", "art get", bench_ms_since(start));
+
+    Vdusize strmap_start = arena.curr_offset;
+    VD_STRMAP Vdu64 *smap = 0;
+    VD_STRMAP_INIT(smap, &arena, (Vdu32)(count + count / 2), 0);
+    start = vd_hitime_get();
+    for (Vdusize i = 0; i < count; ++i) {
+        Vdu64 v = i;
+        VD_STRMAP_SET(smap, keys[i], &v);
+    }
+    printf("%-24s %10.3fms (%.1fMB)\n", "strmap insert", bench_ms_since(start),
+           (arena.curr_offset - strmap_start) / (1024.0 * 1024.0));
+
+    start = vd_hitime_get();
+    for (Vdusize i = 0; i < count; ++i) {
+        Vdu64 v = 0;
+        VD_STRMAP_GET(smap, keys[(i * 2654435761ull) % count], &v);
+        sums[1] += v;
+    }
+    printf("%-24s %10.3fms%s\n", "strmap get", bench_ms_since(start), sums[0] == sums[1] ? "" : "  (MISMATCH)");
+
+    // Longest stored prefix of a key with something appended, as when resolving a path to its page
+    start = vd_hitime_get();
+    for (Vdusize i = 0; i < count; ++i) {
+        char buf[192];
+        VdStr key = keys[(i * 2654435761ull) % count];
+        VD_MEMCPY(buf, key.s, key.len);
+        VD_MEMCPY(buf + key.len, "#params", 7);
+        VdStr query = { buf, key.len + 7 };
+        Vdu64 v = 0;
+        vd_art_longest_prefix(&art, query, 0, &v);
+        sums[2] += v;
+    }
+    printf("%-24s %10.3fms%s\n", "art longest prefix", bench_ms_since(start), sums[0] == sums[2] ? "" : "  (MISMATCH)");
+
+    // Completion: every key under a 4-digit identifier prefix in one section (~6 keys each)
+    Vdusize num_prefixes = count / 10, visited = 0;
+    start = vd_hitime_get();
+    for (Vdusize i = 0; i < num_prefixes; ++i) {
+        VdStr key    = keys[(i * 2654435761ull) % count];
+        VdStr prefix = { key.s, key.len - 2 };
+        visited += vd_art_visit_prefix(&art, prefix, bench_art_count, &sums[3]);
+    }
+    printf("%-24s %10.3fms (%zu prefixes, %zu keys)\n", "art prefix visit", bench_ms_since(start),
+           num_prefixes, visited);
+
+    free(arena.buf);
+    free(keys);
+    free(keys_arena.buf);
+}
+
+/* ----FIBER--------------------------------------------------------------------------------------------------------- */
+#if VD_FIBER_SUPPORTED
+static VD_PROC_FIBER(bench_fiber_ping)
+{
+    VD_UNUSED(userdata);
+    for (;;) vd_fiber_yield(fiber);
+}
+
+static VD_PROC_FIBER(bench_fiber_step)
+{
+    Vdu64 *total = (Vdu64*)userdata;
+    for (int i = 0; i < 4; ++i) {
+        *total += (Vdu64)(Vduptr)fiber & 0xFF;
+        vd_fiber_yield(0);
+    }
+}
+
+static BENCH_PROC(bench_fiber)
+{
+    Vdusize count = max_count;
+
+    VdFiber *ping = vd_fiber_create(bench_fiber_ping, 0, 0);
+    VdHiTime start = vd_hitime_get();
+    for (Vdusize i = 0; i < count; ++i) vd_fiber_resume(ping, 0);
+    Vdf64 ms = bench_ms_since(start);
+    printf("%-24s %10.3fms (%.2f ns per resume + yield)\n", "switch", ms, ms * 1e6 / count);
+    vd_fiber_destroy(ping);
+
+    // Many small fibers alive at once, each stepped round-robin like a scheduler would
+    Vdusize num_fibers = 100000;
+    Vdusize stack_size = VD_KILOBYTES(4);
+    VdArena arena = vd_arena_from_malloc(num_fibers * (stack_size + sizeof(VdFiber) + 64) + VD_MEGABYTES(1));
+    VdFiber **fibers = VD_ARENA_PUSH_ARRAY(&arena, VdFiber*, num_fibers);
+    Vdu64 total = 0;
+
+    start = vd_hitime_get();
+    for (Vdusize i = 0; i < num_fibers; ++i) {
+        fibers[i] = vd_fiber_create_arena(&arena, bench_fiber_step, &total, stack_size);
+    }
+    ms = bench_ms_since(start);
+    printf("%-24s %10.3fms (%zu fibers, %.1f MB)\n", "create", ms, num_fibers, arena.curr_offset / (1024.0 * 1024.0));
+
+    start = vd_hitime_get();
+    Vdusize switches = 0;
+    for (Vdb32 any = VD_TRUE; any;) {
+        any = VD_FALSE;
+        for (Vdusize i = 0; i < num_fibers; ++i) {
+            if (vd_fiber_get_state(fibers[i]) == VD_FIBER_STATE_DONE) continue;
+            vd_fiber_resume(fibers[i], 0);
+            switches++;
+            any = VD_TRUE;
+        }
+    }
+    ms = bench_ms_since(start);
+    printf("%-24s %10.3fms (%.2f ns per resume + yield, %llx)\n", "round-robin", ms, ms * 1e6 / switches,
+           (unsigned long long)total);
+
+    free(arena.buf);
+}
+#else
+static BENCH_PROC(bench_fiber)
+{
+    VD_UNUSED(max_count);
+    printf("fibers are not supported on this platform\n");
+}
+#endif // VD_FIBER_SUPPORTED
+
+/* ----ASYNC IO------------------------------------------------------------------------------------------------------ */
+#if VD_PLATFORM_WINDOWS
+#include <direct.h>
+#define bench_mkdir(path) _mkdir(path)
+#define bench_rmdir(path) _rmdir(path)
+#else
+#include <sys/stat.h>
+#include <unistd.h>
+#define bench_mkdir(path) mkdir(path, 0755)
+#define bench_rmdir(path) rmdir(path)
+#endif // VD_PLATFORM_WINDOWS, else
+
+static void bench_aio_run(const char *name, VdAio *aio, Vdcstr *paths, Vdusize count, Vdusize total)
+{
+    VdArena arena = vd_arena_from_malloc(total + count * 16 + VD_MEGABYTES(1));
+    VdAioFileData *files = (VdAioFileData*)malloc(sizeof(VdAioFileData) * count);
+    const char *backend = vd_aio_get_backend(aio) == VD_AIO_BACKEND_IO_URING ? "io_uring" : "threads";
+    Vdb32 registered = vd_aio_register_buffer(aio, arena.buf, arena.buf_len);
+
+    VdHiTime start = vd_hitime_get();
+    Vdusize loaded = vd_aio_read_files(aio, &arena, paths, count, files);
+    Vdf64 ms = bench_ms_since(start);
+    printf("%-24s %10.3fms (%s%s, %zu/%zu files)\n", name, ms, backend, registered ? ", registered" : "", loaded,
+           count);
+
+    vd_aio_register_buffer(aio, 0, 0);
+    free(files);
+    free(arena.buf);
+}
+
+static BENCH_PROC(bench_aio)
+{
+    Vdusize count = max_count;
+    const char *dir = "bench_aio_files";
+    bench_mkdir(dir);
+
+    char   *names = (char*)malloc(count * 40);
+    Vdcstr *paths = (Vdcstr*)malloc(sizeof(Vdcstr) * count);
+    Vdu8   buf[4096];
+    Vdusize total = 0;
+    for (Vdusize i = 0; i < sizeof(buf); ++i) buf[i] = (Vdu8)bench_rand32();
+    for (Vdusize i = 0; i < count; ++i) {
+        char *name = names + i * 40;
+        snprintf(name, 40, "%s/%06zu.bin", dir, i);
+        paths[i] = name;
+
+        Vdusize size = 256 + bench_rand32() % (sizeof(buf) - 256);
+        FILE *f = fopen(name, "wb");
+        fwrite(buf, 1, size, f);
+        fclose(f);
+        total += size;
+    }
+    printf("%-24s %10zu files, %.1f MB\n", "small files", count, total / (1024.0 * 1024.0));
+
+    // One open, seek, read and close after another
+    VdArena arena = vd_arena_from_malloc(total + count * 16 + VD_MEGABYTES(1));
+    VdHiTime start = vd_hitime_get();
+    for (Vdusize i = 0; i < count; ++i) {
+        Vdusize len;
+        vd_dump_file_to_bytes(&arena, paths[i], &len);
+    }
+    Vdf64 ms = bench_ms_since(start);
+    printf("%-24s %10.3fms\n", "vd_dump_file_to_bytes", ms);
+    free(arena.buf);
+
+    VdAioInitInfo info = {0};
+    info.queue_depth = 1024;
+    VdAio *aio = vd_aio_create(&info);
+    bench_aio_run("vd_aio_read_files", aio, paths, count, total);
+    vd_aio_destroy(aio);
+
+    info.force_threads = VD_TRUE;
+    aio = vd_aio_create(&info);
+    bench_aio_run("vd_aio_read_files", aio, paths, count, total);
+    vd_aio_destroy(aio);
+
+    for (Vdusize i = 0; i < count; ++i) remove(paths[i]);
+    bench_rmdir(dir);
+    free(paths);
+    free(names);
+}
+
+/* ----DEBUG--------------------------------------------------------------------------------------------------------- */
+static BENCH_PROC(bench_debug)
+{
+    // Two zones per iteration, and few enough per frame that none are dropped
+    Vdusize per_frame  = VD_DEBUG_MAX_ZONES / 4;
+    Vdusize num_frames = max_count / (2 * per_frame);
+    Vdusize count      = num_frames * per_frame * 2;
+    volatile Vdu64 sink = 0;
+
+    VD_DEBUG_INIT();
+    Vdf64 zone_ms = 0.0, frame_ms = 0.0;
+    for (Vdusize f = 0; f < num_frames; ++f) {
+        VD_DEBUG_FRAME_BEGIN();
+        VdHiTime start = vd_hitime_get();
+        for (Vdusize i = 0; i < per_frame; ++i) {
+            VD_DEBUG_ZONE_BEGIN(outer);
+            VD_DEBUG_ZONE_BEGIN(inner);
+            sink += i;
+            VD_DEBUG_ZONE_END(inner);
+            VD_DEBUG_ZONE_END(outer);
+        }
+        zone_ms += bench_ms_since(start);
+
+        start = vd_hitime_get();
+        VD_DEBUG_FRAME_END();
+        frame_ms += bench_ms_since(start);
+    }
+
+    printf("%-24s %10.3fms (%.2f ns per zone, %zu bytes per zone)\n", "zone begin + end", zone_ms,
+           zone_ms * 1e6 / count, sizeof(VdDebugZone));
+    printf("%-24s %10.3fms (%.2f ns per zone)\n", "frame end", frame_ms, frame_ms * 1e6 / count);
+}
+
+static BENCH_PROC(bench_debug_ui)
+{
+    // A full history of frames with more zones than the flame graph has pixels
+    Vdusize per_frame = VD_DEBUG_MAX_ZONES / 4;
+    volatile Vdu64 sink = 0;
+
+    VD_DEBUG_INIT();
+    for (Vdusize f = 0; f < VD_DEBUG_MAX_FRAMES; ++f) {
+        VD_DEBUG_FRAME_BEGIN();
+        for (Vdusize i = 0; i < per_frame; ++i) {
+            VD_DEBUG_ZONE_BEGIN(parent);
+            for (int j = 0; j < 3; ++j) {
+                VD_DEBUG_ZONE_BEGIN(child);
+                sink += i * j;
+                VD_DEBUG_ZONE_END(child);
+            }
+            VD_DEBUG_ZONE_END(parent);
+        }
+        VD_DEBUG_FRAME_END();
+    }
+
+    vd_ui_init();
+    vd_ui_event_size(1920.f, 1080.f);
+
+    VdDebugUiPanel panel = {0};
+    Vdf64 panel_ms = 0.0, draw_ms = 0.0;
+    for (Vdusize i = 0; i < max_count; ++i) {
+        vd_ui_frame_begin(1.f / 60.f);
+        VdHiTime start = vd_hitime_get();
+        vd_debug_ui_panel(&panel);
+        panel_ms += bench_ms_since(start);
+        vd_ui_frame_end();
+
+        vd_ui_render_begin();
+        start = vd_hitime_get();
+        vd_debug_ui_panel_draw(&panel);
+        draw_ms += bench_ms_since(start);
+        vd_ui_render_end();
+    }
+
+    printf("%-24s %10.3fms (%.3f ms per frame)\n", "panel", panel_ms, panel_ms / max_count);
+    printf("%-24s %10.3fms (%.3f ms per frame, %u zones in %u quads)\n", "panel draw", draw_ms, draw_ms / max_count,
+           panel.num_zones_drawn, panel.num_quads);
+    vd_debug_ui_panel_destroy(&panel);
+}
+
+/* ----UI----------------------------------------------------------------------------------------------------------- */
+static BENCH_PROC(bench_ui_frame_end)
+{
+    // max_count glyphs, in labels of 250 each; every one of them ends up in the vertex buffer
+    enum { GLYPHS_PER_LABEL = 250, NUM_FRAMES = 20 };
+    char text[GLYPHS_PER_LABEL + 1];
+    for (int i = 0; i < GLYPHS_PER_LABEL; ++i) text[i] = (char)('a' + i % 26);
+    text[GLYPHS_PER_LABEL] = 0;
+
+    Vdusize num_labels = max_count / GLYPHS_PER_LABEL;
+
+    vd_ui_init();
+    vd_ui_event_size(8192.f, 32768.f);
+
+    Vdf64 frame_end_ms = 0.0;
+    for (int f = 0; f < NUM_FRAMES; ++f) {
+        vd_ui_frame_begin(1.f / 60.f);
+        for (Vdusize i = 0; i < num_labels; ++i) {
+            vd_ui_labelf("%s##label%d", text, (int)i);
+        }
+
+        VdHiTime start = vd_hitime_get();
+        vd_ui_frame_end();
+        frame_end_ms += bench_ms_since(start);
+    }
+
+    size_t buffer_size;
+    unsigned int num_passes;
+    vd_ui_frame_get_vertex_buffer(&buffer_size);
+    vd_ui_frame_get_render_passes(&num_passes);
+
+    printf("%-24s %10.3fms (%.3f ms per frame, %zu vertices, %u passes, %zu bytes)\n", "frame end", frame_end_ms,
+           frame_end_ms / NUM_FRAMES, buffer_size / sizeof(VdUiVertex), num_passes, vd_ui_get_min_vertex_buffer_size());
+}
+
+static void bench_ui__cells(Vdusize num_cells, Vdusize frame, Vdusize churn_every)
+{
+    enum { CELLS_PER_ROW = 250 };
+    for (Vdusize r = 0; r * CELLS_PER_ROW < num_cells; ++r) {
+        VdUiDiv *row = vd_ui_div_newf(VD_UI_FLAG_FLEX_HORIZONTAL, "##row%d", (int)r);
+        row->size[0].mode = VD_UI_SIZE_MODE_CONTAIN_CHILDREN;
+        row->size[1].mode = VD_UI_SIZE_MODE_CONTAIN_CHILDREN;
+        vd_ui_parent_push(row);
+
+        for (Vdusize c = r * CELLS_PER_ROW; (c < num_cells) && (c < (r + 1) * CELLS_PER_ROW); ++c) {
+            // Every churn_every'th cell gets an id nobody has seen before, so its div lives for exactly one frame
+            VdUiDiv *cell = (churn_every && (c % churn_every) == 0)
+                ? vd_ui_div_newf(VD_UI_FLAG_BACKGROUND, "##t%d_%d", (int)frame, (int)c)
+                : vd_ui_div_newf(VD_UI_FLAG_BACKGROUND, "##c%d", (int)c);
+            cell->size[0].mode  = VD_UI_SIZE_MODE_ABSOLUTE;
+            cell->size[0].value = 8.f;
+            cell->size[1].mode  = VD_UI_SIZE_MODE_ABSOLUTE;
+            cell->size[1].value = 8.f;
+        }
+
+        vd_ui_parent_pop();
+    }
+}
+
+static BENCH_PROC(bench_ui_churn)
+{
+    // max_count persistent widgets; then the same tree with 1 in 10 widgets replaced every frame
+    enum { NUM_FRAMES = 20, CHURN_EVERY = 10 };
+
+    vd_ui_init();
+    vd_ui_event_size(8192.f, 32768.f);
+
+    for (int pass = 0; pass < 2; ++pass) {
+        Vdusize churn_every = pass ? CHURN_EVERY : 0;
+        Vdf64   frame_ms    = 0.0;
+        for (Vdusize f = 0; f < NUM_FRAMES; ++f) {
+            VdHiTime start = vd_hitime_get();
+            vd_ui_frame_begin(1.f / 60.f);
+            bench_ui__cells(max_count, f, churn_every);
+            vd_ui_frame_end();
+            frame_ms += bench_ms_since(start);
+        }
+
+        size_t buffer_size;
+        vd_ui_frame_get_vertex_buffer(&buffer_size);
+        printf("%-24s %10.3fms (%.3f ms per frame, %zu widgets, %zu transient, %zu vertices)\n",
+               pass ? "churn" : "steady", frame_ms, frame_ms / NUM_FRAMES, (size_t)max_count,
+               churn_every ? (size_t)(max_count / churn_every) : 0, buffer_size / sizeof(VdUiVertex));
+    }
+}
+
+static BENCH_PROC(bench_ui_layout)
+{
+    // max_count divs in rows of text cells. 1 in 100 cells changes its text every frame, either scattered (one
+    // cell in every row) or clustered (every cell in 1 in 100 rows)
+    enum { CELLS_PER_ROW = 100, NUM_FRAMES = 20, CHANGE_EVERY = 100 };
+    static const char *names[] = {
+        "full, scattered", "incremental, scattered", "full, clustered", "incremental, clustered",
+    };
+
+    Vdusize num_rows = max_count / (CELLS_PER_ROW + 1);
+
+    vd_ui_init();
+    vd_ui_event_size(8192.f, 32768.f);
+
+    for (int pass = 0; pass < 4; ++pass) {
+        int clustered = pass >= 2;
+        vd_ui_debug_set_full_layout_on((pass % 2) == 0);
+
+        Vdf64 frame_end_ms = 0.0;
+        for (Vdusize f = 0; f < NUM_FRAMES + 1; ++f) {
+            vd_ui_frame_begin(1.f / 60.f);
+            for (Vdusize r = 0; r < num_rows; ++r) {
+                VdUiDiv *row = vd_ui_div_newf(VD_UI_FLAG_FLEX_HORIZONTAL, "##row%d", (int)r);
+                row->size[0].mode = VD_UI_SIZE_MODE_CONTAIN_CHILDREN;
+                row->size[1].mode = VD_UI_SIZE_MODE_CONTAIN_CHILDREN;
+                vd_ui_parent_push(row);
+
+                for (Vdusize c = 0; c < CELLS_PER_ROW; ++c) {
+                    Vdusize i       = clustered ? r : r * CELLS_PER_ROW + c;
+                    int     value   = ((i + f) % CHANGE_EVERY) == 0 ? (int)f : 0;
+                    VdUiDiv *cell   = vd_ui_div_newf(VD_UI_FLAG_TEXT, "%d##c%d", value, (int)c);
+                    cell->size[0].mode = VD_UI_SIZE_MODE_TEXT_CONTENT;
+                    cell->size[1].mode = VD_UI_SIZE_MODE_TEXT_CONTENT;
+                }
+
+                vd_ui_parent_pop();
+            }
+
+            // The first frame lays everything out either way
+            VdHiTime start = vd_hitime_get();
+            vd_ui_frame_end();
+            if (f > 0) frame_end_ms += bench_ms_since(start);
+        }
+
+        printf("%-24s %10.3fms (%.3f ms per frame, %zu divs, %u laid out)\n", names[pass], frame_end_ms,
+               frame_end_ms / NUM_FRAMES, (size_t)(num_rows * (CELLS_PER_ROW + 1)),
+               vd_ui_context_get()->num_divs_laid_out);
+    }
+}
+
+static BENCH_PROC(bench_ui_text)
+{
+    // max_count labels, whose text either stays the same or changes every frame
+    enum { NUM_FRAMES = 20 };
+
+    vd_ui_init();
+    vd_ui_event_size(8192.f, 32768.f);
+
+    for (int pass = 0; pass < 2; ++pass) {
+        Vdf64 frame_end_ms = 0.0;
+        for (Vdusize f = 0; f < NUM_FRAMES + 1; ++f) {
+            vd_ui_frame_begin(1.f / 60.f);
+            for (Vdusize i = 0; i < max_count; ++i) {
+                vd_ui_labelf("Label number %d, %d##label%d", (int)i, pass ? (int)f : 0, (int)i);
+            }
+
+            VdHiTime start = vd_hitime_get();
+            vd_ui_frame_end();
+            if (f > 0) frame_end_ms += bench_ms_since(start);
+        }
+
+        VdUiContext *ctx = vd_ui_context_get();
+        printf("%-24s %10.3fms (%.3f ms per frame, %u/%u text cache hits)\n", pass ? "changing" : "steady",
+               frame_end_ms, frame_end_ms / NUM_FRAMES, ctx->text_hits, ctx->text_lookups);
+    }
+}
+
+static Bench Benches[] = {
+    { "sort",           bench_sort,           10000000  },
+    { "bitset",         bench_bitset,         100000000 },
+    { "map_image",      bench_map_image,      1000000   },
+    { "arena_snapshot", bench_arena_snapshot, 1000000   },
+    { "utf8",           bench_utf8,           100000000 },
+    { "lz",             bench_lz,             100000000 },
+    { "crc",            bench_crc,            100000000 },
+    { "btree",          bench_btree,          1000000   },
+    { "art",            bench_art,            100000    },
+    { "fiber",          bench_fiber,          10000000  },
+    { "aio",            bench_aio,            50000     },
+    { "debug",          bench_debug,          10000000  },
+    { "debug_ui",       bench_debug_ui,       1000      },
+    { "ui_frame_end",   bench_ui_frame_end,   100000    },
+    { "ui_churn",       bench_ui_churn,       100000    },
+    { "ui_layout",      bench_ui_layout,      50000     },
+    { "ui_text",        bench_ui_text,        10000     },
+};
+
+int main(int argc, char const *argv[])
+{
+    if ((argc > 1) && (strcmp(argv[1], "-h") == 0)) {
+        fprintf(stderr, "Invocation: bench [name|all] [max_count]\nBenchmarks:");
+        for (Vdusize i = 0; i < VD_ARRAY_COUNT(Benches); ++i) fprintf(stderr, " %s", Benches[i].name);
+        fprintf(stderr, "\n");
+        return 0;
+    }
+
+    const char *which     = argc > 1 ? argv[1] : "all";
+    Vdusize     max_count = argc > 2 ? (Vdusize)strtoull(argv[2], 0, 10) : 0;
+
+    vd_init(0);
+
+    for (Vdusize i = 0; i < VD_ARRAY_COUNT(Benches); ++i) {
+        if ((strcmp(which, "all") != 0) && (strcmp(which, Benches[i].name) != 0)) continue;
+
+        printf("---- %s ----\n", Benches[i].name);
+        Benches[i].proc(max_count ? max_count : Benches[i].default_max_count);
+    }
+
+    return 0;
+}
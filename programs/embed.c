@@ -28,18 +28,24 @@
  * ---------------------------------------------------------------------------------------------------------------------
  */
 
+#define VD_USE_CRT 1
+#define VD_IMPL
+#include "vd.h"
+
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 int main(int argc, char const *argv[])
 {
     if (argc < 3) {
-        fprintf(stderr, "Invocation: <program name> file_to_embed identifier");
+        fprintf(stderr, "Invocation: <program name> file_to_embed identifier <?-lz>");
         return -1;
     }
 
     const char *file_to_read = argv[1];
     const char *name = argv[2];
+    int compress = (argc >= 4) && (strcmp(argv[3], "-lz") == 0);
 
     size_t newline_per_byte = 32;
 
@@ -52,7 +58,18 @@ int main(int argc, char const *argv[])
     fread(result, size, 1, f);
     fclose(f);
 
-    printf("static unsigned char %s[%llu] = {\n", name, size);
+    if (compress) {
+        // Emit an LZ frame instead; decompress at startup with vd_lz_frame_decompress_arena.
+        size_t raw_size = size;
+        unsigned char *packed = (unsigned char*)malloc(vd_lz_frame_bound(raw_size));
+        size = vd_lz_frame_compress(result, raw_size, packed, vd_lz_frame_bound(raw_size));
+        free(result);
+        result = packed;
+
+        printf("// LZ frame, %llu bytes uncompressed\n", (unsigned long long)raw_size);
+    }
+
+    printf("static unsigned char %s[%llu] = {\n", name, (unsigned long long)size);
 
     for (size_t i = 0; i < size; ++i) {
         printf("0x%02x", result[i]);
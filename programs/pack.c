@@ -0,0 +1,145 @@
+/**
+ * pack.c - Builds a vd.h pack (see PACK in vd.h) from a directory by Michael Dodis <michaeldodisgr@gmail.com>
+ * ---------------------------------------------------------------------------------------------------------------------
+ * This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <https://unlicense.org/>
+ * ---------------------------------------------------------------------------------------------------------------------
+ */
+
+#define VD_USE_CRT 1
+#define VD_IMPL
+#include "vd.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    const char   *root;
+    VdArena      *names;
+    VdPackSource *sources;
+    VdFileMap    *maps;
+    Vdu32        count;
+    Vdu32        cap;
+    Vdusize      total_size;
+    Vdusize      total_name_len;
+} Packer;
+
+static void visit_file(VdFile *file, void *userdata)
+{
+    Packer *p = (Packer*)userdata;
+    if (p->count == p->cap) {
+        p->cap     = p->cap ? p->cap * 2 : 256;
+        p->sources = (VdPackSource*)realloc(p->sources, sizeof(VdPackSource) * p->cap);
+        p->maps    = (VdFileMap*)realloc(p->maps, sizeof(VdFileMap) * p->cap);
+    }
+
+    // Names are relative to the root, with forward slashes on every platform
+    VdStr name = vd_str_dup(p->names, file->name);
+    for (Vdusize i = 0; i < name.len; ++i) {
+        if (name.s[i] == '\\') name.s[i] = '/';
+    }
+
+    size_t root_len = strlen(p->root);
+    char *path = (char*)vd_arena_alloc(p->names, root_len + name.len + 2);
+    memcpy(path, p->root, root_len);
+    path[root_len] = '/';
+    memcpy(path + root_len + 1, name.s, name.len);
+    path[root_len + 1 + name.len] = 0;
+
+    VdFileMap    *map    = &p->maps[p->count];
+    VdPackSource *source = &p->sources[p->count];
+    source->name = name;
+    source->data = 0;
+    source->size = 0;
+
+    // Empty files can't be mapped, but still get an entry
+    if (vd_file_map_open(map, path)) {
+        source->data = map->data;
+        source->size = map->size;
+    }
+
+    p->total_size     += source->size;
+    p->total_name_len += name.len;
+    p->count++;
+}
+
+int main(int argc, char const *argv[])
+{
+    if (argc < 3) {
+        fprintf(stderr, "Invocation: <program name> directory output_pack <?-lz> <?-checksums> <?-j num_threads>\n");
+        return -1;
+    }
+
+    VdPackBuildFlags flags       = 0;
+    Vdu32            num_threads = 0;
+    for (int i = 3; i < argc; ++i) {
+        if (strcmp(argv[i], "-lz") == 0) {
+            flags |= VD_PACK_BUILD_COMPRESS;
+        } else if (strcmp(argv[i], "-checksums") == 0) {
+            flags |= VD_PACK_BUILD_CHECKSUMS;
+        } else if ((strcmp(argv[i], "-j") == 0) && (i + 1 < argc)) {
+            num_threads = (Vdu32)atoi(argv[++i]);
+        } else {
+            fprintf(stderr, "Unknown option %s\n", argv[i]);
+            return -1;
+        }
+    }
+
+    VdArena names = vd_arena_from_malloc(VD_MEGABYTES(64));
+
+    Packer p = {0};
+    p.root  = argv[1];
+    p.names = &names;
+    vd_directory_walk_recursively(argv[1], visit_file, &p);
+
+    // Sized for the worst case: every entry stored, plus alignment, frame and directory overhead
+    Vdusize overhead = (Vdusize)p.count * 512 + p.total_name_len * 2 + VD_MEGABYTES(1);
+    VdArena output   = vd_arena_from_malloc(p.total_size + overhead);
+    VdArena scratch  = vd_arena_from_malloc(p.total_size + overhead);
+
+    Vdusize size  = 0;
+    void    *pack = vd_pack_build(&output, &scratch, p.sources, p.count, flags, num_threads, &size);
+    if (pack == 0) {
+        fprintf(stderr, "Failed to build the pack (duplicate names?)\n");
+        return -1;
+    }
+
+    FILE *f = fopen(argv[2], "wb");
+    if ((f == 0) || (fwrite(pack, size, 1, f) != 1)) {
+        fprintf(stderr, "Failed to write %s\n", argv[2]);
+        return -1;
+    }
+    fclose(f);
+
+    printf("%u entries, %llu bytes -> %llu bytes\n", p.count, (unsigned long long)p.total_size,
+           (unsigned long long)size);
+
+    for (Vdu32 i = 0; i < p.count; ++i) {
+        if (p.sources[i].size > 0) vd_file_map_close(&p.maps[i]);
+    }
+
+    return 0;
+}
@@ -27,14 +27,42 @@
  * For more information, please refer to <https://unlicense.org/>
  * ---------------------------------------------------------------------------------------------------------------------
  */
+#define VD_USE_CRT 1
+#define VD_IMPL
+#include "vd.h"
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+static int embed_compressed(const char *name, const char *data, size_t size)
+{
+    size_t cap = vd_lz_frame_bound(size);
+    unsigned char *packed = (unsigned char*)malloc(cap);
+    size_t packed_size = vd_lz_frame_compress(data, size, packed, cap);
+
+    // The literal holds an LZ frame; decompress with vd_lz_frame_decompress_arena(a, name, name##_SIZE, 0).
+    printf("#define %s_SIZE %llu\n", name, (unsigned long long)packed_size);
+    printf("#define %s \\\n", name);
+
+    size_t bytes_per_line = 32;
+    for (size_t i = 0; i < packed_size; i += bytes_per_line) {
+        printf("\"");
+        for (size_t j = i; (j < packed_size) && (j < (i + bytes_per_line)); ++j) {
+            printf("\\%03o", packed[j]);
+        }
+        printf("\"");
+        printf(((i + bytes_per_line) < packed_size) ? " \\\n" : "\n");
+    }
+
+    free(packed);
+    return 0;
+}
+
 int main(int argc, char const *argv[])
 {
     if (argc < 3) {
-        fprintf(stderr, "Invocation: <program name> file_to_embed identifier <?min_len>");
+        fprintf(stderr, "Invocation: <program name> file_to_embed identifier <?min_len|-lz>");
         return -1;
     }
 
@@ -42,9 +70,14 @@ int main(int argc, char const *argv[])
     const char *name = argv[2];
 
     int min_len = 0;
+    int compress = 0;
 
     if (argc >= 4) {
-        min_len = atoi(argv[3]);
+        if (strcmp(argv[3], "-lz") == 0) {
+            compress = 1;
+        } else {
+            min_len = atoi(argv[3]);
+        }
     }
 
     int max_line_len = 0;
@@ -59,6 +92,10 @@ int main(int argc, char const *argv[])
 
     result[size] = 0;
 
+    if (compress) {
+        return embed_compressed(name, result, size);
+    }
+
     // Measure max line
     size_t i = 0;
     int curr_line = 0;
@@ -5,10 +5,13 @@
 #define VD_INCLUDE_INTERNAL_TESTS 0
 #define VD_CG_INCLUDE_INTERNAL_TESTS 1
 #define VD_CG_INTERNAL_TESTS_VERBOSE 1
+#define VD_DEBUG_ENABLE 1
+#define VD_DEBUG_INCLUDE_INTERNAL_TESTS 1
 
 #include "vd.h"
 #include "vd_inix.h"
 #include "vd_cg.h"
+#include "vd_debug.h"
 
 int main(int argc, char const *argv[])
 {
@@ -20,3 +23,6 @@ int main(int argc, char const *argv[])
 
 #define VD_CG_IMPL
 #include "vd_cg.h"
+
+#define VD_DEBUG_IMPL
+#include "vd_debug.h"
@@ -316,13 +316,15 @@ int main(int argc, char const *argv[])
     glEnable(GL_BLEND);
 
     GLuint ui_vao, ui_vbo;
+    size_t ui_vbo_size;
     {
         glGenVertexArrays(1, &ui_vao);
         glBindVertexArray(ui_vao);
 
         glGenBuffers(1, &ui_vbo);
         glBindBuffer(GL_ARRAY_BUFFER, ui_vbo);
-        glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)vd_ui_get_min_vertex_buffer_size(), 0, GL_DYNAMIC_DRAW);
+        ui_vbo_size = vd_ui_get_min_vertex_buffer_size();
+        glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)ui_vbo_size, 0, GL_DYNAMIC_DRAW);
 
         for (int i = 0; i < vd_ui_gl_get_num_attributes(); ++i) {
             GLint size;
@@ -589,6 +591,14 @@ int main(int argc, char const *argv[])
         size_t buffer_size;
         void *buffer = vd_ui_frame_get_vertex_buffer(&buffer_size);
 
+        // The vertex buffer grows with the ui, so grow the vbo along with it
+        if (buffer_size > ui_vbo_size) {
+            ui_vbo_size = buffer_size;
+            glBindBuffer(GL_ARRAY_BUFFER, ui_vbo);
+            glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)ui_vbo_size, 0, GL_DYNAMIC_DRAW);
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+        }
+
         // Get render passes
         unsigned int num_passes;
         VdUiRenderPass *passes = vd_ui_frame_get_render_passes(&num_passes);
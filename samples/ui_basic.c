@@ -49,7 +49,8 @@ int main(int argc, char const *argv[])
     GLuint vbo;
     glGenBuffers(1, &vbo);
     glBindBuffer(GL_ARRAY_BUFFER, vbo);
-    glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)vd_ui_get_min_vertex_buffer_size(), 0, GL_DYNAMIC_DRAW);
+    size_t vbo_size = vd_ui_get_min_vertex_buffer_size();
+    glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)vbo_size, 0, GL_DYNAMIC_DRAW);
 
     for (int i = 0; i < vd_ui_gl_get_num_attributes(); ++i) {
         GLint size;
@@ -214,6 +215,14 @@ int main(int argc, char const *argv[])
         size_t buffer_size;
         void *buffer = vd_ui_frame_get_vertex_buffer(&buffer_size);
 
+        // The vertex buffer grows with the ui, so grow the vbo along with it
+        if (buffer_size > vbo_size) {
+            vbo_size = buffer_size;
+            glBindBuffer(GL_ARRAY_BUFFER, vbo);
+            glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)vbo_size, 0, GL_DYNAMIC_DRAW);
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+        }
+
         // Get render passes
         unsigned int num_passes;
         VdUiRenderPass *passes = vd_ui_frame_get_render_passes(&num_passes);
@@ -227,6 +227,15 @@ typedef int32_t       Vdb32;
  */
 #define VD_INTERNAL static
 
+/**
+ * @brief Hints that the cache line holding p will be read soon.
+ */
+#if VD_HOST_COMPILER_CLANG
+#define VD_PREFETCH(p) __builtin_prefetch(p)
+#else
+#define VD_PREFETCH(p) ((void)(p))
+#endif // VD_HOST_COMPILER_CLANG
+
 /* ----LIMITS-------------------------------------------------------------------------------------------------------- */
 #define VD_U8_MAX    UINT8_MAX
 #define VD_U16_MAX   UINT16_MAX
@@ -497,6 +506,159 @@ void        vd_vm_release(void *addr, Vdusize len);
 #endif // VD_PLATFORM_KNOWN
 #endif // VD_INCLUDE_PLATFORM_SPECIFIC_FUNCTIONALITY
 
+/* ----ATOMICS------------------------------------------------------------------------------------------------------- */
+#if VD_HOST_COMPILER_MSVC
+#include <intrin.h>
+#define VD_THREAD_LOCAL __declspec(thread)
+#elif VD_HOST_COMPILER_CLANG
+#define VD_THREAD_LOCAL __thread
+#else
+#define VD_THREAD_LOCAL _Thread_local
+#endif // VD_HOST_COMPILER_MSVC, VD_HOST_COMPILER_CLANG, else
+
+/**
+ * @brief Loads are acquire, stores are release, read-modify-write operations are sequentially consistent.
+ */
+static VD_INLINE Vdu32 vd_atomic_load_u32(volatile Vdu32 *p);
+static VD_INLINE void  vd_atomic_store_u32(volatile Vdu32 *p, Vdu32 v);
+static VD_INLINE Vdu32 vd_atomic_fetch_add_u32(volatile Vdu32 *p, Vdu32 v);
+static VD_INLINE Vdb32 vd_atomic_cas_u32(volatile Vdu32 *p, Vdu32 expected, Vdu32 desired);
+static VD_INLINE Vdu64 vd_atomic_load_u64(volatile Vdu64 *p);
+static VD_INLINE void  vd_atomic_store_u64(volatile Vdu64 *p, Vdu64 v);
+static VD_INLINE Vdu64 vd_atomic_fetch_add_u64(volatile Vdu64 *p, Vdu64 v);
+static VD_INLINE Vdb32 vd_atomic_cas_u64(volatile Vdu64 *p, Vdu64 expected, Vdu64 desired);
+static VD_INLINE void* vd_atomic_load_ptr(void * volatile *p);
+static VD_INLINE void  vd_atomic_store_ptr(void * volatile *p, void *v);
+static VD_INLINE void  vd_cpu_relax(void);
+/**
+ * @brief A cheap monotonic tick count: the time stamp counter on x86, the virtual counter on ARM64, and vd_hitime_get
+ *        nanoseconds elsewhere. The tick rate is unspecified; calibrate it against vd_hitime_get.
+ */
+static VD_INLINE Vdu64 vd_cpu_ticks(void);
+
+#if VD_HOST_COMPILER_MSVC
+#if defined(_M_X64) || defined(_M_IX86)
+// x86 doesn't reorder loads with loads or stores with stores: keeping the compiler in order is enough
+static VD_INLINE Vdu32 vd_atomic_load_u32(volatile Vdu32 *p)                                { Vdu32 v = *p; _ReadWriteBarrier(); return v; }
+static VD_INLINE void  vd_atomic_store_u32(volatile Vdu32 *p, Vdu32 v)                      { _ReadWriteBarrier(); *p = v; }
+static VD_INLINE Vdu64 vd_atomic_load_u64(volatile Vdu64 *p)                                { Vdu64 v = *p; _ReadWriteBarrier(); return v; }
+static VD_INLINE void  vd_atomic_store_u64(volatile Vdu64 *p, Vdu64 v)                      { _ReadWriteBarrier(); *p = v; }
+static VD_INLINE void* vd_atomic_load_ptr(void * volatile *p)                               { void *v = *p; _ReadWriteBarrier(); return v; }
+static VD_INLINE void  vd_atomic_store_ptr(void * volatile *p, void *v)                     { _ReadWriteBarrier(); *p = v; }
+static VD_INLINE void  vd_cpu_relax(void)                                                   { _mm_pause(); }
+static VD_INLINE Vdu64 vd_cpu_ticks(void)                                                   { return (Vdu64)__rdtsc(); }
+#elif defined(_M_ARM64)
+static VD_INLINE Vdu32 vd_atomic_load_u32(volatile Vdu32 *p)                                { return (Vdu32)__ldar32((volatile unsigned __int32*)p); }
+static VD_INLINE void  vd_atomic_store_u32(volatile Vdu32 *p, Vdu32 v)                      { __stlr32((volatile unsigned __int32*)p, (unsigned __int32)v); }
+static VD_INLINE Vdu64 vd_atomic_load_u64(volatile Vdu64 *p)                                { return (Vdu64)__ldar64((volatile unsigned __int64*)p); }
+static VD_INLINE void  vd_atomic_store_u64(volatile Vdu64 *p, Vdu64 v)                      { __stlr64((volatile unsigned __int64*)p, (unsigned __int64)v); }
+static VD_INLINE void* vd_atomic_load_ptr(void * volatile *p)                               { return (void*)__ldar64((volatile unsigned __int64*)p); }
+static VD_INLINE void  vd_atomic_store_ptr(void * volatile *p, void *v)                     { __stlr64((volatile unsigned __int64*)p, (unsigned __int64)v); }
+static VD_INLINE void  vd_cpu_relax(void)                                                   { __yield(); }
+static VD_INLINE Vdu64 vd_cpu_ticks(void)                                                   { return (Vdu64)_ReadStatusReg(ARM64_CNTVCT); }
+#else
+#error "vd: atomics are only implemented for x86, x64 and ARM64 on MSVC"
+#endif // defined(_M_X64) || defined(_M_IX86), defined(_M_ARM64), else
+static VD_INLINE Vdu32 vd_atomic_fetch_add_u32(volatile Vdu32 *p, Vdu32 v)                  { return (Vdu32)_InterlockedExchangeAdd((volatile long*)p, (long)v); }
+static VD_INLINE Vdb32 vd_atomic_cas_u32(volatile Vdu32 *p, Vdu32 expected, Vdu32 desired) { return (Vdu32)_InterlockedCompareExchange((volatile long*)p, (long)desired, (long)expected) == expected; }
+static VD_INLINE Vdu64 vd_atomic_fetch_add_u64(volatile Vdu64 *p, Vdu64 v)                  { return (Vdu64)_InterlockedExchangeAdd64((volatile __int64*)p, (__int64)v); }
+static VD_INLINE Vdb32 vd_atomic_cas_u64(volatile Vdu64 *p, Vdu64 expected, Vdu64 desired) { return (Vdu64)_InterlockedCompareExchange64((volatile __int64*)p, (__int64)desired, (__int64)expected) == expected; }
+#else
+static VD_INLINE Vdu32 vd_atomic_load_u32(volatile Vdu32 *p)                                { return __atomic_load_n(p, __ATOMIC_ACQUIRE); }
+static VD_INLINE void  vd_atomic_store_u32(volatile Vdu32 *p, Vdu32 v)                      { __atomic_store_n(p, v, __ATOMIC_RELEASE); }
+static VD_INLINE Vdu32 vd_atomic_fetch_add_u32(volatile Vdu32 *p, Vdu32 v)                  { return __atomic_fetch_add(p, v, __ATOMIC_SEQ_CST); }
+static VD_INLINE Vdb32 vd_atomic_cas_u32(volatile Vdu32 *p, Vdu32 expected, Vdu32 desired) { return __atomic_compare_exchange_n(p, &expected, desired, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST); }
+static VD_INLINE Vdu64 vd_atomic_load_u64(volatile Vdu64 *p)                                { return __atomic_load_n(p, __ATOMIC_ACQUIRE); }
+static VD_INLINE void  vd_atomic_store_u64(volatile Vdu64 *p, Vdu64 v)                      { __atomic_store_n(p, v, __ATOMIC_RELEASE); }
+static VD_INLINE Vdu64 vd_atomic_fetch_add_u64(volatile Vdu64 *p, Vdu64 v)                  { return __atomic_fetch_add(p, v, __ATOMIC_SEQ_CST); }
+static VD_INLINE Vdb32 vd_atomic_cas_u64(volatile Vdu64 *p, Vdu64 expected, Vdu64 desired) { return __atomic_compare_exchange_n(p, &expected, desired, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST); }
+static VD_INLINE void* vd_atomic_load_ptr(void * volatile *p)                               { return __atomic_load_n(p, __ATOMIC_ACQUIRE); }
+static VD_INLINE void  vd_atomic_store_ptr(void * volatile *p, void *v)                     { __atomic_store_n(p, v, __ATOMIC_RELEASE); }
+#if defined(__x86_64__) || defined(__i386__)
+static VD_INLINE void  vd_cpu_relax(void)                                                   { __builtin_ia32_pause(); }
+static VD_INLINE Vdu64 vd_cpu_ticks(void)                                                   { return (Vdu64)__builtin_ia32_rdtsc(); }
+#elif defined(__aarch64__)
+static VD_INLINE void  vd_cpu_relax(void)                                                   { __asm__ __volatile__("yield"); }
+static VD_INLINE Vdu64 vd_cpu_ticks(void)                                                   { Vdu64 v; __asm__ __volatile__("mrs %0, cntvct_el0" : "=r"(v)); return v; }
+#else
+static VD_INLINE void  vd_cpu_relax(void)                                                   { }
+static VD_INLINE Vdu64 vd_cpu_ticks(void)                                                   { return vd_hitime_ns(vd_hitime_get()); }
+#endif // defined(__x86_64__) || defined(__i386__), defined(__aarch64__), else
+#endif // VD_HOST_COMPILER_MSVC, else
+
+/* ----SIMD---------------------------------------------------------------------------------------------------------- */
+/**
+ * @brief Instruction sets available at compile time. Define any of these to 0 to force the portable code paths.
+ */
+#if !defined(VD_SIMD_SSE2) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2)))
+#define VD_SIMD_SSE2 1
+#endif // !defined(VD_SIMD_SSE2) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2)))
+
+#if !defined(VD_SIMD_NEON) && (defined(__ARM_NEON) || defined(_M_ARM64))
+#define VD_SIMD_NEON 1
+#endif // !defined(VD_SIMD_NEON) && (defined(__ARM_NEON) || defined(_M_ARM64))
+
+#if !defined(VD_SIMD_SSSE3) && (defined(__SSSE3__) || defined(__AVX__))
+#define VD_SIMD_SSSE3 1
+#endif // !defined(VD_SIMD_SSSE3) && (defined(__SSSE3__) || defined(__AVX__))
+
+#ifndef VD_SIMD_SSE2
+#define VD_SIMD_SSE2 0
+#endif // !VD_SIMD_SSE2
+
+#ifndef VD_SIMD_SSSE3
+#define VD_SIMD_SSSE3 0
+#endif // !VD_SIMD_SSSE3
+
+#ifndef VD_SIMD_NEON
+#define VD_SIMD_NEON 0
+#endif // !VD_SIMD_NEON
+
+#if VD_SIMD_SSE2
+#include <emmintrin.h>
+#endif // VD_SIMD_SSE2
+
+#if VD_SIMD_SSSE3
+#include <tmmintrin.h>
+#endif // VD_SIMD_SSSE3
+
+#if VD_SIMD_NEON
+#include <arm_neon.h>
+#endif // VD_SIMD_NEON
+
+/* ----THREAD-------------------------------------------------------------------------------------------------------- */
+#if VD_INCLUDE_PLATFORM_SPECIFIC_FUNCTIONALITY
+#define VD_PROC_THREAD(name) void name(void *userdata)
+typedef VD_PROC_THREAD(VdProcThread);
+
+typedef struct __VD_Thread {
+    Vdu64        handle;
+    VdProcThread *proc;
+    void         *userdata;
+} VdThread;
+
+/**
+ * @brief Starts a thread running proc(userdata). The VdThread must stay alive until vd_thread_join.
+ */
+VD_API Vdb32 vd_thread_create(VdThread *thread, VdProcThread *proc, void *userdata);
+VD_API void  vd_thread_join(VdThread *thread);
+VD_API void  vd_thread_yield(void);
+VD_API void  vd_thread_sleep_ms(Vdu32 ms);
+VD_API Vdu32 vd_thread_get_id(void);
+VD_API Vdu32 vd_get_num_cpus(void);
+
+#if VD_MACRO_ABBREVIATIONS
+#define Thread                                VdThread
+#define ProcThread                            VdProcThread
+#define thread_create(thread, proc, userdata) vd_thread_create(thread, proc, userdata)
+#define thread_join(thread)                   vd_thread_join(thread)
+#define thread_yield()                        vd_thread_yield()
+#define thread_sleep_ms(ms)                   vd_thread_sleep_ms(ms)
+#define thread_get_id()                       vd_thread_get_id()
+#define get_num_cpus()                        vd_get_num_cpus()
+#endif // VD_MACRO_ABBREVIATIONS
+#endif // VD_INCLUDE_PLATFORM_SPECIFIC_FUNCTIONALITY
+
 /* ----SYSTEM ALLOCATOR---------------------------------------------------------------------------------------------- */
 typedef struct {
     Vduptr  buf;
@@ -542,7 +704,7 @@ static VD_INLINE void *vd_free(void *ptr, Vdusize old_size)
 #define VD_FREE(ptr, old_size)              free(ptr)
 #else
 #define VD_REALLOC(ptr, old_size, new_size) vd_realloc(ptr, old_size, new_size)
-#define VD_FREE(ptr, old_size)              vd_free(ptr, new_size)
+#define VD_FREE(ptr, old_size)              vd_free(ptr, old_size)
 #endif // VD_USE_CRT
 #endif // !VD_ALLOC_OVERRIDE
 
@@ -560,7 +722,21 @@ static VD_INLINE void *vd_free(void *ptr, Vdusize old_size)
 
 #ifndef VD_ARENA_ZERO_ON_CLEAR
 #define VD_ARENA_ZERO_ON_CLEAR 1
-#endif // VD_ARENA_ZERO_ON_CLEAR 
+#endif // VD_ARENA_ZERO_ON_CLEAR
+
+/**
+ * @brief Set this to 1 to record per-arena high-water marks and per-callsite allocation totals.
+ *        When 0, none of the tracking state or functions exist. Call sites may be tracked from any thread; the
+ *        per-arena counters are as thread-safe as the arena itself.
+ */
+#ifndef VD_ARENA_TRACK
+#define VD_ARENA_TRACK 0
+#endif // !VD_ARENA_TRACK
+
+// Must be a power of two
+#ifndef VD_ARENA_TRACK_MAX_SITES
+#define VD_ARENA_TRACK_MAX_SITES 1024
+#endif // !VD_ARENA_TRACK_MAX_SITES
 
 enum {
     VD_ARENA_FLAGS_USE_MALLOC = 1 << 7,
@@ -575,6 +751,12 @@ typedef struct VdArena {
     Vdusize      curr_offset;
     VdArenaFlags flags;
     Vdu8         reserved[7];
+#if VD_ARENA_TRACK
+    Vdusize      track_peak;
+    Vdusize      track_num_allocs;
+    Vdusize      track_num_bytes;
+    const char   *track_name;
+#endif // VD_ARENA_TRACK
 } VdArena;
 
 typedef struct __VD_ArenaSave {
@@ -597,7 +779,51 @@ VD_INLINE void*             vd_arena_alloc(VdArena *a, size_t size)
 VD_INLINE void*             vd_arena_resize(VdArena *a, void *old_memory, size_t old_size, size_t new_size) { return vd_arena_resize_align(a, old_memory, old_size, new_size, VD_ARENA_DEFAULT_ALIGNMENT); }
 VD_INLINE VdArena           vd_arena_from_malloc(size_t size)                                               { VdArena result; vd_arena_init(&result, VD_MALLOC(size), size); return result; }
 
-#define VD_ARENA_PUSH_ARRAY(a, x, count) (x*)vd_arena_alloc(a, sizeof(x) * count)
+#if VD_ARENA_TRACK
+typedef struct __VD_ArenaTrackStats {
+    /** The bytes currently in use. */
+    Vdusize used;
+    /** The highest value of used since the arena was initialized. */
+    Vdusize peak;
+    /** The arena's buffer length. */
+    Vdusize capacity;
+    /** The number of allocations (including resizes that grew the allocation). */
+    Vdusize num_allocs;
+    /** The total number of bytes requested. */
+    Vdusize num_bytes;
+} VdArenaTrackStats;
+
+typedef struct __VD_ArenaTrackSite {
+    /** __FILE__ of the call site, or 0 for allocations made outside of a tracked macro. */
+    const char *file;
+    /** __LINE__ of the call site. */
+    Vdu32      line;
+    Vdu32      reserved;
+    Vdu64      num_allocs;
+    Vdu64      num_bytes;
+} VdArenaTrackSite;
+
+VD_API void              vd_arena_track_set_name(VdArena *a, const char *name);
+VD_API VdArenaTrackStats vd_arena_track_get_stats(VdArena *a);
+VD_API Vdu32             vd_arena_track_snapshot(VdArenaTrackSite *sites, Vdu32 max_sites);
+VD_API void              vd_arena_track_reset_sites(void);
+VD_API Vdcstr            vd_arena_track_report(VdArena *out, VdArena **arenas, Vdu32 num_arenas, Vdu32 top_n);
+
+VD_API void              vd__arena_track_set_site(const char *file, Vdu32 line);
+VD_API void*             vd__arena_track_end_ptr(void *result);
+VD_API Vdb32             vd__arena_track_end_b32(Vdb32 result);
+
+/**
+ * @brief Attributes every arena allocation performed while evaluating expr to the call site.
+ */
+#define VD_ARENA_TRACK_PTR(expr) (vd__arena_track_set_site(__FILE__, __LINE__), vd__arena_track_end_ptr((void*)(expr)))
+#define VD_ARENA_TRACK_B32(expr) (vd__arena_track_set_site(__FILE__, __LINE__), vd__arena_track_end_b32((expr)))
+#else
+#define VD_ARENA_TRACK_PTR(expr) (expr)
+#define VD_ARENA_TRACK_B32(expr) (expr)
+#endif // VD_ARENA_TRACK
+
+#define VD_ARENA_PUSH_ARRAY(a, x, count) (x*)VD_ARENA_TRACK_PTR(vd_arena_alloc(a, sizeof(x) * count))
 #define VD_ARENA_PUSH_STRUCT(a, x)       VD_ARENA_PUSH_ARRAY(a, x, 1)
 #define VD_ARENA_FROM_SYSTEM(a, size)    (vd_arena_init(a, VD_MALLOC(size), size))
 
@@ -802,8 +1028,8 @@ typedef struct {
 } VdDynArrayHeader;
 
 #define VD_DYNARRAY_HEADER(a)                      ((VdDynArrayHeader*)(((Vdu8*)a) - sizeof(VdDynArrayHeader)))
-#define VD_DYNARRAY_INIT(a, arena)                 ((a) = vd__dynarray_grow(a, sizeof(*(a)), 1, 0, arena))
-#define VD_DYNARRAY_INIT_WITH_CAP(a, arena, cap)   ((a) = vd__dynarray_grow(a, sizeof(*(a)), cap, cap, arena))
+#define VD_DYNARRAY_INIT(a, arena)                 ((a) = VD_ARENA_TRACK_PTR(vd__dynarray_grow(a, sizeof(*(a)), 1, 0, arena)))
+#define VD_DYNARRAY_INIT_WITH_CAP(a, arena, cap)   ((a) = VD_ARENA_TRACK_PTR(vd__dynarray_grow(a, sizeof(*(a)), cap, cap, arena)))
 #define VD_DYNARRAY_ADD(a, v)                      (VD_DYNARRAY_CHECKGROW(a, 1), (a)[VD_DYNARRAY_HEADER(a)->len++] = (v))
 #define VD_DYNARRAY_PUSH(a)                        (VD_DYNARRAY_CHECKGROW(a, 1), &((a)[VD_DYNARRAY_HEADER(a)->len++]))
 #define VD_DYNARRAY_ADDN(a, n)                     (VD_DYNARRAY_CHECKGROW(a, n), VD_DYNARRAY_HEADER(a)->len += (n))
@@ -814,7 +1040,7 @@ typedef struct {
 #define VD_DYNARRAY_CAP(a)                         ((a) ? VD_DYNARRAY_HEADER(a)->cap : 0)
 #define VD_DYNARRAY_DEL(a, i)                      do { Vdu32 _i_ = (i); if (_i_ == (VD_DYNARRAY_LEN(a) - 1)) { (VD_DYNARRAY_HEADER(a)->len--); } else {  (a)[_i_] = VD_DYNARRAY_LAST(a); (VD_DYNARRAY_HEADER(a)->len--); } } while (0)
 #define VD_DYNARRAY_ARENAP(a)                      ((a) ? VD_DYNARRAY_HEADER(a)->arena : 0)
-#define VD_DYNARRAY_GROW(a, b, c)                  ((a) = vd__dynarray_grow((a), sizeof(*(a)), (b), (c), VD_DYNARRAY_ARENAP(a)))
+#define VD_DYNARRAY_GROW(a, b, c)                  ((a) = VD_ARENA_TRACK_PTR(vd__dynarray_grow((a), sizeof(*(a)), (b), (c), VD_DYNARRAY_ARENAP(a))))
 #define VD_DYNARRAY_PTR_CHECKED(a, i)              ((i < VD_DYNARRAY_LEN(a)) ? &(a)[i] : 0)
 
 // @todo(mdodis): fix & check dynarray & fixedarray (they use invalid macros and dynarray is not tested)
@@ -874,6 +1100,266 @@ VD_INLINE void *vd__dynarray_grow(void *a, Vdusize tsize, Vdu32 addlen, Vdu32 mi
 #define dynarray
 #endif
 
+/* ----SORT---------------------------------------------------------------------------------------------------------- */
+/**
+ * @brief Returns < 0 if a should come before b, 0 if they are equivalent, > 0 otherwise.
+ */
+#define VD_PROC_SORT_CMP(name) int name(const void *a, const void *b, void *userdata)
+typedef VD_PROC_SORT_CMP(VdProcSortCmp);
+
+// Arrays smaller than this are always sorted on the calling thread by the parallel variants
+#ifndef VD_SORT_PARALLEL_MIN_COUNT
+#define VD_SORT_PARALLEL_MIN_COUNT 65536
+#endif // !VD_SORT_PARALLEL_MIN_COUNT
+
+#ifndef VD_SORT_MAX_THREADS
+#define VD_SORT_MAX_THREADS 64
+#endif // !VD_SORT_MAX_THREADS
+
+/**
+ * @brief Unstable in-place comparison sort (pattern-defeating quicksort). O(n log n) worst case, O(n) on sorted,
+ *        reverse sorted and mostly equal inputs. Needs no scratch memory.
+ */
+VD_API void vd_sort(void *base, Vdusize count, Vdusize size, VdProcSortCmp *cmp, void *userdata);
+
+/**
+ * @brief LSD radix sort (8-bit digits) on 32/64-bit keys. Stable. If values is not null, it is permuted alongside keys.
+ *        Requires count * (sizeof(key) + sizeof(value)) bytes of scratch, which is released before returning.
+ *        Passes where every key has the same digit are skipped.
+ */
+VD_API void vd_sort_radix_u32(Vdu32 *keys, Vdu32 *values, Vdusize count, VdArena *scratch);
+VD_API void vd_sort_radix_i32(Vdi32 *keys, Vdu32 *values, Vdusize count, VdArena *scratch);
+VD_API void vd_sort_radix_f32(Vdf32 *keys, Vdu32 *values, Vdusize count, VdArena *scratch);
+VD_API void vd_sort_radix_u64(Vdu64 *keys, Vdu64 *values, Vdusize count, VdArena *scratch);
+VD_API void vd_sort_radix_i64(Vdi64 *keys, Vdu64 *values, Vdusize count, VdArena *scratch);
+VD_API void vd_sort_radix_f64(Vdf64 *keys, Vdu64 *values, Vdusize count, VdArena *scratch);
+
+#if VD_INCLUDE_PLATFORM_SPECIFIC_FUNCTIONALITY
+/**
+ * @brief Same as the above, but each pass is split across num_threads threads (0 = number of cpus).
+ */
+VD_API void vd_sort_radix_u32_parallel(Vdu32 *keys, Vdu32 *values, Vdusize count, VdArena *scratch, Vdu32 num_threads);
+VD_API void vd_sort_radix_u64_parallel(Vdu64 *keys, Vdu64 *values, Vdusize count, VdArena *scratch, Vdu32 num_threads);
+
+/**
+ * @brief Sorts num_threads slices with vd_sort concurrently, then merges them pairwise. Requires count * size bytes of
+ *        scratch.
+ */
+VD_API void vd_sort_parallel(void *base, Vdusize count, Vdusize size, VdProcSortCmp *cmp, void *userdata,
+                             VdArena *scratch, Vdu32 num_threads);
+#endif // VD_INCLUDE_PLATFORM_SPECIFIC_FUNCTIONALITY
+
+#define VD_SORT_ARRAY(a, count, cmp, userdata)   vd_sort((a), (count), sizeof(*(a)), (cmp), (userdata))
+#define VD_DYNARRAY_SORT(a, cmp, userdata)       vd_sort((a), VD_DYNARRAY_LEN(a), sizeof(*(a)), (cmp), (userdata))
+
+#if VD_MACRO_ABBREVIATIONS
+#define ProcSortCmp                                       VdProcSortCmp
+#define sort(base, count, size, cmp, userdata)            vd_sort(base, count, size, cmp, userdata)
+#define sort_radix_u32(keys, values, count, scratch)      vd_sort_radix_u32(keys, values, count, scratch)
+#define sort_radix_i32(keys, values, count, scratch)      vd_sort_radix_i32(keys, values, count, scratch)
+#define sort_radix_f32(keys, values, count, scratch)      vd_sort_radix_f32(keys, values, count, scratch)
+#define sort_radix_u64(keys, values, count, scratch)      vd_sort_radix_u64(keys, values, count, scratch)
+#define sort_radix_i64(keys, values, count, scratch)      vd_sort_radix_i64(keys, values, count, scratch)
+#define sort_radix_f64(keys, values, count, scratch)      vd_sort_radix_f64(keys, values, count, scratch)
+#define SORT_ARRAY(a, count, cmp, userdata)               VD_SORT_ARRAY(a, count, cmp, userdata)
+#define DYNARRAY_SORT(a, cmp, userdata)                   VD_DYNARRAY_SORT(a, cmp, userdata)
+#endif // VD_MACRO_ABBREVIATIONS
+
+/* ----BITSET-------------------------------------------------------------------------------------------------------- */
+/**
+ * @brief Number of Vdu64 words needed to store num_bits bits.
+ */
+#define VD_BITS_WORDS(num_bits) (((num_bits) + 63) / 64)
+
+static VD_INLINE Vdu32 vd_ctz64(Vdu64 x);
+static VD_INLINE Vdu32 vd_clz64(Vdu64 x);
+static VD_INLINE Vdu32 vd_popcount64(Vdu64 x);
+
+#if VD_HOST_COMPILER_MSVC
+static VD_INLINE Vdu32 vd_ctz64(Vdu64 x) { unsigned long i; return _BitScanForward64(&i, x) ? (Vdu32)i : 64; }
+static VD_INLINE Vdu32 vd_clz64(Vdu64 x) { unsigned long i; return _BitScanReverse64(&i, x) ? (Vdu32)(63 - i) : 64; }
+#else
+static VD_INLINE Vdu32 vd_ctz64(Vdu64 x) { return x ? (Vdu32)__builtin_ctzll(x) : 64; }
+static VD_INLINE Vdu32 vd_clz64(Vdu64 x) { return x ? (Vdu32)__builtin_clzll(x) : 64; }
+#endif // VD_HOST_COMPILER_MSVC, else
+
+#if VD_HOST_COMPILER_CLANG && defined(__POPCNT__)
+static VD_INLINE Vdu32 vd_popcount64(Vdu64 x) { return (Vdu32)__builtin_popcountll(x); }
+#elif VD_HOST_COMPILER_MSVC && defined(__AVX__)
+static VD_INLINE Vdu32 vd_popcount64(Vdu64 x) { return (Vdu32)__popcnt64(x); }
+#else
+static VD_INLINE Vdu32 vd_popcount64(Vdu64 x)
+{
+    x = x - ((x >> 1) & 0x5555555555555555ull);
+    x = (x & 0x3333333333333333ull) + ((x >> 2) & 0x3333333333333333ull);
+    x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+    return (Vdu32)((x * 0x0101010101010101ull) >> 56);
+}
+#endif // VD_HOST_COMPILER_CLANG && defined(__POPCNT__), VD_HOST_COMPILER_MSVC && defined(__AVX__), else
+
+/**
+ * @brief Bit operations on plain word arrays, for fixed-size sets stored inline (Vdu64 bits[VD_BITS_WORDS(N)]).
+ */
+static VD_INLINE void  vd_bits_set(Vdu64 *words, Vdusize i)   { words[i >> 6] |=  (1ull << (i & 63)); }
+static VD_INLINE void  vd_bits_clear(Vdu64 *words, Vdusize i) { words[i >> 6] &= ~(1ull << (i & 63)); }
+static VD_INLINE Vdb32 vd_bits_test(Vdu64 *words, Vdusize i)  { return (words[i >> 6] >> (i & 63)) & 1; }
+
+/**
+ * @brief Word-range kernels (SSE2/NEON when available). dst may alias a or b. andnot computes a & ~b.
+ */
+VD_API void    vd_bits_and(Vdu64 *dst, const Vdu64 *a, const Vdu64 *b, Vdusize num_words);
+VD_API void    vd_bits_or(Vdu64 *dst, const Vdu64 *a, const Vdu64 *b, Vdusize num_words);
+VD_API void    vd_bits_andnot(Vdu64 *dst, const Vdu64 *a, const Vdu64 *b, Vdusize num_words);
+VD_API void    vd_bits_xor(Vdu64 *dst, const Vdu64 *a, const Vdu64 *b, Vdusize num_words);
+VD_API Vdusize vd_bits_popcount(const Vdu64 *words, Vdusize num_words);
+
+typedef struct __VD_Bitset {
+    Vdu64   *words;
+    Vdusize num_bits;
+    Vdusize num_words;
+} VdBitset;
+
+/**
+ * @brief Allocates a zeroed, 16-byte aligned bitset of num_bits bits.
+ */
+VD_API VdBitset vd_bitset_new(VdArena *arena, Vdusize num_bits);
+
+static VD_INLINE void  vd_bitset_set(VdBitset *b, Vdusize i)              { vd_bits_set(b->words, i); }
+static VD_INLINE void  vd_bitset_clear(VdBitset *b, Vdusize i)            { vd_bits_clear(b->words, i); }
+static VD_INLINE Vdb32 vd_bitset_test(VdBitset *b, Vdusize i)             { return vd_bits_test(b->words, i); }
+static VD_INLINE void  vd_bitset_assign(VdBitset *b, Vdusize i, Vdb32 v)  { if (v) vd_bits_set(b->words, i); else vd_bits_clear(b->words, i); }
+
+/**
+ * @brief Sets/clears the bits in [begin, end).
+ */
+VD_API void    vd_bitset_set_range(VdBitset *b, Vdusize begin, Vdusize end);
+VD_API void    vd_bitset_clear_range(VdBitset *b, Vdusize begin, Vdusize end);
+VD_API void    vd_bitset_clear_all(VdBitset *b);
+
+/**
+ * @brief Combines a and b into dst over the words all three have in common.
+ */
+VD_API void    vd_bitset_and(VdBitset *dst, VdBitset *a, VdBitset *b);
+VD_API void    vd_bitset_or(VdBitset *dst, VdBitset *a, VdBitset *b);
+VD_API void    vd_bitset_andnot(VdBitset *dst, VdBitset *a, VdBitset *b);
+VD_API void    vd_bitset_xor(VdBitset *dst, VdBitset *a, VdBitset *b);
+
+VD_API Vdusize vd_bitset_count(VdBitset *b);
+VD_API Vdusize vd_bitset_count_range(VdBitset *b, Vdusize begin, Vdusize end);
+
+/**
+ * @brief Returns the index of the first set bit at or after from, or b->num_bits if there is none.
+ */
+VD_API Vdusize vd_bitset_next(VdBitset *b, Vdusize from);
+
+/**
+ * @brief Writes the indices of all set bits to out in increasing order. Returns how many were written.
+ */
+VD_API Vdusize vd_bitset_to_indices(VdBitset *b, Vdu32 *out);
+
+#define VD_BITSET_FOR_EACH(b, i) for (Vdusize i = vd_bitset_next((b), 0); i < (b)->num_bits; i = vd_bitset_next((b), i + 1))
+
+/**
+ * @brief Compressed set of 32-bit integers for sparse data. Members are grouped by their upper 16 bits; each group is
+ *        stored either as a sorted Vdu16 array (up to VD_SPARSE_BITSET_ARRAY_MAX members) or as a 65536-bit bitmap.
+ */
+#ifndef VD_SPARSE_BITSET_ARRAY_MAX
+#define VD_SPARSE_BITSET_ARRAY_MAX 4096
+#endif // !VD_SPARSE_BITSET_ARRAY_MAX
+
+#define VD_SPARSE_BITSET_BITMAP_WORDS 1024
+
+typedef struct __VD_SparseBitsetContainer {
+    /** The upper 16 bits shared by every member of the container. */
+    Vdu16 key;
+    Vdu16 is_bitmap;
+    /** The number of members. */
+    Vdu32 count;
+    /** The capacity of the array, in Vdu16s. Unused by bitmaps. */
+    Vdu32 cap;
+    Vdu32 reserved;
+    /** Vdu16[cap] sorted ascending, or Vdu64[VD_SPARSE_BITSET_BITMAP_WORDS]. */
+    void  *data;
+} VdSparseBitsetContainer;
+
+typedef struct __VD_SparseBitset {
+    VdArena                 *arena;
+    /** Sorted by key. */
+    VdSparseBitsetContainer *containers;
+    Vdu32                   num_containers;
+    Vdu32                   cap_containers;
+} VdSparseBitset;
+
+VD_API void    vd_sparse_bitset_init(VdSparseBitset *s, VdArena *arena);
+/** @return VD_TRUE if x was not already a member */
+VD_API Vdb32   vd_sparse_bitset_add(VdSparseBitset *s, Vdu32 x);
+/** @return VD_TRUE if x was a member */
+VD_API Vdb32   vd_sparse_bitset_remove(VdSparseBitset *s, Vdu32 x);
+VD_API Vdb32   vd_sparse_bitset_test(VdSparseBitset *s, Vdu32 x);
+VD_API Vdu64   vd_sparse_bitset_count(VdSparseBitset *s);
+
+/**
+ * @brief Writes the result of the operation into dst, which must be initialized and empty.
+ */
+VD_API void    vd_sparse_bitset_and(VdSparseBitset *dst, VdSparseBitset *a, VdSparseBitset *b);
+VD_API void    vd_sparse_bitset_or(VdSparseBitset *dst, VdSparseBitset *a, VdSparseBitset *b);
+
+/**
+ * @brief Finds the first member at or after from. Returns VD_FALSE if there is none.
+ */
+VD_API Vdb32   vd_sparse_bitset_next(VdSparseBitset *s, Vdu32 from, Vdu32 *out);
+
+/**
+ * @brief Converts between the two representations. Members of s past dst->num_bits are ignored.
+ */
+VD_API void    vd_sparse_bitset_from_bitset(VdSparseBitset *dst, VdBitset *src);
+VD_API void    vd_sparse_bitset_to_bitset(VdSparseBitset *s, VdBitset *dst);
+
+#if VD_MACRO_ABBREVIATIONS
+#define BITS_WORDS(num_bits)                          VD_BITS_WORDS(num_bits)
+#define BITSET_FOR_EACH(b, i)                         VD_BITSET_FOR_EACH(b, i)
+#define Bitset                                        VdBitset
+#define SparseBitset                                  VdSparseBitset
+#define SparseBitsetContainer                         VdSparseBitsetContainer
+#define ctz64(x)                                      vd_ctz64(x)
+#define clz64(x)                                      vd_clz64(x)
+#define popcount64(x)                                 vd_popcount64(x)
+#define bits_set(words, i)                            vd_bits_set(words, i)
+#define bits_clear(words, i)                          vd_bits_clear(words, i)
+#define bits_test(words, i)                           vd_bits_test(words, i)
+#define bits_and(dst, a, b, num_words)                vd_bits_and(dst, a, b, num_words)
+#define bits_or(dst, a, b, num_words)                 vd_bits_or(dst, a, b, num_words)
+#define bits_andnot(dst, a, b, num_words)             vd_bits_andnot(dst, a, b, num_words)
+#define bits_xor(dst, a, b, num_words)                vd_bits_xor(dst, a, b, num_words)
+#define bits_popcount(words, num_words)               vd_bits_popcount(words, num_words)
+#define bitset_new(arena, num_bits)                   vd_bitset_new(arena, num_bits)
+#define bitset_set(b, i)                              vd_bitset_set(b, i)
+#define bitset_clear(b, i)                            vd_bitset_clear(b, i)
+#define bitset_test(b, i)                             vd_bitset_test(b, i)
+#define bitset_assign(b, i, v)                        vd_bitset_assign(b, i, v)
+#define bitset_set_range(b, begin, end)               vd_bitset_set_range(b, begin, end)
+#define bitset_clear_range(b, begin, end)             vd_bitset_clear_range(b, begin, end)
+#define bitset_clear_all(b)                           vd_bitset_clear_all(b)
+#define bitset_and(dst, a, b)                         vd_bitset_and(dst, a, b)
+#define bitset_or(dst, a, b)                          vd_bitset_or(dst, a, b)
+#define bitset_andnot(dst, a, b)                      vd_bitset_andnot(dst, a, b)
+#define bitset_xor(dst, a, b)                         vd_bitset_xor(dst, a, b)
+#define bitset_count(b)                               vd_bitset_count(b)
+#define bitset_count_range(b, begin, end)             vd_bitset_count_range(b, begin, end)
+#define bitset_next(b, from)                          vd_bitset_next(b, from)
+#define bitset_to_indices(b, out)                     vd_bitset_to_indices(b, out)
+#define sparse_bitset_init(s, arena)                  vd_sparse_bitset_init(s, arena)
+#define sparse_bitset_add(s, x)                       vd_sparse_bitset_add(s, x)
+#define sparse_bitset_remove(s, x)                    vd_sparse_bitset_remove(s, x)
+#define sparse_bitset_test(s, x)                      vd_sparse_bitset_test(s, x)
+#define sparse_bitset_count(s)                        vd_sparse_bitset_count(s)
+#define sparse_bitset_and(dst, a, b)                  vd_sparse_bitset_and(dst, a, b)
+#define sparse_bitset_or(dst, a, b)                   vd_sparse_bitset_or(dst, a, b)
+#define sparse_bitset_next(s, from, out)              vd_sparse_bitset_next(s, from, out)
+#define sparse_bitset_from_bitset(dst, src)           vd_sparse_bitset_from_bitset(dst, src)
+#define sparse_bitset_to_bitset(s, dst)               vd_sparse_bitset_to_bitset(s, dst)
+#endif // VD_MACRO_ABBREVIATIONS
+
 /* ----STR----------------------------------------------------------------------------------------------------------- */
 typedef struct __VD_Str {
     char        *s;
@@ -902,6 +1388,11 @@ VD_INLINE VdStr      vd_str_chop_right(VdStr s, Vdusize at)
 VD_INLINE Vdb32      vd_str_eq(VdStr a, VdStr b);
 VD_INLINE VdStr      vd_str_join(VdArena *arena, VdStr a, VdStr b, Vdb32 null_sep);
 VD_INLINE Vdb32      vd_str_ends_with_char(VdStr a, char c)                             { return a.len > 0 ? a.s[a.len - 1] == c : VD_FALSE; }
+VD_INLINE Vdb32      vd_str_starts_with(VdStr s, VdStr prefix)                          { return (s.len >= prefix.len) && (VD_MEMCMP(s.s, prefix.s, prefix.len) == 0); }
+/**
+ * @brief Byte-wise lexicographic order: negative if a sorts before b, 0 if equal, positive otherwise.
+ */
+VD_INLINE int        vd_str_compare(VdStr a, VdStr b);
 
 VD_INLINE Vdb32 vd_cstr_cmp(Vdcstr _a, Vdcstr _b)
 {
@@ -925,6 +1416,15 @@ VD_INLINE Vdusize vd_cstr_len(Vdcstr a)
     return result;
 }
 
+VD_INLINE int vd_str_compare(VdStr a, VdStr b)
+{
+    Vdusize len = a.len < b.len ? a.len : b.len;
+    int c = len ? VD_MEMCMP(a.s, b.s, len) : 0;
+    if (c != 0)         return c;
+    if (a.len == b.len) return 0;
+    return a.len < b.len ? -1 : 1;
+}
+
 VD_INLINE VdStr vd_str_dup(VdArena *a, VdStr s) {
     VdStr result;
     result.s = (char*)vd_arena_alloc(a, s.len);
@@ -1099,6 +1599,8 @@ VD_INLINE Vdcstr vd_cstr_from_str(VdArena *arena, VdStr s)
 #define str_eq              vd_str_eq
 #define str_join            vd_str_join
 #define str_ends_with_char  vd_str_ends_with_char
+#define str_starts_with     vd_str_starts_with
+#define str_compare         vd_str_compare
 #endif
 
 /* ----UTF8---------------------------------------------------------------------------------------------------------- */
@@ -1117,8 +1619,74 @@ static VD_INLINE Vdu8 vd_utf8_codepoint_len(Vdu32 codepoint)
     return VD_U8_MAX;
 }
 
+/**
+ * @brief Decodes the codepoint at the start of s. Returns the number of bytes it takes, or 0 if s does not start with a
+ *        valid, complete and shortest-form UTF-8 sequence (surrogates and values above U+10FFFF are invalid).
+ */
+static VD_INLINE Vdu32   vd_utf8_decode(const void *s, Vdusize len, Vdu32 *codepoint);
+
+/**
+ * @brief Returns true if every byte is below 0x80.
+ */
+VD_API Vdb32             vd_utf8_is_ascii(const void *data, Vdusize len);
+/**
+ * @brief Validates the whole buffer. Uses the lookup-table algorithm by Keiser & Lemire with SSSE3 or AArch64 NEON,
+ *        scalar decoding otherwise.
+ */
+VD_API Vdb32             vd_utf8_validate(const void *data, Vdusize len);
+/**
+ * @brief Returns the number of codepoints in valid UTF-8 (i.e. the number of bytes that are not continuation bytes).
+ */
+VD_API Vdusize           vd_utf8_count(const void *data, Vdusize len);
+/**
+ * @brief Decodes valid UTF-8 into out, which must hold vd_utf8_count(data, len) codepoints. Returns the count written.
+ *        Invalid input produces unspecified codepoints, but never more than vd_utf8_count(data, len) of them.
+ */
+VD_API Vdusize           vd_utf8_to_utf32(const void *data, Vdusize len, Vdu32 *out);
+/**
+ * @brief Validates, then decodes into an array allocated from a. Returns 0 (and allocates nothing) on invalid input.
+ */
+VD_API Vdu32*            vd_utf8_to_utf32_arena(VdArena *a, const void *data, Vdusize len, Vdusize *count);
+
+static VD_INLINE Vdu32 vd_utf8_decode(const void *s, Vdusize len, Vdu32 *codepoint)
+{
+    const Vdu8 *b = (const Vdu8*)s;
+    if (len == 0) return 0;
+
+    Vdu32 c = b[0];
+    if (c < 0x80) {
+        *codepoint = c;
+        return 1;
+    }
+
+    Vdu32 n;
+    Vdu32 min;
+    if      ((c & 0xE0) == 0xC0) { n = 2; min = 0x80;    c &= 0x1F; }
+    else if ((c & 0xF0) == 0xE0) { n = 3; min = 0x800;   c &= 0x0F; }
+    else if ((c & 0xF8) == 0xF0) { n = 4; min = 0x10000; c &= 0x07; }
+    else                         return 0;
+
+    if (len < n) return 0;
+
+    for (Vdu32 i = 1; i < n; ++i) {
+        if ((b[i] & 0xC0) != 0x80) return 0;
+        c = (c << 6) | (b[i] & 0x3F);
+    }
+
+    if ((c < min) || (c > 0x10FFFF) || ((c >= 0xD800) && (c <= 0xDFFF))) return 0;
+
+    *codepoint = c;
+    return n;
+}
+
 #if VD_MACRO_ABBREVIATIONS
-#define utf8_codepoint_len vd_utf8_codepoint_len
+#define utf8_codepoint_len                       vd_utf8_codepoint_len
+#define utf8_decode(s, len, codepoint)           vd_utf8_decode(s, len, codepoint)
+#define utf8_is_ascii(data, len)                 vd_utf8_is_ascii(data, len)
+#define utf8_validate(data, len)                 vd_utf8_validate(data, len)
+#define utf8_count(data, len)                    vd_utf8_count(data, len)
+#define utf8_to_utf32(data, len, out)            vd_utf8_to_utf32(data, len, out)
+#define utf8_to_utf32_arena(a, data, len, count) vd_utf8_to_utf32_arena(a, data, len, count)
 #endif // VD_MACRO_ABBREVIATIONS
 
 /* ----STR BUILDER--------------------------------------------------------------------------------------------------- */
@@ -1371,10 +1939,270 @@ VD_INLINE Vdu64 vd_dhash64(const void *data, Vdu64 len) { return vd_hash64(data,
 
 VD_INLINE Vdu64 vd_dhash64_str(VdStr s) { return vd_dhash64(s.s, s.len); }
 
+/**
+ * @brief Mixes a single integer (splitmix64 finalizer). Cheaper than vd_hash64 for fixed-size keys, and every input
+ *        bit affects every output bit.
+ */
+VD_INLINE Vdu64 vd_hash_u64(Vdu64 x)
+{
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ull;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebull;
+    x ^= x >> 31;
+    return x;
+}
+
+VD_INLINE Vdu64 vd_hash_u32(Vdu32 x) { return vd_hash_u64((Vdu64)x); }
+
+/**
+ * @brief Combines two hashes. Unlike XOR, the result depends on the order of the arguments and combining a hash with
+ *        itself does not cancel out.
+ */
+VD_INLINE Vdu64 vd_hash_combine(Vdu64 a, Vdu64 b)
+{
+    return vd_hash_u64(a ^ (b + 0x9e3779b97f4a7c15ull + (a << 6) + (a >> 2)));
+}
+
+/**
+ * @brief Streaming hash for keys made of several parts. Feeding the same bytes in any number of updates gives the
+ *        same result, so a composite key can be hashed in one pass without copying it into a contiguous buffer.
+ */
+typedef struct __VD_Hasher {
+    Vdu64 h;
+    Vdu64 len;
+    Vdu64 tail;
+    Vdu32 tail_len;
+    Vdu32 reserved;
+} VdHasher;
+
+#define VD__HASHER_C1 0x87c37b91114253d5ull
+#define VD__HASHER_C2 0x4cf5ad432745937full
+
+VD_INLINE void vd__hasher_block(VdHasher *hasher, Vdu64 k)
+{
+    k *= VD__HASHER_C1;
+    k  = (k << 31) | (k >> 33);
+    k *= VD__HASHER_C2;
+
+    Vdu64 h = hasher->h ^ k;
+    h = (h << 27) | (h >> 37);
+    hasher->h = h * 5 + 0x52dce729;
+}
+
+VD_INLINE void vd_hasher_init(VdHasher *hasher, Vdu64 seed)
+{
+    hasher->h        = seed;
+    hasher->len      = 0;
+    hasher->tail     = 0;
+    hasher->tail_len = 0;
+    hasher->reserved = 0;
+}
+
+VD_INLINE void vd_hasher_update(VdHasher *hasher, const void *data, Vdusize len)
+{
+    const Vdu8 *bytes = (const Vdu8*)data;
+    hasher->len += len;
+
+    while ((hasher->tail_len != 0) && (len > 0)) {
+        hasher->tail |= (Vdu64)(*bytes++) << (hasher->tail_len * 8);
+        len--;
+        if (++hasher->tail_len == 8) {
+            vd__hasher_block(hasher, hasher->tail);
+            hasher->tail     = 0;
+            hasher->tail_len = 0;
+        }
+    }
+
+    while (len >= 8) {
+        Vdu64 k;
+        VD_MEMCPY(&k, bytes, 8);
+        vd__hasher_block(hasher, k);
+        bytes += 8;
+        len   -= 8;
+    }
+
+    for (Vdusize i = 0; i < len; ++i) {
+        hasher->tail |= (Vdu64)bytes[i] << (hasher->tail_len * 8);
+        hasher->tail_len++;
+    }
+}
+
+VD_INLINE void vd_hasher_u32(VdHasher *hasher, Vdu32 x)  { vd_hasher_update(hasher, &x, sizeof(x)); }
+VD_INLINE void vd_hasher_u64(VdHasher *hasher, Vdu64 x)  { vd_hasher_update(hasher, &x, sizeof(x)); }
+VD_INLINE void vd_hasher_str(VdHasher *hasher, VdStr s)  { vd_hasher_update(hasher, s.s, s.len); }
+
+/**
+ * @brief Returns the hash of everything fed so far. Does not modify the hasher, so more data can still be added.
+ */
+VD_INLINE Vdu64 vd_hasher_final(VdHasher *hasher)
+{
+    VdHasher copy = *hasher;
+    if (copy.tail_len != 0) vd__hasher_block(&copy, copy.tail);
+    return vd_hash_u64(copy.h ^ copy.len);
+}
+
 #if VD_MACRO_ABBREVIATIONS
 #define hash64(data, len, seed) vd_hash64(data, len, seed)
 #define dhash64(data, len)      vd_dhash64(data, len)
 #define dhash64_str(s)          vd_dhash64_str(VdStr s)
+#define hash_u64(x)             vd_hash_u64(x)
+#define hash_u32(x)             vd_hash_u32(x)
+#define hash_combine(a, b)      vd_hash_combine(a, b)
+#define Hasher                  VdHasher
+#define hasher_init(h, seed)    vd_hasher_init(h, seed)
+#define hasher_update(h, d, l)  vd_hasher_update(h, d, l)
+#define hasher_u32(h, x)        vd_hasher_u32(h, x)
+#define hasher_u64(h, x)        vd_hasher_u64(h, x)
+#define hasher_str(h, s)        vd_hasher_str(h, s)
+#define hasher_final(h)         vd_hasher_final(h)
+#endif // VD_MACRO_ABBREVIATIONS
+
+/* ----CHECKSUM------------------------------------------------------------------------------------------------------ */
+/**
+ * @brief CRC32C (Castagnoli, as used by iSCSI/ext4/SSE4.2) and CRC-16/ARC. Both take the running value, so data can be
+ *        checksummed in pieces: pass 0 first, then the previous result.
+ *
+ * @details vd_crc32c uses the SSE4.2 crc32 instruction or the ARMv8 CRC extension when available, interleaving three
+ *          streams to hide the instruction's latency. On x86-64 with GCC/Clang/MSVC the instruction is detected at
+ *          runtime, so no compiler flag is needed; on AArch64 it must be enabled at compile time (for example with
+ *          -march=armv8-a+crc, the default on Apple targets). Everywhere else a slicing-by-8 table is used.
+ */
+VD_API Vdu32 vd_crc32c(Vdu32 crc, const void *data, Vdusize len);
+/**
+ * @brief The slicing-by-8 implementation of vd_crc32c, regardless of what the CPU supports.
+ */
+VD_API Vdu32 vd_crc32c_portable(Vdu32 crc, const void *data, Vdusize len);
+/**
+ * @brief Whether vd_crc32c uses CRC instructions on this machine.
+ */
+VD_API Vdb32 vd_crc32c_hw_available(void);
+/**
+ * @brief CRC-16/ARC (reflected 0x8005, no final xor), the checksum in SDL-style gamepad GUIDs.
+ */
+VD_API Vdu16 vd_crc16(Vdu16 crc, const void *data, Vdusize len);
+
+#if VD_MACRO_ABBREVIATIONS
+#define crc32c(crc, data, len)          vd_crc32c(crc, data, len)
+#define crc32c_portable(crc, data, len) vd_crc32c_portable(crc, data, len)
+#define crc32c_hw_available()           vd_crc32c_hw_available()
+#define crc16(crc, data, len)           vd_crc16(crc, data, len)
+#endif // VD_MACRO_ABBREVIATIONS
+
+/* ----LZ------------------------------------------------------------------------------------------------------------ */
+/**
+ * @brief LZ77 compression in the LZ4 block format (4 byte minimum match, 64KiB window, no entropy coding), tuned for
+ *        decompression speed. Neither side allocates or needs the CRT.
+ *
+ * @details vd_lz_compress/vd_lz_decompress work on single blocks whose decompressed size is known by the caller. The
+ *          frame functions split data into independently compressed blocks of up to VD_LZ_FRAME_BLOCK_SIZE bytes, so
+ *          that a frame can be written and read a block at a time (or have its blocks compressed in parallel):
+ *
+ *          [VdLzFrameHeader] { [u32 payload size | VD_LZ_FRAME_BLOCK_STORED] [u32 decompressed size] [payload] }* [u32 0]
+ *
+ *          All integers are little-endian.
+ */
+#ifndef VD_LZ_FRAME_BLOCK_SIZE
+#define VD_LZ_FRAME_BLOCK_SIZE  (64 * 1024)
+#endif // !VD_LZ_FRAME_BLOCK_SIZE
+
+#define VD_LZ_FRAME_MAGIC          0x5A4C4456 /* "VDLZ" */
+#define VD_LZ_FRAME_VERSION        1
+#define VD_LZ_FRAME_BLOCK_STORED   0x80000000u
+#define VD_LZ_CONTENT_SIZE_UNKNOWN VD_U64_MAX
+
+/**
+ * @brief Worst-case output size of vd_lz_compress for n bytes of input.
+ */
+#define VD_LZ_COMPRESS_BOUND(n) ((n) + (n) / 255 + 16)
+
+typedef enum {
+    VD_LZ_OK = 0,
+    /** vd_lz_frame_reader_next reached the end mark. */
+    VD_LZ_END,
+    VD_LZ_ERROR_BAD_MAGIC,
+    VD_LZ_ERROR_BAD_VERSION,
+    VD_LZ_ERROR_TRUNCATED,
+    VD_LZ_ERROR_CORRUPT,
+    VD_LZ_ERROR_DST_TOO_SMALL,
+} VdLzStatus;
+
+typedef struct __VD_LzFrameHeader {
+    Vdu32 magic;
+    Vdu8  version;
+    Vdu8  reserved[3];
+    /** The largest decompressed size of any block. */
+    Vdu32 block_size;
+    Vdu32 reserved2;
+    /** Total decompressed size, or VD_LZ_CONTENT_SIZE_UNKNOWN if the frame was written without knowing it. */
+    Vdu64 content_size;
+} VdLzFrameHeader;
+
+typedef struct __VD_LzFrameReader {
+    const Vdu8 *data;
+    Vdusize    size;
+    Vdusize    cursor;
+    Vdu64      content_size;
+    Vdu32      block_size;
+    Vdb32      done;
+} VdLzFrameReader;
+
+/**
+ * @brief Compresses src into dst. Returns the compressed size, or 0 if it doesn't fit in dst_cap (which can be used to
+ *        give up on incompressible data early by passing a dst_cap smaller than src_len).
+ */
+VD_API Vdusize    vd_lz_compress(const void *src, Vdusize src_len, void *dst, Vdusize dst_cap);
+/**
+ * @brief Decompresses a block that decompresses to exactly dst_len bytes. Never reads or writes out of bounds, even
+ *        with corrupted input. Returns false if the input is malformed or doesn't decompress to dst_len bytes.
+ */
+VD_API Vdb32      vd_lz_decompress(const void *src, Vdusize src_len, void *dst, Vdusize dst_len);
+
+/**
+ * @brief Worst-case size of vd_lz_frame_compress for n bytes of input (blocks that don't compress are stored).
+ */
+VD_API Vdusize    vd_lz_frame_bound(Vdusize n);
+VD_API Vdusize    vd_lz_frame_compress(const void *src, Vdusize src_len, void *dst, Vdusize dst_cap);
+/**
+ * @brief Streaming compression: a header, then any number of blocks of up to VD_LZ_FRAME_BLOCK_SIZE bytes, then the
+ *        end mark. Each returns the number of bytes written to dst, or 0 if dst_cap is too small.
+ */
+VD_API Vdusize    vd_lz_frame_write_header(void *dst, Vdusize dst_cap, Vdu64 content_size);
+VD_API Vdusize    vd_lz_frame_write_block(const void *src, Vdusize src_len, void *dst, Vdusize dst_cap);
+VD_API Vdusize    vd_lz_frame_write_end(void *dst, Vdusize dst_cap);
+
+/**
+ * @brief Streaming decompression: each call to vd_lz_frame_reader_next decompresses one block into dst, which needs
+ *        room for reader->block_size bytes, and returns VD_LZ_END after the last one.
+ */
+VD_API VdLzStatus vd_lz_frame_reader_init(VdLzFrameReader *reader, const void *data, Vdusize size);
+VD_API VdLzStatus vd_lz_frame_reader_next(VdLzFrameReader *reader, void *dst, Vdusize dst_cap, Vdusize *dst_len);
+VD_API VdLzStatus vd_lz_frame_decompress(const void *src, Vdusize src_len, void *dst, Vdusize dst_cap,
+                                         Vdusize *dst_len);
+/**
+ * @brief Decompresses a whole frame written with a known content size into memory allocated from a.
+ *        Returns 0 on failure.
+ */
+VD_API void*      vd_lz_frame_decompress_arena(VdArena *a, const void *src, Vdusize src_len, Vdusize *dst_len);
+VD_API Vdcstr     vd_lz_status_to_cstr(VdLzStatus status);
+
+#if VD_MACRO_ABBREVIATIONS
+#define LzStatus                                               VdLzStatus
+#define LzFrameHeader                                          VdLzFrameHeader
+#define LzFrameReader                                          VdLzFrameReader
+#define LZ_COMPRESS_BOUND(n)                                   VD_LZ_COMPRESS_BOUND(n)
+#define lz_compress(src, src_len, dst, dst_cap)                vd_lz_compress(src, src_len, dst, dst_cap)
+#define lz_decompress(src, src_len, dst, dst_len)              vd_lz_decompress(src, src_len, dst, dst_len)
+#define lz_frame_bound(n)                                      vd_lz_frame_bound(n)
+#define lz_frame_compress(src, src_len, dst, dst_cap)          vd_lz_frame_compress(src, src_len, dst, dst_cap)
+#define lz_frame_write_header(dst, dst_cap, content_size)      vd_lz_frame_write_header(dst, dst_cap, content_size)
+#define lz_frame_write_block(src, src_len, dst, dst_cap)       vd_lz_frame_write_block(src, src_len, dst, dst_cap)
+#define lz_frame_write_end(dst, dst_cap)                       vd_lz_frame_write_end(dst, dst_cap)
+#define lz_frame_reader_init(reader, data, size)               vd_lz_frame_reader_init(reader, data, size)
+#define lz_frame_reader_next(reader, dst, dst_cap, dst_len)    vd_lz_frame_reader_next(reader, dst, dst_cap, dst_len)
+#define lz_frame_decompress(src, src_len, dst, dst_cap, len)   vd_lz_frame_decompress(src, src_len, dst, dst_cap, len)
+#define lz_frame_decompress_arena(a, src, src_len, dst_len)    vd_lz_frame_decompress_arena(a, src, src_len, dst_len)
+#define lz_status_to_cstr(status)                              vd_lz_status_to_cstr(status)
 #endif // VD_MACRO_ABBREVIATIONS
 
 /* ----STRMAP-------------------------------------------------------------------------------------------------------- */
@@ -1433,13 +2261,13 @@ typedef struct __VD_StrmapInitOptions {
 #define VD_STRMAP
 #define VD_STRMAP_DEFAULT_CAP              1024
 #define VD_STRMAP_HEADER(m)                ((Vd__StrmapHeader*)(((Vdu8*)(m)) - sizeof(Vd__StrmapHeader)))
-#define VD_STRMAP_INIT(m, arena, cap, o)   ((m) = (vd__strmap_init((arena), sizeof(*m), (cap), (o))))
+#define VD_STRMAP_INIT(m, arena, cap, o)   ((m) = VD_ARENA_TRACK_PTR(vd__strmap_init((arena), sizeof(*m), (cap), (o))))
 #define VD_STRMAP_INIT_DEFAULT(m, arena)   VD_STRMAP_INIT((m), (arena), VD_STRMAP_DEFAULT_CAP, 0)
-#define VD_STRMAP_SET(m, k, v)             vd__strmap_set((m), (k), (void*)(v), VD__STRMAP_SET_MODE_NEW_ONLY)
+#define VD_STRMAP_SET(m, k, v)             VD_ARENA_TRACK_B32(vd__strmap_set((m), (k), (void*)(v), VD__STRMAP_SET_MODE_NEW_ONLY))
 #define VD_STRMAP_GET(m, k, v)             vd__strmap_get((m), (k), (void*)(v))
 #define VD_STRMAP_GET_PTR(m, k)            vd__strmap_get_ptr((m), (k))
 #define VD_STRMAP_RM(m, k)                 (vd__strmap_get_bin((m), (k), VD__STRMAP_GET_BIN_FLAGS_SET_UNUSED) != 0)
-#define VD_STRMAP_OVERWRITE(m, k, v)       vd__strmap_set((m), (k), (void*)(v), VD__STRMAP_SET_MODE_OVERWRITE)
+#define VD_STRMAP_OVERWRITE(m, k, v)       VD_ARENA_TRACK_B32(vd__strmap_set((m), (k), (void*)(v), VD__STRMAP_SET_MODE_OVERWRITE))
 #define VD_STRMAP_COUNT(m)                 ((m) == 0 ? 0 : VD_STRMAP_HEADER(m)->taken)
 #define VD_STRMAP_TSIZE(m)                 ((m) == 0 ? 0 : VD_STRMAP_HEADER(m)->tsize)
 #define VD_STRMAP_TOTAL_CAP(m)             ((m) == 0 ? 0 : VD_STRMAP_HEADER(m)->cap_total)
@@ -1630,32 +2458,466 @@ VD_INLINE Vdb32 vd__kvmap_set(void *map, void *key, void *value, Vd__KVMapSetMod
 #define kvmap_overwrite(m, k, v)          VD_KVMAP_OVERWRITE(m, k, v)
 #endif // VD_MACRO_ABBREVIATIONS
 
-/* ----FILESYSTEM---------------------------------------------------------------------------------------------------- */
-#if VD_INCLUDE_PLATFORM_SPECIFIC_FUNCTIONALITY
-enum {
-    VD_FILE_FLAG_DIRECTORY = 1 << 0,
-};
-typedef Vdu32 VdFileFlags;
-
-typedef struct VdDirectory {
-    void             *handle;
-    VdStr            filename;
+/* ----BTREE--------------------------------------------------------------------------------------------------------- */
+/**
+ * @brief An ordered map from Vdu64 or VdStr keys to Vdu64 values: a B+tree allocated from an arena. Supports sorted
+ *        iteration, lower-bound/range/prefix queries and building from sorted input in one pass.
+ *
+ * @details Every node keeps its keys in VD_BTREE_ORDER Vdu64s, aligned to and filling whole cache lines, so finding a
+ *          position is a branch-free SIMD count of the keys less than the one searched for. String trees store the
+ *          first 8 bytes of each key there (big-endian, so they order like the string) next to the full VdStr, and
+ *          only compare full strings when those prefixes tie.
+ *
+ *          Leaves are linked in order for iteration. Removal doesn't rebalance: nodes may be left underfull, which
+ *          only costs some space until the tree is rebuilt. Nodes are never freed individually; clear the arena.
+ */
+#ifndef VD_BTREE_ORDER
+#define VD_BTREE_ORDER 16
+#endif // !VD_BTREE_ORDER
 
-#if VD_PLATFORM_WINDOWS
-    int     windows_is_on_first_file;
-    int     windows_is_on_directory;
-#endif // VD_PLATFORM_WINDOWS
-} VdDirectory;
+#ifndef VD_BTREE_MAX_HEIGHT
+#define VD_BTREE_MAX_HEIGHT 16
+#endif // !VD_BTREE_MAX_HEIGHT
 
-typedef struct {
-    VdStr       name;
-    VdFileFlags flags;
-} VdFile;
+typedef enum {
+    VD_BTREE_KEY_U64 = 0,
+    VD_BTREE_KEY_STR,
+} VdBTreeKeyKind;
+
+typedef struct VdBTreeNode {
+    /** Sorted keys (their 8-byte prefixes in string trees). Slots past count hold VD_U64_MAX. */
+    Vdu64 keys[VD_BTREE_ORDER];
+    Vdu32 count;
+    Vdu32 is_leaf;
+    /** The full keys of a string tree, 0 otherwise. */
+    VdStr *strs;
+} VdBTreeNode;
+
+typedef struct VdBTreeLeaf {
+    VdBTreeNode        node;
+    struct VdBTreeLeaf *next;
+    Vdu64              values[VD_BTREE_ORDER];
+} VdBTreeLeaf;
+
+typedef struct VdBTreeInner {
+    VdBTreeNode node;
+    /** children[i] holds the keys in [keys[i - 1], keys[i]). */
+    VdBTreeNode *children[VD_BTREE_ORDER + 1];
+} VdBTreeInner;
+
+typedef struct VdBTree {
+    VdArena        *arena;
+    VdBTreeNode    *root;
+    VdBTreeLeaf    *first;
+    Vdusize        count;
+    Vdu32          height;
+    VdBTreeKeyKind kind;
+} VdBTree;
+
+typedef struct VdBTreeIter {
+    VdBTreeLeaf *leaf;
+    Vdu32       index;
+} VdBTreeIter;
+
+VD_API void        vd_btree_init(VdBTree *tree, VdArena *arena, VdBTreeKeyKind kind);
+
+/**
+ * @brief Sets key to value. Returns VD_TRUE if the key is new, VD_FALSE if an existing value was overwritten.
+ */
+VD_API Vdb32       vd_btree_set_u64(VdBTree *tree, Vdu64 key, Vdu64 value);
+VD_API Vdb32       vd_btree_get_u64(VdBTree *tree, Vdu64 key, Vdu64 *value);
+VD_API Vdb32       vd_btree_remove_u64(VdBTree *tree, Vdu64 key);
+/**
+ * @brief The first entry whose key is >= key.
+ */
+VD_API VdBTreeIter vd_btree_lower_bound_u64(VdBTree *tree, Vdu64 key);
+
+/**
+ * @brief Like vd_btree_set_u64. New keys are copied into the tree's arena.
+ */
+VD_API Vdb32       vd_btree_set_str(VdBTree *tree, VdStr key, Vdu64 value);
+VD_API Vdb32       vd_btree_get_str(VdBTree *tree, VdStr key, Vdu64 *value);
+VD_API Vdb32       vd_btree_remove_str(VdBTree *tree, VdStr key);
+VD_API VdBTreeIter vd_btree_lower_bound_str(VdBTree *tree, VdStr key);
+
+/**
+ * @brief Replaces the tree's contents with count strictly ascending keys, packing every node full. values can be 0,
+ *        in which case each key's value is its index. Much faster than inserting one by one.
+ */
+VD_API void        vd_btree_build_u64(VdBTree *tree, const Vdu64 *keys, const Vdu64 *values, Vdusize count);
+/**
+ * @brief Like vd_btree_build_u64, for keys in vd_str_compare order. The strings are referenced, not copied, and must
+ *        outlive the tree.
+ */
+VD_API void        vd_btree_build_str(VdBTree *tree, const VdStr *keys, const Vdu64 *values, Vdusize count);
+
+static VD_INLINE VdBTreeIter vd_btree_first(VdBTree *tree)          { VdBTreeIter it = { tree->first, 0 }; while (it.leaf && (it.leaf->node.count == 0)) it.leaf = it.leaf->next; return it; }
+static VD_INLINE Vdb32       vd_btree_iter_valid(VdBTreeIter *it)   { return it->leaf != 0; }
+static VD_INLINE Vdu64       vd_btree_iter_key_u64(VdBTreeIter *it) { return it->leaf->node.keys[it->index]; }
+static VD_INLINE VdStr       vd_btree_iter_key_str(VdBTreeIter *it) { return it->leaf->node.strs[it->index]; }
+static VD_INLINE Vdu64       vd_btree_iter_value(VdBTreeIter *it)   { return it->leaf->values[it->index]; }
+static VD_INLINE void        vd_btree_iter_next(VdBTreeIter *it)
+{
+    if (++it->index < it->leaf->node.count) return;
+
+    it->index = 0;
+    do {
+        it->leaf = it->leaf->next;
+    } while (it->leaf && (it->leaf->node.count == 0));
+}
+
+#if VD_MACRO_ABBREVIATIONS
+#define BTree                                       VdBTree
+#define BTreeKeyKind                                VdBTreeKeyKind
+#define BTreeIter                                   VdBTreeIter
+#define btree_init(tree, arena, kind)               vd_btree_init(tree, arena, kind)
+#define btree_set_u64(tree, key, value)             vd_btree_set_u64(tree, key, value)
+#define btree_get_u64(tree, key, value)             vd_btree_get_u64(tree, key, value)
+#define btree_remove_u64(tree, key)                 vd_btree_remove_u64(tree, key)
+#define btree_lower_bound_u64(tree, key)            vd_btree_lower_bound_u64(tree, key)
+#define btree_set_str(tree, key, value)             vd_btree_set_str(tree, key, value)
+#define btree_get_str(tree, key, value)             vd_btree_get_str(tree, key, value)
+#define btree_remove_str(tree, key)                 vd_btree_remove_str(tree, key)
+#define btree_lower_bound_str(tree, key)            vd_btree_lower_bound_str(tree, key)
+#define btree_build_u64(tree, keys, values, count)  vd_btree_build_u64(tree, keys, values, count)
+#define btree_build_str(tree, keys, values, count)  vd_btree_build_str(tree, keys, values, count)
+#define btree_first(tree)                           vd_btree_first(tree)
+#define btree_iter_valid(it)                        vd_btree_iter_valid(it)
+#define btree_iter_key_u64(it)                      vd_btree_iter_key_u64(it)
+#define btree_iter_key_str(it)                      vd_btree_iter_key_str(it)
+#define btree_iter_value(it)                        vd_btree_iter_value(it)
+#define btree_iter_next(it)                         vd_btree_iter_next(it)
+#endif // VD_MACRO_ABBREVIATIONS
+
+/* ----ART----------------------------------------------------------------------------------------------------------- */
+/**
+ * @brief A map from VdStr keys to Vdu64 values that also answers prefix queries: an adaptive radix tree allocated from
+ *        an arena. Besides exact lookups it finds the longest stored key that prefixes a string, and visits every key
+ *        starting with a given prefix in lexicographic order (autocompletion).
+ *
+ * @details Inner nodes branch on one key byte and grow through four layouts as children are added: node4 and node16
+ *          (sorted byte arrays; node16 is searched with one SIMD compare), node48 (a 256-byte index into 48 children)
+ *          and node256 (direct). Runs of bytes that all keys below a node share are stored once as the node's prefix,
+ *          so long common prefixes ("vd_module_...") cost one memcmp instead of a node per byte. A key that ends at an
+ *          inner node is kept in that node's leaf slot, so keys may be prefixes of one another and may contain any byte.
+ *
+ *          Keys are copied into the arena. Outgrown nodes aren't reused; clear the arena to free everything.
+ */
+typedef struct VdArt {
+    VdArena *arena;
+    void    *root;
+    Vdusize count;
+} VdArt;
+
+/**
+ * @brief Called for every key visited by vd_art_visit_prefix. Return VD_FALSE to stop.
+ */
+#define VD_PROC_ART_VISIT(name) Vdb32 name(VdStr key, Vdu64 value, void *userdata)
+typedef VD_PROC_ART_VISIT(VdProcArtVisit);
+
+VD_API void    vd_art_init(VdArt *art, VdArena *arena);
+
+/**
+ * @brief Sets key to value. Returns VD_TRUE if the key is new, VD_FALSE if an existing value was overwritten.
+ */
+VD_API Vdb32   vd_art_set(VdArt *art, VdStr key, Vdu64 value);
+VD_API Vdb32   vd_art_get(VdArt *art, VdStr key, Vdu64 *value);
+
+/**
+ * @brief Finds the longest stored key that is a prefix of (or equal to) str. Writes it to matched (pointing at the
+ *        tree's copy) and its value, and returns VD_FALSE if no stored key is a prefix of str. Either output can be 0.
+ */
+VD_API Vdb32   vd_art_longest_prefix(VdArt *art, VdStr str, VdStr *matched, Vdu64 *value);
+
+/**
+ * @brief Calls visit for every key that starts with prefix, in lexicographic (byte) order, until it returns VD_FALSE.
+ *        Returns the number of keys visited.
+ */
+VD_API Vdusize vd_art_visit_prefix(VdArt *art, VdStr prefix, VdProcArtVisit *visit, void *userdata);
+
+#if VD_MACRO_ABBREVIATIONS
+#define Art                                                 VdArt
+#define ProcArtVisit                                        VdProcArtVisit
+#define art_init(art, arena)                                vd_art_init(art, arena)
+#define art_set(art, key, value)                            vd_art_set(art, key, value)
+#define art_get(art, key, value)                            vd_art_get(art, key, value)
+#define art_longest_prefix(art, str, matched, value)        vd_art_longest_prefix(art, str, matched, value)
+#define art_visit_prefix(art, prefix, visit, userdata)      vd_art_visit_prefix(art, prefix, visit, userdata)
+#endif // VD_MACRO_ABBREVIATIONS
+
+/* ----MAP IMAGE----------------------------------------------------------------------------------------------------- */
+/**
+ * @brief A flat, position-independent copy of a VD_STRMAP or VD_KVMAP. Pointers are replaced by offsets/indices so the
+ *        image can be written to disk once, then mapped and queried read-only with no parsing or allocation.
+ *
+ * @details The bin layout (and therefore the hash function) is kept as is, which is why opening an image checks the
+ *          hash seed and a hash of a probe key against the ones used when writing it. Values are copied as raw bytes,
+ *          so they must not contain pointers.
+ */
+#define VD_MAP_IMAGE_MAGIC   0x494D4456 /* "VDMI" */
+#define VD_MAP_IMAGE_VERSION 1
+
+typedef enum {
+    VD_MAP_IMAGE_KIND_STRMAP = 1,
+    VD_MAP_IMAGE_KIND_KVMAP  = 2,
+} VdMapImageKind;
+
+typedef enum {
+    VD_MAP_IMAGE_OK = 0,
+    VD_MAP_IMAGE_ERROR_TOO_SMALL,
+    VD_MAP_IMAGE_ERROR_BAD_MAGIC,
+    VD_MAP_IMAGE_ERROR_BAD_VERSION,
+    VD_MAP_IMAGE_ERROR_WRONG_KIND,
+    VD_MAP_IMAGE_ERROR_HASH_MISMATCH,
+    VD_MAP_IMAGE_ERROR_CORRUPT,
+} VdMapImageStatus;
+
+typedef struct __VD_MapImageHeader {
+    Vdu32 magic;
+    Vdu32 version;
+    Vdu32 kind;
+    /** The seed passed to vd_hash64 (VD_HASH64_DEFAULT_SEED), or 0 with VD_HASH64_CUSTOM. */
+    Vdu32 hash_seed;
+    /** vd_dhash64 of a fixed probe key, catches a different hash function or seed. */
+    Vdu64 hash_check;
+    /** Number of bins in the addressable region. */
+    Vdu32 cap;
+    Vdu32 cap_total;
+    Vdu32 count;
+    /** Key size for kvmaps, 0 for strmaps. */
+    Vdu32 ksize;
+    Vdu32 vsize;
+    Vdu32 bin_size;
+    Vdu64 bins_offset;
+    Vdu64 keys_offset;
+    Vdu64 keys_size;
+    Vdu64 total_size;
+} VdMapImageHeader;
+
+typedef struct __VD_MapImageBin {
+    /** Index + 1 of the next bin in the chain, 0 at the end. */
+    Vdu32 next;
+    Vdu32 used;
+    /** Strmaps only: the key is keys[key_offset, key_offset + key_len). */
+    Vdu32 key_len;
+    /** Strmaps only: low 32 bits of the key hash, checked before comparing keys. */
+    Vdu32 key_hash;
+    Vdu64 key_offset;
+} VdMapImageBin;                                                // 24 bytes, followed by the key (kvmap) and value
+
+typedef struct __VD_MapImage {
+    const VdMapImageHeader *header;
+    const Vdu8             *bins;
+    const char             *keys;
+} VdMapImage;
+
+/**
+ * @brief Returns the number of bytes vd_strmap_image_write needs.
+ */
+VD_API Vdusize          vd_strmap_image_size(void *map);
+/**
+ * @brief Writes the image of map into buf. Returns the number of bytes written, or 0 if buf_len is too small.
+ */
+VD_API Vdusize          vd_strmap_image_write(void *map, void *buf, Vdusize buf_len);
+VD_API Vdusize          vd_kvmap_image_size(void *map);
+VD_API Vdusize          vd_kvmap_image_write(void *map, void *buf, Vdusize buf_len);
+
+/**
+ * @brief Validates the header of an image in memory (for example, from vd_file_map_open). data must stay alive and
+ *        8-byte aligned for as long as the image is used.
+ */
+VD_API VdMapImageStatus vd_strmap_image_open(VdMapImage *image, const void *data, Vdusize size);
+VD_API VdMapImageStatus vd_kvmap_image_open(VdMapImage *image, const void *data, Vdusize size);
+VD_API Vdcstr           vd_map_image_status_to_cstr(VdMapImageStatus status);
+
+/**
+ * @brief Same semantics as VD_STRMAP_GET_PTR/VD_STRMAP_GET and VD_KVMAP_GET, but read-only.
+ */
+VD_API const void*      vd_strmap_image_get_ptr(VdMapImage *image, VdStr key);
+VD_API Vdb32            vd_strmap_image_get(VdMapImage *image, VdStr key, void *value);
+VD_API const void*      vd_kvmap_image_get_ptr(VdMapImage *image, const void *key);
+VD_API Vdb32            vd_kvmap_image_get(VdMapImage *image, const void *key, void *value);
+
+#define VD_MAP_IMAGE_COUNT(image) ((image)->header->count)
+
+#if VD_MACRO_ABBREVIATIONS
+#define MapImage                                    VdMapImage
+#define MapImageHeader                              VdMapImageHeader
+#define MapImageBin                                 VdMapImageBin
+#define MapImageKind                                VdMapImageKind
+#define MapImageStatus                              VdMapImageStatus
+#define MAP_IMAGE_COUNT(image)                      VD_MAP_IMAGE_COUNT(image)
+#define strmap_image_size(map)                      vd_strmap_image_size(map)
+#define strmap_image_write(map, buf, buf_len)       vd_strmap_image_write(map, buf, buf_len)
+#define kvmap_image_size(map)                       vd_kvmap_image_size(map)
+#define kvmap_image_write(map, buf, buf_len)        vd_kvmap_image_write(map, buf, buf_len)
+#define strmap_image_open(image, data, size)        vd_strmap_image_open(image, data, size)
+#define kvmap_image_open(image, data, size)         vd_kvmap_image_open(image, data, size)
+#define map_image_status_to_cstr(status)            vd_map_image_status_to_cstr(status)
+#define strmap_image_get_ptr(image, key)            vd_strmap_image_get_ptr(image, key)
+#define strmap_image_get(image, key, value)         vd_strmap_image_get(image, key, value)
+#define kvmap_image_get_ptr(image, key)             vd_kvmap_image_get_ptr(image, key)
+#define kvmap_image_get(image, key, value)          vd_kvmap_image_get(image, key, value)
+#endif // VD_MACRO_ABBREVIATIONS
+
+/* ----ARENA SNAPSHOT------------------------------------------------------------------------------------------------ */
+/**
+ * @brief Saves the used bytes of an arena together with a relocation table, so that a pointer graph built inside it
+ *        (parsed documents, trees, lists) can be loaded back at any address with one linear pass over the table.
+ *
+ * @details Only the pointer slots registered in a VdArenaSnapshotRelocs are relocated; every other byte is copied as
+ *          is, so integers and floats are never mistaken for addresses. A registered slot must hold null or point into
+ *          the arena's used range: keep everything reachable from the root inside the arena (see
+ *          VdInixParseInfo::copy_strings), or use VdRelPtr for structures that should be usable straight from a
+ *          read-only mapping with no fixup at all.
+ */
+#define VD_ARENA_SNAPSHOT_MAGIC   0x534E4456 /* "VDNS" */
+#define VD_ARENA_SNAPSHOT_VERSION 1
+// The loaded data keeps the original buffer address modulo this value, so alignments up to it are preserved.
+#define VD_ARENA_SNAPSHOT_ALIGN   64
+
+typedef enum {
+    VD_ARENA_SNAPSHOT_OK = 0,
+    VD_ARENA_SNAPSHOT_ERROR_TOO_SMALL,
+    VD_ARENA_SNAPSHOT_ERROR_BAD_MAGIC,
+    VD_ARENA_SNAPSHOT_ERROR_BAD_VERSION,
+    VD_ARENA_SNAPSHOT_ERROR_POINTER_SIZE,
+    VD_ARENA_SNAPSHOT_ERROR_MISALIGNED,
+    VD_ARENA_SNAPSHOT_ERROR_OUT_OF_MEMORY,
+    VD_ARENA_SNAPSHOT_ERROR_CORRUPT,
+} VdArenaSnapshotStatus;
+
+typedef struct __VD_ArenaSnapshotHeader {
+    Vdu32 magic;
+    Vdu32 version;
+    Vdu32 ptr_size;
+    /** The original arena buffer address modulo VD_ARENA_SNAPSHOT_ALIGN. */
+    Vdu32 base_residue;
+    /** The address pointer slots are currently relative to: 0 when written, the data address after a fixup in place. */
+    Vdu64 base;
+    Vdu64 data_offset;
+    Vdu64 data_size;
+    Vdu64 relocs_offset;
+    /** Relocations are Vdu32 word indices, counted from the data address rounded down to ptr_size. */
+    Vdu64 num_relocs;
+    /** Offset of the root pointer in the data, or VD_U64_MAX for a null root. */
+    Vdu64 root_offset;
+    Vdu64 total_size;
+} VdArenaSnapshotHeader;
+
+typedef struct __VD_ArenaSnapshotRelocs {
+    /** VD_DYNARRAY of the addresses of the registered pointer slots. */
+    Vduptr *slots;
+} VdArenaSnapshotRelocs;
+
+/**
+ * @brief Starts an empty relocation table. Its storage comes from table_arena, usually a scratch arena rather than the
+ *        one being saved.
+ */
+VD_API void                  vd_arena_snapshot_relocs_init(VdArenaSnapshotRelocs *relocs, VdArena *table_arena);
+/**
+ * @brief Registers a pointer-sized, pointer-aligned slot inside the arena. Register each slot once; it is read when the
+ *        snapshot is written, so it may be filled in afterwards.
+ */
+VD_API void                  vd_arena_snapshot_add_ptr(VdArenaSnapshotRelocs *relocs, void *slot);
+/**
+ * @brief Registers the pointer fields of one object, given the byte offsets of those fields (a per-type pointer map
+ *        built with VD_OFFSET_OF).
+ */
+VD_API void                  vd_arena_snapshot_add_ptrs(VdArenaSnapshotRelocs *relocs, void *object,
+                                                        const Vdu32 *offsets, Vdu32 num_offsets);
+/**
+ * @brief Returns the number of bytes vd_arena_snapshot_write needs for the arena's current contents.
+ */
+VD_API Vdusize               vd_arena_snapshot_size(VdArena *a, VdArenaSnapshotRelocs *relocs);
+/**
+ * @brief Writes the used part of the arena and its relocation table into buf, which must be 8-byte aligned. root must be
+ *        null or point into the arena and is what the load functions return. Returns the number of bytes written, or 0
+ *        if buf_len is too small, a registered slot lies outside the arena or points outside of it, or the arena does
+ *        not own its allocations (VD_ARENA_FLAGS_USE_MALLOC).
+ */
+VD_API Vdusize               vd_arena_snapshot_write(VdArena *a, VdArenaSnapshotRelocs *relocs, void *root, void *buf,
+                                                     Vdusize buf_len);
+/**
+ * @brief Relocates the image in place and returns the root through root. The image must be writable, for example a
+ *        file read into memory. It can be fixed up again if it is moved afterwards.
+ */
+VD_API VdArenaSnapshotStatus vd_arena_snapshot_fixup(void *image, Vdusize size, void **root);
+/**
+ * @brief Copies the data of the image into a and relocates it there. The image is not modified, so it can come straight
+ *        from vd_file_map_open. The loaded objects can be extended with further allocations from a.
+ */
+VD_API VdArenaSnapshotStatus vd_arena_snapshot_load(VdArena *a, const void *image, Vdusize size, void **root);
+VD_API Vdcstr                vd_arena_snapshot_status_to_cstr(VdArenaSnapshotStatus status);
+
+/**
+ * @brief A self-relative pointer: stores the distance from the field itself to the target, so a structure that only
+ *        links through VdRelPtr fields is valid at any address and needs no relocation. 0 is the null pointer.
+ */
+typedef Vdi64 VdRelPtr;
+
+#define VD_RELPTR_SET(field, ptr)  ((field) = (ptr) ? (VdRelPtr)((Vdu8*)(ptr) - (Vdu8*)&(field)) : 0)
+#define VD_RELPTR_GET(T, field)    ((field) ? (T*)((Vdu8*)&(field) + (field)) : (T*)0)
+
+#define VD_ARENA_SNAPSHOT_ADD_FIELD(relocs, object, field) vd_arena_snapshot_add_ptr((relocs), (void*)&(object)->field)
+
+#if VD_MACRO_ABBREVIATIONS
+#define ArenaSnapshotStatus                         VdArenaSnapshotStatus
+#define ArenaSnapshotHeader                         VdArenaSnapshotHeader
+#define ArenaSnapshotRelocs                         VdArenaSnapshotRelocs
+#define RelPtr                                      VdRelPtr
+#define RELPTR_SET(field, ptr)                      VD_RELPTR_SET(field, ptr)
+#define RELPTR_GET(T, field)                        VD_RELPTR_GET(T, field)
+#define ARENA_SNAPSHOT_ADD_FIELD(relocs, o, field)  VD_ARENA_SNAPSHOT_ADD_FIELD(relocs, o, field)
+#define arena_snapshot_relocs_init(relocs, arena)   vd_arena_snapshot_relocs_init(relocs, arena)
+#define arena_snapshot_add_ptr(relocs, slot)        vd_arena_snapshot_add_ptr(relocs, slot)
+#define arena_snapshot_add_ptrs(relocs, o, offs, n) vd_arena_snapshot_add_ptrs(relocs, o, offs, n)
+#define arena_snapshot_size(a, relocs)              vd_arena_snapshot_size(a, relocs)
+#define arena_snapshot_write(a, relocs, root, buf, buf_len) vd_arena_snapshot_write(a, relocs, root, buf, buf_len)
+#define arena_snapshot_fixup(image, size, root)     vd_arena_snapshot_fixup(image, size, root)
+#define arena_snapshot_load(a, image, size, root)   vd_arena_snapshot_load(a, image, size, root)
+#define arena_snapshot_status_to_cstr(status)       vd_arena_snapshot_status_to_cstr(status)
+#endif // VD_MACRO_ABBREVIATIONS
+
+/* ----FILESYSTEM---------------------------------------------------------------------------------------------------- */
+#if VD_INCLUDE_PLATFORM_SPECIFIC_FUNCTIONALITY
+enum {
+    VD_FILE_FLAG_DIRECTORY = 1 << 0,
+};
+typedef Vdu32 VdFileFlags;
+
+typedef struct VdDirectory {
+    void             *handle;
+    VdStr            filename;
+
+#if VD_PLATFORM_WINDOWS
+    int     windows_is_on_first_file;
+    int     windows_is_on_directory;
+#endif // VD_PLATFORM_WINDOWS
+} VdDirectory;
+
+typedef struct {
+    VdStr       name;
+    VdFileFlags flags;
+} VdFile;
 
 VD_API int  vd_directory_open(VdDirectory *directory, const char *path);
 VD_API int  vd_directory_get_file(VdDirectory *directory, VdFile *file);
 VD_API int  vd_directory_close(VdDirectory *directory);
 VD_API void vd_directory_walk_recursively(const char *path, void (*visit)(VdFile*, void*), void *userdata);
+
+typedef struct __VD_FileMap {
+    const void *data;
+    Vdusize    size;
+    Vdu64      handle;
+    Vdu64      mapping;
+} VdFileMap;
+
+/**
+ * @brief Maps a whole file read-only into memory. Returns VD_FALSE if the file can't be opened or is empty.
+ */
+VD_API Vdb32 vd_file_map_open(VdFileMap *map, Vdcstr path);
+VD_API void  vd_file_map_close(VdFileMap *map);
 #endif // VD_INCLUDE_PLATFORM_SPECIFIC_FUNCTIONALITY
 
 #include <stdio.h>
@@ -1665,12 +2927,19 @@ VD_INLINE Vdcstr vd_dump_file_to_cstr(VdArena *arena, Vdcstr file_path, Vdusize
 VD_INLINE Vdu8*  vd_dump_file_to_bytes(VdArena *arena, Vdcstr file_path, Vdusize *len)
 {
     FILE *f = fopen(file_path, "rb");
+    if (f == 0) return 0;
+
     fseek(f, 0, SEEK_END);
     Vdusize size = ftell(f);
     fseek(f, 0, SEEK_SET);
 
     Vdu8 *result = (Vdu8*)vd_arena_alloc(arena, size);
-    fread(result, size, 1, f);
+    if ((size > 0) && (fread(result, size, 1, f) != 1)) {
+        fclose(f);
+        return 0;
+    }
+
+    fclose(f);
     *len = size;
     return result;
 }
@@ -1685,10 +2954,12 @@ VD_INLINE Vdcstr vd_dump_file_to_cstr(VdArena *arena, Vdcstr file_path, Vdusize
     fseek(f, 0, SEEK_SET);
 
     char *result = (char*)vd_arena_alloc(arena, size + 1);
-    if (fread(result, size, 1, f) != 1) {
+    if ((size > 0) && (fread(result, size, 1, f) != 1)) {
+        fclose(f);
         return 0;
     }
 
+    fclose(f);
     result[size] = 0;
     *len = size;
     return result;
@@ -1700,10 +2971,309 @@ VD_INLINE Vdcstr vd_dump_file_to_cstr(VdArena *arena, Vdcstr file_path, Vdusize
 #define directory_open                            vd_directory_open
 #define directory_get_file                        vd_directory_get_file
 #define directory_close                           vd_directory_close
+#define FileMap                                   VdFileMap
+#define file_map_open(map, path)                  vd_file_map_open(map, path)
+#define file_map_close(map)                       vd_file_map_close(map)
 #define dump_file_to_bytes(arena, file_path, len) vd_dump_file_to_bytes(arena, file_path, len)
 #define dump_file_to_cstr(arena, file_path, len)  vd_dump_file_to_cstr(arena, file_path, len)
 #endif // VD_MACRO_ABBREVIATIONS
 
+/* ----ASYNC IO------------------------------------------------------------------------------------------------------ */
+/**
+ * @brief Batched, asynchronous file I/O. Queue requests, submit them in one go, then poll or wait for completions.
+ *
+ * @details On Linux this is an io_uring: a whole batch of requests costs one system call to submit and completions
+ *          are read straight from shared memory. Reads and writes that land inside the buffer passed to
+ *          vd_aio_register_buffer use the pre-pinned (fixed) variants, which skips mapping the pages on every call.
+ *
+ *          Where io_uring isn't available (other platforms, old kernels, containers that filter it out) the same API
+ *          runs on a small pool of worker threads doing ordinary blocking calls.
+ *
+ *          Requests are owned by the caller and must stay alive until they complete. A fiber waiting on a request
+ *          can park itself and have the scheduler's idle hook poll the VdAio and ready it.
+ */
+#if VD_INCLUDE_PLATFORM_SPECIFIC_FUNCTIONALITY
+#ifndef VD_AIO_MAX_THREADS
+#define VD_AIO_MAX_THREADS 16
+#endif // !VD_AIO_MAX_THREADS
+
+typedef struct VdAio VdAio;
+
+typedef enum {
+    VD_AIO_BACKEND_IO_URING = 0,
+    VD_AIO_BACKEND_THREADS,
+} VdAioBackend;
+
+typedef enum {
+    /** Opens path. result is the file. */
+    VD_AIO_OP_OPEN = 0,
+    /** Looks up the size of path. result is the size. */
+    VD_AIO_OP_STAT,
+    /** Reads up to size bytes at offset into buf. result is the number of bytes read. */
+    VD_AIO_OP_READ,
+    /** Writes size bytes from buf at offset. result is the number of bytes written. */
+    VD_AIO_OP_WRITE,
+    VD_AIO_OP_CLOSE,
+} VdAioOp;
+
+enum {
+    VD_AIO_OPEN_READ  = 0,
+    /** Open for writing, creating or truncating the file. */
+    VD_AIO_OPEN_WRITE = 1 << 0,
+};
+
+typedef struct VdAioRequest VdAioRequest;
+struct VdAioRequest {
+    VdAioOp      op;
+    Vdu32        open_flags;
+    /** The file returned by a completed VD_AIO_OP_OPEN, for reads, writes and closes. */
+    Vdi64        file;
+    Vdcstr       path;
+    void         *buf;
+    Vdusize      size;
+    Vdu64        offset;
+    void         *userdata;
+    /** Set on completion. Negative on failure (-errno on POSIX, -GetLastError() on Windows). */
+    Vdi64        result;
+
+    // Internal
+    VdAioRequest *next;
+    Vdu32        slot;
+};
+
+typedef struct __VD_AioInitInfo {
+    /** Most requests in flight at once (the io_uring submission queue size). 0 selects 256. */
+    Vdu32 queue_depth;
+    /** Worker threads for the fallback backend. 0 selects 4. */
+    Vdu32 num_threads;
+    /** Use the thread pool even where io_uring is available. */
+    Vdb32 force_threads;
+} VdAioInitInfo;
+
+typedef struct __VD_AioFileData {
+    Vdu8    *data;
+    Vdusize size;
+    /** 0 if the file was read whole, otherwise the failing step's result. */
+    Vdi64   error;
+} VdAioFileData;
+
+/**
+ * @brief Creates a VdAio. info can be 0 for the defaults. Returns 0 only if the thread pool couldn't be started either.
+ */
+VD_API VdAio*       vd_aio_create(VdAioInitInfo *info);
+/**
+ * @brief Waits for every outstanding request, then frees the VdAio.
+ */
+VD_API void         vd_aio_destroy(VdAio *aio);
+VD_API VdAioBackend vd_aio_get_backend(VdAio *aio);
+/**
+ * @brief Pins [base, base + size) so reads and writes inside it use fixed buffers. Replaces any previous
+ *        registration, and passing 0 removes it. Returns VD_FALSE if the backend doesn't support it or the kernel
+ *        refused (usually RLIMIT_MEMLOCK); requests still work either way. No requests may be in flight.
+ */
+VD_API Vdb32        vd_aio_register_buffer(VdAio *aio, void *base, Vdusize size);
+
+/**
+ * @brief Adds a request to the next submission, without any system call.
+ */
+VD_API void         vd_aio_queue(VdAio *aio, VdAioRequest *request);
+/**
+ * @brief Hands queued requests to the kernel or the workers. Returns how many were handed over; the rest (beyond
+ *        queue_depth in flight) go out as earlier ones complete.
+ */
+VD_API Vdusize      vd_aio_submit(VdAio *aio);
+/**
+ * @brief Submits, then collects up to max completed requests without blocking. Returns how many were collected.
+ */
+VD_API Vdusize      vd_aio_poll(VdAio *aio, VdAioRequest **completed, Vdusize max);
+/**
+ * @brief Like vd_aio_poll, but blocks until at least min requests completed (or nothing is outstanding).
+ */
+VD_API Vdusize      vd_aio_wait(VdAio *aio, VdAioRequest **completed, Vdusize max, Vdusize min);
+/**
+ * @brief Requests queued or in flight that haven't been collected yet.
+ */
+VD_API Vdusize      vd_aio_outstanding(VdAio *aio);
+
+/**
+ * @brief Reads count whole files into arena, keeping up to queue_depth / 4 files open at a time. Returns how many
+ *        were read successfully; out[i] says what happened to paths[i].
+ */
+VD_API Vdusize      vd_aio_read_files(VdAio *aio, VdArena *arena, Vdcstr *paths, Vdusize count, VdAioFileData *out);
+
+#if VD_MACRO_ABBREVIATIONS
+#define Aio                                            VdAio
+#define AioBackend                                     VdAioBackend
+#define AioOp                                          VdAioOp
+#define AioRequest                                     VdAioRequest
+#define AioInitInfo                                    VdAioInitInfo
+#define AioFileData                                    VdAioFileData
+#define aio_create(info)                               vd_aio_create(info)
+#define aio_destroy(aio)                               vd_aio_destroy(aio)
+#define aio_get_backend(aio)                           vd_aio_get_backend(aio)
+#define aio_register_buffer(aio, base, size)           vd_aio_register_buffer(aio, base, size)
+#define aio_queue(aio, request)                        vd_aio_queue(aio, request)
+#define aio_submit(aio)                                vd_aio_submit(aio)
+#define aio_poll(aio, completed, max)                  vd_aio_poll(aio, completed, max)
+#define aio_wait(aio, completed, max, min)             vd_aio_wait(aio, completed, max, min)
+#define aio_outstanding(aio)                           vd_aio_outstanding(aio)
+#define aio_read_files(aio, arena, paths, count, out)  vd_aio_read_files(aio, arena, paths, count, out)
+#endif // VD_MACRO_ABBREVIATIONS
+#endif // VD_INCLUDE_PLATFORM_SPECIFIC_FUNCTIONALITY
+
+/* ----PACK---------------------------------------------------------------------------------------------------------- */
+/**
+ * @brief A read-only archive of named blobs that is mapped, not loaded: opening a pack only validates its header, and
+ *        reading an entry touches just that entry's bytes.
+ *
+ * @details [VdPackHeader] [directory: strmap image of VdPackEntry] [blob, aligned to VD_PACK_DATA_ALIGN]*
+ *
+ *          The directory is a MAP IMAGE, so it carries the same hash function/seed requirements. Blobs are either
+ *          stored as is (and can be used in place with vd_pack_entry_bytes) or as an LZ frame. When the pack has
+ *          checksums, every blob's stored bytes are checked on read.
+ */
+#define VD_PACK_MAGIC   0x4B504456 /* "VDPK" */
+#define VD_PACK_VERSION 1
+
+#ifndef VD_PACK_DATA_ALIGN
+#define VD_PACK_DATA_ALIGN 64
+#endif // !VD_PACK_DATA_ALIGN
+
+#ifndef VD_PACK_MAX_THREADS
+#define VD_PACK_MAX_THREADS 64
+#endif // !VD_PACK_MAX_THREADS
+
+typedef enum {
+    VD_PACK_COMPRESSION_NONE = 0,
+    VD_PACK_COMPRESSION_LZ   = 1,
+} VdPackCompression;
+
+typedef enum {
+    VD_PACK_CHECKSUM_NONE   = 0,
+    /** Low 32 bits of vd_dhash64. */
+    VD_PACK_CHECKSUM_HASH32 = 1,
+    VD_PACK_CHECKSUM_CRC32C = 2,
+} VdPackChecksum;
+
+typedef enum {
+    VD_PACK_OK = 0,
+    VD_PACK_ERROR_OPEN_FAILED,
+    VD_PACK_ERROR_TOO_SMALL,
+    VD_PACK_ERROR_BAD_MAGIC,
+    VD_PACK_ERROR_BAD_VERSION,
+    VD_PACK_ERROR_HASH_MISMATCH,
+    VD_PACK_ERROR_CORRUPT,
+    VD_PACK_ERROR_CHECKSUM_MISMATCH,
+    VD_PACK_ERROR_DST_TOO_SMALL,
+} VdPackStatus;
+
+enum {
+    /** Compress every entry that gets smaller as an LZ frame. */
+    VD_PACK_BUILD_COMPRESS  = 1 << 0,
+    VD_PACK_BUILD_CHECKSUMS = 1 << 1,
+};
+typedef Vdu32 VdPackBuildFlags;
+
+typedef struct __VD_PackHeader {
+    Vdu32 magic;
+    Vdu32 version;
+    Vdu32 count;
+    /** A VdPackChecksum. */
+    Vdu32 checksum;
+    Vdu64 directory_offset;
+    Vdu64 directory_size;
+    Vdu64 data_offset;
+    Vdu64 total_size;
+} VdPackHeader;
+
+typedef struct __VD_PackEntry {
+    /** Offset of the stored bytes from the start of the pack. */
+    Vdu64 offset;
+    Vdu64 size;
+    Vdu64 raw_size;
+    /** A VdPackCompression. */
+    Vdu32 compression;
+    Vdu32 checksum;
+} VdPackEntry;
+
+typedef struct __VD_Pack {
+    const VdPackHeader *header;
+    const Vdu8         *data;
+    VdMapImage         directory;
+#if VD_INCLUDE_PLATFORM_SPECIFIC_FUNCTIONALITY
+    VdFileMap          file;
+#endif // VD_INCLUDE_PLATFORM_SPECIFIC_FUNCTIONALITY
+} VdPack;
+
+typedef struct __VD_PackSource {
+    VdStr      name;
+    const void *data;
+    Vdusize    size;
+} VdPackSource;
+
+/**
+ * @brief Builds a pack from count sources into memory allocated from a (VD_PACK_DATA_ALIGN-aligned), and returns it,
+ *        or 0 if two sources have the same name. Compression runs on num_threads threads (0 for one per CPU), one
+ *        LZ frame block at a time, so a single large entry is split across threads as well. Temporary buffers are
+ *        allocated from scratch, which must be a different arena than a.
+ */
+VD_API void*              vd_pack_build(VdArena *a, VdArena *scratch, VdPackSource *sources, Vdu32 count,
+                                        VdPackBuildFlags flags, Vdu32 num_threads, Vdusize *size);
+
+/**
+ * @brief Opens a pack in memory. data must stay alive and VD_PACK_DATA_ALIGN-aligned for as long as the pack is used.
+ */
+VD_API VdPackStatus       vd_pack_open_memory(VdPack *pack, const void *data, Vdusize size);
+#if VD_INCLUDE_PLATFORM_SPECIFIC_FUNCTIONALITY
+/**
+ * @brief Maps the pack at path with vd_file_map_open. Close it with vd_pack_close.
+ */
+VD_API VdPackStatus       vd_pack_open(VdPack *pack, Vdcstr path);
+#endif // VD_INCLUDE_PLATFORM_SPECIFIC_FUNCTIONALITY
+VD_API void               vd_pack_close(VdPack *pack);
+
+/**
+ * @brief Returns the entry with the given name, or 0.
+ */
+VD_API const VdPackEntry* vd_pack_find(VdPack *pack, VdStr name);
+/**
+ * @brief Returns the stored bytes of an entry. For VD_PACK_COMPRESSION_NONE entries this is the data itself, and it
+ *        is not checked against the checksum.
+ */
+VD_API const void*        vd_pack_entry_bytes(VdPack *pack, const VdPackEntry *entry);
+/**
+ * @brief Verifies and decompresses (or copies) an entry into dst, which needs room for entry->raw_size bytes.
+ */
+VD_API VdPackStatus       vd_pack_read(VdPack *pack, const VdPackEntry *entry, void *dst, Vdusize dst_cap);
+/**
+ * @brief Same as vd_pack_read, but into memory allocated from a. Returns 0 on failure.
+ */
+VD_API void*              vd_pack_read_arena(VdArena *a, VdPack *pack, const VdPackEntry *entry, Vdusize *len);
+VD_API Vdcstr             vd_pack_status_to_cstr(VdPackStatus status);
+
+#define VD_PACK_COUNT(pack) ((pack)->header->count)
+
+#if VD_MACRO_ABBREVIATIONS
+#define Pack                                                   VdPack
+#define PackHeader                                             VdPackHeader
+#define PackEntry                                              VdPackEntry
+#define PackSource                                             VdPackSource
+#define PackStatus                                             VdPackStatus
+#define PackCompression                                        VdPackCompression
+#define PackChecksum                                           VdPackChecksum
+#define PackBuildFlags                                         VdPackBuildFlags
+#define PACK_COUNT(pack)                                       VD_PACK_COUNT(pack)
+#define pack_build(a, scratch, sources, count, flags, nt, sz)  vd_pack_build(a, scratch, sources, count, flags, nt, sz)
+#define pack_open_memory(pack, data, size)                     vd_pack_open_memory(pack, data, size)
+#define pack_open(pack, path)                                  vd_pack_open(pack, path)
+#define pack_close(pack)                                       vd_pack_close(pack)
+#define pack_find(pack, name)                                  vd_pack_find(pack, name)
+#define pack_entry_bytes(pack, entry)                          vd_pack_entry_bytes(pack, entry)
+#define pack_read(pack, entry, dst, dst_cap)                   vd_pack_read(pack, entry, dst, dst_cap)
+#define pack_read_arena(a, pack, entry, len)                   vd_pack_read_arena(a, pack, entry, len)
+#define pack_status_to_cstr(status)                            vd_pack_status_to_cstr(status)
+#endif // VD_MACRO_ABBREVIATIONS
+
 /* ----SCRATCH------------------------------------------------------------------------------------------------------- */
 #ifndef VD_SCRATCH_PAGE_COUNT
 #define VD_SCRATCH_PAGE_COUNT 8
@@ -1815,43 +3385,258 @@ extern VD_THREAD_CONTEXT_TYPE * VD_THREAD_CONTEXT_VARNAME;
 #define ThreadContext VdThreadContext
 #endif // VD_MACRO_ABBREVIATIONS
 
-/* ----TESTING------------------------------------------------------------------------------------------------------- */
-#ifndef VD_INCLUDE_TESTS
-#define VD_INCLUDE_TESTS 0
-#endif // VD_INCLUDE_TESTS
+/* ----LOG ASYNC----------------------------------------------------------------------------------------------------- */
+#if VD_INCLUDE_PLATFORM_SPECIFIC_FUNCTIONALITY
+#ifndef VD_LOG_ASYNC_MAX_THREADS
+#define VD_LOG_ASYNC_MAX_THREADS 64
+#endif // !VD_LOG_ASYNC_MAX_THREADS
+
+#ifndef VD_LOG_ASYNC_BATCH_MAX
+#define VD_LOG_ASYNC_BATCH_MAX 64
+#endif // !VD_LOG_ASYNC_BATCH_MAX
+
+typedef struct __VD_LogAsyncInitInfo {
+    /** Size in bytes of each thread's ring (rounded up to a power of two). 0 selects 64KB. */
+    Vdu32 ring_size;
+    /** How many times a producer spins waiting for space before dropping its record. 0 drops immediately. */
+    Vdu32 max_spins;
+    /** How long the writer thread sleeps when there is nothing to write. 0 selects 1ms. */
+    Vdu32 idle_sleep_ms;
+    /** The file descriptor to write to (POSIX). 0 selects stdout. Ignored on Windows, which always uses stdout. */
+    int   fd;
+} VdLogAsyncInitInfo;
+
+typedef struct __VD_LogAsyncStats {
+    Vdu64 num_written;
+    Vdu64 num_dropped;
+    Vdu64 num_batches;
+} VdLogAsyncStats;
 
-#if VD_INCLUDE_TESTS && !VD_HOST_COMPILER_UNKNOWN
-extern VdArena *Test_Arena;
+/**
+ * @brief Starts the writer thread. Then set VdThreadContext.log (or VdInitInfo.proc_log) to vd_log_async.
+ *
+ * @details Each producing thread gets its own single-producer ring on its first message after this call; before it,
+ *          and with more than VD_LOG_ASYNC_MAX_THREADS live producers, messages take the synchronous path. A record is
+ *          the string passed to VdProcLog; VD_LOG_IMPL still formats on the caller, but the caller never touches stdio
+ *          locks or the terminal. The writer thread gathers records and flushes them with one writev per batch.
+ */
+VD_API void            vd_log_async_start(VdLogAsyncInitInfo *info);
+VD_API void            vd_log_async_stop(void);
+VD_API void            vd_log_async_flush(void);
+VD_API VdLogAsyncStats vd_log_async_get_stats(void);
+VD_API void            vd_log_async_install_crash_hook(void);
+VD_API VD_PROC_LOG(vd_log_async);
 
-typedef struct __VD_TestResult {
-    int         ok;
-    const char  *err;
-} VdTestResult;
+/**
+ * @brief Gives the calling thread's ring back so another thread can reuse it. Threads started with vd_thread_create
+ *        do this on their own when they exit; call it before any other thread that logged exits.
+ */
+VD_API void            vd_log_async_release_thread(void);
 
-#define VD_PROC_TEST(name) VdTestResult name(void)
-typedef VD_PROC_TEST(VdProcTest);
+#if VD_MACRO_ABBREVIATIONS
+#define LogAsyncInitInfo                VdLogAsyncInitInfo
+#define LogAsyncStats                   VdLogAsyncStats
+#define log_async_start(info)           vd_log_async_start(info)
+#define log_async_stop()                vd_log_async_stop()
+#define log_async_flush()               vd_log_async_flush()
+#define log_async_get_stats()           vd_log_async_get_stats()
+#define log_async_install_crash_hook()  vd_log_async_install_crash_hook()
+#define log_async_release_thread()      vd_log_async_release_thread()
+#endif // VD_MACRO_ABBREVIATIONS
+#endif // VD_INCLUDE_PLATFORM_SPECIFIC_FUNCTIONALITY
 
-typedef struct __VD_TestEntry {
-    const char   *name;
-    VdProcTest *test;
-} VdTestEntry;
+/* ----FIBER--------------------------------------------------------------------------------------------------------- */
+/**
+ * @brief Stackful fibers: a function that runs on its own stack and can suspend itself anywhere (vd_fiber_yield) to be
+ *        continued later (vd_fiber_resume), possibly on another thread.
+ *
+ * @details Switching saves only the callee-saved registers, in a few lines of assembly for x86-64 (System V) and
+ *          AArch64. Windows uses the system's fiber API. VD_FIBER_SUPPORTED is 0 everywhere else.
+ *
+ *          vd_fiber_create reserves the stack with vd_vm_reserve and leaves an uncommitted guard page below it, so an
+ *          overflow faults instead of silently corrupting memory. vd_fiber_create_arena puts the stack in an arena
+ *          instead: no guard page and no system call, for when many small fibers are needed.
+ *
+ *          VdFiberScheduler runs fibers on a few threads. A fiber waiting on I/O calls vd_fiber_park, and whoever
+ *          completes the I/O calls vd_fiber_scheduler_ready; the idle hook is where workers poll for those completions.
+ */
+#if VD_INCLUDE_PLATFORM_SPECIFIC_FUNCTIONALITY
+#if VD_PLATFORM_WINDOWS || ((defined(__x86_64__) || defined(__aarch64__)) && VD_HOST_COMPILER_CLANG)
+#define VD_FIBER_SUPPORTED 1
+#endif // VD_PLATFORM_WINDOWS || ((defined(__x86_64__) || defined(__aarch64__)) && VD_HOST_COMPILER_CLANG)
+#endif // VD_INCLUDE_PLATFORM_SPECIFIC_FUNCTIONALITY
 
-#define VD_TEST_PROC_ID(counter)        VD_STRING_JOIN2(vd_test_proc_, counter)
-#define VD_TEST_ENTRY_ID(counter)       VD_STRING_JOIN2(vd_test_entry_, counter)
-#define VD_TEST_REG_ID(counter)         VD_STRING_JOIN2(vd_test_reg_, counter)
-#define VD_TEST_REG_PTR_ID(counter)     VD_STRING_JOIN2(vd_test_reg_ptr_, counter)
+#ifndef VD_FIBER_SUPPORTED
+#define VD_FIBER_SUPPORTED 0
+#endif // !VD_FIBER_SUPPORTED
 
-#if VD_HOST_COMPILER_MSVC
-#pragma section(".CRT$XCU", read)
+#if VD_FIBER_SUPPORTED
+#ifndef VD_FIBER_DEFAULT_STACK_SIZE
+#define VD_FIBER_DEFAULT_STACK_SIZE VD_KILOBYTES(64)
+#endif // !VD_FIBER_DEFAULT_STACK_SIZE
 
-#define VD_TEST_IMPL(string, counter) \
-    static VD_PROC_TEST(VD_TEST_PROC_ID(counter)); \
-    static void VD_TEST_REG_ID(counter)(void); \
-    __declspec(allocate(".CRT$XCU")) void (*VD_TEST_REG_PTR_ID(counter))(void) = VD_TEST_REG_ID(counter); \
-    __pragma(comment(linker, "/include:" VD_STRINGIFY(VD_TEST_REG_PTR_ID(counter)))) \
-    static void VD_TEST_REG_ID(counter)(void) {\
-        vd__test_register(string, VD_TEST_PROC_ID(counter)); \
-    } \
+#ifndef VD_FIBER_MAX_THREADS
+#define VD_FIBER_MAX_THREADS 64
+#endif // !VD_FIBER_MAX_THREADS
+
+typedef struct VdFiber VdFiber;
+typedef struct VdFiberScheduler VdFiberScheduler;
+
+#define VD_PROC_FIBER(name) void name(VdFiber *fiber, void *userdata)
+typedef VD_PROC_FIBER(VdProcFiber);
+
+/**
+ * @brief Called by scheduler workers that found nothing to run. Returns whether it made progress (for example, woke
+ *        fibers whose I/O completed); if not, the worker yields its thread before trying again. Must be thread-safe.
+ */
+#define VD_PROC_FIBER_IDLE(name) Vdb32 name(VdFiberScheduler *scheduler, void *userdata)
+typedef VD_PROC_FIBER_IDLE(VdProcFiberIdle);
+
+typedef enum {
+    VD_FIBER_STATE_READY = 0,
+    VD_FIBER_STATE_RUNNING,
+    VD_FIBER_STATE_SUSPENDED,
+    VD_FIBER_STATE_DONE,
+} VdFiberState;
+
+struct VdFiber {
+    /** Saved stack pointer of the fiber while it isn't running (its fiber handle on Windows). */
+    void             *sp;
+    /** Saved stack pointer of whoever resumed it (their fiber handle on Windows). */
+    void             *caller_sp;
+    VdProcFiber      *proc;
+    void             *userdata;
+    /** Passed between vd_fiber_resume and vd_fiber_yield. */
+    void             *value;
+    Vdu8             *stack;
+    Vdusize          stack_size;
+    /** Size of the vd_vm_reserve reservation, 0 for arena stacks. */
+    Vdusize          reserve_size;
+    volatile Vdu32   state;
+    volatile Vdu32   sched_state;
+    VdFiberScheduler *scheduler;
+    VdFiber          *next;
+};
+
+struct VdFiberScheduler {
+    VdFiber         *head;
+    VdFiber         *tail;
+    volatile Vdu32  lock;
+    /** Spawned fibers that haven't finished. */
+    volatile Vdu32  live;
+    VdProcFiberIdle *idle;
+    void            *idle_userdata;
+};
+
+/**
+ * @brief Creates a fiber with a VM-backed stack of at least stack_size bytes (0 for VD_FIBER_DEFAULT_STACK_SIZE) and a
+ *        guard page. The VdFiber itself lives at the top of the same reservation. Free it with vd_fiber_destroy.
+ */
+VD_API VdFiber*     vd_fiber_create(VdProcFiber *proc, void *userdata, Vdusize stack_size);
+/**
+ * @brief Creates a fiber and its stack in a, without a guard page. vd_fiber_destroy is only needed on Windows.
+ */
+VD_API VdFiber*     vd_fiber_create_arena(VdArena *a, VdProcFiber *proc, void *userdata, Vdusize stack_size);
+VD_API void         vd_fiber_destroy(VdFiber *fiber);
+/**
+ * @brief Restarts a finished fiber with a new function, reusing its stack.
+ */
+VD_API void         vd_fiber_reset(VdFiber *fiber, VdProcFiber *proc, void *userdata);
+
+/**
+ * @brief Runs fiber until it yields or returns. value is returned by the vd_fiber_yield call it continues from. Returns
+ *        the value passed to vd_fiber_yield, or 0 if the fiber finished.
+ */
+VD_API void*        vd_fiber_resume(VdFiber *fiber, void *value);
+/**
+ * @brief Suspends the current fiber and returns to whoever resumed it. Returns the value passed to the next resume.
+ */
+VD_API void*        vd_fiber_yield(void *value);
+/**
+ * @brief The fiber running on this thread, or 0 when called outside of any fiber.
+ */
+VD_API VdFiber*     vd_fiber_current(void);
+VD_API VdFiberState vd_fiber_get_state(VdFiber *fiber);
+
+VD_API void         vd_fiber_scheduler_init(VdFiberScheduler *scheduler, VdProcFiberIdle *idle, void *idle_userdata);
+/**
+ * @brief Queues a fiber to run on the scheduler. Can be called from any thread, including from scheduled fibers.
+ */
+VD_API void         vd_fiber_scheduler_spawn(VdFiberScheduler *scheduler, VdFiber *fiber);
+/**
+ * @brief Wakes a fiber that called vd_fiber_park. Can be called from any thread, even before the fiber has parked: the
+ *        wake-up is then remembered and its next vd_fiber_park returns immediately. Wake-ups don't accumulate.
+ */
+VD_API void         vd_fiber_scheduler_ready(VdFiberScheduler *scheduler, VdFiber *fiber);
+/**
+ * @brief Runs spawned fibers on num_threads threads (the calling thread included; 0 for one per CPU) until all of
+ *        them have finished. A scheduled fiber that calls vd_fiber_yield is put back at the end of the queue.
+ */
+VD_API void         vd_fiber_scheduler_run(VdFiberScheduler *scheduler, Vdu32 num_threads);
+/**
+ * @brief Suspends the current scheduled fiber until vd_fiber_scheduler_ready is called on it.
+ */
+VD_API void         vd_fiber_park(void);
+
+#if VD_MACRO_ABBREVIATIONS
+#define Fiber                                          VdFiber
+#define FiberScheduler                                 VdFiberScheduler
+#define FiberState                                     VdFiberState
+#define ProcFiber                                      VdProcFiber
+#define ProcFiberIdle                                  VdProcFiberIdle
+#define fiber_create(proc, userdata, stack_size)       vd_fiber_create(proc, userdata, stack_size)
+#define fiber_create_arena(a, proc, userdata, size)    vd_fiber_create_arena(a, proc, userdata, size)
+#define fiber_destroy(fiber)                           vd_fiber_destroy(fiber)
+#define fiber_reset(fiber, proc, userdata)             vd_fiber_reset(fiber, proc, userdata)
+#define fiber_resume(fiber, value)                     vd_fiber_resume(fiber, value)
+#define fiber_yield(value)                             vd_fiber_yield(value)
+#define fiber_current()                                vd_fiber_current()
+#define fiber_get_state(fiber)                         vd_fiber_get_state(fiber)
+#define fiber_scheduler_init(s, idle, idle_userdata)   vd_fiber_scheduler_init(s, idle, idle_userdata)
+#define fiber_scheduler_spawn(s, fiber)                vd_fiber_scheduler_spawn(s, fiber)
+#define fiber_scheduler_ready(s, fiber)                vd_fiber_scheduler_ready(s, fiber)
+#define fiber_scheduler_run(s, num_threads)            vd_fiber_scheduler_run(s, num_threads)
+#define fiber_park()                                   vd_fiber_park()
+#endif // VD_MACRO_ABBREVIATIONS
+#endif // VD_FIBER_SUPPORTED
+
+/* ----TESTING------------------------------------------------------------------------------------------------------- */
+#ifndef VD_INCLUDE_TESTS
+#define VD_INCLUDE_TESTS 0
+#endif // VD_INCLUDE_TESTS
+
+#if VD_INCLUDE_TESTS && !VD_HOST_COMPILER_UNKNOWN
+extern VdArena *Test_Arena;
+
+typedef struct __VD_TestResult {
+    int         ok;
+    const char  *err;
+} VdTestResult;
+
+#define VD_PROC_TEST(name) VdTestResult name(void)
+typedef VD_PROC_TEST(VdProcTest);
+
+typedef struct __VD_TestEntry {
+    const char   *name;
+    VdProcTest *test;
+} VdTestEntry;
+
+#define VD_TEST_PROC_ID(counter)        VD_STRING_JOIN2(vd_test_proc_, counter)
+#define VD_TEST_ENTRY_ID(counter)       VD_STRING_JOIN2(vd_test_entry_, counter)
+#define VD_TEST_REG_ID(counter)         VD_STRING_JOIN2(vd_test_reg_, counter)
+#define VD_TEST_REG_PTR_ID(counter)     VD_STRING_JOIN2(vd_test_reg_ptr_, counter)
+
+#if VD_HOST_COMPILER_MSVC
+#pragma section(".CRT$XCU", read)
+
+#define VD_TEST_IMPL(string, counter) \
+    static VD_PROC_TEST(VD_TEST_PROC_ID(counter)); \
+    static void VD_TEST_REG_ID(counter)(void); \
+    __declspec(allocate(".CRT$XCU")) void (*VD_TEST_REG_PTR_ID(counter))(void) = VD_TEST_REG_ID(counter); \
+    __pragma(comment(linker, "/include:" VD_STRINGIFY(VD_TEST_REG_PTR_ID(counter)))) \
+    static void VD_TEST_REG_ID(counter)(void) {\
+        vd__test_register(string, VD_TEST_PROC_ID(counter)); \
+    } \
     static VD_PROC_TEST(VD_TEST_PROC_ID(counter))
 
 #elif VD_HOST_COMPILER_CLANG
@@ -1969,7 +3754,7 @@ VD_API void vd_init(VdInitInfo *info) {
     *thread_context_ptr = thread_context;
     VdScratch *scratch = (VdScratch*)((Vduptr)(thread_context) + VD_THREAD_CONTEXT_SCRATCH_OFF());
     VdProcLog **proc_log = (VdProcLog**)((Vduptr)(thread_context) + VD_THREAD_CONTEXT_LOG_OFF());
-    *proc_log = vd__default_log;
+    *proc_log = (info && info->proc_log) ? info->proc_log : vd__default_log;
 
     allocation += sizeof(VD_THREAD_CONTEXT_TYPE);
 
@@ -1995,6 +3780,407 @@ static VD_PROC_LOG(vd__default_log)
 #endif
 }
 
+/* ----LOG ASYNC IMPL------------------------------------------------------------------------------------------------ */
+#if VD_INCLUDE_PLATFORM_SPECIFIC_FUNCTIONALITY
+#if VD_PLATFORM_WINDOWS
+#include <windows.h>
+
+typedef struct {
+    void    *iov_base;
+    Vdusize iov_len;
+} Vd__LogAsyncIov;
+#else
+#include <sys/uio.h>
+#include <signal.h>
+#include <unistd.h>
+#include <errno.h>
+
+typedef struct iovec Vd__LogAsyncIov;
+#endif // VD_PLATFORM_WINDOWS, else
+
+#define VD__LOG_ASYNC_RECORD_WRAP VD_U32_MAX
+
+typedef struct {
+    Vdu32 len;
+    Vdi32 verbosity;
+} Vd__LogAsyncRecord;
+
+typedef struct {
+    // Producer and consumer cursors live on separate cache lines
+    volatile Vdu64 head;
+    Vdu8           pad0[56];
+    volatile Vdu64 tail;
+    Vdu8           pad1[56];
+    // 1 while a thread produces into the ring, 0 once it exited and any thread may claim it
+    volatile Vdu32 owned;
+    Vdu32          cap;
+    Vdu8           *buf;
+} Vd__LogAsyncRing;
+
+typedef struct {
+    Vd__LogAsyncRing * volatile rings[VD_LOG_ASYNC_MAX_THREADS];
+    volatile Vdu32              num_rings;
+    volatile Vdu32              running;
+    volatile Vdu32              draining;
+    volatile Vdu64              num_written;
+    volatile Vdu64              num_dropped;
+    volatile Vdu64              num_batches;
+    Vdu64                       num_dropped_reported;
+    Vdu32                       ring_size;
+    Vdu32                       max_spins;
+    Vdu32                       idle_sleep_ms;
+    int                         fd;
+    VdThread                    thread;
+} Vd__LogAsyncState;
+
+static Vd__LogAsyncState                  Vd__Log_Async_State;
+static VD_THREAD_LOCAL Vd__LogAsyncRing  *Vd__Log_Async_Thread_Ring;
+
+static const VdStr Vd__Log_Async_Prefixes[] = {
+    VD_LIT_INLINE("[ERR]: "),
+    VD_LIT_INLINE("[WRN]: "),
+    VD_LIT_INLINE("[LOG]: "),
+    VD_LIT_INLINE("[DBG]: "),
+};
+
+static const VdStr *vd__log_async_prefix(int verbosity)
+{
+    if (verbosity >= VD_LOG_VERBOSITY_DEBUG)   return &Vd__Log_Async_Prefixes[3];
+    if (verbosity >= VD_LOG_VERBOSITY_LOG)     return &Vd__Log_Async_Prefixes[2];
+    if (verbosity >= VD_LOG_VERBOSITY_WARNING) return &Vd__Log_Async_Prefixes[1];
+    return &Vd__Log_Async_Prefixes[0];
+}
+
+static Vd__LogAsyncRing *vd__log_async_get_ring(void)
+{
+    // Until vd_log_async_start runs (and after vd_log_async_stop) there is no ring size to allocate with and no writer
+    // to drain the ring, so don't claim one yet
+    if (!vd_atomic_load_u32(&Vd__Log_Async_State.running)) {
+        return 0;
+    }
+
+    Vdu32 cap = Vd__Log_Async_State.ring_size;
+    Vd__LogAsyncRing *ring = Vd__Log_Async_Thread_Ring;
+    if (ring != 0) {
+        if (ring->cap == cap) {
+            return ring;
+        }
+
+        // Restarted with a different ring size
+        vd_log_async_release_thread();
+    }
+
+    // Prefer a ring left behind by a thread that exited; whatever it still holds gets drained before our records
+    Vdu32 num_rings = vd_atomic_load_u32(&Vd__Log_Async_State.num_rings);
+    if (num_rings > VD_LOG_ASYNC_MAX_THREADS) {
+        num_rings = VD_LOG_ASYNC_MAX_THREADS;
+    }
+
+    for (Vdu32 i = 0; i < num_rings; ++i) {
+        ring = (Vd__LogAsyncRing*)vd_atomic_load_ptr((void * volatile *)&Vd__Log_Async_State.rings[i]);
+        if ((ring != 0) && (ring->cap == cap) && vd_atomic_cas_u32(&ring->owned, 0, 1)) {
+            Vd__Log_Async_Thread_Ring = ring;
+            return ring;
+        }
+    }
+
+    Vdu32 index = vd_atomic_fetch_add_u32(&Vd__Log_Async_State.num_rings, 1);
+    if (index >= VD_LOG_ASYNC_MAX_THREADS) {
+        return 0;
+    }
+
+    ring = (Vd__LogAsyncRing*)VD_MALLOC(sizeof(Vd__LogAsyncRing) + cap);
+    VD_MEMSET(ring, 0, sizeof(Vd__LogAsyncRing));
+    ring->owned = 1;
+    ring->cap   = cap;
+    ring->buf   = (Vdu8*)(ring + 1);
+
+    vd_atomic_store_ptr((void * volatile *)&Vd__Log_Async_State.rings[index], ring);
+    Vd__Log_Async_Thread_Ring = ring;
+    return ring;
+}
+
+VD_API void vd_log_async_release_thread(void)
+{
+    Vd__LogAsyncRing *ring = Vd__Log_Async_Thread_Ring;
+    if (ring == 0) {
+        return;
+    }
+
+    Vd__Log_Async_Thread_Ring = 0;
+    vd_atomic_store_u32(&ring->owned, 0);
+}
+
+static void vd__log_async_write(Vd__LogAsyncIov *iov, int count);
+
+VD_API VD_PROC_LOG(vd_log_async)
+{
+    Vd__LogAsyncRing *ring = vd__log_async_get_ring();
+    if (ring == 0) {
+        // Not started yet, or more producer threads than VD_LOG_ASYNC_MAX_THREADS: keep the message, pay for the
+        // synchronous path.
+        vd__default_log(verbosity, string);
+        return;
+    }
+
+    Vdu32 len = (Vdu32)vd_cstr_len(string);
+    if (len > ring->cap / 4) {
+        len = ring->cap / 4;
+    }
+
+    Vdu32 record_size = (Vdu32)vd_align_forward(sizeof(Vd__LogAsyncRecord) + len, 8);
+    Vdu64 head        = ring->head;
+    Vdu32 pos         = (Vdu32)(head & (ring->cap - 1));
+    Vdu32 skip        = (ring->cap - pos) < record_size ? (ring->cap - pos) : 0;
+
+    Vdu32 spins = 0;
+    while ((head + skip + record_size) - vd_atomic_load_u64(&ring->tail) > ring->cap) {
+        if (spins++ >= Vd__Log_Async_State.max_spins) {
+            vd_atomic_fetch_add_u64(&Vd__Log_Async_State.num_dropped, 1);
+            return;
+        }
+
+        vd_cpu_relax();
+    }
+
+    if (skip) {
+        // Records never straddle the end of the ring so the writer can point an iovec straight at them
+        ((Vd__LogAsyncRecord*)(ring->buf + pos))->len = VD__LOG_ASYNC_RECORD_WRAP;
+        head += skip;
+        pos = 0;
+    }
+
+    Vd__LogAsyncRecord *record = (Vd__LogAsyncRecord*)(ring->buf + pos);
+    record->len       = len;
+    record->verbosity = verbosity;
+    VD_MEMCPY(record + 1, string, len);
+
+    vd_atomic_store_u64(&ring->head, head + record_size);
+}
+
+static Vdu32 vd__log_async_drain_ring(Vd__LogAsyncRing *ring)
+{
+    Vd__LogAsyncIov iov[VD_LOG_ASYNC_BATCH_MAX * 2];
+    int             num_iov     = 0;
+    Vdu32           num_records = 0;
+    Vdu64           tail        = ring->tail;
+    Vdu64           head        = vd_atomic_load_u64(&ring->head);
+
+    while ((tail < head) && (num_iov < (int)VD_ARRAY_COUNT(iov))) {
+        Vdu32 pos = (Vdu32)(tail & (ring->cap - 1));
+        Vd__LogAsyncRecord *record = (Vd__LogAsyncRecord*)(ring->buf + pos);
+
+        if (record->len == VD__LOG_ASYNC_RECORD_WRAP) {
+            tail += ring->cap - pos;
+            continue;
+        }
+
+        const VdStr *prefix = vd__log_async_prefix(record->verbosity);
+        iov[num_iov].iov_base = prefix->s;
+        iov[num_iov].iov_len  = prefix->len;
+        num_iov++;
+        iov[num_iov].iov_base = (void*)(record + 1);
+        iov[num_iov].iov_len  = record->len;
+        num_iov++;
+
+        tail += vd_align_forward(sizeof(Vd__LogAsyncRecord) + record->len, 8);
+        num_records++;
+    }
+
+    if (num_iov > 0) {
+        vd__log_async_write(iov, num_iov);
+        vd_atomic_fetch_add_u64(&Vd__Log_Async_State.num_written, num_records);
+        vd_atomic_fetch_add_u64(&Vd__Log_Async_State.num_batches, 1);
+    }
+
+    // Release the space only after the iovecs pointing into it have been written
+    vd_atomic_store_u64(&ring->tail, tail);
+    return num_records;
+}
+
+static Vdu32 vd__log_async_drain(Vdu32 max_lock_spins)
+{
+    Vdu32 spins = 0;
+    while (!vd_atomic_cas_u32(&Vd__Log_Async_State.draining, 0, 1)) {
+        if (spins++ >= max_lock_spins) {
+            return 0;
+        }
+
+        vd_cpu_relax();
+    }
+
+    Vdu32 total     = 0;
+    Vdu32 num_rings = vd_atomic_load_u32(&Vd__Log_Async_State.num_rings);
+    if (num_rings > VD_LOG_ASYNC_MAX_THREADS) {
+        num_rings = VD_LOG_ASYNC_MAX_THREADS;
+    }
+
+    for (Vdu32 i = 0; i < num_rings; ++i) {
+        Vd__LogAsyncRing *ring = (Vd__LogAsyncRing*)vd_atomic_load_ptr((void * volatile *)&Vd__Log_Async_State.rings[i]);
+        if (ring == 0) continue;
+
+        Vdu32 n;
+        while ((n = vd__log_async_drain_ring(ring)) > 0) {
+            total += n;
+        }
+    }
+
+    Vdu64 num_dropped = vd_atomic_load_u64(&Vd__Log_Async_State.num_dropped);
+    if (num_dropped != Vd__Log_Async_State.num_dropped_reported) {
+        // Formatted by hand since this also runs from the crash handler, where snprintf isn't safe to call
+        static const char prefix[] = "[WRN]: async log dropped ";
+        static const char suffix[] = " message(s)\n";
+        char  digits[20];
+        Vdu32 num_digits = 0;
+        Vdu64 n          = num_dropped - Vd__Log_Async_State.num_dropped_reported;
+        do {
+            digits[sizeof(digits) - 1 - num_digits++] = (char)('0' + (n % 10));
+            n /= 10;
+        } while (n != 0);
+
+        Vd__LogAsyncIov iov[3];
+        iov[0].iov_base = (void*)prefix;
+        iov[0].iov_len  = sizeof(prefix) - 1;
+        iov[1].iov_base = digits + sizeof(digits) - num_digits;
+        iov[1].iov_len  = num_digits;
+        iov[2].iov_base = (void*)suffix;
+        iov[2].iov_len  = sizeof(suffix) - 1;
+        vd__log_async_write(iov, 3);
+        Vd__Log_Async_State.num_dropped_reported = num_dropped;
+    }
+
+    vd_atomic_store_u32(&Vd__Log_Async_State.draining, 0);
+    return total;
+}
+
+static VD_PROC_THREAD(vd__log_async_thread)
+{
+    VD_UNUSED(userdata);
+
+    while (vd_atomic_load_u32(&Vd__Log_Async_State.running)) {
+        if (vd__log_async_drain(VD_U32_MAX) == 0) {
+            vd_thread_sleep_ms(Vd__Log_Async_State.idle_sleep_ms);
+        }
+    }
+
+    vd__log_async_drain(VD_U32_MAX);
+}
+
+VD_API void vd_log_async_start(VdLogAsyncInitInfo *info)
+{
+    Vdu32 ring_size = (info && info->ring_size) ? info->ring_size : (Vdu32)VD_KILOBYTES(64);
+    Vdu32 cap = 256;
+    while (cap < ring_size) cap <<= 1;
+
+    Vd__Log_Async_State.ring_size     = cap;
+    Vd__Log_Async_State.max_spins     = info ? info->max_spins : 0;
+    Vd__Log_Async_State.idle_sleep_ms = (info && info->idle_sleep_ms) ? info->idle_sleep_ms : 1;
+    Vd__Log_Async_State.fd            = (info && info->fd) ? info->fd : 1;
+
+    vd_atomic_store_u32(&Vd__Log_Async_State.running, 1);
+    if (!vd_thread_create(&Vd__Log_Async_State.thread, vd__log_async_thread, 0)) {
+        // Nothing would drain the rings, so keep logging synchronously
+        vd_atomic_store_u32(&Vd__Log_Async_State.running, 0);
+        vd__log_async_drain(VD_U32_MAX);
+    }
+}
+
+VD_API void vd_log_async_stop(void)
+{
+    if (!vd_atomic_load_u32(&Vd__Log_Async_State.running)) {
+        return;
+    }
+
+    vd_atomic_store_u32(&Vd__Log_Async_State.running, 0);
+    vd_thread_join(&Vd__Log_Async_State.thread);
+}
+
+VD_API void vd_log_async_flush(void)
+{
+    vd__log_async_drain(VD_U32_MAX);
+}
+
+VD_API VdLogAsyncStats vd_log_async_get_stats(void)
+{
+    VdLogAsyncStats result;
+    result.num_written = vd_atomic_load_u64(&Vd__Log_Async_State.num_written);
+    result.num_dropped = vd_atomic_load_u64(&Vd__Log_Async_State.num_dropped);
+    result.num_batches = vd_atomic_load_u64(&Vd__Log_Async_State.num_batches);
+    return result;
+}
+
+#if VD_PLATFORM_WINDOWS
+static void vd__log_async_write(Vd__LogAsyncIov *iov, int count)
+{
+    HANDLE out = GetStdHandle(STD_OUTPUT_HANDLE);
+    for (int i = 0; i < count; ++i) {
+        DWORD written;
+        WriteFile(out, iov[i].iov_base, (DWORD)iov[i].iov_len, &written, 0);
+    }
+}
+
+static LONG WINAPI vd__log_async_crash_filter(EXCEPTION_POINTERS *info)
+{
+    VD_UNUSED(info);
+    vd__log_async_drain(1 << 20);
+    return EXCEPTION_CONTINUE_SEARCH;
+}
+
+VD_API void vd_log_async_install_crash_hook(void)
+{
+    SetUnhandledExceptionFilter(vd__log_async_crash_filter);
+}
+#else
+static void vd__log_async_write(Vd__LogAsyncIov *iov, int count)
+{
+    while (count > 0) {
+        ssize_t written = writev(Vd__Log_Async_State.fd, iov, count);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return;
+        }
+
+        // Skip over fully written iovecs and adjust the partially written one
+        while ((count > 0) && ((Vdusize)written >= iov->iov_len)) {
+            written -= (ssize_t)iov->iov_len;
+            iov++;
+            count--;
+        }
+
+        if (count > 0) {
+            iov->iov_base = (Vdu8*)iov->iov_base + written;
+            iov->iov_len -= (Vdusize)written;
+        }
+    }
+}
+
+static void vd__log_async_crash_handler(int sig)
+{
+    // Only writev and atomics run here. If the writer thread holds the drain lock, wait a bounded amount of time for
+    // it, since the crashing thread may be the one holding it.
+    vd__log_async_drain(1 << 20);
+    raise(sig);
+}
+
+VD_API void vd_log_async_install_crash_hook(void)
+{
+    static const int signals[] = { SIGSEGV, SIGBUS, SIGILL, SIGFPE, SIGABRT };
+
+    struct sigaction action;
+    VD_MEMSET(&action, 0, sizeof(action));
+    action.sa_handler = vd__log_async_crash_handler;
+    action.sa_flags   = SA_RESETHAND;
+    sigemptyset(&action.sa_mask);
+
+    for (Vdusize i = 0; i < VD_ARRAY_COUNT(signals); ++i) {
+        sigaction(signals[i], &action, 0);
+    }
+}
+#endif // VD_PLATFORM_WINDOWS, else
+
+#undef VD__LOG_ASYNC_RECORD_WRAP
+#endif // VD_INCLUDE_PLATFORM_SPECIFIC_FUNCTIONALITY
+
 /* ----TIMING IMPL--------------------------------------------------------------------------------------------------- */
 #if VD_PLATFORM_WINDOWS
 #include <windows.h>
@@ -2126,7 +4312,7 @@ VdHiTime vd_hitime_sub(VdHiTime a, VdHiTime b)
 
 Vdu64 vd_hitime_ns(VdHiTime time_spec)
 {
-    return (Vdu64)time_spec.time.tv_nsec;
+    return (Vdu64)time_spec.time.tv_sec * 1000000000ULL + (Vdu64)time_spec.time.tv_nsec;
 }
 
 Vdf64 vd_hitime_fms64(VdHiTime time_spec)
@@ -2153,7 +4339,7 @@ Vdu64 vd_hitime_ms(VdHiTime time_spec)
 
 Vdusize vd_vm_get_page_size(void)
 {
-    return _SC_PAGE_SIZE;
+    return (Vdusize)sysconf(_SC_PAGE_SIZE);
 }
 
 void *vd_vm_reserve(Vdusize len)
@@ -2198,7 +4384,7 @@ void vd_vm_release(void *addr, Vdusize len)
 
 Vdusize vd_vm_get_page_size(void)
 {
-    return _SC_PAGE_SIZE;
+    return (Vdusize)sysconf(_SC_PAGE_SIZE);
 }
 
 void *vd_vm_reserve(Vdusize len)
@@ -2273,41 +4459,161 @@ void vd_vm_release(void *addr, Vdusize len)
 #endif // !VD_VM_CUSTOM
 #endif // VD_INCLUDE_PLATFORM_SPECIFIC_FUNCTIONALITY
 
-/* ----SYSTEM ALLOCATOR IMPL----------------------------------------------------------------------------------------- */
-#define VD_SYSTEM_HEAP_RESERVE_PAGE_COUNT 16000
-
-static VdSystemHeap Vd_System_Heap_Global = {0};
+/* ----THREAD IMPL--------------------------------------------------------------------------------------------------- */
+#if VD_INCLUDE_PLATFORM_SPECIFIC_FUNCTIONALITY
+#if VD_PLATFORM_WINDOWS
+#include <windows.h>
 
-VD_API VdSystemHeap *vd_system_heap_global(void)
+static DWORD WINAPI vd__thread_entry(LPVOID param)
 {
-    return &Vd_System_Heap_Global;
+    VdThread *thread = (VdThread*)param;
+    thread->proc(thread->userdata);
+    vd_log_async_release_thread();
+    return 0;
 }
 
-VD_API void vd_system_heap_set_reserve_page_count(VdSystemHeap *h, Vdusize page_count)
+VD_API Vdb32 vd_thread_create(VdThread *thread, VdProcThread *proc, void *userdata)
 {
-    VD_ASSERT(h->buf != 0 && "Heap has already been allocated!");
-    if (h->page_size == 0) {
-        h->page_size = vd_vm_get_page_size();
-    }
+    thread->proc     = proc;
+    thread->userdata = userdata;
+    HANDLE handle = CreateThread(0, 0, vd__thread_entry, thread, 0, 0);
+    thread->handle = (Vdu64)(Vduptr)handle;
+    return handle != 0;
+}
 
-    h->reserved = h->page_size * page_count;
+VD_API void vd_thread_join(VdThread *thread)
+{
+    HANDLE handle = (HANDLE)(Vduptr)thread->handle;
+    WaitForSingleObject(handle, INFINITE);
+    CloseHandle(handle);
 }
 
-VD_API void *vd_system_heap_alloc(VdSystemHeap *h, Vdusize size, Vdusize align)
+VD_API void vd_thread_yield(void)
 {
-    if (h->buf == 0) {
-        if (h->page_size == 0) {
-            h->page_size = vd_vm_get_page_size();
-        }
+    SwitchToThread();
+}
 
-        if (h->reserved == 0) {
-            h->reserved = h->page_size * VD_SYSTEM_HEAP_RESERVE_PAGE_COUNT;
-        }
+VD_API void vd_thread_sleep_ms(Vdu32 ms)
+{
+    Sleep(ms);
+}
 
-        h->buf = (Vduptr)vd_vm_reserve(h->reserved);
-    }
+VD_API Vdu32 vd_thread_get_id(void)
+{
+    return (Vdu32)GetCurrentThreadId();
+}
 
-    // PAGE  0 |---------|
+VD_API Vdu32 vd_get_num_cpus(void)
+{
+    SYSTEM_INFO system_info;
+    GetSystemInfo(&system_info);
+    return (Vdu32)system_info.dwNumberOfProcessors;
+}
+
+#elif VD_PLATFORM_LINUX || VD_PLATFORM_MACOS
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#if VD_PLATFORM_LINUX
+#include <sys/syscall.h>
+#endif // VD_PLATFORM_LINUX
+
+static void *vd__thread_entry(void *param)
+{
+    VdThread *thread = (VdThread*)param;
+    thread->proc(thread->userdata);
+    vd_log_async_release_thread();
+    return 0;
+}
+
+VD_API Vdb32 vd_thread_create(VdThread *thread, VdProcThread *proc, void *userdata)
+{
+    pthread_t handle;
+    thread->proc     = proc;
+    thread->userdata = userdata;
+
+    if (pthread_create(&handle, 0, vd__thread_entry, thread) != 0) {
+        return VD_FALSE;
+    }
+
+    VD_MEMCPY(&thread->handle, &handle, sizeof(handle) < sizeof(thread->handle) ? sizeof(handle) : sizeof(thread->handle));
+    return VD_TRUE;
+}
+
+VD_API void vd_thread_join(VdThread *thread)
+{
+    pthread_t handle;
+    VD_MEMCPY(&handle, &thread->handle, sizeof(handle) < sizeof(thread->handle) ? sizeof(handle) : sizeof(thread->handle));
+    pthread_join(handle, 0);
+}
+
+VD_API void vd_thread_yield(void)
+{
+    sched_yield();
+}
+
+VD_API void vd_thread_sleep_ms(Vdu32 ms)
+{
+    struct timespec ts;
+    ts.tv_sec  = ms / 1000;
+    ts.tv_nsec = (long)(ms % 1000) * 1000000L;
+    nanosleep(&ts, 0);
+}
+
+VD_API Vdu32 vd_thread_get_id(void)
+{
+#if VD_PLATFORM_LINUX
+    return (Vdu32)syscall(SYS_gettid);
+#else
+    Vdu64 tid;
+    pthread_threadid_np(0, &tid);
+    return (Vdu32)tid;
+#endif // VD_PLATFORM_LINUX, else
+}
+
+VD_API Vdu32 vd_get_num_cpus(void)
+{
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (Vdu32)n : 1;
+}
+#endif // VD_PLATFORM_WINDOWS, VD_PLATFORM_LINUX || VD_PLATFORM_MACOS
+#endif // VD_INCLUDE_PLATFORM_SPECIFIC_FUNCTIONALITY
+
+/* ----SYSTEM ALLOCATOR IMPL----------------------------------------------------------------------------------------- */
+#define VD_SYSTEM_HEAP_RESERVE_PAGE_COUNT 16000
+
+static VdSystemHeap Vd_System_Heap_Global = {0};
+
+VD_API VdSystemHeap *vd_system_heap_global(void)
+{
+    return &Vd_System_Heap_Global;
+}
+
+VD_API void vd_system_heap_set_reserve_page_count(VdSystemHeap *h, Vdusize page_count)
+{
+    VD_ASSERT(h->buf != 0 && "Heap has already been allocated!");
+    if (h->page_size == 0) {
+        h->page_size = vd_vm_get_page_size();
+    }
+
+    h->reserved = h->page_size * page_count;
+}
+
+VD_API void *vd_system_heap_alloc(VdSystemHeap *h, Vdusize size, Vdusize align)
+{
+    if (h->buf == 0) {
+        if (h->page_size == 0) {
+            h->page_size = vd_vm_get_page_size();
+        }
+
+        if (h->reserved == 0) {
+            h->reserved = h->page_size * VD_SYSTEM_HEAP_RESERVE_PAGE_COUNT;
+        }
+
+        h->buf = (Vduptr)vd_vm_reserve(h->reserved);
+    }
+
+    // PAGE  0 |---------|
     //         [+++++++++|
     //         |+++++++++|
     //         |+++++++++|
@@ -2362,12 +4668,26 @@ VD_API void vd_system_heap_empty(VdSystemHeap *h)
 }
 
 /* ----ARENA IMPL---------------------------------------------------------------------------------------------------- */
+#if VD_ARENA_TRACK
+static void vd__arena_track_record(VdArena *a, Vdusize size);
+#define VD__ARENA_TRACK_RECORD(a, size) vd__arena_track_record(a, size)
+#else
+#define VD__ARENA_TRACK_RECORD(a, size)
+#endif // VD_ARENA_TRACK
+
 void vd_arena_init(VdArena *a, void *buf, size_t len)
 {
     a->buf = (Vdu8*)buf;
     a->buf_len = len;
     a->curr_offset = 0;
     a->prev_offset = 0;
+    a->flags = 0;
+#if VD_ARENA_TRACK
+    a->track_peak       = 0;
+    a->track_num_allocs = 0;
+    a->track_num_bytes  = 0;
+    a->track_name       = 0;
+#endif // VD_ARENA_TRACK
 }
 
 void *vd_arena_alloc_align(VdArena *a, size_t size, size_t align)
@@ -2386,6 +4706,7 @@ void *vd_arena_alloc_align(VdArena *a, size_t size, size_t align)
             a->curr_offset = offset + size;
         }
 
+        VD__ARENA_TRACK_RECORD(a, size);
         VD_MEMSET(ptr, 0, size);
         return ptr;
     }
@@ -2407,6 +4728,7 @@ void *vd_arena_resize_align(VdArena *a, void *old_memory, size_t old_size, size_
             a->curr_offset = a->prev_offset + new_size;
             if (new_size > old_size) {
                 VD_MEMSET(&a->buf[a->curr_offset], 0, new_size - old_size);
+                VD__ARENA_TRACK_RECORD(a, new_size - old_size);
             }
 
             return old_memory;
@@ -2446,1099 +4768,7703 @@ Vdb32 vd_arena_free(VdArena *a, void *memory, size_t size)
     return VD_FALSE;
 }
 
-/* ----SCRATCH IMPL-------------------------------------------------------------------------------------------------- */
-void vd_scratch_init(VdScratch *scratch)
+#if VD_ARENA_TRACK
+typedef struct {
+    VdArenaTrackSite sites[VD_ARENA_TRACK_MAX_SITES];
+    Vdu32            num_sites;
+    Vdu64            num_dropped;
+} Vd__ArenaTrackState;
+
+static Vd__ArenaTrackState Vd__Arena_Track_State;
+
+// The site table is shared by every thread, so it's only touched with this held
+static volatile Vdu32 Vd__Arena_Track_Lock;
+
+// The call site being evaluated is per thread; another thread's VD_ARENA_TRACK_PTR doesn't change it
+static VD_THREAD_LOCAL const char *Vd__Arena_Track_File;
+static VD_THREAD_LOCAL Vdu32       Vd__Arena_Track_Line;
+
+static void vd__arena_track_lock(void)
 {
-    for (Vdusize i = 0; i < VD_SCRATCH_PAGE_COUNT; ++i)
-    {
-        void *a = (void*)VD_MALLOC(VD_SCRATCH_PAGE_SIZE);
-        VD_MEMSET(a, 0, VD_SCRATCH_PAGE_SIZE);
-        vd_arena_init(&scratch->arenas[i], a, VD_SCRATCH_PAGE_SIZE);
+    while (!vd_atomic_cas_u32(&Vd__Arena_Track_Lock, 0, 1)) {
+        while (vd_atomic_load_u32(&Vd__Arena_Track_Lock) != 0) {}
     }
 }
 
-VdArena *vd_scratch_get_arena(VdScratch *scratch)
+static void vd__arena_track_unlock(void)
 {
-    VD_ASSERT(scratch->curr_arena < VD_SCRATCH_PAGE_COUNT);
-    return &scratch->arenas[scratch->curr_arena++];
+    vd_atomic_store_u32(&Vd__Arena_Track_Lock, 0);
 }
 
-void vd_scratch_return_arena(VdScratch *scratch, VdArena *arena)
+VD_API void vd__arena_track_set_site(const char *file, Vdu32 line)
 {
-    VD_ASSERT(scratch->curr_arena > 0);
-    scratch->curr_arena--;
-    VD_ASSERT(&scratch->arenas[scratch->curr_arena] == arena);
+    Vd__Arena_Track_File = file;
+    Vd__Arena_Track_Line = line;
+}
 
-    VD_MEMSET(scratch->arenas[scratch->curr_arena].buf, 0, scratch->arenas[scratch->curr_arena].buf_len);
-    scratch->arenas[scratch->curr_arena].curr_offset = 0;
-    scratch->arenas[scratch->curr_arena].prev_offset = 0;
+VD_API void *vd__arena_track_end_ptr(void *result)
+{
+    Vd__Arena_Track_File = 0;
+    Vd__Arena_Track_Line = 0;
+    return result;
 }
 
-/* ----THREAD CONTEXT IMPL------------------------------------------------------------------------------------------- */
-VD_THREAD_CONTEXT_TYPE * VD_THREAD_CONTEXT_VARNAME;
+VD_API Vdb32 vd__arena_track_end_b32(Vdb32 result)
+{
+    Vd__Arena_Track_File = 0;
+    Vd__Arena_Track_Line = 0;
+    return result;
+}
 
-/* ----PARSING IMPL-------------------------------------------------------------------------------------------------- */
-Vdb32 vd_parse_u64(VdStr s, Vdu64 *r)
+static VdArenaTrackSite *vd__arena_track_find_site(const char *file, Vdu32 line)
 {
-    Vdu64 result = 0;
-    Vdusize i = 0;
-    while (i < s.len && vd_is_ascii_digit(s.s[i])) {
-        result = result * 10 + (s.s[i] - '0');
-        i++;
-    } 
+    // Open addressing on the line number. __FILE__ may have a different address in each translation unit, so
+    // fall back to comparing the strings themselves when the pointers differ.
+    Vdu32 mask  = VD_ARENA_TRACK_MAX_SITES - 1;
+    Vdu32 index = (line * 2654435761u) & mask;
+
+    for (Vdu32 probe = 0; probe < VD_ARENA_TRACK_MAX_SITES; ++probe) {
+        VdArenaTrackSite *site = &Vd__Arena_Track_State.sites[(index + probe) & mask];
+
+        if (site->num_allocs == 0) {
+            site->file = file;
+            site->line = line;
+            Vd__Arena_Track_State.num_sites++;
+            return site;
+        }
 
-    if (i != s.len) {
-        return VD_FALSE;
+        if (site->line == line) {
+            if ((site->file == file) || (site->file && file && vd_cstr_cmp((Vdcstr)site->file, (Vdcstr)file))) {
+                return site;
+            }
+        }
     }
 
-    *r = result;
-
-    return VD_TRUE;
+    return 0;
 }
 
-/* ----ARG IMPL------------------------------------------------------------------------------------------------------ */
-Vdb32 vd__arg_advance(VdArg *arg) {
-    if ((arg->argi + 1) == arg->argc) {
-        return VD_FALSE;
+static void vd__arena_track_record(VdArena *a, Vdusize size)
+{
+    a->track_num_allocs++;
+    a->track_num_bytes += size;
+    if (a->curr_offset > a->track_peak) {
+        a->track_peak = a->curr_offset;
+    }
+
+    vd__arena_track_lock();
+    VdArenaTrackSite *site = vd__arena_track_find_site(Vd__Arena_Track_File, Vd__Arena_Track_Line);
+    if (site == 0) {
+        Vd__Arena_Track_State.num_dropped++;
     } else {
-        arg->argi++;
-        arg->ci = 0;
-        return VD_TRUE;
+        site->num_allocs++;
+        site->num_bytes += size;
     }
+    vd__arena_track_unlock();
 }
 
-#define VD_ARG_CHECK_NEXT(arg) do {                      \
-        if (arg->ci != 0) {                              \
-            if (vd_arg_at_end(arg)) return VD_FALSE;   \
-            if (!vd__arg_advance(arg)) return VD_FALSE; \
-        }                                                \
-    } while(0)
-
-VdArg vd_arg_new(int argc, char **argv)
+VD_API void vd_arena_track_set_name(VdArena *a, const char *name)
 {
-    VdArg result = {0};
-    result.argc = argc;
-    result.argv = argv;
-    return result;
+    a->track_name = name;
 }
 
-void vd_arg_skip_program_name(VdArg *arg)
+VD_API VdArenaTrackStats vd_arena_track_get_stats(VdArena *a)
 {
-   arg->argi++;
-   arg->ci = 0;
+    VdArenaTrackStats result;
+    result.used       = a->curr_offset;
+    result.peak       = a->track_peak;
+    result.capacity   = a->buf_len;
+    result.num_allocs = a->track_num_allocs;
+    result.num_bytes  = a->track_num_bytes;
+    return result;
 }
 
-Vdb32 vd_arg_at_end(VdArg *arg)
+VD_API Vdu32 vd_arena_track_snapshot(VdArenaTrackSite *sites, Vdu32 max_sites)
 {
-    return (arg->argi == arg->argc) ||
-           (arg->argi == (arg->argc - 1) &&
-            arg->argv[arg->argi][arg->ci] == 0);
+    Vdu32 count = 0;
+
+    vd__arena_track_lock();
+
+    // Insertion into a sorted top-N list; max_sites is expected to be small.
+    for (Vdu32 i = 0; i < VD_ARENA_TRACK_MAX_SITES; ++i) {
+        VdArenaTrackSite *site = &Vd__Arena_Track_State.sites[i];
+        if (site->num_allocs == 0) continue;
+
+        Vdu32 at = count;
+        while ((at > 0) && (sites[at - 1].num_bytes < site->num_bytes)) {
+            at--;
+        }
+
+        if (at >= max_sites) continue;
+
+        Vdu32 last = count < max_sites ? count : max_sites - 1;
+        for (Vdu32 j = last; j > at; --j) {
+            sites[j] = sites[j - 1];
+        }
+
+        sites[at] = *site;
+        if (count < max_sites) count++;
+    }
+
+    vd__arena_track_unlock();
+    return count;
 }
 
-void vd_arg_skip(VdArg *arg)
+VD_API void vd_arena_track_reset_sites(void)
 {
-    arg->argi++;
-    arg->ci = 0;    
+    vd__arena_track_lock();
+    VD_MEMSET(&Vd__Arena_Track_State, 0, sizeof(Vd__Arena_Track_State));
+    vd__arena_track_unlock();
 }
 
-Vdb32 vd_arg_get_name(VdArg *arg, VdStr *name)
+VD_API Vdcstr vd_arena_track_report(VdArena *out, VdArena **arenas, Vdu32 num_arenas, Vdu32 top_n)
 {
-    VD_ARG_CHECK_NEXT(arg);
+    Vdusize cap   = 256 + (Vdusize)(num_arenas + top_n) * 256;
+    Vdcstr result = (Vdcstr)vd_arena_alloc(out, cap);
+    Vdusize len   = 0;
 
-    if (arg->argv[arg->argi][arg->ci] != '-') {
-        return VD_FALSE;
+#define VD__ARENA_TRACK_APPEND(...) do { \
+        int _n_ = snprintf(result + len, cap - len, __VA_ARGS__); \
+        if (_n_ > 0) len += ((Vdusize)_n_ < (cap - len)) ? (Vdusize)_n_ : (cap - len - 1); \
+    } while (0)
+
+    VD__ARENA_TRACK_APPEND("%-24s %12s %12s %12s %6s %10s %14s\n", "arena", "used", "peak", "capacity", "peak%", "allocs", "bytes");
+    for (Vdu32 i = 0; i < num_arenas; ++i) {
+        VdArenaTrackStats stats = vd_arena_track_get_stats(arenas[i]);
+        const char *name = arenas[i]->track_name ? arenas[i]->track_name : "(unnamed)";
+        double pct = stats.capacity ? (100.0 * (double)stats.peak / (double)stats.capacity) : 0.0;
+        VD__ARENA_TRACK_APPEND("%-24s %12zu %12zu %12zu %5.1f%% %10zu %14zu\n",
+            name, stats.used, stats.peak, stats.capacity, pct, stats.num_allocs, stats.num_bytes);
     }
 
-    arg->ci = 1;
+    if (top_n > 0) {
+        VdArenaTrackSite *sites = (VdArenaTrackSite*)vd_arena_alloc(out, sizeof(VdArenaTrackSite) * top_n);
+        Vdu32 num_sites = vd_arena_track_snapshot(sites, top_n);
 
-    VdStr result;
-    result.s = &arg->argv[arg->argi][1];
-    result.len = 0;
+        VD__ARENA_TRACK_APPEND("%-64s %10s %14s\n", "site", "allocs", "bytes");
+        for (Vdu32 i = 0; i < num_sites; ++i) {
+            char location[256];
+            if (sites[i].file) {
+                snprintf(location, sizeof(location), "%s:%u", sites[i].file, sites[i].line);
+            } else {
+                snprintf(location, sizeof(location), "(untracked)");
+            }
 
-    while (arg->argv[arg->argi][arg->ci] != 0) {
-        arg->ci++;
-        result.len++;
-    }
+            VD__ARENA_TRACK_APPEND("%-64s %10llu %14llu\n",
+                location, (unsigned long long)sites[i].num_allocs, (unsigned long long)sites[i].num_bytes);
+        }
 
-    if (result.len == 0) {
-        return VD_FALSE;
+        vd__arena_track_lock();
+        Vdu64 num_dropped = Vd__Arena_Track_State.num_dropped;
+        vd__arena_track_unlock();
+
+        if (num_dropped > 0) {
+            VD__ARENA_TRACK_APPEND("(%llu allocations dropped, raise VD_ARENA_TRACK_MAX_SITES)\n",
+                (unsigned long long)num_dropped);
+        }
     }
 
-    *name = result;
+#undef VD__ARENA_TRACK_APPEND
 
-    return VD_TRUE;
+    result[len] = 0;
+    return result;
 }
+#endif // VD_ARENA_TRACK
 
-Vdb32 vd_arg_get_uint(VdArg *arg, Vdu64 *i) {
-    VD_UNUSED(i);
-    VD_TODO();
+#undef VD__ARENA_TRACK_RECORD
 
-    VD_ARG_CHECK_NEXT(arg);
+/* ----SORT IMPL----------------------------------------------------------------------------------------------------- */
+static VD_INLINE void vd__sort_swap(Vdu8 *a, Vdu8 *b, Vdusize size)
+{
+    if (size == 4) {
+        Vdu32 ta, tb;
+        VD_MEMCPY(&ta, a, 4);
+        VD_MEMCPY(&tb, b, 4);
+        VD_MEMCPY(a, &tb, 4);
+        VD_MEMCPY(b, &ta, 4);
+        return;
+    }
 
-    return VD_FALSE;
+    while (size >= 8) {
+        Vdu64 ta, tb;
+        VD_MEMCPY(&ta, a, 8);
+        VD_MEMCPY(&tb, b, 8);
+        VD_MEMCPY(a, &tb, 8);
+        VD_MEMCPY(b, &ta, 8);
+        a += 8; b += 8; size -= 8;
+    }
+
+    while (size > 0) {
+        Vdu8 t = *a;
+        *a++ = *b;
+        *b++ = t;
+        size--;
+    }
 }
 
-Vdb32 vd_arg_get_str(VdArg *arg, VdStr *str) {
-    VD_ARG_CHECK_NEXT(arg);
+#define VD__SORT_AT(i)        (base + (i) * size)
+#define VD__SORT_LESS(a, b)   (cmp((a), (b), userdata) < 0)
+#define VD__SORT_SWAP(a, b)   vd__sort_swap((a), (b), size)
 
-    VdStr result;
-    result.s = &arg->argv[arg->argi][0];
-    result.len = 0;
+static void vd__sort_insertion(Vdu8 *base, Vdusize count, Vdusize size, VdProcSortCmp *cmp, void *userdata)
+{
+    for (Vdusize i = 1; i < count; ++i) {
+        for (Vdusize j = i; (j > 0) && VD__SORT_LESS(VD__SORT_AT(j), VD__SORT_AT(j - 1)); --j) {
+            VD__SORT_SWAP(VD__SORT_AT(j), VD__SORT_AT(j - 1));
+        }
+    }
+}
 
-    while (arg->argv[arg->argi][arg->ci] != 0) {
-        arg->ci++;
-        result.len++;
+// Gives up once more than 8 elements have been displaced; the partition is then left to the quicksort loop
+static Vdb32 vd__sort_partial_insertion(Vdu8 *base, Vdusize count, Vdusize size, VdProcSortCmp *cmp, void *userdata)
+{
+    Vdusize limit = 0;
+    for (Vdusize i = 1; i < count; ++i) {
+        Vdusize j = i;
+        while ((j > 0) && VD__SORT_LESS(VD__SORT_AT(j), VD__SORT_AT(j - 1))) {
+            VD__SORT_SWAP(VD__SORT_AT(j), VD__SORT_AT(j - 1));
+            j--;
+        }
+
+        limit += i - j;
+        if (limit > 8) return VD_FALSE;
     }
 
-    *str = result;
     return VD_TRUE;
 }
 
-Vdb32 vd_arg_expect_char(VdArg *arg, char c);
+static void vd__sort_sift_down(Vdu8 *base, Vdusize root, Vdusize count, Vdusize size, VdProcSortCmp *cmp, void *userdata)
+{
+    for (;;) {
+        Vdusize child = 2 * root + 1;
+        if (child >= count) break;
 
-#undef VD_ARG_CHECK_NEXT
+        if ((child + 1 < count) && VD__SORT_LESS(VD__SORT_AT(child), VD__SORT_AT(child + 1))) {
+            child++;
+        }
 
-/* ----STRMAP IMPL--------------------------------------------------------------------------------------------------- */
-static Vdb32 vd__strmap_check_key(VdStr check, Vd__StrmapBinPrefix *against) {
-    Vdu32 prefix_len       = sizeof(against->key_prefix);    
-    Vdu32 first_check_len  = prefix_len < (Vdu32)check.len ? prefix_len : (Vdu32)check.len;
-    Vdu32 second_check_len = (Vdu32)check.len - prefix_len;
+        if (!VD__SORT_LESS(VD__SORT_AT(root), VD__SORT_AT(child))) break;
 
-    if (against->key_len != check.len) {
-        return VD_FALSE;
+        VD__SORT_SWAP(VD__SORT_AT(root), VD__SORT_AT(child));
+        root = child;
     }
+}
 
-    if (VD_MEMCMP(against->key_prefix, check.s, first_check_len)) {
-        return VD_FALSE;
+static void vd__sort_heap(Vdu8 *base, Vdusize count, Vdusize size, VdProcSortCmp *cmp, void *userdata)
+{
+    for (Vdusize i = count / 2; i > 0; --i) {
+        vd__sort_sift_down(base, i - 1, count, size, cmp, userdata);
     }
 
-    return check.len < prefix_len
-        ? VD_TRUE
-        : (VD_MEMCMP(against->key_rest, check.s + prefix_len, second_check_len) == 0);
+    for (Vdusize end = count - 1; end > 0; --end) {
+        VD__SORT_SWAP(VD__SORT_AT(0), VD__SORT_AT(end));
+        vd__sort_sift_down(base, 0, end, size, cmp, userdata);
+    }
 }
 
-static void vd__strmap_emplace_key(void *map, Vd__StrmapBinPrefix *dst, char *src_key_prefix, char *src_key_rest, Vdu32 src_key_len)
+static void vd__sort_sort3(Vdu8 *a, Vdu8 *b, Vdu8 *c, Vdusize size, VdProcSortCmp *cmp, void *userdata)
 {
-    Vdu32 prefix_len     = sizeof(dst->key_prefix);
-    Vdu32 first_copy_len = src_key_len > prefix_len ? prefix_len : src_key_len;
+    if (VD__SORT_LESS(b, a)) VD__SORT_SWAP(a, b);
+    if (VD__SORT_LESS(c, b)) VD__SORT_SWAP(b, c);
+    if (VD__SORT_LESS(b, a)) VD__SORT_SWAP(a, b);
+}
 
-    VD_MEMCPY(dst->key_prefix, src_key_prefix, first_copy_len);
+// Pivot is at base[0]. Elements equal to the pivot go to the right. Returns the final pivot index.
+static Vdusize vd__sort_partition_right(Vdu8 *base, Vdusize count, Vdusize size, VdProcSortCmp *cmp, void *userdata,
+                                        Vdb32 *already_partitioned)
+{
+    Vdu8 *pivot = VD__SORT_AT(0);
+    Vdusize first = 0;
+    Vdusize last  = count;
 
-    Vdu32 new_len = src_key_len;
+    while (VD__SORT_LESS(VD__SORT_AT(++first), pivot));
 
-    if (src_key_len > prefix_len) {
-        src_key_len -= prefix_len;
+    if (first == 1) {
+        while ((first < last) && !VD__SORT_LESS(VD__SORT_AT(--last), pivot));
+    } else {
+        while (!VD__SORT_LESS(VD__SORT_AT(--last), pivot));
+    }
 
-        // If the source key's length after the prefix doesn't fit in the array allocated for key_rest
-        // Or if the key_rest_cap is zero because no key_rest has been allocated, then resize it
-        if (src_key_len > dst->key_rest_cap) {
+    *already_partitioned = first >= last;
 
-            // Allocate an arena big enough so that statistically, we won't have to ever care about
-            // this again
-            dst->key_rest = (char*)vd_arena_alloc(VD_STRMAP_ARENAP(map), src_key_len * 2);
-            dst->key_rest_cap = src_key_len * 2;
-        }
-
-        // Copy the rest of the key
-        VD_MEMCPY(dst->key_rest, src_key_rest, src_key_len);
+    while (first < last) {
+        VD__SORT_SWAP(VD__SORT_AT(first), VD__SORT_AT(last));
+        while (VD__SORT_LESS(VD__SORT_AT(++first), pivot));
+        while (!VD__SORT_LESS(VD__SORT_AT(--last), pivot));
     }
 
-    dst->key_len = new_len;
+    Vdusize pivot_pos = first - 1;
+    VD__SORT_SWAP(VD__SORT_AT(0), VD__SORT_AT(pivot_pos));
+    return pivot_pos;
 }
 
-static void vd__strmap_copy_key(void *map, VdStr key, Vd__StrmapBinPrefix *bin)
+// Pivot is at base[0]. Elements equal to the pivot go to the left. Used when the pivot equals the element before the
+// range, which means every element equal to it is already in place.
+static Vdusize vd__sort_partition_left(Vdu8 *base, Vdusize count, Vdusize size, VdProcSortCmp *cmp, void *userdata)
 {
-    char *key_prefix_part = key.s;
-    char *key_rest_part = key.len > sizeof(bin->key_prefix) ? key.s + sizeof(bin->key_prefix) : 0;
-    vd__strmap_emplace_key(map, bin, key_prefix_part, key_rest_part, (Vdu32)key.len);
+    Vdu8 *pivot = VD__SORT_AT(0);
+    Vdusize first = 0;
+    Vdusize last  = count;
+
+    while (VD__SORT_LESS(pivot, VD__SORT_AT(--last)));
+
+    if (last + 1 == count) {
+        while ((first < last) && !VD__SORT_LESS(pivot, VD__SORT_AT(++first)));
+    } else {
+        while (!VD__SORT_LESS(pivot, VD__SORT_AT(++first)));
+    }
+
+    while (first < last) {
+        VD__SORT_SWAP(VD__SORT_AT(first), VD__SORT_AT(last));
+        while (VD__SORT_LESS(pivot, VD__SORT_AT(--last)));
+        while (!VD__SORT_LESS(pivot, VD__SORT_AT(++first)));
+    }
+
+    VD__SORT_SWAP(VD__SORT_AT(0), VD__SORT_AT(last));
+    return last;
 }
 
-void* vd__strmap_init(VdArena *arena, Vdu32 tsize, Vdu32 cap, VdStrmapInitOptions *options)
+static void vd__sort_pdq(Vdu8 *base, Vdusize count, Vdusize size, VdProcSortCmp *cmp, void *userdata,
+                         int bad_allowed, Vdb32 leftmost)
 {
-    Vd__StrmapHeader *map;
-    const Vdu32 bin_size = sizeof(Vd__StrmapBinPrefix) + tsize;
-
-    map = (Vd__StrmapHeader*)vd_arena_alloc(arena, sizeof(Vd__StrmapHeader) + bin_size * cap);
+    for (;;) {
+        if (count < 24) {
+            vd__sort_insertion(base, count, size, cmp, userdata);
+            return;
+        }
 
-    Vd__StrmapBinPrefix *bins = (Vd__StrmapBinPrefix*)(((Vdu8ptr)map) + sizeof(Vd__StrmapHeader));
+        // Choose a pivot (ninther for large ranges) and move it to base[0]
+        Vdusize half = count / 2;
+        if (count > 128) {
+            vd__sort_sort3(VD__SORT_AT(0),        VD__SORT_AT(half),     VD__SORT_AT(count - 1), size, cmp, userdata);
+            vd__sort_sort3(VD__SORT_AT(1),        VD__SORT_AT(half - 1), VD__SORT_AT(count - 2), size, cmp, userdata);
+            vd__sort_sort3(VD__SORT_AT(2),        VD__SORT_AT(half + 1), VD__SORT_AT(count - 3), size, cmp, userdata);
+            vd__sort_sort3(VD__SORT_AT(half - 1), VD__SORT_AT(half),     VD__SORT_AT(half + 1),  size, cmp, userdata);
+            VD__SORT_SWAP(VD__SORT_AT(0), VD__SORT_AT(half));
+        } else {
+            vd__sort_sort3(VD__SORT_AT(half), VD__SORT_AT(0), VD__SORT_AT(count - 1), size, cmp, userdata);
+        }
 
-    float address_scale = 0.863f;
-    if (options != 0) address_scale = options->address_scale;
+        if (!leftmost && !VD__SORT_LESS(base - size, VD__SORT_AT(0))) {
+            Vdusize pivot_pos = vd__sort_partition_left(base, count, size, cmp, userdata);
+            base  += (pivot_pos + 1) * size;
+            count -= pivot_pos + 1;
+            continue;
+        }
 
-    map->cap_total    = cap;
-    map->cap          = (Vdu32) (((Vdf32)cap) * address_scale);
-    map->taken        = 0;
-    map->tsize        = tsize;
-    map->arena        = arena;
+        Vdb32 already_partitioned;
+        Vdusize pivot_pos = vd__sort_partition_right(base, count, size, cmp, userdata, &already_partitioned);
+        Vdusize l_size    = pivot_pos;
+        Vdusize r_size    = count - (pivot_pos + 1);
+        Vdu8   *r_base    = VD__SORT_AT(pivot_pos + 1);
+
+        if ((l_size < count / 8) || (r_size < count / 8)) {
+            // Bad partition: after log2(n) of them, fall back to heapsort to guarantee O(n log n)
+            if (--bad_allowed == 0) {
+                vd__sort_heap(base, count, size, cmp, userdata);
+                return;
+            }
 
-    if ((options != 0) && (options->average_key_len > sizeof(((Vd__StrmapBinPrefix*)0)->key_prefix))) {
-        for (Vdu32 i = 0; i < map->cap_total; ++i) {
-            bins[i].key_rest = (char*)vd_arena_alloc(arena, options->average_key_len);
-            VD_ASSERT(bins[i].key_rest);
+            // Break up patterns that might be causing the bad partitions
+            if (l_size >= 24) {
+                VD__SORT_SWAP(VD__SORT_AT(0),             VD__SORT_AT(l_size / 4));
+                VD__SORT_SWAP(VD__SORT_AT(pivot_pos - 1), VD__SORT_AT(pivot_pos - l_size / 4));
+            }
 
-            bins[i].key_rest_cap = options->average_key_len;
+            if (r_size >= 24) {
+                VD__SORT_SWAP(r_base,                            r_base + (r_size / 4) * size);
+                VD__SORT_SWAP(r_base + (r_size - 1) * size,      r_base + (r_size - r_size / 4) * size);
+            }
+        } else if (already_partitioned) {
+            // Likely (nearly) sorted input: try to finish both sides cheaply
+            if (vd__sort_partial_insertion(base, l_size, size, cmp, userdata) &&
+                vd__sort_partial_insertion(r_base, r_size, size, cmp, userdata))
+            {
+                return;
+            }
         }
+
+        // Recurse into the left side, loop on the right
+        vd__sort_pdq(base, l_size, size, cmp, userdata, bad_allowed, leftmost);
+        base     = r_base;
+        count    = r_size;
+        leftmost = VD_FALSE;
     }
+}
 
-    return (void*)((Vdu8*)map + sizeof(Vd__StrmapHeader));
+#undef VD__SORT_AT
+#undef VD__SORT_LESS
+#undef VD__SORT_SWAP
+
+VD_API void vd_sort(void *base, Vdusize count, Vdusize size, VdProcSortCmp *cmp, void *userdata)
+{
+    if (count < 2) return;
+
+    int log2 = 0;
+    for (Vdusize n = count; n > 1; n >>= 1) log2++;
+
+    vd__sort_pdq((Vdu8*)base, count, size, cmp, userdata, log2, VD_TRUE);
 }
 
-// @todo(mdodis): Speed this up if VD_ENABLE_SCRATCH_USE_IN_LIBRARY is enabled
-//                by using a simple queue to store re-inserted bins
-static void vd__strmap_reinsert_chain(void *map, Vd__StrmapBinPrefix *start)
+typedef struct {
+    void    *src_k;
+    void    *dst_k;
+    void    *src_v;
+    void    *dst_v;
+    Vdusize begin;
+    Vdusize end;
+    Vdu32   shift;
+    Vdu32   key_size;
+    Vdusize counts[256];
+} Vd__RadixJob;
+
+static void vd__radix_count(Vd__RadixJob *job)
 {
-    // Build the insertion queue
-    Vd__StrmapBinPrefix *bin = start;
-    Vd__StrmapBinPrefix *bin_next = start->next;
-    while (bin_next != 0) {
-        bin->insq = bin_next;
+    VD_MEMSET(job->counts, 0, sizeof(job->counts));
 
-        bin       = bin_next;
-        bin_next  = bin->next;
+    if (job->key_size == 4) {
+        Vdu32 *k = (Vdu32*)job->src_k;
+        for (Vdusize i = job->begin; i < job->end; ++i) job->counts[(k[i] >> job->shift) & 0xFF]++;
+    } else {
+        Vdu64 *k = (Vdu64*)job->src_k;
+        for (Vdusize i = job->begin; i < job->end; ++i) job->counts[(k[i] >> job->shift) & 0xFF]++;
     }
+}
 
-    // Traverse the queue and for each item, set its bin to be unused, then re-add it
-    Vd__StrmapBinPrefix *q = start->insq;
-    bin = start;
+// Expects job->counts to hold the output offset of each digit for this job's range
+static void vd__radix_scatter(Vd__RadixJob *job)
+{
+    Vdusize *offsets = job->counts;
+    Vdu32    shift   = job->shift;
+
+    if (job->key_size == 4) {
+        Vdu32 *sk = (Vdu32*)job->src_k, *dk = (Vdu32*)job->dst_k;
+        if (job->src_v) {
+            Vdu32 *sv = (Vdu32*)job->src_v, *dv = (Vdu32*)job->dst_v;
+            for (Vdusize i = job->begin; i < job->end; ++i) {
+                Vdu32 k = sk[i];
+                Vdusize o = offsets[(k >> shift) & 0xFF]++;
+                dk[o] = k;
+                dv[o] = sv[i];
+            }
+        } else {
+            for (Vdusize i = job->begin; i < job->end; ++i) {
+                Vdu32 k = sk[i];
+                dk[offsets[(k >> shift) & 0xFF]++] = k;
+            }
+        }
+    } else {
+        Vdu64 *sk = (Vdu64*)job->src_k, *dk = (Vdu64*)job->dst_k;
+        if (job->src_v) {
+            Vdu64 *sv = (Vdu64*)job->src_v, *dv = (Vdu64*)job->dst_v;
+            for (Vdusize i = job->begin; i < job->end; ++i) {
+                Vdu64 k = sk[i];
+                Vdusize o = offsets[(k >> shift) & 0xFF]++;
+                dk[o] = k;
+                dv[o] = sv[i];
+            }
+        } else {
+            for (Vdusize i = job->begin; i < job->end; ++i) {
+                Vdu64 k = sk[i];
+                dk[offsets[(k >> shift) & 0xFF]++] = k;
+            }
+        }
+    }
+}
 
-    start->insq = 0;
+static void vd__radix_swap_buffers(Vd__RadixJob *job)
+{
+    void *t;
+    t = job->src_k; job->src_k = job->dst_k; job->dst_k = t;
+    t = job->src_v; job->src_v = job->dst_v; job->dst_v = t;
+}
 
-    while (q != 0) {
-        q->used = VD_FALSE;
-        Vd__StrmapBinPrefix *nextq = q->insq;
-        q->insq = 0;
+static void vd__radix_sort(void *keys, void *values, Vdusize count, Vdu32 key_size, VdArena *scratch)
+{
+    if (count < 2) return;
+
+    VdArenaSave save = vd_arena_save(scratch);
+    Vdu32 num_digits = key_size;
+
+    Vdusize (*hist)[256] = (Vdusize(*)[256])vd_arena_alloc(scratch, sizeof(Vdusize) * 256 * num_digits);
+
+    // One read pass builds the histograms of every digit
+    if (key_size == 4) {
+        Vdu32 *k = (Vdu32*)keys;
+        for (Vdusize i = 0; i < count; ++i) {
+            Vdu32 v = k[i];
+            hist[0][v & 0xFF]++;
+            hist[1][(v >> 8) & 0xFF]++;
+            hist[2][(v >> 16) & 0xFF]++;
+            hist[3][v >> 24]++;
+        }
+    } else {
+        Vdu64 *k = (Vdu64*)keys;
+        for (Vdusize i = 0; i < count; ++i) {
+            Vdu64 v = k[i];
+            for (Vdu32 d = 0; d < 8; ++d) {
+                hist[d][(v >> (d * 8)) & 0xFF]++;
+            }
+        }
+    }
 
-        // Compose the key for q into a VdStr
-        Vdu64 key_hash;
-        {
-            Vdusize key_len = q->key_len;
-            VdArenaSave save = vd_arena_save(VD_STRMAP_ARENAP(map));
+    Vd__RadixJob job;
+    job.src_k    = keys;
+    job.src_v    = values;
+    job.dst_k    = vd_arena_alloc(scratch, count * key_size);
+    job.dst_v    = values ? vd_arena_alloc(scratch, count * key_size) : 0;
+    job.begin    = 0;
+    job.end      = count;
+    job.key_size = key_size;
+
+    for (Vdu32 d = 0; d < num_digits; ++d) {
+        Vdusize running = 0;
+        Vdb32   trivial = VD_FALSE;
+        for (Vdu32 b = 0; b < 256; ++b) {
+            if (hist[d][b] == count) {
+                trivial = VD_TRUE;
+                break;
+            }
 
-            char *key = (char*)vd_arena_alloc(VD_STRMAP_ARENAP(map), key_len);
+            job.counts[b] = running;
+            running += hist[d][b];
+        }
 
-            Vdusize first_copy_size  = key_len <= sizeof(q->key_prefix) ? key_len : sizeof(q->key_prefix);
-            Vdusize second_copy_size = key_len <= sizeof(q->key_prefix) ? 0 : key_len - sizeof(q->key_prefix);
+        if (trivial) continue;
 
-            VD_MEMCPY(key + 0, q->key_prefix, first_copy_size);
+        job.shift = d * 8;
+        vd__radix_scatter(&job);
+        vd__radix_swap_buffers(&job);
+    }
 
-            if (second_copy_size > 0) {
-                VD_MEMCPY(key + first_copy_size, q->key_rest, second_copy_size);
-            }
+    if (job.src_k != keys) {
+        VD_MEMCPY(keys, job.src_k, count * key_size);
+        if (values) VD_MEMCPY(values, job.src_v, count * key_size);
+    }
 
-            key_hash = vd_dhash64(key, key_len);
+    vd_arena_restore(save);
+}
 
-            vd_arena_restore(save);
-        }
+static VD_INLINE Vdu32 vd__radix_f32_to_key(Vdu32 bits) { return bits ^ ((Vdu32)(-(Vdi32)(bits >> 31)) | 0x80000000u); }
+static VD_INLINE Vdu32 vd__radix_key_to_f32(Vdu32 key)  { return key ^ (((key >> 31) - 1) | 0x80000000u); }
+static VD_INLINE Vdu64 vd__radix_f64_to_key(Vdu64 bits) { return bits ^ ((Vdu64)(-(Vdi64)(bits >> 63)) | 0x8000000000000000ull); }
+static VD_INLINE Vdu64 vd__radix_key_to_f64(Vdu64 key)  { return key ^ (((key >> 63) - 1) | 0x8000000000000000ull); }
 
-        Vdusize bin_index = key_hash % VD_STRMAP_HEADER(map)->cap;
+VD_API void vd_sort_radix_u32(Vdu32 *keys, Vdu32 *values, Vdusize count, VdArena *scratch)
+{
+    vd__radix_sort(keys, values, count, 4, scratch);
+}
 
-        Vd__StrmapBinPrefix *existing_bin = VD_STRMAP_GET_BIN(map, bin_index);
+VD_API void vd_sort_radix_i32(Vdi32 *keys, Vdu32 *values, Vdusize count, VdArena *scratch)
+{
+    Vdu32 *k = (Vdu32*)keys;
+    for (Vdusize i = 0; i < count; ++i) k[i] ^= 0x80000000u;
+    vd__radix_sort(keys, values, count, 4, scratch);
+    for (Vdusize i = 0; i < count; ++i) k[i] ^= 0x80000000u;
+}
 
-        // if the key for some reason hashes to the same place, then ignore it
-        if (existing_bin != q) {
+VD_API void vd_sort_radix_f32(Vdf32 *keys, Vdu32 *values, Vdusize count, VdArena *scratch)
+{
+    Vdu32 *k = (Vdu32*)keys;
+    for (Vdusize i = 0; i < count; ++i) k[i] = vd__radix_f32_to_key(k[i]);
+    vd__radix_sort(keys, values, count, 4, scratch);
+    for (Vdusize i = 0; i < count; ++i) k[i] = vd__radix_key_to_f32(k[i]);
+}
 
-            if (!existing_bin->used) {
-                Vd__StrmapBinPrefix *new_bin = existing_bin;
-                void *sptr = VD_STRMAP_BIN_MOVE_TO_VPTR(q);
-                void *dptr = VD_STRMAP_BIN_MOVE_TO_VPTR(new_bin);
+VD_API void vd_sort_radix_u64(Vdu64 *keys, Vdu64 *values, Vdusize count, VdArena *scratch)
+{
+    vd__radix_sort(keys, values, count, 8, scratch);
+}
 
-                new_bin->used = VD_TRUE;
-                new_bin->next = 0;
-                // Copy key
-                vd__strmap_emplace_key(map, new_bin, q->key_prefix, q->key_rest, q->key_len);
+VD_API void vd_sort_radix_i64(Vdi64 *keys, Vdu64 *values, Vdusize count, VdArena *scratch)
+{
+    Vdu64 *k = (Vdu64*)keys;
+    for (Vdusize i = 0; i < count; ++i) k[i] ^= 0x8000000000000000ull;
+    vd__radix_sort(keys, values, count, 8, scratch);
+    for (Vdusize i = 0; i < count; ++i) k[i] ^= 0x8000000000000000ull;
+}
 
-                // Copy over value
-                VD_MEMCPY(dptr, sptr, VD_STRMAP_TSIZE(map));
-            } else {
-                // Attempt to traverse the chain, if any
-                Vd__StrmapBinPrefix *chain_head = existing_bin;
-                while (chain_head->next == 0) {
-                    chain_head = chain_head->next;
-                }
+VD_API void vd_sort_radix_f64(Vdf64 *keys, Vdu64 *values, Vdusize count, VdArena *scratch)
+{
+    Vdu64 *k = (Vdu64*)keys;
+    for (Vdusize i = 0; i < count; ++i) k[i] = vd__radix_f64_to_key(k[i]);
+    vd__radix_sort(keys, values, count, 8, scratch);
+    for (Vdusize i = 0; i < count; ++i) k[i] = vd__radix_key_to_f64(k[i]);
+}
 
-                Vdu32 cursor = VD_STRMAP_HEADER(map)->cap_total;
-                while ((cursor > 0) && (VD_STRMAP_GET_BIN(map, cursor - 1)->used)) {
-                    cursor--;
-                }
+#if VD_INCLUDE_PLATFORM_SPECIFIC_FUNCTIONALITY
+static Vdu32 vd__sort_resolve_num_threads(Vdu32 num_threads, Vdusize count)
+{
+    if (num_threads == 0) num_threads = vd_get_num_cpus();
+    if (num_threads > VD_SORT_MAX_THREADS) num_threads = VD_SORT_MAX_THREADS;
+    if (count < VD_SORT_PARALLEL_MIN_COUNT) num_threads = 1;
+    return num_threads;
+}
 
-                // After n iterations, if no bin was found we should be at a bin that's still used
-                // (i.e bin 0). In this case, return null.
-                if (cursor == 0) {
-                    VD_IMPOSSIBLE();
-                }
+// Runs proc on jobs[1..n) in new threads and jobs[0] on the calling thread, along with any job whose thread failed to
+// start
+static void vd__sort_run_jobs(VdProcThread *proc, void *jobs, Vdusize job_size, Vdu32 num_jobs)
+{
+    VdThread threads[VD_SORT_MAX_THREADS];
+    Vdb32    started[VD_SORT_MAX_THREADS];
+    for (Vdu32 t = 1; t < num_jobs; ++t) {
+        started[t] = vd_thread_create(&threads[t], proc, (Vdu8*)jobs + t * job_size);
+    }
 
-                cursor--;
-                Vd__StrmapBinPrefix *new_bin = VD_STRMAP_GET_BIN(map, cursor);
+    proc(jobs);
 
-                // Allocate the bin
-                new_bin->used = VD_TRUE;
-                new_bin->next = 0;
-                chain_head->next = new_bin;
+    for (Vdu32 t = 1; t < num_jobs; ++t) {
+        if (!started[t]) proc((Vdu8*)jobs + t * job_size);
+    }
 
-                void *sptr = VD_STRMAP_BIN_MOVE_TO_VPTR(q);
-                void *dptr = VD_STRMAP_BIN_MOVE_TO_VPTR(new_bin);
+    for (Vdu32 t = 1; t < num_jobs; ++t) {
+        if (started[t]) vd_thread_join(&threads[t]);
+    }
+}
 
-                // Copy key
-                vd__strmap_emplace_key(map, new_bin, q->key_prefix, q->key_rest, q->key_len);
+typedef struct {
+    Vd__RadixJob   *jobs;
+    Vdu32          num_threads;
+    Vdu32          key_size;
+    Vdusize        count;
+    volatile Vdu32 go;
+    volatile Vdu32 trivial;
+    volatile Vdu32 barrier_count;
+    volatile Vdu32 barrier_generation;
+} Vd__RadixShared;
 
-                // Copy over value
-                VD_MEMCPY(dptr, sptr, VD_STRMAP_TSIZE(map));
+typedef struct {
+    Vd__RadixShared *shared;
+    Vdu32           index;
+} Vd__RadixWorker;
+
+static void vd__radix_barrier(Vd__RadixShared *shared)
+{
+    Vdu32 generation = vd_atomic_load_u32(&shared->barrier_generation);
+    if (vd_atomic_fetch_add_u32(&shared->barrier_count, 1) + 1 == shared->num_threads) {
+        vd_atomic_store_u32(&shared->barrier_count, 0);
+        vd_atomic_store_u32(&shared->barrier_generation, generation + 1);
+        return;
+    }
+
+    Vdu32 spins = 0;
+    while (vd_atomic_load_u32(&shared->barrier_generation) == generation) {
+        if (spins++ < 1024) vd_cpu_relax();
+        else                vd_thread_yield();
+    }
+}
+
+// Every pass of the sort on one worker; the workers meet at a barrier between the count and scatter phases instead of
+// being started and joined for each phase
+static void vd__radix_parallel_passes(Vd__RadixShared *shared, Vdu32 index)
+{
+    Vd__RadixJob *job = &shared->jobs[index];
+
+    for (Vdu32 d = 0; d < shared->key_size; ++d) {
+        job->shift = d * 8;
+        vd__radix_count(job);
+        vd__radix_barrier(shared);
+
+        if (index == 0) {
+            // Turn the per-thread counts into per-thread output offsets: digit-major, thread-minor keeps the sort
+            // stable
+            Vdusize running = 0;
+            Vdu32   trivial = VD_FALSE;
+            for (Vdu32 b = 0; b < 256; ++b) {
+                Vdusize digit_total = 0;
+                for (Vdu32 t = 0; t < shared->num_threads; ++t) {
+                    Vdusize c = shared->jobs[t].counts[b];
+                    shared->jobs[t].counts[b] = running;
+                    running += c;
+                    digit_total += c;
+                }
+
+                if (digit_total == shared->count) {
+                    trivial = VD_TRUE;
+                    break;
+                }
             }
-        } else {
-            q->used = VD_TRUE;
+
+            vd_atomic_store_u32(&shared->trivial, trivial);
         }
 
-        q = nextq;
+        vd__radix_barrier(shared);
+        if (vd_atomic_load_u32(&shared->trivial)) continue;
+
+        vd__radix_scatter(job);
+        vd__radix_swap_buffers(job);
+
+        // The next pass counts what every worker just scattered
+        vd__radix_barrier(shared);
     }
 }
 
-Vd__StrmapBinPrefix* vd__strmap_get_bin(void *map, VdStr key, Vd__StrmapGetBinFlags op)
+static VD_PROC_THREAD(vd__radix_worker_thread)
 {
-    // Get hash
-    Vdu64 hash = vd_dhash64_str(key);
-    Vdu64 bin_index = hash % VD_STRMAP_HEADER(map)->cap;
+    Vd__RadixWorker *worker = (Vd__RadixWorker*)userdata;
+    while (!vd_atomic_load_u32(&worker->shared->go)) {
+        vd_thread_yield();
+    }
 
-    // Find existing bin if any
-    Vd__StrmapBinPrefix *existing_bin = VD_STRMAP_GET_BIN(map, bin_index);
+    vd__radix_parallel_passes(worker->shared, worker->index);
+}
 
-    // If:
-    // (existing_bin->used == 0) AND
-    //      - We don't need to create a new bin then we want to search anyway since we'll do an early
-    //        return after this if statement
-    //      - We do need to create a new bin then we stop here, because we found it
-    //
-    // (existing_bin->used == 1) AND
-    //      - We don't need to create a new bin, then go inside this statement to see if we can find
-    //        the bin matching the query
-    //      - We do need to create a new bin, then go inside anyway because at the end (meaning if
-    //        we actually find a place to allocate the bin), we'll want to link the collided bin chain
-    //        to the newly allocated bin
-    if (existing_bin->used || !(op & VD__STRMAP_GET_BIN_FLAGS_CREATE)) {
-        Vdb32 found = VD_FALSE;
+static void vd__radix_sort_parallel(void *keys, void *values, Vdusize count, Vdu32 key_size, VdArena *scratch,
+                                    Vdu32 num_threads)
+{
+    num_threads = vd__sort_resolve_num_threads(num_threads, count);
+    if (num_threads <= 1) {
+        vd__radix_sort(keys, values, count, key_size, scratch);
+        return;
+    }
 
-        // Make sure that the hash didn't put us in a bin where the key is equal to the query key
-        if (vd__strmap_check_key(key, existing_bin)) {
-            found = VD_TRUE;
+    VdArenaSave save = vd_arena_save(scratch);
+
+    Vd__RadixShared shared;
+    VD_MEMSET(&shared, 0, sizeof(shared));
+    shared.jobs     = (Vd__RadixJob*)vd_arena_alloc(scratch, sizeof(Vd__RadixJob) * num_threads);
+    shared.key_size = key_size;
+    shared.count    = count;
+
+    // Spawn the workers once for the whole sort. They wait for the go flag, so if some fail to start the ranges can
+    // still be split between the ones that did.
+    VdThread        threads[VD_SORT_MAX_THREADS];
+    Vd__RadixWorker workers[VD_SORT_MAX_THREADS];
+    Vdu32           num_started = 1;
+    for (; num_started < num_threads; ++num_started) {
+        workers[num_started].shared = &shared;
+        workers[num_started].index  = num_started;
+        if (!vd_thread_create(&threads[num_started], vd__radix_worker_thread, &workers[num_started])) {
+            break;
         }
+    }
 
-        // If the bin isn't what we searched for, traverse the chain until the end to find it.
-        while (!found && (existing_bin->next != 0)) {
-            existing_bin = existing_bin->next;
+    Vd__RadixJob *jobs = shared.jobs;
+    void *tmp_k = vd_arena_alloc(scratch, count * key_size);
+    void *tmp_v = values ? vd_arena_alloc(scratch, count * key_size) : 0;
+
+    Vdusize chunk = (count + num_started - 1) / num_started;
+    for (Vdu32 t = 0; t < num_started; ++t) {
+        jobs[t].src_k    = keys;
+        jobs[t].src_v    = values;
+        jobs[t].dst_k    = tmp_k;
+        jobs[t].dst_v    = tmp_v;
+        jobs[t].begin    = t * chunk < count ? t * chunk : count;
+        jobs[t].end      = (t + 1) * chunk < count ? (t + 1) * chunk : count;
+        jobs[t].key_size = key_size;
+    }
 
-            if (vd__strmap_check_key(key, existing_bin)) {
-                found = VD_TRUE;
-                break;
-            }
-        }
+    shared.num_threads = num_started;
+    vd_atomic_store_u32(&shared.go, 1);
 
-        if (found) {
-            if (op & VD__STRMAP_GET_BIN_FLAGS_SET_UNUSED) {
-                // if found is true the bin must be unused, set its flag and return
-                existing_bin->used = VD_FALSE;
-                VD_STRMAP_HEADER(map)->taken--;
-                vd__strmap_reinsert_chain(map, existing_bin);
-                return existing_bin;
+    vd__radix_parallel_passes(&shared, 0);
 
-            } else if (op & VD__STRMAP_GET_BIN_FLAGS_GET_EXISTING) {
-                // If the user wants to create a new bin, overwrite existing one, or just get it, and found is true, 
-                // this means that the user queried with an existing key. Return the existing bin in thie case.
-                return existing_bin;
-            } else if (op & VD__STRMAP_GET_BIN_FLAGS_CREATE) {
-                // If the user wants to create a new bin, and found is true, this means that the user
-                // queried with the same key. Return null in this case.
-                return 0;
-            }
-        }
+    for (Vdu32 t = 1; t < num_started; ++t) {
+        vd_thread_join(&threads[t]);
     }
 
-    // At this point, no bin that matched our key was found so if the user doesn't want a new bin, then
-    // fail
-    if (!(op & VD__STRMAP_GET_BIN_FLAGS_CREATE)) {
-        return 0;
+    if (jobs[0].src_k != keys) {
+        VD_MEMCPY(keys, jobs[0].src_k, count * key_size);
+        if (values) VD_MEMCPY(values, jobs[0].src_v, count * key_size);
     }
 
-    // If this bin is not used then allocate it
-    if (!existing_bin->used) {
-        vd__strmap_copy_key(map, key, existing_bin);
-        existing_bin->used = VD_TRUE;
-        existing_bin->next = 0;
-        VD_STRMAP_HEADER(map)->taken++;
-        return existing_bin;
+    vd_arena_restore(save);
+}
+
+VD_API void vd_sort_radix_u32_parallel(Vdu32 *keys, Vdu32 *values, Vdusize count, VdArena *scratch, Vdu32 num_threads)
+{
+    vd__radix_sort_parallel(keys, values, count, 4, scratch, num_threads);
+}
+
+VD_API void vd_sort_radix_u64_parallel(Vdu64 *keys, Vdu64 *values, Vdusize count, VdArena *scratch, Vdu32 num_threads)
+{
+    vd__radix_sort_parallel(keys, values, count, 8, scratch, num_threads);
+}
+
+typedef struct {
+    Vdu8          *src;
+    Vdu8          *dst;
+    Vdusize       begin;
+    Vdusize       mid;
+    Vdusize       end;
+    Vdusize       size;
+    VdProcSortCmp *cmp;
+    void          *userdata;
+} Vd__SortMergeJob;
+
+static VD_PROC_THREAD(vd__sort_slice_thread)
+{
+    Vd__SortMergeJob *job = (Vd__SortMergeJob*)userdata;
+    vd_sort(job->src + job->begin * job->size, job->end - job->begin, job->size, job->cmp, job->userdata);
+}
+
+static VD_PROC_THREAD(vd__sort_merge_thread)
+{
+    Vd__SortMergeJob *job = (Vd__SortMergeJob*)userdata;
+    Vdusize size = job->size;
+    Vdusize i = job->begin, j = job->mid, o = job->begin;
+
+    while ((i < job->mid) && (j < job->end)) {
+        if (job->cmp(job->src + j * size, job->src + i * size, job->userdata) < 0) {
+            VD_MEMCPY(job->dst + (o++) * size, job->src + (j++) * size, size);
+        } else {
+            VD_MEMCPY(job->dst + (o++) * size, job->src + (i++) * size, size);
+        }
     }
 
-    // At this point, we handle a hash collision either for allocating a bin, or traversing the chain
-    // due to a previous collision
+    VD_MEMCPY(job->dst + o * size, job->src + i * size, (job->mid - i) * size);
+    o += job->mid - i;
+    VD_MEMCPY(job->dst + o * size, job->src + j * size, (job->end - j) * size);
+}
 
-    // Otherwise search starting from the cellar for an unused bin
-    Vdu32 cursor = VD_STRMAP_HEADER(map)->cap_total;
-    while ((cursor > 0) && (VD_STRMAP_GET_BIN(map, cursor - 1)->used)) {
-        cursor--;
+VD_API void vd_sort_parallel(void *base, Vdusize count, Vdusize size, VdProcSortCmp *cmp, void *userdata,
+                             VdArena *scratch, Vdu32 num_threads)
+{
+    num_threads = vd__sort_resolve_num_threads(num_threads, count);
+    if (num_threads <= 1) {
+        vd_sort(base, count, size, cmp, userdata);
+        return;
     }
 
-    // After n iterations, if no bin was found we should be at a bin that's still used
-    // (i.e bin 0). In this case, return null.
-    if (cursor == 0) {
-        return 0;
+    VdArenaSave save = vd_arena_save(scratch);
+    Vdusize *bounds     = (Vdusize*)vd_arena_alloc(scratch, sizeof(Vdusize) * (num_threads + 1));
+    Vd__SortMergeJob *jobs = (Vd__SortMergeJob*)vd_arena_alloc(scratch, sizeof(Vd__SortMergeJob) * num_threads);
+    Vdu8 *src = (Vdu8*)base;
+    Vdu8 *dst = (Vdu8*)vd_arena_alloc(scratch, count * size);
+
+    Vdu32 num_runs = num_threads;
+    for (Vdu32 t = 0; t <= num_runs; ++t) {
+        bounds[t] = (count * t) / num_runs;
     }
 
-    cursor--;
-    Vd__StrmapBinPrefix *new_bin = VD_STRMAP_GET_BIN(map, cursor);
+    for (Vdu32 t = 0; t < num_runs; ++t) {
+        jobs[t].src      = src;
+        jobs[t].begin    = bounds[t];
+        jobs[t].end      = bounds[t + 1];
+        jobs[t].size     = size;
+        jobs[t].cmp      = cmp;
+        jobs[t].userdata = userdata;
+    }
 
-    // Allocate the bin
-    new_bin->used = VD_TRUE;
-    new_bin->next = 0;
+    vd__sort_run_jobs(vd__sort_slice_thread, jobs, sizeof(Vd__SortMergeJob), num_runs);
+
+    // Merge neighbouring runs until one is left, ping-ponging between base and the scratch buffer
+    while (num_runs > 1) {
+        Vdu32 num_jobs = 0;
+        for (Vdu32 r = 0; r < num_runs; r += 2) {
+            Vd__SortMergeJob *job = &jobs[num_jobs++];
+            job->src      = src;
+            job->dst      = dst;
+            job->begin    = bounds[r];
+            job->mid      = bounds[r + 1];
+            job->end      = (r + 1 < num_runs) ? bounds[r + 2] : bounds[r + 1];
+            job->size     = size;
+            job->cmp      = cmp;
+            job->userdata = userdata;
+        }
 
-    VD_STRMAP_HEADER(map)->taken++;
+        vd__sort_run_jobs(vd__sort_merge_thread, jobs, sizeof(Vd__SortMergeJob), num_jobs);
 
-    // Mark bin as next. At this point, the previous search through the chain means that existing_bin
-    // is now at the end of the chain 
-    existing_bin->next = new_bin;
+        for (Vdu32 r = 0; r < num_jobs; ++r) {
+            bounds[r] = jobs[r].begin;
+        }
+        bounds[num_jobs] = count;
+        num_runs = num_jobs;
 
-    // Copy new key and return
-    vd__strmap_copy_key(map, key, new_bin);
-    return new_bin;
+        Vdu8 *t = src; src = dst; dst = t;
+    }
+
+    if (src != (Vdu8*)base) {
+        VD_MEMCPY(base, src, count * size);
+    }
+
+    vd_arena_restore(save);
 }
+#endif // VD_INCLUDE_PLATFORM_SPECIFIC_FUNCTIONALITY
 
-/* ----KVMAP IMPL---------------------------------------------------------------------------------------------------- */
-static Vdb32 vd__kvmap_check_key(Vdusize ksize, void *check, Vd__KVMapBinPrefix *against)
+/* ----BITSET IMPL--------------------------------------------------------------------------------------------------- */
+#if VD_SIMD_SSE2
+#define VD__BITS_VEC_LOOP(op)                                                                                          \
+    for (Vdusize vec_end = num_words & ~(Vdusize)3; i < vec_end; i += 4) {                                             \
+        __m128i a0 = _mm_loadu_si128((const __m128i*)(a + i)), a1 = _mm_loadu_si128((const __m128i*)(a + i + 2));      \
+        __m128i b0 = _mm_loadu_si128((const __m128i*)(b + i)), b1 = _mm_loadu_si128((const __m128i*)(b + i + 2));      \
+        _mm_storeu_si128((__m128i*)(dst + i),     op(a0, b0));                                                         \
+        _mm_storeu_si128((__m128i*)(dst + i + 2), op(a1, b1));                                                         \
+    }
+#define VD__BITS_VAND(x, y)    _mm_and_si128((x), (y))
+#define VD__BITS_VOR(x, y)     _mm_or_si128((x), (y))
+#define VD__BITS_VANDNOT(x, y) _mm_andnot_si128((y), (x))
+#define VD__BITS_VXOR(x, y)    _mm_xor_si128((x), (y))
+#elif VD_SIMD_NEON
+#define VD__BITS_VEC_LOOP(op)                                                                                          \
+    for (Vdusize vec_end = num_words & ~(Vdusize)3; i < vec_end; i += 4) {                                             \
+        uint64x2_t a0 = vld1q_u64((const uint64_t*)(a + i)), a1 = vld1q_u64((const uint64_t*)(a + i + 2));             \
+        uint64x2_t b0 = vld1q_u64((const uint64_t*)(b + i)), b1 = vld1q_u64((const uint64_t*)(b + i + 2));             \
+        vst1q_u64((uint64_t*)(dst + i),     op(a0, b0));                                                               \
+        vst1q_u64((uint64_t*)(dst + i + 2), op(a1, b1));                                                               \
+    }
+#define VD__BITS_VAND(x, y)    vandq_u64((x), (y))
+#define VD__BITS_VOR(x, y)     vorrq_u64((x), (y))
+#define VD__BITS_VANDNOT(x, y) vbicq_u64((x), (y))
+#define VD__BITS_VXOR(x, y)    veorq_u64((x), (y))
+#else
+#define VD__BITS_VEC_LOOP(op)
+#endif // VD_SIMD_SSE2, VD_SIMD_NEON, else
+
+VD_API void vd_bits_and(Vdu64 *dst, const Vdu64 *a, const Vdu64 *b, Vdusize num_words)
 {
-    void *key_against = (void *)(((Vdu8ptr)against) + sizeof(Vd__KVMapBinPrefix));
-    return VD_MEMCMP(check, key_against, ksize) == 0;
+    Vdusize i = 0;
+    VD__BITS_VEC_LOOP(VD__BITS_VAND)
+    for (; i < num_words; ++i) dst[i] = a[i] & b[i];
 }
 
-static void vd__kvmap_copy_key(void *map, void *key, Vd__KVMapBinPrefix *bin)
+VD_API void vd_bits_or(Vdu64 *dst, const Vdu64 *a, const Vdu64 *b, Vdusize num_words)
 {
-    void *dst = (void *)(((Vdu8ptr)bin) + sizeof(Vd__KVMapBinPrefix));
-    VD_MEMCPY(dst, key, VD_KVMAP_KSIZE(map));
+    Vdusize i = 0;
+    VD__BITS_VEC_LOOP(VD__BITS_VOR)
+    for (; i < num_words; ++i) dst[i] = a[i] | b[i];
 }
 
-// @todo(mdodis): Speed this up if VD_ENABLE_SCRATCH_USE_IN_LIBRARY is enabled
-//                by using a simple queue to store re-inserted bins
-static void vd__kvmap_reinsert_chain(void *map, Vd__KVMapBinPrefix *start)
+VD_API void vd_bits_andnot(Vdu64 *dst, const Vdu64 *a, const Vdu64 *b, Vdusize num_words)
 {
-    // Build the insertion queue
-    Vd__KVMapBinPrefix *bin = start;
-    Vd__KVMapBinPrefix *bin_next = start->next;
-    while (bin_next != 0) {
-        bin->insq = bin_next;
+    Vdusize i = 0;
+    VD__BITS_VEC_LOOP(VD__BITS_VANDNOT)
+    for (; i < num_words; ++i) dst[i] = a[i] & ~b[i];
+}
 
-        bin       = bin_next;
-        bin_next  = bin->next;
+VD_API void vd_bits_xor(Vdu64 *dst, const Vdu64 *a, const Vdu64 *b, Vdusize num_words)
+{
+    Vdusize i = 0;
+    VD__BITS_VEC_LOOP(VD__BITS_VXOR)
+    for (; i < num_words; ++i) dst[i] = a[i] ^ b[i];
+}
+
+#undef VD__BITS_VEC_LOOP
+#undef VD__BITS_VAND
+#undef VD__BITS_VOR
+#undef VD__BITS_VANDNOT
+#undef VD__BITS_VXOR
+
+VD_API Vdusize vd_bits_popcount(const Vdu64 *words, Vdusize num_words)
+{
+    Vdusize result = 0;
+    Vdusize i = 0;
+
+#if VD_SIMD_SSE2 && !defined(__POPCNT__)
+    // Bit-slice count per byte, then sum bytes with psadbw
+    const __m128i m1   = _mm_set1_epi8(0x55);
+    const __m128i m2   = _mm_set1_epi8(0x33);
+    const __m128i m4   = _mm_set1_epi8(0x0F);
+    const __m128i zero = _mm_setzero_si128();
+    __m128i acc = zero;
+    for (; i + 2 <= num_words; i += 2) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(words + i));
+        v   = _mm_sub_epi8(v, _mm_and_si128(_mm_srli_epi64(v, 1), m1));
+        v   = _mm_add_epi8(_mm_and_si128(v, m2), _mm_and_si128(_mm_srli_epi64(v, 2), m2));
+        v   = _mm_and_si128(_mm_add_epi8(v, _mm_srli_epi64(v, 4)), m4);
+        acc = _mm_add_epi64(acc, _mm_sad_epu8(v, zero));
     }
 
-    // Traverse the queue and for each item, set its bin to be unused, then re-add it
-    Vd__KVMapBinPrefix *q = start->insq;
-    bin = start;
+    Vdu64 lanes[2];
+    _mm_storeu_si128((__m128i*)lanes, acc);
+    result = (Vdusize)(lanes[0] + lanes[1]);
+#elif VD_SIMD_NEON
+    uint64x2_t acc = vdupq_n_u64(0);
+    for (; i + 2 <= num_words; i += 2) {
+        uint8x16_t c = vcntq_u8(vreinterpretq_u8_u64(vld1q_u64((const uint64_t*)(words + i))));
+        acc = vpadalq_u32(acc, vpaddlq_u16(vpaddlq_u8(c)));
+    }
 
-    start->insq = 0;
+    result = (Vdusize)(vgetq_lane_u64(acc, 0) + vgetq_lane_u64(acc, 1));
+#endif // VD_SIMD_SSE2 && !defined(__POPCNT__), VD_SIMD_NEON
 
-    while (q != 0) {
-        q->used = VD_FALSE;
-        Vd__KVMapBinPrefix *nextq = q->insq;
-        q->insq = 0;
+    for (; i < num_words; ++i) result += vd_popcount64(words[i]);
+    return result;
+}
 
-        // Compose the key for q into a VdStr
-        Vdu64 key_hash;
-        {
-            void *k = (void *)(((Vdu8ptr)q) + sizeof(Vd__KVMapBinPrefix));
-            key_hash = vd_dhash64(k, VD_KVMAP_KSIZE(map));
-        }
+VD_API VdBitset vd_bitset_new(VdArena *arena, Vdusize num_bits)
+{
+    VdBitset result;
+    result.num_bits  = num_bits;
+    result.num_words = VD_BITS_WORDS(num_bits);
+    result.words     = (Vdu64*)vd_arena_alloc_align(arena, result.num_words * sizeof(Vdu64), 16);
+    return result;
+}
 
-        Vdusize bin_index = key_hash % VD_KVMAP_HEADER(map)->cap;
+static VD_INLINE Vdu64 vd__bits_mask_from(Vdusize bit) { return ~0ull << (bit & 63); }
+static VD_INLINE Vdu64 vd__bits_mask_upto(Vdusize bit) { return ~0ull >> (63 - (bit & 63)); }
 
-        Vd__KVMapBinPrefix *existing_bin = VD_KVMAP_GET_BIN(map, bin_index);
+VD_API void vd_bitset_set_range(VdBitset *b, Vdusize begin, Vdusize end)
+{
+    if (begin >= end) return;
 
-        // if the key for some reason hashes to the same place, then ignore it
-        if (existing_bin != q) {
+    Vdusize wb = begin >> 6;
+    Vdusize we = (end - 1) >> 6;
+    if (wb == we) {
+        b->words[wb] |= vd__bits_mask_from(begin) & vd__bits_mask_upto(end - 1);
+        return;
+    }
 
-            if (!existing_bin->used) {
-                Vd__KVMapBinPrefix *new_bin = existing_bin;
-                void *sptr = VD_KVMAP_BIN_MOVE_TO_VPTR(map, q);
-                void *dptr = VD_KVMAP_BIN_MOVE_TO_VPTR(map, new_bin);
+    b->words[wb] |= vd__bits_mask_from(begin);
+    VD_MEMSET(b->words + wb + 1, 0xFF, (we - wb - 1) * sizeof(Vdu64));
+    b->words[we] |= vd__bits_mask_upto(end - 1);
+}
 
-                new_bin->used = VD_TRUE;
-                new_bin->next = 0;
+VD_API void vd_bitset_clear_range(VdBitset *b, Vdusize begin, Vdusize end)
+{
+    if (begin >= end) return;
 
-                // Copy key
-                vd__kvmap_copy_key(map, VD_KVMAP_BIN_MOVE_TO_KPTR(q), new_bin);
+    Vdusize wb = begin >> 6;
+    Vdusize we = (end - 1) >> 6;
+    if (wb == we) {
+        b->words[wb] &= ~(vd__bits_mask_from(begin) & vd__bits_mask_upto(end - 1));
+        return;
+    }
 
-                // Copy over value
-                VD_MEMCPY(dptr, sptr, VD_KVMAP_VSIZE(map));
-            } else {
-                // Attempt to traverse the chain, if any
-                Vd__KVMapBinPrefix *chain_head = existing_bin;
-                while (chain_head->next == 0) {
-                    chain_head = chain_head->next;
-                }
+    b->words[wb] &= ~vd__bits_mask_from(begin);
+    VD_MEMSET(b->words + wb + 1, 0, (we - wb - 1) * sizeof(Vdu64));
+    b->words[we] &= ~vd__bits_mask_upto(end - 1);
+}
 
-                Vdu32 cursor = VD_KVMAP_HEADER(map)->cap_total;
-                while ((cursor > 0) && (VD_KVMAP_GET_BIN(map, cursor - 1)->used)) {
-                    cursor--;
-                }
+VD_API void vd_bitset_clear_all(VdBitset *b)
+{
+    VD_MEMSET(b->words, 0, b->num_words * sizeof(Vdu64));
+}
 
-                // After n iterations, if no bin was found we should be at a bin that's still used
-                // (i.e bin 0). In this case, return null.
-                if (cursor == 0) {
-                    VD_IMPOSSIBLE();
-                }
+static VD_INLINE Vdusize vd__bitset_common_words(VdBitset *dst, VdBitset *a, VdBitset *b)
+{
+    Vdusize result = dst->num_words;
+    if (a->num_words < result) result = a->num_words;
+    if (b->num_words < result) result = b->num_words;
+    return result;
+}
 
-                cursor--;
-                Vd__KVMapBinPrefix *new_bin = VD_KVMAP_GET_BIN(map, cursor);
+VD_API void vd_bitset_and(VdBitset *dst, VdBitset *a, VdBitset *b)    { vd_bits_and(dst->words, a->words, b->words, vd__bitset_common_words(dst, a, b)); }
+VD_API void vd_bitset_or(VdBitset *dst, VdBitset *a, VdBitset *b)     { vd_bits_or(dst->words, a->words, b->words, vd__bitset_common_words(dst, a, b)); }
+VD_API void vd_bitset_andnot(VdBitset *dst, VdBitset *a, VdBitset *b) { vd_bits_andnot(dst->words, a->words, b->words, vd__bitset_common_words(dst, a, b)); }
+VD_API void vd_bitset_xor(VdBitset *dst, VdBitset *a, VdBitset *b)    { vd_bits_xor(dst->words, a->words, b->words, vd__bitset_common_words(dst, a, b)); }
 
-                // Allocate the bin
-                new_bin->used = VD_TRUE;
-                new_bin->next = 0;
-                chain_head->next = new_bin;
+VD_API Vdusize vd_bitset_count(VdBitset *b)
+{
+    return vd_bits_popcount(b->words, b->num_words);
+}
 
-                void *sptr = VD_KVMAP_BIN_MOVE_TO_VPTR(map, q);
-                void *dptr = VD_KVMAP_BIN_MOVE_TO_VPTR(map, new_bin);
+VD_API Vdusize vd_bitset_count_range(VdBitset *b, Vdusize begin, Vdusize end)
+{
+    if (begin >= end) return 0;
 
-                // Copy key
-                vd__kvmap_copy_key(map, VD_KVMAP_BIN_MOVE_TO_KPTR(q), new_bin);
+    Vdusize wb = begin >> 6;
+    Vdusize we = (end - 1) >> 6;
+    if (wb == we) {
+        return vd_popcount64(b->words[wb] & vd__bits_mask_from(begin) & vd__bits_mask_upto(end - 1));
+    }
 
-                // Copy over value
-                VD_MEMCPY(dptr, sptr, VD_KVMAP_VSIZE(map));
-            }
-        } else {
-            q->used = VD_TRUE;
-        }
+    return vd_popcount64(b->words[wb] & vd__bits_mask_from(begin)) +
+           vd_bits_popcount(b->words + wb + 1, we - wb - 1) +
+           vd_popcount64(b->words[we] & vd__bits_mask_upto(end - 1));
+}
 
-        q = nextq;
+VD_API Vdusize vd_bitset_next(VdBitset *b, Vdusize from)
+{
+    if (from >= b->num_bits) return b->num_bits;
+
+    Vdusize wi = from >> 6;
+    Vdu64   w  = b->words[wi] & vd__bits_mask_from(from);
+    while (w == 0) {
+        if (++wi >= b->num_words) return b->num_bits;
+        w = b->words[wi];
     }
+
+    Vdusize result = (wi << 6) + vd_ctz64(w);
+    return result < b->num_bits ? result : b->num_bits;
 }
-void *vd__kvmap_init(VdArena *arena, Vdu32 ksize, Vdu32 vsize, Vdu32 cap, VdKVMapInitOptions *options)
+
+VD_API Vdusize vd_bitset_to_indices(VdBitset *b, Vdu32 *out)
 {
-    Vd__KVMapHeader *map;
-    const Vdu32 bin_size = sizeof(Vd__KVMapBinPrefix) + ksize + vsize;    
+    Vdusize n = 0;
+    for (Vdusize wi = 0; wi < b->num_words; ++wi) {
+        Vdu64 w = b->words[wi];
+        if ((wi == b->num_words - 1) && (b->num_bits & 63)) {
+            w &= vd__bits_mask_upto(b->num_bits - 1);
+        }
 
-    map = (Vd__KVMapHeader*)vd_arena_alloc(arena, sizeof(Vd__KVMapHeader) + bin_size * cap);
-    float address_scale = 0.863f;
-    if (options != 0) address_scale = options->address_scale;
+        while (w) {
+            out[n++] = (Vdu32)((wi << 6) + vd_ctz64(w));
+            w &= w - 1;
+        }
+    }
 
-    map->cap_total    = cap;
-    map->cap          = (Vdu32) (((Vdf32)cap) * address_scale);
-    map->taken        = 0;
-    map->ksize        = ksize;
-    map->vsize        = vsize;
+    return n;
+}
 
-    return (void*)(((Vdu8*)map) + sizeof(Vd__KVMapHeader));
+VD_API void vd_sparse_bitset_init(VdSparseBitset *s, VdArena *arena)
+{
+    s->arena          = arena;
+    s->containers     = 0;
+    s->num_containers = 0;
+    s->cap_containers = 0;
 }
 
-Vd__KVMapBinPrefix *vd__kvmap_get_bin(void *map, void *key, Vd__KVMapGetBinFlags op)
+// Lower bound of key among the containers
+static Vdu32 vd__sparse_bitset_find(VdSparseBitset *s, Vdu16 key)
 {
-    // Get hash
-    Vdu64 hash = vd_dhash64(key, VD_KVMAP_KSIZE(map));
-    Vdu64 bin_index = hash % VD_KVMAP_HEADER(map)->cap;
+    Vdu32 lo = 0, hi = s->num_containers;
+    while (lo < hi) {
+        Vdu32 mid = (lo + hi) / 2;
+        if (s->containers[mid].key < key) lo = mid + 1;
+        else                              hi = mid;
+    }
+    return lo;
+}
 
-    // Find existing bin if any
-    Vd__KVMapBinPrefix *existing_bin = VD_KVMAP_GET_BIN(map, bin_index);
+// Lower bound of x in a sorted Vdu16 array
+static Vdu32 vd__sparse_array_find(Vdu16 *arr, Vdu32 count, Vdu16 x)
+{
+    Vdu32 lo = 0, hi = count;
+    while (lo < hi) {
+        Vdu32 mid = (lo + hi) / 2;
+        if (arr[mid] < x) lo = mid + 1;
+        else              hi = mid;
+    }
+    return lo;
+}
 
-    // If:
-    // (existing_bin->used == 0) AND
-    //      - We don't need to create a new bin then we want to search anyway since we'll do an early
-    //        return after this if statement
-    //      - We do need to create a new bin then we stop here, because we found it
-    //
-    // (existing_bin->used == 1) AND
-    //      - We don't need to create a new bin, then go inside this statement to see if we can find
-    //        the bin matching the query
-    //      - We do need to create a new bin, then go inside anyway because at the end (meaning if
-    //        we actually find a place to allocate the bin), we'll want to link the collided bin chain
-    //        to the newly allocated bin
-    if (existing_bin->used || !(op & VD__KVMAP_GET_BIN_FLAGS_CREATE)) {
-        Vdb32 found = VD_FALSE;
+static VdSparseBitsetContainer *vd__sparse_bitset_insert(VdSparseBitset *s, Vdu32 index, Vdu16 key)
+{
+    if (s->num_containers == s->cap_containers) {
+        Vdu32 new_cap = s->cap_containers ? s->cap_containers * 2 : 8;
+        s->containers = (VdSparseBitsetContainer*)vd_arena_resize(s->arena, s->containers,
+                                                                   sizeof(VdSparseBitsetContainer) * s->cap_containers,
+                                                                   sizeof(VdSparseBitsetContainer) * new_cap);
+        s->cap_containers = new_cap;
+    }
 
-        // Make sure that the hash didn't put us in a bin where the key is equal to the query key
-        if (vd__kvmap_check_key(VD_KVMAP_KSIZE(map), key, existing_bin)) {
-            found = VD_TRUE;
-        }
+    VD_MEMMOVE(s->containers + index + 1, s->containers + index,
+               sizeof(VdSparseBitsetContainer) * (s->num_containers - index));
+    s->num_containers++;
 
-        // If the bin isn't what we searched for, traverse the chain until the end to find it.
-        while (!found && (existing_bin->next != 0)) {
-            existing_bin = existing_bin->next;
+    VdSparseBitsetContainer *c = &s->containers[index];
+    VD_MEMSET(c, 0, sizeof(*c));
+    c->key = key;
+    return c;
+}
 
-            if (vd__kvmap_check_key(VD_KVMAP_KSIZE(map), key, existing_bin)) {
-                found = VD_TRUE;
-                break;
-            }
+static Vdu64 *vd__sparse_array_to_bitmap(VdArena *arena, Vdu16 *arr, Vdu32 count)
+{
+    Vdu64 *words = (Vdu64*)vd_arena_alloc_align(arena, VD_SPARSE_BITSET_BITMAP_WORDS * sizeof(Vdu64), 16);
+    for (Vdu32 i = 0; i < count; ++i) vd_bits_set(words, arr[i]);
+    return words;
+}
+
+static Vdu16 *vd__sparse_bitmap_to_array(VdArena *arena, Vdu64 *words, Vdu32 count)
+{
+    Vdu16 *arr = (Vdu16*)vd_arena_alloc(arena, sizeof(Vdu16) * (count ? count : 1));
+    Vdu32 n = 0;
+    for (Vdu32 wi = 0; wi < VD_SPARSE_BITSET_BITMAP_WORDS; ++wi) {
+        Vdu64 w = words[wi];
+        while (w) {
+            arr[n++] = (Vdu16)((wi << 6) + vd_ctz64(w));
+            w &= w - 1;
         }
+    }
+    return arr;
+}
 
-        if (found) {
-            if (op & VD__KVMAP_GET_BIN_FLAGS_SET_UNUSED) {
-                // if found is true the bin must be unused, set its flag and return
-                existing_bin->used = VD_FALSE;
-                VD_KVMAP_HEADER(map)->taken--;
-                vd__kvmap_reinsert_chain(map, existing_bin);
-                return existing_bin;
+static void vd__sparse_bitset_push(VdSparseBitset *dst, Vdu16 key, Vdb32 is_bitmap, Vdu32 count, void *data)
+{
+    if (count == 0) return;
 
-            } else if (op & VD__KVMAP_GET_BIN_FLAGS_GET_EXISTING) {
-                // If the user wants to create a new bin, overwrite existing one, or just get it, and found is true, 
-                // this means that the user queried with an existing key. Return the existing bin in thie case.
-                return existing_bin;
-            } else if (op & VD__KVMAP_GET_BIN_FLAGS_CREATE) {
-                // If the user wants to create a new bin, and found is true, this means that the user
-                // queried with the same key. Return null in this case.
-                return 0;
-            }
-        }
+    if (is_bitmap && (count <= VD_SPARSE_BITSET_ARRAY_MAX)) {
+        data      = vd__sparse_bitmap_to_array(dst->arena, (Vdu64*)data, count);
+        is_bitmap = VD_FALSE;
+    }
+
+    VdSparseBitsetContainer *c = vd__sparse_bitset_insert(dst, dst->num_containers, key);
+    c->is_bitmap = (Vdu16)is_bitmap;
+    c->count     = count;
+    c->cap       = is_bitmap ? 0 : count;
+    c->data      = data;
+}
+
+static void vd__sparse_bitset_push_copy(VdSparseBitset *dst, VdSparseBitsetContainer *src)
+{
+    Vdusize size = src->is_bitmap ? VD_SPARSE_BITSET_BITMAP_WORDS * sizeof(Vdu64) : src->count * sizeof(Vdu16);
+    void *data = vd_arena_alloc_align(dst->arena, size, 16);
+    VD_MEMCPY(data, src->data, size);
+    vd__sparse_bitset_push(dst, src->key, src->is_bitmap, src->count, data);
+}
+
+VD_API Vdb32 vd_sparse_bitset_add(VdSparseBitset *s, Vdu32 x)
+{
+    Vdu16 key = (Vdu16)(x >> 16);
+    Vdu16 low = (Vdu16)(x & 0xFFFF);
+
+    Vdu32 ci = vd__sparse_bitset_find(s, key);
+    if ((ci == s->num_containers) || (s->containers[ci].key != key)) {
+        vd__sparse_bitset_insert(s, ci, key);
+    }
+
+    VdSparseBitsetContainer *c = &s->containers[ci];
+    if (c->is_bitmap) {
+        Vdu64 *words = (Vdu64*)c->data;
+        if (vd_bits_test(words, low)) return VD_FALSE;
+        vd_bits_set(words, low);
+        c->count++;
+        return VD_TRUE;
+    }
+
+    Vdu16 *arr = (Vdu16*)c->data;
+    Vdu32 pos = vd__sparse_array_find(arr, c->count, low);
+    if ((pos < c->count) && (arr[pos] == low)) return VD_FALSE;
+
+    if (c->count == VD_SPARSE_BITSET_ARRAY_MAX) {
+        Vdu64 *words = vd__sparse_array_to_bitmap(s->arena, arr, c->count);
+        vd_bits_set(words, low);
+        c->data      = words;
+        c->is_bitmap = 1;
+        c->cap       = 0;
+        c->count++;
+        return VD_TRUE;
+    }
+
+    if (c->count == c->cap) {
+        Vdu32 new_cap = c->cap ? c->cap * 2 : 4;
+        if (new_cap > VD_SPARSE_BITSET_ARRAY_MAX) new_cap = VD_SPARSE_BITSET_ARRAY_MAX;
+        arr = (Vdu16*)vd_arena_resize(s->arena, arr, sizeof(Vdu16) * c->cap, sizeof(Vdu16) * new_cap);
+        c->data = arr;
+        c->cap  = new_cap;
+    }
+
+    VD_MEMMOVE(arr + pos + 1, arr + pos, sizeof(Vdu16) * (c->count - pos));
+    arr[pos] = low;
+    c->count++;
+    return VD_TRUE;
+}
+
+VD_API Vdb32 vd_sparse_bitset_remove(VdSparseBitset *s, Vdu32 x)
+{
+    Vdu16 key = (Vdu16)(x >> 16);
+    Vdu16 low = (Vdu16)(x & 0xFFFF);
+
+    Vdu32 ci = vd__sparse_bitset_find(s, key);
+    if ((ci == s->num_containers) || (s->containers[ci].key != key)) return VD_FALSE;
+
+    VdSparseBitsetContainer *c = &s->containers[ci];
+    if (c->is_bitmap) {
+        Vdu64 *words = (Vdu64*)c->data;
+        if (!vd_bits_test(words, low)) return VD_FALSE;
+        vd_bits_clear(words, low);
+        c->count--;
+
+        if (c->count <= VD_SPARSE_BITSET_ARRAY_MAX) {
+            c->data      = vd__sparse_bitmap_to_array(s->arena, words, c->count);
+            c->is_bitmap = 0;
+            c->cap       = c->count;
+        }
+    } else {
+        Vdu16 *arr = (Vdu16*)c->data;
+        Vdu32 pos = vd__sparse_array_find(arr, c->count, low);
+        if ((pos == c->count) || (arr[pos] != low)) return VD_FALSE;
+        VD_MEMMOVE(arr + pos, arr + pos + 1, sizeof(Vdu16) * (c->count - pos - 1));
+        c->count--;
+    }
+
+    if (c->count == 0) {
+        VD_MEMMOVE(s->containers + ci, s->containers + ci + 1,
+                   sizeof(VdSparseBitsetContainer) * (s->num_containers - ci - 1));
+        s->num_containers--;
+    }
+
+    return VD_TRUE;
+}
+
+VD_API Vdb32 vd_sparse_bitset_test(VdSparseBitset *s, Vdu32 x)
+{
+    Vdu16 key = (Vdu16)(x >> 16);
+    Vdu16 low = (Vdu16)(x & 0xFFFF);
+
+    Vdu32 ci = vd__sparse_bitset_find(s, key);
+    if ((ci == s->num_containers) || (s->containers[ci].key != key)) return VD_FALSE;
+
+    VdSparseBitsetContainer *c = &s->containers[ci];
+    if (c->is_bitmap) return vd_bits_test((Vdu64*)c->data, low);
+
+    Vdu16 *arr = (Vdu16*)c->data;
+    Vdu32 pos = vd__sparse_array_find(arr, c->count, low);
+    return (pos < c->count) && (arr[pos] == low);
+}
+
+VD_API Vdu64 vd_sparse_bitset_count(VdSparseBitset *s)
+{
+    Vdu64 result = 0;
+    for (Vdu32 i = 0; i < s->num_containers; ++i) result += s->containers[i].count;
+    return result;
+}
+
+VD_API void vd_sparse_bitset_and(VdSparseBitset *dst, VdSparseBitset *a, VdSparseBitset *b)
+{
+    Vdu32 i = 0, j = 0;
+    while ((i < a->num_containers) && (j < b->num_containers)) {
+        VdSparseBitsetContainer *ca = &a->containers[i];
+        VdSparseBitsetContainer *cb = &b->containers[j];
+        if (ca->key < cb->key) { i++; continue; }
+        if (ca->key > cb->key) { j++; continue; }
+
+        if (ca->is_bitmap && cb->is_bitmap) {
+            Vdu64 *words = (Vdu64*)vd_arena_alloc_align(dst->arena, VD_SPARSE_BITSET_BITMAP_WORDS * sizeof(Vdu64), 16);
+            vd_bits_and(words, (Vdu64*)ca->data, (Vdu64*)cb->data, VD_SPARSE_BITSET_BITMAP_WORDS);
+            Vdu32 count = (Vdu32)vd_bits_popcount(words, VD_SPARSE_BITSET_BITMAP_WORDS);
+            vd__sparse_bitset_push(dst, ca->key, VD_TRUE, count, words);
+        } else if (ca->is_bitmap || cb->is_bitmap) {
+            VdSparseBitsetContainer *bm  = ca->is_bitmap ? ca : cb;
+            VdSparseBitsetContainer *arr = ca->is_bitmap ? cb : ca;
+            Vdu16 *src = (Vdu16*)arr->data;
+            Vdu16 *out = (Vdu16*)vd_arena_alloc(dst->arena, sizeof(Vdu16) * arr->count);
+            Vdu32 n = 0;
+            for (Vdu32 k = 0; k < arr->count; ++k) {
+                out[n] = src[k];
+                n += vd_bits_test((Vdu64*)bm->data, src[k]);
+            }
+            vd__sparse_bitset_push(dst, ca->key, VD_FALSE, n, out);
+        } else {
+            Vdu16 *x = (Vdu16*)ca->data, *y = (Vdu16*)cb->data;
+            Vdu16 *out = (Vdu16*)vd_arena_alloc(dst->arena, sizeof(Vdu16) * (ca->count < cb->count ? ca->count : cb->count));
+            Vdu32 xi = 0, yi = 0, n = 0;
+            while ((xi < ca->count) && (yi < cb->count)) {
+                if      (x[xi] < y[yi]) xi++;
+                else if (x[xi] > y[yi]) yi++;
+                else    { out[n++] = x[xi]; xi++; yi++; }
+            }
+            vd__sparse_bitset_push(dst, ca->key, VD_FALSE, n, out);
+        }
+
+        i++;
+        j++;
+    }
+}
+
+VD_API void vd_sparse_bitset_or(VdSparseBitset *dst, VdSparseBitset *a, VdSparseBitset *b)
+{
+    Vdu32 i = 0, j = 0;
+    while ((i < a->num_containers) || (j < b->num_containers)) {
+        if (j == b->num_containers || ((i < a->num_containers) && (a->containers[i].key < b->containers[j].key))) {
+            vd__sparse_bitset_push_copy(dst, &a->containers[i++]);
+            continue;
+        }
+
+        if (i == a->num_containers || (b->containers[j].key < a->containers[i].key)) {
+            vd__sparse_bitset_push_copy(dst, &b->containers[j++]);
+            continue;
+        }
+
+        VdSparseBitsetContainer *ca = &a->containers[i++];
+        VdSparseBitsetContainer *cb = &b->containers[j++];
+
+        if (ca->is_bitmap || cb->is_bitmap) {
+            Vdu64 *words = (Vdu64*)vd_arena_alloc_align(dst->arena, VD_SPARSE_BITSET_BITMAP_WORDS * sizeof(Vdu64), 16);
+            if (ca->is_bitmap && cb->is_bitmap) {
+                vd_bits_or(words, (Vdu64*)ca->data, (Vdu64*)cb->data, VD_SPARSE_BITSET_BITMAP_WORDS);
+            } else {
+                VdSparseBitsetContainer *bm  = ca->is_bitmap ? ca : cb;
+                VdSparseBitsetContainer *arr = ca->is_bitmap ? cb : ca;
+                VD_MEMCPY(words, bm->data, VD_SPARSE_BITSET_BITMAP_WORDS * sizeof(Vdu64));
+                for (Vdu32 k = 0; k < arr->count; ++k) vd_bits_set(words, ((Vdu16*)arr->data)[k]);
+            }
+
+            Vdu32 count = (Vdu32)vd_bits_popcount(words, VD_SPARSE_BITSET_BITMAP_WORDS);
+            vd__sparse_bitset_push(dst, ca->key, VD_TRUE, count, words);
+        } else {
+            Vdu16 *x = (Vdu16*)ca->data, *y = (Vdu16*)cb->data;
+            Vdu16 *out = (Vdu16*)vd_arena_alloc(dst->arena, sizeof(Vdu16) * (ca->count + cb->count));
+            Vdu32 xi = 0, yi = 0, n = 0;
+            while ((xi < ca->count) && (yi < cb->count)) {
+                if      (x[xi] < y[yi]) out[n++] = x[xi++];
+                else if (x[xi] > y[yi]) out[n++] = y[yi++];
+                else    { out[n++] = x[xi]; xi++; yi++; }
+            }
+            while (xi < ca->count) out[n++] = x[xi++];
+            while (yi < cb->count) out[n++] = y[yi++];
+
+            if (n > VD_SPARSE_BITSET_ARRAY_MAX) {
+                vd__sparse_bitset_push(dst, ca->key, VD_TRUE, n, vd__sparse_array_to_bitmap(dst->arena, out, n));
+            } else {
+                vd__sparse_bitset_push(dst, ca->key, VD_FALSE, n, out);
+            }
+        }
+    }
+}
+
+VD_API Vdb32 vd_sparse_bitset_next(VdSparseBitset *s, Vdu32 from, Vdu32 *out)
+{
+    Vdu16 key = (Vdu16)(from >> 16);
+    for (Vdu32 ci = vd__sparse_bitset_find(s, key); ci < s->num_containers; ++ci) {
+        VdSparseBitsetContainer *c = &s->containers[ci];
+        Vdu32 low_from = (c->key == key) ? (from & 0xFFFF) : 0;
+
+        if (c->is_bitmap) {
+            Vdu64 *words = (Vdu64*)c->data;
+            Vdu32 wi = low_from >> 6;
+            Vdu64 w  = words[wi] & vd__bits_mask_from(low_from);
+            while ((w == 0) && (++wi < VD_SPARSE_BITSET_BITMAP_WORDS)) w = words[wi];
+
+            if (w) {
+                *out = ((Vdu32)c->key << 16) | ((wi << 6) + vd_ctz64(w));
+                return VD_TRUE;
+            }
+        } else {
+            Vdu16 *arr = (Vdu16*)c->data;
+            Vdu32 pos = vd__sparse_array_find(arr, c->count, (Vdu16)low_from);
+            if (pos < c->count) {
+                *out = ((Vdu32)c->key << 16) | arr[pos];
+                return VD_TRUE;
+            }
+        }
+    }
+
+    return VD_FALSE;
+}
+
+VD_API void vd_sparse_bitset_from_bitset(VdSparseBitset *dst, VdBitset *src)
+{
+    Vdusize num_words = src->num_words;
+    if (num_words > ((Vdusize)VD_SPARSE_BITSET_BITMAP_WORDS << 16)) num_words = (Vdusize)VD_SPARSE_BITSET_BITMAP_WORDS << 16;
+
+    for (Vdusize base = 0; base < num_words; base += VD_SPARSE_BITSET_BITMAP_WORDS) {
+        Vdusize chunk_words = num_words - base;
+        if (chunk_words > VD_SPARSE_BITSET_BITMAP_WORDS) chunk_words = VD_SPARSE_BITSET_BITMAP_WORDS;
+
+        Vdu64 *words = (Vdu64*)vd_arena_alloc_align(dst->arena, VD_SPARSE_BITSET_BITMAP_WORDS * sizeof(Vdu64), 16);
+        VD_MEMCPY(words, src->words + base, chunk_words * sizeof(Vdu64));
+        if ((base + chunk_words == src->num_words) && (src->num_bits & 63)) {
+            words[chunk_words - 1] &= vd__bits_mask_upto(src->num_bits - 1);
+        }
+
+        Vdu32 count = (Vdu32)vd_bits_popcount(words, chunk_words);
+        vd__sparse_bitset_push(dst, (Vdu16)(base / VD_SPARSE_BITSET_BITMAP_WORDS), VD_TRUE, count, words);
+    }
+}
+
+VD_API void vd_sparse_bitset_to_bitset(VdSparseBitset *s, VdBitset *dst)
+{
+    vd_bitset_clear_all(dst);
+
+    for (Vdu32 ci = 0; ci < s->num_containers; ++ci) {
+        VdSparseBitsetContainer *c = &s->containers[ci];
+        Vdusize base_word = (Vdusize)c->key * VD_SPARSE_BITSET_BITMAP_WORDS;
+        if (base_word >= dst->num_words) break;
+
+        if (c->is_bitmap) {
+            Vdusize n = dst->num_words - base_word;
+            if (n > VD_SPARSE_BITSET_BITMAP_WORDS) n = VD_SPARSE_BITSET_BITMAP_WORDS;
+            VD_MEMCPY(dst->words + base_word, c->data, n * sizeof(Vdu64));
+        } else {
+            Vdu16 *arr = (Vdu16*)c->data;
+            for (Vdu32 k = 0; k < c->count; ++k) {
+                Vdusize bit = ((Vdusize)c->key << 16) | arr[k];
+                if (bit >= dst->num_bits) break;
+                vd_bits_set(dst->words, bit);
+            }
+        }
+    }
+
+    if (dst->num_bits & 63) {
+        dst->words[dst->num_words - 1] &= vd__bits_mask_upto(dst->num_bits - 1);
+    }
+}
+
+/* ----UTF8 IMPL----------------------------------------------------------------------------------------------------- */
+#define VD__UTF8_HIGH_BITS 0x8080808080808080ull
+
+#if VD_SIMD_NEON && (defined(__aarch64__) || defined(_M_ARM64))
+#define VD__UTF8_NEON64 1
+#else
+#define VD__UTF8_NEON64 0
+#endif // VD_SIMD_NEON && (defined(__aarch64__) || defined(_M_ARM64))
+
+VD_API Vdb32 vd_utf8_is_ascii(const void *data, Vdusize len)
+{
+    const Vdu8 *s = (const Vdu8*)data;
+    Vdusize     i = 0;
+
+#if VD_SIMD_SSE2
+    __m128i acc = _mm_setzero_si128();
+    for (; i + 16 <= len; i += 16) {
+        acc = _mm_or_si128(acc, _mm_loadu_si128((const __m128i*)(s + i)));
+    }
+    if (_mm_movemask_epi8(acc) != 0) return VD_FALSE;
+#endif // VD_SIMD_SSE2
+
+    Vdu64 acc64 = 0;
+    for (; i + 8 <= len; i += 8) {
+        Vdu64 w;
+        VD_MEMCPY(&w, s + i, 8);
+        acc64 |= w;
+    }
+
+    for (; i < len; ++i) acc64 |= s[i];
+    return (acc64 & VD__UTF8_HIGH_BITS) == 0;
+}
+
+/**
+ * Classification tables for the lookup algorithm (Keiser & Lemire, "Validating UTF-8 In Less Than One Instruction Per
+ * Byte"). Every error is described by the high nibble of the previous byte, its low nibble and the high nibble of the
+ * current byte; a bit that is set in all three lookups marks the error.
+ */
+#define VD__UTF8_TOO_SHORT      (1 << 0) // 11______ 0_______ or 11______ 11______
+#define VD__UTF8_TOO_LONG       (1 << 1) // 0_______ 10______
+#define VD__UTF8_OVERLONG_3     (1 << 2) // 11100000 100_____
+#define VD__UTF8_TOO_LARGE      (1 << 3) // 11110100 1001____ and above
+#define VD__UTF8_SURROGATE      (1 << 4) // 11101101 101_____
+#define VD__UTF8_OVERLONG_2     (1 << 5) // 1100000_ 10______
+#define VD__UTF8_TOO_LARGE_1000 (1 << 6) // 11110101 1000____ and above
+#define VD__UTF8_OVERLONG_4     (1 << 6) // 11110000 1000____
+#define VD__UTF8_TWO_CONTS      (1 << 7) // 10______ 10______
+#define VD__UTF8_CARRY          (VD__UTF8_TOO_SHORT | VD__UTF8_TOO_LONG | VD__UTF8_TWO_CONTS)
+
+static const Vdu8 Vd__Utf8_Byte_1_High[16] = {
+    VD__UTF8_TOO_LONG, VD__UTF8_TOO_LONG, VD__UTF8_TOO_LONG, VD__UTF8_TOO_LONG,
+    VD__UTF8_TOO_LONG, VD__UTF8_TOO_LONG, VD__UTF8_TOO_LONG, VD__UTF8_TOO_LONG,
+    VD__UTF8_TWO_CONTS, VD__UTF8_TWO_CONTS, VD__UTF8_TWO_CONTS, VD__UTF8_TWO_CONTS,
+    VD__UTF8_TOO_SHORT | VD__UTF8_OVERLONG_2,
+    VD__UTF8_TOO_SHORT,
+    VD__UTF8_TOO_SHORT | VD__UTF8_OVERLONG_3 | VD__UTF8_SURROGATE,
+    VD__UTF8_TOO_SHORT | VD__UTF8_TOO_LARGE | VD__UTF8_TOO_LARGE_1000 | VD__UTF8_OVERLONG_4,
+};
+
+static const Vdu8 Vd__Utf8_Byte_1_Low[16] = {
+    VD__UTF8_CARRY | VD__UTF8_OVERLONG_3 | VD__UTF8_OVERLONG_2 | VD__UTF8_OVERLONG_4,
+    VD__UTF8_CARRY | VD__UTF8_OVERLONG_2,
+    VD__UTF8_CARRY,
+    VD__UTF8_CARRY,
+    VD__UTF8_CARRY | VD__UTF8_TOO_LARGE,
+    VD__UTF8_CARRY | VD__UTF8_TOO_LARGE | VD__UTF8_TOO_LARGE_1000,
+    VD__UTF8_CARRY | VD__UTF8_TOO_LARGE | VD__UTF8_TOO_LARGE_1000,
+    VD__UTF8_CARRY | VD__UTF8_TOO_LARGE | VD__UTF8_TOO_LARGE_1000,
+    VD__UTF8_CARRY | VD__UTF8_TOO_LARGE | VD__UTF8_TOO_LARGE_1000,
+    VD__UTF8_CARRY | VD__UTF8_TOO_LARGE | VD__UTF8_TOO_LARGE_1000,
+    VD__UTF8_CARRY | VD__UTF8_TOO_LARGE | VD__UTF8_TOO_LARGE_1000,
+    VD__UTF8_CARRY | VD__UTF8_TOO_LARGE | VD__UTF8_TOO_LARGE_1000,
+    VD__UTF8_CARRY | VD__UTF8_TOO_LARGE | VD__UTF8_TOO_LARGE_1000,
+    VD__UTF8_CARRY | VD__UTF8_TOO_LARGE | VD__UTF8_TOO_LARGE_1000 | VD__UTF8_SURROGATE,
+    VD__UTF8_CARRY | VD__UTF8_TOO_LARGE | VD__UTF8_TOO_LARGE_1000,
+    VD__UTF8_CARRY | VD__UTF8_TOO_LARGE | VD__UTF8_TOO_LARGE_1000,
+};
+
+static const Vdu8 Vd__Utf8_Byte_2_High[16] = {
+    VD__UTF8_TOO_SHORT, VD__UTF8_TOO_SHORT, VD__UTF8_TOO_SHORT, VD__UTF8_TOO_SHORT,
+    VD__UTF8_TOO_SHORT, VD__UTF8_TOO_SHORT, VD__UTF8_TOO_SHORT, VD__UTF8_TOO_SHORT,
+    VD__UTF8_TOO_LONG | VD__UTF8_OVERLONG_2 | VD__UTF8_TWO_CONTS | VD__UTF8_OVERLONG_3 | VD__UTF8_TOO_LARGE_1000 |
+    VD__UTF8_OVERLONG_4,
+    VD__UTF8_TOO_LONG | VD__UTF8_OVERLONG_2 | VD__UTF8_TWO_CONTS | VD__UTF8_OVERLONG_3 | VD__UTF8_TOO_LARGE,
+    VD__UTF8_TOO_LONG | VD__UTF8_OVERLONG_2 | VD__UTF8_TWO_CONTS | VD__UTF8_SURROGATE  | VD__UTF8_TOO_LARGE,
+    VD__UTF8_TOO_LONG | VD__UTF8_OVERLONG_2 | VD__UTF8_TWO_CONTS | VD__UTF8_SURROGATE  | VD__UTF8_TOO_LARGE,
+    VD__UTF8_TOO_SHORT, VD__UTF8_TOO_SHORT, VD__UTF8_TOO_SHORT, VD__UTF8_TOO_SHORT,
+};
+
+// A sequence is incomplete at the end of a block if its lead byte is in the last 3, 2 or 1 bytes respectively.
+static const Vdu8 Vd__Utf8_Max_Complete[16] = {
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xF0 - 1, 0xE0 - 1, 0xC0 - 1,
+};
+
+#if VD_SIMD_SSSE3
+#define VD__UTF8_LOOKUP 1
+typedef __m128i Vd__Utf8Vec;
+#define VD__UTF8_LOAD(p)              _mm_loadu_si128((const __m128i*)(p))
+#define VD__UTF8_SET1(x)              _mm_set1_epi8((char)(x))
+#define VD__UTF8_ZERO()               _mm_setzero_si128()
+#define VD__UTF8_AND(a, b)            _mm_and_si128(a, b)
+#define VD__UTF8_OR(a, b)             _mm_or_si128(a, b)
+#define VD__UTF8_XOR(a, b)            _mm_xor_si128(a, b)
+#define VD__UTF8_SUBS(a, b)           _mm_subs_epu8(a, b)
+#define VD__UTF8_LOOKUP16(t, i)       _mm_shuffle_epi8(t, i)
+#define VD__UTF8_HI4(x)               _mm_and_si128(_mm_srli_epi16(x, 4), _mm_set1_epi8(0x0F))
+#define VD__UTF8_LO4(x)               _mm_and_si128(x, _mm_set1_epi8(0x0F))
+#define VD__UTF8_PREV(in, prev, n)    _mm_alignr_epi8(in, prev, 16 - (n))
+#define VD__UTF8_ANY_HIGH(x)          (_mm_movemask_epi8(x) != 0)
+#define VD__UTF8_ANY(x)               (_mm_movemask_epi8(_mm_cmpeq_epi8(x, _mm_setzero_si128())) != 0xFFFF)
+#elif VD__UTF8_NEON64
+#define VD__UTF8_LOOKUP 1
+typedef uint8x16_t Vd__Utf8Vec;
+#define VD__UTF8_LOAD(p)              vld1q_u8((const Vdu8*)(p))
+#define VD__UTF8_SET1(x)              vdupq_n_u8((Vdu8)(x))
+#define VD__UTF8_ZERO()               vdupq_n_u8(0)
+#define VD__UTF8_AND(a, b)            vandq_u8(a, b)
+#define VD__UTF8_OR(a, b)             vorrq_u8(a, b)
+#define VD__UTF8_XOR(a, b)            veorq_u8(a, b)
+#define VD__UTF8_SUBS(a, b)           vqsubq_u8(a, b)
+#define VD__UTF8_LOOKUP16(t, i)       vqtbl1q_u8(t, i)
+#define VD__UTF8_HI4(x)               vshrq_n_u8(x, 4)
+#define VD__UTF8_LO4(x)               vandq_u8(x, vdupq_n_u8(0x0F))
+#define VD__UTF8_PREV(in, prev, n)    vextq_u8(prev, in, 16 - (n))
+#define VD__UTF8_ANY_HIGH(x)          (vmaxvq_u8(x) >= 0x80)
+#define VD__UTF8_ANY(x)               (vmaxvq_u8(x) != 0)
+#else
+#define VD__UTF8_LOOKUP 0
+#endif // VD_SIMD_SSSE3, VD__UTF8_NEON64
+
+static Vdb32 vd__utf8_validate_scalar(const Vdu8 *s, Vdusize len)
+{
+    Vdusize i = 0;
+    while (i < len) {
+        if (i + 8 <= len) {
+            Vdu64 w;
+            VD_MEMCPY(&w, s + i, 8);
+            if ((w & VD__UTF8_HIGH_BITS) == 0) {
+                i += 8;
+                continue;
+            }
+        }
+
+        if (s[i] < 0x80) {
+            i++;
+            continue;
+        }
+
+        Vdu32 codepoint;
+        Vdu32 n = vd_utf8_decode(s + i, len - i, &codepoint);
+        if (n == 0) return VD_FALSE;
+        i += n;
+    }
+
+    return VD_TRUE;
+}
+
+#if VD__UTF8_LOOKUP
+typedef struct {
+    Vd__Utf8Vec error;
+    Vd__Utf8Vec prev_input;
+    Vd__Utf8Vec prev_incomplete;
+    Vd__Utf8Vec byte_1_high;
+    Vd__Utf8Vec byte_1_low;
+    Vd__Utf8Vec byte_2_high;
+    Vd__Utf8Vec max_complete;
+} Vd__Utf8Checker;
+
+static VD_INLINE void vd__utf8_check_block(Vd__Utf8Checker *c, Vd__Utf8Vec input)
+{
+    if (!VD__UTF8_ANY_HIGH(input)) {
+        // An ASCII block is only an error if the previous one ended in the middle of a sequence.
+        c->error           = VD__UTF8_OR(c->error, c->prev_incomplete);
+        c->prev_incomplete = VD__UTF8_ZERO();
+        c->prev_input      = input;
+        return;
+    }
+
+    Vd__Utf8Vec prev1 = VD__UTF8_PREV(input, c->prev_input, 1);
+    Vd__Utf8Vec sc    = VD__UTF8_AND(VD__UTF8_AND(VD__UTF8_LOOKUP16(c->byte_1_high, VD__UTF8_HI4(prev1)),
+                                                  VD__UTF8_LOOKUP16(c->byte_1_low,  VD__UTF8_LO4(prev1))),
+                                     VD__UTF8_LOOKUP16(c->byte_2_high, VD__UTF8_HI4(input)));
+
+    // The third and fourth bytes of 3/4 byte sequences must be continuations (only 111_____ and 1111____ saturate to
+    // 0x80 or above), and those are exactly the places where sc has TWO_CONTS set.
+    Vd__Utf8Vec prev2  = VD__UTF8_PREV(input, c->prev_input, 2);
+    Vd__Utf8Vec prev3  = VD__UTF8_PREV(input, c->prev_input, 3);
+    Vd__Utf8Vec must23 = VD__UTF8_OR(VD__UTF8_SUBS(prev2, VD__UTF8_SET1(0xE0 - 0x80)),
+                                     VD__UTF8_SUBS(prev3, VD__UTF8_SET1(0xF0 - 0x80)));
+    Vd__Utf8Vec must23_80 = VD__UTF8_AND(must23, VD__UTF8_SET1(0x80));
+
+    c->error           = VD__UTF8_OR(c->error, VD__UTF8_XOR(must23_80, sc));
+    c->prev_incomplete = VD__UTF8_SUBS(input, c->max_complete);
+    c->prev_input      = input;
+}
+
+static Vdb32 vd__utf8_validate_lookup(const Vdu8 *s, Vdusize len)
+{
+    Vd__Utf8Checker c;
+    c.error           = VD__UTF8_ZERO();
+    c.prev_input      = VD__UTF8_ZERO();
+    c.prev_incomplete = VD__UTF8_ZERO();
+    c.byte_1_high     = VD__UTF8_LOAD(Vd__Utf8_Byte_1_High);
+    c.byte_1_low      = VD__UTF8_LOAD(Vd__Utf8_Byte_1_Low);
+    c.byte_2_high     = VD__UTF8_LOAD(Vd__Utf8_Byte_2_High);
+    c.max_complete    = VD__UTF8_LOAD(Vd__Utf8_Max_Complete);
+
+    Vdusize i = 0;
+    for (; i + 16 <= len; i += 16) {
+        vd__utf8_check_block(&c, VD__UTF8_LOAD(s + i));
+
+        // Bail out early every 1KiB, otherwise keep the loop free of branches on the error.
+        if (((i & 1023) == 1008) && VD__UTF8_ANY(c.error)) return VD_FALSE;
+    }
+
+    if (i < len) {
+        // Zero padding is ASCII, so a sequence cut short by the end of the input shows up as TOO_SHORT.
+        Vdu8 tail[16] = {0};
+        VD_MEMCPY(tail, s + i, len - i);
+        vd__utf8_check_block(&c, VD__UTF8_LOAD(tail));
+    }
+
+    return !VD__UTF8_ANY(VD__UTF8_OR(c.error, c.prev_incomplete));
+}
+#endif // VD__UTF8_LOOKUP
+
+VD_API Vdb32 vd_utf8_validate(const void *data, Vdusize len)
+{
+#if VD__UTF8_LOOKUP
+    // Short strings aren't worth setting up the lookup tables for
+    if (len < 16) return vd__utf8_validate_scalar((const Vdu8*)data, len);
+    return vd__utf8_validate_lookup((const Vdu8*)data, len);
+#else
+    return vd__utf8_validate_scalar((const Vdu8*)data, len);
+#endif // VD__UTF8_LOOKUP
+}
+
+VD_API Vdusize vd_utf8_count(const void *data, Vdusize len)
+{
+    const Vdu8 *s      = (const Vdu8*)data;
+    Vdusize     i      = 0;
+    Vdusize     result = 0;
+
+#if VD_SIMD_SSE2
+    // Continuation bytes are 0x80..0xBF, i.e. -128..-65 when signed.
+    const __m128i threshold = _mm_set1_epi8(-65);
+    for (; i + 16 <= len; i += 16) {
+        __m128i x = _mm_loadu_si128((const __m128i*)(s + i));
+        result += vd_popcount64((Vdu64)_mm_movemask_epi8(_mm_cmpgt_epi8(x, threshold)));
+    }
+#elif VD__UTF8_NEON64
+    const int8x16_t threshold = vdupq_n_s8(-65);
+    for (; i + 16 <= len; i += 16) {
+        uint8x16_t lead = vcgtq_s8(vreinterpretq_s8_u8(vld1q_u8(s + i)), threshold);
+        result += vaddvq_u8(vshrq_n_u8(lead, 7));
+    }
+#endif // VD_SIMD_SSE2, VD__UTF8_NEON64
+
+    for (; i + 8 <= len; i += 8) {
+        Vdu64 w;
+        VD_MEMCPY(&w, s + i, 8);
+        Vdu64 continuation = w & ~(w << 1) & VD__UTF8_HIGH_BITS;
+        result += 8 - vd_popcount64(continuation);
+    }
+
+    for (; i < len; ++i) result += (s[i] & 0xC0) != 0x80;
+    return result;
+}
+
+static const Vdu8 Vd__Utf8_Lead_Mask[5] = { 0x00, 0x7F, 0x1F, 0x0F, 0x07 };
+
+VD_API Vdusize vd_utf8_to_utf32(const void *data, Vdusize len, Vdu32 *out)
+{
+    const Vdu8 *s     = (const Vdu8*)data;
+    Vdusize     i     = 0;
+    Vdusize     count = 0;
+
+    while (i < len) {
+#if VD_SIMD_SSE2
+        // Every non-continuation byte from i on still has a slot in out (vd_utf8_count counts them, and only bytes
+        // before i have been emitted for). With 16 of them left all 16 lanes can be stored even if only the ASCII
+        // prefix is kept, since the codepoints that follow overwrite the rest; that holds for invalid input too.
+        if (i + 16 <= len) {
+            __m128i x    = _mm_loadu_si128((const __m128i*)(s + i));
+            int     mask = _mm_movemask_epi8(x);
+            Vdb32   wide = (mask == 0);
+            if (!wide) {
+                __m128i cont  = _mm_set1_epi8(-64);
+                Vdu32   leads = vd_popcount64((Vdu64)(~_mm_movemask_epi8(_mm_cmplt_epi8(x, cont)) & 0xFFFF));
+                if ((leads < 16) && (i + 32 <= len)) {
+                    __m128i y = _mm_loadu_si128((const __m128i*)(s + i + 16));
+                    leads += vd_popcount64((Vdu64)(~_mm_movemask_epi8(_mm_cmplt_epi8(y, cont)) & 0xFFFF));
+                }
+                wide = leads >= 16;
+            }
+
+            if (wide) {
+                __m128i zero = _mm_setzero_si128();
+                __m128i lo   = _mm_unpacklo_epi8(x, zero);
+                __m128i hi   = _mm_unpackhi_epi8(x, zero);
+                _mm_storeu_si128((__m128i*)(out + count +  0), _mm_unpacklo_epi16(lo, zero));
+                _mm_storeu_si128((__m128i*)(out + count +  4), _mm_unpackhi_epi16(lo, zero));
+                _mm_storeu_si128((__m128i*)(out + count +  8), _mm_unpacklo_epi16(hi, zero));
+                _mm_storeu_si128((__m128i*)(out + count + 12), _mm_unpackhi_epi16(hi, zero));
+
+                Vdu32 ascii = vd_ctz64((Vdu64)mask | 0x10000);
+                i     += ascii;
+                count += ascii;
+                if (ascii == 16) continue;
+            } else {
+                Vdu32 ascii = vd_ctz64((Vdu64)mask);
+                for (Vdu32 k = 0; k < ascii; ++k) out[count + k] = s[i + k];
+                i     += ascii;
+                count += ascii;
+            }
+        }
+#elif VD_SIMD_NEON
+        if (i + 16 <= len) {
+            uint8x16_t x = vld1q_u8(s + i);
+            uint8x8_t  high = vorr_u8(vget_low_u8(x), vget_high_u8(x));
+            if ((vget_lane_u64(vreinterpret_u64_u8(high), 0) & VD__UTF8_HIGH_BITS) == 0) {
+                uint16x8_t lo = vmovl_u8(vget_low_u8(x));
+                uint16x8_t hi = vmovl_u8(vget_high_u8(x));
+                vst1q_u32(out + count +  0, vmovl_u16(vget_low_u16(lo)));
+                vst1q_u32(out + count +  4, vmovl_u16(vget_high_u16(lo)));
+                vst1q_u32(out + count +  8, vmovl_u16(vget_low_u16(hi)));
+                vst1q_u32(out + count + 12, vmovl_u16(vget_high_u16(hi)));
+                i     += 16;
+                count += 16;
+                continue;
+            }
+        }
+#endif // VD_SIMD_SSE2, VD_SIMD_NEON
+
+        Vdu32 lead = s[i];
+
+        if (i + 4 <= len) {
+            // Branchless decode: the number of leading ones gives the length, then all four bytes are merged and the
+            // ones that don't belong to this codepoint are shifted out.
+            Vdu32 n = vd_clz64(~((Vdu64)lead << 56));
+            n = (n == 0) ? 1 : ((n > 4) ? 4 : n);
+
+            Vdu32 codepoint = ((lead & Vd__Utf8_Lead_Mask[n]) << 18) | ((Vdu32)(s[i + 1] & 0x3F) << 12) |
+                              ((Vdu32)(s[i + 2] & 0x3F) << 6) | (Vdu32)(s[i + 3] & 0x3F);
+
+            // Never emit for a stray continuation byte, so invalid input can't write more than vd_utf8_count entries.
+            if ((lead & 0xC0) != 0x80) out[count++] = codepoint >> (6 * (4 - n));
+            i += n;
+            continue;
+        }
+
+        Vdu32 codepoint;
+        Vdu32 n = vd_utf8_decode(s + i, len - i, &codepoint);
+        if (n == 0) {
+            // Only reachable with unvalidated input: emit U+FFFD and resynchronize on the next lead byte.
+            codepoint = 0xFFFD;
+            n         = 1;
+            while ((i + n < len) && ((s[i + n] & 0xC0) == 0x80)) n++;
+        }
+
+        if ((lead & 0xC0) != 0x80) out[count++] = codepoint;
+        i += n;
+    }
+
+    return count;
+}
+
+VD_API Vdu32 *vd_utf8_to_utf32_arena(VdArena *a, const void *data, Vdusize len, Vdusize *count)
+{
+    if (!vd_utf8_validate(data, len)) {
+        if (count) *count = 0;
+        return 0;
+    }
+
+    Vdusize num_codepoints = vd_utf8_count(data, len);
+    Vdu32 *result = (Vdu32*)vd_arena_alloc_align(a, sizeof(Vdu32) * (num_codepoints ? num_codepoints : 1),
+                                                 sizeof(Vdu32));
+    if (result == 0) return 0;
+
+    vd_utf8_to_utf32(data, len, result);
+    if (count) *count = num_codepoints;
+    return result;
+}
+
+/* ----CHECKSUM IMPL------------------------------------------------------------------------------------------------- */
+#define VD__CRC32C_POLY 0x82F63B78u /* Reflected 0x1EDC6F41 */
+#define VD__CRC16_POLY  0xA001u     /* Reflected 0x8005 */
+
+#if (defined(__SSE4_2__) && defined(__x86_64__)) || (defined(__AVX__) && defined(_M_X64))
+#define VD__CRC32C_X86     1
+#define VD__CRC32C_RUNTIME 0
+#include <nmmintrin.h>
+#elif (defined(__x86_64__) && VD_HOST_COMPILER_CLANG) || (defined(_M_X64) && VD_HOST_COMPILER_MSVC)
+#define VD__CRC32C_X86     1
+#define VD__CRC32C_RUNTIME 1
+#include <nmmintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+#define VD__CRC32C_ARM     1
+#define VD__CRC32C_RUNTIME 0
+#include <arm_acle.h>
+#endif
+
+#ifndef VD__CRC32C_X86
+#define VD__CRC32C_X86 0
+#endif // !VD__CRC32C_X86
+
+#ifndef VD__CRC32C_ARM
+#define VD__CRC32C_ARM 0
+#endif // !VD__CRC32C_ARM
+
+#ifndef VD__CRC32C_RUNTIME
+#define VD__CRC32C_RUNTIME 0
+#endif // !VD__CRC32C_RUNTIME
+
+// Tables are built on first use; 0 = not built, 1 = building, 2 = ready
+static volatile Vdu32 Vd__Crc_Tables_State;
+static Vdu32          Vd__Crc32c_Table[8][256];
+static Vdu16          Vd__Crc16_Table[256];
+
+static void vd__crc_tables_init(void)
+{
+    if (vd_atomic_load_u32(&Vd__Crc_Tables_State) == 2) return;
+
+    if (!vd_atomic_cas_u32(&Vd__Crc_Tables_State, 0, 1)) {
+        while (vd_atomic_load_u32(&Vd__Crc_Tables_State) != 2) vd_cpu_relax();
+        return;
+    }
+
+    for (Vdu32 n = 0; n < 256; ++n) {
+        Vdu32 c = n;
+        Vdu32 d = n;
+        for (int k = 0; k < 8; ++k) {
+            c = (c & 1) ? (c >> 1) ^ VD__CRC32C_POLY : (c >> 1);
+            d = (d & 1) ? (d >> 1) ^ VD__CRC16_POLY  : (d >> 1);
+        }
+        Vd__Crc32c_Table[0][n] = c;
+        Vd__Crc16_Table[n]     = (Vdu16)d;
+    }
+
+    // Table k advances a byte through k more zero bytes, so 8 lookups consume 8 bytes at once
+    for (Vdu32 n = 0; n < 256; ++n) {
+        Vdu32 c = Vd__Crc32c_Table[0][n];
+        for (int k = 1; k < 8; ++k) {
+            c = Vd__Crc32c_Table[0][c & 0xFF] ^ (c >> 8);
+            Vd__Crc32c_Table[k][n] = c;
+        }
+    }
+
+    vd_atomic_store_u32(&Vd__Crc_Tables_State, 2);
+}
+
+VD_API Vdu32 vd_crc32c_portable(Vdu32 crc, const void *data, Vdusize len)
+{
+    vd__crc_tables_init();
+
+    const Vdu8 *p = (const Vdu8*)data;
+    Vdu32      c  = ~crc;
+
+    while ((len > 0) && (((Vduptr)p & 7) != 0)) {
+        c = Vd__Crc32c_Table[0][(c ^ *p++) & 0xFF] ^ (c >> 8);
+        len--;
+    }
+
+    while (len >= 8) {
+        Vdu32 lo, hi;
+        VD_MEMCPY(&lo, p, 4);
+        VD_MEMCPY(&hi, p + 4, 4);
+        lo ^= c;
+        c = Vd__Crc32c_Table[7][lo & 0xFF]         ^ Vd__Crc32c_Table[6][(lo >> 8) & 0xFF] ^
+            Vd__Crc32c_Table[5][(lo >> 16) & 0xFF] ^ Vd__Crc32c_Table[4][lo >> 24]         ^
+            Vd__Crc32c_Table[3][hi & 0xFF]         ^ Vd__Crc32c_Table[2][(hi >> 8) & 0xFF] ^
+            Vd__Crc32c_Table[1][(hi >> 16) & 0xFF] ^ Vd__Crc32c_Table[0][hi >> 24];
+        p   += 8;
+        len -= 8;
+    }
+
+    while (len-- > 0) {
+        c = Vd__Crc32c_Table[0][(c ^ *p++) & 0xFF] ^ (c >> 8);
+    }
+
+    return ~c;
+}
+
+VD_API Vdu16 vd_crc16(Vdu16 crc, const void *data, Vdusize len)
+{
+    vd__crc_tables_init();
+
+    const Vdu8 *p = (const Vdu8*)data;
+    for (Vdusize i = 0; i < len; ++i) {
+        crc = Vd__Crc16_Table[(crc ^ p[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return crc;
+}
+
+#if VD__CRC32C_X86 || VD__CRC32C_ARM
+// Stream lengths for the 3-way interleaved loop, and x^(8 * length) mod P to shift a CRC over that many zero bytes
+#define VD__CRC32C_LONG        8192
+#define VD__CRC32C_SHORT       256
+#define VD__CRC32C_LONG_SHIFT  0x28461564u
+#define VD__CRC32C_SHORT_SHIFT 0x88E56F72u
+
+// Carry-less a * b mod P, in the reflected representation (x^0 is the top bit)
+static Vdu32 vd__crc32c_multiply(Vdu32 a, Vdu32 b)
+{
+    Vdu32 m = 1u << 31;
+    Vdu32 p = 0;
+    for (;;) {
+        if (a & m) {
+            p ^= b;
+            if ((a & (m - 1)) == 0) break;
+        }
+        m >>= 1;
+        b = (b & 1) ? (b >> 1) ^ VD__CRC32C_POLY : (b >> 1);
+    }
+    return p;
+}
+
+#if VD__CRC32C_X86
+#if VD__CRC32C_RUNTIME && VD_HOST_COMPILER_CLANG
+#define VD__CRC32C_TARGET __attribute__((target("sse4.2")))
+#else
+#define VD__CRC32C_TARGET
+#endif // VD__CRC32C_RUNTIME && VD_HOST_COMPILER_CLANG
+
+#define VD__CRC32C_U8(c, x)  _mm_crc32_u8((c), (x))
+#define VD__CRC32C_U64(c, x) (Vdu32)_mm_crc32_u64((c), (x))
+#else
+#define VD__CRC32C_TARGET
+#define VD__CRC32C_U8(c, x)  __crc32cb((c), (x))
+#define VD__CRC32C_U64(c, x) __crc32cd((c), (x))
+#endif // VD__CRC32C_X86
+
+static VD__CRC32C_TARGET Vdu32 vd__crc32c_hw(Vdu32 crc, const void *data, Vdusize len)
+{
+    const Vdu8 *p = (const Vdu8*)data;
+    Vdu32      c  = ~crc;
+
+    while ((len > 0) && (((Vduptr)p & 7) != 0)) {
+        c = VD__CRC32C_U8(c, *p++);
+        len--;
+    }
+
+    // The crc32 instruction has a latency of 3 and a throughput of 1, so three independent streams keep it busy.
+    // Their results are merged by shifting the earlier ones over the length of the later ones.
+    while (len >= 3 * VD__CRC32C_LONG) {
+        Vdu32 c1 = 0, c2 = 0;
+        for (Vdusize i = 0; i < VD__CRC32C_LONG; i += 8) {
+            Vdu64 x0, x1, x2;
+            VD_MEMCPY(&x0, p + i, 8);
+            VD_MEMCPY(&x1, p + i + VD__CRC32C_LONG, 8);
+            VD_MEMCPY(&x2, p + i + 2 * VD__CRC32C_LONG, 8);
+            c  = VD__CRC32C_U64(c,  x0);
+            c1 = VD__CRC32C_U64(c1, x1);
+            c2 = VD__CRC32C_U64(c2, x2);
+        }
+        c = vd__crc32c_multiply(VD__CRC32C_LONG_SHIFT, c) ^ c1;
+        c = vd__crc32c_multiply(VD__CRC32C_LONG_SHIFT, c) ^ c2;
+        p   += 3 * VD__CRC32C_LONG;
+        len -= 3 * VD__CRC32C_LONG;
+    }
+
+    while (len >= 3 * VD__CRC32C_SHORT) {
+        Vdu32 c1 = 0, c2 = 0;
+        for (Vdusize i = 0; i < VD__CRC32C_SHORT; i += 8) {
+            Vdu64 x0, x1, x2;
+            VD_MEMCPY(&x0, p + i, 8);
+            VD_MEMCPY(&x1, p + i + VD__CRC32C_SHORT, 8);
+            VD_MEMCPY(&x2, p + i + 2 * VD__CRC32C_SHORT, 8);
+            c  = VD__CRC32C_U64(c,  x0);
+            c1 = VD__CRC32C_U64(c1, x1);
+            c2 = VD__CRC32C_U64(c2, x2);
+        }
+        c = vd__crc32c_multiply(VD__CRC32C_SHORT_SHIFT, c) ^ c1;
+        c = vd__crc32c_multiply(VD__CRC32C_SHORT_SHIFT, c) ^ c2;
+        p   += 3 * VD__CRC32C_SHORT;
+        len -= 3 * VD__CRC32C_SHORT;
+    }
+
+    while (len >= 8) {
+        Vdu64 x;
+        VD_MEMCPY(&x, p, 8);
+        c = VD__CRC32C_U64(c, x);
+        p   += 8;
+        len -= 8;
+    }
+
+    while (len-- > 0) {
+        c = VD__CRC32C_U8(c, *p++);
+    }
+
+    return ~c;
+}
+#endif // VD__CRC32C_X86 || VD__CRC32C_ARM
+
+VD_API Vdb32 vd_crc32c_hw_available(void)
+{
+#if VD__CRC32C_RUNTIME && VD_HOST_COMPILER_MSVC
+    int info[4];
+    __cpuid(info, 1);
+    return (info[2] & (1 << 20)) != 0;
+#elif VD__CRC32C_RUNTIME
+    return __builtin_cpu_supports("sse4.2") != 0;
+#else
+    return VD__CRC32C_X86 || VD__CRC32C_ARM;
+#endif // VD__CRC32C_RUNTIME && VD_HOST_COMPILER_MSVC, VD__CRC32C_RUNTIME, else
+}
+
+VD_API Vdu32 vd_crc32c(Vdu32 crc, const void *data, Vdusize len)
+{
+#if VD__CRC32C_RUNTIME
+    static volatile Vdu32 hw = 0; // 0 = unknown, 1 = no, 2 = yes
+    Vdu32 state = vd_atomic_load_u32(&hw);
+    if (state == 0) {
+        state = vd_crc32c_hw_available() ? 2 : 1;
+        vd_atomic_store_u32(&hw, state);
+    }
+
+    if (state == 2) return vd__crc32c_hw(crc, data, len);
+    return vd_crc32c_portable(crc, data, len);
+#elif VD__CRC32C_X86 || VD__CRC32C_ARM
+    return vd__crc32c_hw(crc, data, len);
+#else
+    return vd_crc32c_portable(crc, data, len);
+#endif // VD__CRC32C_RUNTIME, VD__CRC32C_X86 || VD__CRC32C_ARM, else
+}
+
+/* ----LZ IMPL------------------------------------------------------------------------------------------------------- */
+#define VD__LZ_MIN_MATCH     4
+#define VD__LZ_LAST_LITERALS 5  // The last 5 bytes are always literals...
+#define VD__LZ_MFLIMIT       12 // ...and the last match starts at least 12 bytes before the end (LZ4 block rules).
+#define VD__LZ_MAX_OFFSET    65535
+#define VD__LZ_HASH_LOG      12
+#define VD__LZ_SKIP_TRIGGER  6
+
+static VD_INLINE Vdu32 vd__lz_read32(const Vdu8 *p)         { Vdu32 v; VD_MEMCPY(&v, p, 4); return v; }
+static VD_INLINE Vdu64 vd__lz_read64(const Vdu8 *p)         { Vdu64 v; VD_MEMCPY(&v, p, 8); return v; }
+static VD_INLINE Vdu32 vd__lz_hash(Vdu32 v)                 { return (v * 2654435761u) >> (32 - VD__LZ_HASH_LOG); }
+static VD_INLINE void  vd__lz_copy8(Vdu8 *d, const Vdu8 *s) { VD_MEMCPY(d, s, 8); }
+
+static VD_INLINE void vd__lz_write_u32le(Vdu8 *p, Vdu32 v)
+{
+    p[0] = (Vdu8)(v);
+    p[1] = (Vdu8)(v >> 8);
+    p[2] = (Vdu8)(v >> 16);
+    p[3] = (Vdu8)(v >> 24);
+}
+
+static VD_INLINE Vdu32 vd__lz_read_u32le(const Vdu8 *p)
+{
+    return (Vdu32)p[0] | ((Vdu32)p[1] << 8) | ((Vdu32)p[2] << 16) | ((Vdu32)p[3] << 24);
+}
+
+static VD_INLINE Vdu8 *vd__lz_write_length(Vdu8 *op, Vdusize len)
+{
+    while (len >= 255) {
+        *op++ = 255;
+        len  -= 255;
+    }
+    *op++ = (Vdu8)len;
+    return op;
+}
+
+VD_API Vdusize vd_lz_compress(const void *src, Vdusize src_len, void *dst, Vdusize dst_cap)
+{
+    const Vdu8 *in     = (const Vdu8*)src;
+    const Vdu8 *ip     = in;
+    const Vdu8 *anchor = in;
+    const Vdu8 *iend   = in + src_len;
+    Vdu8       *out    = (Vdu8*)dst;
+    Vdu8       *op     = out;
+    Vdu8       *oend   = out + dst_cap;
+
+    // Positions are stored as 32-bit offsets from src.
+    if (src_len > 0x7E000000) return 0;
+
+    if (src_len >= VD__LZ_MFLIMIT + 1) {
+        Vdu32       table[1 << VD__LZ_HASH_LOG];
+        const Vdu8  *mflimit    = iend - VD__LZ_MFLIMIT;
+        const Vdu8  *matchlimit = iend - VD__LZ_LAST_LITERALS;
+
+        VD_MEMSET(table, 0, sizeof(table));
+        ip++;
+
+        for (;;) {
+            const Vdu8 *match;
+
+            // Search for a 4 byte match, stepping faster the longer nothing is found.
+            Vdu32 attempts = 1 << VD__LZ_SKIP_TRIGGER;
+            for (;;) {
+                Vdu32 h    = vd__lz_hash(vd__lz_read32(ip));
+                Vdu32 step = attempts++ >> VD__LZ_SKIP_TRIGGER;
+
+                match    = in + table[h];
+                table[h] = (Vdu32)(ip - in);
+
+                if (((Vdusize)(ip - match) <= VD__LZ_MAX_OFFSET) && (vd__lz_read32(match) == vd__lz_read32(ip))) {
+                    break;
+                }
+
+                ip += step;
+                if (ip > mflimit) goto last_literals;
+            }
+
+            while ((ip > anchor) && (match > in) && (ip[-1] == match[-1])) {
+                ip--;
+                match--;
+            }
+
+            // Extend forwards 8 bytes at a time; the first differing byte is found from the lowest set bit, which
+            // assumes a little-endian target (as does the rest of the library).
+            const Vdu8 *mp = ip + VD__LZ_MIN_MATCH;
+            const Vdu8 *mm = match + VD__LZ_MIN_MATCH;
+            while (mp + 8 <= matchlimit) {
+                Vdu64 diff = vd__lz_read64(mp) ^ vd__lz_read64(mm);
+                if (diff) {
+                    mp += vd_ctz64(diff) >> 3;
+                    goto match_end;
+                }
+                mp += 8;
+                mm += 8;
+            }
+            while ((mp < matchlimit) && (*mp == *mm)) {
+                mp++;
+                mm++;
+            }
+match_end:;
+
+            Vdusize lit_len   = (Vdusize)(ip - anchor);
+            Vdusize match_len = (Vdusize)(mp - ip) - VD__LZ_MIN_MATCH;
+
+            if ((Vdusize)(oend - op) < 1 + lit_len / 255 + 1 + lit_len + 2 + match_len / 255 + 1) return 0;
+
+            Vdu8 *token = op++;
+            *token = (Vdu8)(((lit_len >= 15) ? 15 : lit_len) << 4);
+            if (lit_len >= 15) op = vd__lz_write_length(op, lit_len - 15);
+            VD_MEMCPY(op, anchor, lit_len);
+            op += lit_len;
+
+            Vdusize offset = (Vdusize)(ip - match);
+            *op++ = (Vdu8)(offset);
+            *op++ = (Vdu8)(offset >> 8);
+
+            *token |= (Vdu8)((match_len >= 15) ? 15 : match_len);
+            if (match_len >= 15) op = vd__lz_write_length(op, match_len - 15);
+
+            ip     = mp;
+            anchor = ip;
+            if (ip > mflimit) break;
+
+            table[vd__lz_hash(vd__lz_read32(ip - 2))] = (Vdu32)(ip - 2 - in);
+        }
+    }
+
+last_literals:;
+    Vdusize lit_len = (Vdusize)(iend - anchor);
+    if ((Vdusize)(oend - op) < 1 + lit_len / 255 + 1 + lit_len) return 0;
+
+    Vdu8 *token = op++;
+    *token = (Vdu8)(((lit_len >= 15) ? 15 : lit_len) << 4);
+    if (lit_len >= 15) op = vd__lz_write_length(op, lit_len - 15);
+    VD_MEMCPY(op, anchor, lit_len);
+    op += lit_len;
+
+    return (Vdusize)(op - out);
+}
+
+VD_API Vdb32 vd_lz_decompress(const void *src, Vdusize src_len, void *dst, Vdusize dst_len)
+{
+    const Vdu8 *ip     = (const Vdu8*)src;
+    const Vdu8 *iend   = ip + src_len;
+    Vdu8       *op     = (Vdu8*)dst;
+    Vdu8       *ostart = op;
+    Vdu8       *oend   = op + dst_len;
+
+    for (;;) {
+        if (ip >= iend) return VD_FALSE;
+
+        Vdu32   token   = *ip++;
+        Vdusize lit_len = token >> 4;
+
+        // Shortcut for the common case of short literals followed by a short match: copy fixed sizes with no loops
+        // or length checks, as long as there is enough room on both sides.
+        if ((lit_len != 15) && ((token & 15) != 15) && ((iend - ip) >= 16 + 2) && ((oend - op) >= 16 + 24)) {
+            vd__lz_copy8(op, ip);
+            vd__lz_copy8(op + 8, ip + 8);
+            op += lit_len;
+            ip += lit_len;
+
+            Vdusize offset = (Vdusize)ip[0] | ((Vdusize)ip[1] << 8);
+            if ((offset >= 8) && (offset <= (Vdusize)(op - ostart))) {
+                const Vdu8 *match = op - offset;
+                vd__lz_copy8(op, match);
+                vd__lz_copy8(op + 8, match + 8);
+                vd__lz_copy8(op + 16, match + 16);
+                ip += 2;
+                op += (token & 15) + VD__LZ_MIN_MATCH;
+                continue;
+            }
+
+            // Let the general path handle the match (or the end of the block).
+            lit_len = 0;
+        } else if (lit_len == 15) {
+            Vdu32 b;
+            do {
+                if (ip >= iend) return VD_FALSE;
+                b = *ip++;
+                lit_len += b;
+            } while (b == 255);
+        }
+
+        if ((lit_len > (Vdusize)(iend - ip)) || (lit_len > (Vdusize)(oend - op))) return VD_FALSE;
+
+        if (((Vdusize)(iend - ip) >= lit_len + 16) && ((Vdusize)(oend - op) >= lit_len + 16)) {
+            // Enough slack on both sides to copy in whole 16 byte steps.
+            const Vdu8 *s = ip;
+            Vdu8       *d = op;
+            Vdu8       *e = op + lit_len;
+            do {
+                vd__lz_copy8(d, s);
+                vd__lz_copy8(d + 8, s + 8);
+                d += 16;
+                s += 16;
+            } while (d < e);
+        } else {
+            VD_MEMCPY(op, ip, lit_len);
+        }
+
+        ip += lit_len;
+        op += lit_len;
+
+        // The last sequence only has literals.
+        if (ip == iend) break;
+
+        if ((iend - ip) < 2) return VD_FALSE;
+        Vdusize offset = (Vdusize)ip[0] | ((Vdusize)ip[1] << 8);
+        ip += 2;
+        if ((offset == 0) || (offset > (Vdusize)(op - ostart))) return VD_FALSE;
+
+        Vdusize match_len = token & 15;
+        if (match_len == 15) {
+            Vdu32 b;
+            do {
+                if (ip >= iend) return VD_FALSE;
+                b = *ip++;
+                match_len += b;
+            } while (b == 255);
+        }
+        match_len += VD__LZ_MIN_MATCH;
+
+        if (match_len > (Vdusize)(oend - op)) return VD_FALSE;
+
+        const Vdu8 *match = op - offset;
+        Vdu8       *e     = op + match_len;
+        if (offset == 1) {
+            VD_MEMSET(op, *match, match_len);
+            op = e;
+            continue;
+        }
+
+        if (offset < 8) {
+            // The match repeats with a period of offset, so any multiple of it is an equally valid distance. Copy the
+            // first period bytes one at a time, then continue from a distance of at least 8.
+            Vdusize period = offset;
+            while (period < 8) period += offset;
+
+            Vdu8 *head_end = ((Vdusize)(e - op) > period) ? op + period : e;
+            while (op < head_end) *op++ = *match++;
+            match = op - period;
+        }
+
+        // Chunks of 8 never read bytes that the same chunk writes.
+        while (e - op >= 8) {
+            vd__lz_copy8(op, match);
+            op    += 8;
+            match += 8;
+        }
+        while (op < e) *op++ = *match++;
+    }
+
+    return op == oend;
+}
+
+VD_API Vdusize vd_lz_frame_bound(Vdusize n)
+{
+    Vdusize num_blocks = (n + VD_LZ_FRAME_BLOCK_SIZE - 1) / VD_LZ_FRAME_BLOCK_SIZE;
+    return sizeof(VdLzFrameHeader) + num_blocks * 8 + n + 4;
+}
+
+VD_API Vdusize vd_lz_frame_write_header(void *dst, Vdusize dst_cap, Vdu64 content_size)
+{
+    if (dst_cap < sizeof(VdLzFrameHeader)) return 0;
+
+    Vdu8 *p = (Vdu8*)dst;
+    VD_MEMSET(p, 0, sizeof(VdLzFrameHeader));
+    vd__lz_write_u32le(p + 0, VD_LZ_FRAME_MAGIC);
+    p[4] = VD_LZ_FRAME_VERSION;
+    vd__lz_write_u32le(p + 8, VD_LZ_FRAME_BLOCK_SIZE);
+    vd__lz_write_u32le(p + 16, (Vdu32)content_size);
+    vd__lz_write_u32le(p + 20, (Vdu32)(content_size >> 32));
+    return sizeof(VdLzFrameHeader);
+}
+
+VD_API Vdusize vd_lz_frame_write_block(const void *src, Vdusize src_len, void *dst, Vdusize dst_cap)
+{
+    VD_ASSERT(src_len <= VD_LZ_FRAME_BLOCK_SIZE);
+    if (src_len == 0) return 0;
+    if (dst_cap < 8) return 0;
+
+    Vdu8    *p        = (Vdu8*)dst;
+    Vdusize payload   = dst_cap - 8;
+    Vdusize max_lz    = (payload < src_len - 1) ? payload : src_len - 1;
+    Vdusize lz_size   = (src_len > 1) ? vd_lz_compress(src, src_len, p + 8, max_lz) : 0;
+
+    if (lz_size != 0) {
+        vd__lz_write_u32le(p, (Vdu32)lz_size);
+        vd__lz_write_u32le(p + 4, (Vdu32)src_len);
+        return 8 + lz_size;
+    }
+
+    // Incompressible: store as is.
+    if (payload < src_len) return 0;
+    vd__lz_write_u32le(p, (Vdu32)src_len | VD_LZ_FRAME_BLOCK_STORED);
+    vd__lz_write_u32le(p + 4, (Vdu32)src_len);
+    VD_MEMCPY(p + 8, src, src_len);
+    return 8 + src_len;
+}
+
+VD_API Vdusize vd_lz_frame_write_end(void *dst, Vdusize dst_cap)
+{
+    if (dst_cap < 4) return 0;
+    vd__lz_write_u32le((Vdu8*)dst, 0);
+    return 4;
+}
+
+VD_API Vdusize vd_lz_frame_compress(const void *src, Vdusize src_len, void *dst, Vdusize dst_cap)
+{
+    const Vdu8 *in  = (const Vdu8*)src;
+    Vdu8       *out = (Vdu8*)dst;
+    Vdusize    at   = vd_lz_frame_write_header(out, dst_cap, src_len);
+    if (at == 0) return 0;
+
+    for (Vdusize i = 0; i < src_len; i += VD_LZ_FRAME_BLOCK_SIZE) {
+        Vdusize len     = (src_len - i < VD_LZ_FRAME_BLOCK_SIZE) ? src_len - i : VD_LZ_FRAME_BLOCK_SIZE;
+        Vdusize written = vd_lz_frame_write_block(in + i, len, out + at, dst_cap - at);
+        if (written == 0) return 0;
+        at += written;
+    }
+
+    Vdusize written = vd_lz_frame_write_end(out + at, dst_cap - at);
+    if (written == 0) return 0;
+    return at + written;
+}
+
+VD_API VdLzStatus vd_lz_frame_reader_init(VdLzFrameReader *reader, const void *data, Vdusize size)
+{
+    const Vdu8 *p = (const Vdu8*)data;
+    VD_MEMSET(reader, 0, sizeof(*reader));
+
+    if (size < sizeof(VdLzFrameHeader))                        return VD_LZ_ERROR_TRUNCATED;
+    if (vd__lz_read_u32le(p) != VD_LZ_FRAME_MAGIC)             return VD_LZ_ERROR_BAD_MAGIC;
+    if (p[4] != VD_LZ_FRAME_VERSION)                           return VD_LZ_ERROR_BAD_VERSION;
+
+    reader->data         = p;
+    reader->size         = size;
+    reader->cursor       = sizeof(VdLzFrameHeader);
+    reader->block_size   = vd__lz_read_u32le(p + 8);
+    reader->content_size = (Vdu64)vd__lz_read_u32le(p + 16) | ((Vdu64)vd__lz_read_u32le(p + 20) << 32);
+    if (reader->block_size == 0 || reader->block_size >= VD_LZ_FRAME_BLOCK_STORED) return VD_LZ_ERROR_CORRUPT;
+    return VD_LZ_OK;
+}
+
+VD_API VdLzStatus vd_lz_frame_reader_next(VdLzFrameReader *reader, void *dst, Vdusize dst_cap, Vdusize *dst_len)
+{
+    if (dst_len) *dst_len = 0;
+    if (reader->done) return VD_LZ_END;
+
+    const Vdu8 *p    = reader->data + reader->cursor;
+    Vdusize    left  = reader->size - reader->cursor;
+    if (left < 4) return VD_LZ_ERROR_TRUNCATED;
+
+    Vdu32 header = vd__lz_read_u32le(p);
+    if (header == 0) {
+        reader->cursor += 4;
+        reader->done    = VD_TRUE;
+        return VD_LZ_END;
+    }
+
+    if (left < 8) return VD_LZ_ERROR_TRUNCATED;
+    Vdu32 payload = header & ~VD_LZ_FRAME_BLOCK_STORED;
+    Vdu32 raw     = vd__lz_read_u32le(p + 4);
+
+    if ((Vdusize)payload > left - 8)                             return VD_LZ_ERROR_TRUNCATED;
+    if ((raw == 0) || (raw > reader->block_size))                return VD_LZ_ERROR_CORRUPT;
+    if (raw > dst_cap)                                           return VD_LZ_ERROR_DST_TOO_SMALL;
+
+    if (header & VD_LZ_FRAME_BLOCK_STORED) {
+        if (payload != raw) return VD_LZ_ERROR_CORRUPT;
+        VD_MEMCPY(dst, p + 8, raw);
+    } else if (!vd_lz_decompress(p + 8, payload, dst, raw)) {
+        return VD_LZ_ERROR_CORRUPT;
+    }
+
+    reader->cursor += 8 + payload;
+    if (dst_len) *dst_len = raw;
+    return VD_LZ_OK;
+}
+
+VD_API VdLzStatus vd_lz_frame_decompress(const void *src, Vdusize src_len, void *dst, Vdusize dst_cap,
+                                         Vdusize *dst_len)
+{
+    VdLzFrameReader reader;
+    Vdusize         total  = 0;
+    VdLzStatus      status = vd_lz_frame_reader_init(&reader, src, src_len);
+    if (dst_len) *dst_len = 0;
+
+    while (status == VD_LZ_OK) {
+        Vdusize len = 0;
+        status = vd_lz_frame_reader_next(&reader, (Vdu8*)dst + total, dst_cap - total, &len);
+        total += len;
+    }
+
+    if (status != VD_LZ_END) return status;
+    if ((reader.content_size != VD_LZ_CONTENT_SIZE_UNKNOWN) && (reader.content_size != total)) {
+        return VD_LZ_ERROR_CORRUPT;
+    }
+
+    if (dst_len) *dst_len = total;
+    return VD_LZ_OK;
+}
+
+VD_API void *vd_lz_frame_decompress_arena(VdArena *a, const void *src, Vdusize src_len, Vdusize *dst_len)
+{
+    VdLzFrameReader reader;
+    if (vd_lz_frame_reader_init(&reader, src, src_len) != VD_LZ_OK) return 0;
+    if (reader.content_size == VD_LZ_CONTENT_SIZE_UNKNOWN)             return 0;
+    if (reader.content_size > (Vdu64)(a->buf_len - a->curr_offset))    return 0;
+
+    Vdusize     size   = (Vdusize)reader.content_size;
+    VdArenaSave save   = vd_arena_save(a);
+    void        *dst   = vd_arena_alloc(a, size ? size : 1);
+    if (dst == 0) return 0;
+
+    if (vd_lz_frame_decompress(src, src_len, dst, size, dst_len) != VD_LZ_OK) {
+        vd_arena_restore(save);
+        return 0;
+    }
+
+    return dst;
+}
+
+VD_API Vdcstr vd_lz_status_to_cstr(VdLzStatus status)
+{
+    switch (status) {
+        case VD_LZ_OK:                    return "OK";
+        case VD_LZ_END:                   return "End of frame";
+        case VD_LZ_ERROR_BAD_MAGIC:       return "Not an LZ frame";
+        case VD_LZ_ERROR_BAD_VERSION:     return "Unsupported LZ frame version";
+        case VD_LZ_ERROR_TRUNCATED:       return "LZ frame is truncated";
+        case VD_LZ_ERROR_CORRUPT:         return "LZ data is corrupt";
+        case VD_LZ_ERROR_DST_TOO_SMALL:   return "Destination is too small";
+        default:                          return "Unknown";
+    }
+}
+
+/* ----SCRATCH IMPL-------------------------------------------------------------------------------------------------- */
+void vd_scratch_init(VdScratch *scratch)
+{
+    for (Vdusize i = 0; i < VD_SCRATCH_PAGE_COUNT; ++i)
+    {
+        void *a = (void*)VD_MALLOC(VD_SCRATCH_PAGE_SIZE);
+        VD_MEMSET(a, 0, VD_SCRATCH_PAGE_SIZE);
+        vd_arena_init(&scratch->arenas[i], a, VD_SCRATCH_PAGE_SIZE);
+    }
+}
+
+VdArena *vd_scratch_get_arena(VdScratch *scratch)
+{
+    VD_ASSERT(scratch->curr_arena < VD_SCRATCH_PAGE_COUNT);
+    return &scratch->arenas[scratch->curr_arena++];
+}
+
+void vd_scratch_return_arena(VdScratch *scratch, VdArena *arena)
+{
+    VD_ASSERT(scratch->curr_arena > 0);
+    scratch->curr_arena--;
+    VD_ASSERT(&scratch->arenas[scratch->curr_arena] == arena);
+
+    VD_MEMSET(scratch->arenas[scratch->curr_arena].buf, 0, scratch->arenas[scratch->curr_arena].buf_len);
+    scratch->arenas[scratch->curr_arena].curr_offset = 0;
+    scratch->arenas[scratch->curr_arena].prev_offset = 0;
+}
+
+/* ----THREAD CONTEXT IMPL------------------------------------------------------------------------------------------- */
+VD_THREAD_CONTEXT_TYPE * VD_THREAD_CONTEXT_VARNAME;
+
+/* ----PARSING IMPL-------------------------------------------------------------------------------------------------- */
+Vdb32 vd_parse_u64(VdStr s, Vdu64 *r)
+{
+    Vdu64 result = 0;
+    Vdusize i = 0;
+    while (i < s.len && vd_is_ascii_digit(s.s[i])) {
+        result = result * 10 + (s.s[i] - '0');
+        i++;
+    } 
+
+    if (i != s.len) {
+        return VD_FALSE;
+    }
+
+    *r = result;
+
+    return VD_TRUE;
+}
+
+/* ----ARG IMPL------------------------------------------------------------------------------------------------------ */
+Vdb32 vd__arg_advance(VdArg *arg) {
+    if ((arg->argi + 1) == arg->argc) {
+        return VD_FALSE;
+    } else {
+        arg->argi++;
+        arg->ci = 0;
+        return VD_TRUE;
+    }
+}
+
+#define VD_ARG_CHECK_NEXT(arg) do {                      \
+        if (arg->ci != 0) {                              \
+            if (vd_arg_at_end(arg)) return VD_FALSE;   \
+            if (!vd__arg_advance(arg)) return VD_FALSE; \
+        }                                                \
+    } while(0)
+
+VdArg vd_arg_new(int argc, char **argv)
+{
+    VdArg result = {0};
+    result.argc = argc;
+    result.argv = argv;
+    return result;
+}
+
+void vd_arg_skip_program_name(VdArg *arg)
+{
+   arg->argi++;
+   arg->ci = 0;
+}
+
+Vdb32 vd_arg_at_end(VdArg *arg)
+{
+    return (arg->argi == arg->argc) ||
+           (arg->argi == (arg->argc - 1) &&
+            arg->argv[arg->argi][arg->ci] == 0);
+}
+
+void vd_arg_skip(VdArg *arg)
+{
+    arg->argi++;
+    arg->ci = 0;    
+}
+
+Vdb32 vd_arg_get_name(VdArg *arg, VdStr *name)
+{
+    VD_ARG_CHECK_NEXT(arg);
+
+    if (arg->argv[arg->argi][arg->ci] != '-') {
+        return VD_FALSE;
+    }
+
+    arg->ci = 1;
+
+    VdStr result;
+    result.s = &arg->argv[arg->argi][1];
+    result.len = 0;
+
+    while (arg->argv[arg->argi][arg->ci] != 0) {
+        arg->ci++;
+        result.len++;
+    }
+
+    if (result.len == 0) {
+        return VD_FALSE;
+    }
+
+    *name = result;
+
+    return VD_TRUE;
+}
+
+Vdb32 vd_arg_get_uint(VdArg *arg, Vdu64 *i) {
+    VD_UNUSED(i);
+    VD_TODO();
+
+    VD_ARG_CHECK_NEXT(arg);
+
+    return VD_FALSE;
+}
+
+Vdb32 vd_arg_get_str(VdArg *arg, VdStr *str) {
+    VD_ARG_CHECK_NEXT(arg);
+
+    VdStr result;
+    result.s = &arg->argv[arg->argi][0];
+    result.len = 0;
+
+    while (arg->argv[arg->argi][arg->ci] != 0) {
+        arg->ci++;
+        result.len++;
+    }
+
+    *str = result;
+    return VD_TRUE;
+}
+
+Vdb32 vd_arg_expect_char(VdArg *arg, char c);
+
+#undef VD_ARG_CHECK_NEXT
+
+/* ----STRMAP IMPL--------------------------------------------------------------------------------------------------- */
+static Vdb32 vd__strmap_check_key(VdStr check, Vd__StrmapBinPrefix *against) {
+    Vdu32 prefix_len       = sizeof(against->key_prefix);    
+    Vdu32 first_check_len  = prefix_len < (Vdu32)check.len ? prefix_len : (Vdu32)check.len;
+    Vdu32 second_check_len = (Vdu32)check.len - prefix_len;
+
+    if (against->key_len != check.len) {
+        return VD_FALSE;
+    }
+
+    if (VD_MEMCMP(against->key_prefix, check.s, first_check_len)) {
+        return VD_FALSE;
+    }
+
+    return check.len < prefix_len
+        ? VD_TRUE
+        : (VD_MEMCMP(against->key_rest, check.s + prefix_len, second_check_len) == 0);
+}
+
+static void vd__strmap_emplace_key(void *map, Vd__StrmapBinPrefix *dst, char *src_key_prefix, char *src_key_rest, Vdu32 src_key_len)
+{
+    Vdu32 prefix_len     = sizeof(dst->key_prefix);
+    Vdu32 first_copy_len = src_key_len > prefix_len ? prefix_len : src_key_len;
+
+    VD_MEMCPY(dst->key_prefix, src_key_prefix, first_copy_len);
+
+    Vdu32 new_len = src_key_len;
+
+    if (src_key_len > prefix_len) {
+        src_key_len -= prefix_len;
+
+        // If the source key's length after the prefix doesn't fit in the array allocated for key_rest
+        // Or if the key_rest_cap is zero because no key_rest has been allocated, then resize it
+        if (src_key_len > dst->key_rest_cap) {
+
+            // Allocate an arena big enough so that statistically, we won't have to ever care about
+            // this again
+            dst->key_rest = (char*)vd_arena_alloc(VD_STRMAP_ARENAP(map), src_key_len * 2);
+            dst->key_rest_cap = src_key_len * 2;
+        }
+
+        // Copy the rest of the key
+        VD_MEMCPY(dst->key_rest, src_key_rest, src_key_len);
+    }
+
+    dst->key_len = new_len;
+}
+
+static void vd__strmap_copy_key(void *map, VdStr key, Vd__StrmapBinPrefix *bin)
+{
+    char *key_prefix_part = key.s;
+    char *key_rest_part = key.len > sizeof(bin->key_prefix) ? key.s + sizeof(bin->key_prefix) : 0;
+    vd__strmap_emplace_key(map, bin, key_prefix_part, key_rest_part, (Vdu32)key.len);
+}
+
+void* vd__strmap_init(VdArena *arena, Vdu32 tsize, Vdu32 cap, VdStrmapInitOptions *options)
+{
+    Vd__StrmapHeader *map;
+    const Vdu32 bin_size = sizeof(Vd__StrmapBinPrefix) + tsize;
+
+    map = (Vd__StrmapHeader*)vd_arena_alloc(arena, sizeof(Vd__StrmapHeader) + bin_size * cap);
+
+    Vd__StrmapBinPrefix *bins = (Vd__StrmapBinPrefix*)(((Vdu8ptr)map) + sizeof(Vd__StrmapHeader));
+
+    float address_scale = 0.863f;
+    if (options != 0) address_scale = options->address_scale;
+
+    map->cap_total    = cap;
+    map->cap          = (Vdu32) (((Vdf32)cap) * address_scale);
+    map->taken        = 0;
+    map->tsize        = tsize;
+    map->arena        = arena;
+
+    if ((options != 0) && (options->average_key_len > sizeof(((Vd__StrmapBinPrefix*)0)->key_prefix))) {
+        for (Vdu32 i = 0; i < map->cap_total; ++i) {
+            bins[i].key_rest = (char*)vd_arena_alloc(arena, options->average_key_len);
+            VD_ASSERT(bins[i].key_rest);
+
+            bins[i].key_rest_cap = options->average_key_len;
+        }
+    }
+
+    return (void*)((Vdu8*)map + sizeof(Vd__StrmapHeader));
+}
+
+// @todo(mdodis): Speed this up if VD_ENABLE_SCRATCH_USE_IN_LIBRARY is enabled
+//                by using a simple queue to store re-inserted bins
+static void vd__strmap_reinsert_chain(void *map, Vd__StrmapBinPrefix *start)
+{
+    // Build the insertion queue
+    Vd__StrmapBinPrefix *bin = start;
+    Vd__StrmapBinPrefix *bin_next = start->next;
+    while (bin_next != 0) {
+        bin->insq = bin_next;
+
+        bin       = bin_next;
+        bin_next  = bin->next;
+    }
+
+    // Traverse the queue and for each item, set its bin to be unused, then re-add it
+    Vd__StrmapBinPrefix *q = start->insq;
+    bin = start;
+
+    start->insq = 0;
+
+    while (q != 0) {
+        q->used = VD_FALSE;
+        Vd__StrmapBinPrefix *nextq = q->insq;
+        q->insq = 0;
+
+        // Compose the key for q into a VdStr
+        Vdu64 key_hash;
+        {
+            Vdusize key_len = q->key_len;
+            VdArenaSave save = vd_arena_save(VD_STRMAP_ARENAP(map));
+
+            char *key = (char*)vd_arena_alloc(VD_STRMAP_ARENAP(map), key_len);
+
+            Vdusize first_copy_size  = key_len <= sizeof(q->key_prefix) ? key_len : sizeof(q->key_prefix);
+            Vdusize second_copy_size = key_len <= sizeof(q->key_prefix) ? 0 : key_len - sizeof(q->key_prefix);
+
+            VD_MEMCPY(key + 0, q->key_prefix, first_copy_size);
+
+            if (second_copy_size > 0) {
+                VD_MEMCPY(key + first_copy_size, q->key_rest, second_copy_size);
+            }
+
+            key_hash = vd_dhash64(key, key_len);
+
+            vd_arena_restore(save);
+        }
+
+        Vdusize bin_index = key_hash % VD_STRMAP_HEADER(map)->cap;
+
+        Vd__StrmapBinPrefix *existing_bin = VD_STRMAP_GET_BIN(map, bin_index);
+
+        // if the key for some reason hashes to the same place, then ignore it
+        if (existing_bin != q) {
+
+            if (!existing_bin->used) {
+                Vd__StrmapBinPrefix *new_bin = existing_bin;
+                void *sptr = VD_STRMAP_BIN_MOVE_TO_VPTR(q);
+                void *dptr = VD_STRMAP_BIN_MOVE_TO_VPTR(new_bin);
+
+                new_bin->used = VD_TRUE;
+                new_bin->next = 0;
+                // Copy key
+                vd__strmap_emplace_key(map, new_bin, q->key_prefix, q->key_rest, q->key_len);
+
+                // Copy over value
+                VD_MEMCPY(dptr, sptr, VD_STRMAP_TSIZE(map));
+            } else {
+                // Attempt to traverse the chain, if any
+                Vd__StrmapBinPrefix *chain_head = existing_bin;
+                while (chain_head->next == 0) {
+                    chain_head = chain_head->next;
+                }
+
+                Vdu32 cursor = VD_STRMAP_HEADER(map)->cap_total;
+                while ((cursor > 0) && (VD_STRMAP_GET_BIN(map, cursor - 1)->used)) {
+                    cursor--;
+                }
+
+                // After n iterations, if no bin was found we should be at a bin that's still used
+                // (i.e bin 0). In this case, return null.
+                if (cursor == 0) {
+                    VD_IMPOSSIBLE();
+                }
+
+                cursor--;
+                Vd__StrmapBinPrefix *new_bin = VD_STRMAP_GET_BIN(map, cursor);
+
+                // Allocate the bin
+                new_bin->used = VD_TRUE;
+                new_bin->next = 0;
+                chain_head->next = new_bin;
+
+                void *sptr = VD_STRMAP_BIN_MOVE_TO_VPTR(q);
+                void *dptr = VD_STRMAP_BIN_MOVE_TO_VPTR(new_bin);
+
+                // Copy key
+                vd__strmap_emplace_key(map, new_bin, q->key_prefix, q->key_rest, q->key_len);
+
+                // Copy over value
+                VD_MEMCPY(dptr, sptr, VD_STRMAP_TSIZE(map));
+            }
+        } else {
+            q->used = VD_TRUE;
+        }
+
+        q = nextq;
+    }
+}
+
+Vd__StrmapBinPrefix* vd__strmap_get_bin(void *map, VdStr key, Vd__StrmapGetBinFlags op)
+{
+    // Get hash
+    Vdu64 hash = vd_dhash64_str(key);
+    Vdu64 bin_index = hash % VD_STRMAP_HEADER(map)->cap;
+
+    // Find existing bin if any
+    Vd__StrmapBinPrefix *existing_bin = VD_STRMAP_GET_BIN(map, bin_index);
+
+    // If:
+    // (existing_bin->used == 0) AND
+    //      - We don't need to create a new bin then we want to search anyway since we'll do an early
+    //        return after this if statement
+    //      - We do need to create a new bin then we stop here, because we found it
+    //
+    // (existing_bin->used == 1) AND
+    //      - We don't need to create a new bin, then go inside this statement to see if we can find
+    //        the bin matching the query
+    //      - We do need to create a new bin, then go inside anyway because at the end (meaning if
+    //        we actually find a place to allocate the bin), we'll want to link the collided bin chain
+    //        to the newly allocated bin
+    if (existing_bin->used || !(op & VD__STRMAP_GET_BIN_FLAGS_CREATE)) {
+        Vdb32 found = VD_FALSE;
+
+        // Make sure that the hash didn't put us in a bin where the key is equal to the query key
+        if (vd__strmap_check_key(key, existing_bin)) {
+            found = VD_TRUE;
+        }
+
+        // If the bin isn't what we searched for, traverse the chain until the end to find it.
+        while (!found && (existing_bin->next != 0)) {
+            existing_bin = existing_bin->next;
+
+            if (vd__strmap_check_key(key, existing_bin)) {
+                found = VD_TRUE;
+                break;
+            }
+        }
+
+        if (found) {
+            if (op & VD__STRMAP_GET_BIN_FLAGS_SET_UNUSED) {
+                // if found is true the bin must be unused, set its flag and return
+                existing_bin->used = VD_FALSE;
+                VD_STRMAP_HEADER(map)->taken--;
+                vd__strmap_reinsert_chain(map, existing_bin);
+                return existing_bin;
+
+            } else if (op & VD__STRMAP_GET_BIN_FLAGS_GET_EXISTING) {
+                // If the user wants to create a new bin, overwrite existing one, or just get it, and found is true, 
+                // this means that the user queried with an existing key. Return the existing bin in thie case.
+                return existing_bin;
+            } else if (op & VD__STRMAP_GET_BIN_FLAGS_CREATE) {
+                // If the user wants to create a new bin, and found is true, this means that the user
+                // queried with the same key. Return null in this case.
+                return 0;
+            }
+        }
+    }
+
+    // At this point, no bin that matched our key was found so if the user doesn't want a new bin, then
+    // fail
+    if (!(op & VD__STRMAP_GET_BIN_FLAGS_CREATE)) {
+        return 0;
+    }
+
+    // If this bin is not used then allocate it
+    if (!existing_bin->used) {
+        vd__strmap_copy_key(map, key, existing_bin);
+        existing_bin->used = VD_TRUE;
+        existing_bin->next = 0;
+        VD_STRMAP_HEADER(map)->taken++;
+        return existing_bin;
+    }
+
+    // At this point, we handle a hash collision either for allocating a bin, or traversing the chain
+    // due to a previous collision
+
+    // Otherwise search starting from the cellar for an unused bin
+    Vdu32 cursor = VD_STRMAP_HEADER(map)->cap_total;
+    while ((cursor > 0) && (VD_STRMAP_GET_BIN(map, cursor - 1)->used)) {
+        cursor--;
+    }
+
+    // After n iterations, if no bin was found we should be at a bin that's still used
+    // (i.e bin 0). In this case, return null.
+    if (cursor == 0) {
+        return 0;
+    }
+
+    cursor--;
+    Vd__StrmapBinPrefix *new_bin = VD_STRMAP_GET_BIN(map, cursor);
+
+    // Allocate the bin
+    new_bin->used = VD_TRUE;
+    new_bin->next = 0;
+
+    VD_STRMAP_HEADER(map)->taken++;
+
+    // Mark bin as next. At this point, the previous search through the chain means that existing_bin
+    // is now at the end of the chain 
+    existing_bin->next = new_bin;
+
+    // Copy new key and return
+    vd__strmap_copy_key(map, key, new_bin);
+    return new_bin;
+}
+
+/* ----KVMAP IMPL---------------------------------------------------------------------------------------------------- */
+static Vdb32 vd__kvmap_check_key(Vdusize ksize, void *check, Vd__KVMapBinPrefix *against)
+{
+    void *key_against = (void *)(((Vdu8ptr)against) + sizeof(Vd__KVMapBinPrefix));
+    return VD_MEMCMP(check, key_against, ksize) == 0;
+}
+
+static void vd__kvmap_copy_key(void *map, void *key, Vd__KVMapBinPrefix *bin)
+{
+    void *dst = (void *)(((Vdu8ptr)bin) + sizeof(Vd__KVMapBinPrefix));
+    VD_MEMCPY(dst, key, VD_KVMAP_KSIZE(map));
+}
+
+// @todo(mdodis): Speed this up if VD_ENABLE_SCRATCH_USE_IN_LIBRARY is enabled
+//                by using a simple queue to store re-inserted bins
+static void vd__kvmap_reinsert_chain(void *map, Vd__KVMapBinPrefix *start)
+{
+    // Build the insertion queue
+    Vd__KVMapBinPrefix *bin = start;
+    Vd__KVMapBinPrefix *bin_next = start->next;
+    while (bin_next != 0) {
+        bin->insq = bin_next;
+
+        bin       = bin_next;
+        bin_next  = bin->next;
+    }
+
+    // Traverse the queue and for each item, set its bin to be unused, then re-add it
+    Vd__KVMapBinPrefix *q = start->insq;
+    bin = start;
+
+    start->insq = 0;
+
+    while (q != 0) {
+        q->used = VD_FALSE;
+        Vd__KVMapBinPrefix *nextq = q->insq;
+        q->insq = 0;
+
+        // Compose the key for q into a VdStr
+        Vdu64 key_hash;
+        {
+            void *k = (void *)(((Vdu8ptr)q) + sizeof(Vd__KVMapBinPrefix));
+            key_hash = vd_dhash64(k, VD_KVMAP_KSIZE(map));
+        }
+
+        Vdusize bin_index = key_hash % VD_KVMAP_HEADER(map)->cap;
+
+        Vd__KVMapBinPrefix *existing_bin = VD_KVMAP_GET_BIN(map, bin_index);
+
+        // if the key for some reason hashes to the same place, then ignore it
+        if (existing_bin != q) {
+
+            if (!existing_bin->used) {
+                Vd__KVMapBinPrefix *new_bin = existing_bin;
+                void *sptr = VD_KVMAP_BIN_MOVE_TO_VPTR(map, q);
+                void *dptr = VD_KVMAP_BIN_MOVE_TO_VPTR(map, new_bin);
+
+                new_bin->used = VD_TRUE;
+                new_bin->next = 0;
+
+                // Copy key
+                vd__kvmap_copy_key(map, VD_KVMAP_BIN_MOVE_TO_KPTR(q), new_bin);
+
+                // Copy over value
+                VD_MEMCPY(dptr, sptr, VD_KVMAP_VSIZE(map));
+            } else {
+                // Attempt to traverse the chain, if any
+                Vd__KVMapBinPrefix *chain_head = existing_bin;
+                while (chain_head->next == 0) {
+                    chain_head = chain_head->next;
+                }
+
+                Vdu32 cursor = VD_KVMAP_HEADER(map)->cap_total;
+                while ((cursor > 0) && (VD_KVMAP_GET_BIN(map, cursor - 1)->used)) {
+                    cursor--;
+                }
+
+                // After n iterations, if no bin was found we should be at a bin that's still used
+                // (i.e bin 0). In this case, return null.
+                if (cursor == 0) {
+                    VD_IMPOSSIBLE();
+                }
+
+                cursor--;
+                Vd__KVMapBinPrefix *new_bin = VD_KVMAP_GET_BIN(map, cursor);
+
+                // Allocate the bin
+                new_bin->used = VD_TRUE;
+                new_bin->next = 0;
+                chain_head->next = new_bin;
+
+                void *sptr = VD_KVMAP_BIN_MOVE_TO_VPTR(map, q);
+                void *dptr = VD_KVMAP_BIN_MOVE_TO_VPTR(map, new_bin);
+
+                // Copy key
+                vd__kvmap_copy_key(map, VD_KVMAP_BIN_MOVE_TO_KPTR(q), new_bin);
+
+                // Copy over value
+                VD_MEMCPY(dptr, sptr, VD_KVMAP_VSIZE(map));
+            }
+        } else {
+            q->used = VD_TRUE;
+        }
+
+        q = nextq;
+    }
+}
+void *vd__kvmap_init(VdArena *arena, Vdu32 ksize, Vdu32 vsize, Vdu32 cap, VdKVMapInitOptions *options)
+{
+    Vd__KVMapHeader *map;
+    const Vdu32 bin_size = sizeof(Vd__KVMapBinPrefix) + ksize + vsize;    
+
+    map = (Vd__KVMapHeader*)vd_arena_alloc(arena, sizeof(Vd__KVMapHeader) + bin_size * cap);
+    float address_scale = 0.863f;
+    if (options != 0) address_scale = options->address_scale;
+
+    map->cap_total    = cap;
+    map->cap          = (Vdu32) (((Vdf32)cap) * address_scale);
+    map->taken        = 0;
+    map->ksize        = ksize;
+    map->vsize        = vsize;
+
+    return (void*)(((Vdu8*)map) + sizeof(Vd__KVMapHeader));
+}
+
+Vd__KVMapBinPrefix *vd__kvmap_get_bin(void *map, void *key, Vd__KVMapGetBinFlags op)
+{
+    // Get hash
+    Vdu64 hash = vd_dhash64(key, VD_KVMAP_KSIZE(map));
+    Vdu64 bin_index = hash % VD_KVMAP_HEADER(map)->cap;
+
+    // Find existing bin if any
+    Vd__KVMapBinPrefix *existing_bin = VD_KVMAP_GET_BIN(map, bin_index);
+
+    // If:
+    // (existing_bin->used == 0) AND
+    //      - We don't need to create a new bin then we want to search anyway since we'll do an early
+    //        return after this if statement
+    //      - We do need to create a new bin then we stop here, because we found it
+    //
+    // (existing_bin->used == 1) AND
+    //      - We don't need to create a new bin, then go inside this statement to see if we can find
+    //        the bin matching the query
+    //      - We do need to create a new bin, then go inside anyway because at the end (meaning if
+    //        we actually find a place to allocate the bin), we'll want to link the collided bin chain
+    //        to the newly allocated bin
+    if (existing_bin->used || !(op & VD__KVMAP_GET_BIN_FLAGS_CREATE)) {
+        Vdb32 found = VD_FALSE;
+
+        // Make sure that the hash didn't put us in a bin where the key is equal to the query key
+        if (vd__kvmap_check_key(VD_KVMAP_KSIZE(map), key, existing_bin)) {
+            found = VD_TRUE;
+        }
+
+        // If the bin isn't what we searched for, traverse the chain until the end to find it.
+        while (!found && (existing_bin->next != 0)) {
+            existing_bin = existing_bin->next;
+
+            if (vd__kvmap_check_key(VD_KVMAP_KSIZE(map), key, existing_bin)) {
+                found = VD_TRUE;
+                break;
+            }
+        }
+
+        if (found) {
+            if (op & VD__KVMAP_GET_BIN_FLAGS_SET_UNUSED) {
+                // if found is true the bin must be unused, set its flag and return
+                existing_bin->used = VD_FALSE;
+                VD_KVMAP_HEADER(map)->taken--;
+                vd__kvmap_reinsert_chain(map, existing_bin);
+                return existing_bin;
+
+            } else if (op & VD__KVMAP_GET_BIN_FLAGS_GET_EXISTING) {
+                // If the user wants to create a new bin, overwrite existing one, or just get it, and found is true, 
+                // this means that the user queried with an existing key. Return the existing bin in thie case.
+                return existing_bin;
+            } else if (op & VD__KVMAP_GET_BIN_FLAGS_CREATE) {
+                // If the user wants to create a new bin, and found is true, this means that the user
+                // queried with the same key. Return null in this case.
+                return 0;
+            }
+        }
+    }
+
+    // At this point, no bin that matched our key was found so if the user doesn't want a new bin, then
+    // fail
+    if (!(op & VD__KVMAP_GET_BIN_FLAGS_CREATE)) {
+        return 0;
+    }
+
+    // If this bin is not used then allocate it
+    if (!existing_bin->used) {
+        vd__kvmap_copy_key(map, key, existing_bin);
+        existing_bin->used = VD_TRUE;
+        existing_bin->next = 0;
+        VD_KVMAP_HEADER(map)->taken++;
+        return existing_bin;
+    }
+
+    // At this point, we handle a hash collision either for allocating a bin, or traversing the chain
+    // due to a previous collision
+
+    // Otherwise search starting from the cellar for an unused bin
+    Vdu32 cursor = VD_KVMAP_HEADER(map)->cap_total;
+    while ((cursor > 0) && (VD_KVMAP_GET_BIN(map, cursor - 1)->used)) {
+        cursor--;
+    }
+
+    // After n iterations, if no bin was found we should be at a bin that's still used
+    // (i.e bin 0). In this case, return null.
+    if (cursor == 0) {
+        return 0;
+    }
+
+    cursor--;
+    Vd__KVMapBinPrefix *new_bin = VD_KVMAP_GET_BIN(map, cursor);
+
+    // Allocate the bin
+    new_bin->used = VD_TRUE;
+    new_bin->next = 0;
+
+    VD_KVMAP_HEADER(map)->taken++;
+
+    // Mark bin as next. At this point, the previous search through the chain means that existing_bin
+    // is now at the end of the chain 
+    existing_bin->next = new_bin;
+
+    // Copy new key and return
+    vd__kvmap_copy_key(map, key, new_bin);
+    return new_bin;
+}
+
+/* ----BTREE IMPL---------------------------------------------------------------------------------------------------- */
+#if defined(__SSE4_2__)
+#include <nmmintrin.h>
+#endif // defined(__SSE4_2__)
+
+typedef struct {
+    Vdu64 prefix;
+    VdStr str;
+} Vd__BTreeKey;
+
+typedef struct {
+    VdBTreeInner *node;
+    Vdu32        index;
+} Vd__BTreePathEntry;
+
+// The number of keys less than key. Slots past count hold VD_U64_MAX, which is never less than anything, so all
+// VD_BTREE_ORDER slots are compared without branching on count.
+static VD_INLINE Vdu32 vd__btree_count_less(const Vdu64 *keys, Vdu64 key)
+{
+#if defined(__SSE4_2__)
+    // Unsigned compare through the signed one by flipping the top bit
+    __m128i bias = _mm_set1_epi64x((long long)0x8000000000000000ull);
+    __m128i k    = _mm_xor_si128(_mm_set1_epi64x((long long)key), bias);
+    __m128i acc  = _mm_setzero_si128();
+    for (int i = 0; i < VD_BTREE_ORDER; i += 2) {
+        __m128i a = _mm_xor_si128(_mm_load_si128((const __m128i*)(keys + i)), bias);
+        acc = _mm_sub_epi64(acc, _mm_cmpgt_epi64(k, a));
+    }
+    return (Vdu32)(_mm_cvtsi128_si64(acc) + _mm_cvtsi128_si64(_mm_unpackhi_epi64(acc, acc)));
+#elif VD_SIMD_NEON && (defined(__aarch64__) || defined(_M_ARM64))
+    uint64x2_t k   = vdupq_n_u64(key);
+    uint64x2_t acc = vdupq_n_u64(0);
+    for (int i = 0; i < VD_BTREE_ORDER; i += 2) {
+        acc = vsubq_u64(acc, vcltq_u64(vld1q_u64(keys + i), k));
+    }
+    return (Vdu32)vaddvq_u64(acc);
+#elif VD_SIMD_SSE2
+    // No 64-bit compare: compare 32-bit halves (biased to unsigned) and combine hi < || (hi == && lo <)
+    __m128i bias = _mm_set1_epi32((int)0x80000000u);
+    __m128i k    = _mm_xor_si128(_mm_set1_epi64x((long long)key), bias);
+    __m128i acc  = _mm_setzero_si128();
+    for (int i = 0; i < VD_BTREE_ORDER; i += 2) {
+        __m128i a  = _mm_xor_si128(_mm_load_si128((const __m128i*)(keys + i)), bias);
+        __m128i gt = _mm_cmpgt_epi32(k, a);
+        __m128i eq = _mm_cmpeq_epi32(k, a);
+        __m128i lt = _mm_or_si128(_mm_shuffle_epi32(gt, _MM_SHUFFLE(3, 3, 1, 1)),
+                                  _mm_and_si128(_mm_shuffle_epi32(eq, _MM_SHUFFLE(3, 3, 1, 1)),
+                                                _mm_shuffle_epi32(gt, _MM_SHUFFLE(2, 2, 0, 0))));
+        acc = _mm_sub_epi64(acc, lt);
+    }
+    return (Vdu32)(_mm_cvtsi128_si32(acc) + _mm_cvtsi128_si32(_mm_unpackhi_epi64(acc, acc)));
+#else
+    Vdu32 result = 0;
+    for (int i = 0; i < VD_BTREE_ORDER; ++i) result += keys[i] < key;
+    return result;
+#endif // defined(__SSE4_2__), VD_SIMD_NEON && aarch64, VD_SIMD_SSE2, else
+}
+
+static Vd__BTreeKey vd__btree_key_u64(Vdu64 key)
+{
+    Vd__BTreeKey result;
+    result.prefix = key;
+    result.str    = vd_str_null();
+    return result;
+}
+
+static Vd__BTreeKey vd__btree_key_str(VdStr key)
+{
+    Vdu8 bytes[8] = {0};
+    VD_MEMCPY(bytes, key.s, key.len < 8 ? key.len : 8);
+
+    Vd__BTreeKey result;
+    result.prefix = 0;
+    for (int i = 0; i < 8; ++i) result.prefix = (result.prefix << 8) | bytes[i];
+    result.str = key;
+    return result;
+}
+
+// First index whose key is >= key (or > key with upper). Prefix ties in string trees are settled with full compares.
+static VD_INLINE Vdu32 vd__btree_search(VdBTree *tree, VdBTreeNode *node, Vd__BTreeKey *key, Vdb32 upper)
+{
+    Vdu32 i = vd__btree_count_less(node->keys, key->prefix);
+    if (tree->kind == VD_BTREE_KEY_U64) {
+        return i + (upper && (i < node->count) && (node->keys[i] == key->prefix));
+    }
+
+    while ((i < node->count) && (node->keys[i] == key->prefix)) {
+        int c = vd_str_compare(node->strs[i], key->str);
+        if ((c > 0) || ((c == 0) && !upper)) break;
+        i++;
+    }
+    return i;
+}
+
+static Vdb32 vd__btree_key_eq(VdBTree *tree, VdBTreeNode *node, Vdu32 i, Vd__BTreeKey *key)
+{
+    if ((i >= node->count) || (node->keys[i] != key->prefix)) return VD_FALSE;
+    return (tree->kind == VD_BTREE_KEY_U64) || vd_str_eq(node->strs[i], key->str);
+}
+
+static VdBTreeNode *vd__btree_new_node(VdBTree *tree, Vdb32 leaf)
+{
+    Vdusize size = leaf ? sizeof(VdBTreeLeaf) : sizeof(VdBTreeInner);
+    VdBTreeNode *node = (VdBTreeNode*)vd_arena_alloc_align(tree->arena, size, 64);
+    for (int i = 0; i < VD_BTREE_ORDER; ++i) node->keys[i] = VD_U64_MAX;
+    node->is_leaf = leaf;
+    if (tree->kind == VD_BTREE_KEY_STR) {
+        node->strs = (VdStr*)vd_arena_alloc(tree->arena, sizeof(VdStr) * VD_BTREE_ORDER);
+    }
+    return node;
+}
+
+static VdBTreeLeaf *vd__btree_find_leaf(VdBTree *tree, Vd__BTreeKey *key, Vd__BTreePathEntry *path)
+{
+    VdBTreeNode *node = tree->root;
+    for (Vdu32 depth = 0; depth < tree->height; ++depth) {
+        VdBTreeInner *inner = (VdBTreeInner*)node;
+        Vdu32 index = vd__btree_search(tree, node, key, VD_TRUE);
+        if (path) {
+            path[depth].node  = inner;
+            path[depth].index = index;
+        }
+        node = inner->children[index];
+    }
+    return (VdBTreeLeaf*)node;
+}
+
+static void vd__btree_node_set_key(VdBTree *tree, VdBTreeNode *node, Vdu32 i, Vd__BTreeKey *key)
+{
+    node->keys[i] = key->prefix;
+    if (tree->kind == VD_BTREE_KEY_STR) node->strs[i] = key->str;
+}
+
+static Vd__BTreeKey vd__btree_node_get_key(VdBTree *tree, VdBTreeNode *node, Vdu32 i)
+{
+    Vd__BTreeKey result;
+    result.prefix = node->keys[i];
+    result.str    = (tree->kind == VD_BTREE_KEY_STR) ? node->strs[i] : vd_str_null();
+    return result;
+}
+
+// Opens a gap at i in the keys of node. The caller shifts values or children and bumps count.
+static void vd__btree_node_open_gap(VdBTree *tree, VdBTreeNode *node, Vdu32 i)
+{
+    VD_MEMMOVE(node->keys + i + 1, node->keys + i, sizeof(Vdu64) * (node->count - i));
+    if (tree->kind == VD_BTREE_KEY_STR) {
+        VD_MEMMOVE(node->strs + i + 1, node->strs + i, sizeof(VdStr) * (node->count - i));
+    }
+}
+
+static void vd__btree_leaf_insert(VdBTree *tree, VdBTreeLeaf *leaf, Vdu32 i, Vd__BTreeKey *key, Vdu64 value)
+{
+    vd__btree_node_open_gap(tree, &leaf->node, i);
+    VD_MEMMOVE(leaf->values + i + 1, leaf->values + i, sizeof(Vdu64) * (leaf->node.count - i));
+    vd__btree_node_set_key(tree, &leaf->node, i, key);
+    leaf->values[i] = value;
+    leaf->node.count++;
+}
+
+static Vdb32 vd__btree_set(VdBTree *tree, Vd__BTreeKey key, Vdu64 value)
+{
+    Vd__BTreePathEntry path[VD_BTREE_MAX_HEIGHT];
+    VdBTreeLeaf *leaf = vd__btree_find_leaf(tree, &key, path);
+    Vdu32 pos = vd__btree_search(tree, &leaf->node, &key, VD_FALSE);
+
+    if (vd__btree_key_eq(tree, &leaf->node, pos, &key)) {
+        leaf->values[pos] = value;
+        return VD_FALSE;
+    }
+
+    if (tree->kind == VD_BTREE_KEY_STR) key.str = vd_str_dup(tree->arena, key.str);
+    tree->count++;
+
+    if (leaf->node.count < VD_BTREE_ORDER) {
+        vd__btree_leaf_insert(tree, leaf, pos, &key, value);
+        return VD_TRUE;
+    }
+
+    // Split the leaf in half, then put the new entry in whichever half it belongs to
+    VdBTreeLeaf *right = (VdBTreeLeaf*)vd__btree_new_node(tree, VD_TRUE);
+    Vdu32 half = VD_BTREE_ORDER / 2;
+    Vdu32 moved = VD_BTREE_ORDER - half;
+    VD_MEMCPY(right->node.keys, leaf->node.keys + half, sizeof(Vdu64) * moved);
+    VD_MEMCPY(right->values, leaf->values + half, sizeof(Vdu64) * moved);
+    if (tree->kind == VD_BTREE_KEY_STR) VD_MEMCPY(right->node.strs, leaf->node.strs + half, sizeof(VdStr) * moved);
+    for (Vdu32 i = half; i < VD_BTREE_ORDER; ++i) leaf->node.keys[i] = VD_U64_MAX;
+    right->node.count = moved;
+    leaf->node.count  = half;
+    right->next = leaf->next;
+    leaf->next  = right;
+
+    if (pos <= half) vd__btree_leaf_insert(tree, leaf, pos, &key, value);
+    else             vd__btree_leaf_insert(tree, right, pos - half, &key, value);
+
+    // Push the separator up, splitting full inner nodes on the way
+    Vd__BTreeKey sep       = vd__btree_node_get_key(tree, &right->node, 0);
+    VdBTreeNode  *new_node = &right->node;
+    for (Vdu32 d = tree->height; d-- > 0;) {
+        VdBTreeInner *inner = path[d].node;
+        Vdu32        index  = path[d].index;
+
+        if (inner->node.count < VD_BTREE_ORDER) {
+            vd__btree_node_open_gap(tree, &inner->node, index);
+            VD_MEMMOVE(inner->children + index + 2, inner->children + index + 1,
+                       sizeof(VdBTreeNode*) * (inner->node.count - index));
+            vd__btree_node_set_key(tree, &inner->node, index, &sep);
+            inner->children[index + 1] = new_node;
+            inner->node.count++;
+            return VD_TRUE;
+        }
+
+        Vd__BTreeKey keys[VD_BTREE_ORDER + 1];
+        VdBTreeNode  *children[VD_BTREE_ORDER + 2];
+        for (Vdu32 i = 0, j = 0; i < VD_BTREE_ORDER + 1; ++i) {
+            keys[i] = (i == index) ? sep : vd__btree_node_get_key(tree, &inner->node, j++);
+        }
+        for (Vdu32 i = 0, j = 0; i < VD_BTREE_ORDER + 2; ++i) {
+            children[i] = (i == index + 1) ? new_node : inner->children[j++];
+        }
+
+        Vdu32 total = VD_BTREE_ORDER + 1;
+        Vdu32 mid   = total / 2;
+        VdBTreeInner *split = (VdBTreeInner*)vd__btree_new_node(tree, VD_FALSE);
+
+        for (Vdu32 i = 0; i < VD_BTREE_ORDER; ++i) inner->node.keys[i] = VD_U64_MAX;
+        for (Vdu32 i = 0; i < mid; ++i) vd__btree_node_set_key(tree, &inner->node, i, &keys[i]);
+        for (Vdu32 i = 0; i <= mid; ++i) inner->children[i] = children[i];
+        inner->node.count = mid;
+
+        for (Vdu32 i = mid + 1; i < total; ++i) vd__btree_node_set_key(tree, &split->node, i - mid - 1, &keys[i]);
+        for (Vdu32 i = mid + 1; i <= total; ++i) split->children[i - mid - 1] = children[i];
+        split->node.count = total - mid - 1;
+
+        sep      = keys[mid];
+        new_node = &split->node;
+    }
+
+    VD_ASSERT(tree->height < VD_BTREE_MAX_HEIGHT);
+    VdBTreeInner *root = (VdBTreeInner*)vd__btree_new_node(tree, VD_FALSE);
+    vd__btree_node_set_key(tree, &root->node, 0, &sep);
+    root->children[0] = tree->root;
+    root->children[1] = new_node;
+    root->node.count  = 1;
+    tree->root = &root->node;
+    tree->height++;
+    return VD_TRUE;
+}
+
+static Vdb32 vd__btree_get(VdBTree *tree, Vd__BTreeKey key, Vdu64 *value)
+{
+    VdBTreeLeaf *leaf = vd__btree_find_leaf(tree, &key, 0);
+    Vdu32 pos = vd__btree_search(tree, &leaf->node, &key, VD_FALSE);
+    if (!vd__btree_key_eq(tree, &leaf->node, pos, &key)) return VD_FALSE;
+    if (value) *value = leaf->values[pos];
+    return VD_TRUE;
+}
+
+static Vdb32 vd__btree_remove(VdBTree *tree, Vd__BTreeKey key)
+{
+    VdBTreeLeaf *leaf = vd__btree_find_leaf(tree, &key, 0);
+    VdBTreeNode *node = &leaf->node;
+    Vdu32 pos = vd__btree_search(tree, node, &key, VD_FALSE);
+    if (!vd__btree_key_eq(tree, node, pos, &key)) return VD_FALSE;
+
+    Vdu32 after = node->count - pos - 1;
+    VD_MEMMOVE(node->keys + pos, node->keys + pos + 1, sizeof(Vdu64) * after);
+    VD_MEMMOVE(leaf->values + pos, leaf->values + pos + 1, sizeof(Vdu64) * after);
+    if (tree->kind == VD_BTREE_KEY_STR) VD_MEMMOVE(node->strs + pos, node->strs + pos + 1, sizeof(VdStr) * after);
+    node->count--;
+    node->keys[node->count] = VD_U64_MAX;
+    tree->count--;
+    return VD_TRUE;
+}
+
+static VdBTreeIter vd__btree_lower_bound(VdBTree *tree, Vd__BTreeKey key)
+{
+    VdBTreeIter it;
+    it.leaf  = vd__btree_find_leaf(tree, &key, 0);
+    it.index = vd__btree_search(tree, &it.leaf->node, &key, VD_FALSE);
+    if (it.index >= it.leaf->node.count) {
+        it.index = 0;
+        do {
+            it.leaf = it.leaf->next;
+        } while (it.leaf && (it.leaf->node.count == 0));
+    }
+    return it;
+}
+
+static void vd__btree_build(VdBTree *tree, const Vdu64 *ukeys, const VdStr *skeys, const Vdu64 *values, Vdusize count)
+{
+    tree->count  = count;
+    tree->height = 0;
+
+    Vdusize num_leaves = (count + VD_BTREE_ORDER - 1) / VD_BTREE_ORDER;
+    if (num_leaves == 0) {
+        tree->root  = vd__btree_new_node(tree, VD_TRUE);
+        tree->first = (VdBTreeLeaf*)tree->root;
+        return;
+    }
+
+    // Each level as an array of nodes and the smallest key under each, replaced by the level above until one is left
+    VdBTreeNode  **nodes = (VdBTreeNode**)VD_MALLOC(sizeof(VdBTreeNode*) * num_leaves);
+    Vd__BTreeKey *mins   = (Vd__BTreeKey*)VD_MALLOC(sizeof(Vd__BTreeKey) * num_leaves);
+
+    // Spread the entries evenly, so the last leaf isn't left with a handful
+    Vdusize      at   = 0;
+    VdBTreeLeaf *prev = 0;
+    for (Vdusize l = 0; l < num_leaves; ++l) {
+        Vdu32 n = (Vdu32)(count / num_leaves + (l < count % num_leaves));
+        VdBTreeLeaf *leaf = (VdBTreeLeaf*)vd__btree_new_node(tree, VD_TRUE);
+        for (Vdu32 i = 0; i < n; ++i, ++at) {
+            Vd__BTreeKey key = ukeys ? vd__btree_key_u64(ukeys[at]) : vd__btree_key_str(skeys[at]);
+            vd__btree_node_set_key(tree, &leaf->node, i, &key);
+            leaf->values[i] = values ? values[at] : (Vdu64)at;
+        }
+        leaf->node.count = n;
+
+        if (prev) prev->next = leaf;
+        else      tree->first = leaf;
+        prev = leaf;
+        nodes[l] = &leaf->node;
+        mins[l]  = vd__btree_node_get_key(tree, &leaf->node, 0);
+    }
+
+    Vdusize level_count = num_leaves;
+    while (level_count > 1) {
+        VD_ASSERT(tree->height < VD_BTREE_MAX_HEIGHT);
+        Vdusize num_parents = (level_count + VD_BTREE_ORDER) / (VD_BTREE_ORDER + 1);
+        Vdusize child = 0;
+        for (Vdusize p = 0; p < num_parents; ++p) {
+            Vdu32 n = (Vdu32)(level_count / num_parents + (p < level_count % num_parents));
+            VdBTreeInner *inner = (VdBTreeInner*)vd__btree_new_node(tree, VD_FALSE);
+            Vd__BTreeKey min = mins[child];
+            for (Vdu32 i = 0; i < n; ++i, ++child) {
+                inner->children[i] = nodes[child];
+                if (i > 0) vd__btree_node_set_key(tree, &inner->node, i - 1, &mins[child]);
+            }
+            inner->node.count = n - 1;
+            nodes[p] = &inner->node;
+            mins[p]  = min;
+        }
+        level_count = num_parents;
+        tree->height++;
+    }
+
+    tree->root = nodes[0];
+    VD_FREE(nodes, sizeof(VdBTreeNode*) * num_leaves);
+    VD_FREE(mins, sizeof(Vd__BTreeKey) * num_leaves);
+}
+
+VD_API void vd_btree_init(VdBTree *tree, VdArena *arena, VdBTreeKeyKind kind)
+{
+    VD_MEMSET(tree, 0, sizeof(*tree));
+    tree->arena = arena;
+    tree->kind  = kind;
+    tree->root  = vd__btree_new_node(tree, VD_TRUE);
+    tree->first = (VdBTreeLeaf*)tree->root;
+}
+
+VD_API Vdb32 vd_btree_set_u64(VdBTree *tree, Vdu64 key, Vdu64 value)
+{
+    VD_ASSERT(tree->kind == VD_BTREE_KEY_U64);
+    return vd__btree_set(tree, vd__btree_key_u64(key), value);
+}
+
+VD_API Vdb32 vd_btree_get_u64(VdBTree *tree, Vdu64 key, Vdu64 *value)
+{
+    VD_ASSERT(tree->kind == VD_BTREE_KEY_U64);
+    return vd__btree_get(tree, vd__btree_key_u64(key), value);
+}
+
+VD_API Vdb32 vd_btree_remove_u64(VdBTree *tree, Vdu64 key)
+{
+    VD_ASSERT(tree->kind == VD_BTREE_KEY_U64);
+    return vd__btree_remove(tree, vd__btree_key_u64(key));
+}
+
+VD_API VdBTreeIter vd_btree_lower_bound_u64(VdBTree *tree, Vdu64 key)
+{
+    VD_ASSERT(tree->kind == VD_BTREE_KEY_U64);
+    return vd__btree_lower_bound(tree, vd__btree_key_u64(key));
+}
+
+VD_API Vdb32 vd_btree_set_str(VdBTree *tree, VdStr key, Vdu64 value)
+{
+    VD_ASSERT(tree->kind == VD_BTREE_KEY_STR);
+    return vd__btree_set(tree, vd__btree_key_str(key), value);
+}
+
+VD_API Vdb32 vd_btree_get_str(VdBTree *tree, VdStr key, Vdu64 *value)
+{
+    VD_ASSERT(tree->kind == VD_BTREE_KEY_STR);
+    return vd__btree_get(tree, vd__btree_key_str(key), value);
+}
+
+VD_API Vdb32 vd_btree_remove_str(VdBTree *tree, VdStr key)
+{
+    VD_ASSERT(tree->kind == VD_BTREE_KEY_STR);
+    return vd__btree_remove(tree, vd__btree_key_str(key));
+}
+
+VD_API VdBTreeIter vd_btree_lower_bound_str(VdBTree *tree, VdStr key)
+{
+    VD_ASSERT(tree->kind == VD_BTREE_KEY_STR);
+    return vd__btree_lower_bound(tree, vd__btree_key_str(key));
+}
+
+VD_API void vd_btree_build_u64(VdBTree *tree, const Vdu64 *keys, const Vdu64 *values, Vdusize count)
+{
+    VD_ASSERT(tree->kind == VD_BTREE_KEY_U64);
+    for (Vdusize i = 1; i < count; ++i) VD_ASSERT(keys[i - 1] < keys[i]);
+    vd__btree_build(tree, keys, 0, values, count);
+}
+
+VD_API void vd_btree_build_str(VdBTree *tree, const VdStr *keys, const Vdu64 *values, Vdusize count)
+{
+    VD_ASSERT(tree->kind == VD_BTREE_KEY_STR);
+    for (Vdusize i = 1; i < count; ++i) VD_ASSERT(vd_str_compare(keys[i - 1], keys[i]) < 0);
+    vd__btree_build(tree, 0, keys, values, count);
+}
+
+/* ----ART IMPL------------------------------------------------------------------------------------------------------ */
+typedef enum {
+    VD__ART_LEAF = 0,
+    VD__ART_NODE4,
+    VD__ART_NODE16,
+    VD__ART_NODE48,
+    VD__ART_NODE256,
+} Vd__ArtType;
+
+typedef struct Vd__ArtLeaf {
+    Vdu8  type;
+    Vdu64 value;
+    VdStr key;
+} Vd__ArtLeaf;
+
+typedef struct {
+    Vdu8        type;
+    Vdu16       count;
+    /** Bytes every key below shares after the parent's branch byte. Points into one of those keys. */
+    Vdu32       prefix_len;
+    const Vdu8  *prefix;
+    /** The key that ends right after the prefix, if any. */
+    Vd__ArtLeaf *leaf;
+} Vd__ArtNode;
+
+typedef struct {
+    Vd__ArtNode node;
+    Vdu8        keys[4];
+    void        *children[4];
+} Vd__ArtNode4;
+
+typedef struct {
+    Vd__ArtNode node;
+    Vdu8        keys[16];
+    void        *children[16];
+} Vd__ArtNode16;
+
+typedef struct {
+    Vd__ArtNode node;
+    /** Child slot + 1 for every byte, 0 if there's no child. */
+    Vdu8        index[256];
+    void        *children[48];
+} Vd__ArtNode48;
+
+typedef struct {
+    Vd__ArtNode node;
+    void        *children[256];
+} Vd__ArtNode256;
+
+static VD_INLINE Vdb32 vd__art_is_leaf(void *p) { return *(Vdu8*)p == VD__ART_LEAF; }
+
+static Vdusize vd__art_mismatch(const Vdu8 *a, const Vdu8 *b, Vdusize len)
+{
+    Vdusize i = 0;
+    for (; i + 8 <= len; i += 8) {
+        Vdu64 wa, wb;
+        VD_MEMCPY(&wa, a + i, 8);
+        VD_MEMCPY(&wb, b + i, 8);
+        if (wa != wb) break;
+    }
+    while ((i < len) && (a[i] == b[i])) i++;
+    return i;
+}
+
+// memcmp, except empty ranges may come from null strings
+static VD_INLINE Vdb32 vd__art_bytes_eq(const void *a, const void *b, Vdusize len)
+{
+    return vd__art_mismatch((const Vdu8*)a, (const Vdu8*)b, len) == len;
+}
+
+static Vd__ArtLeaf *vd__art_new_leaf(VdArt *art, VdStr key, Vdu64 value)
+{
+    Vd__ArtLeaf *leaf = (Vd__ArtLeaf*)vd_arena_alloc(art->arena, sizeof(Vd__ArtLeaf) + key.len);
+    leaf->type    = VD__ART_LEAF;
+    leaf->value   = value;
+    leaf->key.s   = (char*)(leaf + 1);
+    leaf->key.len = key.len;
+    if (key.len) VD_MEMCPY(leaf->key.s, key.s, key.len);
+    art->count++;
+    return leaf;
+}
+
+static Vd__ArtNode *vd__art_new_node(VdArt *art, Vd__ArtType type, Vd__ArtNode *copy_from)
+{
+    Vdusize size = 0;
+    switch (type) {
+        case VD__ART_NODE4:   size = sizeof(Vd__ArtNode4);   break;
+        case VD__ART_NODE16:  size = sizeof(Vd__ArtNode16);  break;
+        case VD__ART_NODE48:  size = sizeof(Vd__ArtNode48);  break;
+        case VD__ART_NODE256: size = sizeof(Vd__ArtNode256); break;
+        default: VD_ASSERT(VD_FALSE); break;
+    }
+
+    // Line aligned, so a node4 is one cache line and every node's keys are in its first
+    Vd__ArtNode *node = (Vd__ArtNode*)vd_arena_alloc_align(art->arena, size, 64);
+    if (copy_from) *node = *copy_from;
+    node->type = (Vdu8)type;
+    return node;
+}
+
+static void **vd__art_find_child(Vd__ArtNode *node, Vdu8 byte)
+{
+    switch (node->type) {
+        case VD__ART_NODE4: {
+            Vd__ArtNode4 *n = (Vd__ArtNode4*)node;
+            for (Vdu32 i = 0; i < node->count; ++i) {
+                if (n->keys[i] == byte) return &n->children[i];
+            }
+        } break;
+
+        case VD__ART_NODE16: {
+            Vd__ArtNode16 *n = (Vd__ArtNode16*)node;
+#if VD_SIMD_SSE2
+            __m128i eq   = _mm_cmpeq_epi8(_mm_set1_epi8((char)byte), _mm_loadu_si128((const __m128i*)n->keys));
+            Vdu32   mask = (Vdu32)_mm_movemask_epi8(eq) & ((1u << node->count) - 1);
+            if (mask) return &n->children[vd_ctz64(mask)];
+#elif VD_SIMD_NEON
+            // Narrow the byte mask to 4 bits per lane
+            uint8x16_t eq   = vceqq_u8(vdupq_n_u8(byte), vld1q_u8(n->keys));
+            Vdu64      mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(eq), 4)), 0);
+            if (node->count < 16) mask &= (1ull << (node->count * 4)) - 1;
+            if (mask) return &n->children[vd_ctz64(mask) >> 2];
+#else
+            for (Vdu32 i = 0; i < node->count; ++i) {
+                if (n->keys[i] == byte) return &n->children[i];
+            }
+#endif // VD_SIMD_SSE2, VD_SIMD_NEON, else
+        } break;
+
+        case VD__ART_NODE48: {
+            Vd__ArtNode48 *n = (Vd__ArtNode48*)node;
+            if (n->index[byte]) return &n->children[n->index[byte] - 1];
+        } break;
+
+        case VD__ART_NODE256: {
+            Vd__ArtNode256 *n = (Vd__ArtNode256*)node;
+            if (n->children[byte]) return &n->children[byte];
+        } break;
+    }
+    return 0;
+}
+
+// Inserts into a node4/node16 kept sorted by byte
+static void vd__art_insert_sorted(Vdu8 *keys, void **children, Vdu32 count, Vdu8 byte, void *child)
+{
+    Vdu32 i = 0;
+    while ((i < count) && (keys[i] < byte)) i++;
+    VD_MEMMOVE(keys + i + 1, keys + i, count - i);
+    VD_MEMMOVE(children + i + 1, children + i, (count - i) * sizeof(void*));
+    keys[i]     = byte;
+    children[i] = child;
+}
+
+// Adds a child for a byte that has none, growing the node (and updating *ref) if it's full
+static void vd__art_add_child(VdArt *art, void **ref, Vd__ArtNode *node, Vdu8 byte, void *child)
+{
+    switch (node->type) {
+        case VD__ART_NODE4: {
+            Vd__ArtNode4 *n = (Vd__ArtNode4*)node;
+            if (node->count < 4) {
+                vd__art_insert_sorted(n->keys, n->children, node->count++, byte, child);
+                return;
+            }
+
+            Vd__ArtNode16 *grown = (Vd__ArtNode16*)vd__art_new_node(art, VD__ART_NODE16, node);
+            VD_MEMCPY(grown->keys, n->keys, sizeof(n->keys));
+            VD_MEMCPY(grown->children, n->children, sizeof(n->children));
+            *ref = grown;
+            vd__art_add_child(art, ref, &grown->node, byte, child);
+        } break;
+
+        case VD__ART_NODE16: {
+            Vd__ArtNode16 *n = (Vd__ArtNode16*)node;
+            if (node->count < 16) {
+                vd__art_insert_sorted(n->keys, n->children, node->count++, byte, child);
+                return;
+            }
+
+            Vd__ArtNode48 *grown = (Vd__ArtNode48*)vd__art_new_node(art, VD__ART_NODE48, node);
+            for (Vdu32 i = 0; i < 16; ++i) {
+                grown->index[n->keys[i]] = (Vdu8)(i + 1);
+                grown->children[i]       = n->children[i];
+            }
+            *ref = grown;
+            vd__art_add_child(art, ref, &grown->node, byte, child);
+        } break;
+
+        case VD__ART_NODE48: {
+            Vd__ArtNode48 *n = (Vd__ArtNode48*)node;
+            if (node->count < 48) {
+                // Nothing is ever removed, so the slots fill in order
+                n->children[node->count] = child;
+                n->index[byte]           = (Vdu8)(++node->count);
+                return;
+            }
+
+            Vd__ArtNode256 *grown = (Vd__ArtNode256*)vd__art_new_node(art, VD__ART_NODE256, node);
+            for (Vdu32 b = 0; b < 256; ++b) {
+                if (n->index[b]) grown->children[b] = n->children[n->index[b] - 1];
+            }
+            *ref = grown;
+            vd__art_add_child(art, ref, &grown->node, byte, child);
+        } break;
+
+        case VD__ART_NODE256: {
+            Vd__ArtNode256 *n = (Vd__ArtNode256*)node;
+            n->children[byte] = child;
+            node->count++;
+        } break;
+    }
+}
+
+// Puts a leaf into a node whose prefix ends at depth
+static void vd__art_place_leaf(VdArt *art, void **ref, Vd__ArtNode *node, Vdusize depth, Vd__ArtLeaf *leaf)
+{
+    if (leaf->key.len == depth) {
+        node->leaf = leaf;
+    } else {
+        vd__art_add_child(art, ref, node, (Vdu8)leaf->key.s[depth], leaf);
+    }
+}
+
+VD_API void vd_art_init(VdArt *art, VdArena *arena)
+{
+    art->arena = arena;
+    art->root  = 0;
+    art->count = 0;
+}
+
+VD_API Vdb32 vd_art_set(VdArt *art, VdStr key, Vdu64 value)
+{
+    const Vdu8 *k = (const Vdu8*)key.s;
+    void **ref    = &art->root;
+    Vdusize depth = 0;
+
+    for (;;) {
+        void *p = *ref;
+        if (p == 0) {
+            *ref = vd__art_new_leaf(art, key, value);
+            return VD_TRUE;
+        }
+
+        if (vd__art_is_leaf(p)) {
+            Vd__ArtLeaf *leaf = (Vd__ArtLeaf*)p;
+            if (vd_str_eq(leaf->key, key)) {
+                leaf->value = value;
+                return VD_FALSE;
+            }
+
+            // Replace the leaf with a node holding both keys after their common bytes
+            Vd__ArtLeaf *added  = vd__art_new_leaf(art, key, value);
+            Vd__ArtNode *node   = vd__art_new_node(art, VD__ART_NODE4, 0);
+            Vdusize     max_len = (leaf->key.len < key.len ? leaf->key.len : key.len) - depth;
+            Vdusize     common  = vd__art_mismatch((const Vdu8*)leaf->key.s + depth, k + depth, max_len);
+            node->prefix     = (const Vdu8*)added->key.s + depth;
+            node->prefix_len = (Vdu32)common;
+
+            void *tmp = node;
+            vd__art_place_leaf(art, &tmp, node, depth + common, leaf);
+            vd__art_place_leaf(art, &tmp, node, depth + common, added);
+            *ref = node;
+            return VD_TRUE;
+        }
+
+        Vd__ArtNode *node = (Vd__ArtNode*)p;
+        if (node->prefix_len) {
+            Vdusize left   = key.len - depth;
+            Vdusize common = vd__art_mismatch(node->prefix, k + depth, left < node->prefix_len ? left : node->prefix_len);
+            if (common < node->prefix_len) {
+                // The key leaves the prefix early: split it with a node that branches there
+                Vd__ArtNode *split = vd__art_new_node(art, VD__ART_NODE4, 0);
+                split->prefix     = node->prefix;
+                split->prefix_len = (Vdu32)common;
+
+                Vdu8 byte = node->prefix[common];
+                node->prefix     += common + 1;
+                node->prefix_len -= (Vdu32)(common + 1);
+
+                void *tmp = split;
+                vd__art_add_child(art, &tmp, split, byte, node);
+                vd__art_place_leaf(art, &tmp, split, depth + common, vd__art_new_leaf(art, key, value));
+                *ref = split;
+                return VD_TRUE;
+            }
+            depth += node->prefix_len;
+        }
+
+        if (depth == key.len) {
+            if (node->leaf) {
+                node->leaf->value = value;
+                return VD_FALSE;
+            }
+            node->leaf = vd__art_new_leaf(art, key, value);
+            return VD_TRUE;
+        }
+
+        void **child = vd__art_find_child(node, k[depth]);
+        if (child == 0) {
+            vd__art_add_child(art, ref, node, k[depth], vd__art_new_leaf(art, key, value));
+            return VD_TRUE;
+        }
+
+        ref = child;
+        depth++;
+    }
+}
+
+VD_API Vdb32 vd_art_get(VdArt *art, VdStr key, Vdu64 *value)
+{
+    const Vdu8 *k = (const Vdu8*)key.s;
+    void *p       = art->root;
+    Vdusize depth = 0;
+
+    // Every byte before depth has been matched on the way down, so only the rest is compared
+    while (p) {
+        if (vd__art_is_leaf(p)) {
+            Vd__ArtLeaf *leaf = (Vd__ArtLeaf*)p;
+            if ((leaf->key.len != key.len) || !vd__art_bytes_eq(leaf->key.s + depth, k + depth, key.len - depth)) {
+                return VD_FALSE;
+            }
+            if (value) *value = leaf->value;
+            return VD_TRUE;
+        }
+
+        Vd__ArtNode *node = (Vd__ArtNode*)p;
+        if (node->prefix_len) {
+            if ((key.len - depth < node->prefix_len) || !vd__art_bytes_eq(node->prefix, k + depth, node->prefix_len)) {
+                return VD_FALSE;
+            }
+            depth += node->prefix_len;
+        }
+
+        if (depth == key.len) {
+            if (node->leaf == 0) return VD_FALSE;
+            if (value) *value = node->leaf->value;
+            return VD_TRUE;
+        }
+
+        void **child = vd__art_find_child(node, k[depth]);
+        if (child == 0) return VD_FALSE;
+        // Node16 children and long leaf keys spill into the next line
+        p = *child;
+        VD_PREFETCH((Vdu8*)p + 64);
+        depth++;
+    }
+    return VD_FALSE;
+}
+
+VD_API Vdb32 vd_art_longest_prefix(VdArt *art, VdStr str, VdStr *matched, Vdu64 *value)
+{
+    const Vdu8 *k     = (const Vdu8*)str.s;
+    void *p           = art->root;
+    Vdusize depth     = 0;
+    Vd__ArtLeaf *best = 0;
+
+    while (p) {
+        if (vd__art_is_leaf(p)) {
+            Vd__ArtLeaf *leaf = (Vd__ArtLeaf*)p;
+            if ((leaf->key.len <= str.len) &&
+                vd__art_bytes_eq(leaf->key.s + depth, k + depth, leaf->key.len - depth))
+            {
+                best = leaf;
+            }
+            break;
+        }
+
+        Vd__ArtNode *node = (Vd__ArtNode*)p;
+        if (node->prefix_len) {
+            if ((str.len - depth < node->prefix_len) || !vd__art_bytes_eq(node->prefix, k + depth, node->prefix_len)) {
+                break;
+            }
+            depth += node->prefix_len;
+        }
+
+        if (node->leaf) best = node->leaf;
+        if (depth == str.len) break;
+
+        void **child = vd__art_find_child(node, k[depth]);
+        if (child == 0) break;
+        p = *child;
+        VD_PREFETCH((Vdu8*)p + 64);
+        depth++;
+    }
+
+    if (best == 0) return VD_FALSE;
+    if (matched) *matched = best->key;
+    if (value)   *value   = best->value;
+    return VD_TRUE;
+}
+
+static Vdb32 vd__art_visit_leaf(Vd__ArtLeaf *leaf, VdProcArtVisit *visit, void *userdata, Vdusize *count)
+{
+    (*count)++;
+    return visit(leaf->key, leaf->value, userdata);
+}
+
+static Vdb32 vd__art_visit_all(void *p, VdProcArtVisit *visit, void *userdata, Vdusize *count)
+{
+    if (vd__art_is_leaf(p)) return vd__art_visit_leaf((Vd__ArtLeaf*)p, visit, userdata, count);
+
+    // A node's own key is a prefix of everything below it, so it comes first
+    Vd__ArtNode *node = (Vd__ArtNode*)p;
+    if (node->leaf && !vd__art_visit_leaf(node->leaf, visit, userdata, count)) return VD_FALSE;
+
+    switch (node->type) {
+        case VD__ART_NODE4: {
+            Vd__ArtNode4 *n = (Vd__ArtNode4*)node;
+            for (Vdu32 i = 0; i < node->count; ++i) {
+                if (!vd__art_visit_all(n->children[i], visit, userdata, count)) return VD_FALSE;
+            }
+        } break;
+
+        case VD__ART_NODE16: {
+            Vd__ArtNode16 *n = (Vd__ArtNode16*)node;
+            for (Vdu32 i = 0; i < node->count; ++i) {
+                if (!vd__art_visit_all(n->children[i], visit, userdata, count)) return VD_FALSE;
+            }
+        } break;
+
+        case VD__ART_NODE48: {
+            Vd__ArtNode48 *n = (Vd__ArtNode48*)node;
+            for (Vdu32 b = 0; b < 256; ++b) {
+                if (n->index[b] && !vd__art_visit_all(n->children[n->index[b] - 1], visit, userdata, count)) {
+                    return VD_FALSE;
+                }
+            }
+        } break;
+
+        case VD__ART_NODE256: {
+            Vd__ArtNode256 *n = (Vd__ArtNode256*)node;
+            for (Vdu32 b = 0; b < 256; ++b) {
+                if (n->children[b] && !vd__art_visit_all(n->children[b], visit, userdata, count)) return VD_FALSE;
+            }
+        } break;
+    }
+    return VD_TRUE;
+}
+
+VD_API Vdusize vd_art_visit_prefix(VdArt *art, VdStr prefix, VdProcArtVisit *visit, void *userdata)
+{
+    const Vdu8 *k = (const Vdu8*)prefix.s;
+    void *p       = art->root;
+    Vdusize depth = 0;
+    Vdusize count = 0;
+
+    // Descend until the prefix is used up; everything below that point matches
+    while (p) {
+        if (vd__art_is_leaf(p)) {
+            Vd__ArtLeaf *leaf = (Vd__ArtLeaf*)p;
+            if ((leaf->key.len >= prefix.len) &&
+                vd__art_bytes_eq(leaf->key.s + depth, k + depth, prefix.len - depth))
+            {
+                vd__art_visit_leaf(leaf, visit, userdata, &count);
+            }
+            break;
+        }
+
+        Vd__ArtNode *node = (Vd__ArtNode*)p;
+        Vdusize left      = prefix.len - depth;
+        Vdusize check     = left < node->prefix_len ? left : node->prefix_len;
+        if (!vd__art_bytes_eq(node->prefix, k + depth, check)) break;
+        if (left <= node->prefix_len) {
+            vd__art_visit_all(node, visit, userdata, &count);
+            break;
+        }
+        depth += node->prefix_len;
+
+        void **child = vd__art_find_child(node, k[depth]);
+        if (child == 0) break;
+        p = *child;
+        depth++;
+    }
+    return count;
+}
+
+/* ----MAP IMAGE IMPL------------------------------------------------------------------------------------------------ */
+#define VD__MAP_IMAGE_PROBE_KEY "vd_map_image_probe"
+
+static Vdu32 vd__map_image_hash_seed(void)
+{
+#if VD_HASH64_CUSTOM
+    return 0;
+#else
+    return VD_HASH64_DEFAULT_SEED;
+#endif // VD_HASH64_CUSTOM
+}
+
+static Vdu64 vd__map_image_hash_check(void)
+{
+    return vd_dhash64(VD__MAP_IMAGE_PROBE_KEY, sizeof(VD__MAP_IMAGE_PROBE_KEY) - 1);
+}
+
+static Vdu32 vd__map_image_bin_size(Vdu32 ksize, Vdu32 vsize)
+{
+    return (Vdu32)((sizeof(VdMapImageBin) + ksize + vsize + 7) & ~(Vdusize)7);
+}
+
+static Vdusize vd__strmap_image_keys_size(void *map)
+{
+    Vdusize result = 0;
+    for (Vdu32 i = 0; i < VD_STRMAP_TOTAL_CAP(map); ++i) {
+        Vd__StrmapBinPrefix *bin = VD_STRMAP_GET_BIN(map, i);
+        if (bin->used) result += bin->key_len;
+    }
+    return result;
+}
+
+static void vd__map_image_fill_header(VdMapImageHeader *h, VdMapImageKind kind, Vdu32 cap, Vdu32 cap_total,
+                                      Vdu32 count, Vdu32 ksize, Vdu32 vsize, Vdusize keys_size)
+{
+    VD_MEMSET(h, 0, sizeof(*h));
+    h->magic       = VD_MAP_IMAGE_MAGIC;
+    h->version     = VD_MAP_IMAGE_VERSION;
+    h->kind        = kind;
+    h->hash_seed   = vd__map_image_hash_seed();
+    h->hash_check  = vd__map_image_hash_check();
+    h->cap         = cap;
+    h->cap_total   = cap_total;
+    h->count       = count;
+    h->ksize       = ksize;
+    h->vsize       = vsize;
+    h->bin_size    = vd__map_image_bin_size(ksize, vsize);
+    h->bins_offset = sizeof(VdMapImageHeader);
+    h->keys_offset = h->bins_offset + (Vdu64)h->bin_size * cap_total;
+    h->keys_size   = keys_size;
+    h->total_size  = (h->keys_offset + keys_size + 7) & ~(Vdu64)7;
+}
+
+VD_API Vdusize vd_strmap_image_size(void *map)
+{
+    VdMapImageHeader h;
+    vd__map_image_fill_header(&h, VD_MAP_IMAGE_KIND_STRMAP, VD_STRMAP_HEADER(map)->cap, VD_STRMAP_TOTAL_CAP(map),
+                              VD_STRMAP_COUNT(map), 0, VD_STRMAP_TSIZE(map), vd__strmap_image_keys_size(map));
+    return (Vdusize)h.total_size;
+}
+
+VD_API Vdusize vd_strmap_image_write(void *map, void *buf, Vdusize buf_len)
+{
+    VdMapImageHeader *h = (VdMapImageHeader*)buf;
+    VdMapImageHeader header;
+    vd__map_image_fill_header(&header, VD_MAP_IMAGE_KIND_STRMAP, VD_STRMAP_HEADER(map)->cap, VD_STRMAP_TOTAL_CAP(map),
+                              VD_STRMAP_COUNT(map), 0, VD_STRMAP_TSIZE(map), vd__strmap_image_keys_size(map));
+    if (buf_len < header.total_size) return 0;
+
+    VD_MEMSET(buf, 0, (Vdusize)header.total_size);
+    *h = header;
+
+    Vdu8 *bins = (Vdu8*)buf + h->bins_offset;
+    char *keys = (char*)buf + h->keys_offset;
+    Vdu64 key_cursor = 0;
+
+    for (Vdu32 i = 0; i < h->cap_total; ++i) {
+        Vd__StrmapBinPrefix *src = VD_STRMAP_GET_BIN(map, i);
+        VdMapImageBin       *dst = (VdMapImageBin*)(bins + (Vdusize)i * h->bin_size);
+
+        // Chains are written for unused bins as well, since lookups walk through them
+        dst->next = src->next ? (Vdu32)VD_STRMAP_GET_BIN_INDEX(map, src->next) + 1 : 0;
+        if (!src->used) continue;
+
+        Vdu32 prefix_len = src->key_len < sizeof(src->key_prefix) ? src->key_len : (Vdu32)sizeof(src->key_prefix);
+        VD_MEMCPY(keys + key_cursor, src->key_prefix, prefix_len);
+        if (src->key_len > prefix_len) {
+            VD_MEMCPY(keys + key_cursor + prefix_len, src->key_rest, src->key_len - prefix_len);
+        }
+
+        dst->used       = 1;
+        dst->key_len    = src->key_len;
+        dst->key_offset = key_cursor;
+        dst->key_hash   = (Vdu32)vd_dhash64(keys + key_cursor, src->key_len);
+        VD_MEMCPY(dst + 1, VD_STRMAP_BIN_MOVE_TO_VPTR(src), h->vsize);
+
+        key_cursor += src->key_len;
+    }
+
+    return (Vdusize)h->total_size;
+}
+
+VD_API Vdusize vd_kvmap_image_size(void *map)
+{
+    VdMapImageHeader h;
+    vd__map_image_fill_header(&h, VD_MAP_IMAGE_KIND_KVMAP, VD_KVMAP_HEADER(map)->cap, VD_KVMAP_TOTAL_CAP(map),
+                              VD_KVMAP_COUNT(map), VD_KVMAP_KSIZE(map), VD_KVMAP_VSIZE(map), 0);
+    return (Vdusize)h.total_size;
+}
+
+VD_API Vdusize vd_kvmap_image_write(void *map, void *buf, Vdusize buf_len)
+{
+    VdMapImageHeader *h = (VdMapImageHeader*)buf;
+    VdMapImageHeader header;
+    vd__map_image_fill_header(&header, VD_MAP_IMAGE_KIND_KVMAP, VD_KVMAP_HEADER(map)->cap, VD_KVMAP_TOTAL_CAP(map),
+                              VD_KVMAP_COUNT(map), VD_KVMAP_KSIZE(map), VD_KVMAP_VSIZE(map), 0);
+    if (buf_len < header.total_size) return 0;
+
+    VD_MEMSET(buf, 0, (Vdusize)header.total_size);
+    *h = header;
+
+    Vdu8 *bins = (Vdu8*)buf + h->bins_offset;
+    for (Vdu32 i = 0; i < h->cap_total; ++i) {
+        Vd__KVMapBinPrefix *src = VD_KVMAP_GET_BIN(map, i);
+        VdMapImageBin      *dst = (VdMapImageBin*)(bins + (Vdusize)i * h->bin_size);
+
+        dst->next = src->next ? (Vdu32)VD_KVMAP_GET_BIN_INDEX(map, src->next) + 1 : 0;
+        if (!src->used) continue;
+
+        dst->used = 1;
+        VD_MEMCPY(dst + 1, VD_KVMAP_BIN_MOVE_TO_KPTR(src), h->ksize + h->vsize);
+    }
+
+    return (Vdusize)h->total_size;
+}
+
+static VdMapImageStatus vd__map_image_open(VdMapImage *image, const void *data, Vdusize size, VdMapImageKind kind)
+{
+    const VdMapImageHeader *h = (const VdMapImageHeader*)data;
+    if (size < sizeof(VdMapImageHeader))            return VD_MAP_IMAGE_ERROR_TOO_SMALL;
+    if (h->magic != VD_MAP_IMAGE_MAGIC)             return VD_MAP_IMAGE_ERROR_BAD_MAGIC;
+    if (h->version != VD_MAP_IMAGE_VERSION)         return VD_MAP_IMAGE_ERROR_BAD_VERSION;
+    if (h->kind != (Vdu32)kind)                     return VD_MAP_IMAGE_ERROR_WRONG_KIND;
+    if ((h->hash_seed != vd__map_image_hash_seed()) ||
+        (h->hash_check != vd__map_image_hash_check())) return VD_MAP_IMAGE_ERROR_HASH_MISMATCH;
+    if (h->total_size > size)                       return VD_MAP_IMAGE_ERROR_TOO_SMALL;
+
+    if ((h->cap == 0) || (h->cap > h->cap_total) ||
+        (h->bin_size != vd__map_image_bin_size(h->ksize, h->vsize)) ||
+        (h->bins_offset < sizeof(VdMapImageHeader)) ||
+        (h->keys_offset != h->bins_offset + (Vdu64)h->bin_size * h->cap_total) ||
+        (h->keys_offset + h->keys_size > h->total_size))
+    {
+        return VD_MAP_IMAGE_ERROR_CORRUPT;
+    }
+
+    image->header = h;
+    image->bins   = (const Vdu8*)data + h->bins_offset;
+    image->keys   = (const char*)data + h->keys_offset;
+    return VD_MAP_IMAGE_OK;
+}
+
+VD_API VdMapImageStatus vd_strmap_image_open(VdMapImage *image, const void *data, Vdusize size)
+{
+    return vd__map_image_open(image, data, size, VD_MAP_IMAGE_KIND_STRMAP);
+}
+
+VD_API VdMapImageStatus vd_kvmap_image_open(VdMapImage *image, const void *data, Vdusize size)
+{
+    return vd__map_image_open(image, data, size, VD_MAP_IMAGE_KIND_KVMAP);
+}
+
+VD_API Vdcstr vd_map_image_status_to_cstr(VdMapImageStatus status)
+{
+    switch (status) {
+        case VD_MAP_IMAGE_OK:                     return "OK";
+        case VD_MAP_IMAGE_ERROR_TOO_SMALL:        return "Image is truncated";
+        case VD_MAP_IMAGE_ERROR_BAD_MAGIC:        return "Not a map image";
+        case VD_MAP_IMAGE_ERROR_BAD_VERSION:      return "Unsupported map image version";
+        case VD_MAP_IMAGE_ERROR_WRONG_KIND:       return "Map image is of a different kind";
+        case VD_MAP_IMAGE_ERROR_HASH_MISMATCH:    return "Map image was written with a different hash function or seed";
+        case VD_MAP_IMAGE_ERROR_CORRUPT:          return "Map image is corrupt";
+        default:                                  return "Unknown";
+    }
+}
+
+#define VD__MAP_IMAGE_BIN(image, i) ((const VdMapImageBin*)((image)->bins + (Vdusize)(i) * (image)->header->bin_size))
+
+VD_API const void *vd_strmap_image_get_ptr(VdMapImage *image, VdStr key)
+{
+    const VdMapImageHeader *h = image->header;
+    Vdu64 hash     = vd_dhash64_str(key);
+    Vdu32 key_hash = (Vdu32)hash;
+    Vdu32 index    = (Vdu32)(hash % h->cap);
+
+    // Walks at most cap_total bins, so a corrupt chain can't loop forever
+    for (Vdu32 steps = 0; steps < h->cap_total; ++steps) {
+        const VdMapImageBin *bin = VD__MAP_IMAGE_BIN(image, index);
+
+        if (bin->used && (bin->key_hash == key_hash) && (bin->key_len == key.len) &&
+            (bin->key_offset + bin->key_len <= h->keys_size) &&
+            (VD_MEMCMP(image->keys + bin->key_offset, key.s, key.len) == 0))
+        {
+            return (const void*)(bin + 1);
+        }
+
+        if ((bin->next == 0) || (bin->next > h->cap_total)) break;
+        index = bin->next - 1;
+    }
+
+    return 0;
+}
+
+VD_API Vdb32 vd_strmap_image_get(VdMapImage *image, VdStr key, void *value)
+{
+    const void *ptr = vd_strmap_image_get_ptr(image, key);
+    if (ptr == 0) return VD_FALSE;
+
+    VD_MEMCPY(value, ptr, image->header->vsize);
+    return VD_TRUE;
+}
+
+VD_API const void *vd_kvmap_image_get_ptr(VdMapImage *image, const void *key)
+{
+    const VdMapImageHeader *h = image->header;
+    Vdu32 index = (Vdu32)(vd_dhash64(key, h->ksize) % h->cap);
+
+    for (Vdu32 steps = 0; steps < h->cap_total; ++steps) {
+        const VdMapImageBin *bin = VD__MAP_IMAGE_BIN(image, index);
+
+        if (bin->used && (VD_MEMCMP(bin + 1, key, h->ksize) == 0)) {
+            return (const void*)((const Vdu8*)(bin + 1) + h->ksize);
+        }
+
+        if ((bin->next == 0) || (bin->next > h->cap_total)) break;
+        index = bin->next - 1;
+    }
+
+    return 0;
+}
+
+VD_API Vdb32 vd_kvmap_image_get(VdMapImage *image, const void *key, void *value)
+{
+    const void *ptr = vd_kvmap_image_get_ptr(image, key);
+    if (ptr == 0) return VD_FALSE;
+
+    VD_MEMCPY(value, ptr, image->header->vsize);
+    return VD_TRUE;
+}
+
+#undef VD__MAP_IMAGE_BIN
+
+/* ----ARENA SNAPSHOT IMPL------------------------------------------------------------------------------------------- */
+static void vd__arena_snapshot_fill_header(VdArenaSnapshotHeader *h, VdArena *a, void *root, Vdusize num_relocs)
+{
+    Vdusize residue = (Vdusize)((Vduptr)a->buf % VD_ARENA_SNAPSHOT_ALIGN);
+
+    VD_MEMSET(h, 0, sizeof(*h));
+    h->magic         = VD_ARENA_SNAPSHOT_MAGIC;
+    h->version       = VD_ARENA_SNAPSHOT_VERSION;
+    h->ptr_size      = (Vdu32)sizeof(void*);
+    h->base_residue  = (Vdu32)residue;
+    h->base          = 0;
+    h->data_offset   = vd_align_forward(sizeof(VdArenaSnapshotHeader), VD_ARENA_SNAPSHOT_ALIGN) + residue;
+    h->data_size     = a->curr_offset;
+    h->relocs_offset = vd_align_forward((Vduptr)(h->data_offset + h->data_size), 8);
+    h->num_relocs    = num_relocs;
+    h->root_offset   = root ? (Vdu64)((Vdu8*)root - a->buf) : VD_U64_MAX;
+    h->total_size    = vd_align_forward((Vduptr)(h->relocs_offset + num_relocs * sizeof(Vdu32)), 8);
+}
+
+VD_API void vd_arena_snapshot_relocs_init(VdArenaSnapshotRelocs *relocs, VdArena *table_arena)
+{
+    relocs->slots = 0;
+    VD_DYNARRAY_INIT(relocs->slots, table_arena);
+}
+
+VD_API void vd_arena_snapshot_add_ptr(VdArenaSnapshotRelocs *relocs, void *slot)
+{
+    VD_DYNARRAY_ADD(relocs->slots, (Vduptr)slot);
+}
+
+VD_API void vd_arena_snapshot_add_ptrs(VdArenaSnapshotRelocs *relocs, void *object, const Vdu32 *offsets,
+                                       Vdu32 num_offsets)
+{
+    for (Vdu32 i = 0; i < num_offsets; ++i) {
+        VD_DYNARRAY_ADD(relocs->slots, (Vduptr)object + offsets[i]);
+    }
+}
+
+/**
+ * Null slots stay null without a relocation, so only the others are counted. Slots outside the arena are counted
+ * without being read; vd__arena_snapshot_collect rejects them.
+ */
+static Vdusize vd__arena_snapshot_count_relocs(VdArena *a, VdArenaSnapshotRelocs *relocs)
+{
+    Vduptr  lo     = (Vduptr)a->buf;
+    Vduptr  end    = lo + a->curr_offset;
+    Vdusize result = 0;
+
+    for (Vdu32 i = 0; i < VD_DYNARRAY_LEN(relocs->slots); ++i) {
+        Vduptr p = relocs->slots[i];
+        if ((p < lo) || (p + sizeof(void*) > end) || (*(Vduptr*)p != 0)) result++;
+    }
+
+    return result;
+}
+
+/**
+ * Turns the registered slots into word indices, counted from the arena buffer rounded down to the pointer size.
+ * Returns VD_FALSE for a slot that isn't a pointer-aligned word inside the used part of the arena.
+ */
+static Vdb32 vd__arena_snapshot_collect(VdArena *a, VdArenaSnapshotRelocs *relocs, Vdu32 *out)
+{
+    Vduptr  lo    = (Vduptr)a->buf;
+    Vduptr  words = lo & ~(Vduptr)(sizeof(void*) - 1);
+    Vduptr  end   = lo + a->curr_offset;
+    Vdusize n     = 0;
+
+    for (Vdu32 i = 0; i < VD_DYNARRAY_LEN(relocs->slots); ++i) {
+        Vduptr p = relocs->slots[i];
+        if ((p < lo) || (p + sizeof(void*) > end) || ((p & (sizeof(void*) - 1)) != 0)) return VD_FALSE;
+        if (*(Vduptr*)p == 0) continue;
+
+        out[n++] = (Vdu32)((p - words) / sizeof(void*));
+    }
+
+    return VD_TRUE;
+}
+
+static VdArenaSnapshotStatus vd__arena_snapshot_check(const void *image, Vdusize size)
+{
+    const VdArenaSnapshotHeader *h = (const VdArenaSnapshotHeader*)image;
+
+    if (((Vduptr)image & 7) != 0)                         return VD_ARENA_SNAPSHOT_ERROR_MISALIGNED;
+    if (size < sizeof(VdArenaSnapshotHeader))             return VD_ARENA_SNAPSHOT_ERROR_TOO_SMALL;
+    if (h->magic != VD_ARENA_SNAPSHOT_MAGIC)              return VD_ARENA_SNAPSHOT_ERROR_BAD_MAGIC;
+    if (h->version != VD_ARENA_SNAPSHOT_VERSION)          return VD_ARENA_SNAPSHOT_ERROR_BAD_VERSION;
+    if (h->ptr_size != sizeof(void*))                     return VD_ARENA_SNAPSHOT_ERROR_POINTER_SIZE;
+    if (h->total_size > size)                             return VD_ARENA_SNAPSHOT_ERROR_TOO_SMALL;
+
+    if ((h->base_residue >= VD_ARENA_SNAPSHOT_ALIGN) ||
+        (h->data_offset < sizeof(VdArenaSnapshotHeader)) ||
+        (h->data_offset > h->total_size) ||
+        (h->data_offset % VD_ARENA_SNAPSHOT_ALIGN != h->base_residue) ||
+        (h->data_size > h->total_size - h->data_offset) ||
+        (h->relocs_offset % sizeof(Vdu32) != 0) ||
+        (h->relocs_offset < h->data_offset + h->data_size) ||
+        (h->relocs_offset > h->total_size) ||
+        (h->num_relocs > (h->total_size - h->relocs_offset) / sizeof(Vdu32)) ||
+        ((h->root_offset != VD_U64_MAX) && (h->root_offset > h->data_size)))
+    {
+        return VD_ARENA_SNAPSHOT_ERROR_CORRUPT;
+    }
+
+    return VD_ARENA_SNAPSHOT_OK;
+}
+
+/**
+ * The single fixup pass: every slot in data currently holds an address relative to h->base, and is rebased onto
+ * new_base.
+ */
+static VdArenaSnapshotStatus vd__arena_snapshot_relocate(const VdArenaSnapshotHeader *h, const Vdu32 *relocs,
+                                                         Vdu8 *data, Vduptr new_base)
+{
+    Vdusize head      = h->base_residue % sizeof(void*);
+    Vduptr  *words    = (Vduptr*)(data - head);
+    Vduptr  base      = (Vduptr)h->base;
+    Vduptr  range     = (Vduptr)h->data_size;
+    Vdu32   min_index = head ? 1 : 0;
+    Vdu64   max_index = (head + h->data_size) / sizeof(void*);
+
+    for (Vdu64 i = 0; i < h->num_relocs; ++i) {
+        Vdu32 index = relocs[i];
+        if ((index < min_index) || (index >= max_index)) return VD_ARENA_SNAPSHOT_ERROR_CORRUPT;
+
+        Vduptr offset = words[index] - base;
+        if (offset > range) return VD_ARENA_SNAPSHOT_ERROR_CORRUPT;
+
+        words[index] = new_base + offset;
+    }
+
+    return VD_ARENA_SNAPSHOT_OK;
+}
+
+VD_API Vdusize vd_arena_snapshot_size(VdArena *a, VdArenaSnapshotRelocs *relocs)
+{
+    VdArenaSnapshotHeader h;
+    vd__arena_snapshot_fill_header(&h, a, 0, vd__arena_snapshot_count_relocs(a, relocs));
+    return (Vdusize)h.total_size;
+}
+
+VD_API Vdusize vd_arena_snapshot_write(VdArena *a, VdArenaSnapshotRelocs *relocs, void *root, void *buf,
+                                       Vdusize buf_len)
+{
+    if (a->flags & VD_ARENA_FLAGS_USE_MALLOC)            return 0;
+    if (a->curr_offset / sizeof(void*) >= VD_U32_MAX)    return 0;
+    if (((Vduptr)buf & 7) != 0)                          return 0;
+
+    VdArenaSnapshotHeader header;
+    vd__arena_snapshot_fill_header(&header, a, root, vd__arena_snapshot_count_relocs(a, relocs));
+    if (buf_len < header.total_size) return 0;
+
+    Vdu8    *out        = (Vdu8*)buf;
+    Vdu32   *table      = (Vdu32*)(out + header.relocs_offset);
+    Vdusize num_relocs  = (Vdusize)header.num_relocs;
+    if (!vd__arena_snapshot_collect(a, relocs, table)) return 0;
+
+    VD_MEMSET(out, 0, (Vdusize)header.data_offset);
+    VD_MEMCPY(out + header.data_offset, a->buf, a->curr_offset);
+    VD_MEMSET(out + header.data_offset + header.data_size, 0,
+              (Vdusize)(header.relocs_offset - header.data_offset - header.data_size));
+    VD_MEMSET((Vdu8*)(table + num_relocs), 0, (Vdusize)(header.total_size - header.relocs_offset) -
+              num_relocs * sizeof(Vdu32));
+    VD_MEMCPY(out, &header, sizeof(header));
+
+    // Store offsets from the start of the data (i.e. relative to a base of 0), so the file doesn't depend on where the
+    // arena happened to live. This also rejects slots pointing outside the arena, and slots registered twice.
+    header.base = (Vdu64)(Vduptr)a->buf;
+    if (vd__arena_snapshot_relocate(&header, table, out + header.data_offset, 0) != VD_ARENA_SNAPSHOT_OK) return 0;
+    return (Vdusize)header.total_size;
+}
+
+VD_API VdArenaSnapshotStatus vd_arena_snapshot_fixup(void *image, Vdusize size, void **root)
+{
+    VdArenaSnapshotStatus status = vd__arena_snapshot_check(image, size);
+    if (status != VD_ARENA_SNAPSHOT_OK) return status;
+
+    VdArenaSnapshotHeader *h      = (VdArenaSnapshotHeader*)image;
+    Vdu8                  *data   = (Vdu8*)image + h->data_offset;
+    const Vdu32           *relocs = (const Vdu32*)((Vdu8*)image + h->relocs_offset);
+
+    if (h->base != (Vdu64)(Vduptr)data) {
+        status = vd__arena_snapshot_relocate(h, relocs, data, (Vduptr)data);
+        if (status != VD_ARENA_SNAPSHOT_OK) return status;
+        h->base = (Vdu64)(Vduptr)data;
+    }
+
+    if (root) *root = (h->root_offset == VD_U64_MAX) ? 0 : (void*)(data + h->root_offset);
+    return VD_ARENA_SNAPSHOT_OK;
+}
+
+VD_API VdArenaSnapshotStatus vd_arena_snapshot_load(VdArena *a, const void *image, Vdusize size, void **root)
+{
+    VdArenaSnapshotStatus status = vd__arena_snapshot_check(image, size);
+    if (status != VD_ARENA_SNAPSHOT_OK) return status;
+
+    const VdArenaSnapshotHeader *h      = (const VdArenaSnapshotHeader*)image;
+    const Vdu32                 *relocs = (const Vdu32*)((const Vdu8*)image + h->relocs_offset);
+    Vdusize                     needed  = (Vdusize)h->data_size + h->base_residue;
+
+    // vd_arena_alloc_align breaks into the debugger when it runs out, so check beforehand (with worst-case padding).
+    if (a->buf_len - a->curr_offset < needed + VD_ARENA_SNAPSHOT_ALIGN) return VD_ARENA_SNAPSHOT_ERROR_OUT_OF_MEMORY;
+
+    VdArenaSave save = vd_arena_save(a);
+    Vdu8 *data = (Vdu8*)vd_arena_alloc_align(a, needed, VD_ARENA_SNAPSHOT_ALIGN);
+    if (data == 0) return VD_ARENA_SNAPSHOT_ERROR_OUT_OF_MEMORY;
+    data += h->base_residue;
+
+    VD_MEMCPY(data, (const Vdu8*)image + h->data_offset, (Vdusize)h->data_size);
+
+    status = vd__arena_snapshot_relocate(h, relocs, data, (Vduptr)data);
+    if (status != VD_ARENA_SNAPSHOT_OK) {
+        vd_arena_restore(save);
+        return status;
+    }
+
+    if (root) *root = (h->root_offset == VD_U64_MAX) ? 0 : (void*)(data + h->root_offset);
+    return VD_ARENA_SNAPSHOT_OK;
+}
+
+VD_API Vdcstr vd_arena_snapshot_status_to_cstr(VdArenaSnapshotStatus status)
+{
+    switch (status) {
+        case VD_ARENA_SNAPSHOT_OK:                    return "OK";
+        case VD_ARENA_SNAPSHOT_ERROR_TOO_SMALL:       return "Snapshot is truncated";
+        case VD_ARENA_SNAPSHOT_ERROR_BAD_MAGIC:       return "Not an arena snapshot";
+        case VD_ARENA_SNAPSHOT_ERROR_BAD_VERSION:     return "Unsupported arena snapshot version";
+        case VD_ARENA_SNAPSHOT_ERROR_POINTER_SIZE:    return "Arena snapshot was written with a different pointer size";
+        case VD_ARENA_SNAPSHOT_ERROR_MISALIGNED:      return "Arena snapshot is not 8-byte aligned";
+        case VD_ARENA_SNAPSHOT_ERROR_OUT_OF_MEMORY:   return "Not enough space in the arena to load the snapshot";
+        case VD_ARENA_SNAPSHOT_ERROR_CORRUPT:         return "Arena snapshot is corrupt";
+        default:                                      return "Unknown";
+    }
+}
+
+/* ----FILESYSTEM IMPL----------------------------------------------------------------------------------------------- */
+#if VD_INCLUDE_PLATFORM_SPECIFIC_FUNCTIONALITY
+#if VD_PLATFORM_WINDOWS
+#include <windows.h>
+static wchar_t Cached_Directory_Entry[1024];
+static char    Filename_Cache[256];
+
+VD_API int vd_directory_open(VdDirectory *directory, const char *path)
+{
+    directory->filename = vd_str_from_cstr((char*)path);
+    directory->windows_is_on_first_file = VD_TRUE;
+    directory->windows_is_on_directory  = VD_FALSE;
+    return 1;
+}
+
+VD_API int vd_directory_get_file(VdDirectory *directory, VdFile *file)
+{
+query_file:
+    WIN32_FIND_DATAW dataw;
+    Vdb32 was_found = VD_FALSE;
+
+    if (directory->windows_is_on_first_file) {
+        Vdu32 lenw = MultiByteToWideChar(
+            CP_UTF8,
+            MB_ERR_INVALID_CHARS,
+            (const char*)directory->filename.s, (Vdu32)directory->filename.len,
+            Cached_Directory_Entry,
+            VD_ARRAY_COUNT(Cached_Directory_Entry));
+
+        if (Cached_Directory_Entry[lenw -1] != L'/' && Cached_Directory_Entry[lenw -1] != L'\\') {
+            Cached_Directory_Entry[lenw++] = L'\\';
+        }
+
+        Cached_Directory_Entry[lenw++] = L'*';
+        Cached_Directory_Entry[lenw]   = 0;
+
+        directory->handle = FindFirstFileW(Cached_Directory_Entry, &dataw);
+
+        was_found = directory->handle != INVALID_HANDLE_VALUE;
+        directory->windows_is_on_first_file = VD_FALSE;
+    } else {
+        was_found = FindNextFileW(directory->handle, &dataw);
+    }
+
+    if (!was_found) {
+        return VD_FALSE;
+    }
+
+    int num_bytes = WideCharToMultiByte(
+        CP_UTF8,
+        WC_ERR_INVALID_CHARS,
+        dataw.cFileName, -1,
+        Filename_Cache,
+        sizeof(Filename_Cache),
+        0, 0);
+
+    file->name.s = Filename_Cache;
+    file->name.len = num_bytes - 1;
+
+    if (vd_str_eq(file->name, VD_LIT(".")) || vd_str_eq(file->name, VD_LIT(".."))) {
+        goto query_file;
+    }
+
+    file->flags = 0;
+    if (dataw.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+        file->flags |= VD_FILE_FLAG_DIRECTORY;
+    }
+
+    return VD_TRUE;
+}
+
+VD_API int vd_directory_close(VdDirectory *directory)
+{
+    FindClose((HANDLE)directory->handle);    
+    return 1;
+}
+
+VD_API Vdb32 vd_file_map_open(VdFileMap *map, Vdcstr path)
+{
+    VD_MEMSET(map, 0, sizeof(*map));
+
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+    if (file == INVALID_HANDLE_VALUE) return VD_FALSE;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || (size.QuadPart == 0)) {
+        CloseHandle(file);
+        return VD_FALSE;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, 0, PAGE_READONLY, 0, 0, 0);
+    if (mapping == 0) {
+        CloseHandle(file);
+        return VD_FALSE;
+    }
+
+    void *data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (data == 0) {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return VD_FALSE;
+    }
+
+    map->data    = data;
+    map->size    = (Vdusize)size.QuadPart;
+    map->handle  = (Vdu64)(Vduptr)file;
+    map->mapping = (Vdu64)(Vduptr)mapping;
+    return VD_TRUE;
+}
+
+VD_API void vd_file_map_close(VdFileMap *map)
+{
+    if (map->data) {
+        UnmapViewOfFile(map->data);
+        CloseHandle((HANDLE)(Vduptr)map->mapping);
+        CloseHandle((HANDLE)(Vduptr)map->handle);
+    }
+
+    VD_MEMSET(map, 0, sizeof(*map));
+}
+
+#elif VD_PLATFORM_LINUX || VD_PLATFORM_MACOS
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+VD_API int vd_directory_open(VdDirectory *directory, const char *path)
+{
+    DIR *dir = opendir(path);
+    directory->filename = vd_str_from_cstr((char*)path);
+    directory->handle = (void*)dir;
+    return 1;
+}
+
+VD_API int vd_directory_get_file(VdDirectory *directory, VdFile *file)
+{
+    DIR *dir;
+    struct dirent *read_result;
+
+query_file:
+    dir = (DIR*)directory->handle;
+
+    read_result = readdir(dir);
+    if (!read_result) {
+        return 0;
+    }
+
+    file->name = vd_str_from_cstr(read_result->d_name);
+
+    if (vd_str_eq(file->name, VD_LIT(".")) || vd_str_eq(file->name, VD_LIT(".."))) {
+        goto query_file;
+    }
+
+
+    // d_name is relative to the directory, not the working directory
+    char path[4096];
+    Vdusize dir_len = directory->filename.len;
+    if (dir_len + file->name.len + 2 > sizeof(path)) {
+        goto query_file;
+    }
+
+    VD_MEMCPY(path, directory->filename.s, dir_len);
+    if ((dir_len > 0) && (path[dir_len - 1] != '/')) path[dir_len++] = '/';
+    VD_MEMCPY(path + dir_len, file->name.s, file->name.len);
+    path[dir_len + file->name.len] = 0;
+
+    struct stat stat_struct;
+    if (stat(path, &stat_struct) != 0) {
+        goto query_file;
+    }
+
+    file->flags = 0;
+    if (S_ISDIR(stat_struct.st_mode)) {
+        file->flags |= VD_FILE_FLAG_DIRECTORY;
+    }
+
+    return 1;
+}
+
+VD_API int vd_directory_close(VdDirectory *directory)
+{
+    DIR *dir = directory->handle;
+    closedir(dir);
+    return 1;
+}
+
+VD_API Vdb32 vd_file_map_open(VdFileMap *map, Vdcstr path)
+{
+    VD_MEMSET(map, 0, sizeof(*map));
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return VD_FALSE;
+
+    struct stat st;
+    if ((fstat(fd, &st) != 0) || (st.st_size == 0)) {
+        close(fd);
+        return VD_FALSE;
+    }
+
+    void *data = mmap(0, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) return VD_FALSE;
+
+    map->data = data;
+    map->size = (Vdusize)st.st_size;
+    return VD_TRUE;
+}
+
+VD_API void vd_file_map_close(VdFileMap *map)
+{
+    if (map->data) {
+        munmap((void*)map->data, map->size);
+    }
+
+    VD_MEMSET(map, 0, sizeof(*map));
+}
+
+
+#else
+#error "Filesystem implementation not available on this platform"
+#endif // VD_PLATFORM_WINDOWS, else
+
+static void vd_directory__iter_recursive(VdDirectory *directory, char *buf, int buf_len,
+                                         int length_to_searched_directory,
+                                         void (*visit)(VdFile*, void*),
+                                         void *userdata)
+{
+    VdFile file;
+    while (vd_directory_get_file(directory, &file)) {
+
+        if (file.flags & VD_FILE_FLAG_DIRECTORY) {
+            // Construct Path
+            VD_MEMCPY(buf + buf_len, file.name.s, file.name.len);
+            int new_buf_len = buf_len + (int)file.name.len;
+            buf[new_buf_len++] = '/';
+            buf[new_buf_len] = 0;
+
+            VdDirectory new_directory;
+            if (vd_directory_open(&new_directory, buf)) {
+                vd_directory__iter_recursive(&new_directory, buf, new_buf_len, length_to_searched_directory,
+                                             visit, userdata);
+            }
+        } else {
+
+            // Append file.name into buf and call visit
+            VD_MEMCPY(buf + buf_len, file.name.s, file.name.len);
+
+            file.name.s = buf + length_to_searched_directory;
+            file.name.len = file.name.len + buf_len - length_to_searched_directory;
+            visit(&file, userdata);
+        }
+    }
+
+    vd_directory_close(directory);
+}
+
+VD_API void vd_directory_walk_recursively(const char *path, void (*visit)(VdFile*, void*), void *userdata)
+{
+    char buf[256] = {0};
+    int buf_len = 0;
+
+    buf_len = (int)vd_cstr_len((char*)path);
+    VD_MEMCPY(buf, path, buf_len);
+
+    if (buf[buf_len - 1] != '\\' && buf[buf_len - 1] != '/') {
+        buf[buf_len++] = '/';
+    }
+
+    VdDirectory first_directory;
+    if (!vd_directory_open(&first_directory, path)) {
+        return;
+    }
+
+    VdFile file;
+    while (vd_directory_get_file(&first_directory, &file)) {
+
+        if (file.flags & VD_FILE_FLAG_DIRECTORY) {
+            VD_MEMCPY(buf + buf_len, file.name.s, file.name.len);
+            int new_buf_len = buf_len + (int)file.name.len;
+            buf[new_buf_len++] = '/';
+            buf[new_buf_len] = 0;
+
+            VdDirectory new_directory;
+            if (vd_directory_open(&new_directory, buf)) {
+                vd_directory__iter_recursive(&new_directory, buf, new_buf_len, buf_len, visit, userdata);
+            }
+            continue;
+        }
+
+        visit(&file, userdata);
+    }
+
+    vd_directory_close(&first_directory);
+}
+#endif // VD_INCLUDE_PLATFORM_SPECIFIC_FUNCTIONALITY
+
+/* ----ASYNC IO IMPL------------------------------------------------------------------------------------------------- */
+#if VD_INCLUDE_PLATFORM_SPECIFIC_FUNCTIONALITY
+#if VD_PLATFORM_LINUX
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+// IORING_FEAT_RW_CUR_POS arrived with the open/statx/close opcodes (5.6); older headers get the thread pool only
+#if defined(IORING_FEAT_RW_CUR_POS) && defined(__NR_io_uring_setup)
+#define VD__AIO_IO_URING 1
+#endif // defined(IORING_FEAT_RW_CUR_POS) && defined(__NR_io_uring_setup)
+#endif // VD_PLATFORM_LINUX
+
+#ifndef VD__AIO_IO_URING
+#define VD__AIO_IO_URING 0
+#endif // !VD__AIO_IO_URING
+
+#if VD_PLATFORM_WINDOWS
+#include <windows.h>
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif // VD_PLATFORM_WINDOWS, else
+
+#if VD__AIO_IO_URING
+#include <sys/mman.h>
+#include <sys/uio.h>
+
+#define VD__AIO_STATX_SIZE 0x200u
+
+// struct statx, without pulling in <linux/stat.h> next to <sys/stat.h>
+typedef struct {
+    Vdu32 mask;
+    Vdu32 blksize;
+    Vdu64 attributes;
+    Vdu32 nlink;
+    Vdu32 uid;
+    Vdu32 gid;
+    Vdu16 mode;
+    Vdu16 pad0;
+    Vdu64 ino;
+    Vdu64 size;
+    Vdu64 rest[26];
+} Vd__AioStatx;
+#endif // VD__AIO_IO_URING
+
+#define VD__AIO_MAX_IO_SIZE 0x7FFFF000u
+
+struct VdAio {
+    VdAioBackend        backend;
+    Vdu32               queue_depth;
+    /** Handed to the kernel or the workers and not collected yet. */
+    volatile Vdu32      in_flight;
+    VdAioRequest        *queued_head;
+    VdAioRequest        *queued_tail;
+    Vdusize             num_queued;
+    Vdu8                *registered_base;
+    Vdusize             registered_size;
+
+#if VD__AIO_IO_URING
+    int                 ring_fd;
+    Vdu8                *sq_ring;
+    Vdusize             sq_ring_size;
+    Vdu8                *cq_ring;
+    Vdusize             cq_ring_size;
+    struct io_uring_sqe *sqes;
+    Vdusize             sqes_size;
+    Vdu32               *sq_head;
+    Vdu32               *sq_tail;
+    Vdu32               *sq_array;
+    Vdu32               sq_mask;
+    Vdu32               sq_entries;
+    Vdu32               *cq_head;
+    Vdu32               *cq_tail;
+    Vdu32               cq_mask;
+    struct io_uring_cqe *cqes;
+    /** SQEs written but not consumed by io_uring_enter yet. */
+    Vdu32               to_submit;
+    Vd__AioStatx        *statx;
+    Vdu32               *statx_free;
+    Vdu32               num_statx_free;
+#endif // VD__AIO_IO_URING
+
+    volatile Vdu32      work_lock;
+    VdAioRequest        *work_head;
+    VdAioRequest        *work_tail;
+    volatile Vdu32      done_lock;
+    VdAioRequest        *done_head;
+    VdAioRequest        *done_tail;
+    volatile Vdu32      running;
+    Vdu32               num_threads;
+    VdThread            threads[VD_AIO_MAX_THREADS];
+};
+
+static void vd__aio_lock(volatile Vdu32 *lock)
+{
+    while (!vd_atomic_cas_u32(lock, 0, 1)) {
+        while (vd_atomic_load_u32(lock) != 0) vd_cpu_relax();
+    }
+}
+
+static void vd__aio_unlock(volatile Vdu32 *lock)
+{
+    vd_atomic_store_u32(lock, 0);
+}
+
+static Vdusize vd__aio_clamp_size(Vdusize size)
+{
+    return size > VD__AIO_MAX_IO_SIZE ? VD__AIO_MAX_IO_SIZE : size;
+}
+
+// Blocking calls: the thread pool's workers run these
+static void vd__aio_execute(VdAioRequest *r)
+{
+#if VD_PLATFORM_WINDOWS
+    switch (r->op) {
+        case VD_AIO_OP_OPEN: {
+            Vdb32 write = (r->open_flags & VD_AIO_OPEN_WRITE) != 0;
+            HANDLE h = CreateFileA(r->path, write ? GENERIC_WRITE : GENERIC_READ, FILE_SHARE_READ, 0,
+                                   write ? CREATE_ALWAYS : OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+            r->result = (h == INVALID_HANDLE_VALUE) ? -(Vdi64)GetLastError() : (Vdi64)(Vduptr)h;
+        } break;
+
+        case VD_AIO_OP_STAT: {
+            WIN32_FILE_ATTRIBUTE_DATA data;
+            if (GetFileAttributesExA(r->path, GetFileExInfoStandard, &data)) {
+                r->result = (Vdi64)(((Vdu64)data.nFileSizeHigh << 32) | data.nFileSizeLow);
+            } else {
+                r->result = -(Vdi64)GetLastError();
+            }
+        } break;
+
+        case VD_AIO_OP_READ:
+        case VD_AIO_OP_WRITE: {
+            OVERLAPPED ov = {0};
+            ov.Offset     = (DWORD)r->offset;
+            ov.OffsetHigh = (DWORD)(r->offset >> 32);
+            DWORD n = 0;
+            BOOL ok = (r->op == VD_AIO_OP_READ)
+                ? ReadFile((HANDLE)(Vduptr)r->file, r->buf, (DWORD)vd__aio_clamp_size(r->size), &n, &ov)
+                : WriteFile((HANDLE)(Vduptr)r->file, r->buf, (DWORD)vd__aio_clamp_size(r->size), &n, &ov);
+            r->result = (ok || (GetLastError() == ERROR_HANDLE_EOF)) ? (Vdi64)n : -(Vdi64)GetLastError();
+        } break;
+
+        case VD_AIO_OP_CLOSE: {
+            r->result = CloseHandle((HANDLE)(Vduptr)r->file) ? 0 : -(Vdi64)GetLastError();
+        } break;
+    }
+#else
+    switch (r->op) {
+        case VD_AIO_OP_OPEN: {
+            int flags = (r->open_flags & VD_AIO_OPEN_WRITE) ? (O_WRONLY | O_CREAT | O_TRUNC) : O_RDONLY;
+            int fd = open(r->path, flags, 0644);
+            r->result = fd < 0 ? -(Vdi64)errno : (Vdi64)fd;
+        } break;
+
+        case VD_AIO_OP_STAT: {
+            struct stat st;
+            r->result = stat(r->path, &st) == 0 ? (Vdi64)st.st_size : -(Vdi64)errno;
+        } break;
+
+        case VD_AIO_OP_READ:
+        case VD_AIO_OP_WRITE: {
+            Vdusize size = vd__aio_clamp_size(r->size);
+            Vdusize done = 0;
+            while (done < size) {
+                ssize_t n = (r->op == VD_AIO_OP_READ)
+                    ? pread((int)r->file, (Vdu8*)r->buf + done, size - done, (off_t)(r->offset + done))
+                    : pwrite((int)r->file, (Vdu8*)r->buf + done, size - done, (off_t)(r->offset + done));
+                if (n < 0 && errno == EINTR) continue;
+                if (n < 0) {
+                    r->result = -(Vdi64)errno;
+                    return;
+                }
+                if (n == 0) break;
+                done += (Vdusize)n;
+            }
+            r->result = (Vdi64)done;
+        } break;
+
+        case VD_AIO_OP_CLOSE: {
+            r->result = close((int)r->file) == 0 ? 0 : -(Vdi64)errno;
+        } break;
+    }
+#endif // VD_PLATFORM_WINDOWS, else
+}
+
+static VD_PROC_THREAD(vd__aio_worker)
+{
+    VdAio *aio  = (VdAio*)userdata;
+    Vdu32 idle = 0;
+
+    while (vd_atomic_load_u32(&aio->running)) {
+        vd__aio_lock(&aio->work_lock);
+        VdAioRequest *r = aio->work_head;
+        if (r) {
+            aio->work_head = r->next;
+            if (aio->work_head == 0) aio->work_tail = 0;
+        }
+        vd__aio_unlock(&aio->work_lock);
+
+        if (r == 0) {
+            if (++idle < 64) vd_thread_yield();
+            else             vd_thread_sleep_ms(1);
+            continue;
+        }
+
+        idle = 0;
+        vd__aio_execute(r);
+
+        r->next = 0;
+        vd__aio_lock(&aio->done_lock);
+        if (aio->done_tail) aio->done_tail->next = r;
+        else                aio->done_head = r;
+        aio->done_tail = r;
+        vd__aio_unlock(&aio->done_lock);
+    }
+}
+
+static Vdusize vd__aio_threads_push(VdAio *aio)
+{
+    Vdusize count = 0;
+    VdAioRequest *first = 0;
+    VdAioRequest *last  = 0;
+    while (aio->queued_head && (aio->in_flight < aio->queue_depth)) {
+        VdAioRequest *r = aio->queued_head;
+        aio->queued_head = r->next;
+        aio->num_queued--;
+        r->next = 0;
+        if (last) last->next = r;
+        else      first = r;
+        last = r;
+        aio->in_flight++;
+        count++;
+    }
+    if (aio->queued_head == 0) aio->queued_tail = 0;
+
+    if (first) {
+        vd__aio_lock(&aio->work_lock);
+        if (aio->work_tail) aio->work_tail->next = first;
+        else                aio->work_head = first;
+        aio->work_tail = last;
+        vd__aio_unlock(&aio->work_lock);
+    }
+    return count;
+}
+
+static Vdusize vd__aio_threads_reap(VdAio *aio, VdAioRequest **completed, Vdusize max)
+{
+    Vdusize n = 0;
+    vd__aio_lock(&aio->done_lock);
+    while (aio->done_head && (n < max)) {
+        VdAioRequest *r = aio->done_head;
+        aio->done_head = r->next;
+        completed[n++] = r;
+    }
+    if (aio->done_head == 0) aio->done_tail = 0;
+    vd__aio_unlock(&aio->done_lock);
+
+    aio->in_flight -= (Vdu32)n;
+    return n;
+}
+
+#if VD__AIO_IO_URING
+static Vdb32 vd__aio_uring_init(VdAio *aio, Vdu32 entries)
+{
+    struct io_uring_params p;
+    VD_MEMSET(&p, 0, sizeof(p));
+    int fd = (int)syscall(__NR_io_uring_setup, entries, &p);
+    if (fd < 0) return VD_FALSE;
+
+    // Check for every opcode we use, so a 5.1 kernel falls back instead of failing requests
+    Vdu64 probe_storage[(sizeof(struct io_uring_probe) + 256 * sizeof(struct io_uring_probe_op)) / 8 + 1];
+    struct io_uring_probe *probe = (struct io_uring_probe*)probe_storage;
+    VD_MEMSET(probe_storage, 0, sizeof(probe_storage));
+    if (syscall(__NR_io_uring_register, fd, IORING_REGISTER_PROBE, probe, 256) < 0) {
+        close(fd);
+        return VD_FALSE;
+    }
+
+    static const Vdu8 needed[] = {
+        IORING_OP_OPENAT, IORING_OP_STATX, IORING_OP_READ, IORING_OP_WRITE, IORING_OP_READ_FIXED,
+        IORING_OP_WRITE_FIXED, IORING_OP_CLOSE,
+    };
+    for (Vdusize i = 0; i < VD_ARRAY_COUNT(needed); ++i) {
+        if ((needed[i] > probe->last_op) || !(probe->ops[needed[i]].flags & IO_URING_OP_SUPPORTED)) {
+            close(fd);
+            return VD_FALSE;
+        }
+    }
+
+    aio->sq_ring_size = p.sq_off.array + p.sq_entries * sizeof(Vdu32);
+    aio->cq_ring_size = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    if (p.features & IORING_FEAT_SINGLE_MMAP) {
+        if (aio->cq_ring_size > aio->sq_ring_size) aio->sq_ring_size = aio->cq_ring_size;
+        aio->cq_ring_size = aio->sq_ring_size;
+    }
+
+    void *sq_ring = mmap(0, aio->sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+                         IORING_OFF_SQ_RING);
+    if (sq_ring == MAP_FAILED) {
+        close(fd);
+        return VD_FALSE;
+    }
+
+    void *cq_ring = sq_ring;
+    if (!(p.features & IORING_FEAT_SINGLE_MMAP)) {
+        cq_ring = mmap(0, aio->cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+                       IORING_OFF_CQ_RING);
+        if (cq_ring == MAP_FAILED) {
+            munmap(sq_ring, aio->sq_ring_size);
+            close(fd);
+            return VD_FALSE;
+        }
+    }
+
+    aio->sqes_size = p.sq_entries * sizeof(struct io_uring_sqe);
+    void *sqes = mmap(0, aio->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) {
+        if (cq_ring != sq_ring) munmap(cq_ring, aio->cq_ring_size);
+        munmap(sq_ring, aio->sq_ring_size);
+        close(fd);
+        return VD_FALSE;
+    }
+
+    aio->ring_fd    = fd;
+    aio->sq_ring    = (Vdu8*)sq_ring;
+    aio->cq_ring    = (Vdu8*)cq_ring;
+    aio->sqes       = (struct io_uring_sqe*)sqes;
+    aio->sq_head    = (Vdu32*)(aio->sq_ring + p.sq_off.head);
+    aio->sq_tail    = (Vdu32*)(aio->sq_ring + p.sq_off.tail);
+    aio->sq_array   = (Vdu32*)(aio->sq_ring + p.sq_off.array);
+    aio->sq_mask    = *(Vdu32*)(aio->sq_ring + p.sq_off.ring_mask);
+    aio->sq_entries = p.sq_entries;
+    aio->cq_head    = (Vdu32*)(aio->cq_ring + p.cq_off.head);
+    aio->cq_tail    = (Vdu32*)(aio->cq_ring + p.cq_off.tail);
+    aio->cq_mask    = *(Vdu32*)(aio->cq_ring + p.cq_off.ring_mask);
+    aio->cqes       = (struct io_uring_cqe*)(aio->cq_ring + p.cq_off.cqes);
+
+    // At most sq_entries in flight: the completion queue (twice as large) can never overflow, and every STAT
+    // in flight has a statx buffer.
+    aio->queue_depth    = p.sq_entries;
+    aio->statx          = (Vd__AioStatx*)VD_MALLOC(sizeof(Vd__AioStatx) * p.sq_entries);
+    aio->statx_free     = (Vdu32*)VD_MALLOC(sizeof(Vdu32) * p.sq_entries);
+    aio->num_statx_free = p.sq_entries;
+    for (Vdu32 i = 0; i < p.sq_entries; ++i) aio->statx_free[i] = i;
+    return VD_TRUE;
+}
+
+static void vd__aio_uring_deinit(VdAio *aio)
+{
+    munmap(aio->sqes, aio->sqes_size);
+    if (aio->cq_ring != aio->sq_ring) munmap(aio->cq_ring, aio->cq_ring_size);
+    munmap(aio->sq_ring, aio->sq_ring_size);
+    close(aio->ring_fd);
+    VD_FREE(aio->statx, sizeof(Vd__AioStatx) * aio->queue_depth);
+    VD_FREE(aio->statx_free, sizeof(Vdu32) * aio->queue_depth);
+}
+
+static Vdb32 vd__aio_uring_is_registered(VdAio *aio, void *buf, Vdusize size)
+{
+    Vdu8 *p = (Vdu8*)buf;
+    return (aio->registered_size != 0) && (p >= aio->registered_base) &&
+           (p + size <= aio->registered_base + aio->registered_size);
+}
+
+static void vd__aio_uring_prep(VdAio *aio, struct io_uring_sqe *sqe, VdAioRequest *r)
+{
+    VD_MEMSET(sqe, 0, sizeof(*sqe));
+    sqe->user_data = (Vdu64)(Vduptr)r;
+
+    switch (r->op) {
+        case VD_AIO_OP_OPEN: {
+            sqe->opcode     = IORING_OP_OPENAT;
+            sqe->fd         = AT_FDCWD;
+            sqe->addr       = (Vdu64)(Vduptr)r->path;
+            sqe->len        = 0644;
+            sqe->open_flags = (r->open_flags & VD_AIO_OPEN_WRITE) ? (O_WRONLY | O_CREAT | O_TRUNC) : O_RDONLY;
+        } break;
+
+        case VD_AIO_OP_STAT: {
+            VD_ASSERT(aio->num_statx_free > 0);
+            r->slot          = aio->statx_free[--aio->num_statx_free];
+            sqe->opcode      = IORING_OP_STATX;
+            sqe->fd          = AT_FDCWD;
+            sqe->addr        = (Vdu64)(Vduptr)r->path;
+            sqe->len         = VD__AIO_STATX_SIZE;
+            sqe->off         = (Vdu64)(Vduptr)&aio->statx[r->slot];
+        } break;
+
+        case VD_AIO_OP_READ:
+        case VD_AIO_OP_WRITE: {
+            Vdusize size  = vd__aio_clamp_size(r->size);
+            Vdb32   fixed = vd__aio_uring_is_registered(aio, r->buf, size);
+            if (r->op == VD_AIO_OP_READ) sqe->opcode = fixed ? IORING_OP_READ_FIXED  : IORING_OP_READ;
+            else                         sqe->opcode = fixed ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE;
+            sqe->fd        = (int)r->file;
+            sqe->addr      = (Vdu64)(Vduptr)r->buf;
+            sqe->len       = (Vdu32)size;
+            sqe->off       = r->offset;
+            sqe->buf_index = 0;
+        } break;
+
+        case VD_AIO_OP_CLOSE: {
+            sqe->opcode = IORING_OP_CLOSE;
+            sqe->fd     = (int)r->file;
+        } break;
+    }
+}
+
+static Vdusize vd__aio_uring_push(VdAio *aio)
+{
+    Vdu32   tail  = *aio->sq_tail;
+    Vdu32   head  = vd_atomic_load_u32(aio->sq_head);
+    Vdusize count = 0;
+
+    while (aio->queued_head && (aio->in_flight < aio->queue_depth) && ((tail - head) < aio->sq_entries)) {
+        VdAioRequest *r = aio->queued_head;
+        aio->queued_head = r->next;
+        aio->num_queued--;
+
+        Vdu32 index = tail & aio->sq_mask;
+        vd__aio_uring_prep(aio, &aio->sqes[index], r);
+        aio->sq_array[index] = index;
+        tail++;
+        aio->in_flight++;
+        aio->to_submit++;
+        count++;
+    }
+    if (aio->queued_head == 0) aio->queued_tail = 0;
+
+    vd_atomic_store_u32(aio->sq_tail, tail);
+    return count;
+}
+
+static void vd__aio_uring_enter(VdAio *aio, Vdu32 min_complete)
+{
+    if ((aio->to_submit == 0) && (min_complete == 0)) return;
+
+    for (;;) {
+        long n = syscall(__NR_io_uring_enter, aio->ring_fd, aio->to_submit, min_complete,
+                         min_complete ? IORING_ENTER_GETEVENTS : 0, 0, 0);
+        if (n >= 0) {
+            aio->to_submit -= (Vdu32)n;
+            return;
+        }
+
+        // EAGAIN/EBUSY: the kernel wants completions collected first, which the caller does next
+        if (errno != EINTR) return;
+    }
+}
+
+static Vdusize vd__aio_uring_reap(VdAio *aio, VdAioRequest **completed, Vdusize max)
+{
+    Vdu32   head = *aio->cq_head;
+    Vdu32   tail = vd_atomic_load_u32(aio->cq_tail);
+    Vdusize n    = 0;
+
+    while ((head != tail) && (n < max)) {
+        struct io_uring_cqe *cqe = &aio->cqes[head & aio->cq_mask];
+        VdAioRequest *r = (VdAioRequest*)(Vduptr)cqe->user_data;
+        r->result = cqe->res;
+        if (r->op == VD_AIO_OP_STAT) {
+            if (r->result >= 0) r->result = (Vdi64)aio->statx[r->slot].size;
+            aio->statx_free[aio->num_statx_free++] = r->slot;
+        }
+
+        completed[n++] = r;
+        head++;
+    }
+
+    vd_atomic_store_u32(aio->cq_head, head);
+    aio->in_flight -= (Vdu32)n;
+    return n;
+}
+#endif // VD__AIO_IO_URING
+
+VD_API VdAio *vd_aio_create(VdAioInitInfo *info)
+{
+    Vdu32 queue_depth = (info && info->queue_depth) ? info->queue_depth : 256;
+    Vdu32 num_threads = (info && info->num_threads) ? info->num_threads : 4;
+    if (num_threads > VD_AIO_MAX_THREADS) num_threads = VD_AIO_MAX_THREADS;
+
+    VdAio *aio = (VdAio*)VD_MALLOC(sizeof(VdAio));
+    VD_MEMSET(aio, 0, sizeof(*aio));
+
+#if VD__AIO_IO_URING
+    if (!(info && info->force_threads) && vd__aio_uring_init(aio, queue_depth)) {
+        aio->backend = VD_AIO_BACKEND_IO_URING;
+        return aio;
+    }
+#endif // VD__AIO_IO_URING
+
+    aio->backend     = VD_AIO_BACKEND_THREADS;
+    aio->queue_depth = queue_depth;
+    aio->running     = 1;
+    for (Vdu32 i = 0; i < num_threads; ++i) {
+        if (!vd_thread_create(&aio->threads[i], vd__aio_worker, aio)) break;
+        aio->num_threads++;
+    }
+
+    if (aio->num_threads == 0) {
+        VD_FREE(aio, sizeof(VdAio));
+        return 0;
+    }
+
+    return aio;
+}
+
+VD_API void vd_aio_destroy(VdAio *aio)
+{
+    VdAioRequest *sink[64];
+    while (vd_aio_outstanding(aio) > 0) vd_aio_wait(aio, sink, VD_ARRAY_COUNT(sink), 1);
+
+#if VD__AIO_IO_URING
+    if (aio->backend == VD_AIO_BACKEND_IO_URING) {
+        vd__aio_uring_deinit(aio);
+    }
+#endif // VD__AIO_IO_URING
+
+    vd_atomic_store_u32(&aio->running, 0);
+    for (Vdu32 i = 0; i < aio->num_threads; ++i) vd_thread_join(&aio->threads[i]);
+    VD_FREE(aio, sizeof(VdAio));
+}
+
+VD_API VdAioBackend vd_aio_get_backend(VdAio *aio)
+{
+    return aio->backend;
+}
+
+VD_API Vdb32 vd_aio_register_buffer(VdAio *aio, void *base, Vdusize size)
+{
+    VD_ASSERT(aio->in_flight == 0);
+
+#if VD__AIO_IO_URING
+    if (aio->backend == VD_AIO_BACKEND_IO_URING) {
+        if (aio->registered_size != 0) {
+            syscall(__NR_io_uring_register, aio->ring_fd, IORING_UNREGISTER_BUFFERS, 0, 0);
+        }
+
+        aio->registered_base = 0;
+        aio->registered_size = 0;
+        if ((base == 0) || (size == 0)) return VD_TRUE;
+
+        struct iovec iov;
+        iov.iov_base = base;
+        iov.iov_len  = size;
+        if (syscall(__NR_io_uring_register, aio->ring_fd, IORING_REGISTER_BUFFERS, &iov, 1) < 0) return VD_FALSE;
+
+        aio->registered_base = (Vdu8*)base;
+        aio->registered_size = size;
+        return VD_TRUE;
+    }
+#endif // VD__AIO_IO_URING
+
+    VD_UNUSED(base);
+    VD_UNUSED(size);
+    return VD_FALSE;
+}
+
+VD_API void vd_aio_queue(VdAio *aio, VdAioRequest *request)
+{
+    request->next   = 0;
+    request->result = 0;
+    if (aio->queued_tail) aio->queued_tail->next = request;
+    else                  aio->queued_head = request;
+    aio->queued_tail = request;
+    aio->num_queued++;
+}
+
+static Vdusize vd__aio_push(VdAio *aio)
+{
+#if VD__AIO_IO_URING
+    if (aio->backend == VD_AIO_BACKEND_IO_URING) return vd__aio_uring_push(aio);
+#endif // VD__AIO_IO_URING
+    return vd__aio_threads_push(aio);
+}
+
+static Vdusize vd__aio_reap(VdAio *aio, VdAioRequest **completed, Vdusize max)
+{
+#if VD__AIO_IO_URING
+    if (aio->backend == VD_AIO_BACKEND_IO_URING) return vd__aio_uring_reap(aio, completed, max);
+#endif // VD__AIO_IO_URING
+    return vd__aio_threads_reap(aio, completed, max);
+}
+
+VD_API Vdusize vd_aio_submit(VdAio *aio)
+{
+    Vdusize count = vd__aio_push(aio);
+#if VD__AIO_IO_URING
+    if (aio->backend == VD_AIO_BACKEND_IO_URING) vd__aio_uring_enter(aio, 0);
+#endif // VD__AIO_IO_URING
+    return count;
+}
+
+VD_API Vdusize vd_aio_poll(VdAio *aio, VdAioRequest **completed, Vdusize max)
+{
+    return vd_aio_wait(aio, completed, max, 0);
+}
+
+VD_API Vdusize vd_aio_wait(VdAio *aio, VdAioRequest **completed, Vdusize max, Vdusize min)
+{
+    if (min > max) min = max;
+
+    Vdusize n = 0;
+    for (;;) {
+        vd__aio_push(aio);
+        n += vd__aio_reap(aio, completed + n, max - n);
+        Vdb32 done = (n >= min) || (vd_aio_outstanding(aio) == 0);
+
+#if VD__AIO_IO_URING
+        if (aio->backend == VD_AIO_BACKEND_IO_URING) {
+            // Submits whatever the push added, and sleeps in the kernel for a completion when we need more
+            vd__aio_uring_enter(aio, (done || (aio->in_flight == 0)) ? 0 : 1);
+            if (done) return n;
+            continue;
+        }
+#endif // VD__AIO_IO_URING
+
+        if (done) return n;
+        vd_thread_yield();
+    }
+}
+
+VD_API Vdusize vd_aio_outstanding(VdAio *aio)
+{
+    return aio->num_queued + aio->in_flight;
+}
+
+typedef struct {
+    Vdusize      index;
+    Vdu32        waiting;
+    VdAioRequest open;
+    VdAioRequest stat;
+    VdAioRequest read;
+    VdAioRequest close;
+} Vd__AioFileSlot;
+
+static void vd__aio_file_slot_close(VdAio *aio, Vd__AioFileSlot *slot)
+{
+    slot->close.op       = VD_AIO_OP_CLOSE;
+    slot->close.file     = slot->open.result;
+    slot->close.userdata = slot;
+    vd_aio_queue(aio, &slot->close);
+}
+
+VD_API Vdusize vd_aio_read_files(VdAio *aio, VdArena *arena, Vdcstr *paths, Vdusize count, VdAioFileData *out)
+{
+    // Each file has up to two requests in flight (open and stat together), so a quarter of the queue keeps it full
+    // without running into the open file limit.
+    Vdu32 num_slots = aio->queue_depth / 4;
+    if (num_slots == 0) num_slots = 1;
+
+    Vd__AioFileSlot  *slots      = (Vd__AioFileSlot*)VD_MALLOC(sizeof(Vd__AioFileSlot) * num_slots);
+    Vd__AioFileSlot **free_slots = (Vd__AioFileSlot**)VD_MALLOC(sizeof(Vd__AioFileSlot*) * num_slots);
+    VdAioRequest    **completed  = (VdAioRequest**)VD_MALLOC(sizeof(VdAioRequest*) * aio->queue_depth);
+    for (Vdu32 i = 0; i < num_slots; ++i) free_slots[i] = &slots[num_slots - 1 - i];
+
+    Vdu32   num_free = num_slots;
+    Vdusize next     = 0;
+    Vdusize loaded   = 0;
+
+    while ((next < count) || (num_free < num_slots)) {
+        while ((next < count) && (num_free > 0)) {
+            Vd__AioFileSlot *slot = free_slots[--num_free];
+            VD_MEMSET(slot, 0, sizeof(*slot));
+            VD_MEMSET(&out[next], 0, sizeof(out[next]));
+            slot->index   = next;
+            slot->waiting = 2;
+
+            slot->open.op       = VD_AIO_OP_OPEN;
+            slot->open.path     = paths[next];
+            slot->open.userdata = slot;
+            slot->stat.op       = VD_AIO_OP_STAT;
+            slot->stat.path     = paths[next];
+            slot->stat.userdata = slot;
+            vd_aio_queue(aio, &slot->open);
+            vd_aio_queue(aio, &slot->stat);
+            next++;
+        }
+
+        Vdusize num_completed = vd_aio_wait(aio, completed, aio->queue_depth, 1);
+        for (Vdusize i = 0; i < num_completed; ++i) {
+            VdAioRequest    *r    = completed[i];
+            Vd__AioFileSlot *slot = (Vd__AioFileSlot*)r->userdata;
+            VdAioFileData   *file = &out[slot->index];
+
+            if ((r == &slot->open) || (r == &slot->stat)) {
+                if (--slot->waiting > 0) continue;
+
+                if (slot->open.result < 0) {
+                    file->error = slot->open.result;
+                    free_slots[num_free++] = slot;
+                    continue;
+                }
+
+                if (slot->stat.result < 0) {
+                    file->error = slot->stat.result;
+                } else if (slot->stat.result > 0) {
+                    file->size = (Vdusize)slot->stat.result;
+                    file->data = (Vdu8*)vd_arena_alloc(arena, file->size);
+
+                    slot->read.op       = VD_AIO_OP_READ;
+                    slot->read.file     = slot->open.result;
+                    slot->read.buf      = file->data;
+                    slot->read.size     = file->size;
+                    slot->read.userdata = slot;
+                    vd_aio_queue(aio, &slot->read);
+                    continue;
+                }
+
+                vd__aio_file_slot_close(aio, slot);
+            } else if (r == &slot->read) {
+                if (r->result < 0) file->error = r->result;
+                else               file->size  = (Vdusize)r->result;
+                vd__aio_file_slot_close(aio, slot);
+            } else {
+                if (file->error == 0) loaded++;
+                free_slots[num_free++] = slot;
+            }
+        }
+    }
+
+    VD_FREE(completed, sizeof(VdAioRequest*) * aio->queue_depth);
+    VD_FREE(free_slots, sizeof(Vd__AioFileSlot*) * num_slots);
+    VD_FREE(slots, sizeof(Vd__AioFileSlot) * num_slots);
+    return loaded;
+}
+#endif // VD_INCLUDE_PLATFORM_SPECIFIC_FUNCTIONALITY
+
+/* ----PACK IMPL----------------------------------------------------------------------------------------------------- */
+typedef struct {
+    Vdu32   entry;
+    Vdu32   size;
+    Vdusize src_offset;
+    /** Room for a block written with vd_lz_frame_write_block: size + 8 bytes. */
+    Vdu8    *dst;
+    Vdusize dst_len;
+} Vd__PackBlock;
+
+typedef struct {
+    VdPackSource   *sources;
+    Vd__PackBlock  *blocks;
+    Vdu32          num_blocks;
+    volatile Vdu32 next;
+} Vd__PackBuildJob;
+
+static VD_PROC_THREAD(vd__pack_compress_thread)
+{
+    Vd__PackBuildJob *job = (Vd__PackBuildJob*)userdata;
+
+    // Entries vary wildly in size, so blocks are handed out one at a time instead of in fixed ranges
+    for (;;) {
+        Vdu32 i = vd_atomic_fetch_add_u32(&job->next, 1);
+        if (i >= job->num_blocks) break;
+
+        Vd__PackBlock *block = &job->blocks[i];
+        const Vdu8    *src   = (const Vdu8*)job->sources[block->entry].data + block->src_offset;
+        block->dst_len = vd_lz_frame_write_block(src, block->size, block->dst, (Vdusize)block->size + 8);
+    }
+}
+
+static Vdu32 vd__pack_checksum(Vdu32 kind, const void *data, Vdu64 size)
+{
+    switch (kind) {
+        case VD_PACK_CHECKSUM_HASH32: return (Vdu32)vd_dhash64(data, size);
+        case VD_PACK_CHECKSUM_CRC32C: return vd_crc32c(0, data, (Vdusize)size);
+        default:                      return 0;
+    }
+}
+
+static Vdu64 vd__pack_align(Vdu64 x)
+{
+    return (x + VD_PACK_DATA_ALIGN - 1) & ~(Vdu64)(VD_PACK_DATA_ALIGN - 1);
+}
+
+VD_API void *vd_pack_build(VdArena *a, VdArena *scratch, VdPackSource *sources, Vdu32 count,
+                           VdPackBuildFlags flags, Vdu32 num_threads, Vdusize *size)
+{
+    VdArenaSave save = vd_arena_save(scratch);
+
+    VD_STRMAP VdPackEntry *directory = 0;
+    VD_STRMAP_INIT(directory, scratch, count + count / 4 + 8, 0);
+
+    VdPackEntry empty = {0};
+    for (Vdu32 i = 0; i < count; ++i) {
+        if (!VD_STRMAP_SET(directory, sources[i].name, &empty)) {
+            vd_arena_restore(save);
+            return 0;
+        }
+    }
+
+    // Split every entry into frame blocks, so that large entries get compressed in parallel too
+    Vdu32 num_blocks = 0;
+    if (flags & VD_PACK_BUILD_COMPRESS) {
+        for (Vdu32 i = 0; i < count; ++i) {
+            num_blocks += (Vdu32)((sources[i].size + VD_LZ_FRAME_BLOCK_SIZE - 1) / VD_LZ_FRAME_BLOCK_SIZE);
+        }
+    }
+
+    Vd__PackBlock *blocks      = VD_ARENA_PUSH_ARRAY(scratch, Vd__PackBlock, num_blocks + 1);
+    Vdu32         *first_block = VD_ARENA_PUSH_ARRAY(scratch, Vdu32, count + 1);
+    Vdu32         block_cursor = 0;
+    for (Vdu32 i = 0; i < count; ++i) {
+        first_block[i] = block_cursor;
+        if (!(flags & VD_PACK_BUILD_COMPRESS)) continue;
+
+        for (Vdusize at = 0; at < sources[i].size; at += VD_LZ_FRAME_BLOCK_SIZE) {
+            Vd__PackBlock *block = &blocks[block_cursor++];
+            block->entry      = i;
+            block->size       = (Vdu32)((sources[i].size - at < VD_LZ_FRAME_BLOCK_SIZE)
+                                        ? sources[i].size - at : VD_LZ_FRAME_BLOCK_SIZE);
+            block->src_offset = at;
+            block->dst        = (Vdu8*)vd_arena_alloc(scratch, (Vdusize)block->size + 8);
+            block->dst_len    = 0;
+        }
+    }
+    first_block[count] = block_cursor;
+
+    if (num_blocks > 0) {
+        Vd__PackBuildJob job;
+        job.sources    = sources;
+        job.blocks     = blocks;
+        job.num_blocks = num_blocks;
+        job.next       = 0;
+
+        if (num_threads == 0)                  num_threads = vd_get_num_cpus();
+        if (num_threads > VD_PACK_MAX_THREADS) num_threads = VD_PACK_MAX_THREADS;
+        if (num_threads > num_blocks)          num_threads = num_blocks;
+
+        // Workers pull blocks until none are left, so a thread that fails to start only means fewer workers
+        VdThread threads[VD_PACK_MAX_THREADS];
+        Vdb32    started[VD_PACK_MAX_THREADS];
+        for (Vdu32 t = 1; t < num_threads; ++t) {
+            started[t] = vd_thread_create(&threads[t], vd__pack_compress_thread, &job);
+        }
+
+        vd__pack_compress_thread(&job);
+
+        for (Vdu32 t = 1; t < num_threads; ++t) {
+            if (started[t]) vd_thread_join(&threads[t]);
+        }
+    }
+
+    // Lay out the pack. The directory's size only depends on the names, so it can be measured before the entries
+    // are filled in.
+    VdPackEntry *entries        = VD_ARENA_PUSH_ARRAY(scratch, VdPackEntry, count + 1);
+    Vdu64       directory_size  = vd_strmap_image_size(directory);
+    Vdu64       data_offset     = vd__pack_align(sizeof(VdPackHeader) + directory_size);
+    Vdu64       cursor          = data_offset;
+    for (Vdu32 i = 0; i < count; ++i) {
+        Vdu64 frame_size = sizeof(VdLzFrameHeader) + 4;
+        for (Vdu32 b = first_block[i]; b < first_block[i + 1]; ++b) frame_size += blocks[b].dst_len;
+
+        VdPackEntry *e = &entries[i];
+        e->raw_size    = sources[i].size;
+        e->compression = (first_block[i + 1] > first_block[i]) && (frame_size < sources[i].size)
+                            ? VD_PACK_COMPRESSION_LZ
+                            : VD_PACK_COMPRESSION_NONE;
+        e->size        = e->compression == VD_PACK_COMPRESSION_LZ ? frame_size : sources[i].size;
+        e->offset      = cursor;
+        e->checksum    = 0;
+        cursor         = vd__pack_align(cursor + e->size);
+    }
+
+    Vdu8 *image = (Vdu8*)vd_arena_alloc_align(a, (Vdusize)cursor, VD_PACK_DATA_ALIGN);
+    VD_MEMSET(image, 0, (Vdusize)cursor);
+
+    VdPackHeader *h     = (VdPackHeader*)image;
+    h->magic            = VD_PACK_MAGIC;
+    h->version          = VD_PACK_VERSION;
+    h->count            = count;
+    h->checksum         = (flags & VD_PACK_BUILD_CHECKSUMS) ? VD_PACK_CHECKSUM_CRC32C : VD_PACK_CHECKSUM_NONE;
+    h->directory_offset = sizeof(VdPackHeader);
+    h->directory_size   = directory_size;
+    h->data_offset      = data_offset;
+    h->total_size       = cursor;
+
+    for (Vdu32 i = 0; i < count; ++i) {
+        VdPackEntry *e   = &entries[i];
+        Vdu8        *dst = image + e->offset;
+
+        if (e->compression == VD_PACK_COMPRESSION_LZ) {
+            Vdusize at = vd_lz_frame_write_header(dst, (Vdusize)e->size, e->raw_size);
+            for (Vdu32 b = first_block[i]; b < first_block[i + 1]; ++b) {
+                VD_MEMCPY(dst + at, blocks[b].dst, blocks[b].dst_len);
+                at += blocks[b].dst_len;
+            }
+            vd_lz_frame_write_end(dst + at, (Vdusize)e->size - at);
+        } else if (e->size > 0) {
+            VD_MEMCPY(dst, sources[i].data, (Vdusize)e->size);
+        }
+
+        e->checksum = vd__pack_checksum(h->checksum, dst, e->size);
+        *(VdPackEntry*)VD_STRMAP_GET_PTR(directory, sources[i].name) = *e;
+    }
+
+    vd_strmap_image_write(directory, image + h->directory_offset, (Vdusize)directory_size);
+    if (size) *size = (Vdusize)cursor;
+
+    vd_arena_restore(save);
+    return image;
+}
+
+VD_API VdPackStatus vd_pack_open_memory(VdPack *pack, const void *data, Vdusize size)
+{
+    const VdPackHeader *h = (const VdPackHeader*)data;
+    if (size < sizeof(VdPackHeader))  return VD_PACK_ERROR_TOO_SMALL;
+    if (h->magic != VD_PACK_MAGIC)     return VD_PACK_ERROR_BAD_MAGIC;
+    if (h->version != VD_PACK_VERSION) return VD_PACK_ERROR_BAD_VERSION;
+    if (h->total_size > size)          return VD_PACK_ERROR_TOO_SMALL;
+
+    if ((h->directory_offset < sizeof(VdPackHeader)) ||
+        (h->directory_offset + h->directory_size > h->data_offset) ||
+        (h->data_offset > h->total_size))
+    {
+        return VD_PACK_ERROR_CORRUPT;
+    }
+
+    VdMapImageStatus status = vd_strmap_image_open(&pack->directory, (const Vdu8*)data + h->directory_offset,
+                                                   (Vdusize)h->directory_size);
+    if (status == VD_MAP_IMAGE_ERROR_HASH_MISMATCH) return VD_PACK_ERROR_HASH_MISMATCH;
+    if (status != VD_MAP_IMAGE_OK)                  return VD_PACK_ERROR_CORRUPT;
+
+    if ((pack->directory.header->vsize != sizeof(VdPackEntry)) || (VD_MAP_IMAGE_COUNT(&pack->directory) != h->count)) {
+        return VD_PACK_ERROR_CORRUPT;
+    }
+
+    pack->header = h;
+    pack->data   = (const Vdu8*)data;
+    return VD_PACK_OK;
+}
+
+#if VD_INCLUDE_PLATFORM_SPECIFIC_FUNCTIONALITY
+VD_API VdPackStatus vd_pack_open(VdPack *pack, Vdcstr path)
+{
+    VD_MEMSET(pack, 0, sizeof(*pack));
+
+    VdFileMap file;
+    if (!vd_file_map_open(&file, path)) return VD_PACK_ERROR_OPEN_FAILED;
+
+    VdPackStatus status = vd_pack_open_memory(pack, file.data, file.size);
+    if (status != VD_PACK_OK) {
+        vd_file_map_close(&file);
+        return status;
+    }
+
+    pack->file = file;
+    return VD_PACK_OK;
+}
+#endif // VD_INCLUDE_PLATFORM_SPECIFIC_FUNCTIONALITY
+
+VD_API void vd_pack_close(VdPack *pack)
+{
+#if VD_INCLUDE_PLATFORM_SPECIFIC_FUNCTIONALITY
+    if (pack->file.data) vd_file_map_close(&pack->file);
+#endif // VD_INCLUDE_PLATFORM_SPECIFIC_FUNCTIONALITY
+
+    VD_MEMSET(pack, 0, sizeof(*pack));
+}
+
+VD_API const VdPackEntry *vd_pack_find(VdPack *pack, VdStr name)
+{
+    return (const VdPackEntry*)vd_strmap_image_get_ptr(&pack->directory, name);
+}
+
+VD_API const void *vd_pack_entry_bytes(VdPack *pack, const VdPackEntry *entry)
+{
+    return pack->data + entry->offset;
+}
+
+VD_API VdPackStatus vd_pack_read(VdPack *pack, const VdPackEntry *entry, void *dst, Vdusize dst_cap)
+{
+    const VdPackHeader *h = pack->header;
+    if ((entry->offset < h->data_offset) || (entry->offset > h->total_size) ||
+        (entry->size > h->total_size - entry->offset))
+    {
+        return VD_PACK_ERROR_CORRUPT;
+    }
+
+    if (dst_cap < entry->raw_size) return VD_PACK_ERROR_DST_TOO_SMALL;
+
+    const Vdu8 *src = pack->data + entry->offset;
+    if ((h->checksum != VD_PACK_CHECKSUM_NONE) && (vd__pack_checksum(h->checksum, src, entry->size) != entry->checksum)) {
+        return VD_PACK_ERROR_CHECKSUM_MISMATCH;
+    }
+
+    switch (entry->compression) {
+        case VD_PACK_COMPRESSION_NONE: {
+            if (entry->size != entry->raw_size) return VD_PACK_ERROR_CORRUPT;
+            if (entry->size > 0) VD_MEMCPY(dst, src, (Vdusize)entry->size);
+        } break;
+
+        case VD_PACK_COMPRESSION_LZ: {
+            Vdusize len = 0;
+            if ((vd_lz_frame_decompress(src, (Vdusize)entry->size, dst, dst_cap, &len) != VD_LZ_OK) ||
+                (len != entry->raw_size))
+            {
+                return VD_PACK_ERROR_CORRUPT;
+            }
+        } break;
+
+        default: return VD_PACK_ERROR_CORRUPT;
+    }
+
+    return VD_PACK_OK;
+}
+
+VD_API void *vd_pack_read_arena(VdArena *a, VdPack *pack, const VdPackEntry *entry, Vdusize *len)
+{
+    VdArenaSave save   = vd_arena_save(a);
+    void        *result = vd_arena_alloc(a, (Vdusize)entry->raw_size);
+
+    if (vd_pack_read(pack, entry, result, (Vdusize)entry->raw_size) != VD_PACK_OK) {
+        vd_arena_restore(save);
+        return 0;
+    }
+
+    if (len) *len = (Vdusize)entry->raw_size;
+    return result;
+}
+
+VD_API Vdcstr vd_pack_status_to_cstr(VdPackStatus status)
+{
+    switch (status) {
+        case VD_PACK_OK:                      return "OK";
+        case VD_PACK_ERROR_OPEN_FAILED:       return "Pack file could not be opened";
+        case VD_PACK_ERROR_TOO_SMALL:         return "Pack is truncated";
+        case VD_PACK_ERROR_BAD_MAGIC:         return "Not a pack";
+        case VD_PACK_ERROR_BAD_VERSION:       return "Unsupported pack version";
+        case VD_PACK_ERROR_HASH_MISMATCH:     return "Pack was written with a different hash function or seed";
+        case VD_PACK_ERROR_CORRUPT:           return "Pack is corrupt";
+        case VD_PACK_ERROR_CHECKSUM_MISMATCH: return "Pack entry failed its checksum";
+        case VD_PACK_ERROR_DST_TOO_SMALL:     return "Destination buffer is too small";
+        default:                              return "Unknown";
+    }
+}
+
+/* ----FIBER IMPL---------------------------------------------------------------------------------------------------- */
+#if VD_FIBER_SUPPORTED
+static VD_THREAD_LOCAL VdFiber *Vd__Fiber_Current;
+
+// Not inlined, so the thread-local's address isn't cached across a switch that moved the fiber to another thread
+#if VD_HOST_COMPILER_MSVC
+static __declspec(noinline) VdFiber *vd__fiber_get_current(void)     { return Vd__Fiber_Current; }
+static __declspec(noinline) void     vd__fiber_set_current(VdFiber *f) { Vd__Fiber_Current = f; }
+#else
+static __attribute__((noinline)) VdFiber *vd__fiber_get_current(void)     { return Vd__Fiber_Current; }
+static __attribute__((noinline)) void     vd__fiber_set_current(VdFiber *f) { Vd__Fiber_Current = f; }
+#endif // VD_HOST_COMPILER_MSVC
+
+static void vd__fiber_main(VdFiber *fiber);
+
+#if VD_PLATFORM_WINDOWS
+static VOID WINAPI vd__fiber_win32_start(LPVOID param)
+{
+    vd__fiber_main((VdFiber*)param);
+}
+
+static void vd__fiber_switch_in(VdFiber *fiber)
+{
+    void *self = IsThreadAFiber() ? GetCurrentFiber() : ConvertThreadToFiber(0);
+    fiber->caller_sp = self;
+    SwitchToFiber(fiber->sp);
+}
+
+static void vd__fiber_switch_out(VdFiber *fiber)
+{
+    SwitchToFiber(fiber->caller_sp);
+}
+
+static void vd__fiber_prepare(VdFiber *fiber)
+{
+    if (fiber->sp) DeleteFiber(fiber->sp);
+    fiber->sp = CreateFiberEx(fiber->stack_size, fiber->stack_size, FIBER_FLAG_FLOAT_SWITCH, vd__fiber_win32_start,
+                              fiber);
+    VD_ASSERT(fiber->sp != 0);
+}
+#else
+#if VD_PLATFORM_MACOS
+#define VD__FIBER_ASM_SYM(name)  "_" #name
+#define VD__FIBER_ASM_DECL(name) ".private_extern _" #name "\n"
+#else
+#define VD__FIBER_ASM_SYM(name)  #name
+#define VD__FIBER_ASM_DECL(name) ".hidden " #name "\n.type " #name ", %function\n"
+#endif // VD_PLATFORM_MACOS
+
+// Saves the callee-saved registers on the current stack, stores the stack pointer in *save_sp, then restores the
+// registers from new_sp and returns into whatever that stack was doing.
+void vd__fiber_switch(void **save_sp, void *new_sp);
+// The first return address of a new fiber: calls the function in r13/x20 with the fiber in r12/x19.
+void vd__fiber_start(void);
+
+#if defined(__x86_64__)
+__asm__(
+    ".text\n"
+    ".globl " VD__FIBER_ASM_SYM(vd__fiber_switch) "\n"
+    VD__FIBER_ASM_DECL(vd__fiber_switch)
+    ".p2align 4\n"
+    VD__FIBER_ASM_SYM(vd__fiber_switch) ":\n"
+    "    pushq %rbp\n"
+    "    pushq %rbx\n"
+    "    pushq %r12\n"
+    "    pushq %r13\n"
+    "    pushq %r14\n"
+    "    pushq %r15\n"
+    "    subq $8, %rsp\n"
+    "    stmxcsr (%rsp)\n"
+    "    fnstcw 4(%rsp)\n"
+    "    movq %rsp, (%rdi)\n"
+    "    movq %rsi, %rsp\n"
+    "    ldmxcsr (%rsp)\n"
+    "    fldcw 4(%rsp)\n"
+    "    addq $8, %rsp\n"
+    "    popq %r15\n"
+    "    popq %r14\n"
+    "    popq %r13\n"
+    "    popq %r12\n"
+    "    popq %rbx\n"
+    "    popq %rbp\n"
+    "    ret\n"
+    ".globl " VD__FIBER_ASM_SYM(vd__fiber_start) "\n"
+    VD__FIBER_ASM_DECL(vd__fiber_start)
+    ".p2align 4\n"
+    VD__FIBER_ASM_SYM(vd__fiber_start) ":\n"
+    "    movq %r12, %rdi\n"
+    "    andq $-16, %rsp\n"
+    "    callq *%r13\n"
+    "    ud2\n"
+);
+
+#define VD__FIBER_FRAME_WORDS 8
+
+static void vd__fiber_init_frame(Vdu64 *frame, VdFiber *fiber)
+{
+    frame[0] = 0x1F80ull | (0x037Full << 32);     // Default MXCSR and x87 control word
+    frame[1] = 0;                                 // r15
+    frame[2] = 0;                                 // r14
+    frame[3] = (Vdu64)(Vduptr)vd__fiber_main;     // r13
+    frame[4] = (Vdu64)(Vduptr)fiber;              // r12
+    frame[5] = 0;                                 // rbx
+    frame[6] = 0;                                 // rbp
+    frame[7] = (Vdu64)(Vduptr)vd__fiber_start;    // return address
+}
+#elif defined(__aarch64__)
+__asm__(
+    ".text\n"
+    ".globl " VD__FIBER_ASM_SYM(vd__fiber_switch) "\n"
+    VD__FIBER_ASM_DECL(vd__fiber_switch)
+    ".p2align 4\n"
+    VD__FIBER_ASM_SYM(vd__fiber_switch) ":\n"
+    "    sub sp, sp, #160\n"
+    "    stp x19, x20, [sp, #0]\n"
+    "    stp x21, x22, [sp, #16]\n"
+    "    stp x23, x24, [sp, #32]\n"
+    "    stp x25, x26, [sp, #48]\n"
+    "    stp x27, x28, [sp, #64]\n"
+    "    stp x29, x30, [sp, #80]\n"
+    "    stp d8,  d9,  [sp, #96]\n"
+    "    stp d10, d11, [sp, #112]\n"
+    "    stp d12, d13, [sp, #128]\n"
+    "    stp d14, d15, [sp, #144]\n"
+    "    mov x2, sp\n"
+    "    str x2, [x0]\n"
+    "    mov sp, x1\n"
+    "    ldp x19, x20, [sp, #0]\n"
+    "    ldp x21, x22, [sp, #16]\n"
+    "    ldp x23, x24, [sp, #32]\n"
+    "    ldp x25, x26, [sp, #48]\n"
+    "    ldp x27, x28, [sp, #64]\n"
+    "    ldp x29, x30, [sp, #80]\n"
+    "    ldp d8,  d9,  [sp, #96]\n"
+    "    ldp d10, d11, [sp, #112]\n"
+    "    ldp d12, d13, [sp, #128]\n"
+    "    ldp d14, d15, [sp, #144]\n"
+    "    add sp, sp, #160\n"
+    "    ret\n"
+    ".globl " VD__FIBER_ASM_SYM(vd__fiber_start) "\n"
+    VD__FIBER_ASM_DECL(vd__fiber_start)
+    ".p2align 4\n"
+    VD__FIBER_ASM_SYM(vd__fiber_start) ":\n"
+    "    mov x0, x19\n"
+    "    blr x20\n"
+    "    brk #0\n"
+);
+
+#define VD__FIBER_FRAME_WORDS 20
+
+static void vd__fiber_init_frame(Vdu64 *frame, VdFiber *fiber)
+{
+    VD_MEMSET(frame, 0, sizeof(Vdu64) * VD__FIBER_FRAME_WORDS);
+    frame[0]  = (Vdu64)(Vduptr)fiber;             // x19
+    frame[1]  = (Vdu64)(Vduptr)vd__fiber_main;    // x20
+    frame[11] = (Vdu64)(Vduptr)vd__fiber_start;   // x30
+}
+#endif // defined(__x86_64__), defined(__aarch64__)
+
+static void vd__fiber_switch_in(VdFiber *fiber)  { vd__fiber_switch(&fiber->caller_sp, fiber->sp); }
+static void vd__fiber_switch_out(VdFiber *fiber) { vd__fiber_switch(&fiber->sp, fiber->caller_sp); }
+
+static void vd__fiber_prepare(VdFiber *fiber)
+{
+    Vduptr top   = ((Vduptr)fiber->stack + fiber->stack_size) & ~(Vduptr)15;
+    Vdu64  *frame = (Vdu64*)top - VD__FIBER_FRAME_WORDS;
+    vd__fiber_init_frame(frame, fiber);
+    fiber->sp = frame;
+}
+#endif // VD_PLATFORM_WINDOWS
+
+static void vd__fiber_main(VdFiber *fiber)
+{
+    fiber->proc(fiber, fiber->userdata);
+
+    fiber->value = 0;
+    fiber->state = VD_FIBER_STATE_DONE;
+    vd__fiber_switch_out(fiber);
+    VD_ASSERT(VD_FALSE && "A finished fiber was resumed");
+}
+
+static void vd__fiber_setup(VdFiber *fiber, VdProcFiber *proc, void *userdata)
+{
+    fiber->proc        = proc;
+    fiber->userdata    = userdata;
+    fiber->value       = 0;
+    fiber->state       = VD_FIBER_STATE_READY;
+    fiber->sched_state = 0;
+    fiber->scheduler   = 0;
+    fiber->next        = 0;
+    vd__fiber_prepare(fiber);
+}
+
+VD_API VdFiber *vd_fiber_create(VdProcFiber *proc, void *userdata, Vdusize stack_size)
+{
+    if (stack_size == 0) stack_size = VD_FIBER_DEFAULT_STACK_SIZE;
+
+    Vdusize page        = vd_vm_get_page_size();
+    Vdusize header_size = (sizeof(VdFiber) + 63) & ~(Vdusize)63;
+    Vdusize usable      = (stack_size + header_size + page - 1) & ~(page - 1);
+    Vdusize reserve     = usable + page;
+
+    // [guard page][stack ... grows down][VdFiber]
+    Vdu8 *base = (Vdu8*)vd_vm_reserve(reserve);
+    if (base == 0) return 0;
+
+    // POSIX reports failure with MAP_FAILED rather than null, so check for the address asked for
+    if (vd_vm_commit(base + page, usable) != (void*)(base + page)) {
+        vd_vm_release(base, reserve);
+        return 0;
+    }
+
+    VdFiber *fiber = (VdFiber*)(base + reserve - header_size);
+    VD_MEMSET(fiber, 0, sizeof(*fiber));
+    fiber->stack        = base + page;
+    fiber->stack_size   = usable - header_size;
+    fiber->reserve_size = reserve;
+    vd__fiber_setup(fiber, proc, userdata);
+    return fiber;
+}
+
+VD_API VdFiber *vd_fiber_create_arena(VdArena *a, VdProcFiber *proc, void *userdata, Vdusize stack_size)
+{
+    if (stack_size == 0) stack_size = VD_FIBER_DEFAULT_STACK_SIZE;
+
+    VdFiber *fiber = VD_ARENA_PUSH_STRUCT(a, VdFiber);
+    VD_MEMSET(fiber, 0, sizeof(*fiber));
+#if !VD_PLATFORM_WINDOWS
+    fiber->stack = (Vdu8*)vd_arena_alloc_align(a, stack_size, 16);
+    if (fiber->stack == 0) return 0;
+#endif // !VD_PLATFORM_WINDOWS
+    fiber->stack_size = stack_size;
+    vd__fiber_setup(fiber, proc, userdata);
+    return fiber;
+}
+
+VD_API void vd_fiber_destroy(VdFiber *fiber)
+{
+    VD_ASSERT(fiber->state != VD_FIBER_STATE_RUNNING);
+
+#if VD_PLATFORM_WINDOWS
+    if (fiber->sp) DeleteFiber(fiber->sp);
+    fiber->sp = 0;
+#endif // VD_PLATFORM_WINDOWS
+
+    if (fiber->reserve_size) {
+        Vdusize page = vd_vm_get_page_size();
+        vd_vm_release(fiber->stack - page, fiber->reserve_size);
+    }
+}
+
+VD_API void vd_fiber_reset(VdFiber *fiber, VdProcFiber *proc, void *userdata)
+{
+    VD_ASSERT(fiber->state == VD_FIBER_STATE_DONE || fiber->state == VD_FIBER_STATE_READY);
+    vd__fiber_setup(fiber, proc, userdata);
+}
+
+VD_API void *vd_fiber_resume(VdFiber *fiber, void *value)
+{
+    VD_ASSERT(fiber->state == VD_FIBER_STATE_READY || fiber->state == VD_FIBER_STATE_SUSPENDED);
+
+    VdFiber *prev = vd__fiber_get_current();
+    fiber->value = value;
+    fiber->state = VD_FIBER_STATE_RUNNING;
+    vd__fiber_set_current(fiber);
+
+    vd__fiber_switch_in(fiber);
+
+    vd__fiber_set_current(prev);
+    return fiber->value;
+}
+
+VD_API void *vd_fiber_yield(void *value)
+{
+    VdFiber *fiber = vd__fiber_get_current();
+    VD_ASSERT(fiber != 0 && "vd_fiber_yield called outside of a fiber");
+
+    fiber->value = value;
+    fiber->state = VD_FIBER_STATE_SUSPENDED;
+    vd__fiber_switch_out(fiber);
+
+    // May be running on a different thread now
+    return fiber->value;
+}
+
+VD_API VdFiber *vd_fiber_current(void)
+{
+    return vd__fiber_get_current();
+}
+
+VD_API VdFiberState vd_fiber_get_state(VdFiber *fiber)
+{
+    return (VdFiberState)fiber->state;
+}
+
+// A parked fiber goes RUNNING -> PARKING (in the fiber) -> PARKED (in the worker, once its registers are saved).
+// A wake-up that arrives while it is still PARKING turns it into WOKEN, and the worker requeues it right away.
+// One that arrives while it is RUNNING turns it into PENDING, and its next vd_fiber_park returns immediately.
+enum {
+    VD__FIBER_SCHED_RUNNING = 0,
+    VD__FIBER_SCHED_PARKING,
+    VD__FIBER_SCHED_PARKED,
+    VD__FIBER_SCHED_WOKEN,
+    VD__FIBER_SCHED_PENDING,
+};
+
+static void vd__fiber_scheduler_lock(VdFiberScheduler *s)
+{
+    while (!vd_atomic_cas_u32(&s->lock, 0, 1)) {
+        while (vd_atomic_load_u32(&s->lock) != 0) vd_cpu_relax();
+    }
+}
+
+static void vd__fiber_scheduler_unlock(VdFiberScheduler *s)
+{
+    vd_atomic_store_u32(&s->lock, 0);
+}
+
+static void vd__fiber_scheduler_push(VdFiberScheduler *s, VdFiber *fiber)
+{
+    fiber->next = 0;
+    vd__fiber_scheduler_lock(s);
+    if (s->tail) s->tail->next = fiber;
+    else         s->head = fiber;
+    s->tail = fiber;
+    vd__fiber_scheduler_unlock(s);
+}
+
+static VdFiber *vd__fiber_scheduler_pop(VdFiberScheduler *s)
+{
+    vd__fiber_scheduler_lock(s);
+    VdFiber *fiber = s->head;
+    if (fiber) {
+        s->head = fiber->next;
+        if (s->head == 0) s->tail = 0;
+    }
+    vd__fiber_scheduler_unlock(s);
+    return fiber;
+}
+
+VD_API void vd_fiber_scheduler_init(VdFiberScheduler *scheduler, VdProcFiberIdle *idle, void *idle_userdata)
+{
+    VD_MEMSET(scheduler, 0, sizeof(*scheduler));
+    scheduler->idle          = idle;
+    scheduler->idle_userdata = idle_userdata;
+}
+
+VD_API void vd_fiber_scheduler_spawn(VdFiberScheduler *scheduler, VdFiber *fiber)
+{
+    fiber->scheduler   = scheduler;
+    fiber->sched_state = VD__FIBER_SCHED_RUNNING;
+    vd_atomic_fetch_add_u32(&scheduler->live, 1);
+    vd__fiber_scheduler_push(scheduler, fiber);
+}
+
+VD_API void vd_fiber_scheduler_ready(VdFiberScheduler *scheduler, VdFiber *fiber)
+{
+    for (;;) {
+        Vdu32 state = vd_atomic_load_u32(&fiber->sched_state);
+        if (state == VD__FIBER_SCHED_PARKED) {
+            if (vd_atomic_cas_u32(&fiber->sched_state, state, VD__FIBER_SCHED_RUNNING)) {
+                vd__fiber_scheduler_push(scheduler, fiber);
+                return;
+            }
+        } else if (state == VD__FIBER_SCHED_PARKING) {
+            if (vd_atomic_cas_u32(&fiber->sched_state, state, VD__FIBER_SCHED_WOKEN)) return;
+        } else if (state == VD__FIBER_SCHED_RUNNING) {
+            // Not parked yet: remember the wake-up for its next vd_fiber_park
+            if (vd_atomic_cas_u32(&fiber->sched_state, state, VD__FIBER_SCHED_PENDING)) return;
+        } else {
+            // Already woken
+            return;
+        }
+    }
+}
+
+VD_API void vd_fiber_park(void)
+{
+    VdFiber *fiber = vd__fiber_get_current();
+    VD_ASSERT(fiber && fiber->scheduler && "vd_fiber_park called outside of a scheduled fiber");
+
+    for (;;) {
+        if (vd_atomic_cas_u32(&fiber->sched_state, VD__FIBER_SCHED_PENDING, VD__FIBER_SCHED_RUNNING)) return;
+        if (vd_atomic_cas_u32(&fiber->sched_state, VD__FIBER_SCHED_RUNNING, VD__FIBER_SCHED_PARKING)) break;
+    }
+
+    vd_fiber_yield(0);
+}
+
+static VD_PROC_THREAD(vd__fiber_scheduler_worker)
+{
+    VdFiberScheduler *s = (VdFiberScheduler*)userdata;
+
+    while (vd_atomic_load_u32(&s->live) > 0) {
+        VdFiber *fiber = vd__fiber_scheduler_pop(s);
+        if (fiber == 0) {
+            if (!(s->idle && s->idle(s, s->idle_userdata))) vd_thread_yield();
+            continue;
+        }
+
+        vd_fiber_resume(fiber, 0);
+
+        if (fiber->state == VD_FIBER_STATE_DONE) {
+            vd_atomic_fetch_add_u32(&s->live, (Vdu32)-1);
+            continue;
+        }
+
+        // Its registers are saved now, so it's safe for another worker to pick it up
+        if (vd_atomic_cas_u32(&fiber->sched_state, VD__FIBER_SCHED_PARKING, VD__FIBER_SCHED_PARKED)) continue;
+
+        // Woken while parking, or it just yielded (leave a PENDING wake-up for its next park)
+        vd_atomic_cas_u32(&fiber->sched_state, VD__FIBER_SCHED_WOKEN, VD__FIBER_SCHED_RUNNING);
+        vd__fiber_scheduler_push(s, fiber);
+    }
+}
+
+VD_API void vd_fiber_scheduler_run(VdFiberScheduler *scheduler, Vdu32 num_threads)
+{
+    if (num_threads == 0)                   num_threads = vd_get_num_cpus();
+    if (num_threads > VD_FIBER_MAX_THREADS) num_threads = VD_FIBER_MAX_THREADS;
+
+    // Workers share one run queue, so a thread that fails to start only means fewer workers
+    VdThread threads[VD_FIBER_MAX_THREADS];
+    Vdb32    started[VD_FIBER_MAX_THREADS];
+    for (Vdu32 t = 1; t < num_threads; ++t) {
+        started[t] = vd_thread_create(&threads[t], vd__fiber_scheduler_worker, scheduler);
+    }
+
+    vd__fiber_scheduler_worker(scheduler);
+
+    for (Vdu32 t = 1; t < num_threads; ++t) {
+        if (started[t]) vd_thread_join(&threads[t]);
+    }
+}
+#endif // VD_FIBER_SUPPORTED
+
+/* ----TESTING IMPL-------------------------------------------------------------------------------------------------- */
+#if VD_INCLUDE_TESTS
+
+static int vd__run_test(VdTestEntry* e) {
+    vd_arena_clear(Test_Arena);
+    Test_Arena->flags = 0;
+
+    if (!e || !e->name || !e->test) return -1;
+
+    VdTestResult r = e->test();
+    if (r.ok) {
+        VD_TEST_LOG("[%-60s]   OK", e->name);
+        return 1;
+    } else {
+        VD_TEST_LOG("[%-60s]   FAILED", e->name);
+        VD_TEST_LOG("%s", r.err);
+        return 0;
+    }
+}
+
+VdArena *Test_Arena;
+
+#if !VD_HOST_COMPILER_UNKNOWN
+
+VdTestContext *Vd__Global_Test_Context = 0;
+VdTestEntry   *Vd__Test_Entries;
+Vdusize        Vd__Cap_Test_Entries;
+Vdu32          Vd__Len_Test_Entries;
+#endif // VD_HOST_COMPILER_UNKNOWN
+
+void vd_test_set_context(VdTestContext *context)
+{
+    Vd__Global_Test_Context = context;
+}
+
+void vd_test_get_tests(VdTestEntry **out_entries, Vdu32 *out_num_entries)
+{
+    *out_entries = Vd__Test_Entries;
+    *out_num_entries = Vd__Len_Test_Entries;
+}
+
+#if VD_USE_CRT
+static VD_PROC_LOG(vd__test_log) {
+    VD_UNUSED(verbosity);
+    fputs(string, stdout);
+}
+
+#include <stdio.h>
+#endif // VD_USE_CRT
+
+void vd_test_main(void)
+{
+    VdArena a;
+    Test_Arena = &a;
+
+#if VD_USE_CRT
+    VdTestContext context;
+    context.log_impl = vd__test_log;
+
+    if (Vd__Global_Test_Context == 0) {
+        vd_test_set_context(&context);
+    }
+#endif // VD_USE_CRT
+
+    VD_ARENA_FROM_SYSTEM(Test_Arena, VD_MEGABYTES(64));
+
+    int passed = 0, total = 0;
+#if !VD_HOST_COMPILER_UNKNOWN 
+    for (Vdusize i = 0; i < Vd__Len_Test_Entries; ++i) {
+        if (vd__run_test(&Vd__Test_Entries[i])) {
+            passed++;
+        }
+        total++;
+    }
+
+    VD_TEST_LOG("[%d/%d]\n", passed, total);
+#else
+#error "Cannot produce tests for unknown compiler!"
+#endif // !VD_HOST_COMPILER_UNKNOWN
+}
+
+#if VD_INCLUDE_INTERNAL_TESTS
+
+VD_TEST("ipow64u8") {
+    VD_TEST_OK();    
+}
+
+typedef struct {
+    int           value;
+    VdDListNode node;
+} Vd__TestListStruct;
+
+VD_TEST("DList/Basic") {
+    int num_nodes = 5;
+    VdDList list;
+    vd_dlist_init(&list);
+
+    Vd__TestListStruct *structs = VD_ARENA_PUSH_ARRAY(Test_Arena, Vd__TestListStruct, num_nodes);
+
+    for (int i = 0; i < num_nodes; ++i) {
+        Vd__TestListStruct *s = &structs[i];
+        s->value = i;
+        vd_dlist_node_init(&s->node);
+    }
+
+    for (int i = 0; i < num_nodes; ++i) {
+        Vd__TestListStruct *s = &structs[i];
+        VD_TEST_EQ("Each node's next when initialized is linked to itself", s->node.next, &s->node);
+        VD_TEST_EQ("Each node's prev when initialized is linked to itself", s->node.prev, &s->node);
+        vd_dlist_node_init(&s->node);
+
+        VD_TEST_TRUE("dlist_node_is_empty is true", vd_dlist_node_is_empty(&s->node));
+    }
+
+
+    for (int i = 0; i < num_nodes; ++i) {
+        Vd__TestListStruct *s = &structs[i];
+        vd_dlist_append(&list, &s->node);
+    }
+
+    {
+        VD_DLIST_FOR_EACH_WITH_INDEX(&list, n, i) {
+            Vd__TestListStruct *s = VD_CONTAINER_OF(n, Vd__TestListStruct, node);
+            VD_TEST_EQ("Iterating all nodes in order and getting struct value is correct", s->value, (int)i);
+        }
+        VD_TEST_EQ("After iterating all nodes, the index should be equal to the last node's index + 1", i, (Vdusize)(num_nodes));
+    }
+
+    int i = 0;
+    while (!vd_dlist_is_empty(&list)) {
+        VdDListNode *n = vd_dlist_first(&list);
+        vd_dlist_rm(&list, n);
+
+        Vd__TestListStruct *s = VD_CONTAINER_OF(n, Vd__TestListStruct, node);
+
+        VD_TEST_EQ("Removing first node while list is not empty happens in correct order", s->value, i);
+        i++;
+    }
+
+    VD_TEST_OK();
+}
+
+VD_TEST("FixedArray/Basic")
+{
+    VD_FIXEDARRAY int *array = 0;
+    VD_FIXEDARRAY_INIT(array, 30, Test_Arena);
+
+    VD_TEST_EQ("Fixed array has correct capacity", VD_FIXEDARRAY_CAP(array), 30);
+
+    for (int i = 0; i < 30; ++i) {
+        VD_FIXEDARRAY_ADD(array, i);
+        VD_TEST_EQ("Fixed array insertion is correct", array[i], i);
+    }
+    VD_TEST_EQ("Fixed array has correct length", VD_FIXEDARRAY_LEN(array), 30);
+
+    VD_FIXEDARRAY_CLEAR(array);
+    VD_TEST_EQ("Fixed array has correct length when cleared", VD_FIXEDARRAY_LEN(array), 0);
+
+    for (int i = 0; i < 30; ++i) {
+        VD_FIXEDARRAY_ADD(array, i);
+        VD_TEST_EQ("Fixed array insertion after clear is ok", array[i], i);
+    }
+    VD_TEST_EQ("Fixed array has correct length after clear and repopulate", VD_FIXEDARRAY_LEN(array), 30);
+
+    for (int i = 29; i >= 0; --i) {
+        int c = VD_FIXEDARRAY_POP(array);
+        VD_TEST_EQ("Array pop i is correct", c, i);
     }
 
-    // At this point, no bin that matched our key was found so if the user doesn't want a new bin, then
-    // fail
-    if (!(op & VD__KVMAP_GET_BIN_FLAGS_CREATE)) {
-        return 0;
-    }
+    VD_TEST_EQ("Fixed array has correct length after n pops", VD_FIXEDARRAY_LEN(array), 0);
 
-    // If this bin is not used then allocate it
-    if (!existing_bin->used) {
-        vd__kvmap_copy_key(map, key, existing_bin);
-        existing_bin->used = VD_TRUE;
-        existing_bin->next = 0;
-        VD_KVMAP_HEADER(map)->taken++;
-        return existing_bin;
+    VD_TEST_OK();
+}
+
+VD_TEST("DynArray/Basic") {
+    VD_DYNARRAY int *array = 0; 
+    VD_DYNARRAY_INIT(array, Test_Arena);
+
+    for (int i = 0; i < 30; ++i) {
+        VD_DYNARRAY_ADD(array, i);
+        VD_TEST_EQ("Dynamic array insertion is correct", array[i], i);
     }
+    VD_TEST_EQ("Dynamic array has correct length", VD_DYNARRAY_LEN(array), 30);
 
-    // At this point, we handle a hash collision either for allocating a bin, or traversing the chain
-    // due to a previous collision
+    VD_DYNARRAY_CLEAR(array);
+    VD_TEST_EQ("Dynamic array has correct length when cleared", VD_DYNARRAY_LEN(array), 0);
 
-    // Otherwise search starting from the cellar for an unused bin
-    Vdu32 cursor = VD_KVMAP_HEADER(map)->cap_total;
-    while ((cursor > 0) && (VD_KVMAP_GET_BIN(map, cursor - 1)->used)) {
-        cursor--;
+    for (int i = 0; i < 30; ++i) {
+        VD_DYNARRAY_ADD(array, i);
+        VD_TEST_EQ("Dynamic array insertion after clear is ok", array[i], i);
     }
+    VD_TEST_EQ("Dynamic array has correct length after clear and repopulate", VD_DYNARRAY_LEN(array), 30);
 
-    // After n iterations, if no bin was found we should be at a bin that's still used
-    // (i.e bin 0). In this case, return null.
-    if (cursor == 0) {
-        return 0;
+    for (int i = 29; i >= 0; --i) {
+        int c = VD_DYNARRAY_POP(array);
+        VD_TEST_EQ("Array pop i is correct", c, i);
     }
 
-    cursor--;
-    Vd__KVMapBinPrefix *new_bin = VD_KVMAP_GET_BIN(map, cursor);
+    VD_TEST_EQ("Dynamic array has correct length after n pops", VD_DYNARRAY_LEN(array), 0);
 
-    // Allocate the bin
-    new_bin->used = VD_TRUE;
-    new_bin->next = 0;
+    VD_TEST_OK();
+}
 
-    VD_KVMAP_HEADER(map)->taken++;
+#if VD_ARENA_TRACK
+VD_TEST("Arena/Track") {
+    VdArena arena;
+    VD_ARENA_FROM_SYSTEM(&arena, VD_KILOBYTES(64));
+    vd_arena_track_reset_sites();
 
-    // Mark bin as next. At this point, the previous search through the chain means that existing_bin
-    // is now at the end of the chain 
-    existing_bin->next = new_bin;
+    Vdu32 *a = VD_ARENA_PUSH_ARRAY(&arena, Vdu32, 100); Vdu32 line_a = __LINE__;
+    VD_UNUSED(a);
+    for (int i = 0; i < 3; ++i) {
+        Vdu64 *b = VD_ARENA_PUSH_ARRAY(&arena, Vdu64, 8);
+        VD_UNUSED(b);
+    }
 
-    // Copy new key and return
-    vd__kvmap_copy_key(map, key, new_bin);
-    return new_bin;
+    VdArenaTrackStats stats = vd_arena_track_get_stats(&arena);
+    VD_TEST_EQ("Four allocations were recorded", stats.num_allocs, 4);
+    VD_TEST_EQ("Requested bytes are summed", stats.num_bytes, 100 * sizeof(Vdu32) + 3 * 8 * sizeof(Vdu64));
+
+    Vdusize peak = stats.used;
+    vd_arena_clear(&arena);
+    stats = vd_arena_track_get_stats(&arena);
+    VD_TEST_EQ("Clearing keeps the high-water mark", stats.peak, peak);
+    VD_TEST_EQ("Clearing resets the usage", stats.used, 0);
+
+    VdArenaTrackSite sites[2];
+    Vdu32 num_sites = vd_arena_track_snapshot(sites, 2);
+    VD_TEST_EQ("Both call sites are reported", num_sites, 2);
+    VD_TEST_EQ("The largest site comes first", sites[0].line, line_a);
+    VD_TEST_EQ("The loop site has three allocations", sites[1].num_allocs, 3);
+
+    VD_TEST_OK();
 }
 
-/* ----FILESYSTEM IMPL----------------------------------------------------------------------------------------------- */
 #if VD_INCLUDE_PLATFORM_SPECIFIC_FUNCTIONALITY
-#if VD_PLATFORM_WINDOWS
-#include <windows.h>
-static wchar_t Cached_Directory_Entry[1024];
-static char    Filename_Cache[256];
+static volatile Vdu32 Vd__Test_Arena_Track_Thread_Line;
 
-VD_API int vd_directory_open(VdDirectory *directory, const char *path)
+static VD_PROC_THREAD(vd__test_arena_track_thread)
 {
-    directory->filename = vd_str_from_cstr((char*)path);
-    directory->windows_is_on_first_file = VD_TRUE;
-    directory->windows_is_on_directory  = VD_FALSE;
-    return 1;
+    VdArena *arena = (VdArena*)userdata;
+    for (int i = 0; i < 1000; ++i) {
+        Vdu32 *a = VD_ARENA_PUSH_ARRAY(arena, Vdu32, 1); vd_atomic_store_u32(&Vd__Test_Arena_Track_Thread_Line, __LINE__);
+        VD_UNUSED(a);
+        vd_arena_clear(arena);
+    }
 }
 
-VD_API int vd_directory_get_file(VdDirectory *directory, VdFile *file)
-{
-query_file:
-    WIN32_FIND_DATAW dataw;
-    Vdb32 was_found = VD_FALSE;
+VD_TEST("Arena/TrackThreads") {
+    enum { NUM_THREADS = 4 };
+    VdArena arenas[NUM_THREADS];
+    VdThread threads[NUM_THREADS];
+    Vdb32 started[NUM_THREADS];
 
-    if (directory->windows_is_on_first_file) {
-        Vdu32 lenw = MultiByteToWideChar(
-            CP_UTF8,
-            MB_ERR_INVALID_CHARS,
-            (const char*)directory->filename.s, (Vdu32)directory->filename.len,
-            Cached_Directory_Entry,
-            VD_ARRAY_COUNT(Cached_Directory_Entry));
+    vd_arena_track_reset_sites();
+    for (int i = 0; i < NUM_THREADS; ++i) {
+        VD_ARENA_FROM_SYSTEM(&arenas[i], VD_KILOBYTES(4));
+        started[i] = vd_thread_create(&threads[i], vd__test_arena_track_thread, &arenas[i]);
+    }
 
-        if (Cached_Directory_Entry[lenw -1] != L'/' && Cached_Directory_Entry[lenw -1] != L'\\') {
-            Cached_Directory_Entry[lenw++] = L'\\';
-        }
+    for (int i = 0; i < NUM_THREADS; ++i) {
+        if (started[i]) vd_thread_join(&threads[i]);
+        else            vd__test_arena_track_thread(&arenas[i]);
+    }
 
-        Cached_Directory_Entry[lenw++] = L'*';
-        Cached_Directory_Entry[lenw]   = 0;
+    VdArenaTrackSite sites[4];
+    Vdu32 num_sites = vd_arena_track_snapshot(sites, 4);
+    VD_TEST_EQ("Every thread allocated at the same site", num_sites, 1);
+    VD_TEST_EQ("The site is the thread's", sites[0].line, Vd__Test_Arena_Track_Thread_Line);
+    VD_TEST_EQ("No allocation was lost", sites[0].num_allocs, NUM_THREADS * 1000);
 
-        directory->handle = FindFirstFileW(Cached_Directory_Entry, &dataw);
+    VD_TEST_OK();
+}
+#endif // VD_INCLUDE_PLATFORM_SPECIFIC_FUNCTIONALITY
+#endif // VD_ARENA_TRACK
 
-        was_found = directory->handle != INVALID_HANDLE_VALUE;
-        directory->windows_is_on_first_file = VD_FALSE;
-    } else {
-        was_found = FindNextFileW(directory->handle, &dataw);
+#if VD_INCLUDE_PLATFORM_SPECIFIC_FUNCTIONALITY && !VD_PLATFORM_WINDOWS
+static VD_PROC_THREAD(vd__test_log_async_producer)
+{
+    int thread_index = (int)(Vduptr)userdata;
+    char buf[64];
+    for (int i = 0; i < 200; ++i) {
+        snprintf(buf, sizeof(buf), "thread %d message %d\n", thread_index, i);
+        vd_log_async(VD_LOG_VERBOSITY_LOG, buf);
     }
+}
 
-    if (!was_found) {
-        return VD_FALSE;
-    }
+VD_TEST("Log/Async") {
+    FILE *f = tmpfile();
+    VD_TEST_TRUE("Temporary file is available", f != 0);
 
-    int num_bytes = WideCharToMultiByte(
-        CP_UTF8,
-        WC_ERR_INVALID_CHARS,
-        dataw.cFileName, -1,
-        Filename_Cache,
-        sizeof(Filename_Cache),
-        0, 0);
+    VdLogAsyncInitInfo info = {0};
+    info.ring_size = 1024;
+    info.max_spins = VD_U32_MAX;
+    info.fd        = fileno(f);
+    vd_log_async_start(&info);
 
-    file->name.s = Filename_Cache;
-    file->name.len = num_bytes - 1;
+    VdThread threads[4];
+    for (int i = 0; i < 4; ++i) {
+        vd_thread_create(&threads[i], vd__test_log_async_producer, (void*)(Vduptr)i);
+    }
 
-    if (vd_str_eq(file->name, VD_LIT(".")) || vd_str_eq(file->name, VD_LIT(".."))) {
-        goto query_file;
+    for (int i = 0; i < 4; ++i) {
+        vd_thread_join(&threads[i]);
     }
 
-    file->flags = 0;
-    if (dataw.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
-        file->flags |= VD_FILE_FLAG_DIRECTORY;
+    vd_log_async_stop();
+
+    VdLogAsyncStats stats = vd_log_async_get_stats();
+    VD_TEST_EQ("No records are dropped when producers may wait", stats.num_dropped, 0);
+    VD_TEST_EQ("Every record is written", stats.num_written, 800);
+
+    fseek(f, 0, SEEK_SET);
+    int num_lines = 0;
+    int c;
+    while ((c = fgetc(f)) != EOF) {
+        if (c == '\n') num_lines++;
     }
+    fclose(f);
 
-    return VD_TRUE;
+    VD_TEST_EQ("Every record ends up in the file", num_lines, 800);
+    VD_TEST_OK();
 }
 
-VD_API int vd_directory_close(VdDirectory *directory)
-{
-    FindClose((HANDLE)directory->handle);    
-    return 1;
-}
+VD_TEST("Log/AsyncRingReuse") {
+    FILE *f = tmpfile();
+    VD_TEST_TRUE("Temporary file is available", f != 0);
 
-#elif VD_PLATFORM_LINUX || VD_PLATFORM_MACOS
-#include <dirent.h>
-#include <sys/stat.h>
+    VdLogAsyncInitInfo info = {0};
+    info.ring_size = 1024;
+    info.max_spins = VD_U32_MAX;
+    info.fd        = fileno(f);
+    vd_log_async_start(&info);
+    VdLogAsyncStats before = vd_log_async_get_stats();
 
-VD_API int vd_directory_open(VdDirectory *directory, const char *path)
+    // Many more short-lived producers than there are ring slots, one after the other
+    for (int i = 0; i < VD_LOG_ASYNC_MAX_THREADS * 2; ++i) {
+        VdThread thread;
+        VD_TEST_TRUE("Producer thread starts", vd_thread_create(&thread, vd__test_log_async_producer, (void*)(Vduptr)i));
+        vd_thread_join(&thread);
+    }
+
+    vd_log_async_stop();
+    fclose(f);
+
+    VdLogAsyncStats after = vd_log_async_get_stats();
+    VD_TEST_EQ("Exited threads' rings are reused", after.num_written - before.num_written, VD_LOG_ASYNC_MAX_THREADS * 2 * 200);
+    VD_TEST_OK();
+}
+#endif // VD_INCLUDE_PLATFORM_SPECIFIC_FUNCTIONALITY && !VD_PLATFORM_WINDOWS
+
+static Vdu32 vd__test_sort_rand(Vdu32 *state)
 {
-    DIR *dir = opendir(path);
-    directory->filename = vd_str_from_cstr((char*)path);
-    directory->handle = (void*)dir;
-    return 1;
+    Vdu32 x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
 }
 
-VD_API int vd_directory_get_file(VdDirectory *directory, VdFile *file)
+static VD_PROC_SORT_CMP(vd__test_sort_cmp_u32)
 {
-    DIR *dir;
-    struct dirent *read_result;
+    VD_UNUSED(userdata);
+    Vdu32 x = *(const Vdu32*)a;
+    Vdu32 y = *(const Vdu32*)b;
+    return (x > y) - (x < y);
+}
 
-query_file:
-    dir = (DIR*)directory->handle;
+VD_TEST("Sort/Radix") {
+    Vdu32 rng = 0x12345678;
+    Vdusize count = 5000;
 
-    read_result = readdir(dir);
-    if (!read_result) {
-        return 0;
+    Vdu32 *keys   = VD_ARENA_PUSH_ARRAY(Test_Arena, Vdu32, count);
+    Vdu32 *values = VD_ARENA_PUSH_ARRAY(Test_Arena, Vdu32, count);
+    for (Vdusize i = 0; i < count; ++i) {
+        keys[i]   = vd__test_sort_rand(&rng) % 1000;
+        values[i] = keys[i] * 3 + 1;
     }
 
-    file->name = vd_str_from_cstr(read_result->d_name);
+    vd_sort_radix_u32(keys, values, count, Test_Arena);
+    Vdb32 ok = VD_TRUE;
+    for (Vdusize i = 1; i < count; ++i) ok = ok && (keys[i - 1] <= keys[i]);
+    VD_TEST_TRUE("u32 keys are sorted", ok);
 
-    if (vd_str_eq(file->name, VD_LIT(".")) || vd_str_eq(file->name, VD_LIT(".."))) {
-        goto query_file;
-    }
+    ok = VD_TRUE;
+    for (Vdusize i = 0; i < count; ++i) ok = ok && (values[i] == keys[i] * 3 + 1);
+    VD_TEST_TRUE("Values follow their keys", ok);
 
+    Vdf32 floats[] = { 3.5f, -1.0f, 0.0f, -0.5f, 100.0f, -100.0f, 2.25f };
+    vd_sort_radix_f32(floats, 0, VD_ARRAY_COUNT(floats), Test_Arena);
+    ok = VD_TRUE;
+    for (Vdusize i = 1; i < VD_ARRAY_COUNT(floats); ++i) ok = ok && (floats[i - 1] <= floats[i]);
+    VD_TEST_TRUE("f32 keys are sorted, negatives first", ok);
 
-    struct stat stat_struct;
-    stat(read_result->d_name, &stat_struct);    
+    Vdi64 signeds[] = { 5, -7, 0, -VD_I64_MAX - 1, -1, 42, VD_I64_MAX };
+    vd_sort_radix_i64(signeds, 0, VD_ARRAY_COUNT(signeds), Test_Arena);
+    ok = VD_TRUE;
+    for (Vdusize i = 1; i < VD_ARRAY_COUNT(signeds); ++i) ok = ok && (signeds[i - 1] <= signeds[i]);
+    VD_TEST_TRUE("i64 keys are sorted", ok);
 
-    file->flags = 0;
-    if (S_ISDIR(stat_struct.st_mode)) {
-        file->flags |= VD_FILE_FLAG_DIRECTORY;
+    VD_TEST_OK();
+}
+
+#if VD_INCLUDE_PLATFORM_SPECIFIC_FUNCTIONALITY
+VD_TEST("Sort/Parallel") {
+    Vdu32 rng = 0x0BADF00D;
+    Vdusize count = VD_SORT_PARALLEL_MIN_COUNT + 123;
+
+    Vdu32 *keys   = VD_ARENA_PUSH_ARRAY(Test_Arena, Vdu32, count);
+    Vdu32 *values = VD_ARENA_PUSH_ARRAY(Test_Arena, Vdu32, count);
+    for (Vdusize i = 0; i < count; ++i) {
+        keys[i]   = vd__test_sort_rand(&rng) % 100000;
+        values[i] = (Vdu32)i;
     }
 
-    return 1;
-}
+    vd_sort_radix_u32_parallel(keys, values, count, Test_Arena, 4);
+    Vdb32 ok = VD_TRUE;
+    for (Vdusize i = 1; i < count; ++i) {
+        ok = ok && ((keys[i - 1] < keys[i]) || ((keys[i - 1] == keys[i]) && (values[i - 1] < values[i])));
+    }
+    VD_TEST_TRUE("Radix keys are sorted and equal keys keep their order", ok);
 
-VD_API int vd_directory_close(VdDirectory *directory)
-{
-    DIR *dir = directory->handle;
-    closedir(dir);
-    return 1;
+    for (Vdusize i = 0; i < count; ++i) keys[i] = vd__test_sort_rand(&rng);
+    vd_sort_parallel(keys, count, sizeof(*keys), vd__test_sort_cmp_u32, 0, Test_Arena, 4);
+    ok = VD_TRUE;
+    for (Vdusize i = 1; i < count; ++i) ok = ok && (keys[i - 1] <= keys[i]);
+    VD_TEST_TRUE("Merge sorted keys are sorted", ok);
+
+    VD_TEST_OK();
 }
+#endif // VD_INCLUDE_PLATFORM_SPECIFIC_FUNCTIONALITY
 
+VD_TEST("Sort/Generic") {
+    Vdu32 rng = 0xCAFEBABE;
+    Vdusize count = 5000;
+    Vdu32 *a = VD_ARENA_PUSH_ARRAY(Test_Arena, Vdu32, count);
+
+    // Random, few unique, sorted and reversed inputs
+    for (int pattern = 0; pattern < 4; ++pattern) {
+        for (Vdusize i = 0; i < count; ++i) {
+            switch (pattern) {
+                case 0:  a[i] = vd__test_sort_rand(&rng);     break;
+                case 1:  a[i] = vd__test_sort_rand(&rng) % 4; break;
+                case 2:  a[i] = (Vdu32)i;                     break;
+                default: a[i] = (Vdu32)(count - i);           break;
+            }
+        }
 
-#else
-#error "Filesystem implementation not available on this platform"
-#endif // VD_PLATFORM_WINDOWS, else
+        vd_sort(a, count, sizeof(*a), vd__test_sort_cmp_u32, 0);
 
-static void vd_directory__iter_recursive(VdDirectory *directory, char *buf, int buf_len,
-                                         int length_to_searched_directory,
-                                         void (*visit)(VdFile*, void*),
-                                         void *userdata)
-{
-    VdFile file;
-    while (vd_directory_get_file(directory, &file)) {
+        Vdb32 ok = VD_TRUE;
+        for (Vdusize i = 1; i < count; ++i) ok = ok && (a[i - 1] <= a[i]);
+        VD_TEST_TRUE("Array is sorted", ok);
+    }
 
-        if (file.flags & VD_FILE_FLAG_DIRECTORY) {
-            // Construct Path
-            VD_MEMCPY(buf + buf_len, file.name.s, file.name.len);
-            int new_buf_len = buf_len + (int)file.name.len;
-            buf[new_buf_len++] = '/';
-            buf[new_buf_len] = 0;
+    VD_TEST_OK();
+}
 
-            VdDirectory new_directory;
-            if (vd_directory_open(&new_directory, buf)) {
-                vd_directory__iter_recursive(&new_directory, buf, new_buf_len, length_to_searched_directory,
-                                             visit, userdata);
-            }
-        } else {
+VD_TEST("Bitset/Dense") {
+    VdBitset a = vd_bitset_new(Test_Arena, 1000);
+    VdBitset b = vd_bitset_new(Test_Arena, 1000);
+    VdBitset r = vd_bitset_new(Test_Arena, 1000);
 
-            // Append file.name into buf and call visit
-            VD_MEMCPY(buf + buf_len, file.name.s, file.name.len);
+    vd_bitset_set_range(&a, 10, 500);
+    vd_bitset_set_range(&b, 400, 1000);
+    vd_bitset_clear(&a, 450);
 
-            file.name.s = buf + length_to_searched_directory;
-            file.name.len = file.name.len + buf_len - length_to_searched_directory;
-            visit(&file, userdata);
-        }
-    }
+    VD_TEST_EQ("Range set count", vd_bitset_count(&a), 489);
+    VD_TEST_EQ("Range set reaches the last bit", vd_bitset_count(&b), 600);
+    VD_TEST_EQ("Partial range count", vd_bitset_count_range(&a, 0, 64), 54);
 
-    vd_directory_close(directory);
+    vd_bitset_and(&r, &a, &b);
+    VD_TEST_EQ("And", vd_bitset_count(&r), 99);
+    vd_bitset_or(&r, &a, &b);
+    VD_TEST_EQ("Or", vd_bitset_count(&r), 990);
+    vd_bitset_andnot(&r, &a, &b);
+    VD_TEST_EQ("Andnot", vd_bitset_count(&r), 390);
+
+    VD_TEST_EQ("Next skips cleared bits", vd_bitset_next(&a, 450), 451);
+    VD_TEST_EQ("Next past the end", vd_bitset_next(&a, 500), 1000);
+
+    Vdu32 *indices = VD_ARENA_PUSH_ARRAY(Test_Arena, Vdu32, 1000);
+    Vdusize n = vd_bitset_to_indices(&r, indices);
+    VD_TEST_EQ("Index count matches popcount", n, 390);
+    VD_TEST_EQ("First index", indices[0], 10);
+    VD_TEST_EQ("Last index", indices[n - 1], 399);
+
+    Vdusize visited = 0;
+    VD_BITSET_FOR_EACH(&b, i) visited++;
+    VD_TEST_EQ("Iteration visits every set bit", visited, 600);
+    VD_TEST_OK();
 }
 
-VD_API void vd_directory_walk_recursively(const char *path, void (*visit)(VdFile*, void*), void *userdata)
-{
-    char buf[256] = {0};
-    int buf_len = 0;
+VD_TEST("Bitset/Sparse") {
+    VdSparseBitset a, b, r;
+    vd_sparse_bitset_init(&a, Test_Arena);
+    vd_sparse_bitset_init(&b, Test_Arena);
 
-    buf_len = (int)vd_cstr_len((char*)path);
-    VD_MEMCPY(buf, path, buf_len);
+    // a: every 3rd number below 30000 (spills into a bitmap container), plus a few far members
+    for (Vdu32 i = 0; i < 30000; i += 3) vd_sparse_bitset_add(&a, i);
+    vd_sparse_bitset_add(&a, 0x70000001);
+    vd_sparse_bitset_add(&a, 0xFFFFFFFF);
 
-    if (buf[buf_len - 1] != '\\' && buf[buf_len - 1] != '/') {
-        buf[buf_len++] = '/';
-    }
+    // b: every 20th number below 30000, as sorted arrays
+    for (Vdu32 i = 0; i < 30000; i += 20) vd_sparse_bitset_add(&b, i);
+    vd_sparse_bitset_add(&b, 0xFFFFFFFF);
 
-    VdDirectory first_directory;
-    if (!vd_directory_open(&first_directory, path)) {
-        return;
-    }
+    VD_TEST_EQ("Containers are bitmaps past the array limit", a.containers[0].is_bitmap, 1);
+    VD_TEST_EQ("Containers stay arrays below the limit", b.containers[0].is_bitmap, 0);
+    VD_TEST_FALSE("Adding twice is reported", vd_sparse_bitset_add(&a, 3));
+    VD_TEST_TRUE("Member test", vd_sparse_bitset_test(&a, 0x70000001));
+    VD_TEST_FALSE("Non member test", vd_sparse_bitset_test(&a, 0x70000002));
+    VD_TEST_EQ("Count", vd_sparse_bitset_count(&a), 10002);
 
-    VdFile file;
-    while (vd_directory_get_file(&first_directory, &file)) {
+    vd_sparse_bitset_init(&r, Test_Arena);
+    vd_sparse_bitset_and(&r, &a, &b);
+    VD_TEST_EQ("And", vd_sparse_bitset_count(&r), 501);
 
-        if (file.flags & VD_FILE_FLAG_DIRECTORY) {
-            VD_MEMCPY(buf + buf_len, file.name.s, file.name.len);
-            int new_buf_len = buf_len + (int)file.name.len;
-            buf[new_buf_len++] = '/';
-            buf[new_buf_len] = 0;
+    vd_sparse_bitset_init(&r, Test_Arena);
+    vd_sparse_bitset_or(&r, &a, &b);
+    VD_TEST_EQ("Or", vd_sparse_bitset_count(&r), 10002 + 1501 - 501);
 
-            VdDirectory new_directory;
-            if (vd_directory_open(&new_directory, buf)) {
-                vd_directory__iter_recursive(&new_directory, buf, new_buf_len, buf_len, visit, userdata);
-            }
-            continue;
-        }
+    Vdu32 next = 0;
+    VD_TEST_TRUE("Next finds a far member", vd_sparse_bitset_next(&a, 30000, &next));
+    VD_TEST_EQ("Next value", next, 0x70000001);
+
+    VD_TEST_TRUE("Remove", vd_sparse_bitset_remove(&a, 0x70000001));
+    VD_TEST_EQ("Removing the last member drops the container", a.num_containers, 2);
+
+    VdBitset dense = vd_bitset_new(Test_Arena, 30000);
+    vd_sparse_bitset_to_bitset(&b, &dense);
+    VD_TEST_EQ("To dense drops members past the end", vd_bitset_count(&dense), 1500);
+
+    VdSparseBitset back;
+    vd_sparse_bitset_init(&back, Test_Arena);
+    vd_sparse_bitset_from_bitset(&back, &dense);
+    VD_TEST_EQ("Round trip", vd_sparse_bitset_count(&back), 1500);
+    VD_TEST_OK();
+}
+
+VD_TEST("Hash/Streaming") {
+    const char data[] = "The quick brown fox jumps over the lazy dog";
+    Vdusize    len    = sizeof(data) - 1;
+
+    VdHasher whole;
+    vd_hasher_init(&whole, VD_HASH64_DEFAULT_SEED);
+    vd_hasher_update(&whole, data, len);
+    Vdu64 expected = vd_hasher_final(&whole);
+
+    Vdb32 ok = VD_TRUE;
+    for (Vdusize split = 0; split <= len; ++split) {
+        VdHasher parts;
+        vd_hasher_init(&parts, VD_HASH64_DEFAULT_SEED);
+        vd_hasher_update(&parts, data, split);
+        for (Vdusize i = split; i < len; ++i) vd_hasher_update(&parts, data + i, 1);
+        ok = ok && (vd_hasher_final(&parts) == expected);
+    }
+    VD_TEST_TRUE("Any split gives the same hash", ok);
+
+    VdHasher shorter;
+    vd_hasher_init(&shorter, VD_HASH64_DEFAULT_SEED);
+    vd_hasher_update(&shorter, data, len - 1);
+    VD_TEST_TRUE("Length is part of the hash", vd_hasher_final(&shorter) != expected);
+
+    VdHasher ab, ba;
+    vd_hasher_init(&ab, 0);
+    vd_hasher_init(&ba, 0);
+    vd_hasher_u32(&ab, 1); vd_hasher_u32(&ab, 2);
+    vd_hasher_u32(&ba, 2); vd_hasher_u32(&ba, 1);
+    VD_TEST_TRUE("Order matters", vd_hasher_final(&ab) != vd_hasher_final(&ba));
+
+    Vdu64 a = vd_hash_u32(7), b = vd_hash_u32(9);
+    VD_TEST_TRUE("Combine is not commutative", vd_hash_combine(a, b) != vd_hash_combine(b, a));
+    VD_TEST_TRUE("Combine does not cancel out", vd_hash_combine(a, a) != vd_hash_combine(b, b));
+    VD_TEST_OK();
+}
+
+VD_TEST("Checksum/CRC") {
+    VD_TEST_EQ("CRC32C check value", vd_crc32c(0, "123456789", 9), 0xE3069283u);
+    VD_TEST_EQ("Portable CRC32C check value", vd_crc32c_portable(0, "123456789", 9), 0xE3069283u);
+    VD_TEST_EQ("CRC16 check value", vd_crc16(0, "123456789", 9), 0xBB3D);
+    VD_TEST_EQ("Empty input keeps the running value", vd_crc32c(0x1234, "", 0), 0x1234u);
 
-        visit(&file, userdata);
+    // Long enough for both interleaved loops, checked at every alignment and against chained pieces
+    Vdusize len = 3 * 8192 * 2 + 3 * 256 + 77;
+    Vdu8 *data = (Vdu8*)vd_arena_alloc(Test_Arena, len + 8);
+    for (Vdusize i = 0; i < len + 8; ++i) data[i] = (Vdu8)((i * 2654435761u) >> 11);
+
+    Vdb32 ok = VD_TRUE;
+    for (Vdusize offset = 0; offset < 8; ++offset) {
+        ok = ok && (vd_crc32c(0, data + offset, len) == vd_crc32c_portable(0, data + offset, len));
     }
+    VD_TEST_TRUE("Hardware and portable paths agree", ok);
 
-    vd_directory_close(&first_directory);
+    Vdu32 whole   = vd_crc32c(0, data, len);
+    Vdu32 chained = vd_crc32c(vd_crc32c(vd_crc32c(0, data, 1000), data + 1000, 30000), data + 31000, len - 31000);
+    VD_TEST_EQ("Checksums can be chained", chained, whole);
+    VD_TEST_EQ("CRC16 can be chained", vd_crc16(vd_crc16(0, data, 100), data + 100, 900), vd_crc16(0, data, 1000));
+    VD_TEST_OK();
 }
-#endif // VD_INCLUDE_PLATFORM_SPECIFIC_FUNCTIONALITY
-
-/* ----TESTING IMPL-------------------------------------------------------------------------------------------------- */
-#if VD_INCLUDE_TESTS
 
-static int vd__run_test(VdTestEntry* e) {
-    vd_arena_clear(Test_Arena);
-    Test_Arena->flags = 0;
+VD_TEST("UTF8/Validate") {
+    static const struct { const char *s; Vdb32 valid; } cases[] = {
+        { "\xC3\xA9",         VD_TRUE  }, // U+00E9
+        { "\xE2\x82\xAC",     VD_TRUE  }, // U+20AC
+        { "\xF0\x9D\x84\x9E", VD_TRUE  }, // U+1D11E
+        { "\xF4\x8F\xBF\xBF", VD_TRUE  }, // U+10FFFF
+        { "\xEF\xBF\xBD",     VD_TRUE  }, // U+FFFD
+        { "\xC0\x80",         VD_FALSE }, // Overlong 2
+        { "\xE0\x9F\xBF",     VD_FALSE }, // Overlong 3
+        { "\xF0\x8F\xBF\xBF", VD_FALSE }, // Overlong 4
+        { "\xED\xA0\x80",     VD_FALSE }, // Surrogate
+        { "\xF4\x90\x80\x80", VD_FALSE }, // Too large
+        { "\xF8\x88\x80\x80", VD_FALSE }, // 5 byte lead
+        { "\x80",             VD_FALSE }, // Lone continuation
+        { "\xC3\xA9\xA9",     VD_FALSE }, // Extra continuation
+        { "\xE2\x82",         VD_FALSE }, // Truncated
+        { "\xE2\x82" "a",      VD_FALSE }, // Interrupted
+    };
 
-    if (!e || !e->name || !e->test) return -1;
+    char buf[64];
+    Vdb32 ok = VD_TRUE;
+    for (int c = 0; c < (int)VD_ARRAY_COUNT(cases); ++c) {
+        Vdusize len = 0;
+        while (cases[c].s[len]) len++;
+
+        // Move the sequence across block boundaries, with and without trailing ASCII.
+        for (int pad = 0; pad < 20; ++pad) {
+            for (int trail = 0; trail < 2; ++trail) {
+                VD_MEMSET(buf, 'x', sizeof(buf));
+                VD_MEMCPY(buf + pad, cases[c].s, len);
+                Vdusize total = pad + len + (trail ? 20 : 0);
+                ok = ok && (vd_utf8_validate(buf, total) == cases[c].valid);
+                ok = ok && (vd__utf8_validate_scalar((Vdu8*)buf, total) == cases[c].valid);
+            }
+        }
+    }
+    VD_TEST_TRUE("Known sequences are classified correctly", ok);
+
+    // Random bytes biased towards UTF-8 structure, checked against the scalar decoder.
+    static const Vdu8 pool[] = { 'a', 'z', 0x80, 0x8F, 0x90, 0xA0, 0xBF, 0xC2, 0xC3, 0xDF, 0xE0, 0xE1, 0xED, 0xEF,
+                                 0xF0, 0xF3, 0xF4, 0xF5, 0xFF };
+    Vdu64 rng = 0x2545F4914F6CDD1Dull;
+    Vdu8  data[200];
+    Vdu32 codepoints[VD_ARRAY_COUNT(data) + 1];
+    Vdb32 bounded = VD_TRUE;
+    ok = VD_TRUE;
+    for (int iter = 0; iter < 4000; ++iter) {
+        Vdusize len = (Vdusize)(iter % VD_ARRAY_COUNT(data));
+        for (Vdusize i = 0; i < len; ++i) {
+            rng ^= rng << 13; rng ^= rng >> 7; rng ^= rng << 17;
+            data[i] = pool[(rng >> 32) % VD_ARRAY_COUNT(pool)];
+        }
+        ok = ok && (vd_utf8_validate(data, len) == vd__utf8_validate_scalar(data, len));
 
-    VdTestResult r = e->test();
-    if (r.ok) {
-        VD_TEST_LOG("[%-60s]   OK", e->name);
-        return 1;
-    } else {
-        VD_TEST_LOG("[%-60s]   FAILED", e->name);
-        VD_TEST_LOG("%s", r.err);
-        return 0;
+        // A sentinel right after the vd_utf8_count entries catches any write past them
+        Vdusize max_count = vd_utf8_count(data, len);
+        codepoints[max_count] = 0xDEADBEEF;
+        bounded = bounded && (vd_utf8_to_utf32(data, len, codepoints) <= max_count);
+        bounded = bounded && (codepoints[max_count] == 0xDEADBEEF);
     }
+
+    // Only continuation bytes: nothing may be written at all, whichever path runs
+    Vdu32 *none = VD_ARENA_PUSH_ARRAY(Test_Arena, Vdu32, 1);
+    VD_MEMSET(data, 0x80, 128);
+    none[0] = 0xDEADBEEF;
+    bounded = bounded && (vd_utf8_to_utf32(data, 128, none) == 0) && (none[0] == 0xDEADBEEF);
+    VD_TEST_TRUE("Matches the scalar validator", ok);
+    VD_TEST_TRUE("Decoding invalid input stays within vd_utf8_count", bounded);
+    VD_TEST_OK();
 }
 
-VdArena *Test_Arena;
+VD_TEST("UTF8/Decode") {
+    const char text[] = "Hello, w\xC3\xB6rld! \xE2\x82\xAC 100 \xF0\x9F\x98\x80 and some more ASCII to fill blocks.";
+    Vdusize    len    = sizeof(text) - 1;
 
-#if !VD_HOST_COMPILER_UNKNOWN
+    VD_TEST_TRUE("ASCII is detected", vd_utf8_is_ascii("plain ascii text that is long enough", 36));
+    VD_TEST_TRUE("Non-ASCII is detected", !vd_utf8_is_ascii(text, len));
+    VD_TEST_EQ("Codepoints are counted", vd_utf8_count(text, len), len - 1 - 2 - 3);
 
-VdTestContext *Vd__Global_Test_Context = 0;
-VdTestEntry   *Vd__Test_Entries;
-Vdusize        Vd__Cap_Test_Entries;
-Vdu32          Vd__Len_Test_Entries;
-#endif // VD_HOST_COMPILER_UNKNOWN
+    Vdusize count = 0;
+    Vdu32 *codepoints = vd_utf8_to_utf32_arena(Test_Arena, text, len, &count);
+    VD_TEST_EQ("Count matches", count, vd_utf8_count(text, len));
+    VD_TEST_TRUE("Decoded",
+        codepoints && (codepoints[0] == 'H') && (codepoints[8] == 0xF6) && (codepoints[14] == 0x20AC) &&
+        (codepoints[20] == 0x1F600) && (codepoints[count - 1] == '.'));
 
-void vd_test_set_context(VdTestContext *context)
-{
-    Vd__Global_Test_Context = context;
+    VD_TEST_TRUE("Invalid input is rejected", vd_utf8_to_utf32_arena(Test_Arena, "\xC0\x80", 2, &count) == 0);
+    VD_TEST_OK();
 }
 
-void vd_test_get_tests(VdTestEntry **out_entries, Vdu32 *out_num_entries)
-{
-    *out_entries = Vd__Test_Entries;
-    *out_num_entries = Vd__Len_Test_Entries;
-}
+VD_TEST("LZ/Block") {
+    Vdusize max_len = 70000;
+    Vdu8 *src = (Vdu8*)vd_arena_alloc(Test_Arena, max_len);
+    Vdu8 *cmp = (Vdu8*)vd_arena_alloc(Test_Arena, VD_LZ_COMPRESS_BOUND(max_len));
+    Vdu8 *dec = (Vdu8*)vd_arena_alloc(Test_Arena, max_len);
+
+    Vdu64 rng = 0x9E3779B97F4A7C15ull;
+    Vdb32 ok = VD_TRUE;
+    static const Vdusize lengths[] = { 0, 1, 5, 12, 13, 16, 17, 100, 255, 4096, 65535, 65536, 70000 };
+    for (int kind = 0; kind < 4; ++kind) {
+        for (int l = 0; l < (int)VD_ARRAY_COUNT(lengths); ++l) {
+            Vdusize len = lengths[l];
+            for (Vdusize i = 0; i < len; ++i) {
+                rng ^= rng << 13; rng ^= rng >> 7; rng ^= rng << 17;
+                switch (kind) {
+                    case 0: src[i] = (Vdu8)rng; break;                                      // Incompressible
+                    case 1: src[i] = 'a'; break;                                            // Run
+                    case 2: src[i] = "the quick brown fox "[(i + (rng % 97 == 0)) % 20]; break; // Text-ish
+                    case 3: src[i] = (Vdu8)((i % 7) * ((rng & 3) == 0)); break;             // Short offsets
+                }
+            }
 
-#if VD_USE_CRT
-static VD_PROC_LOG(vd__test_log) {
-    VD_UNUSED(verbosity);
-    fputs(string, stdout);
+            Vdusize size = vd_lz_compress(src, len, cmp, VD_LZ_COMPRESS_BOUND(len));
+            ok = ok && (size != 0);
+            ok = ok && vd_lz_decompress(cmp, size, dec, len) && (VD_MEMCMP(src, dec, len) == 0);
+            if (len > 0) ok = ok && !vd_lz_decompress(cmp, size, dec, len - 1);
+        }
+    }
+    VD_TEST_TRUE("Round trips", ok);
+
+    for (Vdusize i = 0; i < max_len; ++i) src[i] = "abcabcabd"[i % 9];
+    Vdusize size = vd_lz_compress(src, max_len, cmp, VD_LZ_COMPRESS_BOUND(max_len));
+    VD_TEST_TRUE("Repetitive data compresses well", size < max_len / 50);
+    VD_TEST_EQ("Too small dst fails", vd_lz_compress(src, max_len, cmp, size - 1), 0);
+
+    // Corrupt the stream in various ways: decoding must fail or succeed, but never go out of bounds.
+    for (int iter = 0; iter < 2000; ++iter) {
+        Vdusize at = (Vdusize)(iter * 7919) % size;
+        Vdu8    old = cmp[at];
+        cmp[at] ^= (Vdu8)(1 + iter % 255);
+        vd_lz_decompress(cmp, size - (iter % 3), dec, max_len);
+        cmp[at] = old;
+    }
+    VD_TEST_OK();
 }
 
-#include <stdio.h>
-#endif // VD_USE_CRT
+VD_TEST("LZ/Frame") {
+    Vdusize len = VD_LZ_FRAME_BLOCK_SIZE * 3 + 1234;
+    Vdu8 *src = (Vdu8*)vd_arena_alloc(Test_Arena, len);
+    for (Vdusize i = 0; i < len; ++i) {
+        // Compressible first half, noise in the second, so both block kinds appear.
+        src[i] = (i < len / 2) ? (Vdu8)(i % 13) : (Vdu8)((i * 2654435761u) >> 13);
+    }
 
-void vd_test_main(void)
-{
-    VdArena a;
-    Test_Arena = &a;
+    Vdusize bound = vd_lz_frame_bound(len);
+    Vdu8 *frame = (Vdu8*)vd_arena_alloc(Test_Arena, bound);
+    Vdusize size = vd_lz_frame_compress(src, len, frame, bound);
+    VD_TEST_TRUE("Frame is written", (size != 0) && (size <= bound));
 
-#if VD_USE_CRT
-    VdTestContext context;
-    context.log_impl = vd__test_log;
+    Vdusize out_len = 0;
+    Vdu8 *out = (Vdu8*)vd_lz_frame_decompress_arena(Test_Arena, frame, size, &out_len);
+    VD_TEST_TRUE("Frame round trips", out && (out_len == len) && (VD_MEMCMP(out, src, len) == 0));
 
-    if (Vd__Global_Test_Context == 0) {
-        vd_test_set_context(&context);
+    // Streaming, block by block, with a frame whose content size is not known up front.
+    Vdusize at = vd_lz_frame_write_header(frame, bound, VD_LZ_CONTENT_SIZE_UNKNOWN);
+    for (Vdusize i = 0; i < len; i += 1000) {
+        Vdusize n = (len - i < 1000) ? len - i : 1000;
+        at += vd_lz_frame_write_block(src + i, n, frame + at, bound - at);
     }
-#endif // VD_USE_CRT
+    at += vd_lz_frame_write_end(frame + at, bound - at);
+
+    VdLzFrameReader reader;
+    VD_TEST_EQ("Reader opens", vd_lz_frame_reader_init(&reader, frame, at), VD_LZ_OK);
+
+    Vdu8 block[VD_LZ_FRAME_BLOCK_SIZE];
+    Vdusize total = 0;
+    Vdb32 ok = VD_TRUE;
+    VdLzStatus status;
+    Vdusize block_len;
+    while ((status = vd_lz_frame_reader_next(&reader, block, sizeof(block), &block_len)) == VD_LZ_OK) {
+        ok = ok && (VD_MEMCMP(block, src + total, block_len) == 0);
+        total += block_len;
+    }
+    VD_TEST_TRUE("Streamed blocks match", ok && (status == VD_LZ_END) && (total == len));
+    VD_TEST_TRUE("Unknown size can't go to an arena", vd_lz_frame_decompress_arena(Test_Arena, frame, at, 0) == 0);
+    VD_TEST_EQ("Truncated frames are detected", vd_lz_frame_decompress(frame, at - 4, out, len, 0),
+               VD_LZ_ERROR_TRUNCATED);
+    VD_TEST_OK();
+}
 
-    VD_ARENA_FROM_SYSTEM(Test_Arena, VD_MEGABYTES(64));
+VD_TEST("Pack/Build") {
+    Vdusize big_len = VD_LZ_FRAME_BLOCK_SIZE * 2 + 777;
+    Vdu8 *big   = (Vdu8*)vd_arena_alloc(Test_Arena, big_len);
+    Vdu8 *noise = (Vdu8*)vd_arena_alloc(Test_Arena, 4096);
+    for (Vdusize i = 0; i < big_len; ++i) big[i] = (Vdu8)(i % 29);
+    for (Vdusize i = 0; i < 4096; ++i) noise[i] = (Vdu8)((i * 2654435761u) >> 13);
 
-    int passed = 0, total = 0;
-#if !VD_HOST_COMPILER_UNKNOWN 
-    for (Vdusize i = 0; i < Vd__Len_Test_Entries; ++i) {
-        if (vd__run_test(&Vd__Test_Entries[i])) {
-            passed++;
-        }
-        total++;
+    VdPackSource sources[] = {
+        { VD_LIT("textures/big.bin"), big,     big_len },
+        { VD_LIT("noise.bin"),        noise,   4096    },
+        { VD_LIT("empty"),            noise,   0       },
+        { VD_LIT("hello.txt"),        "hello", 5       },
+    };
+
+    VdArena scratch;
+    vd_arena_init(&scratch, vd_arena_alloc(Test_Arena, VD_MEGABYTES(2)), VD_MEGABYTES(2));
+
+    Vdusize size = 0;
+    void *image = vd_pack_build(Test_Arena, &scratch, sources, VD_ARRAY_COUNT(sources),
+                                VD_PACK_BUILD_COMPRESS | VD_PACK_BUILD_CHECKSUMS, 2, &size);
+    VD_TEST_TRUE("Pack is built", image != 0);
+
+    VdPack pack = {0};
+    VD_TEST_EQ("Pack opens", vd_pack_open_memory(&pack, image, size), VD_PACK_OK);
+    VD_TEST_EQ("Count is stored", VD_PACK_COUNT(&pack), VD_ARRAY_COUNT(sources));
+
+    Vdb32 ok = VD_TRUE;
+    for (Vdusize i = 0; i < VD_ARRAY_COUNT(sources); ++i) {
+        const VdPackEntry *e = vd_pack_find(&pack, sources[i].name);
+        Vdusize len = 1;
+        Vdu8 *data = e ? (Vdu8*)vd_pack_read_arena(Test_Arena, &pack, e, &len) : 0;
+        ok = ok && data && (len == sources[i].size) && (VD_MEMCMP(data, sources[i].data, len) == 0);
+        ok = ok && e && ((e->offset % VD_PACK_DATA_ALIGN) == 0);
     }
+    VD_TEST_TRUE("Every entry reads back", ok);
+    VD_TEST_TRUE("Missing names are not found", vd_pack_find(&pack, VD_LIT("missing")) == 0);
+
+    const VdPackEntry *big_entry = vd_pack_find(&pack, VD_LIT("textures/big.bin"));
+    const VdPackEntry *hello     = vd_pack_find(&pack, VD_LIT("hello.txt"));
+    VD_TEST_EQ("Compressible entries are compressed", big_entry->compression, VD_PACK_COMPRESSION_LZ);
+    VD_TEST_EQ("Tiny entries are stored", hello->compression, VD_PACK_COMPRESSION_NONE);
+    VD_TEST_TRUE("Stored entries are usable in place", VD_MEMCMP(vd_pack_entry_bytes(&pack, hello), "hello", 5) == 0);
+
+    Vdu8 small[16];
+    VD_TEST_EQ("Short destinations are rejected", vd_pack_read(&pack, big_entry, small, sizeof(small)),
+               VD_PACK_ERROR_DST_TOO_SMALL);
+
+    ((Vdu8*)image)[big_entry->offset + big_entry->size / 2] ^= 0x40;
+    VD_TEST_EQ("Corruption fails the checksum", vd_pack_read(&pack, big_entry, big, big_len),
+               VD_PACK_ERROR_CHECKSUM_MISMATCH);
+
+    VdPackSource duplicates[] = {
+        { VD_LIT("a"), "1", 1 },
+        { VD_LIT("a"), "2", 1 },
+    };
+    VD_TEST_TRUE("Duplicate names fail", vd_pack_build(Test_Arena, &scratch, duplicates, 2, 0, 1, 0) == 0);
 
-    VD_TEST_LOG("[%d/%d]\n", passed, total);
-#else
-#error "Cannot produce tests for unknown compiler!"
-#endif // !VD_HOST_COMPILER_UNKNOWN
+    ((VdPackHeader*)image)->magic = 0;
+    VD_TEST_EQ("Bad magic is detected", vd_pack_open_memory(&pack, image, size), VD_PACK_ERROR_BAD_MAGIC);
+    VD_TEST_OK();
 }
 
-#if VD_INCLUDE_INTERNAL_TESTS
+VD_TEST("BTree/U64") {
+    enum { N = 5000 };
+    VdBTree tree;
+    vd_btree_init(&tree, Test_Arena, VD_BTREE_KEY_U64);
 
-VD_TEST("ipow64u8") {
-    VD_TEST_OK();    
+    // A permutation of the even numbers in [0, 2N), so odd keys are known to be missing
+    Vdb32 ok = VD_TRUE;
+    for (Vdu64 i = 0; i < N; ++i) {
+        Vdu64 k = ((i * 2971) % N) * 2;
+        ok = ok && vd_btree_set_u64(&tree, k, k + 1);
+    }
+    VD_TEST_TRUE("Inserts are new", ok);
+    VD_TEST_EQ("Count", tree.count, N);
+    VD_TEST_TRUE("Splits grew the tree", tree.height > 1);
+    VD_TEST_TRUE("Overwrites aren't new", !vd_btree_set_u64(&tree, 10, 11));
+
+    Vdu64 expect = 0;
+    for (VdBTreeIter it = vd_btree_first(&tree); vd_btree_iter_valid(&it); vd_btree_iter_next(&it)) {
+        ok = ok && (vd_btree_iter_key_u64(&it) == expect) && (vd_btree_iter_value(&it) == expect + 1);
+        expect += 2;
+    }
+    VD_TEST_TRUE("Iteration is sorted", ok && (expect == N * 2));
+
+    Vdu64 v = 0;
+    VD_TEST_TRUE("Get finds keys", vd_btree_get_u64(&tree, 1234, &v) && (v == 1235));
+    VD_TEST_TRUE("Get misses", !vd_btree_get_u64(&tree, 1235, &v));
+
+    VdBTreeIter lb = vd_btree_lower_bound_u64(&tree, 777);
+    VD_TEST_EQ("Lower bound of a missing key", vd_btree_iter_key_u64(&lb), 778);
+    lb = vd_btree_lower_bound_u64(&tree, N * 2);
+    VD_TEST_TRUE("Lower bound past the end", !vd_btree_iter_valid(&lb));
+
+    for (Vdu64 k = 0; k < N * 2; k += 6) ok = ok && vd_btree_remove_u64(&tree, k);
+    VD_TEST_TRUE("Removes", ok && !vd_btree_remove_u64(&tree, 0));
+    Vdusize seen = 0;
+    for (VdBTreeIter it = vd_btree_first(&tree); vd_btree_iter_valid(&it); vd_btree_iter_next(&it)) {
+        ok = ok && ((vd_btree_iter_key_u64(&it) % 6) != 0);
+        seen++;
+    }
+    VD_TEST_TRUE("Removed keys are gone", ok && (seen == tree.count));
+
+    // Range [1000, 1100)
+    Vdusize in_range = 0;
+    for (VdBTreeIter it = vd_btree_lower_bound_u64(&tree, 1000);
+         vd_btree_iter_valid(&it) && (vd_btree_iter_key_u64(&it) < 1100);
+         vd_btree_iter_next(&it))
+    {
+        in_range++;
+    }
+    VD_TEST_EQ("Range query", in_range, 33);
+
+    Vdu64 *keys = (Vdu64*)vd_arena_alloc(Test_Arena, sizeof(Vdu64) * N);
+    for (Vdu64 i = 0; i < N; ++i) keys[i] = i * 3 + 1;
+    VdBTree built;
+    vd_btree_init(&built, Test_Arena, VD_BTREE_KEY_U64);
+    vd_btree_build_u64(&built, keys, 0, N);
+    for (Vdu64 i = 0; i < N; ++i) ok = ok && vd_btree_get_u64(&built, i * 3 + 1, &v) && (v == i);
+    VD_TEST_TRUE("Bulk built trees find every key", ok && !vd_btree_get_u64(&built, 3, &v));
+    ok = ok && vd_btree_set_u64(&built, 3, 42) && vd_btree_get_u64(&built, 3, &v) && (v == 42);
+    VD_TEST_TRUE("Bulk built trees take inserts", ok);
+    VD_TEST_OK();
 }
 
-typedef struct {
-    int           value;
-    VdDListNode node;
-} Vd__TestListStruct;
+VD_TEST("BTree/Str") {
+    enum { N = 2000 };
+    VdBTree tree;
+    vd_btree_init(&tree, Test_Arena, VD_BTREE_KEY_STR);
 
-VD_TEST("DList/Basic") {
-    int num_nodes = 5;
-    VdDList list;
-    vd_dlist_init(&list);
+    // Every key shares its first 8 bytes with the rest, so ordering comes down to full compares
+    Vdb32 ok = VD_TRUE;
+    char buf[32];
+    for (int i = 0; i < N; ++i) {
+        int n = snprintf(buf, sizeof(buf), "identifier_%04d", (i * 1237) % N);
+        VdStr key = { buf, (Vdusize)n };
+        ok = ok && vd_btree_set_str(&tree, key, (Vdu64)((i * 1237) % N));
+    }
+    ok = ok && vd_btree_set_str(&tree, VD_LIT("identifier_"), 9999);
+    ok = ok && vd_btree_set_str(&tree, VD_LIT("a"), 10000);
+    VD_TEST_TRUE("Keys are copied on insert", ok && (tree.count == N + 2));
+
+    VdStr prev = vd_str_null();
+    Vdusize seen = 0;
+    for (VdBTreeIter it = vd_btree_first(&tree); vd_btree_iter_valid(&it); vd_btree_iter_next(&it)) {
+        VdStr key = vd_btree_iter_key_str(&it);
+        ok = ok && ((seen == 0) || (vd_str_compare(prev, key) < 0));
+        prev = key;
+        seen++;
+    }
+    VD_TEST_TRUE("Iteration is sorted", ok && (seen == tree.count));
+
+    Vdu64 v = 0;
+    VD_TEST_TRUE("Get finds keys", vd_btree_get_str(&tree, VD_LIT("identifier_1234"), &v) && (v == 1234));
+    VD_TEST_TRUE("Shorter keys are distinct", vd_btree_get_str(&tree, VD_LIT("identifier_"), &v) && (v == 9999));
+    VD_TEST_TRUE("Get misses", !vd_btree_get_str(&tree, VD_LIT("identifier_123"), &v));
+
+    Vdusize with_prefix = 0;
+    VdStr prefix = VD_LIT("identifier_12");
+    for (VdBTreeIter it = vd_btree_lower_bound_str(&tree, prefix);
+         vd_btree_iter_valid(&it) && vd_str_starts_with(vd_btree_iter_key_str(&it), prefix);
+         vd_btree_iter_next(&it))
+    {
+        with_prefix++;
+    }
+    VD_TEST_EQ("Prefix query", with_prefix, 100);
+
+    VdStr sorted[] = { VD_LIT("alpha"), VD_LIT("beta"), VD_LIT("betamax"), VD_LIT("betamax2"), VD_LIT("gamma") };
+    VdBTree built;
+    vd_btree_init(&built, Test_Arena, VD_BTREE_KEY_STR);
+    vd_btree_build_str(&built, sorted, 0, VD_ARRAY_COUNT(sorted));
+    VD_TEST_TRUE("Bulk built string trees", vd_btree_get_str(&built, VD_LIT("betamax"), &v) && (v == 2));
+    VD_TEST_TRUE("Removal", vd_btree_remove_str(&built, VD_LIT("beta")) && !vd_btree_get_str(&built, VD_LIT("beta"), &v));
+    VD_TEST_OK();
+}
 
-    Vd__TestListStruct *structs = VD_ARENA_PUSH_ARRAY(Test_Arena, Vd__TestListStruct, num_nodes);
+VD_TEST("ART/Lookup") {
+    VdArt art;
+    vd_art_init(&art, Test_Arena);
 
-    for (int i = 0; i < num_nodes; ++i) {
-        Vd__TestListStruct *s = &structs[i];
-        s->value = i;
-        vd_dlist_node_init(&s->node);
+    // Enough distinct bytes after a shared prefix to grow one node through every layout
+    Vdb32 ok = VD_TRUE;
+    char buf[64];
+    for (int i = 0; i < 256; ++i) {
+        int n = snprintf(buf, sizeof(buf), "vd_module_reference_%c_tail", (char)i);
+        VdStr key = { buf, (Vdusize)n };
+        ok = ok && vd_art_set(&art, key, (Vdu64)i);
     }
+    VD_TEST_TRUE("Insert through node4/16/48/256", ok && (art.count == 256));
 
-    for (int i = 0; i < num_nodes; ++i) {
-        Vd__TestListStruct *s = &structs[i];
-        VD_TEST_EQ("Each node's next when initialized is linked to itself", s->node.next, &s->node);
-        VD_TEST_EQ("Each node's prev when initialized is linked to itself", s->node.prev, &s->node);
-        vd_dlist_node_init(&s->node);
-
-        VD_TEST_TRUE("dlist_node_is_empty is true", vd_dlist_node_is_empty(&s->node));
+    Vdu64 v = 0;
+    for (int i = 0; i < 256; ++i) {
+        int n = snprintf(buf, sizeof(buf), "vd_module_reference_%c_tail", (char)i);
+        VdStr key = { buf, (Vdusize)n };
+        ok = ok && vd_art_get(&art, key, &v) && (v == (Vdu64)i);
     }
+    VD_TEST_TRUE("Get finds every key", ok);
+
+    VD_TEST_TRUE("Overwrite", !vd_art_set(&art, VD_LIT("vd_module_reference_a_tail"), 7) &&
+                              vd_art_get(&art, VD_LIT("vd_module_reference_a_tail"), &v) && (v == 7));
+    VD_TEST_TRUE("Prefix of a key misses", !vd_art_get(&art, VD_LIT("vd_module_reference_a"), &v));
+    VD_TEST_TRUE("Key past a key misses", !vd_art_get(&art, VD_LIT("vd_module_reference_a_tails"), &v));
+    VD_TEST_TRUE("Diverging inside a prefix misses", !vd_art_get(&art, VD_LIT("vd_module_referencf_a_tail"), &v));
+
+    // Keys that end inside other keys' shared bytes split the stored prefixes
+    ok = vd_art_set(&art, VD_LIT("vd_module"), 1000) && vd_art_set(&art, VD_LIT("vd_"), 1001) &&
+         vd_art_set(&art, VD_LIT(""), 1002) && !vd_art_set(&art, VD_LIT("vd_"), 1003);
+    VD_TEST_TRUE("Keys may prefix each other", ok && (art.count == 259));
+    VD_TEST_TRUE("Split prefixes", vd_art_get(&art, VD_LIT("vd_module"), &v) && (v == 1000) &&
+                                   vd_art_get(&art, VD_LIT("vd_"), &v) && (v == 1003) &&
+                                   vd_art_get(&art, VD_LIT(""), &v) && (v == 1002) &&
+                                   vd_art_get(&art, VD_LIT("vd_module_reference_b_tail"), &v) && (v == 'b'));
+    VD_TEST_OK();
+}
 
+static VD_PROC_ART_VISIT(vd__test_art_visit)
+{
+    VdStr *prev = (VdStr*)userdata;
+    Vdb32 sorted = (prev->s == 0) || (vd_str_compare(*prev, key) < 0);
+    *prev = key;
+    VD_UNUSED(value);
+    return sorted;
+}
+
+VD_TEST("ART/Prefix") {
+    VdArt art;
+    vd_art_init(&art, Test_Arena);
+    VdStr words[] = {
+        VD_LIT("vd_str"), VD_LIT("vd_str_eq"), VD_LIT("vd_str_dup"), VD_LIT("vd_str_compare"), VD_LIT("vd_strmap"),
+        VD_LIT("vd_arena"), VD_LIT("vd_arena_alloc"), VD_LIT("vd_art_get"), VD_LIT("vd_art_set"), VD_LIT("vd"),
+    };
+    for (int i = 0; i < (int)VD_ARRAY_COUNT(words); ++i) vd_art_set(&art, words[i], (Vdu64)i);
+
+    VdStr prev = vd_str_null();
+    VD_TEST_EQ("Visit everything in order", vd_art_visit_prefix(&art, VD_LIT(""), vd__test_art_visit, &prev), 10);
+    prev = vd_str_null();
+    VD_TEST_EQ("Visit a prefix", vd_art_visit_prefix(&art, VD_LIT("vd_str"), vd__test_art_visit, &prev), 5);
+    prev = vd_str_null();
+    VD_TEST_EQ("Prefix ending inside a stored prefix", vd_art_visit_prefix(&art, VD_LIT("vd_ar"), vd__test_art_visit, &prev), 4);
+    prev = vd_str_null();
+    VD_TEST_EQ("Prefix that is a whole leaf", vd_art_visit_prefix(&art, VD_LIT("vd_str_e"), vd__test_art_visit, &prev), 1);
+    VD_TEST_EQ("No matches", vd_art_visit_prefix(&art, VD_LIT("vd_x"), vd__test_art_visit, &prev), 0);
+
+    VdStr matched;
+    Vdu64 v;
+    VD_TEST_TRUE("Longest prefix",
+                 vd_art_longest_prefix(&art, VD_LIT("vd_arena_alloc_align"), &matched, &v) &&
+                 vd_str_eq(matched, VD_LIT("vd_arena_alloc")) && (v == 6));
+    VD_TEST_TRUE("Longest prefix backs off to a shorter key",
+                 vd_art_longest_prefix(&art, VD_LIT("vd_str_e"), &matched, &v) && vd_str_eq(matched, VD_LIT("vd_str")));
+    VD_TEST_TRUE("Longest prefix exact", vd_art_longest_prefix(&art, VD_LIT("vd_art_get"), &matched, 0) &&
+                                         vd_str_eq(matched, VD_LIT("vd_art_get")));
+    VD_TEST_TRUE("Longest prefix at the top", vd_art_longest_prefix(&art, VD_LIT("vdx"), &matched, 0) &&
+                                              vd_str_eq(matched, VD_LIT("vd")));
+    VD_TEST_TRUE("No stored prefix", !vd_art_longest_prefix(&art, VD_LIT("v"), &matched, 0));
+    VD_TEST_OK();
+}
 
-    for (int i = 0; i < num_nodes; ++i) {
-        Vd__TestListStruct *s = &structs[i];
-        vd_dlist_append(&list, &s->node);
+#if VD_INCLUDE_PLATFORM_SPECIFIC_FUNCTIONALITY
+VD_TEST("AsyncIO/ReadFiles") {
+    enum { NUM_FILES = 12 };
+    char          names[NUM_FILES][32];
+    Vdcstr        paths[NUM_FILES + 1];
+    Vdu8          *contents[NUM_FILES];
+    Vdusize       sizes[NUM_FILES];
+    VdAioRequest  requests[NUM_FILES];
+    Vdi64         handles[NUM_FILES];
+    VdAioRequest  *completed[NUM_FILES + 1];
+    VdAioFileData files[NUM_FILES + 1];
+
+    for (int i = 0; i < NUM_FILES; ++i) {
+        snprintf(names[i], sizeof(names[i]), "vd_aio_test_%d.bin", i);
+        paths[i]    = names[i];
+        sizes[i]    = (Vdusize)i * 1531;
+        contents[i] = (Vdu8*)vd_arena_alloc(Test_Arena, sizes[i] + 1);
+        for (Vdusize j = 0; j < sizes[i]; ++j) contents[i][j] = (Vdu8)(j * 7 + i);
     }
-
-    {
-        VD_DLIST_FOR_EACH_WITH_INDEX(&list, n, i) {
-            Vd__TestListStruct *s = VD_CONTAINER_OF(n, Vd__TestListStruct, node);
-            VD_TEST_EQ("Iterating all nodes in order and getting struct value is correct", s->value, (int)i);
+    paths[NUM_FILES] = "vd_aio_test_missing.bin";
+
+    for (int pass = 0; pass < 2; ++pass) {
+        // A queue smaller than the batch, so requests wait in the backlog
+        VdAioInitInfo info = {0};
+        info.queue_depth   = 8;
+        info.force_threads = pass == 1;
+        VdAio *aio = vd_aio_create(&info);
+        VD_TEST_TRUE("Backend starts", aio != 0);
+
+        VdArena arena;
+        Vdusize arena_size = VD_KILOBYTES(256);
+        vd_arena_init(&arena, vd_arena_alloc(Test_Arena, arena_size), arena_size);
+        Vdb32 registered = vd_aio_register_buffer(aio, arena.buf, arena_size);
+        if (vd_aio_get_backend(aio) == VD_AIO_BACKEND_THREADS) {
+            VD_TEST_TRUE("Threads don't register buffers", !registered);
         }
-        VD_TEST_EQ("After iterating all nodes, the index should be equal to the last node's index + 1", i, (Vdusize)(num_nodes));
-    }
 
-    int i = 0;
-    while (!vd_dlist_is_empty(&list)) {
-        VdDListNode *n = vd_dlist_first(&list);
-        vd_dlist_rm(&list, n);
+        // Open, write and close every file, one batch per step
+        VdAioOp steps[] = { VD_AIO_OP_OPEN, VD_AIO_OP_WRITE, VD_AIO_OP_CLOSE };
+        Vdb32 ok = VD_TRUE;
+        for (Vdusize s = 0; s < VD_ARRAY_COUNT(steps); ++s) {
+            for (int i = 0; i < NUM_FILES; ++i) {
+                if (steps[s] == VD_AIO_OP_WRITE) handles[i] = requests[i].result;
+                VD_MEMSET(&requests[i], 0, sizeof(requests[i]));
+                requests[i].op         = steps[s];
+                requests[i].open_flags = VD_AIO_OPEN_WRITE;
+                requests[i].path       = paths[i];
+                requests[i].file       = handles[i];
+                requests[i].buf        = contents[i];
+                requests[i].size       = sizes[i];
+                vd_aio_queue(aio, &requests[i]);
+            }
+            vd_aio_submit(aio);
 
-        Vd__TestListStruct *s = VD_CONTAINER_OF(n, Vd__TestListStruct, node);
+            Vdusize n = 0;
+            while (n < NUM_FILES) n += vd_aio_wait(aio, completed + n, NUM_FILES - n, NUM_FILES - n);
+            for (int i = 0; i < NUM_FILES; ++i) {
+                ok = ok && (requests[i].result >= 0);
+                if (steps[s] == VD_AIO_OP_WRITE) ok = ok && ((Vdusize)requests[i].result == sizes[i]);
+            }
+        }
+        VD_TEST_TRUE("Batched writes complete", ok && (vd_aio_outstanding(aio) == 0));
 
-        VD_TEST_EQ("Removing first node while list is not empty happens in correct order", s->value, i);
-        i++;
+        Vdusize loaded = vd_aio_read_files(aio, &arena, paths, NUM_FILES + 1, files);
+        VD_TEST_EQ("Every existing file loads", loaded, NUM_FILES);
+        for (int i = 0; i < NUM_FILES; ++i) {
+            ok = ok && (files[i].error == 0) && (files[i].size == sizes[i]);
+            ok = ok && ((sizes[i] == 0) || (VD_MEMCMP(files[i].data, contents[i], sizes[i]) == 0));
+        }
+        VD_TEST_TRUE("File contents match", ok);
+        VD_TEST_TRUE("Missing files report an error", files[NUM_FILES].error < 0);
+
+        vd_aio_register_buffer(aio, 0, 0);
+        vd_aio_destroy(aio);
     }
 
+    for (int i = 0; i < NUM_FILES; ++i) remove(paths[i]);
     VD_TEST_OK();
 }
+#endif // VD_INCLUDE_PLATFORM_SPECIFIC_FUNCTIONALITY
 
-VD_TEST("FixedArray/Basic")
+#if VD_FIBER_SUPPORTED
+static VD_PROC_FIBER(vd__test_fiber_counter)
 {
-    VD_FIXEDARRAY int *array = 0;
-    VD_FIXEDARRAY_INIT(array, 30, Test_Arena);
+    VD_UNUSED(fiber);
+    Vduptr sum = (Vduptr)vd_fiber_yield((void*)(Vduptr)1);
+    for (int i = 0; i < 4; ++i) {
+        sum += (Vduptr)vd_fiber_yield((void*)sum);
+    }
+    *(Vduptr*)userdata = sum;
+}
 
-    VD_TEST_EQ("Fixed array has correct capacity", VD_FIXEDARRAY_CAP(array), 30);
+static int vd__test_fiber_recurse(int depth)
+{
+    volatile char pad[256];
+    pad[0] = (char)depth;
+    return depth == 0 ? pad[0] : vd__test_fiber_recurse(depth - 1) + 1;
+}
 
-    for (int i = 0; i < 30; ++i) {
-        VD_FIXEDARRAY_ADD(array, i);
-        VD_TEST_EQ("Fixed array insertion is correct", array[i], i);
+static VD_PROC_FIBER(vd__test_fiber_deep)
+{
+    *(int*)userdata = vd__test_fiber_recurse(64);
+    vd_fiber_yield(fiber);
+}
+
+VD_TEST("Fiber/Resume") {
+    Vduptr result = 0;
+    VdFiber *f = vd_fiber_create(vd__test_fiber_counter, &result, 0);
+    VD_TEST_TRUE("Fiber is created", f != 0);
+    VD_TEST_EQ("Fibers start ready", vd_fiber_get_state(f), VD_FIBER_STATE_READY);
+    VD_TEST_TRUE("First yield comes back", (Vduptr)vd_fiber_resume(f, 0) == 1);
+    VD_TEST_EQ("Yielded fibers are suspended", vd_fiber_get_state(f), VD_FIBER_STATE_SUSPENDED);
+
+    Vdb32 ok = VD_TRUE;
+    Vduptr expect = 0;
+    for (Vduptr i = 1; i <= 4; ++i) {
+        expect += i;
+        ok = ok && ((Vduptr)vd_fiber_resume(f, (void*)i) == expect);
     }
-    VD_TEST_EQ("Fixed array has correct length", VD_FIXEDARRAY_LEN(array), 30);
+    VD_TEST_TRUE("Values pass both ways", ok);
+    VD_TEST_TRUE("Finishing returns 0", vd_fiber_resume(f, (void*)5) == 0);
+    VD_TEST_EQ("Finished fibers are done", vd_fiber_get_state(f), VD_FIBER_STATE_DONE);
+    VD_TEST_TRUE("The fiber ran to completion", result == 15);
+    VD_TEST_TRUE("No fiber outside of one", vd_fiber_current() == 0);
+
+    int depth = 0;
+    vd_fiber_reset(f, vd__test_fiber_deep, &depth);
+    VD_TEST_TRUE("Reset fibers run again", vd_fiber_resume(f, 0) == f);
+    VD_TEST_EQ("Deep calls fit the stack", depth, 64);
+    vd_fiber_resume(f, 0);
+    vd_fiber_destroy(f);
+
+    VdFiber *g = vd_fiber_create_arena(Test_Arena, vd__test_fiber_counter, &result, VD_KILOBYTES(16));
+    result = 0;
+    vd_fiber_resume(g, 0);
+    for (Vduptr i = 1; i <= 5; ++i) vd_fiber_resume(g, (void*)i);
+    VD_TEST_TRUE("Arena stacks work", (vd_fiber_get_state(g) == VD_FIBER_STATE_DONE) && (result == 15));
+    vd_fiber_destroy(g);
+    VD_TEST_OK();
+}
 
-    VD_FIXEDARRAY_CLEAR(array);
-    VD_TEST_EQ("Fixed array has correct length when cleared", VD_FIXEDARRAY_LEN(array), 0);
+#define VD__TEST_FIBER_COUNT 16
 
-    for (int i = 0; i < 30; ++i) {
-        VD_FIXEDARRAY_ADD(array, i);
-        VD_TEST_EQ("Fixed array insertion after clear is ok", array[i], i);
+typedef struct {
+    VdFiber        *parked[VD__TEST_FIBER_COUNT];
+    volatile Vdu32 parked_flags[VD__TEST_FIBER_COUNT];
+    volatile Vdu32 work;
+    volatile Vdu32 wakes;
+} Vd__TestFiberShared;
+
+typedef struct {
+    Vd__TestFiberShared *shared;
+    Vdu32               index;
+} Vd__TestFiberTask;
+
+static VD_PROC_FIBER(vd__test_fiber_task)
+{
+    Vd__TestFiberTask   *task   = (Vd__TestFiberTask*)userdata;
+    Vd__TestFiberShared *shared = task->shared;
+
+    for (int round = 0; round < 3; ++round) {
+        vd_atomic_fetch_add_u32(&shared->work, 1);
+        vd_fiber_yield(0);
+
+        // Pretend to wait on I/O; the idle hook plays the completion
+        shared->parked[task->index] = fiber;
+        vd_atomic_store_u32(&shared->parked_flags[task->index], 1);
+        vd_fiber_park();
     }
-    VD_TEST_EQ("Fixed array has correct length after clear and repopulate", VD_FIXEDARRAY_LEN(array), 30);
+}
 
-    for (int i = 29; i >= 0; --i) {
-        int c = VD_FIXEDARRAY_POP(array);
-        VD_TEST_EQ("Array pop i is correct", c, i);
+static VD_PROC_FIBER_IDLE(vd__test_fiber_idle)
+{
+    Vd__TestFiberShared *shared = (Vd__TestFiberShared*)userdata;
+    Vdb32 progress = VD_FALSE;
+    for (Vdu32 i = 0; i < VD__TEST_FIBER_COUNT; ++i) {
+        if (vd_atomic_cas_u32(&shared->parked_flags[i], 1, 0)) {
+            vd_atomic_fetch_add_u32(&shared->wakes, 1);
+            vd_fiber_scheduler_ready(scheduler, shared->parked[i]);
+            progress = VD_TRUE;
+        }
     }
+    return progress;
+}
 
-    VD_TEST_EQ("Fixed array has correct length after n pops", VD_FIXEDARRAY_LEN(array), 0);
+VD_TEST("Fiber/Scheduler") {
+    Vd__TestFiberShared shared = {0};
+    Vd__TestFiberTask tasks[VD__TEST_FIBER_COUNT];
 
+    VdFiberScheduler scheduler;
+    vd_fiber_scheduler_init(&scheduler, vd__test_fiber_idle, &shared);
+    for (Vdu32 i = 0; i < VD__TEST_FIBER_COUNT; ++i) {
+        tasks[i].shared = &shared;
+        tasks[i].index  = i;
+        VdFiber *f = vd_fiber_create_arena(Test_Arena, vd__test_fiber_task, &tasks[i], VD_KILOBYTES(32));
+        vd_fiber_scheduler_spawn(&scheduler, f);
+    }
+
+    vd_fiber_scheduler_run(&scheduler, 2);
+    VD_TEST_EQ("Every fiber did its work", shared.work, VD__TEST_FIBER_COUNT * 3);
+    VD_TEST_EQ("Every park was woken", shared.wakes, VD__TEST_FIBER_COUNT * 3);
+    VD_TEST_EQ("Nothing is left running", scheduler.live, 0);
+    VD_TEST_TRUE("The queue is empty", scheduler.head == 0);
     VD_TEST_OK();
 }
 
-VD_TEST("DynArray/Basic") {
-    VD_DYNARRAY int *array = 0; 
-    VD_DYNARRAY_INIT(array, Test_Arena);
+#define VD__TEST_FIBER_EARLY_ROUNDS 50
 
-    for (int i = 0; i < 30; ++i) {
-        VD_DYNARRAY_ADD(array, i);
-        VD_TEST_EQ("Dynamic array insertion is correct", array[i], i);
-    }
-    VD_TEST_EQ("Dynamic array has correct length", VD_DYNARRAY_LEN(array), 30);
+static VD_PROC_FIBER(vd__test_fiber_early_task)
+{
+    Vd__TestFiberTask   *task   = (Vd__TestFiberTask*)userdata;
+    Vd__TestFiberShared *shared = task->shared;
 
-    VD_DYNARRAY_CLEAR(array);
-    VD_TEST_EQ("Dynamic array has correct length when cleared", VD_DYNARRAY_LEN(array), 0);
+    for (int round = 0; round < VD__TEST_FIBER_EARLY_ROUNDS; ++round) {
+        vd_atomic_fetch_add_u32(&shared->work, 1);
 
-    for (int i = 0; i < 30; ++i) {
-        VD_DYNARRAY_ADD(array, i);
-        VD_TEST_EQ("Dynamic array insertion after clear is ok", array[i], i);
-    }
-    VD_TEST_EQ("Dynamic array has correct length after clear and repopulate", VD_DYNARRAY_LEN(array), 30);
+        if (round & 1) {
+            // Wake before parking, every time
+            vd_atomic_fetch_add_u32(&shared->wakes, 1);
+            vd_fiber_scheduler_ready(fiber->scheduler, fiber);
+        } else {
+            // Yield between publishing and parking, so the idle hook can get to it first
+            shared->parked[task->index] = fiber;
+            vd_atomic_store_u32(&shared->parked_flags[task->index], 1);
+            vd_fiber_yield(0);
+        }
 
-    for (int i = 29; i >= 0; --i) {
-        int c = VD_DYNARRAY_POP(array);
-        VD_TEST_EQ("Array pop i is correct", c, i);
+        vd_fiber_park();
     }
+}
 
-    VD_TEST_EQ("Dynamic array has correct length after n pops", VD_DYNARRAY_LEN(array), 0);
+VD_TEST("Fiber/SchedulerEarlyWake") {
+    Vd__TestFiberShared shared = {0};
+    Vd__TestFiberTask tasks[VD__TEST_FIBER_COUNT];
+
+    VdFiberScheduler scheduler;
+    vd_fiber_scheduler_init(&scheduler, vd__test_fiber_idle, &shared);
+    for (Vdu32 i = 0; i < VD__TEST_FIBER_COUNT; ++i) {
+        tasks[i].shared = &shared;
+        tasks[i].index  = i;
+        VdFiber *f = vd_fiber_create_arena(Test_Arena, vd__test_fiber_early_task, &tasks[i], VD_KILOBYTES(32));
+        vd_fiber_scheduler_spawn(&scheduler, f);
+    }
 
+    vd_fiber_scheduler_run(&scheduler, 4);
+    VD_TEST_EQ("Every fiber did its work", shared.work, VD__TEST_FIBER_COUNT * VD__TEST_FIBER_EARLY_ROUNDS);
+    VD_TEST_EQ("Every park was woken", shared.wakes, VD__TEST_FIBER_COUNT * VD__TEST_FIBER_EARLY_ROUNDS);
+    VD_TEST_EQ("Nothing is left running", scheduler.live, 0);
+    VD_TEST_TRUE("The queue is empty", scheduler.head == 0);
     VD_TEST_OK();
 }
+#endif // VD_FIBER_SUPPORTED
 
 /**
  * @note: Uncomment this line to print the map for debugging purposes
@@ -4185,6 +13111,200 @@ VD_TEST("KVMap/Basic") {
     VD_TEST_OK();
 }
 
+VD_TEST("MapImage/Strmap") {
+    VD_STRMAP int *map = 0;
+    VD_STRMAP_INIT(map, Test_Arena, 64, 0);
+
+    char keybuf[64][48];
+    for (int i = 0; i < 48; ++i) {
+        // Every third key is longer than the inline key prefix
+        snprintf(keybuf[i], sizeof(keybuf[i]), (i % 3) ? "key_%d" : "a_much_longer_key_than_the_prefix_%d", i);
+        int v = i * 10;
+        VD_STRMAP_SET(map, vd_str_from_cstr(keybuf[i]), &v);
+    }
+    VD_TEST_TRUE("Removing a key works", VD_STRMAP_RM(map, VD_LIT("key_1")));
+
+    Vdusize size = vd_strmap_image_size(map);
+    void *buf = vd_arena_alloc_align(Test_Arena, size, 8);
+    VD_TEST_EQ("Write returns the computed size", vd_strmap_image_write(map, buf, size), size);
+    VD_TEST_EQ("Write fails on a short buffer", vd_strmap_image_write(map, buf, size - 1), 0);
+
+    VdMapImage image;
+    VD_TEST_EQ("Image opens", vd_strmap_image_open(&image, buf, size), VD_MAP_IMAGE_OK);
+    VD_TEST_EQ("Count is preserved", VD_MAP_IMAGE_COUNT(&image), VD_STRMAP_COUNT(map));
+
+    Vdb32 ok = VD_TRUE;
+    for (int i = 0; i < 48; ++i) {
+        VdStr key = vd_str_from_cstr(keybuf[i]);
+        int expected, got = -1;
+        Vdb32 in_map   = VD_STRMAP_GET(map, key, &expected);
+        Vdb32 in_image = vd_strmap_image_get(&image, key, &got);
+        ok = ok && (in_map == in_image) && (!in_map || (expected == got));
+    }
+    VD_TEST_TRUE("Every lookup matches the map", ok);
+    VD_TEST_TRUE("Missing keys are not found", vd_strmap_image_get_ptr(&image, VD_LIT("missing")) == 0);
+
+    VD_TEST_EQ("Other kinds are rejected", vd_kvmap_image_open(&image, buf, size), VD_MAP_IMAGE_ERROR_WRONG_KIND);
+    VD_TEST_EQ("Truncated images are rejected", vd_strmap_image_open(&image, buf, size - 8), VD_MAP_IMAGE_ERROR_TOO_SMALL);
+
+    VdMapImageHeader *h = (VdMapImageHeader*)buf;
+    h->hash_seed++;
+    VD_TEST_EQ("Hash seed is checked", vd_strmap_image_open(&image, buf, size), VD_MAP_IMAGE_ERROR_HASH_MISMATCH);
+    h->hash_seed--;
+    h->version++;
+    VD_TEST_EQ("Version is checked", vd_strmap_image_open(&image, buf, size), VD_MAP_IMAGE_ERROR_BAD_VERSION);
+    VD_TEST_OK();
+}
+
+VD_TEST("MapImage/KVMap") {
+    VD_KVMAP Vd__TestKVMapKV *map = 0;
+    VD_KVMAP_INIT(map, Test_Arena, 32, 0);
+
+    for (int i = 0; i < 24; ++i) {
+        Vd__TestKVMapKey key = { .a = i, .b = i * 2 };
+        int value = i * 3;
+        VD_KVMAP_SET(map, &key, &value);
+    }
+
+    Vdusize size = vd_kvmap_image_size(map);
+    void *buf = vd_arena_alloc_align(Test_Arena, size, 8);
+    vd_kvmap_image_write(map, buf, size);
+
+    VdMapImage image;
+    VD_TEST_EQ("Image opens", vd_kvmap_image_open(&image, buf, size), VD_MAP_IMAGE_OK);
+
+    Vdb32 ok = VD_TRUE;
+    for (int i = 0; i < 24; ++i) {
+        Vd__TestKVMapKey key = { .a = i, .b = i * 2 };
+        int value = -1;
+        ok = ok && vd_kvmap_image_get(&image, &key, &value) && (value == i * 3);
+    }
+    VD_TEST_TRUE("Every key is found with its value", ok);
+
+    Vd__TestKVMapKey missing = { .a = 1, .b = 1 };
+    VD_TEST_TRUE("Missing keys are not found", vd_kvmap_image_get_ptr(&image, &missing) == 0);
+    VD_TEST_OK();
+}
+
+VD_TEST("ArenaSnapshot/Relocate") {
+    typedef struct Vd__TestSnapNode Vd__TestSnapNode;
+    struct Vd__TestSnapNode {
+        Vd__TestSnapNode *next;
+        Vd__TestSnapNode *prev;
+        VdStr            name;
+        Vdu64            value;
+        Vduptr           lookalike;
+    };
+
+    static const Vdu32 node_ptrs[] = {
+        VD_OFFSET_OF(Vd__TestSnapNode, next),
+        VD_OFFSET_OF(Vd__TestSnapNode, prev),
+    };
+
+    VdArena arena;
+    vd_arena_init(&arena, vd_arena_alloc_align(Test_Arena, VD_KILOBYTES(16), 64), VD_KILOBYTES(16));
+
+    VdArenaSnapshotRelocs relocs;
+    vd_arena_snapshot_relocs_init(&relocs, Test_Arena);
+
+    Vd__TestSnapNode *first = 0;
+    Vd__TestSnapNode *last  = 0;
+    for (int i = 0; i < 32; ++i) {
+        Vd__TestSnapNode *node = VD_ARENA_PUSH_STRUCT(&arena, Vd__TestSnapNode);
+        node->name      = vd_str_dup(&arena, (i % 2) ? VD_LIT("odd") : VD_LIT("even"));
+        node->value     = (Vdu64)i * 7;
+        node->lookalike = (Vduptr)node;
+        node->prev      = last;
+        if (last) last->next = node; else first = node;
+        last = node;
+
+        vd_arena_snapshot_add_ptrs(&relocs, node, node_ptrs, VD_ARRAY_COUNT(node_ptrs));
+        VD_ARENA_SNAPSHOT_ADD_FIELD(&relocs, node, name.s);
+    }
+
+    Vdusize size = vd_arena_snapshot_size(&arena, &relocs);
+    void *image = vd_arena_alloc_align(Test_Arena, size, 8);
+    VD_TEST_EQ("Snapshot is written", vd_arena_snapshot_write(&arena, &relocs, first, image, size), size);
+    VD_TEST_EQ("Short buffers are rejected", vd_arena_snapshot_write(&arena, &relocs, first, image, size - 8), 0);
+
+    VdArenaSnapshotRelocs bad;
+    vd_arena_snapshot_relocs_init(&bad, Test_Arena);
+    VD_ARENA_SNAPSHOT_ADD_FIELD(&bad, first, next);
+    VD_ARENA_SNAPSHOT_ADD_FIELD(&bad, first, next);
+    void *bad_image = vd_arena_alloc_align(Test_Arena, vd_arena_snapshot_size(&arena, &bad), 8);
+    VD_TEST_EQ("Slots registered twice are rejected",
+               vd_arena_snapshot_write(&arena, &bad, first, bad_image, vd_arena_snapshot_size(&arena, &bad)), 0);
+
+    void *outside_slot = first;
+    vd_arena_snapshot_relocs_init(&bad, Test_Arena);
+    vd_arena_snapshot_add_ptr(&bad, &outside_slot);
+    VD_TEST_EQ("Slots outside the arena are rejected",
+               vd_arena_snapshot_write(&arena, &bad, first, bad_image, vd_arena_snapshot_size(&arena, &bad)), 0);
+
+    Vduptr *source_lookalikes = VD_ARENA_PUSH_ARRAY(Test_Arena, Vduptr, 32);
+    {
+        int i = 0;
+        for (Vd__TestSnapNode *n = first; n != 0; n = n->next) source_lookalikes[i++] = n->lookalike;
+    }
+
+    // Scribble over the source so that any pointer left pointing into it is caught.
+    VD_MEMSET(arena.buf, 0xCD, arena.curr_offset);
+
+    void *root = 0;
+    VD_TEST_EQ("Snapshot loads", vd_arena_snapshot_load(Test_Arena, image, size, &root), VD_ARENA_SNAPSHOT_OK);
+
+    Vdb32 ok = VD_TRUE;
+    int count = 0;
+    Vd__TestSnapNode *prev = 0;
+    for (Vd__TestSnapNode *n = (Vd__TestSnapNode*)root; n != 0; prev = n, n = n->next, ++count) {
+        ok = ok && (n->prev == prev) && (n->value == (Vdu64)count * 7);
+        ok = ok && vd_str_eq(n->name, (count % 2) ? VD_LIT("odd") : VD_LIT("even"));
+        ok = ok && (n->lookalike == source_lookalikes[count]);
+    }
+    VD_TEST_TRUE("Loaded list is intact and unregistered words are untouched", ok && (count == 32));
+
+    // Fix up a copy in place, twice (the second one is a no-op).
+    void *copy = vd_arena_alloc_align(Test_Arena, size, 8);
+    VD_MEMCPY(copy, image, size);
+    VD_TEST_EQ("Fixup works", vd_arena_snapshot_fixup(copy, size, &root), VD_ARENA_SNAPSHOT_OK);
+    VD_TEST_EQ("Fixup is idempotent", vd_arena_snapshot_fixup(copy, size, &root), VD_ARENA_SNAPSHOT_OK);
+    count = 0;
+    for (Vd__TestSnapNode *n = (Vd__TestSnapNode*)root; n != 0; n = n->next) count++;
+    VD_TEST_EQ("Fixed up list is intact", count, 32);
+
+    ((VdArenaSnapshotHeader*)copy)->magic = 0;
+    VD_TEST_EQ("Bad magic is detected", vd_arena_snapshot_fixup(copy, size, &root),
+               VD_ARENA_SNAPSHOT_ERROR_BAD_MAGIC);
+    VD_TEST_EQ("Truncated images are detected", vd_arena_snapshot_load(Test_Arena, image, size - 8, &root),
+               VD_ARENA_SNAPSHOT_ERROR_TOO_SMALL);
+    VD_TEST_OK();
+}
+
+VD_TEST("ArenaSnapshot/RelPtr") {
+    typedef struct {
+        VdRelPtr next;
+        int      value;
+    } Vd__TestRelNode;
+
+    Vd__TestRelNode *nodes = VD_ARENA_PUSH_ARRAY(Test_Arena, Vd__TestRelNode, 4);
+    for (int i = 0; i < 4; ++i) {
+        nodes[i].value = i;
+        VD_RELPTR_SET(nodes[i].next, (i < 3) ? &nodes[i + 1] : (Vd__TestRelNode*)0);
+    }
+
+    Vd__TestRelNode *moved = VD_ARENA_PUSH_ARRAY(Test_Arena, Vd__TestRelNode, 4);
+    VD_MEMCPY(moved, nodes, sizeof(*nodes) * 4);
+    VD_MEMSET(nodes, 0, sizeof(*nodes) * 4);
+
+    int sum = 0, count = 0;
+    for (Vd__TestRelNode *n = moved; n != 0; n = VD_RELPTR_GET(Vd__TestRelNode, n->next)) {
+        sum += n->value;
+        count++;
+    }
+    VD_TEST_TRUE("Self-relative list survives a move", (count == 4) && (sum == 6));
+    VD_TEST_OK();
+}
+
 #undef VD__TEST_MAP_CHECK_ENTRIES_
 #undef VD__TEST_MAP_CHECK_ENTRIES
 
@@ -45,52 +45,467 @@
 #define VD_DEBUG_MAX_FRAMES 60
 #endif // !VD_DEBUG_MAX_FRAMES
 
-#define VD_DEBUG_ID(name) VD_STRING_JOIN2(vd__debug__id, name)
+#ifndef VD_DEBUG_MAX_THREADS
+#define VD_DEBUG_MAX_THREADS 64
+#endif // !VD_DEBUG_MAX_THREADS
 
+// Finished zones a thread can hold until the next frame end collects them. Must be a power of two.
+#ifndef VD_DEBUG_THREAD_RING_ZONES
+#define VD_DEBUG_THREAD_RING_ZONES 4096
+#endif // !VD_DEBUG_THREAD_RING_ZONES
+
+#ifndef VD_DEBUG_MAX_DEPTH
+#define VD_DEBUG_MAX_DEPTH 64
+#endif // !VD_DEBUG_MAX_DEPTH
+
+// Distinct VD_DEBUG_ZONE_BEGIN call sites that can be recorded; zones at sites past the limit are dropped
+#ifndef VD_DEBUG_MAX_SITES
+#define VD_DEBUG_MAX_SITES 4096
+#endif // !VD_DEBUG_MAX_SITES
+
+// Counter and gauge samples a frame can hold
+#ifndef VD_DEBUG_MAX_SAMPLES
+#define VD_DEBUG_MAX_SAMPLES 256
+#endif // !VD_DEBUG_MAX_SAMPLES
+
+#if (VD_DEBUG_MAX_THREADS > 256) || (VD_DEBUG_MAX_DEPTH > 256) || (VD_DEBUG_MAX_SITES > 65536)
+#error "VdDebugZone packs threads and depths into 8 bits, and sites into 16 bits"
+#endif // (VD_DEBUG_MAX_THREADS > 256) || (VD_DEBUG_MAX_DEPTH > 256) || (VD_DEBUG_MAX_SITES > 65536)
+
+#define VD_DEBUG_ID(name)      VD_STRING_JOIN2(vd__debug__id, name)
+#define VD_DEBUG_SITE_ID(name) VD_STRING_JOIN2(vd__debug__site, name)
+
+typedef enum {
+    VD_DEBUG_SITE_KIND_ZONE = 0,
+    /** Samples are amounts; a frame's value is their sum. */
+    VD_DEBUG_SITE_KIND_COUNTER,
+    /** Samples are levels; a frame's value is the last one. */
+    VD_DEBUG_SITE_KIND_GAUGE,
+} VdDebugSiteKind;
+
+/**
+ * @brief What a zone's (or sample's) call site knows at compile time. The recording macros keep one in static storage
+ *        per call site and register it the first time they record, so records only need to refer to it by index.
+ */
+typedef struct __VD_Debug_Site {
+    const char     *name;
+    const char     *file;
+    const char     *function;
+    Vdu32          line;
+    /** A VdDebugSiteKind. */
+    Vdu32          kind;
+    /** The site's index + 1 once registered, 0 before. */
+    volatile Vdu32 id;
+} VdDebugSite;
+
+/**
+ * @brief A recorded zone, packed into 16 bytes. Times are the low 48 bits of vd_cpu_ticks, which only makes sense next
+ *        to the frame the zone was collected in; read zones through the vd_debug_zone_* procedures.
+ */
 typedef struct __VD_Debug_Zone {
-    const char *name;
-    VdHiTime    begin_time;
-    const char *file;
-    Vdu64      line;
-    const char *function;
-    Vdu64      id;
-    VdHiTime   end_time;
+    /** Bits 0-47: begin ticks. Bits 48-63: the site's index. */
+    Vdu64 begin;
+    /** Bits 0-47: end ticks. Bits 48-55: the recording thread. Bits 56-63: nesting depth on that thread. */
+    Vdu64 end;
 } VdDebugZone;
 
+/**
+ * @brief A counter or gauge sample.
+ */
+typedef struct __VD_Debug_Sample {
+    /** Bits 0-47: ticks when the sample was taken. Bits 48-63: the site's index. */
+    Vdu64 time;
+    Vdf64 value;
+} VdDebugSample;
+
+/**
+ * @brief The zones of every thread that ended between the previous frame end and this one. They are grouped by thread,
+ *        and each thread's zones are in begin order, parents before their children.
+ */
 typedef struct __VD_Debug_Frame {
-    Vdu32       num_zones;
-    Vdu32       current_zone_index;
-    VdDebugZone zones[VD_DEBUG_MAX_ZONES];
+    VdHiTime      begin_time;
+    VdHiTime      end_time;
+    /** vd_cpu_ticks at end_time. */
+    Vdu64         end_ticks;
+    /** Counts every frame ended since VD_DEBUG_INIT, paused frames excepted. */
+    Vdu64         index;
+    Vdu32         num_zones;
+    /** Zones and samples that were lost because zones[], samples[] or their thread's ring was full. */
+    Vdu32         num_dropped;
+    Vdu32         num_samples;
+    VdDebugZone   zones[VD_DEBUG_MAX_ZONES];
+    /** In the order they were taken. */
+    VdDebugSample samples[VD_DEBUG_MAX_SAMPLES];
 } VdDebugFrame;
 
 extern void          vd__debug_init(void);
 extern void          vd__debug_frame_begin(void);
-extern VdDebugZone*  vd__debug_zone_begin(const char *id, const char *file, Vdu64 line, const char *function, Vdu64 unique_id);
+extern VdDebugZone*  vd__debug_zone_begin(VdDebugSite *site);
 extern void          vd__debug_zone_end(VdDebugZone *zone);
+extern void          vd__debug_sample(VdDebugSite *site, Vdf64 value);
 extern void          vd__debug_frame_end(void);
 
 extern void          vd_debug_pause(Vdb32 pause);
 extern Vdb32         vd_debug_is_paused(void);
 extern Vdusize       vd_debug_get_num_frames(void);
 extern VdDebugFrame* vd_debug_get_frame(Vdusize i);
+extern Vdu32         vd_debug_get_num_threads(void);
+extern Vdu32         vd_debug_get_num_sites(void);
+extern VdDebugSite*  vd_debug_get_site(Vdu32 index);
 
 extern Vdusize       vd_debug_frame_get_num_zones(VdDebugFrame *frame);
 extern VdDebugZone*  vd_debug_frame_get_zone(VdDebugFrame *frame, Vdusize i);
+extern Vdu32         vd_debug_frame_get_num_dropped(VdDebugFrame *frame);
+extern Vdf64         vd_debug_frame_get_ms(VdDebugFrame *frame);
+extern Vdusize       vd_debug_frame_get_num_samples(VdDebugFrame *frame);
+extern VdDebugSample* vd_debug_frame_get_sample(VdDebugFrame *frame, Vdusize i);
+/**
+ * @brief The value of a counter or gauge site in frame: the sum of a counter's samples, or a gauge's last sample.
+ *        Returns false if the site has no samples in the frame.
+ */
+extern Vdb32         vd_debug_frame_get_value(VdDebugFrame *frame, VdDebugSite *site, Vdf64 *value);
 
+extern VdDebugSite*  vd_debug_zone_get_site(VdDebugZone *zone);
+extern Vdu32         vd_debug_zone_get_site_index(VdDebugZone *zone);
+/**
+ * @brief The recording thread, numbered in the order threads first began a zone.
+ */
+extern Vdu32         vd_debug_zone_get_thread(VdDebugZone *zone);
+/**
+ * @brief Nesting depth on the recording thread; 0 for outermost zones.
+ */
+extern Vdu32         vd_debug_zone_get_depth(VdDebugZone *zone);
 extern Vdf64         vd_debug_zone_get_ms(VdDebugZone *zone);
+/**
+ * @brief When zone, collected in frame, began and ended, on the clock of vd_hitime_ns.
+ */
+extern Vdu64         vd_debug_zone_get_begin_ns(VdDebugFrame *frame, VdDebugZone *zone);
+extern Vdu64         vd_debug_zone_get_end_ns(VdDebugFrame *frame, VdDebugZone *zone);
+
+extern VdDebugSite*  vd_debug_sample_get_site(VdDebugSample *sample);
+extern Vdu64         vd_debug_sample_get_ns(VdDebugFrame *frame, VdDebugSample *sample);
+
+/**
+ * @brief Names the calling thread in exported traces.
+ */
+extern void          vd_debug_set_thread_name(const char *name);
+extern const char*   vd_debug_get_thread_name(Vdu32 thread);
+/**
+ * @brief The operating system's id for a VdDebugZone.thread, as shown in exported traces.
+ */
+extern Vdu32         vd_debug_get_thread_os_id(Vdu32 thread);
+
+typedef enum {
+    /** Chrome's Trace Event Format (JSON array), opened by chrome://tracing and ui.perfetto.dev. */
+    VD_DEBUG_TRACE_FORMAT_CHROME_JSON = 0,
+    /** Perfetto's protobuf trace (TracePacket/TrackEvent), opened by ui.perfetto.dev and trace_processor. */
+    VD_DEBUG_TRACE_FORMAT_PERFETTO,
+} VdDebugTraceFormat;
+
+#define VD_PROC_DEBUG_TRACE_WRITE(name) void name(const void *data, Vdusize size, void *userdata)
+typedef VD_PROC_DEBUG_TRACE_WRITE(VdProcDebugTraceWrite);
+
+// Bytes a trace buffers before calling its write procedure
+#ifndef VD_DEBUG_TRACE_BUFFER_SIZE
+#define VD_DEBUG_TRACE_BUFFER_SIZE (64 * 1024)
+#endif // !VD_DEBUG_TRACE_BUFFER_SIZE
+
+/**
+ * @brief Writes frames as a trace, in chunks of at most VD_DEBUG_TRACE_BUFFER_SIZE bytes, through a write procedure.
+ *        Zones become slices on their thread's track (with file, line and function as arguments), frames become
+ *        slices on a separate "Frames" track, and counters and gauges become counter tracks.
+ *
+ * @details Either write frames already captured (vd_debug_trace_write_history), or pass the trace to
+ *          vd_debug_trace_stream so that every frame is written as it ends; memory use stays the same however long the
+ *          capture runs. JSON traces are valid even if vd_debug_trace_end never runs, since the closing bracket of the
+ *          array format is optional.
+ */
+typedef struct __VD_Debug_Trace {
+    VdDebugTraceFormat    format;
+    VdProcDebugTraceWrite *write;
+    void                  *userdata;
+    Vdu64                 base_ns;
+    Vdu64                 num_frames;
+    Vdu64                 num_events;
+    Vdu64                 num_bytes;
+    Vdu8                  described[VD_DEBUG_MAX_THREADS];
+    Vdu8                  described_sites[(VD_DEBUG_MAX_SITES + 7) / 8];
+    Vdusize               len;
+    Vdu8                  buf[VD_DEBUG_TRACE_BUFFER_SIZE];
+} VdDebugTrace;
+
+extern void          vd_debug_trace_begin(VdDebugTrace *trace, VdDebugTraceFormat format, VdProcDebugTraceWrite *write, void *userdata);
+extern void          vd_debug_trace_write_frame(VdDebugTrace *trace, VdDebugFrame *frame);
+/**
+ * @brief Writes every frame in the history, oldest first.
+ */
+extern void          vd_debug_trace_write_history(VdDebugTrace *trace);
+/**
+ * @brief Makes every frame end write the frame to trace (from the thread ending frames). Pass 0 to stop.
+ */
+extern void          vd_debug_trace_stream(VdDebugTrace *trace);
+extern void          vd_debug_trace_flush(VdDebugTrace *trace);
+/**
+ * @brief Finishes the trace and flushes it. Stops streaming into it.
+ */
+extern void          vd_debug_trace_end(VdDebugTrace *trace);
+
+#if VD_USE_CRT
+/**
+ * @brief A VdProcDebugTraceWrite that fwrites to the FILE* passed as userdata.
+ */
+extern VD_PROC_DEBUG_TRACE_WRITE(vd_debug_trace_write_file);
+#endif // VD_USE_CRT
+
+#define VD_DEBUG_STATS_NO_NODE 0xFFFFFFFF
+
+/**
+ * @brief Per-frame times of a zone site, over the frames it ran in.
+ */
+typedef struct __VD_Debug_Time_Stats {
+    Vdf64 mean_ms;
+    Vdf64 p50_ms;
+    Vdf64 p95_ms;
+    Vdf64 p99_ms;
+    Vdf64 max_ms;
+} VdDebugTimeStats;
+
+/**
+ * @brief A zone site reached through one particular chain of parent sites.
+ */
+typedef struct __VD_Debug_Stats_Node {
+    VdDebugSite      *site;
+    /** Node indices; VD_DEBUG_STATS_NO_NODE where there is none. Children are in the order they were first seen. */
+    Vdu32            parent;
+    Vdu32            first_child;
+    Vdu32            next_sibling;
+    Vdu32            depth;
+    /** The zones recorded at this node, and the number of frames they were recorded in. */
+    Vdu64            count;
+    Vdu32            num_frames;
+    /** This node's entries in VdDebugStats.samples, one per frame it ran in, oldest first. */
+    Vdu32            first_sample;
+    /** Totals over every frame. Self time is inclusive time minus the inclusive time of the node's children. */
+    Vdf64            inclusive_ms;
+    Vdf64            self_ms;
+    VdDebugTimeStats inclusive;
+    VdDebugTimeStats self;
+} VdDebugStatsNode;
+
+typedef struct __VD_Debug_Stats_Sample {
+    /** Index into VdDebugStats.frames. */
+    Vdu32 frame;
+    Vdf64 inclusive_ms;
+    Vdf64 self_ms;
+} VdDebugStatsSample;
+
+/**
+ * @brief A counter or gauge site's per-frame values (see vd_debug_frame_get_value), over the frames it was sampled in.
+ */
+typedef struct __VD_Debug_Stats_Value {
+    VdDebugSite *site;
+    Vdu32       num_frames;
+    Vdf64       min;
+    Vdf64       max;
+    Vdf64       mean;
+    /** The value in the newest of those frames. */
+    Vdf64       last;
+} VdDebugStatsValue;
+
+typedef struct __VD_Debug_Stats_Frame {
+    /** VdDebugFrame.index */
+    Vdu64 index;
+    Vdf64 ms;
+} VdDebugStatsFrame;
+
+/**
+ * @brief The call tree of the last frames in the history, with each node's times aggregated across them. A zone's
+ *        parent is the zone on the same thread, one level shallower, that encloses it; zones whose parent was not
+ *        recorded (dropped, or still open when the frame ended) attach to the nearest enclosing ancestor, or become
+ *        roots.
+ */
+typedef struct __VD_Debug_Stats {
+    VdDebugStatsNode   *nodes;
+    Vdu32              num_nodes;
+    /** The first root node, or VD_DEBUG_STATS_NO_NODE; further roots follow through next_sibling. */
+    Vdu32              first_root;
+    VdDebugStatsSample *samples;
+    VdDebugStatsFrame  *frames;
+    Vdu32              num_frames;
+    VdDebugTimeStats   frame_ms;
+    /** One per counter or gauge site, in the order they were first sampled. */
+    VdDebugStatsValue  *values;
+    Vdu32              num_values;
+} VdDebugStats;
+
+/**
+ * @brief A frame slower than usual, and the node that explains most of it.
+ */
+typedef struct __VD_Debug_Spike {
+    /** Index into VdDebugStats.frames. */
+    Vdu32 frame;
+    Vdf64 frame_ms;
+    /** The node whose self time grew the most over its median, or VD_DEBUG_STATS_NO_NODE if none grew. */
+    Vdu32 node;
+    Vdf64 self_ms;
+    Vdf64 growth_ms;
+} VdDebugSpike;
+
+/**
+ * @brief The arena space vd_debug_stats_build needs for the last num_frames frames (an upper bound).
+ */
+extern Vdusize       vd_debug_stats_get_memory(Vdusize num_frames);
+/**
+ * @brief Aggregates the last num_frames frames of the history (at most vd_debug_get_num_frames()) into stats. Frames
+ *        that never ended are skipped. Everything stats points to is allocated from arena.
+ */
+extern void          vd_debug_stats_build(VdDebugStats *stats, VdArena *arena, Vdusize num_frames);
+/**
+ * @brief Finds the frames that took more than factor times the median frame time (oldest first), and for each the node
+ *        whose self time grew the most over its own median. Returns the number of spikes written.
+ */
+extern Vdu32         vd_debug_stats_find_spikes(VdDebugStats *stats, Vdf64 factor, VdDebugSpike *spikes, Vdu32 max_spikes);
+
+#ifdef VD_UI_H
+// Frames at least this many times slower than the median are marked as spikes on the timeline
+#ifndef VD_DEBUG_UI_SPIKE_FACTOR
+#define VD_DEBUG_UI_SPIKE_FACTOR 2.0
+#endif // !VD_DEBUG_UI_SPIKE_FACTOR
+
+// The frame budget drawn on the timeline, in milliseconds
+#ifndef VD_DEBUG_UI_TARGET_MS
+#define VD_DEBUG_UI_TARGET_MS (1000.0 / 60.0)
+#endif // !VD_DEBUG_UI_TARGET_MS
+
+// Zones narrower than this many pixels (and the gaps between them) are merged into one bar
+#ifndef VD_DEBUG_UI_MERGE_PX
+#define VD_DEBUG_UI_MERGE_PX 2.0f
+#endif // !VD_DEBUG_UI_MERGE_PX
+
+// The most quads vd_debug_ui_panel_draw pushes; whatever doesn't fit is left out
+#ifndef VD_DEBUG_UI_MAX_QUADS
+#define VD_DEBUG_UI_MAX_QUADS 16384
+#endif // !VD_DEBUG_UI_MAX_QUADS
+
+// Widths of a frame on the timeline and heights of a flame graph row, in pixels before vd_ui_get_scale
+#ifndef VD_DEBUG_UI_FRAME_PX
+#define VD_DEBUG_UI_FRAME_PX 6.0f
+#endif // !VD_DEBUG_UI_FRAME_PX
+
+#ifndef VD_DEBUG_UI_ROW_PX
+#define VD_DEBUG_UI_ROW_PX 18.0f
+#endif // !VD_DEBUG_UI_ROW_PX
+
+// Flame graph rows shown before the deeper ones are cut off
+#ifndef VD_DEBUG_UI_FLAME_ROWS
+#define VD_DEBUG_UI_FLAME_ROWS 16
+#endif // !VD_DEBUG_UI_FLAME_ROWS
 
+// Zone table rows shown at once; the rest are reached by scrolling
+#ifndef VD_DEBUG_UI_TABLE_ROWS
+#define VD_DEBUG_UI_TABLE_ROWS 16
+#endif // !VD_DEBUG_UI_TABLE_ROWS
+
+// How often the table and the spikes are aggregated again while frames keep coming, in milliseconds
+#ifndef VD_DEBUG_UI_REFRESH_MS
+#define VD_DEBUG_UI_REFRESH_MS 250.0
+#endif // !VD_DEBUG_UI_REFRESH_MS
+
+#define VD_DEBUG_UI_NO_ZONE 0xFFFFFFFF
+
+typedef enum {
+    VD_DEBUG_UI_COLUMN_NAME = 0,
+    VD_DEBUG_UI_COLUMN_CALLS,
+    VD_DEBUG_UI_COLUMN_TOTAL,
+    VD_DEBUG_UI_COLUMN_SELF,
+    VD_DEBUG_UI_COLUMN_MEAN,
+    VD_DEBUG_UI_COLUMN_P95,
+    VD_DEBUG_UI_COLUMN_MAX,
+    VD_DEBUG_UI_COLUMN_COUNT,
+} VdDebugUiColumn;
+
+/**
+ * @brief An in-app profiler view made of vd_ui divs: a timeline of the frame history (spikes in red), a flame graph of
+ *        the selected frame, one lane per thread, and a table of the call tree aggregated over the history.
+ *
+ * @details Zero-initialize it and call vd_debug_ui_panel between vd_ui_frame_begin and vd_ui_frame_end, inside the div
+ *          it should fill. vd_ui_frame_end clears custom vertices, so the bars are pushed by vd_debug_ui_panel_draw,
+ *          between vd_ui_render_begin and vd_ui_render_end. Clicking a frame selects it; clicking a spike also pauses
+ *          capture. The mouse wheel zooms the flame graph around the cursor and dragging pans it.
+ *
+ *          Zones closer together than VD_DEBUG_UI_MERGE_PX are drawn as a single gray bar and bars outside of the view
+ *          are skipped, so drawing costs about the same for any number of zones.
+ */
+typedef struct __VD_Debug_Ui_Panel {
+    Vdb32           initialized;
+    /** The VdDebugFrame.index shown in the flame graph. The newest frame is shown until one is clicked. */
+    Vdb32           has_selection;
+    Vdu64           selected;
+    /** Frames the timeline is scrolled back from the newest one. */
+    Vdf32           scroll;
+    /** The part of the selected frame that the flame graph shows, as fractions of the frame. */
+    Vdf64           view[2];
+    VdDebugUiColumn sort;
+    Vdb32           sort_ascending;
+    Vdu32           table_scroll;
+    /** The index of the zone under the mouse, in the selected frame, or VD_DEBUG_UI_NO_ZONE. */
+    Vdu32           hovered;
+    /** The history, aggregated at most every VD_DEBUG_UI_REFRESH_MS. order holds stats' nodes in table order. */
+    VdArena         arena;
+    VdDebugStats    stats;
+    Vdu32           *order;
+    VdDebugSpike    spikes[VD_DEBUG_MAX_FRAMES];
+    Vdu32           num_spikes;
+    Vdb32           built;
+    Vdu64           built_index;
+    VdHiTime        built_time;
+    VdUiDiv         *timeline;
+    VdUiDiv         *flame;
+    /** What the last vd_debug_ui_panel_draw did: quads pushed, and zones they stand for. */
+    Vdu32           num_quads;
+    Vdu32           num_zones_drawn;
+} VdDebugUiPanel;
+
+extern void          vd_debug_ui_panel(VdDebugUiPanel *panel);
+extern void          vd_debug_ui_panel_draw(VdDebugUiPanel *panel);
+extern void          vd_debug_ui_panel_destroy(VdDebugUiPanel *panel);
+#endif // VD_UI_H
+
+/**
+ * Zones can be recorded from any thread; each thread gets its own lock-free ring the first time it begins one. Frames
+ * are begun and ended by one thread, and a frame end collects every zone, from any thread, that ended before it.
+ * Rings are kept for the life of the process, so record from long-lived (pooled) threads, not one thread per task.
+ *
+ * VD_DEBUG_COUNTER and VD_DEBUG_GAUGE sample a value (converted to Vdf64) into the same rings, and show up as counter
+ * tracks in traces. Every call site is its own track, so to add to one counter from several places, call a function
+ * that records it. When VD_DEBUG_ENABLE is off, the value expression is not evaluated.
+ */
 #if VD_DEBUG_ENABLE
-#define VD_DEBUG_INIT()           vd__debug_init()
-#define VD_DEBUG_FRAME_BEGIN()    vd__debug_frame_begin()
-#define VD_DEBUG_ZONE_BEGIN(name) VdDebugZone *VD_DEBUG_ID(name) = vd__debug_zone_begin(#name, __FILE__, __LINE__, __FUNCTION__, __COUNTER__)
-#define VD_DEBUG_ZONE_END(name)   vd__debug_zone_end(VD_DEBUG_ID(name))
-#define VD_DEBUG_FRAME_END()      vd__debug_frame_end()
+#define VD_DEBUG_INIT()               vd__debug_init()
+#define VD_DEBUG_FRAME_BEGIN()        vd__debug_frame_begin()
+#define VD_DEBUG_ZONE_BEGIN(name)                                                                                      \
+    VD__DEBUG_SITE(name, VD_DEBUG_SITE_KIND_ZONE);                                                                     \
+    VdDebugZone *VD_DEBUG_ID(name) = vd__debug_zone_begin(&VD_DEBUG_SITE_ID(name))
+#define VD_DEBUG_ZONE_END(name)       vd__debug_zone_end(VD_DEBUG_ID(name))
+#define VD_DEBUG_FRAME_END()          vd__debug_frame_end()
+#define VD_DEBUG_COUNTER(name, value) VD__DEBUG_SAMPLE(name, value, VD_DEBUG_SITE_KIND_COUNTER)
+#define VD_DEBUG_GAUGE(name, value)   VD__DEBUG_SAMPLE(name, value, VD_DEBUG_SITE_KIND_GAUGE)
+
+#define VD__DEBUG_SITE(name, kind)                                                                                     \
+    static VdDebugSite VD_DEBUG_SITE_ID(name) = { #name, __FILE__, __FUNCTION__, __LINE__, kind, 0 }
+#define VD__DEBUG_SAMPLE(name, value, kind)                                                                            \
+    do {                                                                                                               \
+        VD__DEBUG_SITE(name, kind);                                                                                    \
+        vd__debug_sample(&VD_DEBUG_SITE_ID(name), (Vdf64)(value));                                                     \
+    } while (0)
 #else
 #define VD_DEBUG_INIT()
 #define VD_DEBUG_FRAME_BEGIN()
 #define VD_DEBUG_ZONE_BEGIN(name)
 #define VD_DEBUG_ZONE_END(name)
 #define VD_DEBUG_FRAME_END()
+#define VD_DEBUG_COUNTER(name, value)
+#define VD_DEBUG_GAUGE(name, value)
 #endif // VD_DEBUG_ENABLE, else
 
 #if VD_MACRO_ABBREVIATIONS
@@ -99,33 +514,282 @@ extern Vdf64         vd_debug_zone_get_ms(VdDebugZone *zone);
 #define DEBUG_ZONE_BEGIN            VD_DEBUG_ZONE_BEGIN
 #define DEBUG_ZONE_END              VD_DEBUG_ZONE_END
 #define DEBUG_FRAME_END             VD_DEBUG_FRAME_END
+#define DEBUG_COUNTER               VD_DEBUG_COUNTER
+#define DEBUG_GAUGE                 VD_DEBUG_GAUGE
 #define DebugFrame                  VdDebugFrame
 #define DebugZone                   VdDebugZone
+#define DebugSite                   VdDebugSite
+#define DebugSiteKind               VdDebugSiteKind
+#define DebugSample                 VdDebugSample
+#define DebugTrace                  VdDebugTrace
+#define DebugTraceFormat            VdDebugTraceFormat
+#define ProcDebugTraceWrite         VdProcDebugTraceWrite
 #define debug_pause                 vd_debug_pause
 #define debug_is_paused             vd_debug_is_paused
 #define debug_get_num_frames        vd_debug_get_num_frames
 #define debug_get_frame             vd_debug_get_frame
+#define debug_get_num_threads       vd_debug_get_num_threads
+#define debug_get_num_sites         vd_debug_get_num_sites
+#define debug_get_site              vd_debug_get_site
 #define debug_frame_get_num_zones   vd_debug_frame_get_num_zones
 #define debug_frame_get_zone        vd_debug_frame_get_zone
+#define debug_frame_get_num_dropped vd_debug_frame_get_num_dropped
+#define debug_frame_get_ms          vd_debug_frame_get_ms
+#define debug_frame_get_num_samples vd_debug_frame_get_num_samples
+#define debug_frame_get_sample      vd_debug_frame_get_sample
+#define debug_frame_get_value       vd_debug_frame_get_value
+#define debug_zone_get_site         vd_debug_zone_get_site
+#define debug_zone_get_site_index   vd_debug_zone_get_site_index
+#define debug_zone_get_thread       vd_debug_zone_get_thread
+#define debug_zone_get_depth        vd_debug_zone_get_depth
 #define debug_zone_get_ms           vd_debug_zone_get_ms
+#define debug_zone_get_begin_ns     vd_debug_zone_get_begin_ns
+#define debug_zone_get_end_ns       vd_debug_zone_get_end_ns
+#define debug_sample_get_site       vd_debug_sample_get_site
+#define debug_sample_get_ns         vd_debug_sample_get_ns
+#define debug_set_thread_name       vd_debug_set_thread_name
+#define debug_get_thread_name       vd_debug_get_thread_name
+#define debug_get_thread_os_id      vd_debug_get_thread_os_id
+#define debug_trace_begin           vd_debug_trace_begin
+#define debug_trace_write_frame     vd_debug_trace_write_frame
+#define debug_trace_write_history   vd_debug_trace_write_history
+#define debug_trace_stream          vd_debug_trace_stream
+#define debug_trace_flush           vd_debug_trace_flush
+#define debug_trace_end             vd_debug_trace_end
+#define DebugTimeStats              VdDebugTimeStats
+#define DebugStatsNode              VdDebugStatsNode
+#define DebugStatsSample            VdDebugStatsSample
+#define DebugStatsFrame             VdDebugStatsFrame
+#define DebugStatsValue             VdDebugStatsValue
+#define DebugStats                  VdDebugStats
+#define DebugSpike                  VdDebugSpike
+#define debug_stats_get_memory      vd_debug_stats_get_memory
+#define debug_stats_build           vd_debug_stats_build
+#define debug_stats_find_spikes     vd_debug_stats_find_spikes
+#define DebugUiColumn               VdDebugUiColumn
+#define DebugUiPanel                VdDebugUiPanel
+#define debug_ui_panel              vd_debug_ui_panel
+#define debug_ui_panel_draw         vd_debug_ui_panel_draw
+#define debug_ui_panel_destroy      vd_debug_ui_panel_destroy
 #endif // VD_MACRO_ABBREVIATIONS
 
 #endif // !VD_DEBUG_H
 
 #ifdef VD_DEBUG_IMPL
 
+// A thread's zones. The thread is the only writer of head, depth and open[]; the thread ending frames is the only
+// writer of tail. Zones are published to the ring only once they end, so the reader never sees a half-written one.
+typedef struct __VD_Debug_Thread {
+    volatile Vdu64 head;
+    Vdu8           pad0[56];
+    volatile Vdu64 tail;
+    Vdu8           pad1[56];
+    volatile Vdu32 num_dropped;
+    Vdu32          num_dropped_seen;
+    Vdu32          index;
+    Vdu32          depth;
+    Vdu32          os_id;
+    const char     *name;
+    VdDebugZone    open[VD_DEBUG_MAX_DEPTH];
+    VdDebugZone    zones[VD_DEBUG_THREAD_RING_ZONES];
+} Vd__DebugThread;
+
 typedef struct __VD_Debug_State {
-    VdArena       debug_arena;
-    VdDebugFrame  *frames;
-    Vdusize       curr_frame;
-    Vdb32         will_pause;
-    Vdb32         paused;
+    VdArena                    debug_arena;
+    VdDebugFrame               *frames;
+    Vdusize                    curr_frame;
+    Vdb32                      will_pause;
+    volatile Vdu32             paused;
+    Vd__DebugThread * volatile threads[VD_DEBUG_MAX_THREADS];
+    volatile Vdu32             num_threads;
+    volatile Vdu32             num_dropped_untracked;
+    Vdu32                      num_dropped_untracked_seen;
+    Vdu64                      num_frames_ended;
+    VdDebugTrace               *stream;
+    VdDebugSite * volatile     sites[VD_DEBUG_MAX_SITES];
+    // Registering takes an index from num_sites_reserved; num_sites only counts sites whose pointer is already stored
+    volatile Vdu32             num_sites_reserved;
+    volatile Vdu32             num_sites;
+    // vd_cpu_ticks and vd_hitime_ns at VD_DEBUG_INIT, and the tick length they give by the last frame end
+    Vdu64                      base_ticks;
+    Vdu64                      base_ns;
+    Vdf64                      ns_per_tick;
 } Vd__DebugState;
 
-static Vd__DebugState Vd__Debug_State;
+static Vd__DebugState                 Vd__Debug_State;
+static VD_THREAD_LOCAL Vd__DebugThread *Vd__Debug_Thread;
+// Vd__Debug_Thread of a thread that came after the first VD_DEBUG_MAX_THREADS: it isn't traced
+#define VD__DEBUG_THREAD_NONE ((Vd__DebugThread*)1)
 #define VD_DEBUG_GET_STATE()  (Vd__Debug_State)
 #define VD_DEBUG_CURR_FRAME() (VD_DEBUG_GET_STATE().frames[VD_DEBUG_GET_STATE().curr_frame])
 
+static Vd__DebugThread *vd__debug_get_thread(void)
+{
+    if (Vd__Debug_Thread == VD__DEBUG_THREAD_NONE) {
+        return 0;
+    }
+
+    if (Vd__Debug_Thread != 0) {
+        return Vd__Debug_Thread;
+    }
+
+    Vdu32 index = vd_atomic_fetch_add_u32(&VD_DEBUG_GET_STATE().num_threads, 1);
+    if (index >= VD_DEBUG_MAX_THREADS) {
+        // Take a slot only once, so num_threads can't wrap around
+        Vd__Debug_Thread = VD__DEBUG_THREAD_NONE;
+        return 0;
+    }
+
+    Vd__DebugThread *thread = (Vd__DebugThread*)VD_MALLOC(sizeof(Vd__DebugThread));
+    VD_MEMSET(thread, 0, sizeof(Vd__DebugThread));
+    thread->index = index;
+#if VD_INCLUDE_PLATFORM_SPECIFIC_FUNCTIONALITY
+    thread->os_id = vd_thread_get_id();
+#else
+    thread->os_id = index + 1;
+#endif // VD_INCLUDE_PLATFORM_SPECIFIC_FUNCTIONALITY
+
+    vd_atomic_store_ptr((void * volatile *)&VD_DEBUG_GET_STATE().threads[index], thread);
+    Vd__Debug_Thread = thread;
+    return thread;
+}
+
+#define VD__DEBUG_TICKS_MASK      ((1ull << 48) - 1)
+#define VD__DEBUG_SITE_REGISTERING VD_U32_MAX
+
+// How many ticks before ref the 48-bit tick count t was. Zones are never close to 2^48 ticks (a day at 3GHz) old.
+static VD_INLINE Vdu64 vd__debug_ticks_age(Vdu64 t, Vdu64 ref)
+{
+    return (ref - t) & VD__DEBUG_TICKS_MASK;
+}
+
+static VD_INLINE Vdb32 vd__debug_ticks_at_or_before(Vdu64 t, Vdu64 ref)
+{
+    return vd__debug_ticks_age(t, ref) < (1ull << 47);
+}
+
+static Vdu32 vd__debug_register_site(VdDebugSite *site)
+{
+    if (vd_atomic_cas_u32(&site->id, 0, VD__DEBUG_SITE_REGISTERING)) {
+        Vdu32 index = vd_atomic_fetch_add_u32(&VD_DEBUG_GET_STATE().num_sites_reserved, 1);
+        if (index < VD_DEBUG_MAX_SITES) {
+            vd_atomic_store_ptr((void * volatile *)&VD_DEBUG_GET_STATE().sites[index], site);
+
+            // Publish in index order, so every site below num_sites is readable
+            while (vd_atomic_load_u32(&VD_DEBUG_GET_STATE().num_sites) != index) vd_cpu_relax();
+            vd_atomic_store_u32(&VD_DEBUG_GET_STATE().num_sites, index + 1);
+        }
+        vd_atomic_store_u32(&site->id, index + 1);
+    }
+
+    Vdu32 id;
+    while ((id = vd_atomic_load_u32(&site->id)) == VD__DEBUG_SITE_REGISTERING) vd_cpu_relax();
+    return id;
+}
+
+// The site's index + 1, registering it on first use. Greater than VD_DEBUG_MAX_SITES if there was no room for it.
+static VD_INLINE Vdu32 vd__debug_site_id(VdDebugSite *site)
+{
+    Vdu32 id = vd_atomic_load_u32(&site->id);
+    if ((id == 0) || (id == VD__DEBUG_SITE_REGISTERING)) {
+        id = vd__debug_register_site(site);
+    }
+    return id;
+}
+
+static VD_INLINE Vdb32 vd__debug_is_sample(VdDebugZone *record)
+{
+    return vd_debug_get_site((Vdu32)(record->begin >> 48))->kind != VD_DEBUG_SITE_KIND_ZONE;
+}
+
+// Ring records of samples are VdDebugSample's bits: the time where a zone's begin is and the value where its end is
+static VD_INLINE VdDebugSample vd__debug_record_to_sample(VdDebugZone *record)
+{
+    VdDebugSample sample;
+    sample.time = record->begin;
+    VD_MEMCPY(&sample.value, &record->end, sizeof(sample.value));
+    return sample;
+}
+
+static void vd__debug_publish(Vd__DebugThread *thread, VdDebugZone *record)
+{
+    Vdu64 head = thread->head;
+    if (head - vd_atomic_load_u64(&thread->tail) >= VD_DEBUG_THREAD_RING_ZONES) {
+        vd_atomic_store_u32(&thread->num_dropped, thread->num_dropped + 1);
+        return;
+    }
+
+    thread->zones[head & (VD_DEBUG_THREAD_RING_ZONES - 1)] = *record;
+    vd_atomic_store_u64(&thread->head, head + 1);
+}
+
+// Begin order (relative to the frame end in userdata), outer zones first on ties
+static VD_PROC_SORT_CMP(vd__debug_zone_cmp)
+{
+    const VdDebugZone *za = (const VdDebugZone*)a;
+    const VdDebugZone *zb = (const VdDebugZone*)b;
+    Vdu64 end_ticks = *(Vdu64*)userdata;
+
+    Vdu64 aa = vd__debug_ticks_age(za->begin, end_ticks);
+    Vdu64 ab = vd__debug_ticks_age(zb->begin, end_ticks);
+    if (aa != ab) return aa > ab ? -1 : 1;
+    return (int)(za->end >> 56) - (int)(zb->end >> 56);
+}
+
+static VD_PROC_SORT_CMP(vd__debug_sample_cmp)
+{
+    Vdu64 end_ticks = *(Vdu64*)userdata;
+    Vdu64 aa = vd__debug_ticks_age(((const VdDebugSample*)a)->time, end_ticks);
+    Vdu64 ab = vd__debug_ticks_age(((const VdDebugSample*)b)->time, end_ticks);
+    return aa > ab ? -1 : (aa < ab ? 1 : 0);
+}
+
+// Moves the zones that ended by end_ticks out of every thread's ring and into frame (or nowhere, if frame is 0)
+static void vd__debug_collect(VdDebugFrame *frame, Vdu64 end_ticks)
+{
+    Vdu32 num_threads = vd_atomic_load_u32(&VD_DEBUG_GET_STATE().num_threads);
+    if (num_threads > VD_DEBUG_MAX_THREADS) num_threads = VD_DEBUG_MAX_THREADS;
+
+    for (Vdu32 i = 0; i < num_threads; ++i) {
+        Vd__DebugThread *thread = (Vd__DebugThread*)vd_atomic_load_ptr((void * volatile *)&VD_DEBUG_GET_STATE().threads[i]);
+        if (thread == 0) continue;
+
+        Vdu64 head  = vd_atomic_load_u64(&thread->head);
+        Vdu64 tail  = thread->tail;
+        Vdu32 first = frame ? frame->num_zones : 0;
+
+        // Each ring is in the order records were published (zones when they end, samples when they're taken), so stop
+        // at the first one published after the frame ended
+        for (; tail < head; ++tail) {
+            VdDebugZone *zone = &thread->zones[tail & (VD_DEBUG_THREAD_RING_ZONES - 1)];
+            Vdb32 is_sample   = vd__debug_is_sample(zone);
+            if (!vd__debug_ticks_at_or_before(is_sample ? zone->begin : zone->end, end_ticks)) break;
+            if (frame == 0) continue;
+
+            if (is_sample && (frame->num_samples < VD_DEBUG_MAX_SAMPLES)) {
+                frame->samples[frame->num_samples++] = vd__debug_record_to_sample(zone);
+            } else if (!is_sample && (frame->num_zones < VD_DEBUG_MAX_ZONES)) {
+                frame->zones[frame->num_zones++] = *zone;
+            } else {
+                frame->num_dropped++;
+            }
+        }
+        vd_atomic_store_u64(&thread->tail, tail);
+
+        Vdu32 num_dropped = vd_atomic_load_u32(&thread->num_dropped);
+        if (frame) frame->num_dropped += num_dropped - thread->num_dropped_seen;
+        thread->num_dropped_seen = num_dropped;
+
+        if (frame && (frame->num_zones - first > 1)) {
+            vd_sort(frame->zones + first, frame->num_zones - first, sizeof(VdDebugZone), vd__debug_zone_cmp, &end_ticks);
+        }
+    }
+
+    if (frame && (frame->num_samples > 1)) {
+        vd_sort(frame->samples, frame->num_samples, sizeof(VdDebugSample), vd__debug_sample_cmp, &end_ticks);
+    }
+}
+
 void vd__debug_init(void)
 {
     Vdusize arena_size = VD_DEBUG_MAX_FRAMES * sizeof(VdDebugFrame) * 2;
@@ -134,56 +798,126 @@ void vd__debug_init(void)
         VD_MEMSET(VD_MALLOC(arena_size), 0, arena_size), arena_size);
 
     VD_DEBUG_GET_STATE().frames = (VdDebugFrame*)vd_arena_alloc(&VD_DEBUG_GET_STATE().debug_arena, VD_DEBUG_MAX_FRAMES * sizeof(VdDebugFrame));
+    VD_DEBUG_CURR_FRAME().begin_time = vd_hitime_get();
+    VD_DEBUG_GET_STATE().base_ticks  = vd_cpu_ticks();
+    VD_DEBUG_GET_STATE().base_ns     = vd_hitime_ns(VD_DEBUG_CURR_FRAME().begin_time);
 }
 
 void vd__debug_frame_begin(void)
 {
-    if (VD_DEBUG_GET_STATE().will_pause != VD_DEBUG_GET_STATE().paused) {
-        VD_DEBUG_GET_STATE().paused = VD_DEBUG_GET_STATE().will_pause;
+    if (VD_DEBUG_GET_STATE().will_pause != (Vdb32)VD_DEBUG_GET_STATE().paused) {
+        vd_atomic_store_u32(&VD_DEBUG_GET_STATE().paused, VD_DEBUG_GET_STATE().will_pause);
+    }
+
+    if (!VD_DEBUG_GET_STATE().paused) {
+        VD_DEBUG_CURR_FRAME().begin_time = vd_hitime_get();
     }
 }
 
-VdDebugZone *vd__debug_zone_begin(const char *id, const char *file, Vdu64 line, const char *function, Vdu64 unique_id)
+VdDebugZone *vd__debug_zone_begin(VdDebugSite *site)
 {
-    VD_DEBUG_CURR_FRAME().current_zone_index++;
+    Vd__DebugThread *thread = vd__debug_get_thread();
+    if (thread == 0) {
+        // More threads than VD_DEBUG_MAX_THREADS: nothing on this thread is recorded
+        vd_atomic_fetch_add_u32(&VD_DEBUG_GET_STATE().num_dropped_untracked, 1);
+        return 0;
+    }
 
+    Vdu32 depth = thread->depth++;
     if (VD_DEBUG_GET_STATE().paused) {
-        return 0;    
+        return 0;
+    }
+
+    Vdu32 id = vd__debug_site_id(site);
+    if ((depth >= VD_DEBUG_MAX_DEPTH) || (id > VD_DEBUG_MAX_SITES)) {
+        vd_atomic_store_u32(&thread->num_dropped, thread->num_dropped + 1);
+        return 0;
     }
 
-    VdDebugZone *zn = &VD_DEBUG_CURR_FRAME().zones[VD_DEBUG_CURR_FRAME().num_zones++];
-    zn->name = id;
-    zn->file = file;
-    zn->line = line;
-    zn->function = function;
-    zn->begin_time = vd_hitime_get();
-    zn->id = unique_id;
+    VdDebugZone *zn = &thread->open[depth];
+    zn->end   = ((Vdu64)depth << 56) | ((Vdu64)thread->index << 48);
+    zn->begin = ((Vdu64)(id - 1) << 48) | (vd_cpu_ticks() & VD__DEBUG_TICKS_MASK);
     return zn;
 }
 
 void vd__debug_zone_end(VdDebugZone *zone)
 {
-    VD_ASSERT(VD_DEBUG_CURR_FRAME().current_zone_index != 0);
-    VD_DEBUG_CURR_FRAME().current_zone_index--;
+    Vd__DebugThread *thread = Vd__Debug_Thread;
+    if (thread == 0 || thread == VD__DEBUG_THREAD_NONE) {
+        return;
+    }
+
+    VD_ASSERT(thread->depth != 0);
+    thread->depth--;
     if (zone == 0) {
         return;
     }
 
-    zone->end_time = vd_hitime_get();
+    zone->end |= vd_cpu_ticks() & VD__DEBUG_TICKS_MASK;
+    vd__debug_publish(thread, zone);
+}
+
+void vd__debug_sample(VdDebugSite *site, Vdf64 value)
+{
+    Vd__DebugThread *thread = vd__debug_get_thread();
+    if (thread == 0) {
+        vd_atomic_fetch_add_u32(&VD_DEBUG_GET_STATE().num_dropped_untracked, 1);
+        return;
+    }
+
+    if (VD_DEBUG_GET_STATE().paused) {
+        return;
+    }
+
+    Vdu32 id = vd__debug_site_id(site);
+    if (id > VD_DEBUG_MAX_SITES) {
+        vd_atomic_store_u32(&thread->num_dropped, thread->num_dropped + 1);
+        return;
+    }
+
+    VdDebugZone record;
+    record.begin = ((Vdu64)(id - 1) << 48) | (vd_cpu_ticks() & VD__DEBUG_TICKS_MASK);
+    VD_MEMCPY(&record.end, &value, sizeof(value));
+    vd__debug_publish(thread, &record);
 }
 
 void vd__debug_frame_end(void)
 {
-    VD_ASSERT(VD_DEBUG_CURR_FRAME().current_zone_index == 0 && "A VD_DEBUG_ZONE_BEGIN/VD_DEBUG_ZONE_END mismatch has occurred");
+    VD_ASSERT((Vd__Debug_Thread == 0 || Vd__Debug_Thread == VD__DEBUG_THREAD_NONE || Vd__Debug_Thread->depth == 0) && "A VD_DEBUG_ZONE_BEGIN/VD_DEBUG_ZONE_END mismatch has occurred");
+    Vdu64    ticks = vd_cpu_ticks();
+    VdHiTime now   = vd_hitime_get();
     if (VD_DEBUG_GET_STATE().paused) {
+        // Keep the rings from filling up with zones nobody will see
+        vd__debug_collect(0, ticks);
         return;
     }
 
-    VD_DEBUG_GET_STATE().curr_frame++;
-    if (VD_DEBUG_GET_STATE().curr_frame > VD_DEBUG_MAX_FRAMES) {
-        VD_DEBUG_GET_STATE().curr_frame = 0;
+    // Calibrated over everything since VD_DEBUG_INIT, so it gets more precise the longer the program runs
+    Vdu64 now_ns = vd_hitime_ns(now);
+    if ((ticks > VD_DEBUG_GET_STATE().base_ticks) && (now_ns > VD_DEBUG_GET_STATE().base_ns)) {
+        VD_DEBUG_GET_STATE().ns_per_tick = (Vdf64)(now_ns - VD_DEBUG_GET_STATE().base_ns) /
+                                           (Vdf64)(ticks - VD_DEBUG_GET_STATE().base_ticks);
+    }
+
+    VdDebugFrame *frame = &VD_DEBUG_CURR_FRAME();
+    frame->end_time  = now;
+    frame->end_ticks = ticks;
+    frame->index     = VD_DEBUG_GET_STATE().num_frames_ended++;
+    vd__debug_collect(frame, ticks);
+
+    Vdu32 num_untracked = vd_atomic_load_u32(&VD_DEBUG_GET_STATE().num_dropped_untracked);
+    frame->num_dropped += num_untracked - VD_DEBUG_GET_STATE().num_dropped_untracked_seen;
+    VD_DEBUG_GET_STATE().num_dropped_untracked_seen = num_untracked;
+
+    if (VD_DEBUG_GET_STATE().stream) {
+        vd_debug_trace_write_frame(VD_DEBUG_GET_STATE().stream, frame);
     }
-    VD_DEBUG_CURR_FRAME().num_zones = 0;
+
+    VD_DEBUG_GET_STATE().curr_frame = (VD_DEBUG_GET_STATE().curr_frame + 1) % VD_DEBUG_MAX_FRAMES;
+    VD_DEBUG_CURR_FRAME().num_zones   = 0;
+    VD_DEBUG_CURR_FRAME().num_samples = 0;
+    VD_DEBUG_CURR_FRAME().num_dropped = 0;
+    VD_DEBUG_CURR_FRAME().begin_time  = now;
 }
 
 void vd_debug_pause(Vdb32 pause)
@@ -206,6 +940,24 @@ VdDebugFrame *vd_debug_get_frame(Vdusize i)
     return &VD_DEBUG_GET_STATE().frames[(VD_DEBUG_GET_STATE().curr_frame + 1 + i) % VD_DEBUG_MAX_FRAMES];
 }
 
+Vdu32 vd_debug_get_num_threads(void)
+{
+    Vdu32 num_threads = vd_atomic_load_u32(&VD_DEBUG_GET_STATE().num_threads);
+    return num_threads > VD_DEBUG_MAX_THREADS ? VD_DEBUG_MAX_THREADS : num_threads;
+}
+
+Vdu32 vd_debug_get_num_sites(void)
+{
+    Vdu32 num_sites = vd_atomic_load_u32(&VD_DEBUG_GET_STATE().num_sites);
+    return num_sites > VD_DEBUG_MAX_SITES ? VD_DEBUG_MAX_SITES : num_sites;
+}
+
+VdDebugSite *vd_debug_get_site(Vdu32 index)
+{
+    if (index >= vd_debug_get_num_sites()) return 0;
+    return (VdDebugSite*)vd_atomic_load_ptr((void * volatile *)&VD_DEBUG_GET_STATE().sites[index]);
+}
+
 Vdusize vd_debug_frame_get_num_zones(VdDebugFrame *frame)
 {
     return frame->num_zones;
@@ -216,12 +968,1898 @@ VdDebugZone *vd_debug_frame_get_zone(VdDebugFrame *frame, Vdusize i)
     return &frame->zones[i];
 }
 
+Vdu32 vd_debug_frame_get_num_dropped(VdDebugFrame *frame)
+{
+    return frame->num_dropped;
+}
+
+Vdf64 vd_debug_frame_get_ms(VdDebugFrame *frame)
+{
+    return vd_hitime_fms64(vd_hitime_sub(frame->end_time, frame->begin_time));
+}
+
+Vdusize vd_debug_frame_get_num_samples(VdDebugFrame *frame)
+{
+    return frame->num_samples;
+}
+
+VdDebugSample *vd_debug_frame_get_sample(VdDebugFrame *frame, Vdusize i)
+{
+    return &frame->samples[i];
+}
+
+Vdb32 vd_debug_frame_get_value(VdDebugFrame *frame, VdDebugSite *site, Vdf64 *value)
+{
+    Vdb32 found = VD_FALSE;
+    Vdf64 v     = 0.0;
+    for (Vdu32 i = 0; i < frame->num_samples; ++i) {
+        if (vd_debug_sample_get_site(&frame->samples[i]) != site) continue;
+        found = VD_TRUE;
+        v = site->kind == VD_DEBUG_SITE_KIND_COUNTER ? v + frame->samples[i].value : frame->samples[i].value;
+    }
+
+    if (found) *value = v;
+    return found;
+}
+
+VdDebugSite *vd_debug_zone_get_site(VdDebugZone *zone)
+{
+    return vd_debug_get_site(vd_debug_zone_get_site_index(zone));
+}
+
+Vdu32 vd_debug_zone_get_site_index(VdDebugZone *zone)
+{
+    return (Vdu32)(zone->begin >> 48);
+}
+
+Vdu32 vd_debug_zone_get_thread(VdDebugZone *zone)
+{
+    return (Vdu32)(zone->end >> 48) & 0xFF;
+}
+
+Vdu32 vd_debug_zone_get_depth(VdDebugZone *zone)
+{
+    return (Vdu32)(zone->end >> 56);
+}
+
 Vdf64 vd_debug_zone_get_ms(VdDebugZone *zone)
 {
-    Vdf64 ms = vd_hitime_fms64(vd_hitime_sub(zone->end_time, zone->begin_time));
-    return ms;
+    Vdu64 ticks = (zone->end - zone->begin) & VD__DEBUG_TICKS_MASK;
+    return (Vdf64)ticks * VD_DEBUG_GET_STATE().ns_per_tick / 1000000.0;
+}
+
+// Counted back from the frame's end, whose time on both clocks is known
+static Vdu64 vd__debug_frame_ticks_to_ns(VdDebugFrame *frame, Vdu64 t)
+{
+    Vdu64 end_ns = vd_hitime_ns(frame->end_time);
+    Vdu64 ago_ns = (Vdu64)((Vdf64)vd__debug_ticks_age(t, frame->end_ticks) * VD_DEBUG_GET_STATE().ns_per_tick);
+    return ago_ns < end_ns ? end_ns - ago_ns : 0;
+}
+
+Vdu64 vd_debug_zone_get_begin_ns(VdDebugFrame *frame, VdDebugZone *zone)
+{
+    return vd__debug_frame_ticks_to_ns(frame, zone->begin);
 }
 
+Vdu64 vd_debug_zone_get_end_ns(VdDebugFrame *frame, VdDebugZone *zone)
+{
+    return vd__debug_frame_ticks_to_ns(frame, zone->end);
+}
+
+VdDebugSite *vd_debug_sample_get_site(VdDebugSample *sample)
+{
+    return vd_debug_get_site((Vdu32)(sample->time >> 48));
+}
+
+Vdu64 vd_debug_sample_get_ns(VdDebugFrame *frame, VdDebugSample *sample)
+{
+    return vd__debug_frame_ticks_to_ns(frame, sample->time);
+}
+
+void vd_debug_set_thread_name(const char *name)
+{
+    Vd__DebugThread *thread = vd__debug_get_thread();
+    if (thread) {
+        thread->name = name;
+    }
+}
+
+static Vd__DebugThread *vd__debug_find_thread(Vdu32 thread)
+{
+    if (thread >= vd_debug_get_num_threads()) return 0;
+    return (Vd__DebugThread*)vd_atomic_load_ptr((void * volatile *)&VD_DEBUG_GET_STATE().threads[thread]);
+}
+
+const char *vd_debug_get_thread_name(Vdu32 thread)
+{
+    Vd__DebugThread *t = vd__debug_find_thread(thread);
+    return t ? t->name : 0;
+}
+
+Vdu32 vd_debug_get_thread_os_id(Vdu32 thread)
+{
+    Vd__DebugThread *t = vd__debug_find_thread(thread);
+    return t ? t->os_id : thread + 1;
+}
+
+// Track uuids for Perfetto; thread tracks are VD__DEBUG_TRACK_THREAD + the thread, and counter tracks are
+// VD__DEBUG_TRACK_COUNTER + the site's index
+#define VD__DEBUG_TRACK_PROCESS 1
+#define VD__DEBUG_TRACK_FRAMES  2
+#define VD__DEBUG_TRACK_THREAD  16
+#define VD__DEBUG_TRACK_COUNTER (VD__DEBUG_TRACK_THREAD + VD_DEBUG_MAX_THREADS)
+#define VD__DEBUG_TRACE_PID     1
+
+static void vd__debug_trace_put(VdDebugTrace *trace, const void *data, Vdusize size)
+{
+    if (trace->len + size > VD_DEBUG_TRACE_BUFFER_SIZE) {
+        vd_debug_trace_flush(trace);
+        if (size > VD_DEBUG_TRACE_BUFFER_SIZE) {
+            trace->write(data, size, trace->userdata);
+            trace->num_bytes += size;
+            return;
+        }
+    }
+    VD_MEMCPY(trace->buf + trace->len, data, size);
+    trace->len += size;
+}
+
+static void vd__debug_trace_put_cstr(VdDebugTrace *trace, const char *s)
+{
+    vd__debug_trace_put(trace, s, vd_cstr_len((Vdcstr)s));
+}
+
+static void vd__debug_trace_put_u64(VdDebugTrace *trace, Vdu64 v)
+{
+    char digits[20];
+    int n = 0;
+    do {
+        digits[sizeof(digits) - 1 - n++] = (char)('0' + v % 10);
+        v /= 10;
+    } while (v);
+    vd__debug_trace_put(trace, digits + sizeof(digits) - n, n);
+}
+
+// Nanoseconds as the microseconds JSON traces count in
+static void vd__debug_trace_put_us(VdDebugTrace *trace, Vdu64 ns)
+{
+    vd__debug_trace_put_u64(trace, ns / 1000);
+
+    Vdu32 frac = (Vdu32)(ns % 1000);
+    char text[4] = { '.', (char)('0' + frac / 100), (char)('0' + frac / 10 % 10), (char)('0' + frac % 10) };
+    vd__debug_trace_put(trace, text, 4);
+}
+
+// Six decimals, trailing zeros trimmed. JSON has no NaN or infinity, so those are written as 0.
+static void vd__debug_trace_put_f64(VdDebugTrace *trace, Vdf64 v)
+{
+    if ((v != v) || (v > 1e18) || (v < -1e18)) v = 0.0;
+    if (v < 0.0) {
+        vd__debug_trace_put(trace, "-", 1);
+        v = -v;
+    }
+
+    Vdu64 micros = (Vdu64)(v * 1000000.0 + 0.5);
+    vd__debug_trace_put_u64(trace, micros / 1000000);
+
+    Vdu32 frac = (Vdu32)(micros % 1000000);
+    if (frac == 0) return;
+
+    char text[7] = { '.' };
+    int  n       = 7;
+    for (int i = 6; i >= 1; --i, frac /= 10) text[i] = (char)('0' + frac % 10);
+    while (text[n - 1] == '0') n--;
+    vd__debug_trace_put(trace, text, n);
+}
+
+static void vd__debug_trace_put_json_str(VdDebugTrace *trace, const char *s)
+{
+    static const char hex[] = "0123456789abcdef";
+    vd__debug_trace_put(trace, "\"", 1);
+    for (const char *c = s ? s : ""; *c; ++c) {
+        unsigned char ch = (unsigned char)*c;
+        if ((ch == '"') || (ch == '\\')) {
+            char esc[2] = { '\\', (char)ch };
+            vd__debug_trace_put(trace, esc, 2);
+        } else if (ch < 0x20) {
+            char esc[6] = { '\\', 'u', '0', '0', hex[ch >> 4], hex[ch & 15] };
+            vd__debug_trace_put(trace, esc, 6);
+        } else {
+            vd__debug_trace_put(trace, c, 1);
+        }
+    }
+    vd__debug_trace_put(trace, "\"", 1);
+}
+
+static void vd__debug_trace_json_event_begin(VdDebugTrace *trace, const char *name, const char *ph, Vdu64 tid)
+{
+    vd__debug_trace_put_cstr(trace, trace->num_events++ ? ",\n{\"name\":" : "{\"name\":");
+    vd__debug_trace_put_json_str(trace, name);
+    vd__debug_trace_put_cstr(trace, ",\"ph\":\"");
+    vd__debug_trace_put_cstr(trace, ph);
+    vd__debug_trace_put_cstr(trace, "\",\"pid\":1,\"tid\":");
+    vd__debug_trace_put_u64(trace, tid);
+}
+
+static void vd__debug_trace_json_name_track(VdDebugTrace *trace, const char *kind, Vdu64 tid, const char *name)
+{
+    vd__debug_trace_json_event_begin(trace, kind, "M", tid);
+    vd__debug_trace_put_cstr(trace, ",\"args\":{\"name\":");
+    vd__debug_trace_put_json_str(trace, name);
+    vd__debug_trace_put_cstr(trace, "}}");
+}
+
+static void vd__debug_trace_json_slice(VdDebugTrace *trace, const char *name, Vdu64 tid, Vdu64 begin_ns, Vdu64 end_ns)
+{
+    vd__debug_trace_json_event_begin(trace, name, "X", tid);
+    vd__debug_trace_put_cstr(trace, ",\"ts\":");
+    vd__debug_trace_put_us(trace, begin_ns > trace->base_ns ? begin_ns - trace->base_ns : 0);
+    vd__debug_trace_put_cstr(trace, ",\"dur\":");
+    vd__debug_trace_put_us(trace, end_ns > begin_ns ? end_ns - begin_ns : 0);
+}
+
+// A protobuf message being built in a fixed buffer. Running out of room marks it full; full messages are dropped.
+typedef struct {
+    Vdu8  *at;
+    Vdu8  *end;
+    Vdb32 full;
+} Vd__DebugPb;
+
+static Vd__DebugPb vd__debug_pb(Vdu8 *buf, Vdusize size)
+{
+    Vd__DebugPb pb = { buf, buf + size, VD_FALSE };
+    return pb;
+}
+
+static void vd__debug_pb_varint(Vd__DebugPb *pb, Vdu64 v)
+{
+    do {
+        if (pb->at == pb->end) {
+            pb->full = VD_TRUE;
+            return;
+        }
+        *pb->at++ = (Vdu8)((v & 0x7f) | (v > 0x7f ? 0x80 : 0));
+        v >>= 7;
+    } while (v);
+}
+
+static void vd__debug_pb_uint(Vd__DebugPb *pb, Vdu32 field, Vdu64 v)
+{
+    vd__debug_pb_varint(pb, (Vdu64)field << 3);
+    vd__debug_pb_varint(pb, v);
+}
+
+static void vd__debug_pb_bytes(Vd__DebugPb *pb, Vdu32 field, const void *data, Vdusize size)
+{
+    vd__debug_pb_varint(pb, ((Vdu64)field << 3) | 2);
+    vd__debug_pb_varint(pb, size);
+    if ((Vdusize)(pb->end - pb->at) < size) {
+        pb->full = VD_TRUE;
+        pb->at   = pb->end;
+        return;
+    }
+    if (size) VD_MEMCPY(pb->at, data, size);
+    pb->at += size;
+}
+
+static void vd__debug_pb_double(Vd__DebugPb *pb, Vdu32 field, Vdf64 v)
+{
+    Vdu64 bits;
+    VD_MEMCPY(&bits, &v, sizeof(bits));
+    vd__debug_pb_varint(pb, ((Vdu64)field << 3) | 1);
+    for (int i = 0; i < 8; ++i) {
+        if (pb->at == pb->end) {
+            pb->full = VD_TRUE;
+            return;
+        }
+        *pb->at++ = (Vdu8)(bits >> (i * 8));
+    }
+}
+
+static void vd__debug_pb_str(Vd__DebugPb *pb, Vdu32 field, const char *s)
+{
+    vd__debug_pb_bytes(pb, field, s ? s : "", s ? vd_cstr_len((Vdcstr)s) : 0);
+}
+
+static void vd__debug_pb_msg(Vd__DebugPb *pb, Vdu32 field, Vd__DebugPb *msg, Vdu8 *msg_buf)
+{
+    if (msg->full) pb->full = VD_TRUE;
+    vd__debug_pb_bytes(pb, field, msg_buf, (Vdusize)(msg->at - msg_buf));
+}
+
+// Wraps a TracePacket (without its sequence id) in Trace.packet and writes it
+static void vd__debug_trace_pb_packet(VdDebugTrace *trace, Vd__DebugPb *packet, Vdu8 *packet_buf)
+{
+    vd__debug_pb_uint(packet, 10, 1);  // trusted_packet_sequence_id
+    if (trace->num_events == 0) vd__debug_pb_uint(packet, 13, 1);  // sequence_flags: SEQ_INCREMENTAL_STATE_CLEARED
+    if (packet->full) return;
+    trace->num_events++;
+
+    Vdu8 header[16];
+    Vd__DebugPb pb = vd__debug_pb(header, sizeof(header));
+    vd__debug_pb_varint(&pb, (1 << 3) | 2);
+    vd__debug_pb_varint(&pb, (Vdu64)(packet->at - packet_buf));
+    vd__debug_trace_put(trace, header, (Vdusize)(pb.at - header));
+    vd__debug_trace_put(trace, packet_buf, (Vdusize)(packet->at - packet_buf));
+}
+
+// TrackDescriptor: a process, a thread (os_id != 0), a counter, or a named child track of the process
+static void vd__debug_trace_pb_track(VdDebugTrace *trace, Vdu64 uuid, const char *name, Vdu32 os_id)
+{
+    Vdu8 desc_buf[512], inner_buf[384], packet_buf[640];
+    Vd__DebugPb inner = vd__debug_pb(inner_buf, sizeof(inner_buf));
+    Vd__DebugPb desc  = vd__debug_pb(desc_buf, sizeof(desc_buf));
+    vd__debug_pb_uint(&desc, 1, uuid);
+
+    if (uuid == VD__DEBUG_TRACK_PROCESS) {
+        vd__debug_pb_uint(&inner, 1, VD__DEBUG_TRACE_PID);
+        vd__debug_pb_str(&inner, 6, name);
+        vd__debug_pb_msg(&desc, 3, &inner, inner_buf);
+    } else if (os_id) {
+        vd__debug_pb_uint(&inner, 1, VD__DEBUG_TRACE_PID);
+        vd__debug_pb_uint(&inner, 2, os_id);
+        vd__debug_pb_str(&inner, 5, name);
+        vd__debug_pb_msg(&desc, 4, &inner, inner_buf);
+    } else {
+        vd__debug_pb_str(&desc, 2, name);
+        vd__debug_pb_uint(&desc, 5, VD__DEBUG_TRACK_PROCESS);
+        if (uuid >= VD__DEBUG_TRACK_COUNTER) vd__debug_pb_bytes(&desc, 8, 0, 0);  // counter: an empty CounterDescriptor
+    }
+
+    Vd__DebugPb packet = vd__debug_pb(packet_buf, sizeof(packet_buf));
+    vd__debug_pb_msg(&packet, 60, &desc, desc_buf);
+    vd__debug_trace_pb_packet(trace, &packet, packet_buf);
+}
+
+static void vd__debug_pb_annotation_str(Vd__DebugPb *pb, const char *name, const char *value)
+{
+    Vdu8 buf[320];
+    Vd__DebugPb a = vd__debug_pb(buf, sizeof(buf));
+    vd__debug_pb_str(&a, 10, name);
+    vd__debug_pb_str(&a, 6, value);
+    vd__debug_pb_msg(pb, 4, &a, buf);
+}
+
+static void vd__debug_pb_annotation_int(Vd__DebugPb *pb, const char *name, Vdu64 value)
+{
+    Vdu8 buf[64];
+    Vd__DebugPb a = vd__debug_pb(buf, sizeof(buf));
+    vd__debug_pb_str(&a, 10, name);
+    vd__debug_pb_uint(&a, 4, value);
+    vd__debug_pb_msg(pb, 4, &a, buf);
+}
+
+// A TrackEvent slice begin (site or frame non-null) or end
+static void vd__debug_trace_pb_slice(VdDebugTrace *trace, Vdu64 track, Vdu64 ns, VdDebugSite *site, VdDebugFrame *frame)
+{
+    Vdu8 event_buf[1024], packet_buf[1100];
+    Vd__DebugPb event = vd__debug_pb(event_buf, sizeof(event_buf));
+    vd__debug_pb_uint(&event, 9, (site || frame) ? 1 : 2);  // type: TYPE_SLICE_BEGIN, TYPE_SLICE_END
+    vd__debug_pb_uint(&event, 11, track);
+    if (site) {
+        vd__debug_pb_str(&event, 23, site->name);
+        vd__debug_pb_annotation_str(&event, "file", site->file);
+        vd__debug_pb_annotation_int(&event, "line", site->line);
+        vd__debug_pb_annotation_str(&event, "function", site->function);
+    } else if (frame) {
+        vd__debug_pb_str(&event, 23, "Frame");
+        vd__debug_pb_annotation_int(&event, "index", frame->index);
+        vd__debug_pb_annotation_int(&event, "dropped", frame->num_dropped);
+    }
+
+    Vd__DebugPb packet = vd__debug_pb(packet_buf, sizeof(packet_buf));
+    vd__debug_pb_uint(&packet, 8, ns);
+    vd__debug_pb_msg(&packet, 11, &event, event_buf);
+    vd__debug_trace_pb_packet(trace, &packet, packet_buf);
+}
+
+static void vd__debug_trace_pb_counter(VdDebugTrace *trace, Vdu64 track, Vdu64 ns, Vdf64 value)
+{
+    Vdu8 event_buf[32], packet_buf[64];
+    Vd__DebugPb event = vd__debug_pb(event_buf, sizeof(event_buf));
+    vd__debug_pb_uint(&event, 9, 4);  // type: TYPE_COUNTER
+    vd__debug_pb_uint(&event, 11, track);
+    vd__debug_pb_double(&event, 44, value);  // double_counter_value
+
+    Vd__DebugPb packet = vd__debug_pb(packet_buf, sizeof(packet_buf));
+    vd__debug_pb_uint(&packet, 8, ns);
+    vd__debug_pb_msg(&packet, 11, &event, event_buf);
+    vd__debug_trace_pb_packet(trace, &packet, packet_buf);
+}
+
+// Counter tracks: a gauge's samples when they were taken, and a counter's total for the frame at the frame's begin
+static void vd__debug_trace_write_samples(VdDebugTrace *trace, VdDebugFrame *frame)
+{
+    for (Vdu32 i = 0; i < frame->num_samples; ++i) {
+        VdDebugSample *sample = &frame->samples[i];
+        VdDebugSite   *site   = vd_debug_sample_get_site(sample);
+        Vdu32         index   = (Vdu32)(sample->time >> 48);
+        Vdu64         ns      = vd_debug_sample_get_ns(frame, sample);
+        Vdf64         value   = sample->value;
+
+        if (site->kind == VD_DEBUG_SITE_KIND_COUNTER) {
+            Vdb32 seen = VD_FALSE;
+            for (Vdu32 j = 0; (j < i) && !seen; ++j) seen = (Vdu32)(frame->samples[j].time >> 48) == index;
+            if (seen) continue;
+
+            vd_debug_frame_get_value(frame, site, &value);
+            ns = vd_hitime_ns(frame->begin_time);
+        }
+
+        if (trace->format == VD_DEBUG_TRACE_FORMAT_CHROME_JSON) {
+            vd__debug_trace_json_event_begin(trace, site->name, "C", 0);
+            vd__debug_trace_put_cstr(trace, ",\"ts\":");
+            vd__debug_trace_put_us(trace, ns > trace->base_ns ? ns - trace->base_ns : 0);
+            vd__debug_trace_put_cstr(trace, ",\"args\":{\"value\":");
+            vd__debug_trace_put_f64(trace, value);
+            vd__debug_trace_put_cstr(trace, "}}");
+            continue;
+        }
+
+        if ((trace->described_sites[index / 8] & (1u << (index % 8))) == 0) {
+            trace->described_sites[index / 8] |= (Vdu8)(1u << (index % 8));
+            vd__debug_trace_pb_track(trace, VD__DEBUG_TRACK_COUNTER + index, site->name, 0);
+        }
+        vd__debug_trace_pb_counter(trace, VD__DEBUG_TRACK_COUNTER + index, ns, value);
+    }
+}
+
+static void vd__debug_trace_describe_thread(VdDebugTrace *trace, Vdu32 thread)
+{
+    if ((thread >= VD_DEBUG_MAX_THREADS) || trace->described[thread]) return;
+    trace->described[thread] = 1;
+
+    char default_name[32] = "Thread ";
+    const char *name = vd_debug_get_thread_name(thread);
+    if (name == 0) {
+        Vdu32 n = 7, v = thread, div = 1;
+        while (v / div >= 10) div *= 10;
+        for (; div; div /= 10) default_name[n++] = (char)('0' + v / div % 10);
+        default_name[n] = 0;
+        name = default_name;
+    }
+
+    Vdu32 os_id = vd_debug_get_thread_os_id(thread);
+    if (trace->format == VD_DEBUG_TRACE_FORMAT_CHROME_JSON) {
+        vd__debug_trace_json_name_track(trace, "thread_name", os_id, name);
+    } else {
+        vd__debug_trace_pb_track(trace, VD__DEBUG_TRACK_THREAD + thread, name, os_id);
+    }
+}
+
+void vd_debug_trace_begin(VdDebugTrace *trace, VdDebugTraceFormat format, VdProcDebugTraceWrite *write, void *userdata)
+{
+    VD_MEMSET(trace, 0, sizeof(*trace));
+    trace->format   = format;
+    trace->write    = write;
+    trace->userdata = userdata;
+
+    // JSON frames go on tid 0, which no OS thread has
+    if (format == VD_DEBUG_TRACE_FORMAT_CHROME_JSON) {
+        vd__debug_trace_put_cstr(trace, "[\n");
+        vd__debug_trace_json_name_track(trace, "process_name", 0, "vd_debug");
+        vd__debug_trace_json_name_track(trace, "thread_name", 0, "Frames");
+    } else {
+        vd__debug_trace_pb_track(trace, VD__DEBUG_TRACK_PROCESS, "vd_debug", 0);
+        vd__debug_trace_pb_track(trace, VD__DEBUG_TRACK_FRAMES, "Frames", 0);
+    }
+}
+
+void vd_debug_trace_write_frame(VdDebugTrace *trace, VdDebugFrame *frame)
+{
+    Vdu64 frame_begin = vd_hitime_ns(frame->begin_time);
+    Vdu64 frame_end   = vd_hitime_ns(frame->end_time);
+    if (trace->base_ns == 0) trace->base_ns = frame_begin;
+    trace->num_frames++;
+
+    if (trace->format == VD_DEBUG_TRACE_FORMAT_CHROME_JSON) {
+        vd__debug_trace_json_slice(trace, "Frame", 0, frame_begin, frame_end);
+        vd__debug_trace_put_cstr(trace, ",\"args\":{\"index\":");
+        vd__debug_trace_put_u64(trace, frame->index);
+        vd__debug_trace_put_cstr(trace, ",\"dropped\":");
+        vd__debug_trace_put_u64(trace, frame->num_dropped);
+        vd__debug_trace_put_cstr(trace, "}}");
+
+        // Complete events nest by time on their thread, so zones can be written in any order
+        for (Vdu32 i = 0; i < frame->num_zones; ++i) {
+            VdDebugZone *zone  = &frame->zones[i];
+            VdDebugSite *site  = vd_debug_zone_get_site(zone);
+            Vdu32       thread = vd_debug_zone_get_thread(zone);
+            vd__debug_trace_describe_thread(trace, thread);
+            vd__debug_trace_json_slice(trace, site->name, vd_debug_get_thread_os_id(thread),
+                                       vd_debug_zone_get_begin_ns(frame, zone), vd_debug_zone_get_end_ns(frame, zone));
+            vd__debug_trace_put_cstr(trace, ",\"args\":{\"file\":");
+            vd__debug_trace_put_json_str(trace, site->file);
+            vd__debug_trace_put_cstr(trace, ",\"line\":");
+            vd__debug_trace_put_u64(trace, site->line);
+            vd__debug_trace_put_cstr(trace, ",\"function\":");
+            vd__debug_trace_put_json_str(trace, site->function);
+            vd__debug_trace_put_cstr(trace, "}}");
+        }
+
+        vd__debug_trace_write_samples(trace, frame);
+        return;
+    }
+
+    vd__debug_trace_pb_slice(trace, VD__DEBUG_TRACK_FRAMES, frame_begin, 0, frame);
+    vd__debug_trace_pb_slice(trace, VD__DEBUG_TRACK_FRAMES, frame_end, 0, 0);
+
+    // Begin/end events: zones are in begin order per thread, so keep the open ones' ends on a stack
+    Vdu64 ends[VD_DEBUG_MAX_DEPTH];
+    Vdu32 num_open = 0;
+    Vdu32 thread   = VD_U32_MAX;
+    for (Vdu32 i = 0; i <= frame->num_zones; ++i) {
+        VdDebugZone *zone = i < frame->num_zones ? &frame->zones[i] : 0;
+        Vdu64 begin       = zone ? vd_debug_zone_get_begin_ns(frame, zone) : VD_U64_MAX;
+        Vdb32 new_thread  = (zone == 0) || (vd_debug_zone_get_thread(zone) != thread);
+
+        while (num_open && (new_thread || (ends[num_open - 1] <= begin) || (num_open == VD_DEBUG_MAX_DEPTH))) {
+            vd__debug_trace_pb_slice(trace, VD__DEBUG_TRACK_THREAD + thread, ends[--num_open], 0, 0);
+        }
+        if (zone == 0) break;
+
+        thread = vd_debug_zone_get_thread(zone);
+        vd__debug_trace_describe_thread(trace, thread);
+        vd__debug_trace_pb_slice(trace, VD__DEBUG_TRACK_THREAD + thread, begin, vd_debug_zone_get_site(zone), 0);
+        ends[num_open++] = vd_debug_zone_get_end_ns(frame, zone);
+    }
+
+    vd__debug_trace_write_samples(trace, frame);
+}
+
+void vd_debug_trace_write_history(VdDebugTrace *trace)
+{
+    for (Vdusize i = 0; i < vd_debug_get_num_frames(); ++i) {
+        VdDebugFrame *frame = vd_debug_get_frame(i);
+        if (vd_hitime_ns(frame->end_time) == 0) continue;
+        vd_debug_trace_write_frame(trace, frame);
+    }
+}
+
+void vd_debug_trace_stream(VdDebugTrace *trace)
+{
+    VD_DEBUG_GET_STATE().stream = trace;
+}
+
+void vd_debug_trace_flush(VdDebugTrace *trace)
+{
+    if (trace->len == 0) return;
+    trace->write(trace->buf, trace->len, trace->userdata);
+    trace->num_bytes += trace->len;
+    trace->len = 0;
+}
+
+void vd_debug_trace_end(VdDebugTrace *trace)
+{
+    if (VD_DEBUG_GET_STATE().stream == trace) {
+        VD_DEBUG_GET_STATE().stream = 0;
+    }
+
+    if (trace->format == VD_DEBUG_TRACE_FORMAT_CHROME_JSON) {
+        vd__debug_trace_put_cstr(trace, "\n]\n");
+    }
+    vd_debug_trace_flush(trace);
+}
+
+#if VD_USE_CRT
+#include <stdio.h>
+
+VD_PROC_DEBUG_TRACE_WRITE(vd_debug_trace_write_file)
+{
+    fwrite(data, 1, size, (FILE*)userdata);
+}
+#endif // VD_USE_CRT
+
+typedef struct {
+    Vdu32 node;
+    Vdu32 depth;
+    Vdu64 end_ns;
+} Vd__DebugStatsOpen;
+
+// The index of the oldest frame of the history that stats over num_frames frames look at
+static Vdusize vd__debug_stats_first_frame(Vdusize num_frames)
+{
+    Vdusize total = vd_debug_get_num_frames();
+    return num_frames < total ? total - num_frames : 0;
+}
+
+static Vdb32 vd__debug_stats_frame_ended(VdDebugFrame *frame)
+{
+    return vd_hitime_ns(frame->end_time) != 0;
+}
+
+static Vdusize vd__debug_stats_table_cap(Vdusize num_zones)
+{
+    Vdusize cap = 16;
+    while (cap < num_zones * 2) cap *= 2;
+    return cap;
+}
+
+Vdusize vd_debug_stats_get_memory(Vdusize num_frames)
+{
+    Vdusize count     = 0;
+    Vdusize num_zones = 0;
+    for (Vdusize i = vd__debug_stats_first_frame(num_frames); i < vd_debug_get_num_frames(); ++i) {
+        VdDebugFrame *frame = vd_debug_get_frame(i);
+        if (!vd__debug_stats_frame_ended(frame)) continue;
+        count++;
+        num_zones += frame->num_zones;
+    }
+
+    return count     * (sizeof(VdDebugFrame*) + sizeof(VdDebugStatsFrame) + sizeof(Vdf64)) +
+           num_zones * (sizeof(VdDebugStatsNode) + sizeof(VdDebugStatsSample) + 2 * sizeof(Vdu32)) +
+           vd__debug_stats_table_cap(num_zones) * sizeof(Vdu32) +
+           vd_debug_get_num_sites() * (sizeof(VdDebugStatsValue) + 3 * sizeof(Vdu32) + sizeof(Vdf64)) +
+           12 * VD_ARENA_DEFAULT_ALIGNMENT;
+}
+
+// The node for zone under parent, created if it's the first time zone's site is seen there
+static Vdu32 vd__debug_stats_node(VdDebugStats *stats, Vdu32 *table, Vdusize cap, Vdu32 parent, VdDebugZone *zone)
+{
+    VdDebugSite *site = vd_debug_zone_get_site(zone);
+    Vdusize     slot  = vd_hash_combine(vd_hash_u32(vd_debug_zone_get_site_index(zone)), parent) & (cap - 1);
+    for (; table[slot] != 0; slot = (slot + 1) & (cap - 1)) {
+        VdDebugStatsNode *node = &stats->nodes[table[slot] - 1];
+        if (node->site == site && node->parent == parent) {
+            return table[slot] - 1;
+        }
+    }
+
+    Vdu32 index = stats->num_nodes++;
+    table[slot] = index + 1;
+
+    VdDebugStatsNode *node = &stats->nodes[index];
+    node->site         = site;
+    node->parent       = parent;
+    node->first_child  = VD_DEBUG_STATS_NO_NODE;
+    node->next_sibling = VD_DEBUG_STATS_NO_NODE;
+    node->depth        = parent == VD_DEBUG_STATS_NO_NODE ? 0 : stats->nodes[parent].depth + 1;
+    return index;
+}
+
+// The sample of node for frame f, appended if node hasn't run in f yet. filled[node] counts the node's samples so far.
+static VdDebugStatsSample *vd__debug_stats_sample(VdDebugStats *stats, Vdu32 *filled, Vdu32 node, Vdu32 f)
+{
+    VdDebugStatsSample *samples = &stats->samples[stats->nodes[node].first_sample];
+    if (filled[node] == 0 || samples[filled[node] - 1].frame != f) {
+        samples[filled[node]++].frame = f;
+    }
+    return &samples[filled[node] - 1];
+}
+
+static VD_PROC_SORT_CMP(vd__debug_f64_cmp)
+{
+    Vdf64 va = *(const Vdf64*)a;
+    Vdf64 vb = *(const Vdf64*)b;
+    VD_UNUSED(userdata);
+    return va < vb ? -1 : (va > vb ? 1 : 0);
+}
+
+// Nearest-rank percentile of count sorted values
+static Vdf64 vd__debug_percentile(Vdf64 *sorted, Vdu32 count, Vdu32 percent)
+{
+    Vdu32 rank = (count * percent + 99) / 100;
+    return sorted[rank == 0 ? 0 : rank - 1];
+}
+
+// Summarizes values, sorting them in place
+static VdDebugTimeStats vd__debug_time_stats(Vdf64 *values, Vdu32 count)
+{
+    VdDebugTimeStats result;
+    VD_MEMSET(&result, 0, sizeof(result));
+    if (count == 0) {
+        return result;
+    }
+
+    Vdf64 sum = 0.0;
+    for (Vdu32 i = 0; i < count; ++i) sum += values[i];
+    vd_sort(values, count, sizeof(Vdf64), vd__debug_f64_cmp, 0);
+
+    result.mean_ms = sum / (Vdf64)count;
+    result.p50_ms  = vd__debug_percentile(values, count, 50);
+    result.p95_ms  = vd__debug_percentile(values, count, 95);
+    result.p99_ms  = vd__debug_percentile(values, count, 99);
+    result.max_ms  = values[count - 1];
+    return result;
+}
+
+void vd_debug_stats_build(VdDebugStats *stats, VdArena *arena, Vdusize num_frames)
+{
+    VD_MEMSET(stats, 0, sizeof(*stats));
+    stats->first_root = VD_DEBUG_STATS_NO_NODE;
+
+    Vdusize first     = vd__debug_stats_first_frame(num_frames);
+    Vdusize total     = vd_debug_get_num_frames();
+    Vdusize num_zones = 0;
+    for (Vdusize i = first; i < total; ++i) {
+        VdDebugFrame *frame = vd_debug_get_frame(i);
+        if (!vd__debug_stats_frame_ended(frame)) continue;
+        stats->num_frames++;
+        num_zones += frame->num_zones;
+    }
+
+    VdDebugFrame **frames = VD_ARENA_PUSH_ARRAY(arena, VdDebugFrame*, stats->num_frames);
+    stats->frames         = VD_ARENA_PUSH_ARRAY(arena, VdDebugStatsFrame, stats->num_frames);
+    stats->nodes          = VD_ARENA_PUSH_ARRAY(arena, VdDebugStatsNode, num_zones);
+    Vdu32 *zone_nodes     = VD_ARENA_PUSH_ARRAY(arena, Vdu32, num_zones);
+    Vdu32 *marks          = VD_ARENA_PUSH_ARRAY(arena, Vdu32, num_zones);
+    Vdusize cap           = vd__debug_stats_table_cap(num_zones);
+    Vdu32 *table          = VD_ARENA_PUSH_ARRAY(arena, Vdu32, cap);
+
+    for (Vdusize i = first, f = 0; i < total; ++i) {
+        VdDebugFrame *frame = vd_debug_get_frame(i);
+        if (!vd__debug_stats_frame_ended(frame)) continue;
+        frames[f]              = frame;
+        stats->frames[f].index = frame->index;
+        stats->frames[f].ms    = vd_debug_frame_get_ms(frame);
+        f++;
+    }
+
+    // Place every zone in the tree. Each thread's zones are in begin order, so a zone's parent is on the stack of zones
+    // that enclose it.
+    Vdusize z = 0;
+    for (Vdu32 f = 0; f < stats->num_frames; ++f) {
+        VdDebugFrame       *frame = frames[f];
+        Vd__DebugStatsOpen open[VD_DEBUG_MAX_DEPTH];
+        Vdu32              num_open = 0;
+        Vdu32              thread   = VD_DEBUG_STATS_NO_NODE;
+
+        for (Vdu32 i = 0; i < frame->num_zones; ++i) {
+            VdDebugZone *zone = &frame->zones[i];
+            Vdu32 depth       = vd_debug_zone_get_depth(zone);
+            Vdu64 begin_ns    = vd_debug_zone_get_begin_ns(frame, zone);
+            if (vd_debug_zone_get_thread(zone) != thread) {
+                thread   = vd_debug_zone_get_thread(zone);
+                num_open = 0;
+            }
+
+            while (num_open > 0 && (open[num_open - 1].depth >= depth || open[num_open - 1].end_ns < begin_ns)) {
+                num_open--;
+            }
+
+            Vdu32 parent = num_open > 0 ? open[num_open - 1].node : VD_DEBUG_STATS_NO_NODE;
+            Vdu32 node   = vd__debug_stats_node(stats, table, cap, parent, zone);
+            zone_nodes[z++] = node;
+
+            stats->nodes[node].count++;
+            if (marks[node] != f + 1) {
+                marks[node] = f + 1;
+                stats->nodes[node].num_frames++;
+            }
+
+            open[num_open].node   = node;
+            open[num_open].depth  = depth;
+            open[num_open].end_ns = vd_debug_zone_get_end_ns(frame, zone);
+            num_open++;
+        }
+    }
+
+    // Parents are always created before their children, so linking backwards keeps children in first-seen order
+    for (Vdu32 i = stats->num_nodes; i-- > 0;) {
+        Vdu32 parent = stats->nodes[i].parent;
+        if (parent == VD_DEBUG_STATS_NO_NODE) {
+            stats->nodes[i].next_sibling = stats->first_root;
+            stats->first_root = i;
+        } else {
+            stats->nodes[i].next_sibling = stats->nodes[parent].first_child;
+            stats->nodes[parent].first_child = i;
+        }
+    }
+
+    Vdu32 num_samples = 0;
+    for (Vdu32 i = 0; i < stats->num_nodes; ++i) {
+        stats->nodes[i].first_sample = num_samples;
+        num_samples += stats->nodes[i].num_frames;
+    }
+    stats->samples = VD_ARENA_PUSH_ARRAY(arena, VdDebugStatsSample, num_samples);
+
+    // Sum each node's time per frame. A zone's time is its parent's (in the same frame) child time.
+    Vdu32 *filled = marks;
+    VD_MEMSET(filled, 0, sizeof(Vdu32) * stats->num_nodes);
+    z = 0;
+    for (Vdu32 f = 0; f < stats->num_frames; ++f) {
+        VdDebugFrame *frame = frames[f];
+        for (Vdu32 i = 0; i < frame->num_zones; ++i) {
+            Vdu32 node = zone_nodes[z++];
+            Vdf64 ms   = vd_debug_zone_get_ms(&frame->zones[i]);
+
+            VdDebugStatsSample *sample = vd__debug_stats_sample(stats, filled, node, f);
+            sample->inclusive_ms += ms;
+            sample->self_ms      += ms;
+
+            Vdu32 parent = stats->nodes[node].parent;
+            if (parent != VD_DEBUG_STATS_NO_NODE) {
+                vd__debug_stats_sample(stats, filled, parent, f)->self_ms -= ms;
+            }
+        }
+    }
+
+    Vdf64 *values = VD_ARENA_PUSH_ARRAY(arena, Vdf64, stats->num_frames);
+    for (Vdu32 i = 0; i < stats->num_nodes; ++i) {
+        VdDebugStatsNode   *node    = &stats->nodes[i];
+        VdDebugStatsSample *samples = &stats->samples[node->first_sample];
+
+        for (Vdu32 j = 0; j < node->num_frames; ++j) {
+            node->inclusive_ms += samples[j].inclusive_ms;
+            values[j] = samples[j].inclusive_ms;
+        }
+        node->inclusive = vd__debug_time_stats(values, node->num_frames);
+
+        for (Vdu32 j = 0; j < node->num_frames; ++j) {
+            node->self_ms += samples[j].self_ms;
+            values[j] = samples[j].self_ms;
+        }
+        node->self = vd__debug_time_stats(values, node->num_frames);
+    }
+
+    for (Vdu32 f = 0; f < stats->num_frames; ++f) values[f] = stats->frames[f].ms;
+    stats->frame_ms = vd__debug_time_stats(values, stats->num_frames);
+
+    // Counters and gauges: each site's value in each frame, folded into its min, max and mean
+    Vdu32 num_sites     = vd_debug_get_num_sites();
+    Vdu32 *value_of     = VD_ARENA_PUSH_ARRAY(arena, Vdu32, num_sites);
+    Vdu32 *frame_marks  = VD_ARENA_PUSH_ARRAY(arena, Vdu32, num_sites);
+    Vdu32 *touched      = VD_ARENA_PUSH_ARRAY(arena, Vdu32, num_sites);
+    Vdf64 *frame_values = VD_ARENA_PUSH_ARRAY(arena, Vdf64, num_sites);
+    stats->values       = VD_ARENA_PUSH_ARRAY(arena, VdDebugStatsValue, num_sites);
+
+    for (Vdu32 f = 0; f < stats->num_frames; ++f) {
+        VdDebugFrame *frame = frames[f];
+        Vdu32 num_touched   = 0;
+        for (Vdu32 i = 0; i < frame->num_samples; ++i) {
+            VdDebugSample *sample = &frame->samples[i];
+            Vdu32         index   = (Vdu32)(sample->time >> 48);
+            if (index >= num_sites) continue;
+
+            if (value_of[index] == 0) {
+                value_of[index] = ++stats->num_values;
+                stats->values[stats->num_values - 1].site = vd_debug_get_site(index);
+            }
+
+            if (frame_marks[index] != f + 1) {
+                frame_marks[index]     = f + 1;
+                frame_values[index]    = 0.0;
+                touched[num_touched++] = index;
+            }
+
+            Vdb32 is_counter    = stats->values[value_of[index] - 1].site->kind == VD_DEBUG_SITE_KIND_COUNTER;
+            frame_values[index] = is_counter ? frame_values[index] + sample->value : sample->value;
+        }
+
+        for (Vdu32 i = 0; i < num_touched; ++i) {
+            VdDebugStatsValue *value = &stats->values[value_of[touched[i]] - 1];
+            Vdf64 v = frame_values[touched[i]];
+            if ((value->num_frames == 0) || (v < value->min)) value->min = v;
+            if ((value->num_frames == 0) || (v > value->max)) value->max = v;
+            value->mean += v;
+            value->last  = v;
+            value->num_frames++;
+        }
+    }
+
+    for (Vdu32 i = 0; i < stats->num_values; ++i) {
+        stats->values[i].mean /= (Vdf64)stats->values[i].num_frames;
+    }
+}
+
+Vdu32 vd_debug_stats_find_spikes(VdDebugStats *stats, Vdf64 factor, VdDebugSpike *spikes, Vdu32 max_spikes)
+{
+    Vdf64 limit      = stats->frame_ms.p50_ms * factor;
+    Vdu32 num_spikes = 0;
+
+    for (Vdu32 f = 0; f < stats->num_frames && num_spikes < max_spikes; ++f) {
+        if (stats->frames[f].ms <= limit) continue;
+
+        VdDebugSpike *spike = &spikes[num_spikes++];
+        spike->frame     = f;
+        spike->frame_ms  = stats->frames[f].ms;
+        spike->node      = VD_DEBUG_STATS_NO_NODE;
+        spike->self_ms   = 0.0;
+        spike->growth_ms = 0.0;
+
+        for (Vdu32 i = 0; i < stats->num_nodes; ++i) {
+            VdDebugStatsNode   *node    = &stats->nodes[i];
+            VdDebugStatsSample *samples = &stats->samples[node->first_sample];
+
+            // Samples are in frame order
+            Vdu32 lo = 0, hi = node->num_frames;
+            while (lo < hi) {
+                Vdu32 mid = lo + (hi - lo) / 2;
+                if (samples[mid].frame < f) lo = mid + 1;
+                else                        hi = mid;
+            }
+            if (lo == node->num_frames || samples[lo].frame != f) continue;
+
+            Vdf64 growth = samples[lo].self_ms - node->self.p50_ms;
+            if (growth > spike->growth_ms) {
+                spike->node      = i;
+                spike->self_ms   = samples[lo].self_ms;
+                spike->growth_ms = growth;
+            }
+        }
+    }
+
+    return num_spikes;
+}
+
+#ifdef VD_UI_H
+static const Vdf32 Vd__Debug_Ui_Palette[8][3] = {
+    { 0.82f, 0.45f, 0.30f }, { 0.35f, 0.60f, 0.80f }, { 0.55f, 0.72f, 0.35f }, { 0.80f, 0.65f, 0.25f },
+    { 0.62f, 0.45f, 0.78f }, { 0.30f, 0.70f, 0.62f }, { 0.78f, 0.42f, 0.55f }, { 0.50f, 0.58f, 0.70f },
+};
+
+// Where the timeline's frames are: history indices first..last, the last one at the right edge
+typedef struct {
+    Vdf32   rect[4];
+    Vdf32   bar_w;
+    Vdusize first;
+    Vdusize last;
+    Vdb32   empty;
+} Vd__DebugUiTimeline;
+
+// Where the flame graph's zones are: thread lanes stacked top to bottom, one row per depth
+typedef struct {
+    VdDebugFrame *frame;
+    Vdf32        rect[4];
+    Vdf32        row_h;
+    Vdu32        num_rows;
+    Vdu32        base[VD_DEBUG_MAX_THREADS];
+    Vdu64        begin_ns;
+    Vdf64        px_per_ns;
+} Vd__DebugUiFlame;
+
+static void vd__debug_ui_fill(VdUiDiv *div, Vdf32 gray)
+{
+    div->style.background.normal = vd_ui_gradient1(vd_ui_f4(gray, gray, gray, 1.f));
+    div->style.background.hot    = div->style.background.normal;
+    div->style.background.active = div->style.background.normal;
+}
+
+// Fixed point, since vd_ui's formatting has no precision for floats
+static char *vd__debug_ui_fmt(char buf[32], Vdf64 v, Vdu32 decimals)
+{
+    Vdu64 scale = 1;
+    for (Vdu32 i = 0; i < decimals; ++i) scale *= 10;
+    if ((v != v) || (v < 0.0)) v = 0.0;
+    if (v > 1e12) v = 1e12;
+
+    Vdu64 fixed = (Vdu64)(v * (Vdf64)scale + 0.5);
+    char  tmp[32];
+    int   n = 0;
+    for (Vdu32 i = 0; i < decimals; ++i, fixed /= 10) tmp[n++] = (char)('0' + fixed % 10);
+    if (decimals) tmp[n++] = '.';
+    do { tmp[n++] = (char)('0' + fixed % 10); fixed /= 10; } while (fixed);
+
+    for (int i = 0; i < n; ++i) buf[i] = tmp[n - 1 - i];
+    buf[n] = 0;
+    return buf;
+}
+
+static const char *vd__debug_ui_basename(const char *path)
+{
+    const char *result = path ? path : "";
+    for (const char *c = result; *c; ++c) {
+        if ((*c == '/') || (*c == '\\')) result = c + 1;
+    }
+    return result;
+}
+
+static Vdb32 vd__debug_ui_push_rect(VdDebugUiPanel *panel, Vdf32 x0, Vdf32 y0, Vdf32 x1, Vdf32 y1, const Vdf32 color[4],
+                                    Vdf32 border_thickness)
+{
+    if (panel->num_quads >= VD_DEBUG_UI_MAX_QUADS) return 0;
+    panel->num_quads++;
+
+    Vdf32 rect[4] = { x0, y0, x1, y1 };
+    VdUiGradient gradient = vd_ui_gradient1(vd_ui_f4(color[0], color[1], color[2], color[3]));
+    vd_ui_push_rectgrad(rect, gradient.e, 0.f, 0.f, border_thickness);
+    return 1;
+}
+
+// The frame the flame graph shows: the selected one while it is in the history, the newest ended one otherwise
+static VdDebugFrame *vd__debug_ui_frame(VdDebugUiPanel *panel)
+{
+    Vdusize num_frames = vd_debug_get_num_frames();
+    if (panel->has_selection) {
+        for (Vdusize i = 0; i < num_frames; ++i) {
+            VdDebugFrame *frame = vd_debug_get_frame(i);
+            if (vd__debug_stats_frame_ended(frame) && (frame->index == panel->selected)) return frame;
+        }
+        panel->has_selection = 0;
+    }
+
+    for (Vdusize i = num_frames; i > 0; --i) {
+        VdDebugFrame *frame = vd_debug_get_frame(i - 1);
+        if (vd__debug_stats_frame_ended(frame)) return frame;
+    }
+    return 0;
+}
+
+static VdDebugSpike *vd__debug_ui_find_spike(VdDebugUiPanel *panel, Vdu64 index)
+{
+    for (Vdu32 i = 0; i < panel->num_spikes; ++i) {
+        if (panel->stats.frames[panel->spikes[i].frame].index == index) return &panel->spikes[i];
+    }
+    return 0;
+}
+
+static Vdf64 vd__debug_ui_column_value(VdDebugStatsNode *node, VdDebugUiColumn column)
+{
+    switch (column) {
+        case VD_DEBUG_UI_COLUMN_CALLS: return (Vdf64)node->count;
+        case VD_DEBUG_UI_COLUMN_TOTAL: return node->inclusive_ms;
+        case VD_DEBUG_UI_COLUMN_SELF:  return node->self_ms;
+        case VD_DEBUG_UI_COLUMN_MEAN:  return node->inclusive.mean_ms;
+        case VD_DEBUG_UI_COLUMN_P95:   return node->inclusive.p95_ms;
+        case VD_DEBUG_UI_COLUMN_MAX:   return node->inclusive.max_ms;
+        default:                       return 0.0;
+    }
+}
+
+static VD_PROC_SORT_CMP(vd__debug_ui_node_cmp)
+{
+    VdDebugUiPanel   *panel = (VdDebugUiPanel*)userdata;
+    VdDebugStatsNode *na    = &panel->stats.nodes[*(const Vdu32*)a];
+    VdDebugStatsNode *nb    = &panel->stats.nodes[*(const Vdu32*)b];
+
+    int result = 0;
+    if (panel->sort == VD_DEBUG_UI_COLUMN_NAME) {
+        const char *sa = na->site->name, *sb = nb->site->name;
+        while (*sa && (*sa == *sb)) { sa++; sb++; }
+        result = (int)(unsigned char)*sa - (int)(unsigned char)*sb;
+    } else {
+        Vdf64 va = vd__debug_ui_column_value(na, panel->sort);
+        Vdf64 vb = vd__debug_ui_column_value(nb, panel->sort);
+        result = (va > vb) - (va < vb);
+    }
+
+    return panel->sort_ascending ? result : -result;
+}
+
+static void vd__debug_ui_sort(VdDebugUiPanel *panel)
+{
+    vd_sort(panel->order, panel->stats.num_nodes, sizeof(Vdu32), vd__debug_ui_node_cmp, panel);
+}
+
+// Aggregates the history again if it changed, but not more often than every VD_DEBUG_UI_REFRESH_MS
+static void vd__debug_ui_refresh(VdDebugUiPanel *panel)
+{
+    VdDebugFrame *newest = 0;
+    for (Vdusize i = vd_debug_get_num_frames(); (i > 0) && !newest; --i) {
+        VdDebugFrame *frame = vd_debug_get_frame(i - 1);
+        if (vd__debug_stats_frame_ended(frame)) newest = frame;
+    }
+    if (!newest) return;
+
+    VdHiTime now = vd_hitime_get();
+    if (panel->built) {
+        if (panel->built_index == newest->index) return;
+        if (vd_hitime_fms64(vd_hitime_sub(now, panel->built_time)) < VD_DEBUG_UI_REFRESH_MS) return;
+    }
+
+    Vdusize num_frames = vd_debug_get_num_frames();
+    Vdusize num_zones  = 0;
+    for (Vdusize i = 0; i < num_frames; ++i) num_zones += vd_debug_get_frame(i)->num_zones;
+
+    Vdusize memory = vd_debug_stats_get_memory(num_frames) + num_zones * sizeof(Vdu32) + VD_ARENA_DEFAULT_ALIGNMENT;
+    if (panel->arena.buf_len < memory) {
+        if (panel->arena.buf) VD_FREE(panel->arena.buf, panel->arena.buf_len);
+        panel->arena = vd_arena_from_malloc(memory + memory / 2);
+    }
+    vd_arena_clear(&panel->arena);
+
+    vd_debug_stats_build(&panel->stats, &panel->arena, num_frames);
+    panel->order = VD_ARENA_PUSH_ARRAY(&panel->arena, Vdu32, panel->stats.num_nodes);
+    for (Vdu32 i = 0; i < panel->stats.num_nodes; ++i) panel->order[i] = i;
+    vd__debug_ui_sort(panel);
+
+    panel->num_spikes  = vd_debug_stats_find_spikes(&panel->stats, VD_DEBUG_UI_SPIKE_FACTOR, panel->spikes,
+                                                    VD_DEBUG_MAX_FRAMES);
+    panel->built       = 1;
+    panel->built_index = newest->index;
+    panel->built_time  = now;
+}
+
+static void vd__debug_ui_timeline_layout(VdDebugUiPanel *panel, Vd__DebugUiTimeline *timeline)
+{
+    VD_MEMCPY(timeline->rect, panel->timeline->rect, sizeof(timeline->rect));
+    timeline->bar_w = VD_DEBUG_UI_FRAME_PX * vd_ui_get_scale();
+
+    Vdusize num_frames = vd_debug_get_num_frames();
+    Vdusize visible    = (Vdusize)((timeline->rect[2] - timeline->rect[0]) / timeline->bar_w);
+    timeline->empty    = (num_frames == 0) || (visible == 0);
+    if (timeline->empty) return;
+
+    Vdf32 max_scroll = (Vdf32)(num_frames > visible ? num_frames - visible : 0);
+    if (panel->scroll < 0.f)        panel->scroll = 0.f;
+    if (panel->scroll > max_scroll) panel->scroll = max_scroll;
+
+    timeline->last  = num_frames - 1 - (Vdusize)panel->scroll;
+    timeline->first = timeline->last + 1 > visible ? timeline->last + 1 - visible : 0;
+}
+
+// The history index of the frame under x, or num_frames
+static Vdusize vd__debug_ui_timeline_hit(Vd__DebugUiTimeline *timeline, Vdf32 x)
+{
+    if (timeline->empty || (x < timeline->rect[0]) || (x >= timeline->rect[2])) return vd_debug_get_num_frames();
+
+    Vdusize back = (Vdusize)((timeline->rect[2] - x) / timeline->bar_w);
+    if (back > timeline->last - timeline->first) return vd_debug_get_num_frames();
+    return timeline->last - back;
+}
+
+// Gives each thread that has zones in frame a lane of rows, one per depth. Returns the number of rows.
+static Vdu32 vd__debug_ui_flame_lanes(VdDebugFrame *frame, Vdu32 base[VD_DEBUG_MAX_THREADS])
+{
+    Vdu32 rows[VD_DEBUG_MAX_THREADS] = {0};
+    for (Vdu32 i = 0; i < frame->num_zones; ++i) {
+        Vdu32 thread = vd_debug_zone_get_thread(&frame->zones[i]);
+        Vdu32 depth  = vd_debug_zone_get_depth(&frame->zones[i]);
+        if (depth + 1 > rows[thread]) rows[thread] = depth + 1;
+    }
+
+    Vdu32 num_rows = 0;
+    for (Vdu32 t = 0; t < VD_DEBUG_MAX_THREADS; ++t) {
+        base[t]   = num_rows;
+        num_rows += rows[t];
+    }
+    return num_rows;
+}
+
+static void vd__debug_ui_flame_layout(VdDebugUiPanel *panel, VdDebugFrame *frame, Vd__DebugUiFlame *flame)
+{
+    flame->num_rows = vd__debug_ui_flame_lanes(frame, flame->base);
+
+    Vdu64 frame_begin_ns = vd_hitime_ns(frame->begin_time);
+    Vdf64 frame_span_ns  = (Vdf64)(vd_hitime_ns(frame->end_time) - frame_begin_ns);
+    if (frame_span_ns < 1.0) frame_span_ns = 1.0;
+
+    flame->frame     = frame;
+    VD_MEMCPY(flame->rect, panel->flame->rect, sizeof(flame->rect));
+    flame->row_h     = VD_DEBUG_UI_ROW_PX * vd_ui_get_scale();
+    flame->begin_ns  = frame_begin_ns + (Vdu64)(frame_span_ns * panel->view[0]);
+    flame->px_per_ns = (Vdf64)(flame->rect[2] - flame->rect[0]) / (frame_span_ns * (panel->view[1] - panel->view[0]));
+}
+
+static void vd__debug_ui_flame_zone_x(Vd__DebugUiFlame *flame, VdDebugZone *zone, Vdf64 *x0, Vdf64 *x1)
+{
+    Vdi64 begin = (Vdi64)(vd_debug_zone_get_begin_ns(flame->frame, zone) - flame->begin_ns);
+    Vdi64 end   = (Vdi64)(vd_debug_zone_get_end_ns(flame->frame, zone) - flame->begin_ns);
+    *x0 = (Vdf64)flame->rect[0] + (Vdf64)begin * flame->px_per_ns;
+    *x1 = (Vdf64)flame->rect[0] + (Vdf64)end * flame->px_per_ns;
+}
+
+static Vdu32 vd__debug_ui_flame_hit(Vd__DebugUiFlame *flame, Vdf32 x, Vdf32 y)
+{
+    if ((x < flame->rect[0]) || (x >= flame->rect[2]) || (y < flame->rect[1]) || (y >= flame->rect[3])) {
+        return VD_DEBUG_UI_NO_ZONE;
+    }
+
+    Vdu32 row = (Vdu32)((y - flame->rect[1]) / flame->row_h);
+    for (Vdu32 i = 0; i < flame->frame->num_zones; ++i) {
+        VdDebugZone *zone = &flame->frame->zones[i];
+        if (flame->base[vd_debug_zone_get_thread(zone)] + vd_debug_zone_get_depth(zone) != row) continue;
+
+        Vdf64 x0, x1;
+        vd__debug_ui_flame_zone_x(flame, zone, &x0, &x1);
+        if ((x >= x0) && (x < x1)) return i;
+    }
+    return VD_DEBUG_UI_NO_ZONE;
+}
+
+static void vd__debug_ui_table(VdDebugUiPanel *panel, float wheel[2])
+{
+    static const char *titles[VD_DEBUG_UI_COLUMN_COUNT] = {
+        "Zone", "Calls", "Total ms", "Self ms", "Mean ms", "P95 ms", "Max ms",
+    };
+    Vdf32 s = vd_ui_get_scale();
+
+    VdUiDiv *table = vd_ui_div_newf(0, "##vd-debug-table");
+    table->size[0].mode  = VD_UI_SIZE_MODE_PERCENT_OF_PARENT;
+    table->size[0].value = 1.f;
+    table->size[1].mode  = VD_UI_SIZE_MODE_CONTAIN_CHILDREN;
+
+    VdUiReply reply = vd_ui_call(table);
+    if ((reply.mouse[0] >= table->rect[0]) && (reply.mouse[0] < table->rect[2]) &&
+        (reply.mouse[1] >= table->rect[1]) && (reply.mouse[1] < table->rect[3]))
+    {
+        Vdi64 scroll = (Vdi64)panel->table_scroll - (Vdi64)wheel[1];
+        Vdi64 max    = (Vdi64)panel->stats.num_nodes - VD_DEBUG_UI_TABLE_ROWS;
+        if (scroll > max) scroll = max;
+        if (scroll < 0)   scroll = 0;
+        panel->table_scroll = (Vdu32)scroll;
+    }
+
+    vd_ui_parent_push(table);
+
+    VdUiDiv *header = vd_ui_div_newf(VD_UI_FLAG_FLEX_HORIZONTAL, "##vd-debug-header");
+    header->size[0].mode = VD_UI_SIZE_MODE_CONTAIN_CHILDREN;
+    header->size[1].mode = VD_UI_SIZE_MODE_CONTAIN_CHILDREN;
+    vd_ui_parent_push(header);
+    for (int c = 0; c < VD_DEBUG_UI_COLUMN_COUNT; ++c) {
+        const char *arrow = (panel->sort != (VdDebugUiColumn)c) ? "" : panel->sort_ascending ? " ^" : " v";
+
+        VdUiDiv *cell = vd_ui_div_newf(VD_UI_FLAG_TEXT | VD_UI_FLAG_BACKGROUND | VD_UI_FLAG_CLICKABLE,
+                                       "%s%s##vd-debug-sort%d", titles[c], arrow, c);
+        cell->size[0].mode  = VD_UI_SIZE_MODE_ABSOLUTE;
+        cell->size[0].value = (c == VD_DEBUG_UI_COLUMN_NAME ? 240.f : 80.f) * s;
+        cell->size[1].mode  = VD_UI_SIZE_MODE_TEXT_CONTENT;
+        cell->style.padding[VD_UI_LEFT]  = 4.f;
+        cell->style.padding[VD_UI_RIGHT] = 4.f;
+        cell->style.text_halign = (c == VD_DEBUG_UI_COLUMN_NAME) ? VD_UI_TEXT_HALIGN_LEFT : VD_UI_TEXT_HALIGN_RIGHT;
+        vd__debug_ui_fill(cell, 0.2f);
+        cell->style.background.hot = vd_ui_gradient1(vd_ui_f4(0.3f, 0.3f, 0.3f, 1.f));
+
+        if (vd_ui_call(cell).clicked) {
+            if (panel->sort == (VdDebugUiColumn)c) {
+                panel->sort_ascending = !panel->sort_ascending;
+            } else {
+                panel->sort           = (VdDebugUiColumn)c;
+                panel->sort_ascending = (c == VD_DEBUG_UI_COLUMN_NAME);
+            }
+
+            if (panel->built) vd__debug_ui_sort(panel);
+        }
+    }
+    vd_ui_parent_pop();
+
+    // Rows are identified by their position, so scrolling reuses the same divs
+    for (Vdu32 r = 0; (r < VD_DEBUG_UI_TABLE_ROWS) && (panel->table_scroll + r < panel->stats.num_nodes); ++r) {
+        VdDebugStatsNode *node = &panel->stats.nodes[panel->order[panel->table_scroll + r]];
+
+        VdUiDiv *row = vd_ui_div_newf(VD_UI_FLAG_FLEX_HORIZONTAL, "##vd-debug-row%d", (int)r);
+        row->size[0].mode = VD_UI_SIZE_MODE_CONTAIN_CHILDREN;
+        row->size[1].mode = VD_UI_SIZE_MODE_CONTAIN_CHILDREN;
+        vd_ui_parent_push(row);
+        for (int c = 0; c < VD_DEBUG_UI_COLUMN_COUNT; ++c) {
+            char        buf[32];
+            const char *text = (c == VD_DEBUG_UI_COLUMN_NAME) ? node->site->name :
+                               vd__debug_ui_fmt(buf, vd__debug_ui_column_value(node, (VdDebugUiColumn)c),
+                                                c == VD_DEBUG_UI_COLUMN_CALLS ? 0 : 3);
+
+            VdUiDiv *cell = vd_ui_div_newf(VD_UI_FLAG_TEXT, "%s##c%d", text, c);
+            cell->size[0].mode  = VD_UI_SIZE_MODE_ABSOLUTE;
+            cell->size[0].value = (c == VD_DEBUG_UI_COLUMN_NAME ? 240.f : 80.f) * s;
+            cell->size[1].mode  = VD_UI_SIZE_MODE_TEXT_CONTENT;
+            cell->style.padding[VD_UI_LEFT]  = 4.f + (c == VD_DEBUG_UI_COLUMN_NAME ? 12.f * s * node->depth : 0.f);
+            cell->style.padding[VD_UI_RIGHT] = 4.f;
+            cell->style.text_halign = (c == VD_DEBUG_UI_COLUMN_NAME) ? VD_UI_TEXT_HALIGN_LEFT : VD_UI_TEXT_HALIGN_RIGHT;
+        }
+        vd_ui_parent_pop();
+    }
+
+    vd_ui_parent_pop();
+}
+
+void vd_debug_ui_panel(VdDebugUiPanel *panel)
+{
+    Vdf32 s = vd_ui_get_scale();
+    if (!panel->initialized) {
+        panel->initialized = 1;
+        panel->sort        = VD_DEBUG_UI_COLUMN_SELF;
+        panel->view[0]     = 0.0;
+        panel->view[1]     = 1.0;
+    }
+    panel->hovered = VD_DEBUG_UI_NO_ZONE;
+
+    VdUiDiv *root = vd_ui_div_newf(VD_UI_FLAG_BACKGROUND | VD_UI_FLAG_CLIP_CONTENT, "##vd-debug-panel");
+    root->size[0].mode  = VD_UI_SIZE_MODE_PERCENT_OF_PARENT;
+    root->size[0].value = 1.f;
+    root->size[1].mode  = VD_UI_SIZE_MODE_PERCENT_OF_PARENT;
+    root->size[1].value = 1.f;
+    vd__debug_ui_fill(root, 0.1f);
+    vd_ui_parent_push(root);
+
+    if (VD_DEBUG_GET_STATE().frames == 0) {
+        panel->timeline = 0;
+        panel->flame    = 0;
+        vd_ui_labelf("VD_DEBUG_INIT has not been called##vd-debug-none");
+        vd_ui_parent_pop();
+        return;
+    }
+
+    vd__debug_ui_refresh(panel);
+
+    VdUiDiv *toolbar = vd_ui_div_newf(VD_UI_FLAG_FLEX_HORIZONTAL | VD_UI_FLAG_ALIGN_CENTER, "##vd-debug-toolbar");
+    toolbar->size[0].mode  = VD_UI_SIZE_MODE_PERCENT_OF_PARENT;
+    toolbar->size[0].value = 1.f;
+    toolbar->size[1].mode  = VD_UI_SIZE_MODE_CONTAIN_CHILDREN;
+
+    panel->timeline = vd_ui_div_newf(VD_UI_FLAG_BACKGROUND | VD_UI_FLAG_CLICKABLE, "##vd-debug-timeline");
+    panel->timeline->size[0].mode  = VD_UI_SIZE_MODE_PERCENT_OF_PARENT;
+    panel->timeline->size[0].value = 1.f;
+    panel->timeline->size[1].mode  = VD_UI_SIZE_MODE_ABSOLUTE;
+    panel->timeline->size[1].value = 64.f * s;
+    vd__debug_ui_fill(panel->timeline, 0.14f);
+
+    VdDebugFrame *frame     = vd__debug_ui_frame(panel);
+    Vdu32        flame_rows = 4;
+    if (frame) {
+        Vdu32 base[VD_DEBUG_MAX_THREADS];
+        Vdu32 num_rows = vd__debug_ui_flame_lanes(frame, base);
+        if (num_rows > flame_rows) flame_rows = num_rows;
+        if (flame_rows > VD_DEBUG_UI_FLAME_ROWS) flame_rows = VD_DEBUG_UI_FLAME_ROWS;
+    }
+
+    panel->flame = vd_ui_div_newf(VD_UI_FLAG_BACKGROUND | VD_UI_FLAG_CLICKABLE | VD_UI_FLAG_CAPTURES_MOUSE,
+                                  "##vd-debug-flame");
+    panel->flame->size[0].mode  = VD_UI_SIZE_MODE_PERCENT_OF_PARENT;
+    panel->flame->size[0].value = 1.f;
+    panel->flame->size[1].mode  = VD_UI_SIZE_MODE_ABSOLUTE;
+    panel->flame->size[1].value = (Vdf32)flame_rows * VD_DEBUG_UI_ROW_PX * s;
+    vd__debug_ui_fill(panel->flame, 0.12f);
+
+    float wheel[2];
+    vd_ui_get_mouse_wheel(wheel);
+
+    // The divs' rects are from the last layout, which is what the user sees and clicks on
+    Vd__DebugUiTimeline timeline;
+    vd__debug_ui_timeline_layout(panel, &timeline);
+    VdUiReply reply = vd_ui_call(panel->timeline);
+    if (reply.hovering) {
+        panel->scroll += wheel[1];
+        vd__debug_ui_timeline_layout(panel, &timeline);
+    }
+
+    if (reply.clicked) {
+        Vdusize i = vd__debug_ui_timeline_hit(&timeline, reply.mouse[0]);
+        if ((i < vd_debug_get_num_frames()) && vd__debug_stats_frame_ended(vd_debug_get_frame(i))) {
+            panel->has_selection = 1;
+            panel->selected      = vd_debug_get_frame(i)->index;
+            panel->view[0]       = 0.0;
+            panel->view[1]       = 1.0;
+            if (vd__debug_ui_find_spike(panel, panel->selected)) vd_debug_pause(1);
+            frame = vd__debug_ui_frame(panel);
+        }
+    }
+
+    reply = vd_ui_call(panel->flame);
+    if (frame) {
+        Vd__DebugUiFlame flame;
+        vd__debug_ui_flame_layout(panel, frame, &flame);
+        Vdf64 width = (Vdf64)(flame.rect[2] - flame.rect[0]);
+
+        if (reply.hovering && (wheel[1] != 0.f) && (width > 0.0)) {
+            // Zoom around the mouse, down to about a microsecond across
+            Vdf64 span     = panel->view[1] - panel->view[0];
+            Vdf64 at       = panel->view[0] + span * (Vdf64)(reply.mouse[0] - flame.rect[0]) / width;
+            Vdf64 factor   = 1.0 - 0.15 * (Vdf64)wheel[1];
+            Vdf64 min_span = 1000.0 / (vd_debug_frame_get_ms(frame) * 1000000.0 + 1.0);
+            if (factor < 0.5) factor = 0.5;
+            if (factor > 2.0) factor = 2.0;
+
+            Vdf64 new_span = span * factor;
+            if (new_span < min_span) new_span = min_span;
+            if (new_span > 1.0)      new_span = 1.0;
+            panel->view[0] = at - (at - panel->view[0]) * (new_span / span);
+            panel->view[1] = panel->view[0] + new_span;
+        }
+
+        if ((reply.drag[0] != 0.f) && (width > 0.0)) {
+            Vdf64 shift = -(Vdf64)reply.drag[0] / width * (panel->view[1] - panel->view[0]);
+            panel->view[0] += shift;
+            panel->view[1] += shift;
+        }
+
+        if (panel->view[0] < 0.0) { panel->view[1] -= panel->view[0];        panel->view[0] = 0.0; }
+        if (panel->view[1] > 1.0) { panel->view[0] -= panel->view[1] - 1.0;  panel->view[1] = 1.0; }
+        if (panel->view[0] < 0.0) panel->view[0] = 0.0;
+
+        if (reply.hovering) {
+            vd__debug_ui_flame_layout(panel, frame, &flame);
+            panel->hovered = vd__debug_ui_flame_hit(&flame, reply.mouse[0], reply.mouse[1]);
+        }
+    }
+
+    vd__debug_ui_table(panel, wheel);
+
+    // Filled in last, so that it can describe what the mouse is over
+    vd_ui_parent_push(toolbar);
+    {
+        char buf[32];
+        if (vd_ui_buttonf("%s##vd-debug-pause", vd_debug_is_paused() ? "Resume" : "Pause").clicked) {
+            vd_debug_pause(!vd_debug_is_paused());
+        }
+
+        if (vd_ui_buttonf("Reset zoom##vd-debug-zoom").clicked) {
+            panel->view[0] = 0.0;
+            panel->view[1] = 1.0;
+        }
+
+        if (frame) {
+            vd_ui_labelf(" Frame %d: %s ms, %d zones, %d dropped##vd-debug-frame", (int)frame->index,
+                         vd__debug_ui_fmt(buf, vd_debug_frame_get_ms(frame), 3), (int)frame->num_zones,
+                         (int)frame->num_dropped);
+
+            VdDebugSpike *spike = vd__debug_ui_find_spike(panel, frame->index);
+            if (spike && (spike->node != VD_DEBUG_STATS_NO_NODE)) {
+                vd_ui_labelf(" Spike: %s took %s ms more than usual##vd-debug-spike",
+                             panel->stats.nodes[spike->node].site->name, vd__debug_ui_fmt(buf, spike->growth_ms, 3));
+            }
+        }
+
+        if (frame && (panel->hovered != VD_DEBUG_UI_NO_ZONE)) {
+            VdDebugZone *zone = &frame->zones[panel->hovered];
+            VdDebugSite *site   = vd_debug_zone_get_site(zone);
+            const char  *thread = vd_debug_get_thread_name(vd_debug_zone_get_thread(zone));
+            vd_ui_labelf(" | %s: %s ms (%s:%d, thread %d %s)##vd-debug-hovered", site->name,
+                         vd__debug_ui_fmt(buf, vd_debug_zone_get_ms(zone), 3), vd__debug_ui_basename(site->file),
+                         (int)site->line, (int)vd_debug_zone_get_thread(zone), thread ? thread : "");
+        }
+    }
+    vd_ui_parent_pop();
+
+    vd_ui_parent_pop();
+}
+
+static void vd__debug_ui_draw_timeline(VdDebugUiPanel *panel)
+{
+    static const Vdf32 normal[4]   = { 0.35f, 0.65f, 0.40f, 1.f };
+    static const Vdf32 slow[4]     = { 0.90f, 0.60f, 0.20f, 1.f };
+    static const Vdf32 spike[4]    = { 0.90f, 0.25f, 0.25f, 1.f };
+    static const Vdf32 selected[4] = { 1.f, 1.f, 1.f, 0.15f };
+    static const Vdf32 target[4]   = { 1.f, 1.f, 1.f, 0.35f };
+
+    Vd__DebugUiTimeline timeline;
+    vd__debug_ui_timeline_layout(panel, &timeline);
+    if (timeline.empty) return;
+
+    VdDebugFrame *shown = vd__debug_ui_frame(panel);
+
+    Vdf64 scale_ms = VD_DEBUG_UI_TARGET_MS * 1.25;
+    for (Vdusize i = timeline.first; i <= timeline.last; ++i) {
+        Vdf64 ms = vd_debug_frame_get_ms(vd_debug_get_frame(i));
+        if (ms * 1.1 > scale_ms) scale_ms = ms * 1.1;
+    }
+
+    Vdf32 height = timeline.rect[3] - timeline.rect[1];
+    for (Vdusize i = timeline.first; i <= timeline.last; ++i) {
+        VdDebugFrame *frame = vd_debug_get_frame(i);
+        if (!vd__debug_stats_frame_ended(frame)) continue;
+
+        Vdf32 x1 = timeline.rect[2] - (Vdf32)(timeline.last - i) * timeline.bar_w;
+        Vdf32 x0 = x1 - timeline.bar_w;
+        if (frame == shown) {
+            vd__debug_ui_push_rect(panel, x0, timeline.rect[1], x1, timeline.rect[3], selected, 0.f);
+        }
+
+        Vdf64        ms    = vd_debug_frame_get_ms(frame);
+        const Vdf32 *color = vd__debug_ui_find_spike(panel, frame->index) ? spike :
+                             ms > VD_DEBUG_UI_TARGET_MS                   ? slow  : normal;
+        Vdf32 y0 = timeline.rect[3] - (Vdf32)(ms / scale_ms) * height;
+        vd__debug_ui_push_rect(panel, x0 + 1.f, y0, x1 - 1.f, timeline.rect[3], color, 0.f);
+    }
+
+    Vdf32 y = timeline.rect[3] - (Vdf32)(VD_DEBUG_UI_TARGET_MS / scale_ms) * height;
+    vd__debug_ui_push_rect(panel, timeline.rect[0], y, timeline.rect[2], y + 1.f, target, 0.f);
+}
+
+// Draws a bar, and its name if it fits
+static void vd__debug_ui_draw_bar(VdDebugUiPanel *panel, Vd__DebugUiFlame *flame, Vdu32 row, Vdf32 x0, Vdf32 x1,
+                                  VdDebugSite *site, Vdu32 site_index)
+{
+    static const Vdf32 merged[4] = { 0.45f, 0.45f, 0.45f, 1.f };
+
+    Vdf32 y0 = flame->rect[1] + (Vdf32)row * flame->row_h;
+    Vdf32 y1 = y0 + flame->row_h - 1.f;
+    if (x1 - x0 < 1.f) x1 = x0 + 1.f;
+
+    if (!site) {
+        vd__debug_ui_push_rect(panel, x0, y0, x1, y1, merged, 0.f);
+        return;
+    }
+
+    const Vdf32 *rgb      = Vd__Debug_Ui_Palette[vd_hash_u32(site_index) % 8];
+    Vdf32       color[4] = { rgb[0], rgb[1], rgb[2], 1.f };
+    if (!vd__debug_ui_push_rect(panel, x0, y0, x1 - 1.f, y1, color, 0.f)) return;
+
+    // Text is measured only for bars that could hold a few glyphs
+    Vdf32   size = flame->row_h - 4.f;
+    VdUiStr name = { (char*)site->name, vd_ui_strlen(site->name) };
+    if ((x1 - x0) < size * 2.f) return;
+    if (panel->num_quads + (Vdu32)name.l > VD_DEBUG_UI_MAX_QUADS) return;
+
+    float w = 0.f, h = 0.f;
+    vd_ui_measure_text_size((VdUiFontId){0}, name, size, &w, &h);
+    if (w + 6.f > x1 - x0) return;
+
+    vd_ui_push_text(name, x0 + 3.f, y0 + 2.f, size);
+    panel->num_quads += (Vdu32)name.l;
+}
+
+static void vd__debug_ui_draw_flame(VdDebugUiPanel *panel)
+{
+    static const Vdf32 hovered[4] = { 1.f, 1.f, 1.f, 1.f };
+
+    VdDebugFrame *frame = vd__debug_ui_frame(panel);
+    if (!frame) return;
+
+    Vd__DebugUiFlame flame;
+    vd__debug_ui_flame_layout(panel, frame, &flame);
+
+    Vdu32 num_rows = (Vdu32)((flame.rect[3] - flame.rect[1]) / flame.row_h);
+    if (num_rows > flame.num_rows) num_rows = flame.num_rows;
+    if (num_rows > VD_DEBUG_UI_FLAME_ROWS) num_rows = VD_DEBUG_UI_FLAME_ROWS;
+
+    // A run of narrow zones per row, waiting to be drawn as one bar. Each row's zones come left to right.
+    Vdf32 pending[VD_DEBUG_UI_FLAME_ROWS][2];
+    Vdu32 pending_count[VD_DEBUG_UI_FLAME_ROWS] = {0};
+    Vdu32 pending_zone[VD_DEBUG_UI_FLAME_ROWS];
+
+    for (Vdu32 i = 0; i < frame->num_zones; ++i) {
+        VdDebugZone *zone = &frame->zones[i];
+        Vdu32        row  = flame.base[vd_debug_zone_get_thread(zone)] + vd_debug_zone_get_depth(zone);
+        if (row >= num_rows) continue;
+
+        Vdf64 fx0, fx1;
+        vd__debug_ui_flame_zone_x(&flame, zone, &fx0, &fx1);
+        if ((fx1 < (Vdf64)flame.rect[0]) || (fx0 > (Vdf64)flame.rect[2])) continue;
+
+        Vdf32 x0 = fx0 < (Vdf64)flame.rect[0] ? flame.rect[0] : (Vdf32)fx0;
+        Vdf32 x1 = fx1 > (Vdf64)flame.rect[2] ? flame.rect[2] : (Vdf32)fx1;
+        panel->num_zones_drawn++;
+
+        if (pending_count[row] && ((x1 - x0 >= VD_DEBUG_UI_MERGE_PX) || (x0 - pending[row][1] >= VD_DEBUG_UI_MERGE_PX))) {
+            VdDebugZone *first = &frame->zones[pending_zone[row]];
+            vd__debug_ui_draw_bar(panel, &flame, row, pending[row][0], pending[row][1],
+                                  pending_count[row] == 1 ? vd_debug_zone_get_site(first) : 0,
+                                  vd_debug_zone_get_site_index(first));
+            pending_count[row] = 0;
+        }
+
+        if (x1 - x0 >= VD_DEBUG_UI_MERGE_PX) {
+            vd__debug_ui_draw_bar(panel, &flame, row, x0, x1, vd_debug_zone_get_site(zone),
+                                  vd_debug_zone_get_site_index(zone));
+        } else if (pending_count[row]) {
+            if (x1 > pending[row][1]) pending[row][1] = x1;
+            pending_count[row]++;
+        } else {
+            pending[row][0]    = x0;
+            pending[row][1]    = x1;
+            pending_count[row] = 1;
+            pending_zone[row]  = i;
+        }
+    }
+
+    for (Vdu32 row = 0; row < num_rows; ++row) {
+        if (!pending_count[row]) continue;
+        VdDebugZone *first = &frame->zones[pending_zone[row]];
+        vd__debug_ui_draw_bar(panel, &flame, row, pending[row][0], pending[row][1],
+                              pending_count[row] == 1 ? vd_debug_zone_get_site(first) : 0,
+                              vd_debug_zone_get_site_index(first));
+    }
+
+    if (panel->hovered < frame->num_zones) {
+        VdDebugZone *zone = &frame->zones[panel->hovered];
+        Vdu32        row  = flame.base[vd_debug_zone_get_thread(zone)] + vd_debug_zone_get_depth(zone);
+        Vdf64 x0, x1;
+        vd__debug_ui_flame_zone_x(&flame, zone, &x0, &x1);
+        if (row < num_rows) {
+            Vdf32 y0 = flame.rect[1] + (Vdf32)row * flame.row_h;
+            vd__debug_ui_push_rect(panel, (Vdf32)x0, y0, (Vdf32)x1 + 1.f, y0 + flame.row_h, hovered, 1.f);
+        }
+    }
+}
+
+void vd_debug_ui_panel_draw(VdDebugUiPanel *panel)
+{
+    panel->num_quads       = 0;
+    panel->num_zones_drawn = 0;
+    if (!panel->timeline || !panel->flame) return;
+
+    vd__debug_ui_draw_timeline(panel);
+    vd__debug_ui_draw_flame(panel);
+}
+
+void vd_debug_ui_panel_destroy(VdDebugUiPanel *panel)
+{
+    if (panel->arena.buf) VD_FREE(panel->arena.buf, panel->arena.buf_len);
+    VD_MEMSET(panel, 0, sizeof(*panel));
+}
+#endif // VD_UI_H
+
+#ifndef VD_DEBUG_INCLUDE_INTERNAL_TESTS
+#   define VD_DEBUG_INCLUDE_INTERNAL_TESTS 0
+#endif // !VD_DEBUG_INCLUDE_INTERNAL_TESTS
+#if VD_DEBUG_INCLUDE_INTERNAL_TESTS && VD_DEBUG_ENABLE
+
+static void vd__debug_test_init(void)
+{
+    if (VD_DEBUG_GET_STATE().frames == 0) {
+        VD_DEBUG_INIT();
+    }
+}
+
+static VdDebugFrame *vd__debug_test_last_frame(void)
+{
+    return vd_debug_get_frame(vd_debug_get_num_frames() - 1);
+}
+
+#if VD_INCLUDE_PLATFORM_SPECIFIC_FUNCTIONALITY
+static VD_PROC_THREAD(vd__debug_test_worker)
+{
+    VD_UNUSED(userdata);
+    for (int i = 0; i < 100; ++i) {
+        VD_DEBUG_ZONE_BEGIN(outer);
+        VD_DEBUG_ZONE_BEGIN(inner);
+        VD_DEBUG_ZONE_END(inner);
+        VD_DEBUG_ZONE_END(outer);
+    }
+}
+
+VD_TEST("Debug/Threads") {
+    enum { NUM_THREADS = 4 };
+    vd__debug_test_init();
+
+    VD_DEBUG_FRAME_BEGIN();
+    VdThread threads[NUM_THREADS];
+    for (int i = 0; i < NUM_THREADS; ++i) vd_thread_create(&threads[i], vd__debug_test_worker, 0);
+    for (int i = 0; i < NUM_THREADS; ++i) vd_thread_join(&threads[i]);
+    VD_DEBUG_FRAME_END();
+
+    VdDebugFrame *frame = vd__debug_test_last_frame();
+    VD_TEST_EQ("Zones from every thread", vd_debug_frame_get_num_zones(frame), NUM_THREADS * 200);
+    VD_TEST_EQ("Nothing dropped", vd_debug_frame_get_num_dropped(frame), 0);
+
+    // Grouped by thread, in begin order, each inner zone right after its outer zone
+    Vdb32 ok = VD_TRUE;
+    for (Vdusize i = 0; i < vd_debug_frame_get_num_zones(frame); i += 2) {
+        VdDebugZone *outer = vd_debug_frame_get_zone(frame, i);
+        VdDebugZone *inner = vd_debug_frame_get_zone(frame, i + 1);
+        ok = ok && (vd_debug_zone_get_depth(outer) == 0) && (vd_debug_zone_get_depth(inner) == 1);
+        ok = ok && (vd_debug_zone_get_thread(outer) == vd_debug_zone_get_thread(inner));
+        ok = ok && (vd_debug_zone_get_begin_ns(frame, outer) <= vd_debug_zone_get_begin_ns(frame, inner));
+        ok = ok && (vd_debug_zone_get_end_ns(frame, inner) <= vd_debug_zone_get_end_ns(frame, outer));
+    }
+    VD_TEST_TRUE("Nesting is kept per thread", ok);
+    VD_TEST_OK();
+}
+#endif // VD_INCLUDE_PLATFORM_SPECIFIC_FUNCTIONALITY
+
+VD_TEST("Debug/TooManyThreads") {
+    vd__debug_test_init();
+
+    // Pretend every slot is taken and this thread hasn't asked for one yet
+    Vd__DebugThread *self        = Vd__Debug_Thread;
+    Vdu32            num_threads = VD_DEBUG_GET_STATE().num_threads;
+    Vd__Debug_Thread                 = 0;
+    VD_DEBUG_GET_STATE().num_threads = VD_DEBUG_MAX_THREADS;
+
+    VD_DEBUG_FRAME_BEGIN();
+    for (int i = 0; i < 100; ++i) {
+        VD_DEBUG_ZONE_BEGIN(zone);
+        VD_DEBUG_ZONE_END(zone);
+    }
+    VD_TEST_TRUE("The thread isn't traced", vd__debug_get_thread() == 0);
+    VD_TEST_EQ("It asked for a slot once", VD_DEBUG_GET_STATE().num_threads, VD_DEBUG_MAX_THREADS + 1);
+    VD_TEST_EQ("The count stays clamped", vd_debug_get_num_threads(), VD_DEBUG_MAX_THREADS);
+
+    Vd__Debug_Thread                 = self;
+    VD_DEBUG_GET_STATE().num_threads = num_threads;
+    VD_DEBUG_FRAME_END();
+    VD_TEST_EQ("Its zones are dropped", vd_debug_frame_get_num_dropped(vd__debug_test_last_frame()), 100);
+    VD_TEST_OK();
+}
+
+VD_TEST("Debug/Overflow") {
+    enum { NUM_ZONES = VD_DEBUG_THREAD_RING_ZONES + 10 };
+    vd__debug_test_init();
+
+    VD_DEBUG_FRAME_BEGIN();
+    for (int i = 0; i < NUM_ZONES; ++i) {
+        VD_DEBUG_ZONE_BEGIN(zone);
+        VD_DEBUG_ZONE_END(zone);
+    }
+    VD_DEBUG_FRAME_END();
+
+    VdDebugFrame *frame = vd__debug_test_last_frame();
+    VD_TEST_EQ("The frame keeps what fits", vd_debug_frame_get_num_zones(frame), VD_DEBUG_MAX_ZONES);
+    VD_TEST_EQ("The rest is counted", vd_debug_frame_get_num_dropped(frame), NUM_ZONES - VD_DEBUG_MAX_ZONES);
+
+    VD_DEBUG_FRAME_BEGIN();
+    VD_DEBUG_FRAME_END();
+    VD_TEST_EQ("Rings are emptied", vd_debug_frame_get_num_zones(vd__debug_test_last_frame()), 0);
+    VD_TEST_OK();
+}
+
+typedef struct {
+    char    data[1 << 20];
+    Vdusize len;
+    Vdu32   num_writes;
+} Vd__DebugTestSink;
+
+static VD_PROC_DEBUG_TRACE_WRITE(vd__debug_test_sink_write)
+{
+    Vd__DebugTestSink *sink = (Vd__DebugTestSink*)userdata;
+    Vdusize n = size < sizeof(sink->data) - 1 - sink->len ? size : sizeof(sink->data) - 1 - sink->len;
+    VD_MEMCPY(sink->data + sink->len, data, n);
+    sink->len += n;
+    sink->data[sink->len] = 0;
+    sink->num_writes++;
+}
+
+// Walks a Perfetto trace as length-delimited Trace.packet (field 1) records; returns 0 if it isn't exactly that
+static Vdusize vd__debug_test_count_packets(Vd__DebugTestSink *sink)
+{
+    Vdusize at = 0, num_packets = 0;
+    while (at < sink->len) {
+        if ((Vdu8)sink->data[at++] != 0x0a) return 0;
+
+        Vdu64 len = 0;
+        int shift = 0;
+        while (at < sink->len) {
+            Vdu8 b = (Vdu8)sink->data[at++];
+            len |= (Vdu64)(b & 0x7f) << shift;
+            shift += 7;
+            if ((b & 0x80) == 0) break;
+        }
+        at += (Vdusize)len;
+        num_packets++;
+    }
+    return at == sink->len ? num_packets : 0;
+}
+
+static int vd__debug_test_count(const char *haystack, const char *needle)
+{
+    int count = 0;
+    Vdusize len = vd_cstr_len((Vdcstr)needle);
+    for (const char *c = haystack; *c; ++c) count += VD_MEMCMP(c, needle, len) == 0;
+    return count;
+}
+
+VD_TEST("Debug/TraceExport") {
+    vd__debug_test_init();
+    static Vd__DebugTestSink sink;
+    static VdDebugTrace trace;
+
+    // Streamed: each frame is written by its frame end
+    VD_MEMSET(&sink, 0, sizeof(sink));
+    vd_debug_trace_begin(&trace, VD_DEBUG_TRACE_FORMAT_CHROME_JSON, vd__debug_test_sink_write, &sink);
+    vd_debug_trace_stream(&trace);
+    vd_debug_set_thread_name("Main \"thread\"");
+    for (int f = 0; f < 3; ++f) {
+        VD_DEBUG_FRAME_BEGIN();
+        VD_DEBUG_ZONE_BEGIN(update);
+        VD_DEBUG_ZONE_BEGIN(physics);
+        VD_DEBUG_ZONE_END(physics);
+        VD_DEBUG_ZONE_END(update);
+        VD_DEBUG_FRAME_END();
+        vd_debug_trace_flush(&trace);
+    }
+    VD_TEST_TRUE("Frames are written as they end", (sink.num_writes == 3) && (trace.num_frames == 3));
+    vd_debug_trace_end(&trace);
+
+    VD_TEST_TRUE("JSON array", (sink.data[0] == '[') && (vd__debug_test_count(sink.data, "\n]\n") == 1));
+    VD_TEST_EQ("Zone slices", vd__debug_test_count(sink.data, "{\"name\":\"physics\",\"ph\":\"X\""), 3);
+    VD_TEST_EQ("Frame slices", vd__debug_test_count(sink.data, "{\"name\":\"Frame\",\"ph\":\"X\",\"pid\":1,\"tid\":0"), 3);
+    VD_TEST_EQ("Threads are named once, escaped", vd__debug_test_count(sink.data, "\"Main \\\"thread\\\"\""), 1);
+    VD_TEST_EQ("Source locations", vd__debug_test_count(sink.data, "\"function\":\"vd_test_proc_"), 6);
+    VD_TEST_TRUE("Not streaming after the end", VD_DEBUG_GET_STATE().stream == 0);
+
+    // From history, as protobuf: every packet is a length-delimited Trace.packet (field 1)
+    VD_MEMSET(&sink, 0, sizeof(sink));
+    vd_debug_trace_begin(&trace, VD_DEBUG_TRACE_FORMAT_PERFETTO, vd__debug_test_sink_write, &sink);
+    vd_debug_trace_write_history(&trace);
+    vd_debug_trace_end(&trace);
+
+    Vdusize num_packets = vd__debug_test_count_packets(&sink);
+    VD_TEST_TRUE("Protobuf packets", (num_packets > 0) && (trace.num_events == num_packets));
+    VD_TEST_OK();
+}
+
+static void vd__debug_test_leaf(Vdf64 spin_ms)
+{
+    VD_DEBUG_ZONE_BEGIN(leaf);
+    VdHiTime start = vd_hitime_get();
+    while (vd_hitime_fms64(vd_hitime_sub(vd_hitime_get(), start)) < spin_ms) {}
+    VD_DEBUG_ZONE_END(leaf);
+}
+
+VD_TEST("Debug/Stats") {
+    enum { NUM_FRAMES = 8, SPIKE_FRAME = 5 };
+    vd__debug_test_init();
+
+    // The same leaf site twice under outer, and once on its own
+    for (int f = 0; f < NUM_FRAMES; ++f) {
+        VD_DEBUG_FRAME_BEGIN();
+        VD_DEBUG_ZONE_BEGIN(outer);
+        vd__debug_test_leaf(f == SPIKE_FRAME ? 20.0 : 0.0);
+        vd__debug_test_leaf(0.0);
+        VD_DEBUG_ZONE_END(outer);
+        vd__debug_test_leaf(0.0);
+        VD_DEBUG_FRAME_END();
+    }
+
+    Vdusize memory = vd_debug_stats_get_memory(NUM_FRAMES);
+    VdArena arena = vd_arena_from_malloc(memory);
+    VdDebugStats stats;
+    vd_debug_stats_build(&stats, &arena, NUM_FRAMES);
+
+    VD_TEST_TRUE("Tree", (stats.num_frames == NUM_FRAMES) && (stats.num_nodes == 3) && (stats.first_root == 0));
+    VdDebugStatsNode *outer = &stats.nodes[stats.first_root];
+    VdDebugStatsNode *inner = &stats.nodes[outer->first_child];
+    VdDebugStatsNode *leaf  = &stats.nodes[outer->next_sibling];
+    VD_TEST_TRUE("One node per site and parent", (inner->site == leaf->site) && (inner->depth == 1) && (leaf->depth == 0) &&
+                                                 (inner->next_sibling == VD_DEBUG_STATS_NO_NODE));
+    VD_TEST_TRUE("Counts", (outer->count == NUM_FRAMES) && (inner->count == 2 * NUM_FRAMES) && (leaf->count == NUM_FRAMES));
+    Vdf64 self_error = outer->self_ms - (outer->inclusive_ms - inner->inclusive_ms);
+    VD_TEST_TRUE("Self time", (self_error < 1e-6) && (self_error > -1e-6));
+    VD_TEST_TRUE("Percentiles", (inner->inclusive.p50_ms <= inner->inclusive.p95_ms) &&
+                                (inner->inclusive.p95_ms <= inner->inclusive.p99_ms) &&
+                                (inner->inclusive.p99_ms <= inner->inclusive.max_ms) &&
+                                (inner->inclusive.max_ms >= 20.0) && (inner->inclusive.p50_ms < 20.0));
+
+    // Other frames may be outliers too if the test was preempted, but the spin must be found and blamed on inner
+    VdDebugSpike spikes[NUM_FRAMES];
+    Vdu32 num_spikes = vd_debug_stats_find_spikes(&stats, 4.0, spikes, NUM_FRAMES);
+    Vdb32 found = VD_FALSE;
+    for (Vdu32 i = 0; i < num_spikes; ++i) {
+        found = found || ((spikes[i].frame == SPIKE_FRAME) && (&stats.nodes[spikes[i].node] == inner) &&
+                          (spikes[i].growth_ms >= 19.0));
+    }
+    VD_TEST_TRUE("Spike", found);
+    VD_TEST_TRUE("Within the reported memory", arena.curr_offset <= memory);
+
+    VD_FREE(arena.buf, memory);
+    VD_TEST_OK();
+}
+
+static void vd__debug_test_count_alloc(void)
+{
+    VD_DEBUG_COUNTER(allocs, 1);
+}
+
+VD_TEST("Debug/Counters") {
+    enum { NUM_FRAMES = 4 };
+    vd__debug_test_init();
+    static Vd__DebugTestSink sink;
+    static VdDebugTrace trace;
+
+    // 3 allocations and two levels each frame; the gauge's last level in frame f is f * 10 + 5
+    VD_MEMSET(&sink, 0, sizeof(sink));
+    vd_debug_trace_begin(&trace, VD_DEBUG_TRACE_FORMAT_CHROME_JSON, vd__debug_test_sink_write, &sink);
+    vd_debug_trace_stream(&trace);
+    for (int f = 0; f < NUM_FRAMES; ++f) {
+        VD_DEBUG_FRAME_BEGIN();
+        for (int i = 0; i < 3; ++i) vd__debug_test_count_alloc();
+        for (int i = 0; i < 2; ++i) VD_DEBUG_GAUGE(level, f * 10 + i * 5);
+        VD_DEBUG_FRAME_END();
+    }
+    vd_debug_trace_end(&trace);
+
+    VdDebugFrame *frame = vd__debug_test_last_frame();
+    VD_TEST_EQ("Samples are kept in the frame", vd_debug_frame_get_num_samples(frame), 5);
+    VdDebugSite *allocs = vd_debug_sample_get_site(vd_debug_frame_get_sample(frame, 0));
+    VdDebugSite *level  = vd_debug_sample_get_site(vd_debug_frame_get_sample(frame, 3));
+    Vdf64 allocs_value = 0.0, level_value = 0.0;
+    VD_TEST_TRUE("Counters sum", vd_debug_frame_get_value(frame, allocs, &allocs_value) && (allocs_value == 3.0));
+    VD_TEST_TRUE("Gauges keep the last sample", vd_debug_frame_get_value(frame, level, &level_value) && (level_value == 35.0));
+
+    VD_TEST_EQ("Counter tracks", vd__debug_test_count(sink.data, "\"ph\":\"C\""), NUM_FRAMES * 3);
+    VD_TEST_EQ("Counter totals", vd__debug_test_count(sink.data, "{\"name\":\"allocs\",\"ph\":\"C\""), NUM_FRAMES);
+    VD_TEST_EQ("Values", vd__debug_test_count(sink.data, "\"args\":{\"value\":35}}"), 1);
+
+    Vdusize memory = vd_debug_stats_get_memory(NUM_FRAMES);
+    VdArena arena = vd_arena_from_malloc(memory);
+    VdDebugStats stats;
+    vd_debug_stats_build(&stats, &arena, NUM_FRAMES);
+    VD_TEST_EQ("One value per site", stats.num_values, 2);
+    VdDebugStatsValue *a = &stats.values[0], *l = &stats.values[1];
+    VD_TEST_TRUE("Counter stats", (a->site == allocs) && (a->min == 3.0) && (a->max == 3.0) && (a->mean == 3.0));
+    VD_TEST_TRUE("Gauge stats", (l->site == level) && (l->min == 5.0) && (l->max == 35.0) && (l->mean == 20.0) &&
+                                (l->last == 35.0) && (l->num_frames == NUM_FRAMES));
+    VD_FREE(arena.buf, memory);
+
+    VD_MEMSET(&sink, 0, sizeof(sink));
+    vd_debug_trace_begin(&trace, VD_DEBUG_TRACE_FORMAT_PERFETTO, vd__debug_test_sink_write, &sink);
+    vd_debug_trace_write_frame(&trace, frame);
+    vd_debug_trace_end(&trace);
+    VD_TEST_EQ("Protobuf counter tracks", vd__debug_test_count_packets(&sink), trace.num_events);
+    VD_TEST_OK();
+}
+
+#endif // VD_DEBUG_INCLUDE_INTERNAL_TESTS && VD_DEBUG_ENABLE
+
 #undef VD_DEBUG_CURR_FRAME
 #undef VD_DEBUG_GET_STATE
-#endif // VD_DEBUG_IMPL
\ No newline at end of file
+#endif // VD_DEBUG_IMPL
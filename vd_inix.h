@@ -75,6 +75,9 @@ typedef struct __VD_Inix_InixParseInfo {
     VdStr         contents;
     Vdusize       num_mappings;
     VdInixMapping *mappings;
+    /** Copy names and strings into the arena instead of pointing into contents, so that the result only references
+     *  memory owned by the arena (for example, to save it with vd_arena_snapshot_write). */
+    Vdb32         copy_strings;
 } VdInixParseInfo;
 
 VdInixResult vd_inix_parse(VdArena *arena, VdInixParseInfo *info);
@@ -151,6 +154,7 @@ typedef struct {
 
     Vdusize         num_mappings;
     VdInixMapping   *mappings;
+    Vdb32           copy_strings;
 
 } Vd__InixContext;
 
@@ -435,6 +439,10 @@ Vdb32 vd__inix_expect_type(Vd__InixContext *context, Vd__InixLexTokenType type,
     return VD_TRUE;
 }
 
+VdStr vd__inix_str(Vd__InixContext *context, VdStr s) {
+    return context->copy_strings ? vd_str_dup(context->arena, s) : s;
+}
+
 VdInixSection *vd__inix_push_section(Vd__InixContext *context) {
     VdInixSection *result = vd_arena_alloc(context->arena, sizeof(VdInixSection));
     context->curr_section->next = result;
@@ -490,7 +498,7 @@ Vdb32 vd__inix_parse_section(Vd__InixContext *context)
         };
 
         VdInixSection *section = vd__inix_push_section(context);
-        section->name = section_name;
+        section->name = vd__inix_str(context, section_name);
 
         // LOGF("Section: [%.*s]", VD_STR_EXPAND(section_name));
         return VD_TRUE;
@@ -541,8 +549,8 @@ Vdb32 vd__inix_parse_expression(Vd__InixContext *context)
             VdStr raw_string = val.raw_string;
 
             VdInixEntry *entry = vd__inix_push_entry(context, VD_INIX_ENTRY_TYPE_RAW_STRING);
-            entry->name = first_string;
-            entry->val.raw_string = raw_string;
+            entry->name = vd__inix_str(context, first_string);
+            entry->val.raw_string = vd__inix_str(context, raw_string);
 
             // LOGF("String assignment: %.*s = %.*s", VD_STR_EXPAND(first_string), VD_STR_EXPAND(raw_string));
             return VD_TRUE;
@@ -553,8 +561,8 @@ Vdb32 vd__inix_parse_expression(Vd__InixContext *context)
             VdStr raw_string = val.raw_string;
 
             VdInixEntry *entry = vd__inix_push_entry(context, VD_INIX_ENTRY_TYPE_RAW_STRING);
-            entry->name = first_string;
-            entry->val.raw_string = raw_string;
+            entry->name = vd__inix_str(context, first_string);
+            entry->val.raw_string = vd__inix_str(context, raw_string);
 
             // LOGF("Raw string assignment: %.*s = %.*s", VD_STR_EXPAND(first_string), VD_STR_EXPAND(raw_string));
             return VD_TRUE;
@@ -563,7 +571,7 @@ Vdb32 vd__inix_parse_expression(Vd__InixContext *context)
             vd__inix_consume_token(context, val);
 
             VdInixEntry *entry = vd__inix_push_entry(context, VD_INIX_ENTRY_TYPE_ENUMERATION);
-            entry->name = first_string;
+            entry->name = vd__inix_str(context, first_string);
 
             VdStr val_string = {
                 &context->contents.s[val.lexstate.cursor_from],
@@ -597,7 +605,7 @@ Vdb32 vd__inix_parse_expression(Vd__InixContext *context)
             }
 
             VdInixEntry *entry = vd__inix_push_entry(context, VD_INIX_ENTRY_TYPE_INTEGER);
-            entry->name = first_string;
+            entry->name = vd__inix_str(context, first_string);
             entry->val.integer = number;
 
             // LOGF("Integer assignment: %.*s = %llu", VD_STR_EXPAND(first_string), number);
@@ -653,8 +661,14 @@ static VdStr Vd__Inix_Global_Section_Name = VD_LIT_INLINE(".global");
 
 VdInixResult vd_inix_parse(VdArena *arena, VdInixParseInfo *info)
 {
+    if (!vd_utf8_validate(info->contents.s, info->contents.len)) {
+        VD_ERRF("%s", "Input is not valid UTF-8");
+        return (VdInixResult) { .global_section = 0, };
+    }
+
     VdInixSection *global_section = vd_arena_alloc(arena, sizeof(VdInixSection));
-    global_section->name = Vd__Inix_Global_Section_Name;
+    global_section->name = info->copy_strings ? vd_str_dup(arena, Vd__Inix_Global_Section_Name)
+                                              : Vd__Inix_Global_Section_Name;
 
     Vd__InixContext context = {
         .contents            = info->contents,
@@ -663,6 +677,7 @@ VdInixResult vd_inix_parse(VdArena *arena, VdInixParseInfo *info)
         .curr_section        = global_section,
         .num_mappings        = info->num_mappings,
         .mappings            = info->mappings,
+        .copy_strings        = info->copy_strings,
         .debug_log_tokens    = 0,
     };
 
@@ -186,7 +186,7 @@ enum {
 };
 
 typedef struct __VD_Input_KeyboardState {
-    Vdb32 states[VD_INPUT_KEYBOARD_SCANCODE_MAX];
+    Vdu64 states[VD_BITS_WORDS(VD_INPUT_KEYBOARD_SCANCODE_MAX)];
 } VdInputKeyboardState;
 
 typedef struct __VD_Input_KeyboardStateGetConstantKeyDownEventsInfo {
@@ -300,7 +300,7 @@ VdStr vd_input_keyboard_scancode_get_name(VdInputKeyboardScancode scancode)
 
 void vd_input_keyboard_state_init(VdInputKeyboardState *kbstate)
 {
-    VD_MEMSET(kbstate->states, 0, sizeof(Vdb32) * VD_INPUT_KEYBOARD_SCANCODE_MAX);
+    VD_MEMSET(kbstate->states, 0, sizeof(kbstate->states));
 }
 
 void vd_input_keyboard_state_send_event(VdInputKeyboardState *kbstate, VdInputEvent *evt)
@@ -309,7 +309,11 @@ void vd_input_keyboard_state_send_event(VdInputKeyboardState *kbstate, VdInputEv
         return;
     }
 
-    kbstate->states[evt->data.key.scancode] = evt->type == VD_INPUT_EVENT_TYPE_KEY_DOWN;
+    if (evt->type == VD_INPUT_EVENT_TYPE_KEY_DOWN) {
+        vd_bits_set(kbstate->states, evt->data.key.scancode);
+    } else {
+        vd_bits_clear(kbstate->states, evt->data.key.scancode);
+    }
 }
 
 void vd_input_keyboard_state_get_constant_key_down_events(VdInputKeyboardState *kbstate, VdInputKeyboardStateGetConstantKeyDownEventsInfo *info)
@@ -317,14 +321,14 @@ void vd_input_keyboard_state_get_constant_key_down_events(VdInputKeyboardState *
     VD_DYNARRAY VdInputEvent *events = 0;
     VD_DYNARRAY_INIT(events, info->arena);
 
-    for (u32 i = 0; i < VD_INPUT_KEYBOARD_SCANCODE_MAX; ++i) {
-        if (kbstate->states[i]) {
+    for (u32 wi = 0; wi < VD_ARRAY_COUNT(kbstate->states); ++wi) {
+        for (Vdu64 w = kbstate->states[wi]; w != 0; w &= w - 1) {
             VdInputEvent *evt = VD_DYNARRAY_PUSH(events);
             *evt = (VdInputEvent) {
                 .type = VD_INPUT_EVENT_TYPE_KEY_DOWN,
                 .data = {
                     .key = {
-                        .scancode = i,
+                        .scancode = wi * 64 + vd_ctz64(w),
                     }
                 }
             };
@@ -129,6 +129,22 @@ typedef char VdUiBool;
 #   endif
 #endif
 
+#ifndef VD_UI_REALLOC
+#   ifdef VD_H
+#       define VD_UI_REALLOC(p,o,n) VD_REALLOC(p,o,n)
+#   else
+#       define VD_UI_REALLOC(p,o,n) realloc(p,n)
+#   endif
+#endif // !VD_UI_REALLOC
+
+#ifndef VD_UI_FREE
+#   ifdef VD_H
+#       define VD_UI_FREE(p,s) VD_FREE(p,s)
+#   else
+#       define VD_UI_FREE(p,s) free(p)
+#   endif
+#endif // !VD_UI_FREE
+
 #define VD_UI_OFFSET_OF(type, element) ((size_t) & (((type*)0)->element))
 
 /* ----INITIALIZATION------------------------------------------------------------------------------------------------ */
@@ -340,8 +356,22 @@ struct VdUiDiv {
     size_t      last_frame_touched;
     int         size_changed;
 
+    /** Hashes of this div's own layout inputs, and of its whole subtree's (computed every frame) */
+    size_t      layout_key;
+    size_t      layout_hash;
+    /** layout_hash as of the last layout that didn't change anything in the subtree, 0 if there was none */
+    size_t      layout_settled;
+    /** Whether the subtree keeps its last layout. Cleared once anything it reads from its parent differs */
+    VdUiBool    layout_clean;
+    /** What the subtree read from outside when it was last laid out: the parent size when sizing upwards and when
+     *  solving oversizes, its own size as the parent left it, and the rect the parent placed it at */
+    float       layout_parent_up[VD_UI_AXES];
+    float       layout_parent_over[VD_UI_AXES];
+    float       layout_size_over[VD_UI_AXES];
+    float       layout_rect[4];
+
+    /** Links free divs, and this frame's null divs */
     VdUiDiv     *hnext;
-    VdUiDiv     *hprev;
 
     VdUiStr     content_str;
     VdUiStr     id_str;
@@ -603,7 +633,9 @@ typedef struct {
 } VdUiUpdate;
 
 /**
- * Get the minimum size required to hold the vertex buffer. Using this, you should allocate the buffer
+ * Get the minimum size required to hold the vertex buffer. Using this, you should allocate the buffer. The vertex
+ * buffer grows when a frame needs more vertices, so check the size vd_ui_frame_get_vertex_buffer returns every frame
+ * and grow your buffer to match.
  * @return  The size (in bytes) of the vertex buffer.
  */
 VD_UI_API size_t           vd_ui_get_min_vertex_buffer_size(void);
@@ -650,6 +682,15 @@ VD_UI_API void             vd_ui_push_rectgrad(float rect[4], float color[16],
                                                float edge_softness,
                                                float border_thickness);
 
+/**
+ * Push a line of text, in the default font, to the vertex buffer
+ * @param str  The text
+ * @param x    The left of the line
+ * @param y    The top of the line
+ * @param size The font size, in pixels
+ */
+VD_UI_API void             vd_ui_push_text(VdUiStr str, float x, float y, float size);
+
 /* ----FONTS--------------------------------------------------------------------------------------------------------- */
 VD_UI_API VdUiFontId       vd_ui_font_add_ttf(void *buffer, size_t size);
 
@@ -664,6 +705,7 @@ VD_UI_API void             vd_ui_event_focus(int on);
 VD_UI_API int              vd_ui_mouse_left_clicked(void);
 VD_UI_API int              vd_ui_mouse_left_just_released(void);
 VD_UI_API void             vd_ui_transform_point(VdUiDiv *div, float point[2], float out_point[2]);
+VD_UI_API void             vd_ui_get_mouse_wheel(float out_wheel[2]);
 VD_UI_API void             vd_ui_set_capture(size_t eid);
 VD_UI_API int              vd_ui_is_captured(VdUiDiv *div);
 
@@ -693,6 +735,12 @@ VD_UI_API void             vd_ui_debug_set_inspector_on(VdUiBool on);
 VD_UI_API void             vd_ui_debug_set_metrics_on(VdUiBool on);
 VD_UI_API void             vd_ui_debug_set_layout_recompute_vis_on(VdUiBool on);
 
+/**
+ * Lay out the whole tree every frame, instead of only the subtrees whose inputs changed
+ * @param  on Whether to force a full layout
+ */
+VD_UI_API void             vd_ui_debug_set_full_layout_on(VdUiBool on);
+
 /* ----INTEGRATION - WINDOW SYSTEMS---------------------------------------------------------------------------------- */
 
 /**
@@ -1035,14 +1083,17 @@ static unsigned char Vd_Ui_Default_Icons_Font[7840];
 #define VD_UI_RENDER_PASSES_MAX     (VD_UI_LAYERS_MAX * VD_UI_CHANNELS_MAX)
 
 #define VD_UI_PARENT_STACK_MAX      256
-#define VD_UI_VBUF_COUNT_MAX        4096
-#define VD_UI_RP_COUNT_MAX          128
+#define VD_UI_VBUF_CHUNK_COUNT      4096
+#define VD_UI_RP_CHUNK_COUNT        128
 #define VD_UI_FONT_COUNT_MAX        4
 #define VD_UI_UPDATE_COUNT_MAX      2
 #define VD_UI_GLYPH_CACHE_COUNT_MAX 2048
 #define VD_UI_FBUF_MAX              1024
 #define VD_UI_CLIP_STACK_MAX        64
-#define VD_UI_NULL_DIVS_MAX         64
+#define VD_UI_DIV_CHUNK_COUNT       256
+#define VD_UI_DIV_SLOTS_MIN         1024
+#define VD_UI_TEXT_CACHE_COUNT      4096
+#define VD_UI_TEXT_GLYPHS_COUNT     65536
 
 #ifndef VD_UI_LOG_ENABLE
 #define VD_UI_LOG_ENABLE 0
@@ -1118,6 +1169,10 @@ static void vd_ui__push_vertexgrad(VdUiContext *ctx, VdUiTextureId *texture, flo
                                                                              float border_thickness);
 static void vd_ui__get_transformed_rect(VdUiContext *ctx, VdUiDiv *div, float rect[4]);
 static void vd_ui__push_pass(VdUiContext *ctx);
+static void *vd_ui__grow(void *buf, unsigned int *cap, unsigned int chunk_count, size_t elem_size);
+static VdUiDiv *vd_ui__div_alloc(VdUiContext *ctx);
+static VdUiDiv *vd_ui__div_get(VdUiContext *ctx, size_t h);
+static void vd_ui__collect_divs(VdUiContext *ctx);
 static void vd_ui__put_line(VdUiContext *ctx, VdUiStr s, float x, float y, float size);
 static void vd_ui__put_symbol(VdUiContext *ctx, VdUiSymbol symbol, float *x, float y, float size);
 static void vd_ui__put_linef(VdUiContext *ctx, float x, float y, const char *fmt, ...);
@@ -1129,8 +1184,12 @@ static void vd_ui__get_glyph_quad(VdUiContext *ctx, unsigned int codepoint, floa
                                   float *s0, float *t0,
                                   float *s1, float *t1);
 static VdUiGlyph*   vd_ui__push_glyph(VdUiContext *ctx, unsigned int codepoint, float size, VdUiFontId font_id);
+static VdUiGlyph*   vd_ui__get_glyph(VdUiContext *ctx, unsigned int codepoint, float size, VdUiFontId font_id);
 static size_t       vd_ui__hash_glyph(unsigned int codepoint, float size, VdUiFontId font_id);
 static void         vd_ui__layout(VdUiContext *ctx);
+static void         vd_ui__measure_div_text(VdUiDiv *curr);
+static size_t       vd_ui__hash_layout_inputs(VdUiDiv *div);
+static int          vd_ui__layout_same(float *a, float *b, int count);
 
 static void         vd_ui__get_axes_for_div(VdUiDiv *div, int *daxis, int *faxis, int *daxisf, int *faxisf);
 static VdUiStr      vd_ui__strbuf_dup(VdUiContext *ctx, VdUiStr str);
@@ -1154,6 +1213,45 @@ static int          vd_ui_ws_nc_area__calc(VdUiContext *ctx, VdUiDiv *curr,
                                                              int *num_total_exclude_rects,
                                                              int *num_exclude_rects, int (*exclude_rects)[4]);
 
+typedef struct {
+    size_t                  h;
+    VdUiDiv                 *div;
+} VdUi__DivSlot;
+
+typedef struct VdUi__DivChunk VdUi__DivChunk;
+struct VdUi__DivChunk {
+    VdUi__DivChunk          *next;
+    VdUiDiv                 divs[VD_UI_DIV_CHUNK_COUNT];
+};
+
+typedef struct {
+    float                   advance;                                               // Rounded x advance
+    float                   off[2];                                                // Quad offset from the pen
+    float                   dim[2];                                                // Quad size
+    float                   uv0[2];                                                // Atlas coordinates
+    float                   uv1[2];
+} VdUi__TextGlyph;
+
+#define VD_UI__TEXT_RUN_HEAD 16
+
+typedef struct {
+    size_t                  h;                                                     // Hash of text, font, size and dpi scale
+    int                     len;                                                   // The rest of the key, compared on a hash
+    char                    head[VD_UI__TEXT_RUN_HEAD];                            // match so that a collision can't return
+    float                   key_size, key_dpi_scale;                               // another text's run. head holds the first
+    uintptr_t               key_font;                                              // bytes of the text
+    int                     prev, next;                                            // LRU links, most recent first
+    int                     has_size;
+    float                   size[2];                                               // Measured width and height
+    int                     has_glyphs;
+    size_t                  glyphs_at;                                             // Index into the glyph ring, counted from
+    unsigned int            num_glyphs;                                            // context creation
+} VdUi__TextRun;
+
+static VdUi__TextRun* vd_ui__text_run_get(VdUiContext *ctx, VdUiStr str, float size, VdUiFontId font_id);
+static int            vd_ui__text_run_put_glyphs(VdUiContext *ctx, VdUi__TextRun *run, VdUiStr str, float size,
+                                                 VdUiFontId font_id);
+
 struct VdUiContext {
     VdUiDiv                 root;                                                  // Root div. Every frame begins with this div
                                                                                    // as the parent.
@@ -1161,11 +1259,13 @@ struct VdUiContext {
     unsigned int            parents_next;                                          // Parent stack.
     VdUiDiv                 *parents[VD_UI_PARENT_STACK_MAX];
 
-    unsigned int            vbuf_count;                                            // Vertex buffer
-    VdUiVertex              vbuf[VD_UI_VBUF_COUNT_MAX];
+    unsigned int            vbuf_count;                                            // Vertex buffer. Grows by whole chunks, and
+    unsigned int            vbuf_cap;                                              // stays contiguous for the renderer
+    VdUiVertex              *vbuf;
 
     unsigned int            num_passes;                                            // Render Passes. Each rp gets added if texture
-    VdUiRenderPass          passes[VD_UI_RP_COUNT_MAX];                            // config or layer differs
+    unsigned int            passes_cap;                                            // config or layer differs
+    VdUiRenderPass          *passes;
 
     unsigned int            num_updates;                                           // Updates. Requests to the user/graphics api
     VdUiUpdate              updates[VD_UI_UPDATE_COUNT_MAX];
@@ -1176,13 +1276,26 @@ struct VdUiContext {
     unsigned int            clip_stack_count;                                      // Clip stack
     float                   clip_stack[VD_UI_CLIP_STACK_MAX][4];
 
-    VdUiDiv                 *divs;                                                 // The actual divs hashmap
-    unsigned int            divs_cap;
-    unsigned int            divs_cap_total;
+    VdUi__DivSlot           *div_slots;                                            // Divs by id. Open addressing on the full id
+    unsigned int            div_slots_cap;                                         // hash (0 marks an empty slot); power of two
+    unsigned int            num_divs;                                              // Divs in div_slots
+    unsigned int            num_divs_touched;                                      // Divs in div_slots touched this frame
+    unsigned int            num_divs_laid_out;                                     // Divs whose layout was redone this frame
+
+    VdUi__DivChunk          *div_chunks;                                           // Div storage. Chunks never move, so div
+    VdUiDiv                 *div_free;                                             // pointers stay valid until evicted
 
-    VdUiDiv                 *null_divs;                                            // Growable buffer for null divs. Currently
-    unsigned int            null_divs_len;                                         // used for spacer divs
-    unsigned int            null_divs_cap;
+    VdUi__TextRun           *text_runs;                                            // Text run cache. LRU of measured (and laid
+    int                     *text_slots;                                           // out) text, by hash; slots index text_runs
+    int                     num_text_runs;                                         // and are -1 when empty
+    int                     text_lru_first, text_lru_last;
+    VdUi__TextGlyph         *text_glyphs;                                          // Glyph quads of cached runs, as a ring. A
+    size_t                  text_glyphs_written;                                   // run whose quads got written over lays out
+                                                                                   // its glyphs again
+    unsigned int            text_lookups, text_hits;                               // Text cache use this frame
+
+    VdUiDiv                 *null_divs;                                            // This frame's null divs (spacers); freed at
+                                                                                   // the next vd_ui_frame_begin
 
     // Glyph Cache
     // Plan (for now):
@@ -1249,6 +1362,7 @@ struct VdUiContext {
         VdUiBool           inspector_on;
 
         VdUiBool           layout_recompute_vis_on;
+        VdUiBool           full_layout_on;
     } debug;
     
     struct {                                                                       // NC AREA
@@ -1273,6 +1387,8 @@ struct VdUiContext {
 VD_UI_API void vd_ui_frame_begin(float delta_seconds)
 {
     VdUiContext *ctx = vd_ui_context_get();
+    vd_ui__collect_divs(ctx);
+
     ctx->root.first           = NULL;
     ctx->root.next            = NULL;
     ctx->root.last            = NULL;
@@ -1290,7 +1406,8 @@ VD_UI_API void vd_ui_frame_begin(float delta_seconds)
     ctx->delta_seconds        = delta_seconds;
 
     ctx->strbuf_len           = 0;
-    ctx->null_divs_len        = 0;
+    ctx->text_lookups         = 0;
+    ctx->text_hits            = 0;
 
     vd_ui_parent_push(&ctx->root);
 
@@ -1431,7 +1548,11 @@ VD_UI_API void vd_ui_frame_end(void)
     }
 
     if (ctx->debug.metrics_on) {
-        vd_ui__put_linef(ctx, 0.f, 32.f, "VBUF: %d", ctx->vbuf_count);
+        vd_ui__put_linef(ctx, 0.f, 32.f, "VBUF: %d/%d PASSES: %d/%d DIVS: %d/%d LAYOUT: %d", ctx->vbuf_count,
+                         ctx->vbuf_cap, ctx->num_passes, ctx->passes_cap, ctx->num_divs, ctx->div_slots_cap,
+                         ctx->num_divs_laid_out);
+        vd_ui__put_linef(ctx, 0.f, 48.f, "TEXT: %d/%d hits, %d runs", ctx->text_hits, ctx->text_lookups,
+                         ctx->num_text_runs);
     }
     vd_ui__pop_clip(ctx);
 
@@ -1442,7 +1563,8 @@ VD_UI_API void vd_ui_frame_end(void)
 /* ----RENDERING IMPL------------------------------------------------------------------------------------------------ */
 VD_UI_API size_t vd_ui_get_min_vertex_buffer_size(void)
 {
-    return sizeof(VdUiVertex) * VD_UI_VBUF_COUNT_MAX;
+    VdUiContext *ctx = vd_ui_context_get();
+    return sizeof(VdUiVertex) * ctx->vbuf_cap;
 }
 
 VD_UI_API VdUiUpdate *vd_ui_frame_get_updates(size_t *num_updates)
@@ -1487,13 +1609,44 @@ VD_UI_API void vd_ui_push_rectgrad(float rect[4], float color[16],
     vd_ui__push_rectgrad(vd_ui_context_get(), rect, color, corner_radius, edge_softness, border_thickness);
 }
 
+VD_UI_API void vd_ui_push_text(VdUiStr str, float x, float y, float size)
+{
+    vd_ui__put_line(vd_ui_context_get(), str, x, y, size);
+}
+
 /* ----UI IMPL------------------------------------------------------------------------------------------------------- */
 #ifdef VD_H
 static size_t vd_ui__hash(void *begin, int len)
 {
     return vd_dhash64(begin, len);
 }
+
+static size_t vd_ui__hash_u64(unsigned long long x)
+{
+    return vd_hash_u64(x);
+}
+
+static size_t vd_ui__hash_combine(size_t a, size_t b)
+{
+    return vd_hash_combine(a, b);
+}
 #else
+static size_t vd_ui__hash_u64(unsigned long long x)
+{
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ull;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebull;
+    x ^= x >> 31;
+    return (size_t)x;
+}
+
+static size_t vd_ui__hash_combine(size_t a, size_t b)
+{
+    unsigned long long x = a;
+    return vd_ui__hash_u64(x ^ (b + 0x9e3779b97f4a7c15ull + (x << 6) + (x >> 2)));
+}
+
 static size_t vd_ui__hash(void *begin, int len)
 {
     const unsigned int m = 0x5bd1e995;
@@ -1928,6 +2081,136 @@ VD_UI_API void vd_ui_scroll_end()
     vd_ui_parent_pop();
 }
 
+// A zeroed div, from the free list or from a new chunk
+static VdUiDiv *vd_ui__div_alloc(VdUiContext *ctx)
+{
+    if (ctx->div_free == 0) {
+        VdUi__DivChunk *chunk = (VdUi__DivChunk*)VD_UI_MALLOC(sizeof(VdUi__DivChunk));
+        VD_UI_ASSERT(chunk != 0);
+        chunk->next = ctx->div_chunks;
+        ctx->div_chunks = chunk;
+
+        for (int i = VD_UI_DIV_CHUNK_COUNT - 1; i >= 0; --i) {
+            chunk->divs[i].hnext = ctx->div_free;
+            ctx->div_free = &chunk->divs[i];
+        }
+    }
+
+    VdUiDiv *result = ctx->div_free;
+    ctx->div_free = result->hnext;
+    VD_UI_MEMSET(result, 0, sizeof(*result));
+    return result;
+}
+
+static void vd_ui__div_free(VdUiContext *ctx, VdUiDiv *div)
+{
+    div->h = 0;
+    div->hnext = ctx->div_free;
+    ctx->div_free = div;
+}
+
+static void vd_ui__div_slots_resize(VdUiContext *ctx, unsigned int cap)
+{
+    VdUi__DivSlot *old_slots = ctx->div_slots;
+    unsigned int  old_cap    = ctx->div_slots_cap;
+
+    ctx->div_slots     = (VdUi__DivSlot*)VD_UI_MALLOC(cap * sizeof(VdUi__DivSlot));
+    ctx->div_slots_cap = cap;
+    VD_UI_ASSERT(ctx->div_slots != 0);
+    VD_UI_MEMSET(ctx->div_slots, 0, cap * sizeof(VdUi__DivSlot));
+
+    for (unsigned int i = 0; i < old_cap; ++i) {
+        if (old_slots[i].h == 0) continue;
+
+        unsigned int j = (unsigned int)(old_slots[i].h & (cap - 1));
+        while (ctx->div_slots[j].h != 0) j = (j + 1) & (cap - 1);
+        ctx->div_slots[j] = old_slots[i];
+    }
+
+    VD_UI_FREE(old_slots, old_cap * sizeof(VdUi__DivSlot));
+}
+
+// The div with id h, created if there isn't one. Linear probing, kept under half full.
+static VdUiDiv *vd_ui__div_get(VdUiContext *ctx, size_t h)
+{
+    unsigned int mask = ctx->div_slots_cap - 1;
+    unsigned int i    = (unsigned int)(h & mask);
+    while (ctx->div_slots[i].h != 0) {
+        if (ctx->div_slots[i].h == h) {
+            return ctx->div_slots[i].div;
+        }
+        i = (i + 1) & mask;
+    }
+
+    if ((ctx->num_divs + 1) * 2 > ctx->div_slots_cap) {
+        vd_ui__div_slots_resize(ctx, ctx->div_slots_cap * 2);
+        mask = ctx->div_slots_cap - 1;
+        i    = (unsigned int)(h & mask);
+        while (ctx->div_slots[i].h != 0) i = (i + 1) & mask;
+    }
+
+    VdUiDiv *result = vd_ui__div_alloc(ctx);
+    ctx->div_slots[i].h   = h;
+    ctx->div_slots[i].div = result;
+    ctx->num_divs++;
+    return result;
+}
+
+// Empties slot i, moving later slots of the same probe run back so that lookups never stop short
+static void vd_ui__div_slots_remove(VdUiContext *ctx, unsigned int i)
+{
+    unsigned int mask = ctx->div_slots_cap - 1;
+    unsigned int j    = i;
+    for (;;) {
+        ctx->div_slots[i].h   = 0;
+        ctx->div_slots[i].div = 0;
+
+        for (;;) {
+            j = (j + 1) & mask;
+            if (ctx->div_slots[j].h == 0) {
+                return;
+            }
+
+            // Slot j can fill the hole at i unless its home slot lies cyclically in (i, j]
+            unsigned int home = (unsigned int)(ctx->div_slots[j].h & mask);
+            int stays = (i <= j) ? ((i < home) && (home <= j)) : ((i < home) || (home <= j));
+            if (!stays) {
+                break;
+            }
+        }
+
+        ctx->div_slots[i] = ctx->div_slots[j];
+        i = j;
+    }
+}
+
+// Evicts the divs that the frame that just ended didn't touch, and frees its null divs
+static void vd_ui__collect_divs(VdUiContext *ctx)
+{
+    while (ctx->null_divs != 0) {
+        VdUiDiv *next = ctx->null_divs->hnext;
+        vd_ui__div_free(ctx, ctx->null_divs);
+        ctx->null_divs = next;
+    }
+
+    if (ctx->num_divs_touched != ctx->num_divs) {
+        unsigned int i = 0;
+        while (i < ctx->div_slots_cap) {
+            VdUiDiv *div = ctx->div_slots[i].div;
+            if ((div != 0) && (div->last_frame_touched != ctx->frame_index)) {
+                // Don't advance: the removal may have moved another slot into i
+                vd_ui__div_slots_remove(ctx, i);
+                vd_ui__div_free(ctx, div);
+                ctx->num_divs--;
+            } else {
+                i++;
+            }
+        }
+    }
+
+    ctx->num_divs_touched = 0;
+}
+
 VD_UI_API VdUiDiv *vd_ui_div_newf(VdUiFlags flags, const char *fmt, ...)
 {
     static char buf[VD_UI_FBUF_MAX];
@@ -1962,8 +2245,9 @@ VD_UI_API VdUiDiv *vd_ui_div_new(VdUiFlags flags, VdUiStr str)
 
     VdUiDiv *result;
     if (str.l == 0) {
-        VD_UI_ASSERT((ctx->null_divs_len + 1) <= ctx->null_divs_cap);
-        result = &ctx->null_divs[ctx->null_divs_len++];
+        result = vd_ui__div_alloc(ctx);
+        result->hnext = ctx->null_divs;
+        ctx->null_divs = result;
         result->h = 0;
         result->is_null = 1;
         result->content_str = (VdUiStr) {0, 0};
@@ -1972,43 +2256,17 @@ VD_UI_API VdUiDiv *vd_ui_div_new(VdUiFlags flags, VdUiStr str)
         size_t ht = vd_ui__hash(substr_to_hash.s, substr_to_hash.l);
         size_t h = ht;
 
+        // Combine instead of XOR, so the order of the parents matters and repeated hashes don't cancel out
         for (int i = 0; i < vd_ui_parent_count(); ++i) {
-            h = h ^ vd_ui_parent_get(i)->h;
+            h = vd_ui__hash_combine(h, vd_ui_parent_get(i)->h);
         }
 
-        size_t index = h % ctx->divs_cap;
-
-        if (ctx->divs[index].h == h) {
-            result = &ctx->divs[index];
-        } else {
-            // We need to traverse the hnext chain of index until we find something
-
-            VdUiDiv *curr = &ctx->divs[index];
-            while ((curr->h != h) && (curr->hnext != 0)) {
-                curr = curr->hnext;
-            }
-
-            if (curr->h != h) {
-                // Otherwise, we need to allocate a new div
-                index = ctx->divs_cap_total - 1;
-
-                while ((index > 0) && (ctx->divs[index].h != 0)) {
-                    index--;
-                }
-
-                if (index == 0) {
-                    // @todo(mdodis)
-                    VD_UI_ASSERT(0);
-                }
-
-                result = &ctx->divs[index];
-                curr->hnext = result;
+        // 0 marks an empty slot in ctx->div_slots
+        if (h == 0) h = 1;
 
-                result->hnext = 0;
-
-            } else {
-                result = curr;
-            }
+        result = vd_ui__div_get(ctx, h);
+        if (result->last_frame_touched != ctx->frame_index) {
+            ctx->num_divs_touched++;
         }
 
         result->h = h;
@@ -2310,10 +2568,20 @@ static void vd_ui__calc_fixed_size(VdUiContext *ctx, VdUiDiv *curr)
     if (curr == 0) {
         return;
     }
+
+    // Hash the subtree's inputs on the way up. The tree is rebuilt every frame, so this is the one pass that can't
+    // skip anything; the rest skip subtrees whose hash matches the last one that settled
+    size_t   key            = (curr == &ctx->root) ? 0 : vd_ui__hash_layout_inputs(curr);
+    size_t   subtree_hash   = key;
+    VdUiBool children_clean = 1;
+
     VdUiDiv *child = curr->first;
     while (child != 0) {
         vd_ui__calc_fixed_size(ctx, child);
 
+        children_clean = children_clean && child->layout_clean;
+        subtree_hash   = vd_ui__hash_combine(subtree_hash, vd_ui__hash_combine(child->h, child->layout_hash));
+
         if (child == child->next) {
             // @impossible
             VD_UI_ASSERT(0);
@@ -2322,41 +2590,27 @@ static void vd_ui__calc_fixed_size(VdUiContext *ctx, VdUiDiv *curr)
     }
 
     if (curr == &ctx->root) {
+        curr->layout_clean = 0;
         return;
     }
 
-    VdUiFontId font_id = {0};
-    float text_sizes[VD_UI_AXES] = {0.f, 0.f};
+    VdUiBool key_changed = curr->is_null || (key != curr->layout_key);
+    curr->layout_key   = key;
+    curr->layout_hash  = subtree_hash;
+    curr->layout_clean = !ctx->debug.full_layout_on && !curr->is_null && children_clean &&
+                         (subtree_hash == curr->layout_settled);
 
-    if ((curr->content_str.l > 0) && (curr->style.text_visibility & VD_UI_VISBILITY_DONT_MEASURE) == 0) {
-        vd_ui_measure_text_size(font_id, curr->content_str, curr->style.text_font_size, &text_sizes[0], &text_sizes[1]);
+    // Text is only measured again when the div's own inputs changed
+    if (key_changed || ctx->debug.full_layout_on) {
+        vd_ui__measure_div_text(curr);
     }
 
-    if (vd_ui_symbol_valid(curr->style.symbol) && (curr->style.symbol_visibility & VD_UI_VISBILITY_DONT_MEASURE) == 0) {
-
-        float rx = 0.f, ry = 0.f;
-        float x0, y0, x1, y1, s0, t0, s1, t1;
-        vd_ui_get_glyph_metrics(curr->style.symbol.font, curr->style.symbol.codepoint, curr->style.text_font_size,
-                                &rx, &ry,
-                                &x0, &y0,
-                                &x1, &y1,
-                                &s0, &t0,
-                                &s1, &t1);
-        text_sizes[0] += x1 - x0;
-        if ((y1 - y0) > text_sizes[1]) {
-            text_sizes[1] = y1 - y0;
-        }
-    }
-
-    curr->text_size[0] = text_sizes[0];
-    curr->text_size[1] = text_sizes[1];
-
     for (int i = 0; i < VD_UI_AXES; ++i) {
 
         float new_comp_size = 0.f;
         switch (curr->size[i].mode) {
             case VD_UI_SIZE_MODE_ABSOLUTE:     new_comp_size = curr->size[i].value; break;
-            case VD_UI_SIZE_MODE_TEXT_CONTENT: new_comp_size = text_sizes[i];             break;
+            case VD_UI_SIZE_MODE_TEXT_CONTENT: new_comp_size = curr->text_size[i];  break;
             default: break;
         }
 
@@ -2378,7 +2632,35 @@ static void vd_ui__calc_fixed_size(VdUiContext *ctx, VdUiDiv *curr)
             default: break;
         }
     }
+}
+
+static void vd_ui__measure_div_text(VdUiDiv *curr)
+{
+    VdUiFontId font_id = {0};
+    float text_sizes[VD_UI_AXES] = {0.f, 0.f};
+
+    if ((curr->content_str.l > 0) && (curr->style.text_visibility & VD_UI_VISBILITY_DONT_MEASURE) == 0) {
+        vd_ui_measure_text_size(font_id, curr->content_str, curr->style.text_font_size, &text_sizes[0], &text_sizes[1]);
+    }
+
+    if (vd_ui_symbol_valid(curr->style.symbol) && (curr->style.symbol_visibility & VD_UI_VISBILITY_DONT_MEASURE) == 0) {
 
+        float rx = 0.f, ry = 0.f;
+        float x0, y0, x1, y1, s0, t0, s1, t1;
+        vd_ui_get_glyph_metrics(curr->style.symbol.font, curr->style.symbol.codepoint, curr->style.text_font_size,
+                                &rx, &ry,
+                                &x0, &y0,
+                                &x1, &y1,
+                                &s0, &t0,
+                                &s1, &t1);
+        text_sizes[0] += x1 - x0;
+        if ((y1 - y0) > text_sizes[1]) {
+            text_sizes[1] = y1 - y0;
+        }
+    }
+
+    curr->text_size[0] = text_sizes[0];
+    curr->text_size[1] = text_sizes[1];
 }
 
 static void vd_ui__calc_dyn_size_up(VdUiContext *ctx, VdUiDiv *curr)
@@ -2387,6 +2669,18 @@ static void vd_ui__calc_dyn_size_up(VdUiContext *ctx, VdUiDiv *curr)
         return;
     }
 
+    if (curr->layout_clean) {
+        if (vd_ui__layout_same(curr->parent->comp_size, curr->layout_parent_up, VD_UI_AXES)) {
+            return;
+        }
+        curr->layout_clean = 0;
+    }
+
+    if (curr->parent) {
+        curr->layout_parent_up[0] = curr->parent->comp_size[0];
+        curr->layout_parent_up[1] = curr->parent->comp_size[1];
+    }
+
     for (int i = 0; i < VD_UI_AXES; ++i) {
         switch (curr->size[i].mode) {
             case VD_UI_SIZE_MODE_PERCENT_OF_PARENT: {
@@ -2413,7 +2707,7 @@ static void vd_ui__calc_dyn_size_up(VdUiContext *ctx, VdUiDiv *curr)
 
 static void vd_ui__calc_dyn_size_down(VdUiContext *ctx, VdUiDiv *curr)
 {
-    if (curr == 0) {
+    if ((curr == 0) || curr->layout_clean) {
         return;
     }
 
@@ -2464,6 +2758,22 @@ static void vd_ui__calc_oversizes(VdUiContext *ctx, VdUiDiv *curr)
         return;
     }
 
+    if (curr->layout_clean) {
+        if (vd_ui__layout_same(curr->parent->comp_size, curr->layout_parent_over, VD_UI_AXES) &&
+            vd_ui__layout_same(curr->comp_size, curr->layout_size_over, VD_UI_AXES))
+        {
+            return;
+        }
+        curr->layout_clean = 0;
+    }
+
+    if (curr->parent) {
+        curr->layout_parent_over[0] = curr->parent->comp_size[0];
+        curr->layout_parent_over[1] = curr->parent->comp_size[1];
+        curr->layout_size_over[0]   = curr->comp_size[0];
+        curr->layout_size_over[1]   = curr->comp_size[1];
+    }
+
     for (int i = 0; i < VD_UI_AXES; ++i) {
         if (curr->parent == 0) {
             continue;
@@ -2536,7 +2846,11 @@ static void vd_ui__calc_oversizes(VdUiContext *ctx, VdUiDiv *curr)
             if ((child->flags & VD_UI_FLAG_FLOAT) == 0) {
                 float proportional_niceness = child->size[i].niceness / overall_niceness;
                 if (proportional_niceness != 0.f) {
-                    child->comp_size[i] = child->comp_size[i] - oversize_amount * proportional_niceness;
+                    float new_comp_size = child->comp_size[i] - oversize_amount * proportional_niceness;
+                    if (new_comp_size != child->comp_size[i]) {
+                        vd_ui__size_changed(ctx, child);
+                    }
+                    child->comp_size[i] = new_comp_size;
                 }
             }
 
@@ -2558,12 +2872,24 @@ static void vd_ui__calc_oversizes(VdUiContext *ctx, VdUiDiv *curr)
 }
 
 
-static void vd_ui__calc_positions(VdUiContext *ctx, VdUiDiv *curr)
+static int vd_ui__calc_positions(VdUiContext *ctx, VdUiDiv *curr)
 {
     if (curr == 0) {
-        return;
+        return 0;
     }
 
+    // A clean subtree that hasn't moved keeps every rect from last frame
+    if (curr->layout_clean) {
+        if (vd_ui__layout_same(curr->rect, curr->layout_rect, 4)) {
+            return 0;
+        }
+        curr->layout_clean = 0;
+    }
+
+    curr->layout_rect[0] = curr->rect[0]; curr->layout_rect[1] = curr->rect[1];
+    curr->layout_rect[2] = curr->rect[2]; curr->layout_rect[3] = curr->rect[3];
+    ctx->num_divs_laid_out++;
+
     VdUiDiv *child = curr->first;
 
     int daxis, faxis, daxisf, faxisf;
@@ -2620,15 +2946,61 @@ static void vd_ui__calc_positions(VdUiContext *ctx, VdUiDiv *curr)
     }
 
 
+    int changed = curr->size_changed;
     child = curr->first;
     while (child != 0) {
-        vd_ui__calc_positions(ctx, child);
+        changed = vd_ui__calc_positions(ctx, child) || changed;
         child = child->next;
     }
+
+    // Only a subtree that came out of layout unchanged can be skipped next frame
+    curr->layout_settled = changed ? 0 : curr->layout_hash;
+    return changed;
+}
+
+static size_t vd_ui__hash_layout_inputs(VdUiDiv *div)
+{
+    union { float f; unsigned int u; } inputs[21] = {
+        {.f = div->style.padding[0]}, {.f = div->style.padding[1]},
+        {.f = div->style.padding[2]}, {.f = div->style.padding[3]},
+        {.f = div->style.text_font_size},
+        {.f = div->size[0].value}, {.f = div->size[0].niceness},
+        {.f = div->size[1].value}, {.f = div->size[1].niceness},
+        {.f = div->offset[0]}, {.f = div->offset[1]},
+        // Floating divs are placed by comp_pos_rel, which the widget sets before layout
+        {.f = (div->flags & VD_UI_FLAG_FLOAT) ? div->comp_pos_rel[0] : 0.f},
+        {.f = (div->flags & VD_UI_FLAG_FLOAT) ? div->comp_pos_rel[1] : 0.f},
+        {.u = (unsigned int)div->flags},
+        {.u = (unsigned int)div->size[0].mode},
+        {.u = (unsigned int)div->size[1].mode},
+        {.u = (unsigned int)div->style.text_visibility},
+        {.u = (unsigned int)div->style.symbol_visibility},
+        {.u = div->style.symbol.codepoint},
+        {.u = (unsigned int)div->style.symbol.font.id},
+        {.u = (unsigned int)div->content_str.l},
+    };
+
+    size_t h = vd_ui__hash(inputs, sizeof(inputs));
+    if (div->content_str.l > 0) {
+        h = vd_ui__hash_combine(h, vd_ui__hash(div->content_str.s, div->content_str.l));
+    }
+    return h;
+}
+
+static int vd_ui__layout_same(float *a, float *b, int count)
+{
+    for (int i = 0; i < count; ++i) {
+        if (a[i] != b[i]) {
+            return 0;
+        }
+    }
+    return 1;
 }
 
 static void vd_ui__layout(VdUiContext *ctx)
 {
+    ctx->num_divs_laid_out = 0;
+
     // Calculate independent sizes
     vd_ui__calc_fixed_size(ctx, &ctx->root);
 
@@ -2751,6 +3123,13 @@ VD_UI_API void vd_ui_transform_point(VdUiDiv *div, float point[2], float out_poi
     out_point[1] = point[1] - div->rect[1];
 }
 
+VD_UI_API void vd_ui_get_mouse_wheel(float out_wheel[2])
+{
+    VdUiContext *ctx = vd_ui_context_get();
+    out_wheel[0] = ctx->wheel_current[0];
+    out_wheel[1] = ctx->wheel_current[1];
+}
+
 VD_UI_API void vd_ui_set_capture(size_t eid)
 {
     VdUiContext *ctx = vd_ui_context_get();
@@ -2877,7 +3256,9 @@ static void vd_ui__push_vertexgrad(VdUiContext *ctx, VdUiTextureId *texture, flo
         vd_ui__push_pass(ctx);
     }
 
-    VD_UI_ASSERT(ctx->vbuf_count < VD_UI_VBUF_COUNT_MAX);
+    if (ctx->vbuf_count == ctx->vbuf_cap) {
+        ctx->vbuf = (VdUiVertex*)vd_ui__grow(ctx->vbuf, &ctx->vbuf_cap, VD_UI_VBUF_CHUNK_COUNT, sizeof(VdUiVertex));
+    }
 
     // Ok so clearly there is an issue when submitting separate passes
     VdUiVertex *v = &ctx->vbuf[ctx->vbuf_count++];
@@ -2923,12 +3304,25 @@ static void vd_ui__get_transformed_rect(VdUiContext *ctx, VdUiDiv *div, float re
     rect[3] = cy + hh + div->offset[1];
 }
 
+// Doubles the number of chunks, so that a frame only grows the buffer a few times on its way to its final size
+static void *vd_ui__grow(void *buf, unsigned int *cap, unsigned int chunk_count, size_t elem_size)
+{
+    unsigned int new_cap = (*cap == 0) ? chunk_count : *cap * 2;
+    void *result = VD_UI_REALLOC(buf, (size_t)(*cap) * elem_size, (size_t)new_cap * elem_size);
+    VD_UI_ASSERT(result != 0);
+    *cap = new_cap;
+    return result;
+}
+
 static void vd_ui__push_pass(VdUiContext *ctx)
 {
     float current_clip[4];
     vd_ui__get_clip(ctx, current_clip);
 
-    VD_UI_ASSERT(ctx->num_passes < VD_UI_RP_COUNT_MAX);
+    if (ctx->num_passes == ctx->passes_cap) {
+        ctx->passes = (VdUiRenderPass*)vd_ui__grow(ctx->passes, &ctx->passes_cap, VD_UI_RP_CHUNK_COUNT,
+                                                   sizeof(VdUiRenderPass));
+    }
     ctx->num_passes++;
 
     VdUiRenderPass *pass   = &ctx->passes[ctx->num_passes - 1];
@@ -2980,6 +3374,10 @@ static void vd_ui__push_rect(VdUiContext *ctx, float rect[4], float color[4])
 
 static void vd_ui__put_line(VdUiContext *ctx, VdUiStr s, float x, float y, float size)
 {
+    if (s.l == 0) {
+        return;
+    }
+
     VdUiFont *font = &ctx->fonts[ctx->def.font.id];
 
     float pixel_size = (float)size;
@@ -2988,6 +3386,37 @@ static void vd_ui__put_line(VdUiContext *ctx, VdUiStr s, float x, float y, float
     float hadd = (float)font->bounding_box[3] - (float)font->bounding_box[1];
     float rp[2] = {x, y + hadd * size_scaled * 0.5f};
 
+    // Emit the run's glyph quads straight from the cache, only snapping them to the pen position
+    VdUi__TextRun *run = vd_ui__text_run_get(ctx, s, size, (VdUiFontId) {0});
+    ctx->text_lookups++;
+    if (run->has_glyphs && (ctx->text_glyphs_written <= run->glyphs_at + VD_UI_TEXT_GLYPHS_COUNT)) {
+        ctx->text_hits++;
+    } else if (!vd_ui__text_run_put_glyphs(ctx, run, s, size, (VdUiFontId) {0})) {
+        run = 0;
+    }
+
+    if (run != 0) {
+        VdUi__TextGlyph *glyphs = &ctx->text_glyphs[run->glyphs_at % VD_UI_TEXT_GLYPHS_COUNT];
+        for (unsigned int i = 0; i < run->num_glyphs; ++i) {
+            VdUi__TextGlyph *glyph = &glyphs[i];
+
+            float p0[2], p1[2];
+            p0[0] = (float)((int)floor(rp[0] + glyph->off[0] + 0.5f));
+            p0[1] = (float)((int)floor(rp[1] + glyph->off[1] + 0.5f));
+            p1[0] = p0[0] + glyph->dim[0];
+            p1[1] = p0[1] + glyph->dim[1];
+
+            vd_ui__push_vertex(ctx, &ctx->texture,
+                p0, p1,
+                glyph->uv0, glyph->uv1,
+                (float[]){1.f, 1.f, 1.f, 1.f},
+                VD_UI_VERTEX_FLAG_TEXTURE_IS_ALPHA_BUFFER);
+
+            rp[0] += glyph->advance;
+        }
+        return;
+    }
+
     unsigned int codepoint = 0;
     while (vd_ui__utf8decs(&s, &codepoint)) {
 
@@ -3066,29 +3495,7 @@ static void vd_ui__get_glyph_quad(VdUiContext *ctx, unsigned int codepoint, floa
                                   float *s0, float *t0,
                                   float *s1, float *t1)
 {
-    size_t hash = vd_ui__hash_glyph(codepoint, size, font_id);
-    size_t hindex = hash % VD_UI_GLYPH_CACHE_COUNT_MAX;
-    size_t index = hindex;
-
-    // Lookup glyph
-    int found_glyph = 1;
-    while (!vd_ui__glyph_eq(&ctx->glyph_cache[index], codepoint, size, font_id)) {
-        if (ctx->glyph_cache[index].next == -1) {
-            found_glyph = 0;
-            break;
-        }
-
-        index = ctx->glyph_cache[index].next;
-    }
-
-    VdUiGlyph *glyph = &ctx->glyph_cache[index];
-
-    if (!found_glyph) {
-        // @todo(mdodis): Glyph paging
-        // We didn't find the glyph. Allocate a new one if it fits
-        // and assert if it doesn't (for now)
-        glyph = vd_ui__push_glyph(ctx, codepoint, size, font_id);
-    }
+    VdUiGlyph *glyph = vd_ui__get_glyph(ctx, codepoint, size, font_id);
 
     int align_to_integer = 1;
     float ipw = 1.0f / (ctx->atlas[0]); float iph = 1.0f / (ctx->atlas[1]);
@@ -3109,6 +3516,27 @@ static void vd_ui__get_glyph_quad(VdUiContext *ctx, unsigned int codepoint, floa
     *rx += roundf(glyph->xadvance);
 }
 
+static VdUiGlyph *vd_ui__get_glyph(VdUiContext *ctx, unsigned int codepoint, float size, VdUiFontId font_id)
+{
+    size_t hash = vd_ui__hash_glyph(codepoint, size, font_id);
+    size_t hindex = hash % VD_UI_GLYPH_CACHE_COUNT_MAX;
+    size_t index = hindex;
+
+    // Lookup glyph
+    while (!vd_ui__glyph_eq(&ctx->glyph_cache[index], codepoint, size, font_id)) {
+        if (ctx->glyph_cache[index].next == -1) {
+            // @todo(mdodis): Glyph paging
+            // We didn't find the glyph. Allocate a new one if it fits
+            // and assert if it doesn't (for now)
+            return vd_ui__push_glyph(ctx, codepoint, size, font_id);
+        }
+
+        index = ctx->glyph_cache[index].next;
+    }
+
+    return &ctx->glyph_cache[index];
+}
+
 VdUiGlyph *vd_ui__push_glyph(VdUiContext *ctx, unsigned int codepoint, float size, VdUiFontId font_id)
 {
     ctx->state = ctx->state == VD_UI__TEXTURE_STATE_IN_GPU ? VD_UI__TEXTURE_STATE_NEEDS_UPDATE : VD_UI__TEXTURE_STATE_NULL;
@@ -3180,10 +3608,11 @@ VdUiGlyph *vd_ui__push_glyph(VdUiContext *ctx, unsigned int codepoint, float siz
 
 static size_t vd_ui__hash_glyph(unsigned int codepoint, float size, VdUiFontId font_id)
 {
-    size_t result = vd_ui__hash(&codepoint, sizeof(codepoint));
-    result = result ^ vd_ui__hash(&font_id, sizeof(font_id));
-    result = result ^ vd_ui__hash(&size, sizeof(size));
-    return result;
+    unsigned int size_bits;
+    VD_UI_MEMCPY(&size_bits, &size, sizeof(size_bits));
+
+    size_t result = vd_ui__hash_u64(((unsigned long long)size_bits << 32) | codepoint);
+    return vd_ui__hash_combine(result, (size_t)font_id.id);
 }
 
 VD_UI_API void             vd_ui_get_glyph_metrics(VdUiFontId id, unsigned int codepoint, float size,
@@ -3206,21 +3635,190 @@ VD_UI_API void vd_ui_measure_text_size(VdUiFontId font_id, VdUiStr str, float si
 {
     VdUiContext *ctx = vd_ui_context_get();
 
-    VdUiFont *font = &ctx->fonts[font_id.id];
-    float pixel_size = (float)size;
-    float size_scaled = stbtt_ScaleForPixelHeight(&font->font_info, pixel_size);
-    *h = (font->ascent - font->descent + font->linegap) * size_scaled;
+    if (str.l == 0) {
+        VdUiFont *font = &ctx->fonts[font_id.id];
+        *h = (font->ascent - font->descent + font->linegap) * stbtt_ScaleForPixelHeight(&font->font_info, size);
+        return;
+    }
+
+    VdUi__TextRun *run = vd_ui__text_run_get(ctx, str, size, font_id);
+    ctx->text_lookups++;
+    if (run->has_size) {
+        ctx->text_hits++;
+    } else {
+        VdUiFont *font = &ctx->fonts[font_id.id];
+        float pixel_size = (float)size;
+        float size_scaled = stbtt_ScaleForPixelHeight(&font->font_info, pixel_size);
+
+        float width = 0.f;
+        unsigned int codepoint;
+        while (vd_ui__utf8decs(&str, &codepoint)) {
+            width += roundf(vd_ui__get_glyph(ctx, codepoint, size, font_id)->xadvance);
+        }
+
+        run->has_size = 1;
+        run->size[0]  = width;
+        run->size[1]  = (font->ascent - font->descent + font->linegap) * size_scaled;
+    }
 
+    *w += run->size[0];
+    *h  = run->size[1];
+}
+
+static void vd_ui__text_run_unlink(VdUiContext *ctx, int i)
+{
+    VdUi__TextRun *run = &ctx->text_runs[i];
+    if (run->prev != -1) ctx->text_runs[run->prev].next = run->next; else ctx->text_lru_first = run->next;
+    if (run->next != -1) ctx->text_runs[run->next].prev = run->prev; else ctx->text_lru_last  = run->prev;
+}
+
+static void vd_ui__text_run_push_front(VdUiContext *ctx, int i)
+{
+    VdUi__TextRun *run = &ctx->text_runs[i];
+    run->prev = -1;
+    run->next = ctx->text_lru_first;
+    if (ctx->text_lru_first != -1) ctx->text_runs[ctx->text_lru_first].prev = i; else ctx->text_lru_last = i;
+    ctx->text_lru_first = i;
+}
+
+static void vd_ui__text_slots_remove(VdUiContext *ctx, unsigned int i)
+{
+    unsigned int mask = VD_UI_TEXT_CACHE_COUNT * 2 - 1;
+    unsigned int j    = i;
+    for (;;) {
+        ctx->text_slots[i] = -1;
+
+        for (;;) {
+            j = (j + 1) & mask;
+            if (ctx->text_slots[j] == -1) {
+                return;
+            }
+
+            // Same backward shift as vd_ui__div_slots_remove
+            unsigned int home = (unsigned int)(ctx->text_runs[ctx->text_slots[j]].h & mask);
+            int stays = (i <= j) ? ((i < home) && (home <= j)) : ((i < home) || (home <= j));
+            if (!stays) {
+                break;
+            }
+        }
+
+        ctx->text_slots[i] = ctx->text_slots[j];
+        i = j;
+    }
+}
+
+static int vd_ui__text_run_matches(VdUi__TextRun *run, size_t h, VdUiStr str, float size, float dpi_scale,
+                                   VdUiFontId font_id)
+{
+    if ((run->h != h) || (run->len != str.l) || (run->key_font != font_id.id) ||
+        (run->key_size != size) || (run->key_dpi_scale != dpi_scale))
+    {
+        return 0;
+    }
+
+    int n = str.l < VD_UI__TEXT_RUN_HEAD ? str.l : VD_UI__TEXT_RUN_HEAD;
+    for (int k = 0; k < n; ++k) {
+        if (run->head[k] != str.s[k]) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+static VdUi__TextRun *vd_ui__text_run_get(VdUiContext *ctx, VdUiStr str, float size, VdUiFontId font_id)
+{
+    float  sizes[2] = {size, ctx->dpi_scale};
+    size_t h        = vd_ui__hash(str.s, str.l);
+    h = vd_ui__hash_combine(h, vd_ui__hash(sizes, sizeof(sizes)));
+    h = vd_ui__hash_combine(h, (size_t)font_id.id);
+
+    unsigned int mask = VD_UI_TEXT_CACHE_COUNT * 2 - 1;
+    unsigned int i    = (unsigned int)(h & mask);
+    while (ctx->text_slots[i] != -1) {
+        int ri = ctx->text_slots[i];
+        if (vd_ui__text_run_matches(&ctx->text_runs[ri], h, str, size, ctx->dpi_scale, font_id)) {
+            if (ri != ctx->text_lru_first) {
+                vd_ui__text_run_unlink(ctx, ri);
+                vd_ui__text_run_push_front(ctx, ri);
+            }
+            return &ctx->text_runs[ri];
+        }
+        i = (i + 1) & mask;
+    }
+
+    int ri;
+    if (ctx->num_text_runs < VD_UI_TEXT_CACHE_COUNT) {
+        ri = ctx->num_text_runs++;
+    } else {
+        // Evict the least recently used run
+        ri = ctx->text_lru_last;
+        vd_ui__text_run_unlink(ctx, ri);
+
+        unsigned int slot = (unsigned int)(ctx->text_runs[ri].h & mask);
+        while (ctx->text_slots[slot] != ri) {
+            slot = (slot + 1) & mask;
+        }
+        vd_ui__text_slots_remove(ctx, slot);
+
+        // Removing shifted the slots around, so probe for a free one again
+        i = (unsigned int)(h & mask);
+        while (ctx->text_slots[i] != -1) {
+            i = (i + 1) & mask;
+        }
+    }
+
+    VdUi__TextRun *run = &ctx->text_runs[ri];
+    run->h             = h;
+    run->len           = str.l;
+    run->key_size      = size;
+    run->key_dpi_scale = ctx->dpi_scale;
+    run->key_font      = font_id.id;
+    VD_UI_MEMCPY(run->head, str.s, str.l < VD_UI__TEXT_RUN_HEAD ? str.l : VD_UI__TEXT_RUN_HEAD);
+    run->has_size      = 0;
+    run->has_glyphs    = 0;
+    run->glyphs_at     = 0;
+    run->num_glyphs    = 0;
+    ctx->text_slots[i] = ri;
+    vd_ui__text_run_push_front(ctx, ri);
+    return run;
+}
+
+static int vd_ui__text_run_put_glyphs(VdUiContext *ctx, VdUi__TextRun *run, VdUiStr str, float size,
+                                      VdUiFontId font_id)
+{
+    // A run takes at most one glyph per byte. Keep a single run from taking up much of the ring
+    if ((size_t)str.l > VD_UI_TEXT_GLYPHS_COUNT / 16) {
+        return 0;
+    }
+
+    // Runs are contiguous in the ring, so skip to the start if this one doesn't fit before the end
+    size_t at = ctx->text_glyphs_written;
+    if ((at % VD_UI_TEXT_GLYPHS_COUNT) + str.l > VD_UI_TEXT_GLYPHS_COUNT) {
+        at += VD_UI_TEXT_GLYPHS_COUNT - (at % VD_UI_TEXT_GLYPHS_COUNT);
+    }
+
+    VdUi__TextGlyph *glyphs = &ctx->text_glyphs[at % VD_UI_TEXT_GLYPHS_COUNT];
+    float ipw = 1.0f / (ctx->atlas[0]); float iph = 1.0f / (ctx->atlas[1]);
+
+    unsigned int num_glyphs = 0;
     unsigned int codepoint;
     while (vd_ui__utf8decs(&str, &codepoint)) {
-        float x0, y0, x1, y1, s0, t0, s1, t1;
-        vd_ui__get_glyph_quad(ctx, codepoint, size, font_id,
-            w, h,
-            &x0, &y0,
-            &x1, &y1,
-            &s0, &t0,
-            &s1, &t1);
+        VdUiGlyph *glyph = vd_ui__get_glyph(ctx, codepoint, size, font_id);
+        VdUi__TextGlyph *out = &glyphs[num_glyphs++];
+
+        out->advance = roundf(glyph->xadvance);
+        out->off[0]  = glyph->xoff;                out->off[1] = glyph->yoff;
+        out->dim[0]  = glyph->xoff2 - glyph->xoff; out->dim[1] = glyph->yoff2 - glyph->yoff;
+        out->uv0[0]  = glyph->x0 * ipw;            out->uv0[1] = glyph->y0 * iph;
+        out->uv1[0]  = glyph->x1 * ipw;            out->uv1[1] = glyph->y1 * iph;
     }
+
+    run->has_glyphs = 1;
+    run->glyphs_at  = at;
+    run->num_glyphs = num_glyphs;
+    ctx->text_glyphs_written = at + num_glyphs;
+    return 1;
 }
 
 static void vd_ui__traverse_and_render_divs(VdUiContext *ctx, VdUiDiv *curr)
@@ -3538,16 +4136,24 @@ VD_UI_API VdUiContext *vd_ui_context_create(VdUiContextCreateInfo *info)
     rpcontext->x = 4;
 
     // Divs & Ids
-    result->divs_cap       = 1000;
-    result->divs_cap_total = 1024;
-    result->divs           = (VdUiDiv*)VD_UI_MALLOC(result->divs_cap_total * sizeof(VdUiDiv));
-    VD_UI_MEMSET(result->divs, 0, result->divs_cap_total * sizeof(VdUiDiv));
+    result->div_slots_cap = VD_UI_DIV_SLOTS_MIN;
+    result->div_slots     = (VdUi__DivSlot*)VD_UI_MALLOC(result->div_slots_cap * sizeof(VdUi__DivSlot));
+    VD_UI_MEMSET(result->div_slots, 0, result->div_slots_cap * sizeof(VdUi__DivSlot));
+
+    // Text Cache
+    result->text_runs   = (VdUi__TextRun*)VD_UI_MALLOC(VD_UI_TEXT_CACHE_COUNT * sizeof(VdUi__TextRun));
+    result->text_slots  = (int*)VD_UI_MALLOC(VD_UI_TEXT_CACHE_COUNT * 2 * sizeof(int));
+    result->text_glyphs = (VdUi__TextGlyph*)VD_UI_MALLOC(VD_UI_TEXT_GLYPHS_COUNT * sizeof(VdUi__TextGlyph));
+    for (int i = 0; i < VD_UI_TEXT_CACHE_COUNT * 2; ++i) {
+        result->text_slots[i] = -1;
+    }
+    result->text_lru_first = -1;
+    result->text_lru_last  = -1;
 
-    // Null Divs
-    result->null_divs_cap = VD_UI_NULL_DIVS_MAX;
-    result->null_divs_len = 0;
-    result->null_divs     = (VdUiDiv*)VD_UI_MALLOC(result->null_divs_cap * sizeof(VdUiDiv));
-    VD_UI_MEMSET(result->null_divs, 0, result->null_divs_cap * sizeof(VdUiDiv));
+    // Vertices & Render Passes
+    result->vbuf   = (VdUiVertex*)vd_ui__grow(0, &result->vbuf_cap, VD_UI_VBUF_CHUNK_COUNT, sizeof(VdUiVertex));
+    result->passes = (VdUiRenderPass*)vd_ui__grow(0, &result->passes_cap, VD_UI_RP_CHUNK_COUNT,
+                                                  sizeof(VdUiRenderPass));
 
     // Arena
     result->strbuf_cap  = 1024 * 1024; // 1MB of per frame string storage
@@ -3881,6 +4487,12 @@ VD_UI_API void vd_ui_debug_set_layout_recompute_vis_on(VdUiBool on)
     ctx->debug.layout_recompute_vis_on = on;
 }
 
+VD_UI_API void vd_ui_debug_set_full_layout_on(VdUiBool on)
+{
+    VdUiContext *ctx = vd_ui_context_get();
+    ctx->debug.full_layout_on = on;
+}
+
 /* ----INTEGRATION - WINDOW SYSTEMS IMPL----------------------------------------------------------------------------- */
 VD_UI_API void vd_ui_ws_nc_area_mark(VdUiDiv *div)
 {